@@ -35,6 +35,7 @@ public class MessageDispatchHeaderGenerator extends CommandHeaderGenerator {
         out.println("    private:");
         out.println("");
         out.println("        decaf::lang::Exception rollbackCause;");
+        out.println("        long long arrivalTime;");
         out.println("");
     }
 
@@ -43,6 +44,10 @@ public class MessageDispatchHeaderGenerator extends CommandHeaderGenerator {
         out.println("");
         out.println("        decaf::lang::Exception getRollbackCause() const;");
         out.println("");
+        out.println("        void setArrivalTime(long long arrivalTime);");
+        out.println("");
+        out.println("        long long getArrivalTime() const;");
+        out.println("");
 
         super.generateAdditonalMembers( out );
     }
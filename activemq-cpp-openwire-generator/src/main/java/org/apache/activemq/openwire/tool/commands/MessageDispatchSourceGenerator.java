@@ -21,7 +21,7 @@ import java.io.PrintWriter;
 public class MessageDispatchSourceGenerator extends CommandSourceGenerator {
 
     protected String generateInitializerList() {
-        return super.generateInitializerList() + ", rollbackCause()";
+        return super.generateInitializerList() + ", rollbackCause(), arrivalTime(0)";
     }
 
     protected void generateAdditionalMethods( PrintWriter out ) {
@@ -35,6 +35,16 @@ public class MessageDispatchSourceGenerator extends CommandSourceGenerator {
         out.println("    return this->rollbackCause;");
         out.println("}");
         out.println("");
+        out.println("////////////////////////////////////////////////////////////////////////////////");
+        out.println("void MessageDispatch::setArrivalTime(long long arrivalTime) {");
+        out.println("    this->arrivalTime = arrivalTime;");
+        out.println("}");
+        out.println("");
+        out.println("////////////////////////////////////////////////////////////////////////////////");
+        out.println("long long MessageDispatch::getArrivalTime() const {");
+        out.println("    return this->arrivalTime;");
+        out.println("}");
+        out.println("");
 
         super.generateAdditionalMethods(out);
     }
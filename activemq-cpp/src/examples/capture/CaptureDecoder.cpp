@@ -0,0 +1,157 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <activemq/library/ActiveMQCPP.h>
+#include <activemq/io/CaptureFile.h>
+#include <activemq/io/CaptureFileReader.h>
+#include <activemq/io/CaptureRecord.h>
+#include <activemq/wireformat/openwire/OpenWireCaptureDecoder.h>
+#include <activemq/commands/Command.h>
+#include <decaf/lang/Exception.h>
+#include <decaf/lang/Integer.h>
+#include <decaf/lang/System.h>
+#include <decaf/util/LinkedList.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <iostream>
+#include <memory>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::io;
+using namespace activemq::commands;
+using namespace activemq::wireformat::openwire;
+using namespace decaf::lang;
+using namespace decaf::util;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    void usage() {
+        cout << "Usage: capture_decoder [-r iterations] <capture file>" << endl
+             << endl
+             << "Prints the OpenWire commands held in a file captured with the" << endl
+             << "transport.captureFile option of the tcp transport, or with -r decodes" << endl
+             << "the whole capture the given number of times and reports the rate." << endl;
+    }
+
+    void print(const CaptureRecord& record, LinkedList< Pointer<Command> >& commands) {
+
+        long long seconds = record.getTimestamp() / 1000000000LL;
+        long long nanos = record.getTimestamp() % 1000000000LL;
+
+        printf("%lld.%09lld stream %d %s %d bytes\n", seconds, nanos, record.getStreamId(),
+               record.isInbound() ? "<<" : ">>", (int) record.getData().size());
+
+        std::auto_ptr< Iterator< Pointer<Command> > > iter(commands.iterator());
+        while (iter->hasNext()) {
+            cout << "    " << iter->next()->toString() << endl;
+        }
+    }
+
+    void replay(CaptureFileReader& reader, int iterations) {
+
+        OpenWireCaptureDecoder decoder;
+        CaptureRecord record;
+        LinkedList< Pointer<Command> > commands;
+
+        long long bytes = 0;
+        long long decoded = 0;
+        long long start = System::nanoTime();
+
+        for (int i = 0; i < iterations; ++i) {
+            reader.reset();
+            decoder.reset();
+
+            while (reader.next(record)) {
+                bytes += (long long) record.getData().size();
+                decoded += decoder.decode(record, commands);
+                commands.clear();
+            }
+        }
+
+        double elapsed = (double) (System::nanoTime() - start) / 1e9;
+        if (elapsed <= 0) {
+            elapsed = 1e-9;
+        }
+
+        printf("decoded %lld commands from %lld bytes in %.3f s: %.0f commands/s, %.1f MB/s\n",
+               decoded, bytes, elapsed, (double) decoded / elapsed, (double) bytes / elapsed / (1024 * 1024));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[]) {
+
+    int iterations = 0;
+    const char* path = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            iterations = Integer::parseInt(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            usage();
+            return 1;
+        } else {
+            path = argv[i];
+        }
+    }
+
+    if (path == NULL) {
+        usage();
+        return 1;
+    }
+
+    activemq::library::ActiveMQCPP::initializeLibrary();
+
+    int result = 0;
+
+    try {
+
+        CaptureFileReader reader(path);
+
+        printf("%d records from %d streams%s, %d dropped\n", reader.getRecordCount(),
+               reader.getStreamCount(), reader.isWrapped() ? " (wrapped)" : "", reader.getDroppedCount());
+
+        if (iterations > 0) {
+            replay(reader, iterations);
+        } else {
+            OpenWireCaptureDecoder decoder;
+            CaptureRecord record;
+            LinkedList< Pointer<Command> > commands;
+
+            while (reader.next(record)) {
+                decoder.decode(record, commands);
+                print(record, commands);
+                commands.clear();
+            }
+
+            if (decoder.getErrorCount() > 0) {
+                printf("%d stream directions could not be decoded\n", decoder.getErrorCount());
+            }
+        }
+
+    } catch (Exception& ex) {
+        cerr << ex.getMessage() << endl;
+        result = 1;
+    }
+
+    activemq::library::ActiveMQCPP::shutdownLibrary();
+
+    return result;
+}
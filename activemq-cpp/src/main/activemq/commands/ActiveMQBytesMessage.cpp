@@ -30,6 +30,7 @@ using namespace std;
 using namespace activemq;
 using namespace activemq::util;
 using namespace activemq::commands;
+using namespace activemq::io;
 using namespace activemq::exceptions;
 using namespace decaf::io;
 using namespace decaf::lang;
@@ -70,7 +71,7 @@ namespace{
 
 ////////////////////////////////////////////////////////////////////////////////
 ActiveMQBytesMessage::ActiveMQBytesMessage() :
-    ActiveMQMessageTemplate<cms::BytesMessage>(), bytesOut(NULL), dataIn(), dataOut(), length(0) {
+    ActiveMQMessageTemplate<cms::BytesMessage>(), bytesOut(NULL), dataIn(), dataOut(), length(0), bodyFile() {
 
     this->clearBody();
 }
@@ -112,6 +113,8 @@ void ActiveMQBytesMessage::copyDataStructure( const DataStructure* src ) {
     nonConstSrc->storeContent();
 
     ActiveMQMessageTemplate<cms::BytesMessage>::copyDataStructure( src );
+
+    this->bodyFile = srcPtr->bodyFile;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -124,6 +127,18 @@ bool ActiveMQBytesMessage::equals( const DataStructure* value ) const {
     return ActiveMQMessageTemplate<cms::BytesMessage>::equals( value );
 }
 
+////////////////////////////////////////////////////////////////////////////////
+unsigned int ActiveMQBytesMessage::getSize() const {
+
+    unsigned int size = ActiveMQMessageTemplate<cms::BytesMessage>::getSize();
+
+    if( this->bodyFile != NULL ) {
+        size += (unsigned int)this->bodyFile->getLength();
+    }
+
+    return size;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQBytesMessage::setBodyBytes( const unsigned char* buffer, int numBytes ) {
 
@@ -159,6 +174,12 @@ unsigned char* ActiveMQBytesMessage::getBodyBytes() const {
 int ActiveMQBytesMessage::getBodyLength() const {
 
     try{
+
+        if( this->bodyFile != NULL ) {
+            this->failIfWriteOnlyBody();
+            return this->bodyFile->getLength();
+        }
+
         initializeReading();
         return this->length;
     }
@@ -175,11 +196,19 @@ void ActiveMQBytesMessage::clearBody() {
     this->bytesOut = NULL;
     this->dataIn.reset( NULL );
     this->length = 0;
+    this->bodyFile.reset( NULL );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQBytesMessage::onSend() {
 
+    // A file body can only be sent from the file as it is, when the connection
+    // compresses bodies it is read in through the compressing writer instead.
+    if( this->bodyFile != NULL && this->connection != NULL && this->connection->isUseCompression() ) {
+        this->setReadOnlyBody( false );
+        this->initializeWriting();
+    }
+
     this->storeContent();
     ActiveMQMessageTemplate<cms::BytesMessage>::onSend();
 }
@@ -573,6 +602,44 @@ void ActiveMQBytesMessage::writeUTF( const std::string& value ) {
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQBytesMessage::setBodyFile( const std::string& path, long long position, int length ) {
+
+    this->failIfReadOnlyBody();
+    try{
+
+        Pointer<FileRegion> region( new FileRegion( path, position, length ) );
+
+        this->dataOut.reset( NULL );
+        this->bytesOut = NULL;
+        this->dataIn.reset( NULL );
+        this->length = 0;
+        this->setContent( std::vector<unsigned char>() );
+        this->setCompressed( false );
+        this->bodyFile = region;
+    }
+    AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQBytesMessage::loadBodyFile() {
+
+    try{
+
+        if( this->bodyFile != NULL ) {
+
+            std::vector<unsigned char> content( (std::size_t)this->bodyFile->getLength() );
+            if( !content.empty() ) {
+                this->bodyFile->read( &content[0] );
+            }
+
+            this->getContent().swap( content );
+            this->bodyFile.reset( NULL );
+        }
+    }
+    AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQBytesMessage::storeContent() {
 
@@ -619,6 +686,11 @@ void ActiveMQBytesMessage::initializeReading() const {
     try {
 
         if (this->dataIn.get() == NULL) {
+
+            if (this->bodyFile != NULL) {
+                const_cast<ActiveMQBytesMessage*>(this)->loadBodyFile();
+            }
+
             InputStream* is = new ByteArrayInputStream(this->getContent());
 
             if (this->isCompressed()) {
@@ -662,6 +734,16 @@ void ActiveMQBytesMessage::initializeWriting() {
             }
 
             this->dataOut.reset( new DataOutputStream( os, true ) );
+
+            // Bytes written after a file body was set are appended to the file data.
+            if( this->bodyFile != NULL ) {
+                std::vector<unsigned char> content( (std::size_t)this->bodyFile->getLength() );
+                if( !content.empty() ) {
+                    this->bodyFile->read( &content[0] );
+                    this->dataOut->write( &content[0], (int)content.size(), 0, (int)content.size() );
+                }
+                this->bodyFile.reset( NULL );
+            }
         }
     }
     AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
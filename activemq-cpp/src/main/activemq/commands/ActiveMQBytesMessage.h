@@ -25,9 +25,11 @@
 
 #include <activemq/util/Config.h>
 #include <activemq/commands/ActiveMQMessageTemplate.h>
+#include <activemq/io/FileRegion.h>
 #include <decaf/io/ByteArrayOutputStream.h>
 #include <decaf/io/DataInputStream.h>
 #include <decaf/io/DataOutputStream.h>
+#include <decaf/lang/Pointer.h>
 #include <cms/BytesMessage.h>
 #include <vector>
 #include <string>
@@ -61,6 +63,11 @@ namespace commands{
          */
         mutable int length;
 
+        /**
+         * Region of a file that supplies the body in place of the content bytes.
+         */
+        decaf::lang::Pointer<activemq::io::FileRegion> bodyFile;
+
     public:
 
         const static unsigned char ID_ACTIVEMQBYTESMESSAGE = 24;
@@ -86,6 +93,8 @@ namespace commands{
 
         virtual bool equals( const DataStructure* value ) const;
 
+        virtual unsigned int getSize() const;
+
     public:   // CMS Message
 
         virtual cms::BytesMessage* clone() const {
@@ -161,6 +170,50 @@ namespace commands{
 
         virtual void writeUTF( const std::string& value );
 
+    public:   // File backed body
+
+        /**
+         * Makes the given region of a file the body of this message, replacing anything
+         * written so far.  The file is not read here, when the message is sent over a
+         * plain TCP connection without compression the region goes from the file to the
+         * socket with sendfile, otherwise it is read into the message when it is sent or
+         * when the body is read.  Bytes written to the message afterwards are appended
+         * to the file data.  The file must not change until the send has completed.
+         *
+         * @param path
+         *      The path of the file holding the body.
+         * @param position
+         *      The offset into the file where the body starts.
+         * @param length
+         *      The length of the body.
+         *
+         * @throws CMSException if the region is not valid or the file cannot be read.
+         * @throws MessageNotWriteableException if the message is in read-only mode.
+         *
+         * @since 3.8.0
+         */
+        void setBodyFile( const std::string& path, long long position, int length );
+
+        /**
+         * @returns the file region holding the body of this message, or NULL when the
+         *          body is held in memory.
+         *
+         * @since 3.8.0
+         */
+        decaf::lang::Pointer<activemq::io::FileRegion> getBodyFile() const {
+            return this->bodyFile;
+        }
+
+        /**
+         * Reads the file region that holds the body of this message, if there is one,
+         * into the message content so that it can be marshaled like any other body.
+         *
+         * @throws CMSException if the file cannot be read.
+         *
+         * @since 3.8.0
+         */
+        void loadBodyFile();
+
     private:
 
         void storeContent();
@@ -39,7 +39,7 @@ using namespace decaf::lang::exceptions;
 
 ////////////////////////////////////////////////////////////////////////////////
 MessageDispatch::MessageDispatch() :
-    BaseCommand(), consumerId(NULL), destination(NULL), message(NULL), redeliveryCounter(0), rollbackCause() {
+    BaseCommand(), consumerId(NULL), destination(NULL), message(NULL), redeliveryCounter(0), rollbackCause(), arrivalTime(0) {
 
 }
 
@@ -235,3 +235,13 @@ decaf::lang::Exception MessageDispatch::getRollbackCause() const {
     return this->rollbackCause;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void MessageDispatch::setArrivalTime(long long arrivalTime) {
+    this->arrivalTime = arrivalTime;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long MessageDispatch::getArrivalTime() const {
+    return this->arrivalTime;
+}
+
@@ -62,6 +62,7 @@ namespace commands {
     private:
 
         decaf::lang::Exception rollbackCause;
+        long long arrivalTime;
 
     private:
 
@@ -88,6 +89,10 @@ namespace commands {
 
         decaf::lang::Exception getRollbackCause() const;
 
+        void setArrivalTime(long long arrivalTime);
+
+        long long getArrivalTime() const;
+
         virtual const Pointer<ConsumerId>& getConsumerId() const;
         virtual Pointer<ConsumerId>& getConsumerId();
         virtual void setConsumerId( const Pointer<ConsumerId>& consumerId );
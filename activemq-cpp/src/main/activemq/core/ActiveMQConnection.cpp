@@ -22,6 +22,7 @@
 #include <activemq/core/ActiveMQSession.h>
 #include <activemq/core/ActiveMQConstants.h>
 #include <activemq/core/ActiveMQConnectionMetaData.h>
+#include <activemq/core/ConsumerRoutingTable.h>
 #include <activemq/core/ActiveMQMessageAudit.h>
 #include <activemq/core/AdvisoryConsumer.h>
 #include <activemq/core/ConnectionAudit.h>
@@ -34,12 +35,16 @@
 #include <activemq/exceptions/ConnectionFailedException.h>
 #include <activemq/util/CMSExceptionSupport.h>
 #include <activemq/util/IdGenerator.h>
+#include <activemq/util/LatencyStatistics.h>
+#include <activemq/util/MemoryUsage.h>
+#include <activemq/transport/IOTransport.h>
 #include <activemq/transport/failover/FailoverTransport.h>
 #include <activemq/transport/ResponseCallback.h>
 
 #include <decaf/lang/Math.h>
 #include <decaf/lang/Boolean.h>
 #include <decaf/lang/Integer.h>
+#include <decaf/lang/System.h>
 #include <decaf/util/Iterator.h>
 #include <decaf/util/Set.h>
 #include <decaf/util/Collection.h>
@@ -96,10 +101,14 @@ namespace core{
     private:
 
         std::string connectionId;
+        std::string prefix;
 
     public:
 
-        ConnectionThreadFactory(std::string connectionId) : connectionId(connectionId) {
+        ConnectionThreadFactory(std::string connectionId,
+                                std::string prefix = "ActiveMQ Connection Executor: ") :
+            connectionId(connectionId), prefix(prefix) {
+
             if (connectionId.empty()) {
                 throw NullPointerException(__FILE__, __LINE__, "Connection Id must be set.");
             }
@@ -108,8 +117,6 @@ namespace core{
         virtual ~ConnectionThreadFactory() {}
 
         virtual Thread* newThread(decaf::lang::Runnable* runnable) {
-            static std::string prefix = "ActiveMQ Connection Executor: ";
-
             std::string name = prefix + connectionId;
             Thread* thread = new Thread(runnable, name);
             return thread;
@@ -117,6 +124,37 @@ namespace core{
 
     };
 
+    /**
+     * Applies backpressure to the transport thread, when the completion queue is full the
+     * thread waits for room rather than dropping the result or running the callback itself.
+     */
+    class BlockingCompletionPolicy : public RejectedExecutionHandler {
+    public:
+
+        BlockingCompletionPolicy() : RejectedExecutionHandler() {}
+
+        virtual ~BlockingCompletionPolicy() {}
+
+        virtual void rejectedExecution(decaf::lang::Runnable* task, ThreadPoolExecutor* executor) {
+
+            // Once shut down the result is still delivered, just not asynchronously.
+            if (!executor->isShutdown()) {
+                try {
+                    executor->getQueue()->put(task);
+                    return;
+                } catch (InterruptedException& ex) {
+                    Thread::currentThread()->interrupt();
+                }
+            }
+
+            try {
+                task->run();
+            } catch (...) {
+            }
+            delete task;
+        }
+    };
+
     class ConnectionConfig {
     private:
 
@@ -125,9 +163,7 @@ namespace core{
 
     public:
 
-        typedef decaf::util::StlMap< Pointer<commands::ConsumerId>,
-                                     Dispatcher*,
-                                     commands::ConsumerId::COMPARATOR > DispatcherMap;
+        typedef ConsumerRoutingTable<Dispatcher*> DispatcherMap;
 
         typedef decaf::util::StlMap< Pointer<commands::ProducerId>,
                                      Pointer<ActiveMQProducerKernel>,
@@ -175,10 +211,21 @@ namespace core{
         bool exclusiveConsumer;
         bool transactedIndividualAck;
         bool nonBlockingRedelivery;
+        bool localSelectorFiltering;
+        bool adaptivePrefetch;
+        int adaptivePrefetchMaximum;
+        long long adaptivePrefetchMemoryLimit;
+        long long inboundMemoryLimit;
+        int pullPipelineDepth;
+        int sendPipelineDepth;
+        int completionExecutorThreads;
+        int completionQueueSize;
+        bool statisticsEnabled;
         int compressionLevel;
         unsigned int sendTimeout;
         unsigned int closeTimeout;
         unsigned int producerWindowSize;
+        bool adaptiveSendPacing;
         int auditDepth;
         int auditMaximumProducerNumber;
         long long optimizeAcknowledgeTimeOut;
@@ -211,6 +258,19 @@ namespace core{
 
         ConnectionAudit connectionAudit;
 
+        decaf::util::concurrent::Mutex prefetchMemoryMutex;
+        long long reservedPrefetchMemory;
+
+        Pointer<util::MemoryUsage> inboundMemoryUsage;
+        decaf::util::concurrent::atomic::AtomicBoolean inboundMemoryThrottled;
+        bool inboundMemoryThrottleApplied;
+        decaf::util::concurrent::atomic::AtomicBoolean inboundMemoryThrottleRetry;
+
+        decaf::util::concurrent::Mutex completionExecutorLock;
+        Pointer<ThreadPoolExecutor> completionExecutor;
+
+        Pointer<util::LatencyStatistics> statistics;
+
         ConnectionConfig(const Pointer<transport::Transport> transport,
                          const Pointer<decaf::util::Properties> properties) :
                              properties(properties),
@@ -242,10 +302,21 @@ namespace core{
                              exclusiveConsumer(false),
                              transactedIndividualAck(false),
                              nonBlockingRedelivery(false),
+                             localSelectorFiltering(false),
+                             adaptivePrefetch(false),
+                             adaptivePrefetchMaximum(32766),
+                             adaptivePrefetchMemoryLimit(64 * 1024 * 1024),
+                             inboundMemoryLimit(0),
+                             pullPipelineDepth(1),
+                             sendPipelineDepth(0),
+                             completionExecutorThreads(0),
+                             completionQueueSize(1000),
+                             statisticsEnabled(false),
                              compressionLevel(-1),
                              sendTimeout(0),
                              closeTimeout(15000),
                              producerWindowSize(0),
+                             adaptiveSendPacing(false),
                              auditDepth(ActiveMQMessageAudit::DEFAULT_WINDOW_SIZE),
                              auditMaximumProducerNumber(ActiveMQMessageAudit::MAXIMUM_PRODUCER_COUNT),
                              optimizeAcknowledgeTimeOut(300),
@@ -267,7 +338,17 @@ namespace core{
                              sessionsLock(),
                              activeSessions(),
                              transportListeners(),
-                             activeTempDestinations() {
+                             activeTempDestinations(),
+                             connectionAudit(),
+                             prefetchMemoryMutex(),
+                             reservedPrefetchMemory(0),
+                             inboundMemoryUsage(new util::MemoryUsage()),
+                             inboundMemoryThrottled(),
+                             inboundMemoryThrottleApplied(false),
+                             inboundMemoryThrottleRetry(),
+                             completionExecutorLock(),
+                             completionExecutor(),
+                             statistics() {
 
             this->defaultPrefetchPolicy.reset(new DefaultPrefetchPolicy());
             this->defaultRedeliveryPolicy.reset(new DefaultRedeliveryPolicy());
@@ -297,13 +378,66 @@ namespace core{
                     this->executor->shutdown();
                     this->executor->awaitTermination(10, TimeUnit::MINUTES);
                 }
+
+                synchronized(&completionExecutorLock) {
+                    if (this->completionExecutor != NULL) {
+                        this->completionExecutor->shutdown();
+                        this->completionExecutor->awaitTermination(10, TimeUnit::MINUTES);
+                    }
+                }
             }
             AMQ_CATCHALL_NOTHROW()
         }
 
+        /**
+         * Returns the executor that delivers AsyncCallback results, creating it on first
+         * use, or NULL if callbacks are run on the transport thread.
+         */
+        ThreadPoolExecutor* getCompletionExecutor() {
+
+            if (this->completionExecutorThreads <= 0) {
+                return NULL;
+            }
+
+            synchronized(&completionExecutorLock) {
+                if (this->completionExecutor == NULL) {
+                    int threads = this->completionExecutorThreads;
+                    int capacity = this->completionQueueSize < 1 ? 1 : this->completionQueueSize;
+                    this->completionExecutor.reset(
+                        new ThreadPoolExecutor(threads, threads, 5, TimeUnit::SECONDS,
+                            new LinkedBlockingQueue<Runnable*>(capacity),
+                            new ConnectionThreadFactory(this->connectionInfo->getConnectionId()->toString(),
+                                                        "ActiveMQ Connection Completions: "),
+                            new BlockingCompletionPolicy()));
+                }
+
+                return this->completionExecutor.get();
+            }
+
+            return NULL;
+        }
+
         void waitForBrokerInfo() {
             this->brokerInfoReceived->await();
         }
+
+        /**
+         * Hands the statistics to the IOTransport currently beneath the connection so it
+         * can time its writes, a fault tolerant transport gets a new one on each reconnect.
+         */
+        void attachStatistics() {
+
+            if (this->transport == NULL) {
+                return;
+            }
+
+            transport::IOTransport* ioTransport =
+                dynamic_cast<transport::IOTransport*>(this->transport->narrow(typeid(transport::IOTransport)));
+
+            if (ioTransport != NULL) {
+                ioTransport->setStatistics(this->statisticsEnabled ? this->statistics : Pointer<util::LatencyStatistics>());
+            }
+        }
     };
 
     // Static init.
@@ -407,6 +541,19 @@ namespace core{
 
                 this->config->brokerInfoReceived->countDown();
 
+                // Pipelined sends will never be answered now, fail them so that closing
+                // their producers doesn't wait on the broker.
+                cms::CMSException failure = ActiveMQException(*this->connection->getFirstFailureError()).convertToCMSException();
+                this->config->sessionsLock.readLock().lock();
+                try {
+                    std::auto_ptr<Iterator<Pointer<ActiveMQSessionKernel> > > sessions(this->config->activeSessions.iterator());
+                    while (sessions->hasNext()) {
+                        sessions->next()->failSendWindows(failure);
+                    }
+                } catch(...) {
+                }
+                this->config->sessionsLock.readLock().unlock();
+
                 // Clean up the Connection resources.
                 this->connection->cleanup();
 
@@ -423,27 +570,92 @@ namespace core{
         }
     };
 
-    class AsyncResponseCallback : public ResponseCallback {
+    class InboundMemoryThrottleRunnable : public Runnable {
     private:
 
+        ActiveMQConnection* connection;
         ConnectionConfig* config;
+
+    private:
+
+        InboundMemoryThrottleRunnable(const InboundMemoryThrottleRunnable&);
+        InboundMemoryThrottleRunnable& operator= (const InboundMemoryThrottleRunnable&);
+
+    public:
+
+        InboundMemoryThrottleRunnable(ActiveMQConnection* connection, ConnectionConfig* config) :
+            Runnable(), connection(connection), config(config) {}
+        virtual ~InboundMemoryThrottleRunnable() {}
+
+        virtual void run() {
+
+            // Runs on the single connection executor thread so the last request wins.
+            bool throttled = config->inboundMemoryThrottled.get();
+            if (throttled == config->inboundMemoryThrottleApplied) {
+                return;
+            }
+
+            // Every session is updated even if one fails, the state only counts as
+            // applied once they all succeed, otherwise the next inbound message retries.
+            bool applied = true;
+
+            config->sessionsLock.readLock().lock();
+            try {
+                std::auto_ptr<Iterator<Pointer<ActiveMQSessionKernel> > > iter(config->activeSessions.iterator());
+                while (iter->hasNext()) {
+                    try {
+                        iter->next()->setDispatchThrottled(throttled);
+                    } catch (Exception& ex) {
+                        applied = false;
+                        connection->onAsyncException(ex);
+                    }
+                }
+                config->sessionsLock.readLock().unlock();
+            } catch (Exception& ex) {
+                config->sessionsLock.readLock().unlock();
+                applied = false;
+                connection->onAsyncException(ex);
+            }
+
+            if (applied) {
+                config->inboundMemoryThrottleApplied = throttled;
+            } else {
+                config->inboundMemoryThrottleRetry.set(true);
+            }
+        }
+    };
+
+    class AsyncCallbackRunnable : public Runnable {
+    private:
+
         cms::AsyncCallback* callback;
+        Pointer<cms::AsyncCallback> owner;
+        Pointer<commands::Response> response;
 
     private:
 
-        AsyncResponseCallback(const AsyncResponseCallback&);
-        AsyncResponseCallback& operator= (const AsyncResponseCallback&);
+        AsyncCallbackRunnable(const AsyncCallbackRunnable&);
+        AsyncCallbackRunnable& operator= (const AsyncCallbackRunnable&);
 
     public:
 
-        AsyncResponseCallback(ConnectionConfig* config, cms::AsyncCallback* callback) :
-            ResponseCallback(), config(config), callback(callback) {
+        AsyncCallbackRunnable(cms::AsyncCallback* callback, const Pointer<cms::AsyncCallback>& owner,
+                              const Pointer<commands::Response>& response) :
+            Runnable(), callback(callback), owner(owner), response(response) {
         }
 
-        virtual ~AsyncResponseCallback() {
+        virtual ~AsyncCallbackRunnable() {}
+
+        virtual void run() {
+            try {
+                notify(this->callback, this->response);
+            } catch(...) {}
         }
 
-        virtual void onComplete(Pointer<commands::Response> response) {
+        /**
+         * Passes the outcome of a request to the callback waiting on it.
+         */
+        static void notify(cms::AsyncCallback* callback, const Pointer<commands::Response>& response) {
 
             commands::ExceptionResponse* exceptionResponse =
                 dynamic_cast<ExceptionResponse*> (response.get());
@@ -453,13 +665,50 @@ namespace core{
                 Exception ex = exceptionResponse->getException()->createExceptionObject();
                 const cms::CMSException* cmsError = dynamic_cast<const cms::CMSException*>(ex.getCause());
                 if (cmsError != NULL) {
-                    this->callback->onException(*cmsError);
+                    callback->onException(*cmsError);
                 } else {
                     BrokerException error = BrokerException(__FILE__, __LINE__, exceptionResponse->getException()->getMessage().c_str());
-                    this->callback->onException(error.convertToCMSException());
+                    callback->onException(error.convertToCMSException());
                 }
             } else {
-                this->callback->onSuccess();
+                callback->onSuccess();
+            }
+        }
+    };
+
+    class AsyncResponseCallback : public ResponseCallback {
+    private:
+
+        ConnectionConfig* config;
+        cms::AsyncCallback* callback;
+        ThreadPoolExecutor* completions;
+
+        // Keeps a shared callback alive until its Response has been delivered.
+        Pointer<cms::AsyncCallback> owner;
+
+    private:
+
+        AsyncResponseCallback(const AsyncResponseCallback&);
+        AsyncResponseCallback& operator= (const AsyncResponseCallback&);
+
+    public:
+
+        AsyncResponseCallback(ConnectionConfig* config, cms::AsyncCallback* callback, ThreadPoolExecutor* completions,
+                              const Pointer<cms::AsyncCallback>& owner = Pointer<cms::AsyncCallback>()) :
+            ResponseCallback(), config(config), callback(callback), completions(completions), owner(owner) {
+        }
+
+        virtual ~AsyncResponseCallback() {
+        }
+
+        virtual void onComplete(Pointer<commands::Response> response) {
+
+            // Keep the transport thread free of the cost of user code when a completion
+            // executor has been configured.
+            if (this->completions != NULL) {
+                this->completions->execute(new AsyncCallbackRunnable(this->callback, this->owner, response));
+            } else {
+                AsyncCallbackRunnable::notify(this->callback, response);
             }
         }
     };
@@ -506,9 +755,7 @@ ActiveMQConnection::~ActiveMQConnection() {
 void ActiveMQConnection::addDispatcher(const decaf::lang::Pointer<ConsumerId>& consumer, Dispatcher* dispatcher) {
 
     try {
-        synchronized(&this->config->dispatchers) {
-            this->config->dispatchers.put(consumer, dispatcher);
-        }
+        this->config->dispatchers.put(*consumer, dispatcher);
     }
     AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
 }
@@ -517,9 +764,7 @@ void ActiveMQConnection::addDispatcher(const decaf::lang::Pointer<ConsumerId>& c
 void ActiveMQConnection::removeDispatcher(const decaf::lang::Pointer<ConsumerId>& consumer) {
 
     try {
-        synchronized(&this->config->dispatchers) {
-            this->config->dispatchers.remove(consumer);
-        }
+        this->config->dispatchers.remove(*consumer);
     }
     AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
 }
@@ -591,6 +836,8 @@ void ActiveMQConnection::removeSession(Pointer<ActiveMQSessionKernel> session) {
             this->config->sessionsLock.writeLock().unlock();
             throw;
         }
+
+        checkInboundMemoryUsage();
     }
     AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
 }
@@ -761,6 +1008,21 @@ void ActiveMQConnection::close() {
             }
         }
 
+        // Results already queued are still delivered, the threads exit once they are done.
+        try {
+            synchronized(&this->config->completionExecutorLock) {
+                if (this->config->completionExecutor != NULL) {
+                    this->config->completionExecutor->shutdown();
+                }
+            }
+        } catch (Exception& error) {
+            if (!hasException) {
+                ex = error;
+                ex.setMark(__FILE__, __LINE__);
+                hasException = true;
+            }
+        }
+
         // Ensure that interruption processing completes in case any consumers were
         // still in the process when we closed them.
         try {
@@ -917,7 +1179,13 @@ void ActiveMQConnection::disconnect(long long lastDeliveredSequenceId) {
         bool hasException = false;
         exceptions::ActiveMQException e;
 
-        if (this->config->isConnectionInfoSentToBroker) {
+        // A failed or closed Transport can't carry the goodbye to the broker, which has
+        // already dropped us.  Check for that up front instead of letting each send
+        // throw an exception that close would then report.
+        bool transportUsable = !this->transportFailed.get() &&
+                               this->config->transport != NULL && !this->config->transport->isClosed();
+
+        if (this->config->isConnectionInfoSentToBroker && transportUsable) {
 
             try {
                 // Remove our ConnectionId from the Broker
@@ -1049,14 +1317,18 @@ void ActiveMQConnection::onCommand(const Pointer<Command> command) {
 
             Pointer<MessageDispatch> dispatch = command.dynamicCast<MessageDispatch>();
 
+            if (this->config->statisticsEnabled) {
+                dispatch->setArrivalTime(System::nanoTime());
+            }
+
             // Check first to see if we are recovering.
             waitForTransportInterruptionProcessingToComplete();
 
-            // Look up the dispatcher.
-            Dispatcher* dispatcher = NULL;
-            synchronized(&this->config->dispatchers) {
-
-                dispatcher = this->config->dispatchers.get(dispatch->getConsumerId());
+            // Look up the dispatcher, the guard keeps it from being removed until
+            // the dispatch is done.
+            {
+                ConnectionConfig::DispatcherMap::ReadGuard guard(this->config->dispatchers);
+                Dispatcher* dispatcher = guard.get(*dispatch->getConsumerId());
 
                 // If we have no registered dispatcher, the consumer was probably
                 // just closed.
@@ -1076,6 +1348,8 @@ void ActiveMQConnection::onCommand(const Pointer<Command> command) {
                 }
             }
 
+            checkInboundMemoryUsage();
+
         } else if (command->isProducerAck()) {
 
             ProducerAck* producerAck = dynamic_cast<ProducerAck*>(command.get());
@@ -1233,6 +1507,23 @@ void ActiveMQConnection::transportInterrupted() {
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQConnection::transportResumed() {
 
+    if (this->config->statisticsEnabled) {
+        this->config->attachStatistics();
+    }
+
+    // Sends outstanding on the old connection will never be acked by the broker.
+    this->config->sessionsLock.readLock().lock();
+    try {
+        std::auto_ptr<Iterator<Pointer<ActiveMQSessionKernel> > > sessions(this->config->activeSessions.iterator());
+        while (sessions->hasNext()) {
+            sessions->next()->resetProducerWindows();
+        }
+        this->config->sessionsLock.readLock().unlock();
+    } catch (Exception& ex) {
+        this->config->sessionsLock.readLock().unlock();
+        throw;
+    }
+
     synchronized(&this->config->transportListeners) {
         Pointer<Iterator<TransportListener*> > iter(this->config->transportListeners.iterator());
         while (iter->hasNext()) {
@@ -1299,7 +1590,31 @@ void ActiveMQConnection::asyncRequest(Pointer<Command> command, cms::AsyncCallba
 
         checkClosedOrFailed();
 
-        Pointer<ResponseCallback> callback(new AsyncResponseCallback(this->config, onComplete));
+        Pointer<ResponseCallback> callback(
+            new AsyncResponseCallback(this->config, onComplete, this->config->getCompletionExecutor()));
+        this->config->transport->asyncRequest(command, callback);
+    }
+    AMQ_CATCH_RETHROW(ActiveMQException)
+    AMQ_CATCH_EXCEPTION_CONVERT(IOException, ActiveMQException)
+    AMQ_CATCH_EXCEPTION_CONVERT(decaf::lang::exceptions::UnsupportedOperationException, ActiveMQException)
+    AMQ_CATCH_EXCEPTION_CONVERT(Exception, ActiveMQException)
+    AMQ_CATCHALL_THROW(ActiveMQException)
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnection::asyncRequest(Pointer<Command> command, const Pointer<cms::AsyncCallback>& onComplete) {
+
+    try {
+
+        if (onComplete == NULL) {
+            this->syncRequest(command);
+            return;
+        }
+
+        checkClosedOrFailed();
+
+        Pointer<ResponseCallback> callback(
+            new AsyncResponseCallback(this->config, onComplete.get(), this->config->getCompletionExecutor(), onComplete));
         this->config->transport->asyncRequest(command, callback);
     }
     AMQ_CATCH_RETHROW(ActiveMQException)
@@ -1611,6 +1926,16 @@ void ActiveMQConnection::setProducerWindowSize(unsigned int windowSize) {
     this->config->producerWindowSize = windowSize;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQConnection::isAdaptiveSendPacing() const {
+    return this->config->adaptiveSendPacing;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnection::setAdaptiveSendPacing(bool adaptiveSendPacing) {
+    this->config->adaptiveSendPacing = adaptiveSendPacing;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 long long ActiveMQConnection::getNextTempDestinationId() {
     return this->config->tempDestinationIds.getNextSequenceId();
@@ -1752,6 +2077,126 @@ void ActiveMQConnection::setNonBlockingRedelivery(bool nonBlockingRedelivery) {
     this->config->nonBlockingRedelivery = nonBlockingRedelivery;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQConnection::isLocalSelectorFiltering() const {
+    return this->config->localSelectorFiltering;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnection::setLocalSelectorFiltering(bool localSelectorFiltering) {
+    this->config->localSelectorFiltering = localSelectorFiltering;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQConnection::isAdaptivePrefetch() const {
+    return this->config->adaptivePrefetch;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnection::setAdaptivePrefetch(bool adaptivePrefetch) {
+    this->config->adaptivePrefetch = adaptivePrefetch;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ActiveMQConnection::getAdaptivePrefetchMaximum() const {
+    return this->config->adaptivePrefetchMaximum;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnection::setAdaptivePrefetchMaximum(int adaptivePrefetchMaximum) {
+    this->config->adaptivePrefetchMaximum = adaptivePrefetchMaximum;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long ActiveMQConnection::getAdaptivePrefetchMemoryLimit() const {
+    return this->config->adaptivePrefetchMemoryLimit;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnection::setAdaptivePrefetchMemoryLimit(long long adaptivePrefetchMemoryLimit) {
+    this->config->adaptivePrefetchMemoryLimit = adaptivePrefetchMemoryLimit;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long ActiveMQConnection::getInboundMemoryLimit() const {
+    return this->config->inboundMemoryLimit;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnection::setInboundMemoryLimit(long long inboundMemoryLimit) {
+    this->config->inboundMemoryLimit = inboundMemoryLimit;
+    this->config->inboundMemoryUsage->setLimit(inboundMemoryLimit > 0 ? inboundMemoryLimit : 0);
+    this->checkInboundMemoryUsage();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ActiveMQConnection::getPullPipelineDepth() const {
+    return this->config->pullPipelineDepth;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnection::setPullPipelineDepth(int pullPipelineDepth) {
+    this->config->pullPipelineDepth = pullPipelineDepth;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ActiveMQConnection::getSendPipelineDepth() const {
+    return this->config->sendPipelineDepth;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnection::setSendPipelineDepth(int sendPipelineDepth) {
+    this->config->sendPipelineDepth = sendPipelineDepth;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ActiveMQConnection::getCompletionExecutorThreads() const {
+    return this->config->completionExecutorThreads;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnection::setCompletionExecutorThreads(int completionExecutorThreads) {
+    this->config->completionExecutorThreads = completionExecutorThreads;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ActiveMQConnection::getCompletionQueueSize() const {
+    return this->config->completionQueueSize;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnection::setCompletionQueueSize(int completionQueueSize) {
+    this->config->completionQueueSize = completionQueueSize;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQConnection::isStatisticsEnabled() const {
+    return this->config->statisticsEnabled;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnection::setStatisticsEnabled(bool statisticsEnabled) {
+
+    synchronized(&this->config->mutex) {
+        if (statisticsEnabled && this->config->statistics == NULL) {
+            this->config->statistics.reset(new util::LatencyStatistics());
+        }
+
+        this->config->statisticsEnabled = statisticsEnabled;
+        this->config->attachStatistics();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<activemq::util::LatencyStatistics> ActiveMQConnection::getStatistics() const {
+
+    if (!this->config->statisticsEnabled) {
+        return Pointer<activemq::util::LatencyStatistics>();
+    }
+
+    return this->config->statistics;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 bool ActiveMQConnection::isOptimizeAcknowledge() const {
     return this->config->optimizeAcknowledge;
@@ -1918,3 +2363,70 @@ bool ActiveMQConnection::isDuplicate(Dispatcher* dispatcher, Pointer<commands::M
 void ActiveMQConnection::rollbackDuplicate(Dispatcher* dispatcher, Pointer<commands::Message> message) {
     this->config->connectionAudit.rollbackDuplicate(dispatcher, message);
 }
+
+////////////////////////////////////////////////////////////////////////////////
+long long ActiveMQConnection::reservePrefetchMemory(long long current, long long requested) {
+
+    synchronized(&this->config->prefetchMemoryMutex) {
+
+        long long others = this->config->reservedPrefetchMemory - current;
+        if (others < 0) {
+            others = 0;
+        }
+
+        long long granted = requested < 0 ? 0 : requested;
+        long long limit = this->config->adaptivePrefetchMemoryLimit;
+        if (limit > 0 && others + granted > limit) {
+            granted = limit > others ? limit - others : 0;
+        }
+
+        this->config->reservedPrefetchMemory = others + granted;
+        return granted;
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long ActiveMQConnection::getReservedPrefetchMemory() const {
+
+    synchronized(&this->config->prefetchMemoryMutex) {
+        return this->config->reservedPrefetchMemory;
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<activemq::util::MemoryUsage> ActiveMQConnection::getInboundMemoryUsage() const {
+    return this->config->inboundMemoryUsage;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQConnection::isInboundMemoryThrottled() const {
+    return this->config->inboundMemoryThrottled.get();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnection::checkInboundMemoryUsage() {
+
+    long long limit = this->config->inboundMemoryLimit;
+    bool changed = false;
+
+    if (!this->config->inboundMemoryThrottled.get()) {
+        if (limit > 0 && this->config->inboundMemoryUsage->isFull()) {
+            changed = this->config->inboundMemoryThrottled.compareAndSet(false, true);
+        }
+    } else if (limit <= 0 || this->config->inboundMemoryUsage->getUsage() <= (unsigned long long) limit / 2) {
+        changed = this->config->inboundMemoryThrottled.compareAndSet(true, false);
+    }
+
+    // The ConsumerControl commands are sent from the executor so that callers holding
+    // consumer locks never need the session locks.
+    if (changed || this->config->inboundMemoryThrottleRetry.compareAndSet(true, false)) {
+        try {
+            this->config->executor->execute(new InboundMemoryThrottleRunnable(this, this->config));
+        } catch (Exception& ex) {
+        }
+    }
+}
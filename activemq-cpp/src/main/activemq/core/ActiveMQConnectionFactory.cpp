@@ -89,10 +89,21 @@ namespace core{
         bool exclusiveConsumer;
         bool transactedIndividualAck;
         bool nonBlockingRedelivery;
+        bool localSelectorFiltering;
+        bool adaptivePrefetch;
+        int adaptivePrefetchMaximum;
+        long long adaptivePrefetchMemoryLimit;
+        long long inboundMemoryLimit;
+        int pullPipelineDepth;
+        int sendPipelineDepth;
+        int completionExecutorThreads;
+        int completionQueueSize;
+        bool statisticsEnabled;
         int compressionLevel;
         unsigned int sendTimeout;
         unsigned int closeTimeout;
         unsigned int producerWindowSize;
+        bool adaptiveSendPacing;
         int auditDepth;
         int auditMaximumProducerNumber;
         long long optimizeAcknowledgeTimeOut;
@@ -123,10 +134,21 @@ namespace core{
                             exclusiveConsumer(false),
                             transactedIndividualAck(false),
                             nonBlockingRedelivery(false),
+                            localSelectorFiltering(false),
+                            adaptivePrefetch(false),
+                            adaptivePrefetchMaximum(32766),
+                            adaptivePrefetchMemoryLimit(64 * 1024 * 1024),
+                            inboundMemoryLimit(0),
+                            pullPipelineDepth(1),
+                            sendPipelineDepth(0),
+                            completionExecutorThreads(0),
+                            completionQueueSize(1000),
+                            statisticsEnabled(false),
                             compressionLevel(-1),
                             sendTimeout(0),
                             closeTimeout(15000),
                             producerWindowSize(0),
+                            adaptiveSendPacing(false),
                             auditDepth(ActiveMQMessageAudit::DEFAULT_WINDOW_SIZE),
                             auditMaximumProducerNumber(ActiveMQMessageAudit::MAXIMUM_PRODUCER_COUNT),
                             optimizeAcknowledgeTimeOut(300),
@@ -214,6 +236,28 @@ namespace core{
                 properties->getProperty("connection.consumerFailoverRedeliveryWaitPeriod", Long::toString(consumerFailoverRedeliveryWaitPeriod)));
             this->nonBlockingRedelivery = Boolean::parseBoolean(
                 properties->getProperty("connection.nonBlockingRedelivery", Boolean::toString(nonBlockingRedelivery)));
+            this->localSelectorFiltering = Boolean::parseBoolean(
+                properties->getProperty("connection.localSelectorFiltering", Boolean::toString(localSelectorFiltering)));
+            this->adaptivePrefetch = Boolean::parseBoolean(
+                properties->getProperty("connection.adaptivePrefetch", Boolean::toString(adaptivePrefetch)));
+            this->adaptivePrefetchMaximum = Integer::parseInt(
+                properties->getProperty("connection.adaptivePrefetchMaximum", Integer::toString(adaptivePrefetchMaximum)));
+            this->adaptivePrefetchMemoryLimit = Long::parseLong(
+                properties->getProperty("connection.adaptivePrefetchMemoryLimit", Long::toString(adaptivePrefetchMemoryLimit)));
+            this->inboundMemoryLimit = Long::parseLong(
+                properties->getProperty("connection.inboundMemoryLimit", Long::toString(inboundMemoryLimit)));
+            this->pullPipelineDepth = Integer::parseInt(
+                properties->getProperty("connection.pullPipelineDepth", Integer::toString(pullPipelineDepth)));
+            this->sendPipelineDepth = Integer::parseInt(
+                properties->getProperty("connection.sendPipelineDepth", Integer::toString(sendPipelineDepth)));
+            this->completionExecutorThreads = Integer::parseInt(
+                properties->getProperty("connection.completionExecutorThreads", Integer::toString(completionExecutorThreads)));
+            this->completionQueueSize = Integer::parseInt(
+                properties->getProperty("connection.completionQueueSize", Integer::toString(completionQueueSize)));
+            this->statisticsEnabled = Boolean::parseBoolean(
+                properties->getProperty("connection.statisticsEnabled", Boolean::toString(statisticsEnabled)));
+            this->adaptiveSendPacing = Boolean::parseBoolean(
+                properties->getProperty("connection.adaptiveSendPacing", Boolean::toString(adaptiveSendPacing)));
             this->watchTopicAdvisories = Boolean::parseBoolean(
                 properties->getProperty("connection.watchTopicAdvisories", Boolean::toString(watchTopicAdvisories)));
 
@@ -395,6 +439,7 @@ void ActiveMQConnectionFactory::configureConnection(ActiveMQConnection* connecti
     connection->setSendTimeout(this->settings->sendTimeout);
     connection->setCloseTimeout(this->settings->closeTimeout);
     connection->setProducerWindowSize(this->settings->producerWindowSize);
+    connection->setAdaptiveSendPacing(this->settings->adaptiveSendPacing);
     connection->setPrefetchPolicy(this->settings->defaultPrefetchPolicy->clone());
     connection->setRedeliveryPolicy(this->settings->defaultRedeliveryPolicy->clone());
     connection->setMessagePrioritySupported(this->settings->messagePrioritySupported);
@@ -410,6 +455,16 @@ void ActiveMQConnectionFactory::configureConnection(ActiveMQConnection* connecti
     connection->setTransactedIndividualAck(this->settings->transactedIndividualAck);
     connection->setUseRetroactiveConsumer(this->settings->useRetroactiveConsumer);
     connection->setNonBlockingRedelivery(this->settings->nonBlockingRedelivery);
+    connection->setLocalSelectorFiltering(this->settings->localSelectorFiltering);
+    connection->setAdaptivePrefetch(this->settings->adaptivePrefetch);
+    connection->setAdaptivePrefetchMaximum(this->settings->adaptivePrefetchMaximum);
+    connection->setAdaptivePrefetchMemoryLimit(this->settings->adaptivePrefetchMemoryLimit);
+    connection->setInboundMemoryLimit(this->settings->inboundMemoryLimit);
+    connection->setPullPipelineDepth(this->settings->pullPipelineDepth);
+    connection->setSendPipelineDepth(this->settings->sendPipelineDepth);
+    connection->setCompletionExecutorThreads(this->settings->completionExecutorThreads);
+    connection->setCompletionQueueSize(this->settings->completionQueueSize);
+    connection->setStatisticsEnabled(this->settings->statisticsEnabled);
     connection->setConsumerFailoverRedeliveryWaitPeriod(this->settings->consumerFailoverRedeliveryWaitPeriod);
 
     if (this->settings->defaultListener) {
@@ -603,6 +658,16 @@ void ActiveMQConnectionFactory::setProducerWindowSize(unsigned int windowSize) {
     this->settings->producerWindowSize = windowSize;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQConnectionFactory::isAdaptiveSendPacing() const {
+    return this->settings->adaptiveSendPacing;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnectionFactory::setAdaptiveSendPacing(bool adaptiveSendPacing) {
+    this->settings->adaptiveSendPacing = adaptiveSendPacing;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 bool ActiveMQConnectionFactory::isMessagePrioritySupported() const {
     return this->settings->messagePrioritySupported;
@@ -673,6 +738,106 @@ void ActiveMQConnectionFactory::setNonBlockingRedelivery(bool nonBlockingRedeliv
     this->settings->nonBlockingRedelivery = nonBlockingRedelivery;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQConnectionFactory::isLocalSelectorFiltering() const {
+    return this->settings->localSelectorFiltering;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnectionFactory::setLocalSelectorFiltering(bool localSelectorFiltering) {
+    this->settings->localSelectorFiltering = localSelectorFiltering;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQConnectionFactory::isAdaptivePrefetch() const {
+    return this->settings->adaptivePrefetch;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnectionFactory::setAdaptivePrefetch(bool adaptivePrefetch) {
+    this->settings->adaptivePrefetch = adaptivePrefetch;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ActiveMQConnectionFactory::getAdaptivePrefetchMaximum() const {
+    return this->settings->adaptivePrefetchMaximum;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnectionFactory::setAdaptivePrefetchMaximum(int adaptivePrefetchMaximum) {
+    this->settings->adaptivePrefetchMaximum = adaptivePrefetchMaximum;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long ActiveMQConnectionFactory::getAdaptivePrefetchMemoryLimit() const {
+    return this->settings->adaptivePrefetchMemoryLimit;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnectionFactory::setAdaptivePrefetchMemoryLimit(long long adaptivePrefetchMemoryLimit) {
+    this->settings->adaptivePrefetchMemoryLimit = adaptivePrefetchMemoryLimit;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long ActiveMQConnectionFactory::getInboundMemoryLimit() const {
+    return this->settings->inboundMemoryLimit;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnectionFactory::setInboundMemoryLimit(long long inboundMemoryLimit) {
+    this->settings->inboundMemoryLimit = inboundMemoryLimit;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ActiveMQConnectionFactory::getPullPipelineDepth() const {
+    return this->settings->pullPipelineDepth;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnectionFactory::setPullPipelineDepth(int pullPipelineDepth) {
+    this->settings->pullPipelineDepth = pullPipelineDepth;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ActiveMQConnectionFactory::getSendPipelineDepth() const {
+    return this->settings->sendPipelineDepth;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnectionFactory::setSendPipelineDepth(int sendPipelineDepth) {
+    this->settings->sendPipelineDepth = sendPipelineDepth;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ActiveMQConnectionFactory::getCompletionExecutorThreads() const {
+    return this->settings->completionExecutorThreads;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnectionFactory::setCompletionExecutorThreads(int completionExecutorThreads) {
+    this->settings->completionExecutorThreads = completionExecutorThreads;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ActiveMQConnectionFactory::getCompletionQueueSize() const {
+    return this->settings->completionQueueSize;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnectionFactory::setCompletionQueueSize(int completionQueueSize) {
+    this->settings->completionQueueSize = completionQueueSize;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQConnectionFactory::isStatisticsEnabled() const {
+    return this->settings->statisticsEnabled;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnectionFactory::setStatisticsEnabled(bool statisticsEnabled) {
+    this->settings->statisticsEnabled = statisticsEnabled;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 bool ActiveMQConnectionFactory::isOptimizeAcknowledge() const {
     return this->settings->optimizeAcknowledge;
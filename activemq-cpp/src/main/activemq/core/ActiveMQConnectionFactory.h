@@ -409,6 +409,22 @@ namespace core{
          */
         void setProducerWindowSize(unsigned int windowSize);
 
+        /**
+         * @returns true if producers pace their sends to the rate the broker acknowledges them.
+         */
+        bool isAdaptiveSendPacing() const;
+
+        /**
+         * When enabled, and a producer window size is set, each producer estimates how quickly
+         * the broker drains its window from the ProducerAcks it receives.  Once the window is
+         * more than half full the producer spaces its sends at that rate instead of sending
+         * until the window is full and then stalling.  See util::ProducerWindow.
+         *
+         * @param adaptiveSendPacing
+         *      True to pace sends to the broker's drain rate.
+         */
+        void setAdaptiveSendPacing(bool adaptiveSendPacing);
+
         /**
          * @returns true if the Connections that this factory creates should support the
          * message based priority settings.
@@ -576,6 +592,181 @@ namespace core{
          */
         void setNonBlockingRedelivery(bool nonBlockingRedelivery);
 
+        /**
+         * Returns true if Consumers created from this Connection evaluate their message selector
+         * against each Message they receive and discard those that do not match.
+         *
+         * @return true if local selector filtering is enabled.
+         */
+        bool isLocalSelectorFiltering() const;
+
+        /**
+         * When true each Consumer and QueueBrowser compiles its message selector and evaluates it
+         * against every Message dispatched to it, Messages that do not match are acknowledged as
+         * delivered and never reach the application.  Useful when the broker cannot be relied upon
+         * to apply the selector, for instance for redelivered or prefetched Messages.
+         *
+         * @param localSelectorFiltering
+         *      The value to configure for local selector filtering.
+         */
+        void setLocalSelectorFiltering(bool localSelectorFiltering);
+
+        /**
+         * @returns true if consumers adjust their prefetch window to their measured processing rate.
+         */
+        bool isAdaptivePrefetch() const;
+
+        /**
+         * When enabled each consumer with a non-zero prefetch measures how quickly its messages are
+         * consumed and sends ConsumerControl updates to the broker to grow or shrink its prefetch
+         * window, bounded by the adaptivePrefetchMaximum and adaptivePrefetchMemoryLimit settings.
+         *
+         * @param adaptivePrefetch
+         *      True to enable adaptive prefetch sizing.
+         */
+        void setAdaptivePrefetch(bool adaptivePrefetch);
+
+        /**
+         * @returns the largest prefetch window an adaptive consumer will request.
+         */
+        int getAdaptivePrefetchMaximum() const;
+
+        /**
+         * Sets the largest prefetch window an adaptive consumer will request from the broker.
+         *
+         * @param adaptivePrefetchMaximum
+         *      The upper bound for adaptive prefetch windows.
+         */
+        void setAdaptivePrefetchMaximum(int adaptivePrefetchMaximum);
+
+        /**
+         * @returns the number of bytes the adaptive prefetch windows of this connection may cover.
+         */
+        long long getAdaptivePrefetchMemoryLimit() const;
+
+        /**
+         * Sets the number of bytes that the prefetch windows of all adaptive consumers on this
+         * connection may cover together, estimated from the average size of the messages each
+         * consumer receives.  Consumers are not allowed to grow their window past this limit.
+         *
+         * @param adaptivePrefetchMemoryLimit
+         *      The limit in bytes, zero or less means unlimited.
+         */
+        void setAdaptivePrefetchMemoryLimit(long long adaptivePrefetchMemoryLimit);
+
+        /**
+         * Gets the number of bytes of dispatched but not yet consumed Messages this Connection will
+         * buffer across all of its consumers before asking the broker to stop dispatching.
+         *
+         * @returns the inbound memory limit in bytes, zero or less means unlimited.
+         */
+        long long getInboundMemoryLimit() const;
+
+        /**
+         * Sets the number of bytes of dispatched but not yet consumed Messages this Connection will
+         * buffer across all of its consumers.  Once the limit is reached every consumer's prefetch
+         * is reduced to zero with a ConsumerControl, the prefetch is restored when the buffered
+         * amount drains below half of the limit.
+         *
+         * @param inboundMemoryLimit
+         *        The inbound memory limit in bytes, zero or less disables the limit.
+         */
+        void setInboundMemoryLimit(long long inboundMemoryLimit);
+
+        /**
+         * Gets the number of MessagePull requests a consumer with a prefetch of zero keeps
+         * outstanding with the broker.
+         *
+         * @returns the number of pulls kept in flight by pull consumers.
+         */
+        int getPullPipelineDepth() const;
+
+        /**
+         * Sets the number of MessagePull requests a consumer with a prefetch of zero keeps
+         * outstanding with the broker.  With the default of one each receive call issues its own
+         * pull and waits for the answer.  Larger values keep that many pulls in flight so a pull
+         * consumer is never holding more than this many messages while avoiding a round trip per
+         * message.  When used with failover the maxPullCacheSize should cover every pipelined pull.
+         *
+         * @param pullPipelineDepth
+         *        The number of pulls to keep outstanding, values below one are treated as one.
+         */
+        void setPullPipelineDepth(int pullPipelineDepth);
+
+        /**
+         * Gets the number of persistent sends a producer may have waiting on a response from the broker.
+         *
+         * @returns the send pipeline depth, zero when each send waits for its response.
+         */
+        int getSendPipelineDepth() const;
+
+        /**
+         * Sets the number of persistent sends a producer may have waiting on a response from the broker.
+         * With the default of zero a persistent send blocks until the broker has stored the message.
+         * Larger values let a send return once it is written, the producer blocks only when this many
+         * sends are unacknowledged or when it is flushed or closed.  A failed send is reported by the
+         * next call made on the producer.  Transacted sends and sends given an AsyncCallback are not affected.
+         *
+         * @param sendPipelineDepth
+         *        The number of unacknowledged sends allowed per producer, zero or less disables pipelining.
+         */
+        void setSendPipelineDepth(int sendPipelineDepth);
+
+        /**
+         * Gets the number of threads used to deliver the results of sends made with an AsyncCallback.
+         *
+         * @returns the number of completion threads, zero when callbacks run on the transport thread.
+         */
+        int getCompletionExecutorThreads() const;
+
+        /**
+         * Sets the number of threads used to deliver the results of sends made with an AsyncCallback.
+         * With the default of zero the callbacks are run by the thread that reads from the transport,
+         * so a slow callback delays every message and response that follows it.  When set the results
+         * are queued for a dedicated pool of threads instead, with a single thread the callbacks are
+         * run in the order the broker answered.  The value must be set before the first such send.
+         *
+         * @param completionExecutorThreads
+         *        The number of threads that run AsyncCallbacks, zero or less runs them on the transport thread.
+         */
+        void setCompletionExecutorThreads(int completionExecutorThreads);
+
+        /**
+         * Gets the number of AsyncCallback results that may wait for a completion thread.
+         *
+         * @returns the capacity of the completion queue.
+         */
+        int getCompletionQueueSize() const;
+
+        /**
+         * Sets the number of AsyncCallback results that may wait for a completion thread.  Once the
+         * queue is full the transport thread waits for room, which in turn stops the connection from
+         * reading more from the broker until the callbacks catch up.
+         *
+         * @param completionQueueSize
+         *        The capacity of the completion queue, values below one are treated as one.
+         */
+        void setCompletionQueueSize(int completionQueueSize);
+
+        /**
+         * Gets whether the Connection keeps latency statistics for itself and its Sessions and
+         * Consumers, see ActiveMQConnection::getStatistics().
+         *
+         * @returns true if latency statistics are kept.
+         */
+        bool isStatisticsEnabled() const;
+
+        /**
+         * Sets whether the Connection keeps latency statistics for itself and its Sessions and
+         * Consumers.  When disabled, the default, no timings are taken on the hot path.  The
+         * setting should be made before Sessions are created, existing Sessions and Consumers
+         * keep the setting they were created with.
+         *
+         * @param statisticsEnabled
+         *        true to keep latency statistics.
+         */
+        void setStatisticsEnabled(bool statisticsEnabled);
+
         /**
          * Gets the delay period for a consumer redelivery.
          *
@@ -227,3 +227,18 @@ bool ActiveMQConsumer::isOptimizeAcknowledge() const {
 void ActiveMQConsumer::setOptimizeAcknowledge(bool value) {
     this->config->kernel->setOptimizeAcknowledge(value);
 }
+
+////////////////////////////////////////////////////////////////////////////////
+const AdaptivePrefetchController* ActiveMQConsumer::getAdaptivePrefetchController() const {
+    return this->config->kernel->getAdaptivePrefetchController();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<LatencyStatistics> ActiveMQConsumer::getStatistics() const {
+    return this->config->kernel->getStatistics();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ActiveMQConsumer::getOutstandingPullCount() const {
+    return this->config->kernel->getOutstandingPullCount();
+}
@@ -23,6 +23,8 @@
 #include <cms/CMSException.h>
 
 #include <activemq/util/Config.h>
+#include <activemq/util/LatencyStatistics.h>
+#include <activemq/core/AdaptivePrefetchController.h>
 #include <activemq/core/kernels/ActiveMQConsumerKernel.h>
 #include <activemq/commands/ConsumerInfo.h>
 #include <activemq/core/RedeliveryPolicy.h>
@@ -170,6 +172,32 @@ namespace core{
          */
         void setOptimizeAcknowledge(bool value);
 
+        /**
+         * Gets the controller that sizes this consumer's prefetch window when adaptive
+         * prefetch is enabled on the Connection.  The controller's accessors report the
+         * window in use along with the rate and processing time it was derived from.
+         *
+         * @returns the AdaptivePrefetchController or NULL if the prefetch is fixed.
+         */
+        const AdaptivePrefetchController* getAdaptivePrefetchController() const;
+
+        /**
+         * Gets the latency statistics of this consumer, the time messages wait in the
+         * dispatch queue and the time spent in the MessageListener.  Everything recorded
+         * here is also added to the Session's statistics.
+         *
+         * @returns the consumer's statistics or NULL if the Connection does not keep statistics.
+         */
+        Pointer<util::LatencyStatistics> getStatistics() const;
+
+        /**
+         * Gets the number of MessagePull requests this consumer has sent that the broker has
+         * not yet answered, see ActiveMQConnection::setPullPipelineDepth.
+         *
+         * @returns the number of pulls currently outstanding.
+         */
+        int getOutstandingPullCount() const;
+
     };
 
 }}
@@ -0,0 +1,388 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ActiveMQMessageDemultiplexer.h"
+
+#include <activemq/commands/Message.h>
+#include <activemq/commands/ActiveMQDestination.h>
+#include <activemq/exceptions/ActiveMQException.h>
+#include <activemq/filter/MessageSelector.h>
+#include <activemq/util/ActiveMQMessageTransformation.h>
+#include <activemq/util/CMSExceptionSupport.h>
+
+#include <cms/IllegalStateException.h>
+#include <cms/MessageConsumer.h>
+#include <cms/Session.h>
+
+#include <decaf/lang/Pointer.h>
+#include <decaf/lang/exceptions/NullPointerException.h>
+#include <decaf/util/concurrent/Mutex.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::core;
+using namespace activemq::commands;
+using namespace activemq::exceptions;
+using namespace activemq::filter;
+using namespace activemq::util;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace activemq {
+namespace core {
+
+    class Route {
+    public:
+
+        Pointer<MessageSelector> selector;
+        cms::MessageListener* listener;
+
+        Route(Pointer<MessageSelector> selector, cms::MessageListener* listener) :
+            selector(selector), listener(listener) {
+        }
+
+        bool matches(const Message* message) const {
+            return this->selector == NULL || this->selector->matches(message);
+        }
+    };
+
+    class DemultiplexerImpl {
+    private:
+
+        DemultiplexerImpl(const DemultiplexerImpl&);
+        DemultiplexerImpl& operator=(const DemultiplexerImpl&);
+
+    public:
+
+        typedef std::vector<Route> RouteList;
+        typedef std::map<std::string, RouteList> RouteIndex;
+
+        // Recursive, held while routing so listeners can add or remove routes.
+        Mutex mutex;
+
+        // Routes keyed by the qualified name of an exact destination.
+        RouteIndex destinationRoutes;
+
+        // Routes that apply to messages from any destination.
+        RouteList anyDestinationRoutes;
+
+        cms::MessageListener* defaultListener;
+        int routeCount;
+        long long routed;
+        long long unrouted;
+        bool closed;
+
+        std::auto_ptr<cms::Session> session;
+        std::auto_ptr<cms::MessageConsumer> consumer;
+
+        DemultiplexerImpl() : mutex(),
+                              destinationRoutes(),
+                              anyDestinationRoutes(),
+                              defaultListener(NULL),
+                              routeCount(0),
+                              routed(0),
+                              unrouted(0),
+                              closed(false),
+                              session(),
+                              consumer() {
+        }
+
+        static std::string getRoutingKey(const cms::Destination* destination) {
+            const ActiveMQDestination* amqDestination = NULL;
+            bool cloned = ActiveMQMessageTransformation::transformDestination(destination, &amqDestination);
+            std::string key = amqDestination->toString();
+            if (cloned) {
+                delete amqDestination;
+            }
+            return key;
+        }
+
+        static int removeFrom(RouteList& routes, cms::MessageListener* listener) {
+            int removed = 0;
+            RouteList::iterator iter = routes.begin();
+            while (iter != routes.end()) {
+                if (iter->listener == listener) {
+                    iter = routes.erase(iter);
+                    removed++;
+                } else {
+                    ++iter;
+                }
+            }
+            return removed;
+        }
+
+        static void collect(const RouteList& routes, const Message* message,
+                            std::vector<cms::MessageListener*>& targets) {
+            RouteList::const_iterator iter = routes.begin();
+            for (; iter != routes.end(); ++iter) {
+                if (iter->matches(message)) {
+                    targets.push_back(iter->listener);
+                }
+            }
+        }
+
+        void checkClosed() const {
+            if (this->closed) {
+                throw cms::IllegalStateException("The Demultiplexer has been closed.");
+            }
+        }
+    };
+
+}}
+
+////////////////////////////////////////////////////////////////////////////////
+ActiveMQMessageDemultiplexer::ActiveMQMessageDemultiplexer(cms::Connection* connection,
+                                                           const cms::Destination* destination,
+                                                           const std::string& selector) :
+    cms::MessageListener(), cms::Closeable(), impl(new DemultiplexerImpl) {
+
+    if (connection == NULL) {
+        delete this->impl;
+        throw NullPointerException(__FILE__, __LINE__, "Connection passed was NULL");
+    }
+
+    if (destination == NULL) {
+        delete this->impl;
+        throw NullPointerException(__FILE__, __LINE__, "Destination passed was NULL");
+    }
+
+    try {
+        this->impl->session.reset(connection->createSession(cms::Session::AUTO_ACKNOWLEDGE));
+        this->impl->consumer.reset(this->impl->session->createConsumer(destination, selector));
+        this->impl->consumer->setMessageListener(this);
+    } catch (...) {
+        try {
+            if (this->impl->session.get() != NULL) {
+                this->impl->session->close();
+            }
+        } catch (...) {
+        }
+        delete this->impl;
+        throw;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ActiveMQMessageDemultiplexer::~ActiveMQMessageDemultiplexer() {
+    try {
+        close();
+    }
+    AMQ_CATCHALL_NOTHROW()
+
+    try {
+        delete this->impl;
+    }
+    AMQ_CATCHALL_NOTHROW()
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQMessageDemultiplexer::addListener(const cms::Destination* destination, cms::MessageListener* listener) {
+    this->addListener(destination, "", listener);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQMessageDemultiplexer::addListener(const std::string& selector, cms::MessageListener* listener) {
+    this->addListener(NULL, selector, listener);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQMessageDemultiplexer::addListener(const cms::Destination* destination,
+                                               const std::string& selector,
+                                               cms::MessageListener* listener) {
+
+    try {
+
+        if (listener == NULL) {
+            throw NullPointerException(__FILE__, __LINE__, "MessageListener passed was NULL");
+        }
+
+        // Compile outside the lock, an invalid selector throws here.
+        Pointer<MessageSelector> compiled(new MessageSelector(selector));
+        if (compiled->isEmpty()) {
+            compiled.reset(NULL);
+        }
+
+        Route route(compiled, listener);
+
+        synchronized(&this->impl->mutex) {
+            this->impl->checkClosed();
+
+            if (destination != NULL) {
+                std::string key = DemultiplexerImpl::getRoutingKey(destination);
+                this->impl->destinationRoutes[key].push_back(route);
+            } else {
+                this->impl->anyDestinationRoutes.push_back(route);
+            }
+
+            this->impl->routeCount++;
+        }
+    }
+    AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQMessageDemultiplexer::removeListener(cms::MessageListener* listener) {
+
+    int removed = 0;
+
+    synchronized(&this->impl->mutex) {
+        removed += DemultiplexerImpl::removeFrom(this->impl->anyDestinationRoutes, listener);
+
+        DemultiplexerImpl::RouteIndex::iterator iter = this->impl->destinationRoutes.begin();
+        while (iter != this->impl->destinationRoutes.end()) {
+            removed += DemultiplexerImpl::removeFrom(iter->second, listener);
+            if (iter->second.empty()) {
+                this->impl->destinationRoutes.erase(iter++);
+            } else {
+                ++iter;
+            }
+        }
+
+        this->impl->routeCount -= removed;
+    }
+
+    return removed > 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQMessageDemultiplexer::setDefaultListener(cms::MessageListener* listener) {
+    synchronized(&this->impl->mutex) {
+        this->impl->defaultListener = listener;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+cms::MessageListener* ActiveMQMessageDemultiplexer::getDefaultListener() const {
+    synchronized(&this->impl->mutex) {
+        return this->impl->defaultListener;
+    }
+
+    return NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ActiveMQMessageDemultiplexer::getRouteCount() const {
+    synchronized(&this->impl->mutex) {
+        return this->impl->routeCount;
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long ActiveMQMessageDemultiplexer::getRoutedCount() const {
+    synchronized(&this->impl->mutex) {
+        return this->impl->routed;
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long ActiveMQMessageDemultiplexer::getUnroutedCount() const {
+    synchronized(&this->impl->mutex) {
+        return this->impl->unrouted;
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQMessageDemultiplexer::isClosed() const {
+    synchronized(&this->impl->mutex) {
+        return this->impl->closed;
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQMessageDemultiplexer::close() {
+
+    try {
+
+        synchronized(&this->impl->mutex) {
+            if (this->impl->closed) {
+                return;
+            }
+
+            this->impl->closed = true;
+            this->impl->destinationRoutes.clear();
+            this->impl->anyDestinationRoutes.clear();
+            this->impl->defaultListener = NULL;
+            this->impl->routeCount = 0;
+        }
+
+        // Closing the session waits for any in progress onMessage call, so it must
+        // not be done while holding the routing lock.
+        this->impl->session->close();
+    }
+    AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQMessageDemultiplexer::onMessage(const cms::Message* message) {
+
+    const Message* amqMessage = dynamic_cast<const Message*>(message);
+    if (amqMessage == NULL) {
+        return;
+    }
+
+    synchronized(&this->impl->mutex) {
+
+        if (this->impl->closed) {
+            return;
+        }
+
+        // Gather the targets first so a listener may add or remove routes while
+        // the message is being delivered.
+        std::vector<cms::MessageListener*> targets;
+
+        if (amqMessage->getDestination() != NULL) {
+            DemultiplexerImpl::RouteIndex::const_iterator iter =
+                this->impl->destinationRoutes.find(amqMessage->getDestination()->toString());
+            if (iter != this->impl->destinationRoutes.end()) {
+                DemultiplexerImpl::collect(iter->second, amqMessage, targets);
+            }
+        }
+
+        DemultiplexerImpl::collect(this->impl->anyDestinationRoutes, amqMessage, targets);
+
+        if (targets.empty()) {
+            this->impl->unrouted++;
+            if (this->impl->defaultListener != NULL) {
+                targets.push_back(this->impl->defaultListener);
+            }
+        } else {
+            this->impl->routed++;
+        }
+
+        std::vector<cms::MessageListener*>::const_iterator target = targets.begin();
+        for (; target != targets.end(); ++target) {
+            try {
+                (*target)->onMessage(message);
+            }
+            AMQ_CATCHALL_NOTHROW()
+        }
+    }
+}
@@ -0,0 +1,194 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_CORE_ACTIVEMQMESSAGEDEMULTIPLEXER_H_
+#define _ACTIVEMQ_CORE_ACTIVEMQMESSAGEDEMULTIPLEXER_H_
+
+#include <activemq/util/Config.h>
+
+#include <cms/Closeable.h>
+#include <cms/CMSException.h>
+#include <cms/Connection.h>
+#include <cms/Destination.h>
+#include <cms/MessageListener.h>
+
+#include <string>
+
+namespace activemq {
+namespace core {
+
+    class DemultiplexerImpl;
+
+    /**
+     * Fans the messages of a single broker subscription out to any number of local
+     * MessageListener instances.
+     *
+     * Applications that listen to many related destinations would otherwise create a
+     * consumer for each one, and with it a ConsumerInfo, a prefetch buffer and a
+     * subscription on the broker.  The demultiplexer instead opens one consumer,
+     * typically on a wildcard topic such as "PRICES.>", and routes each message it
+     * receives to the listeners whose routing key matches.  A route is keyed by an
+     * exact destination, by a selector, or by both; routes keyed by destination are
+     * held in an index so the cost of routing a message does not grow with the number
+     * of destinations that have listeners.
+     *
+     * The demultiplexer uses its own AUTO_ACKNOWLEDGE session, so listeners are called
+     * from that session's dispatch thread one message at a time.  An exception thrown
+     * from one listener does not prevent the message reaching the other listeners that
+     * matched it.  Messages that match no route are passed to the default listener if
+     * one has been set, otherwise they are dropped.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API ActiveMQMessageDemultiplexer : public cms::MessageListener,
+                                                    public cms::Closeable {
+    private:
+
+        DemultiplexerImpl* impl;
+
+    private:
+
+        ActiveMQMessageDemultiplexer(const ActiveMQMessageDemultiplexer&);
+        ActiveMQMessageDemultiplexer& operator=(const ActiveMQMessageDemultiplexer&);
+
+    public:
+
+        /**
+         * Creates the demultiplexer and the single consumer it reads from.  Messages
+         * begin to flow once the Connection is started.
+         *
+         * @param connection
+         *      The Connection used to create the demultiplexer's Session.
+         * @param destination
+         *      The Destination to subscribe to, usually a wildcard topic.
+         * @param selector
+         *      Optional selector sent to the broker with the subscription.
+         *
+         * @throws CMSException if the session or consumer cannot be created.
+         */
+        ActiveMQMessageDemultiplexer(cms::Connection* connection,
+                                     const cms::Destination* destination,
+                                     const std::string& selector = "");
+
+        virtual ~ActiveMQMessageDemultiplexer();
+
+    public:
+
+        /**
+         * Routes messages sent to the given destination to the listener.
+         *
+         * @param destination
+         *      The exact destination whose messages are wanted.
+         * @param listener
+         *      The listener to call, the caller retains ownership.
+         *
+         * @throws CMSException if the demultiplexer is closed.
+         */
+        void addListener(const cms::Destination* destination, cms::MessageListener* listener);
+
+        /**
+         * Routes messages matching the given selector to the listener regardless of
+         * which destination they were sent to.
+         *
+         * @param selector
+         *      The JMS selector the messages must match.
+         * @param listener
+         *      The listener to call, the caller retains ownership.
+         *
+         * @throws InvalidSelectorException if the selector is not valid.
+         * @throws CMSException if the demultiplexer is closed.
+         */
+        void addListener(const std::string& selector, cms::MessageListener* listener);
+
+        /**
+         * Routes messages that were sent to the given destination and that match the
+         * selector to the listener.
+         *
+         * @param destination
+         *      The exact destination whose messages are wanted, or NULL for any.
+         * @param selector
+         *      The JMS selector the messages must match, or empty for all.
+         * @param listener
+         *      The listener to call, the caller retains ownership.
+         *
+         * @throws InvalidSelectorException if the selector is not valid.
+         * @throws CMSException if the demultiplexer is closed.
+         */
+        void addListener(const cms::Destination* destination, const std::string& selector,
+                         cms::MessageListener* listener);
+
+        /**
+         * Removes every route that delivers to the given listener.  Once this method
+         * returns the listener will not be called again.
+         *
+         * @param listener
+         *      The listener to remove.
+         *
+         * @returns true if at least one route was removed.
+         */
+        bool removeListener(cms::MessageListener* listener);
+
+        /**
+         * Sets the listener that receives messages matching no route, or NULL to
+         * drop them.
+         *
+         * @param listener
+         *      The listener to call, the caller retains ownership.
+         */
+        void setDefaultListener(cms::MessageListener* listener);
+
+        /**
+         * @returns the listener that receives messages matching no route.
+         */
+        cms::MessageListener* getDefaultListener() const;
+
+        /**
+         * @returns the number of routes currently registered.
+         */
+        int getRouteCount() const;
+
+        /**
+         * @returns the number of messages that were delivered to at least one route.
+         */
+        long long getRoutedCount() const;
+
+        /**
+         * @returns the number of messages that matched no route.
+         */
+        long long getUnroutedCount() const;
+
+        /**
+         * @returns true if close has been called.
+         */
+        bool isClosed() const;
+
+        /**
+         * Closes the consumer and session, all routes are removed.
+         *
+         * @throws CMSException if an error occurs while closing.
+         */
+        virtual void close();
+
+    public:  // MessageListener
+
+        virtual void onMessage(const cms::Message* message);
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_CORE_ACTIVEMQMESSAGEDEMULTIPLEXER_H_ */
@@ -206,6 +206,37 @@ namespace core{
         const Pointer<commands::ProducerId>& getProducerId() const {
             return this->kernel->getProducerId();
         }
+
+        /**
+         * Blocks until every pipelined send from this Producer has been acknowledged by
+         * the broker, see ActiveMQConnection::setSendPipelineDepth.
+         *
+         * @throws CMSException if an earlier send failed.
+         */
+        void flush() {
+            this->kernel->flush();
+        }
+
+        /**
+         * @returns the number of pipelined sends still waiting on the broker.
+         */
+        int getPendingSendCount() const {
+            Pointer<PipelinedSendWindow> window = this->kernel->getSendWindow();
+            return window != NULL ? window->getInFlightCount() : 0;
+        }
+
+        /**
+         * Gets the window of sends this Producer has made that the broker has not yet
+         * acknowledged, which holds the flow control statistics for the Producer such as
+         * its window utilization and the time it has spent blocked.
+         *
+         * @returns the producer window, or NULL if no producer window size is configured.
+         *
+         * @since 3.8.0
+         */
+        const util::ProducerWindow* getProducerWindow() const {
+            return this->kernel->getProducerWindow();
+        }
    };
 
 }}
@@ -193,6 +193,16 @@ namespace core{
             return this->kernel->getConnection();
         }
 
+        /**
+         * Gets the latency statistics of this Session, which hold the totals of all its
+         * Consumers and are themselves added to the Connection's statistics.
+         *
+         * @returns the Session's statistics or NULL if the Connection does not keep statistics.
+         */
+        Pointer<util::LatencyStatistics> getStatistics() const {
+            return this->kernel->getStatistics();
+        }
+
     };
 
 }}
@@ -25,11 +25,15 @@
 #include <activemq/core/SimplePriorityMessageDispatchChannel.h>
 #include <activemq/commands/ConsumerInfo.h>
 #include <activemq/threads/DedicatedTaskRunner.h>
+#include <decaf/lang/System.h>
+
+#include <algorithm>
 
 using namespace std;
 using namespace activemq;
 using namespace activemq::core;
 using namespace activemq::core::kernels;
+using namespace activemq::commands;
 using namespace activemq::threads;
 using namespace activemq::exceptions;
 using namespace decaf::lang;
@@ -38,13 +42,14 @@ using namespace decaf::util::concurrent;
 
 ////////////////////////////////////////////////////////////////////////////////
 ActiveMQSessionExecutor::ActiveMQSessionExecutor(ActiveMQSessionKernel* session) :
-    session(session), messageQueue(), taskRunner() {
+    session(session), messageQueue(), taskRunner(), redeliveries(), redeliverySequence(0), redeliveryMutex() {
 
     if (this->session->getConnection()->isMessagePrioritySupported()) {
         this->messageQueue.reset(new SimplePriorityMessageDispatchChannel());
     } else {
         this->messageQueue.reset(new FifoMessageDispatchChannel());
     }
+    this->messageQueue->setMemoryUsage(this->session->getConnection()->getInboundMemoryUsage());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -94,6 +99,123 @@ void ActiveMQSessionExecutor::executeFirst(const Pointer<MessageDispatch>& dispa
     this->wakeup();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionExecutor::executeAfterDelay(const Pointer<MessageDispatch>& dispatch, long long delay) {
+
+    Redelivery redelivery;
+    redelivery.dispatch = dispatch;
+    this->schedule(redelivery, delay);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionExecutor::startConsumerAfterDelay(const Pointer<ActiveMQConsumerKernel>& consumer, long long delay) {
+
+    Redelivery redelivery;
+    redelivery.consumer = consumer;
+    this->schedule(redelivery, delay);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionExecutor::schedule(const Redelivery& redelivery, long long delay) {
+
+    bool earliest = false;
+
+    synchronized(&redeliveryMutex) {
+        redeliveries.push_back(redelivery);
+        redeliveries.back().dueTime = System::nanoTime() / 1000000 + std::max(0LL, delay);
+        redeliveries.back().sequence = redeliverySequence++;
+        std::push_heap(redeliveries.begin(), redeliveries.end());
+
+        // Only a new head of the queue changes when the dispatch thread must next
+        // wake, any later entry is picked up when the head is handled.
+        earliest = redeliveries.front().sequence == redeliverySequence - 1;
+    }
+
+    if (earliest && messageQueue->isRunning()) {
+        this->wakeup();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ActiveMQSessionExecutor::getPendingRedeliveryCount() const {
+
+    int count = 0;
+    synchronized(&redeliveryMutex) {
+        count = (int) redeliveries.size();
+    }
+    return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long ActiveMQSessionExecutor::redeliverDue() {
+
+    while (true) {
+
+        Redelivery redelivery;
+
+        synchronized(&redeliveryMutex) {
+            if (redeliveries.empty()) {
+                return 0;
+            }
+
+            long long now = System::nanoTime() / 1000000;
+            if (redeliveries.front().dueTime > now) {
+                return redeliveries.front().dueTime - now;
+            }
+
+            std::pop_heap(redeliveries.begin(), redeliveries.end());
+            redelivery = redeliveries.back();
+            redeliveries.pop_back();
+        }
+
+        if (redelivery.dispatch != NULL) {
+            if (!messageQueue->isClosed()) {
+                messageQueue->enqueue(redelivery.dispatch);
+            }
+        } else {
+            try {
+                if (redelivery.consumer != NULL && !redelivery.consumer->isClosed()) {
+                    redelivery.consumer->start();
+                }
+            } catch (cms::CMSException& ex) {
+                Exception wrapper(ex.clone());
+                session->getConnection()->onAsyncException(wrapper);
+            }
+        }
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionExecutor::clearMessagesInProgress() {
+
+    // Delayed redeliveries are in progress as well, consumer restarts are kept since
+    // the consumers they belong to still need to resume.
+    synchronized(&redeliveryMutex) {
+        std::vector<Redelivery>::iterator end = redeliveries.begin();
+        for (std::vector<Redelivery>::iterator iter = redeliveries.begin(); iter != redeliveries.end(); ++iter) {
+            if (iter->dispatch == NULL) {
+                *end++ = *iter;
+            }
+        }
+        redeliveries.erase(end, redeliveries.end());
+        std::make_heap(redeliveries.begin(), redeliveries.end());
+    }
+
+    this->messageQueue->clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionExecutor::clear() {
+
+    synchronized(&redeliveryMutex) {
+        redeliveries.clear();
+    }
+
+    this->messageQueue->clear();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQSessionExecutor::wakeup() {
 
@@ -115,7 +237,7 @@ void ActiveMQSessionExecutor::start() {
 
     if (!messageQueue->isRunning()) {
         messageQueue->start();
-        if (hasUncomsumedMessages()) {
+        if (hasUncomsumedMessages() || getPendingRedeliveryCount() > 0) {
             this->wakeup();
         }
     }
@@ -156,6 +278,8 @@ void ActiveMQSessionExecutor::dispatch(const Pointer<MessageDispatch>& dispatch)
             consumer->dispatch(dispatch);
         }
 
+        this->session->getConnection()->checkInboundMemoryUsage();
+
     } catch (decaf::lang::Exception& ex) {
         ex.setMark(__FILE__, __LINE__);
     } catch (std::exception& ex) {
@@ -170,7 +294,10 @@ bool ActiveMQSessionExecutor::iterate() {
 
     try {
 
+        long long nextRedelivery = redeliverDue();
+
         if (this->session->iterateConsumers()) {
+            this->session->getConnection()->checkInboundMemoryUsage();
             return true;
         }
 
@@ -179,7 +306,22 @@ bool ActiveMQSessionExecutor::iterate() {
         Pointer<MessageDispatch> message = messageQueue->dequeueNoWait();
         if (message != NULL) {
             dispatch(message);
-            return !messageQueue->isEmpty();
+            if (!messageQueue->isEmpty()) {
+                return true;
+            }
+        }
+
+        // Nothing left to do right now, have the runner come back when the next
+        // delayed redelivery is due.
+        if (nextRedelivery > 0) {
+            Pointer<DedicatedTaskRunner> taskRunner;
+            synchronized(messageQueue.get()) {
+                taskRunner = this->taskRunner;
+            }
+
+            if (taskRunner != NULL) {
+                taskRunner->wakeupAfter(nextRedelivery);
+            }
         }
 
         return false;
@@ -23,13 +23,17 @@
 #include <activemq/commands/ConsumerId.h>
 #include <activemq/commands/MessageDispatch.h>
 #include <activemq/threads/Task.h>
-#include <activemq/threads/TaskRunner.h>
+#include <activemq/threads/DedicatedTaskRunner.h>
 #include <decaf/lang/Pointer.h>
+#include <decaf/util/concurrent/Mutex.h>
+
+#include <vector>
 
 namespace activemq{
 namespace core{
 namespace kernels{
     class ActiveMQSessionKernel;
+    class ActiveMQConsumerKernel;
 }
 
     using decaf::lang::Pointer;
@@ -40,10 +44,33 @@ namespace kernels{
     /**
      * Delegate dispatcher for a single session.  Contains a thread
      * to provide for asynchronous dispatching.
+     *
+     * Rolled back messages that are redelivered after a delay, and consumers that are
+     * restarted after one, wait in a time ordered queue that the same thread services,
+     * so delayed redelivery needs no timer thread or task object per rollback.
      */
     class AMQCPP_API ActiveMQSessionExecutor : activemq::threads::Task {
     private:
 
+        /**
+         * An entry in the redelivery queue, either a dispatch to put back on the
+         * session's queue or, when dispatch is NULL, a consumer to restart.
+         */
+        struct Redelivery {
+            long long dueTime;
+            long long sequence;
+            Pointer<MessageDispatch> dispatch;
+            Pointer<activemq::core::kernels::ActiveMQConsumerKernel> consumer;
+
+            Redelivery() : dueTime(0), sequence(0), dispatch(), consumer() {}
+
+            // Orders the heap so the earliest entry, and of those the first
+            // one added, is on top.
+            bool operator<(const Redelivery& other) const {
+                return dueTime != other.dueTime ? dueTime > other.dueTime : sequence > other.sequence;
+            }
+        };
+
         /** Session that is this executors parent. */
         activemq::core::kernels::ActiveMQSessionKernel* session;
 
@@ -51,7 +78,12 @@ namespace kernels{
         Pointer<MessageDispatchChannel> messageQueue;
 
         /** The Dispatcher TaskRunner */
-        Pointer<activemq::threads::TaskRunner> taskRunner;
+        Pointer<activemq::threads::DedicatedTaskRunner> taskRunner;
+
+        /** Heap of delayed redeliveries, guarded by redeliveryMutex. */
+        std::vector<Redelivery> redeliveries;
+        long long redeliverySequence;
+        mutable decaf::util::concurrent::Mutex redeliveryMutex;
 
     private:
 
@@ -87,9 +119,7 @@ namespace kernels{
         /**
          * Removes all messages in the Dispatch Channel so that non are delivered.
          */
-        virtual void clearMessagesInProgress() {
-            this->messageQueue->clear();
-        }
+        virtual void clearMessagesInProgress();
 
         /**
          * @return true if there are any pending messages in the dispatch channel.
@@ -138,9 +168,36 @@ namespace kernels{
         /**
          * Removes all queued messages and destroys them.
          */
-        virtual void clear() {
-            this->messageQueue->clear();
-        }
+        virtual void clear();
+
+        /**
+         * Puts the dispatch back on the session's queue once the delay has passed, it
+         * is then dispatched in order with the messages already queued.  Dispatches
+         * scheduled with the same delay are queued in the order they were given.
+         *
+         * @param data - The message to be dispatched again.
+         * @param delay - Time in milliseconds to hold the dispatch for.
+         *
+         * @since 3.8.0
+         */
+        void executeAfterDelay(const Pointer<MessageDispatch>& data, long long delay);
+
+        /**
+         * Starts the consumer once the delay has passed, if it is still open by then.
+         *
+         * @param consumer - The consumer to start.
+         * @param delay - Time in milliseconds before the consumer is started.
+         *
+         * @since 3.8.0
+         */
+        void startConsumerAfterDelay(const Pointer<activemq::core::kernels::ActiveMQConsumerKernel>& consumer, long long delay);
+
+        /**
+         * @returns the number of dispatches and consumer starts waiting for their delay.
+         *
+         * @since 3.8.0
+         */
+        int getPendingRedeliveryCount() const;
 
         /**
          * Iterates on the MessageDispatchChannel sending all pending messages
@@ -166,6 +223,14 @@ namespace kernels{
          */
         virtual void dispatch(const Pointer<MessageDispatch>& data);
 
+        void schedule(const Redelivery& redelivery, long long delay);
+
+        /**
+         * Handles every redelivery that is due, returns the time in milliseconds
+         * until the next one or zero if none are left waiting.
+         */
+        long long redeliverDue();
+
     };
 
 }}
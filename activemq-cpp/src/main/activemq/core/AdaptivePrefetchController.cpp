@@ -0,0 +1,221 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AdaptivePrefetchController.h"
+
+#include <decaf/lang/exceptions/IllegalArgumentException.h>
+
+using namespace activemq;
+using namespace activemq::core;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+const int AdaptivePrefetchController::DEFAULT_SAMPLE_SIZE = 32;
+const long long AdaptivePrefetchController::DEFAULT_SAMPLE_PERIOD = 1000;
+const long long AdaptivePrefetchController::DEFAULT_TARGET_DRAIN_TIME = 1000;
+
+////////////////////////////////////////////////////////////////////////////////
+AdaptivePrefetchController::AdaptivePrefetchController(int initialWindow, int minimumWindow,
+                                                       int maximumWindow, long long now) :
+    window(initialWindow),
+    minimumWindow(minimumWindow < 1 ? 1 : minimumWindow),
+    maximumWindow(maximumWindow),
+    sampleSize(DEFAULT_SAMPLE_SIZE),
+    samplePeriod(DEFAULT_SAMPLE_PERIOD),
+    targetDrainTime(DEFAULT_TARGET_DRAIN_TIME),
+    sampleStart(now),
+    sampleCount(0),
+    sampleProcessingTime(0),
+    sampleBytes(0),
+    consumptionRate(0),
+    averageProcessingTime(0),
+    averageMessageSize(0),
+    adjustments(0),
+    mutex() {
+
+    if (this->maximumWindow < this->minimumWindow) {
+        throw IllegalArgumentException(__FILE__, __LINE__,
+            "Maximum prefetch window cannot be smaller than the minimum window");
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+AdaptivePrefetchController::~AdaptivePrefetchController() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void AdaptivePrefetchController::messageConsumed(long long processingTime, int size) {
+
+    synchronized(&mutex) {
+        this->sampleCount++;
+        this->sampleProcessingTime += processingTime < 0 ? 0 : processingTime;
+        this->sampleBytes += size < 0 ? 0 : size;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool AdaptivePrefetchController::isSampleComplete(long long now) const {
+
+    synchronized(&mutex) {
+        return this->sampleCount >= this->sampleSize ||
+               (this->sampleCount > 0 && now - this->sampleStart >= this->samplePeriod);
+    }
+
+    return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int AdaptivePrefetchController::evaluate(long long now) {
+
+    synchronized(&mutex) {
+
+        int proposed = this->window;
+
+        if (this->sampleCount > 0) {
+
+            long long elapsed = now - this->sampleStart;
+            if (elapsed < 1) {
+                elapsed = 1;
+            }
+
+            this->consumptionRate = (double) this->sampleCount * 1000.0 / (double) elapsed;
+            this->averageProcessingTime = (double) this->sampleProcessingTime / (double) this->sampleCount;
+
+            long long sampleMessageSize = this->sampleBytes / this->sampleCount;
+            if (this->averageMessageSize == 0) {
+                this->averageMessageSize = sampleMessageSize;
+            } else {
+                this->averageMessageSize = (this->averageMessageSize * 7 + sampleMessageSize) / 8;
+            }
+
+            // Messages the consumer could process in the drain time if kept busy.
+            double desired = (double) this->maximumWindow;
+            if (this->averageProcessingTime > 0) {
+                desired = ((double) this->targetDrainTime * 1000.0) / this->averageProcessingTime;
+            }
+
+            if (desired > (double) this->maximumWindow) {
+                proposed = this->maximumWindow;
+            } else if (desired < (double) this->minimumWindow) {
+                proposed = this->minimumWindow;
+            } else {
+                proposed = (int) desired;
+            }
+
+            // Ignore changes of less than a quarter unless the window is out of bounds.
+            bool inBounds = this->window >= this->minimumWindow && this->window <= this->maximumWindow;
+            int delta = proposed > this->window ? proposed - this->window : this->window - proposed;
+            if (inBounds && delta * 4 < this->window) {
+                proposed = this->window;
+            }
+        }
+
+        this->sampleStart = now;
+        this->sampleCount = 0;
+        this->sampleProcessingTime = 0;
+        this->sampleBytes = 0;
+
+        return proposed;
+    }
+
+    return this->window;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void AdaptivePrefetchController::setWindow(int window) {
+
+    synchronized(&mutex) {
+        if (window != this->window) {
+            this->window = window;
+            this->adjustments++;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int AdaptivePrefetchController::getWindow() const {
+
+    synchronized(&mutex) {
+        return this->window;
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long AdaptivePrefetchController::getTargetDrainTime() const {
+
+    synchronized(&mutex) {
+        return this->targetDrainTime;
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void AdaptivePrefetchController::setTargetDrainTime(long long value) {
+
+    if (value <= 0) {
+        throw IllegalArgumentException(__FILE__, __LINE__, "Target drain time must be positive");
+    }
+
+    synchronized(&mutex) {
+        this->targetDrainTime = value;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+double AdaptivePrefetchController::getConsumptionRate() const {
+
+    synchronized(&mutex) {
+        return this->consumptionRate;
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+double AdaptivePrefetchController::getAverageProcessingTime() const {
+
+    synchronized(&mutex) {
+        return this->averageProcessingTime;
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long AdaptivePrefetchController::getAverageMessageSize() const {
+
+    synchronized(&mutex) {
+        return this->averageMessageSize;
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long AdaptivePrefetchController::getAdjustmentCount() const {
+
+    synchronized(&mutex) {
+        return this->adjustments;
+    }
+
+    return 0;
+}
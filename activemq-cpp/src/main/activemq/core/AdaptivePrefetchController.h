@@ -0,0 +1,202 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_CORE_ADAPTIVEPREFETCHCONTROLLER_H_
+#define _ACTIVEMQ_CORE_ADAPTIVEPREFETCHCONTROLLER_H_
+
+#include <activemq/util/Config.h>
+
+#include <decaf/util/concurrent/Mutex.h>
+
+namespace activemq {
+namespace core {
+
+    /**
+     * Computes the prefetch window for a single consumer from how quickly it consumes
+     * the messages it is sent.
+     *
+     * The consumer reports the time spent processing each message, either the time
+     * taken by its MessageListener or the time between a synchronous receive returning
+     * and the next call.  Once a sample has been gathered the controller estimates how
+     * many messages the consumer can process in the target drain time and proposes that
+     * as the new window.  A fast consumer is therefore given a large window so it is not
+     * left waiting for the broker to refill it, while a slow one is held to a small
+     * window so it does not hoard messages other consumers could be processing.
+     *
+     * Small changes are ignored so that the broker is not sent a ConsumerControl for
+     * every sample.  The controller only computes windows, the consumer is responsible
+     * for applying them.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API AdaptivePrefetchController {
+    public:
+
+        /**
+         * Default number of messages that make up a sample.
+         */
+        static const int DEFAULT_SAMPLE_SIZE;
+
+        /**
+         * Default time in milliseconds after which a smaller sample is evaluated.
+         */
+        static const long long DEFAULT_SAMPLE_PERIOD;
+
+        /**
+         * Default time in milliseconds of work the window should hold.
+         */
+        static const long long DEFAULT_TARGET_DRAIN_TIME;
+
+    private:
+
+        int window;
+        int minimumWindow;
+        int maximumWindow;
+        int sampleSize;
+        long long samplePeriod;
+        long long targetDrainTime;
+
+        long long sampleStart;
+        int sampleCount;
+        long long sampleProcessingTime;
+        long long sampleBytes;
+
+        double consumptionRate;
+        double averageProcessingTime;
+        long long averageMessageSize;
+        long long adjustments;
+
+        mutable decaf::util::concurrent::Mutex mutex;
+
+    private:
+
+        AdaptivePrefetchController(const AdaptivePrefetchController&);
+        AdaptivePrefetchController& operator=(const AdaptivePrefetchController&);
+
+    public:
+
+        /**
+         * Creates a new controller.
+         *
+         * @param initialWindow
+         *      The prefetch the consumer was created with.
+         * @param minimumWindow
+         *      The smallest window that will be proposed, at least one.
+         * @param maximumWindow
+         *      The largest window that will be proposed.
+         * @param now
+         *      The current time in milliseconds, the start of the first sample.
+         */
+        AdaptivePrefetchController(int initialWindow, int minimumWindow, int maximumWindow, long long now);
+
+        virtual ~AdaptivePrefetchController();
+
+        /**
+         * Records that a message was consumed.
+         *
+         * @param processingTime
+         *      Time in microseconds the consumer spent on the message.
+         * @param size
+         *      The size of the message in bytes.
+         */
+        void messageConsumed(long long processingTime, int size);
+
+        /**
+         * @param now
+         *      The current time in milliseconds.
+         *
+         * @returns true if enough has been recorded for evaluate to be called.
+         */
+        bool isSampleComplete(long long now) const;
+
+        /**
+         * Computes the window for the sample just completed and starts a new sample.
+         * The result is not applied, call setWindow once the consumer has decided on
+         * the window it will use.
+         *
+         * @param now
+         *      The current time in milliseconds.
+         *
+         * @returns the proposed window, equal to the current window if no change is needed.
+         */
+        int evaluate(long long now);
+
+        /**
+         * Sets the window the consumer is now using.
+         *
+         * @param window
+         *      The new prefetch window.
+         */
+        void setWindow(int window);
+
+        /**
+         * @returns the prefetch window currently in use.
+         */
+        int getWindow() const;
+
+        /**
+         * @returns the smallest window that will be proposed.
+         */
+        int getMinimumWindow() const {
+            return this->minimumWindow;
+        }
+
+        /**
+         * @returns the largest window that will be proposed.
+         */
+        int getMaximumWindow() const {
+            return this->maximumWindow;
+        }
+
+        /**
+         * @returns the time in milliseconds of work the window should hold.
+         */
+        long long getTargetDrainTime() const;
+
+        /**
+         * Sets the time in milliseconds of work the window should hold.
+         *
+         * @param value
+         *      The target drain time, must be positive.
+         */
+        void setTargetDrainTime(long long value);
+
+        /**
+         * @returns the number of messages per second consumed in the last sample.
+         */
+        double getConsumptionRate() const;
+
+        /**
+         * @returns the mean time in microseconds spent processing a message in the last sample.
+         */
+        double getAverageProcessingTime() const;
+
+        /**
+         * @returns the mean size in bytes of the messages seen so far.
+         */
+        long long getAverageMessageSize() const;
+
+        /**
+         * @returns the number of times the window has been changed.
+         */
+        long long getAdjustmentCount() const;
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_CORE_ADAPTIVEPREFETCHCONTROLLER_H_ */
@@ -0,0 +1,408 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_CORE_CONSUMERROUTINGTABLE_H_
+#define _ACTIVEMQ_CORE_CONSUMERROUTINGTABLE_H_
+
+#include <activemq/util/Config.h>
+#include <activemq/commands/ConsumerId.h>
+
+#include <decaf/lang/Thread.h>
+#include <decaf/util/concurrent/Concurrent.h>
+#include <decaf/util/concurrent/Mutex.h>
+#include <decaf/util/concurrent/atomic/AtomicInteger.h>
+#include <decaf/util/concurrent/atomic/AtomicReference.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace activemq {
+namespace core {
+
+    /**
+     * Maps the ConsumerIds of a single Connection to the object that handles their message
+     * dispatches.  Entries are found by hashing the numeric session and consumer values of
+     * the id so a lookup never compares the connection id string.
+     *
+     * The table is read-mostly, readers never take a lock.  Each update copies the current
+     * table and publishes the copy, the old copy is retired and deleted once no reader is
+     * left in the table so publishing never waits.  A reader can hold a ReadGuard for as long
+     * as it uses the value it found, a remove or clear does not return until the readers that
+     * were in the table are done which lets the caller destroy the removed object safely.  That
+     * wait blocks on a monitor the last reader signals and does not count ReadGuards held by
+     * the waiting thread itself.
+     *
+     * @since 3.8.0
+     */
+    template <typename V>
+    class ConsumerRoutingTable {
+    private:
+
+        struct Entry {
+            long long sessionId;
+            long long value;
+            V target;
+            bool used;
+
+            Entry() : sessionId(0), value(0), target(), used(false) {}
+        };
+
+        struct Snapshot {
+            std::vector<Entry> entries;
+            std::size_t mask;
+            int count;
+
+            Snapshot(std::size_t capacity) : entries(capacity), mask(capacity - 1), count(0) {}
+
+            std::size_t indexOf(long long sessionId, long long value) const {
+                unsigned long long hash = (unsigned long long) value * 0x9E3779B97F4A7C15ULL;
+                hash ^= (unsigned long long) sessionId * 0xC2B2AE3D27D4EB4FULL;
+                return (std::size_t) (hash >> 32) & mask;
+            }
+
+            const Entry* find(long long sessionId, long long value) const {
+                std::size_t index = indexOf(sessionId, value);
+                while (entries[index].used) {
+                    if (entries[index].value == value && entries[index].sessionId == sessionId) {
+                        return &entries[index];
+                    }
+                    index = (index + 1) & mask;
+                }
+                return NULL;
+            }
+
+            bool insert(long long sessionId, long long value, const V& target) {
+                std::size_t index = indexOf(sessionId, value);
+                while (entries[index].used) {
+                    if (entries[index].value == value && entries[index].sessionId == sessionId) {
+                        entries[index].target = target;
+                        return false;
+                    }
+                    index = (index + 1) & mask;
+                }
+                entries[index].sessionId = sessionId;
+                entries[index].value = value;
+                entries[index].target = target;
+                entries[index].used = true;
+                count++;
+                return true;
+            }
+        };
+
+        static const int MAX_READER_SLOTS = 16;
+
+        decaf::util::concurrent::Mutex writeLock;
+        decaf::util::concurrent::atomic::AtomicReference<Snapshot> current;
+        decaf::util::concurrent::atomic::AtomicInteger readers;
+        decaf::util::concurrent::atomic::AtomicReference<decaf::lang::Thread> readerThreads[MAX_READER_SLOTS];
+
+        // Readers that find every slot taken are recorded here instead.
+        decaf::util::concurrent::Mutex overflowLock;
+        std::vector<decaf::lang::Thread*> overflowThreads;
+
+        // Snapshots replaced while readers were in the table, guarded by the write lock.
+        std::vector<Snapshot*> retired;
+        decaf::util::concurrent::atomic::AtomicInteger retiredCount;
+
+        // Removes wait here for the readers to leave, readers only signal it while
+        // someone is waiting.
+        decaf::util::concurrent::Mutex drained;
+        decaf::util::concurrent::atomic::AtomicInteger drainWaiters;
+
+    private:
+
+        ConsumerRoutingTable(const ConsumerRoutingTable&);
+        ConsumerRoutingTable& operator= (const ConsumerRoutingTable&);
+
+    public:
+
+        /**
+         * Marks a section in which values read from the table remain valid, the guard must
+         * not outlive the table it was created from.
+         */
+        class ReadGuard {
+        private:
+
+            ConsumerRoutingTable& table;
+            Snapshot* snapshot;
+            int slot;
+
+        private:
+
+            ReadGuard(const ReadGuard&);
+            ReadGuard& operator= (const ReadGuard&);
+
+        public:
+
+            ReadGuard(ConsumerRoutingTable& table) : table(table), snapshot(NULL), slot(-1) {
+                table.readers.incrementAndGet();
+
+                decaf::lang::Thread* thread = decaf::lang::Thread::currentThread();
+                for (int i = 0; i < MAX_READER_SLOTS; ++i) {
+                    if (table.readerThreads[i].compareAndSet(NULL, thread)) {
+                        slot = i;
+                        break;
+                    }
+                }
+
+                if (slot < 0) {
+                    synchronized(&table.overflowLock) {
+                        table.overflowThreads.push_back(thread);
+                    }
+                }
+
+                snapshot = table.current.get();
+            }
+
+            ~ReadGuard() {
+                if (slot >= 0) {
+                    table.readerThreads[slot].set(NULL);
+                } else {
+                    synchronized(&table.overflowLock) {
+                        std::vector<decaf::lang::Thread*>& threads = table.overflowThreads;
+                        threads.erase(std::find(threads.begin(), threads.end(), decaf::lang::Thread::currentThread()));
+                    }
+                }
+
+                if (table.readers.decrementAndGet() == 0 && table.retiredCount.get() > 0) {
+                    table.reclaim();
+                }
+
+                if (table.drainWaiters.get() > 0) {
+                    synchronized(&table.drained) {
+                        table.drained.notifyAll();
+                    }
+                }
+            }
+
+            /**
+             * @returns the value mapped to the given id or a default constructed value.
+             */
+            V get(const commands::ConsumerId& id) const {
+                const Entry* entry = snapshot->find(id.getSessionId(), id.getValue());
+                return entry != NULL ? entry->target : V();
+            }
+        };
+
+    public:
+
+        ConsumerRoutingTable() : writeLock(), current(new Snapshot(8)), readers(), readerThreads(),
+                                 overflowLock(), overflowThreads(), retired(), retiredCount(),
+                                 drained(), drainWaiters() {}
+
+        virtual ~ConsumerRoutingTable() {
+            for (std::size_t i = 0; i < retired.size(); ++i) {
+                delete retired[i];
+            }
+            delete current.get();
+        }
+
+        /**
+         * Finds the value mapped to the given id, callers that must use the value after a
+         * concurrent remove could return should hold a ReadGuard instead.
+         *
+         * @returns the value mapped to the given id or a default constructed value.
+         */
+        V get(const commands::ConsumerId& id) {
+            ReadGuard guard(*this);
+            return guard.get(id);
+        }
+
+        /**
+         * Maps the id to the given value replacing any existing mapping.  When a mapping is
+         * replaced this waits for readers like remove does, adding a new one never waits.
+         */
+        void put(const commands::ConsumerId& id, const V& target) {
+            bool replaced = false;
+            synchronized(&writeLock) {
+                Snapshot* snapshot = copy(current.get(), current.get()->count + 1);
+                replaced = !snapshot->insert(id.getSessionId(), id.getValue(), target);
+                publish(snapshot);
+            }
+
+            if (replaced) {
+                awaitReaders();
+            }
+        }
+
+        /**
+         * Removes the mapping for the given id.  On return no reader other than the caller
+         * can still be using the removed value.
+         *
+         * @returns true if there was a mapping for the id.
+         */
+        bool remove(const commands::ConsumerId& id) {
+            bool removed = false;
+            synchronized(&writeLock) {
+                Snapshot* old = current.get();
+                if (old->find(id.getSessionId(), id.getValue()) == NULL) {
+                    return false;
+                }
+
+                Snapshot* snapshot = new Snapshot(capacityFor(old->count - 1));
+                for (std::size_t i = 0; i < old->entries.size(); ++i) {
+                    const Entry& entry = old->entries[i];
+                    if (entry.used && (entry.value != id.getValue() || entry.sessionId != id.getSessionId())) {
+                        snapshot->insert(entry.sessionId, entry.value, entry.target);
+                    }
+                }
+                publish(snapshot);
+                removed = true;
+            }
+
+            if (removed) {
+                awaitReaders();
+            }
+
+            return removed;
+        }
+
+        /**
+         * Removes every mapping from the table.  On return no reader other than the caller
+         * can still be using a removed value.
+         */
+        void clear() {
+            synchronized(&writeLock) {
+                publish(new Snapshot(8));
+            }
+
+            awaitReaders();
+        }
+
+        /**
+         * @returns the number of ids currently mapped.
+         */
+        int size() const {
+            return current.get()->count;
+        }
+
+        /**
+         * @returns a copy of every value currently in the table.
+         */
+        std::vector<V> values() {
+            std::vector<V> result;
+            ReadGuard guard(*this);
+            const Snapshot* snapshot = current.get();
+            for (std::size_t i = 0; i < snapshot->entries.size(); ++i) {
+                if (snapshot->entries[i].used) {
+                    result.push_back(snapshot->entries[i].target);
+                }
+            }
+            return result;
+        }
+
+    private:
+
+        static std::size_t capacityFor(int count) {
+            std::size_t capacity = 8;
+            while (capacity < (std::size_t) count * 2) {
+                capacity <<= 1;
+            }
+            return capacity;
+        }
+
+        static Snapshot* copy(const Snapshot* source, int count) {
+            Snapshot* snapshot = new Snapshot(capacityFor(count));
+            for (std::size_t i = 0; i < source->entries.size(); ++i) {
+                const Entry& entry = source->entries[i];
+                if (entry.used) {
+                    snapshot->insert(entry.sessionId, entry.value, entry.target);
+                }
+            }
+            return snapshot;
+        }
+
+        /**
+         * Makes the new snapshot visible and retires the old one, it is deleted here if no
+         * reader is in the table or else by the last reader to leave.  Must be called with
+         * the write lock held.
+         */
+        void publish(Snapshot* snapshot) {
+            retired.push_back(current.getAndSet(snapshot));
+            retiredCount.incrementAndGet();
+
+            if (readers.get() == 0) {
+                reclaim();
+            }
+        }
+
+        /**
+         * Deletes the retired snapshots if no reader is in the table.  A reader that enters
+         * after the check can only see the current snapshot which is never retired here.
+         */
+        void reclaim() {
+            synchronized(&writeLock) {
+                if (readers.get() == 0) {
+                    for (std::size_t i = 0; i < retired.size(); ++i) {
+                        delete retired[i];
+                    }
+                    retired.clear();
+                    retiredCount.set(0);
+                }
+            }
+        }
+
+        /**
+         * @returns the number of ReadGuards the calling thread holds on this table.
+         */
+        int ownReaders() {
+            decaf::lang::Thread* thread = decaf::lang::Thread::currentThread();
+
+            int own = 0;
+            for (int i = 0; i < MAX_READER_SLOTS; ++i) {
+                if (readerThreads[i].get() == thread) {
+                    own++;
+                }
+            }
+
+            synchronized(&overflowLock) {
+                own += (int) std::count(overflowThreads.begin(), overflowThreads.end(), thread);
+            }
+
+            return own;
+        }
+
+        /**
+         * Blocks until every reader other than the calling thread has left the table, the
+         * write lock must not be held so other updates can go ahead while this waits.
+         */
+        void awaitReaders() {
+            if (readers.get() == 0) {
+                return;
+            }
+
+            int own = ownReaders();
+
+            synchronized(&drained) {
+                drainWaiters.incrementAndGet();
+                try {
+                    while (readers.get() > own) {
+                        drained.wait();
+                    }
+                } catch (...) {
+                    drainWaiters.decrementAndGet();
+                    throw;
+                }
+                drainWaiters.decrementAndGet();
+            }
+        }
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_CORE_CONSUMERROUTINGTABLE_H_ */
@@ -17,28 +17,36 @@
 
 #include "FifoMessageDispatchChannel.h"
 
+#include <activemq/exceptions/ActiveMQException.h>
+
 using namespace std;
 using namespace activemq;
 using namespace activemq::core;
 using namespace activemq::commands;
 using namespace activemq::exceptions;
+using namespace activemq::util;
 using namespace decaf;
 using namespace decaf::lang;
 using namespace decaf::util;
 using namespace decaf::util::concurrent;
 
 ////////////////////////////////////////////////////////////////////////////////
-FifoMessageDispatchChannel::FifoMessageDispatchChannel() : closed(false), running(false), channel() {
+FifoMessageDispatchChannel::FifoMessageDispatchChannel() : closed(false), running(false), channel(), memoryUsage(), memoryHeld(0) {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 FifoMessageDispatchChannel::~FifoMessageDispatchChannel() {
+    try {
+        releaseAll();
+    }
+    AMQ_CATCHALL_NOTHROW()
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 void FifoMessageDispatchChannel::enqueue(const Pointer<MessageDispatch>& message) {
     synchronized(&channel) {
         channel.addLast(message);
+        charge(message);
         channel.notify();
     }
 }
@@ -47,6 +55,7 @@ void FifoMessageDispatchChannel::enqueue(const Pointer<MessageDispatch>& message
 void FifoMessageDispatchChannel::enqueueFirst(const Pointer<MessageDispatch>& message) {
     synchronized(&channel) {
         channel.addFirst(message);
+        charge(message);
         channel.notify();
     }
 }
@@ -78,7 +87,7 @@ Pointer<MessageDispatch> FifoMessageDispatchChannel::dequeue(long long timeout)
             return Pointer<MessageDispatch>();
         }
 
-        return channel.pop();
+        return release(channel.pop());
     }
 
     return Pointer<MessageDispatch>();
@@ -90,7 +99,7 @@ Pointer<MessageDispatch> FifoMessageDispatchChannel::dequeueNoWait() {
         if (closed || !running || channel.isEmpty()) {
             return Pointer<MessageDispatch>();
         }
-        return channel.pop();
+        return release(channel.pop());
     }
 
     return Pointer<MessageDispatch>();
@@ -141,6 +150,7 @@ void FifoMessageDispatchChannel::close() {
 void FifoMessageDispatchChannel::clear() {
     synchronized(&channel) {
         channel.clear();
+        releaseAll();
     }
 }
 
@@ -160,7 +170,62 @@ std::vector<Pointer<MessageDispatch> > FifoMessageDispatchChannel::removeAll() {
     synchronized(&channel) {
         result = channel.toArray();
         channel.clear();
+        releaseAll();
     }
 
     return result;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+void FifoMessageDispatchChannel::setMemoryUsage(const Pointer<MemoryUsage>& usage) {
+    synchronized(&channel) {
+        if (this->memoryUsage != NULL) {
+            this->memoryUsage->decreaseUsage(this->memoryHeld);
+        }
+        this->memoryUsage = usage;
+        if (this->memoryUsage != NULL) {
+            this->memoryUsage->increaseUsage(this->memoryHeld);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<MemoryUsage> FifoMessageDispatchChannel::getMemoryUsage() const {
+    synchronized(&channel) {
+        return this->memoryUsage;
+    }
+
+    return Pointer<MemoryUsage>();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void FifoMessageDispatchChannel::charge(const Pointer<MessageDispatch>& dispatch) {
+    if (dispatch != NULL && dispatch->getMessage() != NULL) {
+        unsigned long long size = dispatch->getMessage()->getSize();
+        this->memoryHeld += size;
+        if (this->memoryUsage != NULL) {
+            this->memoryUsage->increaseUsage(size);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<MessageDispatch> FifoMessageDispatchChannel::release(const Pointer<MessageDispatch>& dispatch) {
+    if (dispatch != NULL && dispatch->getMessage() != NULL) {
+        unsigned long long size = dispatch->getMessage()->getSize();
+        this->memoryHeld = size > this->memoryHeld ? 0 : this->memoryHeld - size;
+        if (this->memoryUsage != NULL) {
+            this->memoryUsage->decreaseUsage(size);
+        }
+    }
+
+    return dispatch;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void FifoMessageDispatchChannel::releaseAll() {
+    if (this->memoryUsage != NULL) {
+        this->memoryUsage->decreaseUsage(this->memoryHeld);
+    }
+    this->memoryHeld = 0;
+}
@@ -35,6 +35,9 @@ namespace core {
 
         mutable decaf::util::LinkedList< Pointer<MessageDispatch> > channel;
 
+        Pointer<activemq::util::MemoryUsage> memoryUsage;
+        unsigned long long memoryHeld;
+
     private:
 
         FifoMessageDispatchChannel(const FifoMessageDispatchChannel&);
@@ -78,6 +81,10 @@ namespace core {
 
         virtual std::vector<Pointer<MessageDispatch> > removeAll();
 
+        virtual void setMemoryUsage(const Pointer<activemq::util::MemoryUsage>& usage);
+
+        virtual Pointer<activemq::util::MemoryUsage> getMemoryUsage() const;
+
     public:
 
         virtual void lock() {
@@ -112,6 +119,14 @@ namespace core {
             channel.notifyAll();
         }
 
+    private:
+
+        void charge(const Pointer<MessageDispatch>& dispatch);
+
+        Pointer<MessageDispatch> release(const Pointer<MessageDispatch>& dispatch);
+
+        void releaseAll();
+
     };
 
 }}
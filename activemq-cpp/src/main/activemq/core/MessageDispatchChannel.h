@@ -20,6 +20,7 @@
 
 #include <activemq/util/Config.h>
 #include <activemq/commands/MessageDispatch.h>
+#include <activemq/util/MemoryUsage.h>
 
 #include <decaf/util/concurrent/Mutex.h>
 #include <decaf/util/concurrent/Synchronizable.h>
@@ -127,6 +128,25 @@ namespace core {
          */
         virtual std::vector<Pointer<MessageDispatch> > removeAll() = 0;
 
+        /**
+         * Sets the MemoryUsage that is charged with the size of each Message while it is held
+         * in this Channel.  Any Messages already in the Channel are moved over to the new usage
+         * instance, passing NULL stops the tracking.
+         *
+         * @param usage
+         *      The MemoryUsage instance to update as messages enter and leave the Channel.
+         *
+         * @since 3.8.0
+         */
+        virtual void setMemoryUsage(const Pointer<activemq::util::MemoryUsage>& usage) = 0;
+
+        /**
+         * @return the MemoryUsage instance charged for Messages held in this Channel, or NULL.
+         *
+         * @since 3.8.0
+         */
+        virtual Pointer<activemq::util::MemoryUsage> getMemoryUsage() const = 0;
+
     };
 
 }}
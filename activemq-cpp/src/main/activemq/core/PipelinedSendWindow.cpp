@@ -0,0 +1,249 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PipelinedSendWindow.h"
+
+#include <cms/CMSSecurityException.h>
+#include <cms/IllegalStateException.h>
+#include <cms/InvalidClientIdException.h>
+#include <cms/InvalidDestinationException.h>
+#include <cms/InvalidSelectorException.h>
+#include <cms/MessageEOFException.h>
+#include <cms/MessageFormatException.h>
+#include <cms/MessageNotReadableException.h>
+#include <cms/MessageNotWriteableException.h>
+#include <cms/ResourceAllocationException.h>
+#include <cms/TransactionInProgressException.h>
+#include <cms/TransactionRolledBackException.h>
+#include <cms/UnsupportedOperationException.h>
+#include <cms/XAException.h>
+
+#include <decaf/lang/System.h>
+#include <decaf/lang/Thread.h>
+#include <decaf/lang/exceptions/IllegalArgumentException.h>
+#include <decaf/lang/exceptions/InterruptedException.h>
+#include <decaf/util/concurrent/Concurrent.h>
+
+using namespace activemq;
+using namespace activemq::core;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    template<typename E>
+    void throwAs(const cms::CMSException& error) {
+        const E* typed = dynamic_cast<const E*>(&error);
+        if (typed != NULL) {
+            throw E(*typed);
+        }
+    }
+
+    // Throws a copy of the error as the CMS type it was created as.
+    void rethrow(const cms::CMSException& error) {
+        throwAs<cms::CMSSecurityException>(error);
+        throwAs<cms::IllegalStateException>(error);
+        throwAs<cms::InvalidClientIdException>(error);
+        throwAs<cms::InvalidDestinationException>(error);
+        throwAs<cms::InvalidSelectorException>(error);
+        throwAs<cms::MessageEOFException>(error);
+        throwAs<cms::MessageFormatException>(error);
+        throwAs<cms::MessageNotReadableException>(error);
+        throwAs<cms::MessageNotWriteableException>(error);
+        throwAs<cms::ResourceAllocationException>(error);
+        throwAs<cms::TransactionInProgressException>(error);
+        throwAs<cms::TransactionRolledBackException>(error);
+        throwAs<cms::UnsupportedOperationException>(error);
+        throwAs<cms::XAException>(error);
+        throw cms::CMSException(error);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+PipelinedSendWindow::PipelinedSendWindow(int capacity) :
+    cms::AsyncCallback(), capacity(capacity), inFlight(0), abandoned(0), completed(0), pendingError(), mutex() {
+
+    if (capacity < 1) {
+        throw IllegalArgumentException(__FILE__, __LINE__,
+            "Send window capacity must be at least one");
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+PipelinedSendWindow::~PipelinedSendWindow() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PipelinedSendWindow::acquire() {
+
+    synchronized(&mutex) {
+        try {
+            while (this->inFlight >= this->capacity && this->pendingError.get() == NULL) {
+                mutex.wait();
+            }
+        } catch (InterruptedException& ex) {
+            throw cms::CMSException("Send aborted due to thread interrupt.");
+        }
+
+        checkForError();
+        this->inFlight++;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PipelinedSendWindow::release() {
+
+    synchronized(&mutex) {
+        if (this->inFlight > 0) {
+            this->inFlight--;
+        }
+        mutex.notifyAll();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PipelinedSendWindow::flush() {
+
+    synchronized(&mutex) {
+        try {
+            while (this->inFlight > 0) {
+                mutex.wait();
+            }
+        } catch (InterruptedException& ex) {
+            throw cms::CMSException("Flush aborted due to thread interrupt.");
+        }
+
+        checkForError();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool PipelinedSendWindow::awaitCompletion(long long timeout) {
+
+    synchronized(&mutex) {
+        try {
+            if (timeout <= 0) {
+                while (this->inFlight > 0) {
+                    mutex.wait();
+                }
+            } else {
+                long long deadline = System::currentTimeMillis() + timeout;
+                while (this->inFlight > 0) {
+                    long long remaining = deadline - System::currentTimeMillis();
+                    if (remaining <= 0) {
+                        break;
+                    }
+                    mutex.wait(remaining);
+                }
+            }
+        } catch (InterruptedException& ex) {
+            Thread::currentThread()->interrupt();
+        }
+
+        return this->inFlight == 0;
+    }
+
+    return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PipelinedSendWindow::fail(const cms::CMSException& error) {
+
+    synchronized(&mutex) {
+        if (this->inFlight > 0) {
+            setError(error);
+            this->abandoned += this->inFlight;
+            this->inFlight = 0;
+        }
+        mutex.notifyAll();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PipelinedSendWindow::checkForError() {
+
+    synchronized(&mutex) {
+        if (this->pendingError.get() != NULL) {
+            std::auto_ptr<cms::CMSException> error(this->pendingError.release());
+            rethrow(*error);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int PipelinedSendWindow::getInFlightCount() const {
+
+    synchronized(&mutex) {
+        return this->inFlight;
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long PipelinedSendWindow::getCompletedCount() const {
+
+    synchronized(&mutex) {
+        return this->completed;
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PipelinedSendWindow::onSuccess() {
+    complete(NULL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PipelinedSendWindow::onException(const cms::CMSException& ex) {
+    complete(&ex);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PipelinedSendWindow::complete(const cms::CMSException* error) {
+
+    synchronized(&mutex) {
+
+        // The send was already given up on and its slot handed back.
+        if (this->abandoned > 0) {
+            this->abandoned--;
+            return;
+        }
+
+        if (error != NULL) {
+            setError(*error);
+        }
+
+        if (this->inFlight > 0) {
+            this->inFlight--;
+        }
+        this->completed++;
+        mutex.notifyAll();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PipelinedSendWindow::setError(const cms::CMSException& error) {
+
+    // Only the first error is kept, clone keeps the type it was thrown as.
+    if (this->pendingError.get() == NULL) {
+        this->pendingError.reset(const_cast<cms::CMSException&>(error).clone());
+    }
+}
@@ -0,0 +1,160 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_CORE_PIPELINEDSENDWINDOW_H_
+#define _ACTIVEMQ_CORE_PIPELINEDSENDWINDOW_H_
+
+#include <activemq/util/Config.h>
+
+#include <cms/AsyncCallback.h>
+#include <cms/CMSException.h>
+
+#include <decaf/util/concurrent/Mutex.h>
+
+#include <memory>
+
+namespace activemq {
+namespace core {
+
+    /**
+     * Bounds the number of persistent sends of one producer that are waiting on their
+     * Response from the broker.
+     *
+     * A send takes a slot in the window and is then written without waiting, the slot is
+     * returned when the broker's Response arrives through the AsyncCallback interface.
+     * A send only blocks when every slot is taken.  The first error reported by the broker
+     * is held and thrown, as the type the broker reported, from the next call made on the
+     * window, so a failure is reported to the producer exactly once and always before any
+     * later send is written.
+     *
+     * The connection holds a reference to the window for every send still waiting on its
+     * Response, the window must be owned through a Pointer so that a Response arriving
+     * after the producer is gone doesn't reach a deleted window.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API PipelinedSendWindow : public cms::AsyncCallback {
+    private:
+
+        int capacity;
+        int inFlight;
+        int abandoned;
+        long long completed;
+        std::auto_ptr<cms::CMSException> pendingError;
+
+        mutable decaf::util::concurrent::Mutex mutex;
+
+    private:
+
+        PipelinedSendWindow(const PipelinedSendWindow&);
+        PipelinedSendWindow& operator=(const PipelinedSendWindow&);
+
+    public:
+
+        /**
+         * Creates a new window.
+         *
+         * @param capacity
+         *      The number of sends that may wait on a Response, at least one.
+         */
+        PipelinedSendWindow(int capacity);
+
+        virtual ~PipelinedSendWindow();
+
+        /**
+         * Takes a slot for a send, blocking while the window is full.
+         *
+         * @throws CMSException if an earlier send failed or the wait is interrupted.
+         */
+        void acquire();
+
+        /**
+         * Returns the slot of a send that could not be written.
+         */
+        void release();
+
+        /**
+         * Waits for every send in the window to complete and then throws the first
+         * error any of them reported.
+         *
+         * @throws CMSException if an earlier send failed or the wait is interrupted.
+         */
+        void flush();
+
+        /**
+         * Waits for every send in the window to complete without reporting errors.
+         *
+         * @param timeout
+         *      The most time to wait in milliseconds, zero to wait without a limit.
+         *
+         * @returns true if every send completed, false if the wait timed out or was
+         *          interrupted.
+         */
+        bool awaitCompletion(long long timeout);
+
+        /**
+         * Gives up on every send still waiting on a Response, the given error is held
+         * like one the broker reported and any Response that still arrives for those
+         * sends is ignored.  Used when the connection has failed or the producer is
+         * closed before the broker answered.
+         *
+         * @param error
+         *      The error to report for the abandoned sends.
+         */
+        void fail(const cms::CMSException& error);
+
+        /**
+         * Throws, and forgets, the first error reported by an earlier send.
+         *
+         * @throws CMSException if an earlier send failed.
+         */
+        void checkForError();
+
+        /**
+         * @returns the number of sends that may wait on a Response.
+         */
+        int getCapacity() const {
+            return this->capacity;
+        }
+
+        /**
+         * @returns the number of sends currently waiting on a Response.
+         */
+        int getInFlightCount() const;
+
+        /**
+         * @returns the number of sends that have received their Response.
+         */
+        long long getCompletedCount() const;
+
+    public:  // AsyncCallback
+
+        virtual void onSuccess();
+
+        virtual void onException(const cms::CMSException& ex);
+
+    private:
+
+        void complete(const cms::CMSException* error);
+
+        void setError(const cms::CMSException& error);
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_CORE_PIPELINEDSENDWINDOW_H_ */
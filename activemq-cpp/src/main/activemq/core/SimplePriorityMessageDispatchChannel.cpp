@@ -19,6 +19,8 @@
 
 #include <cms/Message.h>
 
+#include <activemq/exceptions/ActiveMQException.h>
+
 #include <decaf/lang/Math.h>
 
 using namespace std;
@@ -26,6 +28,7 @@ using namespace activemq;
 using namespace activemq::core;
 using namespace activemq::commands;
 using namespace activemq::exceptions;
+using namespace activemq::util;
 using namespace decaf;
 using namespace decaf::lang;
 using namespace decaf::util;
@@ -36,11 +39,15 @@ const int SimplePriorityMessageDispatchChannel::MAX_PRIORITIES = 10;
 
 ////////////////////////////////////////////////////////////////////////////////
 SimplePriorityMessageDispatchChannel::SimplePriorityMessageDispatchChannel() :
-    closed(false), running(false), mutex(), channels(MAX_PRIORITIES), enqueued(0) {
+    closed(false), running(false), mutex(), channels(MAX_PRIORITIES), enqueued(0), memoryUsage(), memoryHeld(0) {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 SimplePriorityMessageDispatchChannel::~SimplePriorityMessageDispatchChannel() {
+    try {
+        releaseAll();
+    }
+    AMQ_CATCHALL_NOTHROW()
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -48,6 +55,7 @@ void SimplePriorityMessageDispatchChannel::enqueue(const Pointer<MessageDispatch
     synchronized(&mutex) {
         this->getChannel(message).addLast(message);
         this->enqueued++;
+        charge(message);
         mutex.notify();
     }
 }
@@ -57,6 +65,7 @@ void SimplePriorityMessageDispatchChannel::enqueueFirst(const Pointer<MessageDis
     synchronized(&mutex) {
         this->getChannel(message).addFirst(message);
         this->enqueued++;
+        charge(message);
         mutex.notify();
     }
 }
@@ -84,7 +93,7 @@ Pointer<MessageDispatch> SimplePriorityMessageDispatchChannel::dequeue(long long
             return Pointer<MessageDispatch>();
         }
 
-        return removeFirst();
+        return release(removeFirst());
     }
 
     return Pointer<MessageDispatch>();
@@ -96,7 +105,7 @@ Pointer<MessageDispatch> SimplePriorityMessageDispatchChannel::dequeueNoWait() {
         if (closed || !running || isEmpty()) {
             return Pointer<MessageDispatch>();
         }
-        return removeFirst();
+        return release(removeFirst());
     }
 
     return Pointer<MessageDispatch>();
@@ -149,6 +158,8 @@ void SimplePriorityMessageDispatchChannel::clear() {
         for (int i = 0; i < MAX_PRIORITIES; i++) {
             this->channels[i].clear();
         }
+        this->enqueued = 0;
+        releaseAll();
     }
 }
 
@@ -172,6 +183,7 @@ std::vector<Pointer<MessageDispatch> > SimplePriorityMessageDispatchChannel::rem
             this->enqueued -= (int) temp.size();
             channels[i].clear();
         }
+        releaseAll();
     }
 
     return result;
@@ -220,3 +232,57 @@ Pointer<MessageDispatch> SimplePriorityMessageDispatchChannel::getFirst() const
 
     return Pointer<MessageDispatch>();
 }
+
+////////////////////////////////////////////////////////////////////////////////
+void SimplePriorityMessageDispatchChannel::setMemoryUsage(const Pointer<MemoryUsage>& usage) {
+    synchronized(&mutex) {
+        if (this->memoryUsage != NULL) {
+            this->memoryUsage->decreaseUsage(this->memoryHeld);
+        }
+        this->memoryUsage = usage;
+        if (this->memoryUsage != NULL) {
+            this->memoryUsage->increaseUsage(this->memoryHeld);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<MemoryUsage> SimplePriorityMessageDispatchChannel::getMemoryUsage() const {
+    synchronized(&mutex) {
+        return this->memoryUsage;
+    }
+
+    return Pointer<MemoryUsage>();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SimplePriorityMessageDispatchChannel::charge(const Pointer<MessageDispatch>& dispatch) {
+    if (dispatch != NULL && dispatch->getMessage() != NULL) {
+        unsigned long long size = dispatch->getMessage()->getSize();
+        this->memoryHeld += size;
+        if (this->memoryUsage != NULL) {
+            this->memoryUsage->increaseUsage(size);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<MessageDispatch> SimplePriorityMessageDispatchChannel::release(const Pointer<MessageDispatch>& dispatch) {
+    if (dispatch != NULL && dispatch->getMessage() != NULL) {
+        unsigned long long size = dispatch->getMessage()->getSize();
+        this->memoryHeld = size > this->memoryHeld ? 0 : this->memoryHeld - size;
+        if (this->memoryUsage != NULL) {
+            this->memoryUsage->decreaseUsage(size);
+        }
+    }
+
+    return dispatch;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SimplePriorityMessageDispatchChannel::releaseAll() {
+    if (this->memoryUsage != NULL) {
+        this->memoryUsage->decreaseUsage(this->memoryHeld);
+    }
+    this->memoryHeld = 0;
+}
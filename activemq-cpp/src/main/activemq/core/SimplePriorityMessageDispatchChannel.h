@@ -44,6 +44,9 @@ namespace core {
 
         int enqueued;
 
+        Pointer<activemq::util::MemoryUsage> memoryUsage;
+        unsigned long long memoryHeld;
+
     private:
 
         SimplePriorityMessageDispatchChannel(const SimplePriorityMessageDispatchChannel&);
@@ -86,6 +89,10 @@ namespace core {
 
         virtual std::vector<Pointer<MessageDispatch> > removeAll();
 
+        virtual void setMemoryUsage(const Pointer<activemq::util::MemoryUsage>& usage);
+
+        virtual Pointer<activemq::util::MemoryUsage> getMemoryUsage() const;
+
     public:
 
         virtual void lock() {
@@ -128,6 +135,12 @@ namespace core {
 
         Pointer<MessageDispatch> getFirst() const;
 
+        void charge(const Pointer<MessageDispatch>& dispatch);
+
+        Pointer<MessageDispatch> release(const Pointer<MessageDispatch>& dispatch);
+
+        void releaseAll();
+
     };
 
 }}
@@ -26,14 +26,15 @@
 #include <decaf/lang/Integer.h>
 #include <decaf/lang/Long.h>
 #include <decaf/util/HashMap.h>
-#include <decaf/util/Collections.h>
 #include <decaf/util/concurrent/ExecutorService.h>
 #include <decaf/util/concurrent/Executors.h>
 #include <activemq/util/Config.h>
 #include <activemq/util/CMSExceptionSupport.h>
 #include <activemq/util/ActiveMQProperties.h>
 #include <activemq/util/ActiveMQMessageTransformation.h>
+#include <activemq/util/LatencyStatistics.h>
 #include <activemq/exceptions/ActiveMQException.h>
+#include <activemq/commands/ConsumerControl.h>
 #include <activemq/commands/Message.h>
 #include <activemq/commands/MessageAck.h>
 #include <activemq/commands/MessagePull.h>
@@ -44,11 +45,13 @@
 #include <activemq/core/ActiveMQConstants.h>
 #include <activemq/core/ActiveMQTransactionContext.h>
 #include <activemq/core/ActiveMQAckHandler.h>
+#include <activemq/core/AdaptivePrefetchController.h>
 #include <activemq/core/FifoMessageDispatchChannel.h>
 #include <activemq/core/SimplePriorityMessageDispatchChannel.h>
 #include <activemq/core/RedeliveryPolicy.h>
 #include <activemq/core/kernels/ActiveMQSessionKernel.h>
 #include <activemq/threads/Scheduler.h>
+#include <activemq/filter/MessageSelector.h>
 #include <cms/ExceptionListener.h>
 #include <cms/MessageTransformer.h>
 #include <memory>
@@ -61,6 +64,7 @@ using namespace activemq::core::kernels;
 using namespace activemq::commands;
 using namespace activemq::exceptions;
 using namespace activemq::threads;
+using namespace activemq::filter;
 using namespace decaf::lang;
 using namespace decaf::lang::exceptions;
 using namespace decaf::util;
@@ -127,6 +131,16 @@ namespace kernels {
         ActiveMQSessionKernel* session;
         ActiveMQConsumerKernel* parent;
         Pointer<ConsumerInfo> info;
+        Pointer<MessageSelector> localSelector;
+        Pointer<AdaptivePrefetchController> prefetchController;
+        Pointer<LatencyStatistics> statistics;
+        long long reservedPrefetchMemory;
+        long long lastReceiveTime;
+        unsigned int lastReceiveSize;
+        int pullPipelineDepth;
+        int outstandingPulls;
+        int nextPullSlot;
+        bool pullPipelineStarted;
 
         ActiveMQConsumerKernelConfig() : listener(NULL),
                                          messageAvailableListener(NULL),
@@ -163,7 +177,53 @@ namespace kernels {
                                          executor(),
                                          session(),
                                          parent(),
-                                         info() {
+                                         info(),
+                                         localSelector(),
+                                         prefetchController(),
+                                         statistics(),
+                                         reservedPrefetchMemory(0),
+                                         lastReceiveTime(0),
+                                         lastReceiveSize(0),
+                                         pullPipelineDepth(1),
+                                         outstandingPulls(0),
+                                         nextPullSlot(0),
+                                         pullPipelineStarted(false) {
+        }
+
+        /**
+         * Returns false if local selector filtering is in effect and the dispatched
+         * Message does not match this consumer's selector.
+         */
+        bool isSelected(const Pointer<MessageDispatch>& dispatch) const {
+            return localSelector == NULL || localSelector->matches(dispatch->getMessage().get());
+        }
+
+        /**
+         * Called at the start of a synchronous receive, the time since the previous
+         * receive returned is how long the application spent processing that message.
+         */
+        void receiveStarted() {
+            if (prefetchController != NULL && lastReceiveTime != 0) {
+                prefetchController->messageConsumed((System::nanoTime() - lastReceiveTime) / 1000, lastReceiveSize);
+                lastReceiveTime = 0;
+            }
+        }
+
+        /**
+         * A Message dispatched to a pipelined pull consumer answers one outstanding pull,
+         * called with the unconsumedMessages lock held.
+         */
+        void pullAnswered(const Pointer<MessageDispatch>& dispatch) {
+            if (pullPipelineDepth > 1 && outstandingPulls > 0 && dispatch->getMessage() != NULL) {
+                outstandingPulls--;
+            }
+        }
+
+        void receiveCompleted(const Pointer<MessageDispatch>& dispatch) {
+            if (prefetchController != NULL) {
+                lastReceiveTime = System::nanoTime();
+                lastReceiveSize = dispatch->getMessage()->getSize();
+            }
         }
 
         bool isTimeForOptimizedAck(int prefetchSize) const {
@@ -494,48 +554,6 @@ namespace {
         }
     };
 
-    /**
-     * Class used to Start a Consumer's dispatch queue asynchronously from the
-     * configured Scheduler.
-     */
-    class StartConsumerTask : public Runnable {
-    private:
-
-        Pointer<ActiveMQConsumerKernel> consumer;
-        ActiveMQSessionKernel* session;
-
-    private:
-
-        StartConsumerTask(const StartConsumerTask&);
-        StartConsumerTask& operator=(const StartConsumerTask&);
-
-    public:
-
-        StartConsumerTask(Pointer<ActiveMQConsumerKernel> consumer, ActiveMQSessionKernel* session) :
-            Runnable(), consumer(consumer), session(session) {
-
-            if (consumer == NULL) {
-                throw NullPointerException(
-                    __FILE__, __LINE__, "Synchronization Created with NULL Consumer.");
-            }
-        }
-
-        virtual ~StartConsumerTask() {}
-
-        virtual void run() {
-            try {
-                if (!this->consumer->isClosed()) {
-                    this->consumer->start();
-                }
-            } catch(cms::CMSException& ex) {
-                Exception wrapper(ex.clone());
-                this->session->getConnection()->onAsyncException(wrapper);
-            }
-
-            this->consumer.reset(NULL);
-        }
-    };
-
     class AsyncMessageAckTask : public Runnable {
     private:
 
@@ -595,46 +613,6 @@ namespace {
             this->consumer.reset(NULL);
         }
     };
-
-    class NonBlockingRedeliveryTask : public Runnable {
-    private:
-
-        ActiveMQSessionKernel* session;
-        Pointer<ActiveMQConsumerKernel> consumer;
-        ActiveMQConsumerKernelConfig* impl;
-        ArrayList<Pointer<MessageDispatch> > redeliveries;
-
-    private:
-
-        NonBlockingRedeliveryTask(const NonBlockingRedeliveryTask&);
-        NonBlockingRedeliveryTask& operator=(const NonBlockingRedeliveryTask&);
-
-    public:
-
-        NonBlockingRedeliveryTask(ActiveMQSessionKernel* session, Pointer<ActiveMQConsumerKernel> consumer, ActiveMQConsumerKernelConfig* impl) :
-            Runnable(), session(session), consumer(consumer), impl(impl), redeliveries() {
-
-            this->redeliveries.copy(impl->dispatchedMessages);
-            Collections::reverse(this->redeliveries);
-        }
-        virtual ~NonBlockingRedeliveryTask() {}
-
-        virtual void run() {
-            try {
-                if (!impl->unconsumedMessages->isClosed()) {
-                    Pointer<Iterator<Pointer<MessageDispatch> > > iter(redeliveries.iterator());
-                    while (iter->hasNext() && !impl->unconsumedMessages->isClosed()) {
-                        Pointer<MessageDispatch> dispatch = iter->next();
-                        session->dispatch(dispatch);
-                    }
-                }
-            } catch (Exception& e) {
-                session->getConnection()->onAsyncException(e);
-            }
-
-            this->consumer.reset(NULL);
-        }
-    };
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -678,6 +656,15 @@ ActiveMQConsumerKernel::ActiveMQConsumerKernel(ActiveMQSessionKernel* session,
         }
     }
 
+    // Compiled before any state is allocated as an invalid selector fails creation.
+    Pointer<MessageSelector> localSelector;
+    if (session->getConnection()->isLocalSelectorFiltering()) {
+        localSelector.reset(new MessageSelector(selector));
+        if (localSelector->isEmpty()) {
+            localSelector.reset(NULL);
+        }
+    }
+
     this->internal = new ActiveMQConsumerKernelConfig();
 
     Pointer<ConsumerInfo> consumerInfo(new ConsumerInfo());
@@ -701,6 +688,7 @@ ActiveMQConsumerKernel::ActiveMQConsumerKernel(ActiveMQSessionKernel* session,
     this->internal->session = session;
     this->internal->parent = this;
     this->internal->info = consumerInfo;
+    this->internal->localSelector = localSelector;
     this->internal->hashCode = id->getHashCode();
     this->internal->lastDeliveredSequenceId = -1;
     this->internal->synchronizationRegistered = false;
@@ -718,6 +706,7 @@ ActiveMQConsumerKernel::ActiveMQConsumerKernel(ActiveMQSessionKernel* session,
     } else {
         this->internal->unconsumedMessages.reset(new FifoMessageDispatchChannel());
     }
+    this->internal->unconsumedMessages->setMemoryUsage(this->session->getConnection()->getInboundMemoryUsage());
 
     if (listener != NULL) {
         this->setMessageListener(listener);
@@ -747,6 +736,23 @@ ActiveMQConsumerKernel::ActiveMQConsumerKernel(ActiveMQSessionKernel* session,
         throw IllegalArgumentException(
             __FILE__, __LINE__, "Cannot create a consumer with a negative prefetch");
     }
+
+    if (this->consumerInfo->getPrefetchSize() == 0) {
+        this->internal->pullPipelineDepth = session->getConnection()->getPullPipelineDepth();
+    }
+
+    // Pull consumers and browsers keep the prefetch they were configured with.
+    if (session->getConnection()->isAdaptivePrefetch() &&
+        this->consumerInfo->getPrefetchSize() > 0 && !this->consumerInfo->isBrowser()) {
+
+        int maximum = Math::max(session->getConnection()->getAdaptivePrefetchMaximum(), 1);
+        this->internal->prefetchController.reset(new AdaptivePrefetchController(
+            this->consumerInfo->getPrefetchSize(), 1, maximum, System::currentTimeMillis()));
+    }
+
+    if (session->getStatistics() != NULL) {
+        this->internal->statistics.reset(new LatencyStatistics(session->getStatistics()));
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -860,6 +866,11 @@ void ActiveMQConsumerKernel::dispose() {
                 this->internal->optimizedAckTask = NULL;
             }
 
+            if (this->internal->reservedPrefetchMemory > 0) {
+                this->session->getConnection()->reservePrefetchMemory(this->internal->reservedPrefetchMemory, 0);
+                this->internal->reservedPrefetchMemory = 0;
+            }
+
             if (session->isClientAcknowledge()) {
                 if (!this->consumerInfo->isBrowser()) {
                     // roll back duplicates that aren't acknowledged
@@ -893,6 +904,7 @@ void ActiveMQConsumerKernel::dispose() {
 
             // Stop and Wakeup all sync consumers.
             this->internal->unconsumedMessages->close();
+            this->session->getConnection()->checkInboundMemoryUsage();
 
             if (this->session->isIndividualAcknowledge()) {
                 // For IndividualAck Mode we need to unlink the ack handler to remove a
@@ -966,7 +978,7 @@ decaf::lang::Pointer<MessageDispatch> ActiveMQConsumerKernel::dequeue(long long
                 }
             } else if (dispatch->getMessage() == NULL) {
                 return Pointer<MessageDispatch> ();
-            } else if (dispatch->getMessage()->isExpired()) {
+            } else if (dispatch->getMessage()->isExpired() || !this->internal->isSelected(dispatch)) {
                 beforeMessageIsConsumed(dispatch);
                 afterMessageIsConsumed(dispatch, true);
                 if (timeout > 0) {
@@ -995,6 +1007,7 @@ cms::Message* ActiveMQConsumerKernel::receive() {
 
         this->checkClosed();
         this->checkMessageListener();
+        this->internal->receiveStarted();
 
         // Send a request for a new message if needed
         this->sendPullRequest(0);
@@ -1007,6 +1020,9 @@ cms::Message* ActiveMQConsumerKernel::receive() {
 
         beforeMessageIsConsumed(message);
         afterMessageIsConsumed(message, false);
+        this->internal->receiveCompleted(message);
+        adaptPrefetch();
+        this->session->getConnection()->checkInboundMemoryUsage();
 
         // Need to clone the message because the user is responsible for freeing
         // its copy of the message, createCMSMessage will do this for us.
@@ -1022,6 +1038,7 @@ cms::Message* ActiveMQConsumerKernel::receive(int millisecs) {
 
         this->checkClosed();
         this->checkMessageListener();
+        this->internal->receiveStarted();
 
         // Send a request for a new message if needed
         this->sendPullRequest(millisecs);
@@ -1034,6 +1051,9 @@ cms::Message* ActiveMQConsumerKernel::receive(int millisecs) {
 
         beforeMessageIsConsumed(message);
         afterMessageIsConsumed(message, false);
+        this->internal->receiveCompleted(message);
+        adaptPrefetch();
+        this->session->getConnection()->checkInboundMemoryUsage();
 
         // Need to clone the message because the user is responsible for freeing
         // its copy of the message, createCMSMessage will do this for us.
@@ -1049,6 +1069,7 @@ cms::Message* ActiveMQConsumerKernel::receiveNoWait() {
 
         this->checkClosed();
         this->checkMessageListener();
+        this->internal->receiveStarted();
 
         // Send a request for a new message if needed
         this->sendPullRequest(-1);
@@ -1061,6 +1082,9 @@ cms::Message* ActiveMQConsumerKernel::receiveNoWait() {
 
         beforeMessageIsConsumed(message);
         afterMessageIsConsumed(message, false);
+        this->internal->receiveCompleted(message);
+        adaptPrefetch();
+        this->session->getConnection()->checkInboundMemoryUsage();
 
         // Need to clone the message because the user is responsible for freeing
         // its copy of the message, createCMSMessage will do this for us.
@@ -1111,6 +1135,13 @@ void ActiveMQConsumerKernel::setMessageListener(cms::MessageListener* listener)
 void ActiveMQConsumerKernel::beforeMessageIsConsumed(Pointer<MessageDispatch> dispatch) {
     this->internal->lastDeliveredSequenceId = dispatch->getMessage()->getMessageId()->getBrokerSequenceId();
 
+    // Only the first hand off counts, a redelivery's wait is the redelivery delay.
+    if (this->internal->statistics != NULL && dispatch->getArrivalTime() != 0) {
+        this->internal->statistics->record(LatencyStatistics::DISPATCH_RESIDENCE_TIME,
+                                           System::nanoTime() - dispatch->getArrivalTime());
+        dispatch->setArrivalTime(0);
+    }
+
     if (!isAutoAcknowledgeBatch()) {
 
         // When not in an Auto
@@ -1465,17 +1496,16 @@ void ActiveMQConsumerKernel::rollback() {
                 if (this->internal->nonBlockingRedelivery) {
 
                     if (!this->internal->unconsumedMessages->isClosed()) {
-                        Pointer<ActiveMQConsumerKernel> self =
-                            this->session->lookupConsumerKernel(this->consumerInfo->getConsumerId());
-
-                        NonBlockingRedeliveryTask* redeliveryTask =
-                            new NonBlockingRedeliveryTask(session, self, this->internal);
+                        // The list holds the newest dispatch first, hand them back
+                        // oldest first so they are redelivered in their original order.
+                        std::auto_ptr<Iterator<Pointer<MessageDispatch> > > iter(
+                            this->internal->dispatchedMessages.descendingIterator());
+                        while (iter->hasNext()) {
+                            this->session->dispatchAfterDelay(iter->next(), this->internal->redeliveryDelay);
+                        }
 
                         this->internal->deliveredCounter -= (int) internal->dispatchedMessages.size();
                         this->internal->dispatchedMessages.clear();
-
-                        this->session->getScheduler()->executeAfterDelay(
-                            redeliveryTask, this->internal->redeliveryDelay);
                     }
                 } else {
                     // stop the delivery of messages.
@@ -1491,10 +1521,10 @@ void ActiveMQConsumerKernel::rollback() {
                     this->internal->dispatchedMessages.clear();
 
                     if (internal->redeliveryDelay > 0 && !this->internal->unconsumedMessages->isClosed()) {
+                        // The queue entry holds the consumer so nothing is looked up when it fires.
                         Pointer<ActiveMQConsumerKernel> self =
                             this->session->lookupConsumerKernel(this->consumerInfo->getConsumerId());
-                        this->internal->scheduler->executeAfterDelay(
-                            new StartConsumerTask(self, session), internal->redeliveryDelay);
+                        this->session->startConsumerAfterDelay(self, internal->redeliveryDelay);
                     } else {
                         start();
                     }
@@ -1518,6 +1548,8 @@ void ActiveMQConsumerKernel::dispatch(const Pointer<MessageDispatch>& dispatch)
 
         synchronized(this->internal->unconsumedMessages.get()) {
 
+            this->internal->pullAnswered(dispatch);
+
             if (!this->internal->unconsumedMessages->isClosed()) {
 
                 if (this->consumerInfo->isBrowser() || !session->getConnection()->isDuplicate(this, dispatch->getMessage())) {
@@ -1528,11 +1560,21 @@ void ActiveMQConsumerKernel::dispatch(const Pointer<MessageDispatch>& dispatch)
                             Pointer<cms::Message> message = createCMSMessage(dispatch);
                             beforeMessageIsConsumed(dispatch);
                             try {
-                                bool expired = dispatch->getMessage()->isExpired();
-                                if (!expired) {
+                                bool discard = dispatch->getMessage()->isExpired() || !this->internal->isSelected(dispatch);
+                                if (!discard) {
+                                    long long started = System::nanoTime();
                                     this->internal->listener->onMessage(message.get());
+                                    long long elapsed = System::nanoTime() - started;
+                                    if (this->internal->prefetchController != NULL) {
+                                        this->internal->prefetchController->messageConsumed(
+                                            elapsed / 1000, dispatch->getMessage()->getSize());
+                                    }
+                                    if (this->internal->statistics != NULL) {
+                                        this->internal->statistics->record(LatencyStatistics::LISTENER_TIME, elapsed);
+                                    }
                                 }
-                                afterMessageIsConsumed(dispatch, expired);
+                                afterMessageIsConsumed(dispatch, discard);
+                                adaptPrefetch();
                             } catch (RuntimeException& e) {
                                 if (isAutoAcknowledgeBatch() || isAutoAcknowledgeEach() || session->isIndividualAcknowledge()) {
                                     // Schedule redelivery and possible DLQ processing
@@ -1654,6 +1696,11 @@ void ActiveMQConsumerKernel::sendPullRequest(long long timeout) {
 
         clearDispatchList();
 
+        if (this->consumerInfo->getPrefetchSize() == 0 && this->internal->pullPipelineDepth > 1) {
+            fillPullPipeline();
+            return;
+        }
+
         // There are still local message, consume them first.
         if (!this->internal->unconsumedMessages->isEmpty()) {
             return;
@@ -1674,6 +1721,48 @@ void ActiveMQConsumerKernel::sendPullRequest(long long timeout) {
     AMQ_CATCHALL_THROW(ActiveMQException)
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConsumerKernel::fillPullPipeline() {
+
+    std::vector< Pointer<MessagePull> > pulls;
+
+    // Messages that already arrived count against the depth so the consumer never holds more.
+    synchronized(this->internal->unconsumedMessages.get()) {
+        int depth = this->internal->pullPipelineDepth;
+        int wanted = depth - this->internal->outstandingPulls - this->internal->unconsumedMessages->size();
+
+        for (int i = 0; i < wanted; ++i) {
+            Pointer<MessagePull> messagePull(new MessagePull());
+            messagePull->setConsumerId(this->consumerInfo->getConsumerId());
+            messagePull->setDestination(this->consumerInfo->getDestination());
+            messagePull->setTimeout(0);
+
+            // The slot lets a fault tolerant transport track and replay every outstanding pull.
+            messagePull->setCorrelationId(Integer::toString(this->internal->nextPullSlot));
+            this->internal->nextPullSlot = (this->internal->nextPullSlot + 1) % depth;
+
+            pulls.push_back(messagePull);
+            this->internal->outstandingPulls++;
+            this->internal->pullPipelineStarted = true;
+        }
+    }
+
+    std::vector< Pointer<MessagePull> >::const_iterator iter = pulls.begin();
+    for (; iter != pulls.end(); ++iter) {
+        this->session->oneway(*iter);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ActiveMQConsumerKernel::getOutstandingPullCount() const {
+
+    synchronized(this->internal->unconsumedMessages.get()) {
+        return this->internal->outstandingPulls;
+    }
+
+    return 0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQConsumerKernel::checkClosed() const {
     if (this->isClosed()) {
@@ -1732,6 +1821,11 @@ void ActiveMQConsumerKernel::clearMessagesInProgress() {
                     }
                 }
 
+                // The state tracker replays a pull for every pipeline slot on reconnect.
+                if (this->internal->pullPipelineDepth > 1 && this->internal->pullPipelineStarted) {
+                    this->internal->outstandingPulls = this->internal->pullPipelineDepth;
+                }
+
                 // allow dispatch on this connection to resume
                 this->session->getConnection()->setTransportInterruptionProcessingComplete();
                 this->internal->inProgressClearRequiredFlag = false;
@@ -1915,6 +2009,82 @@ decaf::lang::Exception* ActiveMQConsumerKernel::getFailureError() const {
 void ActiveMQConsumerKernel::setPrefetchSize(int prefetchSize) {
     deliverAcks();
     this->consumerInfo->setCurrentPrefetchSize(prefetchSize);
+
+    if (this->internal->prefetchController != NULL) {
+        this->internal->prefetchController->setWindow(prefetchSize);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConsumerKernel::setDispatchThrottled(bool throttled) {
+
+    if (this->isClosed() || this->consumerInfo->getPrefetchSize() == 0) {
+        return;
+    }
+
+    Pointer<ConsumerControl> control(new ConsumerControl());
+    control->setConsumerId(this->consumerInfo->getConsumerId());
+    control->setDestination(this->consumerInfo->getDestination());
+    control->setPrefetch(throttled ? 0 : this->consumerInfo->getCurrentPrefetchSize());
+    this->session->oneway(control);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConsumerKernel::adaptPrefetch() {
+
+    Pointer<AdaptivePrefetchController> controller = this->internal->prefetchController;
+    if (controller == NULL) {
+        return;
+    }
+
+    long long now = System::currentTimeMillis();
+    if (!controller->isSampleComplete(now)) {
+        return;
+    }
+
+    int window = controller->evaluate(now);
+
+    // Hold the window to what the connection's memory limit allows for messages of this size.
+    long long messageSize = Math::max(controller->getAverageMessageSize(), 1LL);
+    long long requested = (long long) window * messageSize;
+    this->internal->reservedPrefetchMemory = this->session->getConnection()->reservePrefetchMemory(
+        this->internal->reservedPrefetchMemory, requested);
+    if (this->internal->reservedPrefetchMemory < requested) {
+        window = (int) Math::max(this->internal->reservedPrefetchMemory / messageSize,
+                                 (long long) controller->getMinimumWindow());
+    }
+
+    if (window == controller->getWindow()) {
+        return;
+    }
+
+    controller->setWindow(window);
+
+    // Flush what is owed under the old window so the broker sees an accurate count.
+    deliverAcks();
+    this->consumerInfo->setPrefetchSize(window);
+    this->consumerInfo->setCurrentPrefetchSize(window);
+
+    // The new window is sent once the connection lifts its inbound memory throttle.
+    if (this->session->getConnection()->isInboundMemoryThrottled()) {
+        return;
+    }
+
+    Pointer<ConsumerControl> control(new ConsumerControl());
+    control->setConsumerId(this->consumerInfo->getConsumerId());
+    control->setDestination(this->consumerInfo->getDestination());
+    control->setPrefetch(window);
+    this->session->oneway(control);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const AdaptivePrefetchController* ActiveMQConsumerKernel::getAdaptivePrefetchController() const {
+    return this->internal->prefetchController.get();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<LatencyStatistics> ActiveMQConsumerKernel::getStatistics() const {
+    return this->internal->statistics;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -24,10 +24,12 @@
 #include <cms/CMSException.h>
 
 #include <activemq/util/Config.h>
+#include <activemq/util/LatencyStatistics.h>
 #include <activemq/exceptions/ActiveMQException.h>
 #include <activemq/commands/ConsumerInfo.h>
 #include <activemq/commands/MessageAck.h>
 #include <activemq/commands/MessageDispatch.h>
+#include <activemq/core/AdaptivePrefetchController.h>
 #include <activemq/core/Dispatcher.h>
 #include <activemq/core/RedeliveryPolicy.h>
 #include <activemq/core/MessageDispatchChannel.h>
@@ -316,6 +318,24 @@ namespace kernels {
          */
         void setPrefetchSize(int prefetchSize);
 
+        /**
+         * Asks the broker to stop dispatching to this consumer by sending a ConsumerControl
+         * with a prefetch of zero, or restores the consumer's current prefetch size.  Pull
+         * consumers already have a zero prefetch and are left alone.
+         *
+         * @param throttled
+         *      True to stop dispatch from the broker, false to resume it.
+         */
+        void setDispatchThrottled(bool throttled);
+
+        /**
+         * Gets the number of MessagePull requests this consumer has sent that the broker has
+         * not yet answered with a Message, only pipelined pull consumers keep more than one.
+         *
+         * @returns the number of pulls currently outstanding.
+         */
+        int getOutstandingPullCount() const;
+
         /**
          * Checks if the given destination is the Destination that this Consumer is subscribed to.
          *
@@ -354,6 +374,24 @@ namespace kernels {
          */
         void setOptimizeAcknowledge(bool value);
 
+        /**
+         * Gets the controller that sizes this consumer's prefetch window when adaptive
+         * prefetch is enabled on the Connection.  The controller's accessors report the
+         * window in use along with the rate and processing time it was derived from.
+         *
+         * @returns the AdaptivePrefetchController or NULL if the prefetch is fixed.
+         */
+        const AdaptivePrefetchController* getAdaptivePrefetchController() const;
+
+        /**
+         * Gets the latency statistics of this consumer, the time messages wait in the
+         * dispatch queue and the time spent in the MessageListener.  Everything recorded
+         * here is also added to the Session's statistics.
+         *
+         * @returns the consumer's statistics or NULL if the Connection does not keep statistics.
+         */
+        Pointer<util::LatencyStatistics> getStatistics() const;
+
     protected:
 
         /**
@@ -394,6 +432,8 @@ namespace kernels {
 
         void sendPullRequest(long long timeout);
 
+        void fillPullPipeline();
+
         void checkClosed() const;
 
         void checkMessageListener() const;
@@ -412,6 +452,8 @@ namespace kernels {
 
         void clearDispatchList();
 
+        void adaptPrefetch();
+
     };
 
 }}}
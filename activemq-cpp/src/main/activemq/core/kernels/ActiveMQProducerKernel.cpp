@@ -57,7 +57,8 @@ ActiveMQProducerKernel::ActiveMQProducerKernel(ActiveMQSessionKernel* session,
                                                                         memoryUsage(),
                                                                         destination(),
                                                                         messageSequence(),
-                                                                        transformer() {
+                                                                        transformer(),
+                                                                        sendWindow() {
 
     if (session == NULL || producerId == NULL) {
         throw ActiveMQException(
@@ -81,8 +82,16 @@ ActiveMQProducerKernel::ActiveMQProducerKernel(ActiveMQSessionKernel* session,
         this->destination = destination.dynamicCast<cms::Destination>();
     }
 
-    // TODO - Check for need of MemoryUsage if there's a producer Windows size
-    //        and the Protocol version is greater than 3.
+    if (session->getConnection()->getSendPipelineDepth() > 0) {
+        this->sendWindow.reset(new PipelinedSendWindow(session->getConnection()->getSendPipelineDepth()));
+    }
+
+    // The broker only returns ProducerAcks for a producer that announced a window,
+    // so the window is tracked here only when one was set.
+    if (this->producerInfo->getWindowSize() > 0) {
+        this->memoryUsage.reset(new util::ProducerWindow(
+            this->producerInfo->getWindowSize(), session->getConnection()->isAdaptiveSendPacing()));
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -110,6 +119,11 @@ void ActiveMQProducerKernel::close() {
             this->session->oneway(info);
 
             this->closed = true;
+
+            // Report a failed pipelined send that was not seen by an earlier call.
+            if (this->sendWindow != NULL) {
+                this->sendWindow->checkForError();
+            }
         }
     }
     AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
@@ -119,6 +133,21 @@ void ActiveMQProducerKernel::close() {
 void ActiveMQProducerKernel::dispose() {
 
     if (!this->isClosed()) {
+
+        // Give the broker up to the close timeout to answer the outstanding sends,
+        // any Response arriving later is ignored by the window.
+        if (this->sendWindow != NULL &&
+            !this->sendWindow->awaitCompletion(this->session->getConnection()->getCloseTimeout())) {
+
+            this->sendWindow->fail(cms::CMSException(
+                "Producer closed before the broker acknowledged every pipelined send"));
+        }
+
+        // No more ProducerAcks will arrive, release any send blocked on the window.
+        if (this->memoryUsage.get() != NULL) {
+            this->memoryUsage->close();
+        }
+
         Pointer<ActiveMQProducerKernel> producer(this);
         try {
             this->session->removeProducer(producer);
@@ -257,12 +286,23 @@ void ActiveMQProducerKernel::send(const cms::Destination* destination, cms::Mess
             }
         }
 
+        if (this->sendWindow != NULL) {
+            this->sendWindow->checkForError();
+        }
+
         if (this->memoryUsage.get() != NULL) {
             try {
                 this->memoryUsage->waitForSpace();
             } catch (InterruptedException& e) {
                 throw cms::CMSException("Send aborted due to thread interrupt.");
             }
+
+            // The producer may have been closed while the send was waiting.
+            if (this->memoryUsage->isClosed()) {
+                throw ActiveMQException(
+                    __FILE__, __LINE__,
+                    "ActiveMQProducerKernel - Producer Already Closed" );
+            }
         }
 
         this->session->send(this, dest, outbound, deliveryMode, priority, timeToLive,
@@ -271,6 +311,19 @@ void ActiveMQProducerKernel::send(const cms::Destination* destination, cms::Mess
     AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQProducerKernel::flush() {
+
+    try {
+        this->checkClosed();
+
+        if (this->sendWindow != NULL) {
+            this->sendWindow->flush();
+        }
+    }
+    AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQProducerKernel::onProducerAck(const commands::ProducerAck& ack) {
 
@@ -285,6 +338,22 @@ void ActiveMQProducerKernel::onProducerAck(const commands::ProducerAck& ack) {
     AMQ_CATCHALL_THROW(ActiveMQException)
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQProducerKernel::resetProducerWindow() {
+
+    if (this->memoryUsage.get() != NULL) {
+        this->memoryUsage->reset();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQProducerKernel::failSendWindow(const cms::CMSException& error) {
+
+    if (this->sendWindow != NULL) {
+        this->sendWindow->fail(error);
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQProducerKernel::checkClosed() const {
     if (closed) {
@@ -25,11 +25,12 @@
 #include <cms/MessageTransformer.h>
 
 #include <activemq/util/Config.h>
-#include <activemq/util/MemoryUsage.h>
+#include <activemq/util/ProducerWindow.h>
 #include <activemq/util/LongSequenceGenerator.h>
 #include <activemq/commands/ProducerInfo.h>
 #include <activemq/commands/ProducerAck.h>
 #include <activemq/exceptions/ActiveMQException.h>
+#include <activemq/core/PipelinedSendWindow.h>
 
 #include <memory>
 
@@ -72,7 +73,7 @@ namespace kernels {
         bool closed;
 
         // Memory Usage Class, created only if the Producer is tracking its usage.
-        std::auto_ptr<util::MemoryUsage> memoryUsage;
+        std::auto_ptr<util::ProducerWindow> memoryUsage;
 
         // The Destination assigned at creation, NULL if not assigned.
         Pointer<cms::Destination> destination;
@@ -83,6 +84,9 @@ namespace kernels {
         // Used to tranform Message before sending them to the CMS bus.
         cms::MessageTransformer* transformer;
 
+        // Tracks persistent sends awaiting a Response, created only if pipelining is enabled.
+        Pointer<PipelinedSendWindow> sendWindow;
+
     private:
 
         ActiveMQProducerKernel(const ActiveMQProducerKernel&);
@@ -289,6 +293,45 @@ namespace kernels {
          */
         void dispose();
 
+        /**
+         * Blocks until every pipelined send from this Producer has been acknowledged by
+         * the broker and throws the first error any of them reported.  Returns at once
+         * when send pipelining is not enabled.
+         *
+         * @throws CMSException if an earlier send failed.
+         */
+        void flush();
+
+        /**
+         * @returns the window of pipelined sends, or NULL if pipelining is not enabled.
+         */
+        Pointer<PipelinedSendWindow> getSendWindow() const {
+            return this->sendWindow;
+        }
+
+        /**
+         * @returns the window of sends awaiting a ProducerAck, or NULL if no producer
+         *          window size is configured.
+         */
+        const util::ProducerWindow* getProducerWindow() const {
+            return this->memoryUsage.get();
+        }
+
+        /**
+         * Empties the producer window, the broker will never acknowledge the bytes sent
+         * on a connection that has since failed over.
+         */
+        void resetProducerWindow();
+
+        /**
+         * Gives up on every pipelined send still waiting on a Response, the error is
+         * thrown from the next call made on this Producer.
+         *
+         * @param error
+         *      The error to report for the sends that were abandoned.
+         */
+        void failSendWindow(const cms::CMSException& error);
+
         /**
          * @returns the next sequence number for a Message sent from this Producer.
          */
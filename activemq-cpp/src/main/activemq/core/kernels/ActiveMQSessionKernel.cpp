@@ -21,6 +21,7 @@
 #include <activemq/core/ActiveMQConstants.h>
 #include <activemq/core/ActiveMQConnection.h>
 #include <activemq/core/ActiveMQTransactionContext.h>
+#include <activemq/core/ConsumerRoutingTable.h>
 #include <activemq/core/ActiveMQConsumer.h>
 #include <activemq/core/ActiveMQProducer.h>
 #include <activemq/core/ActiveMQQueueBrowser.h>
@@ -29,6 +30,7 @@
 #include <activemq/util/ActiveMQProperties.h>
 #include <activemq/util/ActiveMQMessageTransformation.h>
 #include <activemq/util/CMSExceptionSupport.h>
+#include <activemq/util/LatencyStatistics.h>
 
 #include <activemq/commands/ConsumerInfo.h>
 #include <activemq/commands/DestinationInfo.h>
@@ -95,18 +97,21 @@ namespace kernels{
         decaf::util::LinkedList< Pointer<ActiveMQProducerKernel> > producers;
         decaf::util::concurrent::locks::ReentrantReadWriteLock consumerLock;
         decaf::util::LinkedList< Pointer<ActiveMQConsumerKernel> > consumers;
+        ConsumerRoutingTable< Pointer<ActiveMQConsumerKernel> > consumersById;
         Pointer<Scheduler> scheduler;
         Pointer<CloseSynhcronization> closeSync;
         Mutex sendMutex;
         cms::MessageTransformer* transformer;
         int hashCode;
+        Pointer<LatencyStatistics> statistics;
 
     public:
 
         SessionConfig() : synchronizationRegistered(false),
                           producerLock(), producers(), consumerLock(), consumers(),
+                          consumersById(),
                           scheduler(), closeSync(), sendMutex(), transformer(NULL),
-                          hashCode() {}
+                          hashCode(), statistics() {}
         ~SessionConfig() {}
     };
 
@@ -216,6 +221,10 @@ ActiveMQSessionKernel::ActiveMQSessionKernel(ActiveMQConnection* connection,
 
     this->config->hashCode = id->getHashCode();
 
+    if (this->connection->isStatisticsEnabled()) {
+        this->config->statistics.reset(new LatencyStatistics(this->connection->getStatistics()));
+    }
+
     try {
         this->connection->oneway(this->sessionInfo);
     } catch (...) {
@@ -384,6 +393,7 @@ void ActiveMQSessionKernel::dispose() {
                 }
             }
             this->config->consumers.clear();
+            this->config->consumersById.clear();
             this->config->consumerLock.writeLock().unlock();
         } catch (Exception& ex) {
             this->config->consumerLock.writeLock().unlock();
@@ -480,6 +490,38 @@ void ActiveMQSessionKernel::recover() {
     AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionKernel::resetProducerWindows() {
+
+    this->config->producerLock.readLock().lock();
+    try {
+        Pointer<Iterator< Pointer<ActiveMQProducerKernel> > > iter(this->config->producers.iterator());
+        while (iter->hasNext()) {
+            iter->next()->resetProducerWindow();
+        }
+        this->config->producerLock.readLock().unlock();
+    } catch (Exception& ex) {
+        this->config->producerLock.readLock().unlock();
+        throw;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionKernel::failSendWindows(const cms::CMSException& error) {
+
+    this->config->producerLock.readLock().lock();
+    try {
+        Pointer<Iterator< Pointer<ActiveMQProducerKernel> > > iter(this->config->producers.iterator());
+        while (iter->hasNext()) {
+            iter->next()->failSendWindow(error);
+        }
+        this->config->producerLock.readLock().unlock();
+    } catch (Exception& ex) {
+        this->config->producerLock.readLock().unlock();
+        throw;
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQSessionKernel::clearMessagesInProgress() {
 
@@ -503,6 +545,37 @@ void ActiveMQSessionKernel::clearMessagesInProgress() {
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionKernel::setDispatchThrottled(bool throttled) {
+
+    // A failure for one consumer doesn't stop the rest from being updated, the
+    // first error is thrown once they have all been tried.
+    Pointer<Exception> error;
+
+    this->config->consumerLock.readLock().lock();
+    try {
+        Pointer<Iterator< Pointer<ActiveMQConsumerKernel> > > iter(this->config->consumers.iterator());
+        while (iter->hasNext()) {
+            Pointer<ActiveMQConsumerKernel> consumer = iter->next();
+            try {
+                consumer->setDispatchThrottled(throttled);
+            } catch (Exception& ex) {
+                if (error == NULL) {
+                    error.reset(ex.clone());
+                }
+            }
+        }
+        this->config->consumerLock.readLock().unlock();
+    } catch (Exception& ex) {
+        this->config->consumerLock.readLock().unlock();
+        throw;
+    }
+
+    if (error != NULL) {
+        throw *error;
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQSessionKernel::acknowledge() {
 
@@ -908,6 +981,9 @@ void ActiveMQSessionKernel::send(kernels::ActiveMQProducerKernel* producer, Poin
 
         this->checkClosed();
 
+        LatencyStatistics* statistics = this->config->statistics.get();
+        long long started = statistics != NULL ? System::nanoTime() : 0;
+
         if (destination->isTemporary()) {
             Pointer<ActiveMQTempDestination> tempDest = destination.dynamicCast<ActiveMQTempDestination>();
             if (this->connection->isDeleted(tempDest)) {
@@ -988,8 +1064,23 @@ void ActiveMQSessionKernel::send(kernels::ActiveMQProducerKernel* producer, Poin
                 // No Response Required, send is asynchronous.
                 this->connection->oneway(amqMessage);
 
+                // The producer already waited for space before the send.
                 if (producerWindow != NULL) {
-                    producerWindow->enqueueUsage(amqMessage->getSize());
+                    producerWindow->increaseUsage(amqMessage->getSize());
+                }
+
+            } else if (onComplete == NULL && sendTimeout <= 0 &&
+                       producer->getSendWindow() != NULL && amqMessage->getTransactionId() == NULL) {
+
+                // Pipelined send, the window collects the Response and holds any error
+                // for the next call made on the producer.
+                Pointer<PipelinedSendWindow> window = producer->getSendWindow();
+                window->acquire();
+                try {
+                    this->connection->asyncRequest(amqMessage, window);
+                } catch (...) {
+                    window->release();
+                    throw;
                 }
 
             } else {
@@ -999,6 +1090,10 @@ void ActiveMQSessionKernel::send(kernels::ActiveMQProducerKernel* producer, Poin
                     this->connection->asyncRequest(amqMessage, onComplete);
                 }
             }
+
+            if (statistics != NULL) {
+                statistics->record(LatencyStatistics::SEND_LATENCY, System::nanoTime() - started);
+            }
         }
     }
     AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
@@ -1056,6 +1151,22 @@ void ActiveMQSessionKernel::dispatch(const Pointer<MessageDispatch>& dispatch) {
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionKernel::dispatchAfterDelay(const Pointer<MessageDispatch>& dispatch, long long delay) {
+
+    if (this->executor.get() != NULL) {
+        this->executor->executeAfterDelay(dispatch, delay);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionKernel::startConsumerAfterDelay(const Pointer<ActiveMQConsumerKernel>& consumer, long long delay) {
+
+    if (this->executor.get() != NULL) {
+        this->executor->startConsumerAfterDelay(consumer, delay);
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQSessionKernel::redispatch(MessageDispatchChannel& unconsumedMessages) {
 
@@ -1224,6 +1335,7 @@ void ActiveMQSessionKernel::addConsumer(Pointer<ActiveMQConsumerKernel> consumer
         this->config->consumerLock.writeLock().lock();
         try {
             this->config->consumers.add(consumer);
+            this->config->consumersById.put(*consumer->getConsumerId(), consumer);
             this->config->consumerLock.writeLock().unlock();
         } catch (Exception& ex) {
             this->config->consumerLock.writeLock().unlock();
@@ -1246,6 +1358,7 @@ void ActiveMQSessionKernel::removeConsumer(Pointer<ActiveMQConsumerKernel> consu
         this->config->consumerLock.writeLock().lock();
         try {
             this->config->consumers.remove(consumer);
+            this->config->consumersById.remove(*consumer->getConsumerId());
             this->config->consumerLock.writeLock().unlock();
         } catch (Exception& ex) {
             this->config->consumerLock.writeLock().unlock();
@@ -1325,25 +1438,7 @@ Pointer<ActiveMQProducerKernel> ActiveMQSessionKernel::lookupProducerKernel(Poin
 
 ////////////////////////////////////////////////////////////////////////////////
 Pointer<ActiveMQConsumerKernel> ActiveMQSessionKernel::lookupConsumerKernel(Pointer<ConsumerId> id) {
-
-    this->config->consumerLock.readLock().lock();
-    try {
-        Pointer<Iterator< Pointer<ActiveMQConsumerKernel> > > iter(this->config->consumers.iterator());
-
-        while (iter->hasNext()) {
-            Pointer<ActiveMQConsumerKernel> consumer = iter->next();
-            if (consumer->getConsumerId()->equals(*id)) {
-                this->config->consumerLock.readLock().unlock();
-                return consumer;
-            }
-        }
-        this->config->consumerLock.readLock().unlock();
-    } catch (Exception& ex) {
-        this->config->consumerLock.readLock().unlock();
-        throw;
-    }
-
-    return Pointer<ActiveMQConsumerKernel>();
+    return this->config->consumersById.get(*id);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1481,9 +1576,22 @@ void ActiveMQSessionKernel::checkMessageListener() const {
 
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQSessionKernel::sendAck(Pointer<MessageAck> ack, bool async) {
+
+    LatencyStatistics* statistics = this->config->statistics.get();
+    long long started = statistics != NULL ? System::nanoTime() : 0;
+
     if (async || this->connection->isSendAcksAsync() || this->isTransacted()) {
         this->connection->oneway(ack);
     } else {
         this->connection->syncRequest(ack);
     }
+
+    if (statistics != NULL) {
+        statistics->record(LatencyStatistics::ACK_ROUND_TRIP, System::nanoTime() - started);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<LatencyStatistics> ActiveMQSessionKernel::getStatistics() const {
+    return this->config->statistics;
 }
@@ -38,6 +38,7 @@
 #include <activemq/core/Dispatcher.h>
 #include <activemq/core/MessageDispatchChannel.h>
 #include <activemq/util/LongSequenceGenerator.h>
+#include <activemq/util/LatencyStatistics.h>
 #include <activemq/threads/Scheduler.h>
 
 #include <decaf/lang/Pointer.h>
@@ -187,6 +188,28 @@ namespace kernels {
          */
         virtual void dispatch(const Pointer<MessageDispatch>& message);
 
+        /**
+         * Dispatches a message to its consumer once the given delay has passed, the
+         * delay is kept by the Session's dispatch thread so no task is scheduled.
+         *
+         * @param message - the message to be dispatched
+         * @param delay - time in milliseconds to wait before dispatching
+         *
+         * @since 3.8.0
+         */
+        void dispatchAfterDelay(const Pointer<MessageDispatch>& message, long long delay);
+
+        /**
+         * Starts the consumer once the given delay has passed, the consumer is not
+         * started if it has been closed in the meantime.
+         *
+         * @param consumer - the consumer to start
+         * @param delay - time in milliseconds to wait before starting the consumer
+         *
+         * @since 3.8.0
+         */
+        void startConsumerAfterDelay(const Pointer<ActiveMQConsumerKernel>& consumer, long long delay);
+
     public:   // Implements Methods
 
         virtual void close();
@@ -336,6 +359,14 @@ namespace kernels {
          */
         Pointer<threads::Scheduler> getScheduler() const;
 
+        /**
+         * Gets the latency statistics of this Session, which hold the totals of all its
+         * Consumers and are themselves added to the Connection's statistics.
+         *
+         * @returns the Session's statistics or NULL if the Connection does not keep statistics.
+         */
+        Pointer<util::LatencyStatistics> getStatistics() const;
+
         /**
          * Gets the currently set Last Delivered Sequence Id
          *
@@ -464,6 +495,31 @@ namespace kernels {
          */
         void clearMessagesInProgress();
 
+        /**
+         * Request that this Session empty the windows of all of its producers, used once
+         * the transport has resumed since sends outstanding on the old connection will
+         * never be acknowledged.
+         */
+        void resetProducerWindows();
+
+        /**
+         * Request that this Session give up on the pipelined sends of all of its producers,
+         * used once the transport has failed since those sends will never be answered.
+         *
+         * @param error
+         *      The error each producer reports for the sends it lost.
+         */
+        void failSendWindows(const cms::CMSException& error);
+
+        /**
+         * Request that this Session ask the broker to stop, or resume, dispatching to each
+         * of its consumers.  Used by the Connection to enforce its inbound memory limit.
+         *
+         * @param throttled
+         *      True to reduce every consumer's prefetch to zero, false to restore it.
+         */
+        void setDispatchThrottled(bool throttled);
+
         /**
          * Causes the Session to wakeup its executer and ensure all messages are dispatched.
          */
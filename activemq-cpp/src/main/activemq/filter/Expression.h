@@ -0,0 +1,63 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_FILTER_EXPRESSION_H_
+#define _ACTIVEMQ_FILTER_EXPRESSION_H_
+
+#include <activemq/util/Config.h>
+#include <activemq/filter/SelectorValue.h>
+
+#include <string>
+
+namespace activemq {
+namespace commands {
+    class Message;
+}
+namespace filter {
+
+    /**
+     * A node in the expression tree produced when a message selector is compiled.
+     * Expressions are immutable once built and can be evaluated concurrently from
+     * multiple threads.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API Expression {
+    public:
+
+        virtual ~Expression();
+
+        /**
+         * Evaluates this expression against the given Message.
+         *
+         * @param message
+         *      The Message whose headers and properties are referenced by the expression.
+         *
+         * @returns the resulting value, NULL values represent an UNKNOWN result.
+         */
+        virtual SelectorValue evaluate(const commands::Message* message) const = 0;
+
+        /**
+         * @returns a string form of the expression, used for diagnostics.
+         */
+        virtual std::string toString() const = 0;
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_FILTER_EXPRESSION_H_ */
@@ -0,0 +1,74 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MessageSelector.h"
+
+#include <activemq/filter/SelectorParser.h>
+#include <activemq/commands/Message.h>
+#include <activemq/exceptions/ExceptionDefines.h>
+#include <activemq/exceptions/ActiveMQException.h>
+#include <decaf/lang/Character.h>
+
+using namespace activemq;
+using namespace activemq::filter;
+using namespace activemq::commands;
+using namespace decaf;
+using namespace decaf::lang;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    bool isBlank(const std::string& value) {
+        for (std::size_t i = 0; i < value.length(); ++i) {
+            if (!Character::isWhitespace(value[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MessageSelector::MessageSelector(const std::string& selector) : selector(selector), expression() {
+
+    if (!isBlank(selector)) {
+        this->expression = SelectorParser::parse(selector);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MessageSelector::~MessageSelector() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool MessageSelector::matches(const Message* message) const {
+
+    if (message == NULL) {
+        return false;
+    }
+
+    if (this->expression == NULL) {
+        return true;
+    }
+
+    try {
+        return this->expression->evaluate(message).isTrue();
+    }
+    AMQ_CATCHALL_NOTHROW()
+
+    return false;
+}
@@ -0,0 +1,99 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_FILTER_MESSAGESELECTOR_H_
+#define _ACTIVEMQ_FILTER_MESSAGESELECTOR_H_
+
+#include <activemq/util/Config.h>
+#include <activemq/filter/Expression.h>
+
+#include <cms/InvalidSelectorException.h>
+#include <decaf/lang/Pointer.h>
+
+#include <string>
+
+namespace activemq {
+namespace commands {
+    class Message;
+}
+namespace filter {
+
+    /**
+     * A JMS message selector compiled once into an expression tree so that it can be
+     * cheaply evaluated against each Message received.  Used to filter messages on
+     * the client side, for instance messages that were prefetched or redelivered
+     * locally without passing through the broker's own selector.
+     *
+     * An empty selector matches every message.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API MessageSelector {
+    private:
+
+        std::string selector;
+        decaf::lang::Pointer<Expression> expression;
+
+    private:
+
+        MessageSelector(const MessageSelector&);
+        MessageSelector& operator=(const MessageSelector&);
+
+    public:
+
+        /**
+         * Compiles the given selector.
+         *
+         * @param selector
+         *      The JMS selector string, may be empty.
+         *
+         * @throws InvalidSelectorException if the selector cannot be parsed.
+         */
+        MessageSelector(const std::string& selector);
+
+        virtual ~MessageSelector();
+
+        /**
+         * @returns the selector string this instance was compiled from.
+         */
+        const std::string& getSelector() const {
+            return this->selector;
+        }
+
+        /**
+         * @returns true if the selector is empty and so matches every message.
+         */
+        bool isEmpty() const {
+            return this->expression == NULL;
+        }
+
+        /**
+         * Evaluates the selector against the given Message.  A selector that evaluates
+         * to FALSE or UNKNOWN, or whose evaluation fails, does not match.
+         *
+         * @param message
+         *      The Message to test, a NULL message never matches.
+         *
+         * @returns true if the message is selected.
+         */
+        bool matches(const commands::Message* message) const;
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_FILTER_MESSAGESELECTOR_H_ */
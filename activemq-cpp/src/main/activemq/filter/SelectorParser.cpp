@@ -0,0 +1,1187 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SelectorParser.h"
+
+#include <activemq/commands/Message.h>
+#include <activemq/util/PrimitiveMap.h>
+#include <activemq/wireformat/openwire/marshal/BaseDataStreamMarshaller.h>
+#include <decaf/lang/Character.h>
+#include <decaf/lang/Integer.h>
+#include <decaf/lang/Long.h>
+
+#include <set>
+#include <vector>
+#include <cmath>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::filter;
+using namespace activemq::commands;
+using namespace activemq::util;
+using namespace activemq::wireformat::openwire::marshal;
+using namespace decaf;
+using namespace decaf::lang;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    enum TokenType {
+        TOKEN_END,
+        TOKEN_IDENTIFIER,
+        TOKEN_STRING,
+        TOKEN_DECIMAL,
+        TOKEN_OCTAL,
+        TOKEN_HEX,
+        TOKEN_FLOAT,
+        TOKEN_LPAREN,
+        TOKEN_RPAREN,
+        TOKEN_COMMA,
+        TOKEN_EQ,
+        TOKEN_NE,
+        TOKEN_LT,
+        TOKEN_LE,
+        TOKEN_GT,
+        TOKEN_GE,
+        TOKEN_PLUS,
+        TOKEN_MINUS,
+        TOKEN_STAR,
+        TOKEN_SLASH,
+        TOKEN_PERCENT,
+        TOKEN_NOT,
+        TOKEN_AND,
+        TOKEN_OR,
+        TOKEN_BETWEEN,
+        TOKEN_LIKE,
+        TOKEN_ESCAPE,
+        TOKEN_IN,
+        TOKEN_IS,
+        TOKEN_NULL,
+        TOKEN_TRUE,
+        TOKEN_FALSE
+    };
+
+    struct Token {
+        TokenType type;
+        std::string text;
+        std::size_t position;
+
+        Token(TokenType type, const std::string& text, std::size_t position) :
+            type(type), text(text), position(position) {
+        }
+    };
+
+    cms::InvalidSelectorException syntaxError(const std::string& selector, std::size_t position, const std::string& reason) {
+        return cms::InvalidSelectorException(
+            std::string("Invalid selector '") + selector + "' at position " +
+            Integer::toString((int) position) + ": " + reason);
+    }
+
+    bool equalsIgnoreCase(const std::string& left, const char* right) {
+        std::size_t i = 0;
+        for (; i < left.length() && right[i] != '\0'; ++i) {
+            if (Character::toLowerCase(left[i]) != Character::toLowerCase(right[i])) {
+                return false;
+            }
+        }
+        return i == left.length() && right[i] == '\0';
+    }
+
+    bool isIdentifierStart(char ch) {
+        return Character::isLetter(ch) || ch == '_' || ch == '$';
+    }
+
+    bool isIdentifierPart(char ch) {
+        return Character::isLetterOrDigit(ch) || ch == '_' || ch == '$';
+    }
+
+    TokenType keywordType(const std::string& word) {
+
+        static const struct {
+            const char* word;
+            TokenType type;
+        } KEYWORDS[] = {
+            { "NOT", TOKEN_NOT }, { "AND", TOKEN_AND }, { "OR", TOKEN_OR },
+            { "BETWEEN", TOKEN_BETWEEN }, { "LIKE", TOKEN_LIKE }, { "ESCAPE", TOKEN_ESCAPE },
+            { "IN", TOKEN_IN }, { "IS", TOKEN_IS }, { "NULL", TOKEN_NULL },
+            { "TRUE", TOKEN_TRUE }, { "FALSE", TOKEN_FALSE }
+        };
+
+        for (std::size_t i = 0; i < sizeof(KEYWORDS) / sizeof(KEYWORDS[0]); ++i) {
+            if (equalsIgnoreCase(word, KEYWORDS[i].word)) {
+                return KEYWORDS[i].type;
+            }
+        }
+
+        return TOKEN_IDENTIFIER;
+    }
+
+    std::vector<Token> tokenize(const std::string& selector) {
+
+        std::vector<Token> tokens;
+        const std::size_t length = selector.length();
+        std::size_t pos = 0;
+
+        while (pos < length) {
+
+            char ch = selector[pos];
+
+            if (Character::isWhitespace(ch)) {
+                pos++;
+                continue;
+            }
+
+            std::size_t start = pos;
+
+            if (isIdentifierStart(ch)) {
+                while (pos < length && isIdentifierPart(selector[pos])) {
+                    pos++;
+                }
+                std::string word = selector.substr(start, pos - start);
+                tokens.push_back(Token(keywordType(word), word, start));
+            } else if (ch == '\'') {
+                std::string value;
+                pos++;
+                while (true) {
+                    if (pos >= length) {
+                        throw syntaxError(selector, start, "unterminated string literal");
+                    }
+                    if (selector[pos] == '\'') {
+                        if (pos + 1 < length && selector[pos + 1] == '\'') {
+                            value += '\'';
+                            pos += 2;
+                            continue;
+                        }
+                        pos++;
+                        break;
+                    }
+                    value += selector[pos++];
+                }
+                tokens.push_back(Token(TOKEN_STRING, value, start));
+            } else if (Character::isDigit(ch) || (ch == '.' && pos + 1 < length && Character::isDigit(selector[pos + 1]))) {
+
+                TokenType type = TOKEN_DECIMAL;
+
+                if (ch == '0' && pos + 1 < length && (selector[pos + 1] == 'x' || selector[pos + 1] == 'X')) {
+                    pos += 2;
+                    while (pos < length && std::isxdigit((unsigned char) selector[pos])) {
+                        pos++;
+                    }
+                    if (pos == start + 2) {
+                        throw syntaxError(selector, start, "malformed hexadecimal literal");
+                    }
+                    type = TOKEN_HEX;
+                } else {
+                    while (pos < length && Character::isDigit(selector[pos])) {
+                        pos++;
+                    }
+                    if (pos < length && selector[pos] == '.') {
+                        type = TOKEN_FLOAT;
+                        pos++;
+                        while (pos < length && Character::isDigit(selector[pos])) {
+                            pos++;
+                        }
+                    }
+                    if (pos < length && (selector[pos] == 'e' || selector[pos] == 'E')) {
+                        type = TOKEN_FLOAT;
+                        pos++;
+                        if (pos < length && (selector[pos] == '+' || selector[pos] == '-')) {
+                            pos++;
+                        }
+                        if (pos >= length || !Character::isDigit(selector[pos])) {
+                            throw syntaxError(selector, start, "malformed exponent");
+                        }
+                        while (pos < length && Character::isDigit(selector[pos])) {
+                            pos++;
+                        }
+                    }
+                    if (type == TOKEN_DECIMAL && ch == '0' && pos - start > 1) {
+                        type = TOKEN_OCTAL;
+                    }
+                }
+
+                std::string text = selector.substr(start, pos - start);
+
+                if (type != TOKEN_FLOAT && pos < length && (selector[pos] == 'l' || selector[pos] == 'L')) {
+                    pos++;
+                }
+
+                if (pos < length && isIdentifierPart(selector[pos])) {
+                    throw syntaxError(selector, start, "malformed numeric literal");
+                }
+
+                tokens.push_back(Token(type, text, start));
+            } else {
+
+                TokenType type = TOKEN_END;
+                std::size_t width = 1;
+                char next = pos + 1 < length ? selector[pos + 1] : '\0';
+
+                switch (ch) {
+                    case '(': type = TOKEN_LPAREN; break;
+                    case ')': type = TOKEN_RPAREN; break;
+                    case ',': type = TOKEN_COMMA; break;
+                    case '=': type = TOKEN_EQ; break;
+                    case '+': type = TOKEN_PLUS; break;
+                    case '-': type = TOKEN_MINUS; break;
+                    case '*': type = TOKEN_STAR; break;
+                    case '/': type = TOKEN_SLASH; break;
+                    case '%': type = TOKEN_PERCENT; break;
+                    case '<':
+                        if (next == '>') {
+                            type = TOKEN_NE;
+                            width = 2;
+                        } else if (next == '=') {
+                            type = TOKEN_LE;
+                            width = 2;
+                        } else {
+                            type = TOKEN_LT;
+                        }
+                        break;
+                    case '>':
+                        if (next == '=') {
+                            type = TOKEN_GE;
+                            width = 2;
+                        } else {
+                            type = TOKEN_GT;
+                        }
+                        break;
+                    default:
+                        throw syntaxError(selector, start, std::string("unexpected character '") + ch + "'");
+                }
+
+                pos += width;
+                tokens.push_back(Token(type, selector.substr(start, width), start));
+            }
+        }
+
+        tokens.push_back(Token(TOKEN_END, "", length));
+        return tokens;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Expression tree nodes.
+
+    class ConstantExpression : public Expression {
+    private:
+
+        std::string text;
+        SelectorValue value;
+
+    public:
+
+        ConstantExpression(const SelectorValue& value) : Expression(), text(), value(value) {
+        }
+
+        ConstantExpression(const std::string& text) : Expression(), text(text), value() {
+            this->value = SelectorValue::createStringRef(this->text);
+        }
+
+        virtual SelectorValue evaluate(const Message* message AMQCPP_UNUSED) const {
+            return this->value;
+        }
+
+        virtual std::string toString() const {
+            return this->value.toString();
+        }
+    };
+
+    class PropertyExpression : public Expression {
+    private:
+
+        std::string name;
+
+    public:
+
+        PropertyExpression(const std::string& name) : Expression(), name(name) {
+        }
+
+        virtual SelectorValue evaluate(const Message* message) const {
+
+            const PrimitiveMap& properties = message->getMessageProperties();
+            if (!properties.containsKey(this->name)) {
+                return SelectorValue();
+            }
+
+            const PrimitiveValueNode& node = properties.get(this->name);
+            PrimitiveValueNode::PrimitiveValue value = node.getValue();
+
+            switch (node.getType()) {
+                case PrimitiveValueNode::BOOLEAN_TYPE:
+                    return SelectorValue::createBoolean(value.boolValue);
+                case PrimitiveValueNode::BYTE_TYPE:
+                    return SelectorValue::createLong((char) value.byteValue);
+                case PrimitiveValueNode::SHORT_TYPE:
+                    return SelectorValue::createLong(value.shortValue);
+                case PrimitiveValueNode::INTEGER_TYPE:
+                    return SelectorValue::createLong(value.intValue);
+                case PrimitiveValueNode::LONG_TYPE:
+                    return SelectorValue::createLong(value.longValue);
+                case PrimitiveValueNode::FLOAT_TYPE:
+                    return SelectorValue::createDouble(value.floatValue);
+                case PrimitiveValueNode::DOUBLE_TYPE:
+                    return SelectorValue::createDouble(value.doubleValue);
+                case PrimitiveValueNode::CHAR_TYPE:
+                    return SelectorValue::createString(std::string(1, value.charValue));
+                case PrimitiveValueNode::STRING_TYPE:
+                case PrimitiveValueNode::BIG_STRING_TYPE:
+                    return SelectorValue::createStringRef(*value.stringValue);
+                default:
+                    return SelectorValue();
+            }
+        }
+
+        virtual std::string toString() const {
+            return this->name;
+        }
+    };
+
+    enum HeaderField {
+        JMS_DELIVERY_MODE,
+        JMS_PRIORITY,
+        JMS_MESSAGE_ID,
+        JMS_TIMESTAMP,
+        JMS_CORRELATION_ID,
+        JMS_TYPE,
+        JMS_EXPIRATION,
+        JMS_REDELIVERED,
+        JMSX_DELIVERY_COUNT,
+        JMSX_GROUP_ID,
+        JMSX_GROUP_SEQ,
+        JMSX_USER_ID
+    };
+
+    const std::string PERSISTENT_MODE = "PERSISTENT";
+    const std::string NON_PERSISTENT_MODE = "NON_PERSISTENT";
+
+    class HeaderExpression : public Expression {
+    private:
+
+        std::string name;
+        HeaderField field;
+
+    private:
+
+        static SelectorValue optionalString(const std::string& value) {
+            if (value.empty()) {
+                return SelectorValue();
+            }
+            return SelectorValue::createStringRef(value);
+        }
+
+    public:
+
+        HeaderExpression(const std::string& name, HeaderField field) : Expression(), name(name), field(field) {
+        }
+
+        virtual SelectorValue evaluate(const Message* message) const {
+
+            switch (this->field) {
+                case JMS_DELIVERY_MODE:
+                    return SelectorValue::createStringRef(message->isPersistent() ? PERSISTENT_MODE : NON_PERSISTENT_MODE);
+                case JMS_PRIORITY:
+                    return SelectorValue::createLong(message->getPriority());
+                case JMS_MESSAGE_ID:
+                    if (message->getMessageId() == NULL) {
+                        return SelectorValue();
+                    }
+                    return SelectorValue::createString(BaseDataStreamMarshaller::toString(message->getMessageId().get()));
+                case JMS_TIMESTAMP:
+                    return SelectorValue::createLong(message->getTimestamp());
+                case JMS_CORRELATION_ID:
+                    return optionalString(message->getCorrelationId());
+                case JMS_TYPE:
+                    return optionalString(message->getType());
+                case JMS_EXPIRATION:
+                    return SelectorValue::createLong(message->getExpiration());
+                case JMS_REDELIVERED:
+                    return SelectorValue::createBoolean(message->getRedeliveryCounter() > 0);
+                case JMSX_DELIVERY_COUNT:
+                    return SelectorValue::createLong(message->getRedeliveryCounter() + 1);
+                case JMSX_GROUP_ID:
+                    return optionalString(message->getGroupID());
+                case JMSX_GROUP_SEQ:
+                    return SelectorValue::createLong(message->getGroupSequence());
+                case JMSX_USER_ID:
+                    return optionalString(message->getUserID());
+            }
+
+            return SelectorValue();
+        }
+
+        virtual std::string toString() const {
+            return this->name;
+        }
+    };
+
+    class BinaryExpression : public Expression {
+    protected:
+
+        Pointer<Expression> left;
+        Pointer<Expression> right;
+        std::string symbol;
+
+    public:
+
+        BinaryExpression(const Pointer<Expression>& left, const Pointer<Expression>& right, const std::string& symbol) :
+            Expression(), left(left), right(right), symbol(symbol) {
+        }
+
+        virtual std::string toString() const {
+            return std::string("(") + left->toString() + " " + symbol + " " + right->toString() + ")";
+        }
+    };
+
+    class AndExpression : public BinaryExpression {
+    public:
+
+        AndExpression(const Pointer<Expression>& left, const Pointer<Expression>& right) :
+            BinaryExpression(left, right, "AND") {
+        }
+
+        virtual SelectorValue evaluate(const Message* message) const {
+
+            SelectorValue lvalue = left->evaluate(message);
+            if (lvalue.isFalse()) {
+                return lvalue;
+            }
+
+            SelectorValue rvalue = right->evaluate(message);
+            if (rvalue.isFalse()) {
+                return rvalue;
+            }
+
+            if (lvalue.isTrue() && rvalue.isTrue()) {
+                return lvalue;
+            }
+
+            return SelectorValue();
+        }
+    };
+
+    class OrExpression : public BinaryExpression {
+    public:
+
+        OrExpression(const Pointer<Expression>& left, const Pointer<Expression>& right) :
+            BinaryExpression(left, right, "OR") {
+        }
+
+        virtual SelectorValue evaluate(const Message* message) const {
+
+            SelectorValue lvalue = left->evaluate(message);
+            if (lvalue.isTrue()) {
+                return lvalue;
+            }
+
+            SelectorValue rvalue = right->evaluate(message);
+            if (rvalue.isTrue()) {
+                return rvalue;
+            }
+
+            if (lvalue.isFalse() && rvalue.isFalse()) {
+                return lvalue;
+            }
+
+            return SelectorValue();
+        }
+    };
+
+    class NotExpression : public Expression {
+    private:
+
+        Pointer<Expression> operand;
+
+    public:
+
+        NotExpression(const Pointer<Expression>& operand) : Expression(), operand(operand) {
+        }
+
+        virtual SelectorValue evaluate(const Message* message) const {
+
+            SelectorValue value = operand->evaluate(message);
+            if (!value.isBoolean()) {
+                return SelectorValue();
+            }
+
+            return SelectorValue::createBoolean(!value.getBoolean());
+        }
+
+        virtual std::string toString() const {
+            return std::string("NOT ") + operand->toString();
+        }
+    };
+
+    enum ComparisonOperator {
+        COMPARE_EQ,
+        COMPARE_NE,
+        COMPARE_LT,
+        COMPARE_LE,
+        COMPARE_GT,
+        COMPARE_GE
+    };
+
+    class ComparisonExpression : public BinaryExpression {
+    private:
+
+        ComparisonOperator op;
+
+    private:
+
+        bool test(int result) const {
+            switch (op) {
+                case COMPARE_EQ: return result == 0;
+                case COMPARE_NE: return result != 0;
+                case COMPARE_LT: return result < 0;
+                case COMPARE_LE: return result <= 0;
+                case COMPARE_GT: return result > 0;
+                case COMPARE_GE: return result >= 0;
+            }
+            return false;
+        }
+
+    public:
+
+        ComparisonExpression(const Pointer<Expression>& left, const Pointer<Expression>& right,
+                             ComparisonOperator op, const std::string& symbol) :
+            BinaryExpression(left, right, symbol), op(op) {
+        }
+
+        virtual SelectorValue evaluate(const Message* message) const {
+
+            SelectorValue lvalue = left->evaluate(message);
+            if (lvalue.isNull()) {
+                return lvalue;
+            }
+
+            SelectorValue rvalue = right->evaluate(message);
+            if (rvalue.isNull()) {
+                return rvalue;
+            }
+
+            if (lvalue.isNumber() && rvalue.isNumber()) {
+
+                if (lvalue.getType() == SelectorValue::LONG_VALUE && rvalue.getType() == SelectorValue::LONG_VALUE) {
+                    long long l = lvalue.getLong();
+                    long long r = rvalue.getLong();
+                    return SelectorValue::createBoolean(test(l < r ? -1 : (l > r ? 1 : 0)));
+                }
+
+                double l = lvalue.getDouble();
+                double r = rvalue.getDouble();
+                return SelectorValue::createBoolean(test(l < r ? -1 : (l > r ? 1 : 0)));
+
+            } else if (lvalue.isString() && rvalue.isString()) {
+                return SelectorValue::createBoolean(test(lvalue.getString().compare(rvalue.getString())));
+            } else if (lvalue.isBoolean() && rvalue.isBoolean() && (op == COMPARE_EQ || op == COMPARE_NE)) {
+                return SelectorValue::createBoolean(test(lvalue.getBoolean() == rvalue.getBoolean() ? 0 : 1));
+            }
+
+            // Values of incompatible types are never equal to one another.
+            return SelectorValue::createBoolean(op == COMPARE_NE);
+        }
+    };
+
+    class ArithmeticExpression : public BinaryExpression {
+    private:
+
+        char op;
+
+    public:
+
+        ArithmeticExpression(const Pointer<Expression>& left, const Pointer<Expression>& right, char op) :
+            BinaryExpression(left, right, std::string(1, op)), op(op) {
+        }
+
+        virtual SelectorValue evaluate(const Message* message) const {
+
+            SelectorValue lvalue = left->evaluate(message);
+            if (lvalue.isNull()) {
+                return lvalue;
+            }
+
+            SelectorValue rvalue = right->evaluate(message);
+            if (rvalue.isNull()) {
+                return rvalue;
+            }
+
+            if (op == '+' && lvalue.isString() && rvalue.isString()) {
+                return SelectorValue::createString(lvalue.getString() + rvalue.getString());
+            }
+
+            if (!lvalue.isNumber() || !rvalue.isNumber()) {
+                return SelectorValue();
+            }
+
+            if (lvalue.getType() == SelectorValue::LONG_VALUE && rvalue.getType() == SelectorValue::LONG_VALUE) {
+
+                long long l = lvalue.getLong();
+                long long r = rvalue.getLong();
+
+                switch (op) {
+                    case '+': return SelectorValue::createLong(l + r);
+                    case '-': return SelectorValue::createLong(l - r);
+                    case '*': return SelectorValue::createLong(l * r);
+                    case '/': return r == 0 ? SelectorValue() : SelectorValue::createLong(l / r);
+                    default: return r == 0 ? SelectorValue() : SelectorValue::createLong(l % r);
+                }
+            }
+
+            double l = lvalue.getDouble();
+            double r = rvalue.getDouble();
+
+            switch (op) {
+                case '+': return SelectorValue::createDouble(l + r);
+                case '-': return SelectorValue::createDouble(l - r);
+                case '*': return SelectorValue::createDouble(l * r);
+                case '/': return SelectorValue::createDouble(l / r);
+                default: return SelectorValue::createDouble(std::fmod(l, r));
+            }
+        }
+    };
+
+    class NegateExpression : public Expression {
+    private:
+
+        Pointer<Expression> operand;
+
+    public:
+
+        NegateExpression(const Pointer<Expression>& operand) : Expression(), operand(operand) {
+        }
+
+        virtual SelectorValue evaluate(const Message* message) const {
+
+            SelectorValue value = operand->evaluate(message);
+
+            if (value.getType() == SelectorValue::LONG_VALUE) {
+                return SelectorValue::createLong(-value.getLong());
+            } else if (value.getType() == SelectorValue::DOUBLE_VALUE) {
+                return SelectorValue::createDouble(-value.getDouble());
+            }
+
+            return SelectorValue();
+        }
+
+        virtual std::string toString() const {
+            return std::string("-") + operand->toString();
+        }
+    };
+
+    class IsNullExpression : public Expression {
+    private:
+
+        Pointer<Expression> operand;
+        bool negated;
+
+    public:
+
+        IsNullExpression(const Pointer<Expression>& operand, bool negated) :
+            Expression(), operand(operand), negated(negated) {
+        }
+
+        virtual SelectorValue evaluate(const Message* message) const {
+            return SelectorValue::createBoolean(operand->evaluate(message).isNull() != negated);
+        }
+
+        virtual std::string toString() const {
+            return operand->toString() + (negated ? " IS NOT NULL" : " IS NULL");
+        }
+    };
+
+    class InExpression : public Expression {
+    private:
+
+        Pointer<Expression> operand;
+        std::set<std::string> values;
+        bool negated;
+
+    public:
+
+        InExpression(const Pointer<Expression>& operand, const std::set<std::string>& values, bool negated) :
+            Expression(), operand(operand), values(values), negated(negated) {
+        }
+
+        virtual SelectorValue evaluate(const Message* message) const {
+
+            SelectorValue value = operand->evaluate(message);
+            if (value.isNull()) {
+                return value;
+            }
+
+            bool found = value.isString() && values.find(value.getString()) != values.end();
+            return SelectorValue::createBoolean(found != negated);
+        }
+
+        virtual std::string toString() const {
+
+            std::string result = operand->toString() + (negated ? " NOT IN (" : " IN (");
+            for (std::set<std::string>::const_iterator iter = values.begin(); iter != values.end(); ++iter) {
+                if (iter != values.begin()) {
+                    result += ", ";
+                }
+                result += "'" + *iter + "'";
+            }
+
+            return result + ")";
+        }
+    };
+
+    class LikeExpression : public Expression {
+    private:
+
+        enum ElementKind {
+            MATCH_CHAR,
+            MATCH_ANY_ONE,
+            MATCH_ANY_MANY
+        };
+
+        struct Element {
+            ElementKind kind;
+            char ch;
+        };
+
+        Pointer<Expression> operand;
+        std::string pattern;
+        std::vector<Element> elements;
+        bool negated;
+
+    private:
+
+        bool matches(const std::string& value) const {
+
+            const std::size_t count = elements.size();
+            std::size_t vi = 0;
+            std::size_t pi = 0;
+            std::size_t starPi = std::string::npos;
+            std::size_t starVi = 0;
+
+            while (vi < value.length()) {
+                if (pi < count && elements[pi].kind == MATCH_ANY_MANY) {
+                    starPi = pi++;
+                    starVi = vi;
+                } else if (pi < count && (elements[pi].kind == MATCH_ANY_ONE || elements[pi].ch == value[vi])) {
+                    pi++;
+                    vi++;
+                } else if (starPi != std::string::npos) {
+                    pi = starPi + 1;
+                    vi = ++starVi;
+                } else {
+                    return false;
+                }
+            }
+
+            while (pi < count && elements[pi].kind == MATCH_ANY_MANY) {
+                pi++;
+            }
+
+            return pi == count;
+        }
+
+    public:
+
+        LikeExpression(const Pointer<Expression>& operand, const std::string& pattern,
+                       const std::string& escape, bool negated) :
+            Expression(), operand(operand), pattern(pattern), elements(), negated(negated) {
+
+            for (std::size_t i = 0; i < pattern.length(); ++i) {
+                Element element;
+                element.ch = pattern[i];
+
+                if (!escape.empty() && pattern[i] == escape[0]) {
+                    if (i + 1 >= pattern.length()) {
+                        throw cms::InvalidSelectorException(
+                            std::string("LIKE pattern '") + pattern + "' ends with the escape character");
+                    }
+                    element.kind = MATCH_CHAR;
+                    element.ch = pattern[++i];
+                } else if (pattern[i] == '%') {
+                    // Adjacent wildcards are equivalent to a single one.
+                    if (!elements.empty() && elements.back().kind == MATCH_ANY_MANY) {
+                        continue;
+                    }
+                    element.kind = MATCH_ANY_MANY;
+                } else if (pattern[i] == '_') {
+                    element.kind = MATCH_ANY_ONE;
+                } else {
+                    element.kind = MATCH_CHAR;
+                }
+
+                elements.push_back(element);
+            }
+        }
+
+        virtual SelectorValue evaluate(const Message* message) const {
+
+            SelectorValue value = operand->evaluate(message);
+            if (!value.isString()) {
+                return SelectorValue();
+            }
+
+            return SelectorValue::createBoolean(matches(value.getString()) != negated);
+        }
+
+        virtual std::string toString() const {
+            return operand->toString() + (negated ? " NOT LIKE '" : " LIKE '") + pattern + "'";
+        }
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Recursive descent parser, precedence from lowest to highest is OR, AND,
+    // NOT, equality, comparison, additive, multiplicative then unary sign.
+
+    class Parser {
+    private:
+
+        const std::string& selector;
+        std::vector<Token> tokens;
+        std::size_t current;
+
+    private:
+
+        Parser(const Parser&);
+        Parser& operator=(const Parser&);
+
+    public:
+
+        Parser(const std::string& selector) : selector(selector), tokens(tokenize(selector)), current(0) {
+        }
+
+        Pointer<Expression> parse() {
+
+            Pointer<Expression> result = parseOr();
+
+            if (peek().type != TOKEN_END) {
+                throw syntaxError(selector, peek().position, std::string("unexpected '") + peek().text + "'");
+            }
+
+            return result;
+        }
+
+    private:
+
+        const Token& peek() const {
+            return tokens[current];
+        }
+
+        const Token& next() {
+            const Token& token = tokens[current];
+            if (token.type != TOKEN_END) {
+                current++;
+            }
+            return token;
+        }
+
+        bool accept(TokenType type) {
+            if (peek().type == type) {
+                next();
+                return true;
+            }
+            return false;
+        }
+
+        const Token& expect(TokenType type, const char* what) {
+            if (peek().type != type) {
+                throw syntaxError(selector, peek().position, std::string("expected ") + what);
+            }
+            return next();
+        }
+
+        Pointer<Expression> parseOr() {
+            Pointer<Expression> result = parseAnd();
+            while (accept(TOKEN_OR)) {
+                result.reset(new OrExpression(result, parseAnd()));
+            }
+            return result;
+        }
+
+        Pointer<Expression> parseAnd() {
+            Pointer<Expression> result = parseNot();
+            while (accept(TOKEN_AND)) {
+                result.reset(new AndExpression(result, parseNot()));
+            }
+            return result;
+        }
+
+        Pointer<Expression> parseNot() {
+            if (accept(TOKEN_NOT)) {
+                return Pointer<Expression>(new NotExpression(parseNot()));
+            }
+            return parseEquality();
+        }
+
+        Pointer<Expression> parseEquality() {
+
+            Pointer<Expression> result = parseComparison();
+
+            while (true) {
+                if (accept(TOKEN_EQ)) {
+                    result.reset(new ComparisonExpression(result, parseComparison(), COMPARE_EQ, "="));
+                } else if (accept(TOKEN_NE)) {
+                    result.reset(new ComparisonExpression(result, parseComparison(), COMPARE_NE, "<>"));
+                } else if (accept(TOKEN_IS)) {
+                    bool negated = accept(TOKEN_NOT);
+                    expect(TOKEN_NULL, "NULL");
+                    result.reset(new IsNullExpression(result, negated));
+                } else {
+                    return result;
+                }
+            }
+        }
+
+        Pointer<Expression> parseComparison() {
+
+            Pointer<Expression> result = parseAdditive();
+
+            while (true) {
+                if (accept(TOKEN_GT)) {
+                    result.reset(new ComparisonExpression(result, parseAdditive(), COMPARE_GT, ">"));
+                } else if (accept(TOKEN_GE)) {
+                    result.reset(new ComparisonExpression(result, parseAdditive(), COMPARE_GE, ">="));
+                } else if (accept(TOKEN_LT)) {
+                    result.reset(new ComparisonExpression(result, parseAdditive(), COMPARE_LT, "<"));
+                } else if (accept(TOKEN_LE)) {
+                    result.reset(new ComparisonExpression(result, parseAdditive(), COMPARE_LE, "<="));
+                } else if (peek().type == TOKEN_LIKE || peek().type == TOKEN_BETWEEN || peek().type == TOKEN_IN ||
+                           (peek().type == TOKEN_NOT && isNegatablePredicate(tokens[current + 1].type))) {
+                    bool negated = accept(TOKEN_NOT);
+                    if (accept(TOKEN_LIKE)) {
+                        result = parseLike(result, negated);
+                    } else if (accept(TOKEN_BETWEEN)) {
+                        result = parseBetween(result, negated);
+                    } else {
+                        next();
+                        result = parseIn(result, negated);
+                    }
+                } else {
+                    return result;
+                }
+            }
+        }
+
+        static bool isNegatablePredicate(TokenType type) {
+            return type == TOKEN_LIKE || type == TOKEN_BETWEEN || type == TOKEN_IN;
+        }
+
+        Pointer<Expression> parseLike(const Pointer<Expression>& operand, bool negated) {
+
+            std::string pattern = expect(TOKEN_STRING, "a string literal LIKE pattern").text;
+            std::string escape;
+
+            if (accept(TOKEN_ESCAPE)) {
+                const Token& token = expect(TOKEN_STRING, "a string literal ESCAPE character");
+                if (token.text.length() != 1) {
+                    throw syntaxError(selector, token.position, "ESCAPE must be a single character");
+                }
+                escape = token.text;
+            }
+
+            return Pointer<Expression>(new LikeExpression(operand, pattern, escape, negated));
+        }
+
+        Pointer<Expression> parseBetween(const Pointer<Expression>& operand, bool negated) {
+
+            Pointer<Expression> low = parseAdditive();
+            expect(TOKEN_AND, "AND");
+            Pointer<Expression> high = parseAdditive();
+
+            if (negated) {
+                return Pointer<Expression>(new OrExpression(
+                    Pointer<Expression>(new ComparisonExpression(operand, low, COMPARE_LT, "<")),
+                    Pointer<Expression>(new ComparisonExpression(operand, high, COMPARE_GT, ">"))));
+            }
+
+            return Pointer<Expression>(new AndExpression(
+                Pointer<Expression>(new ComparisonExpression(operand, low, COMPARE_GE, ">=")),
+                Pointer<Expression>(new ComparisonExpression(operand, high, COMPARE_LE, "<="))));
+        }
+
+        Pointer<Expression> parseIn(const Pointer<Expression>& operand, bool negated) {
+
+            std::set<std::string> values;
+
+            expect(TOKEN_LPAREN, "'('");
+            do {
+                values.insert(expect(TOKEN_STRING, "a string literal").text);
+            } while (accept(TOKEN_COMMA));
+            expect(TOKEN_RPAREN, "')'");
+
+            return Pointer<Expression>(new InExpression(operand, values, negated));
+        }
+
+        Pointer<Expression> parseAdditive() {
+
+            Pointer<Expression> result = parseMultiplicative();
+
+            while (true) {
+                if (accept(TOKEN_PLUS)) {
+                    result.reset(new ArithmeticExpression(result, parseMultiplicative(), '+'));
+                } else if (accept(TOKEN_MINUS)) {
+                    result.reset(new ArithmeticExpression(result, parseMultiplicative(), '-'));
+                } else {
+                    return result;
+                }
+            }
+        }
+
+        Pointer<Expression> parseMultiplicative() {
+
+            Pointer<Expression> result = parseUnary();
+
+            while (true) {
+                if (accept(TOKEN_STAR)) {
+                    result.reset(new ArithmeticExpression(result, parseUnary(), '*'));
+                } else if (accept(TOKEN_SLASH)) {
+                    result.reset(new ArithmeticExpression(result, parseUnary(), '/'));
+                } else if (accept(TOKEN_PERCENT)) {
+                    result.reset(new ArithmeticExpression(result, parseUnary(), '%'));
+                } else {
+                    return result;
+                }
+            }
+        }
+
+        Pointer<Expression> parseUnary() {
+
+            if (accept(TOKEN_PLUS)) {
+                return parseUnary();
+            } else if (accept(TOKEN_MINUS)) {
+                if (isNumber(peek().type)) {
+                    return parseNumber(next(), true);
+                }
+                return Pointer<Expression>(new NegateExpression(parseUnary()));
+            }
+
+            return parsePrimary();
+        }
+
+        static bool isNumber(TokenType type) {
+            return type == TOKEN_DECIMAL || type == TOKEN_OCTAL || type == TOKEN_HEX || type == TOKEN_FLOAT;
+        }
+
+        Pointer<Expression> parseNumber(const Token& token, bool negative) {
+
+            errno = 0;
+
+            if (token.type == TOKEN_FLOAT) {
+                double value = std::strtod(token.text.c_str(), NULL);
+                return Pointer<Expression>(new ConstantExpression(SelectorValue::createDouble(negative ? -value : value)));
+            }
+
+            int radix = token.type == TOKEN_HEX ? 16 : (token.type == TOKEN_OCTAL ? 8 : 10);
+            unsigned long long magnitude = std::strtoull(token.text.c_str(), NULL, radix);
+            const unsigned long long limit = (unsigned long long) Long::MAX_VALUE;
+
+            if (errno == ERANGE || magnitude > limit + (negative ? 1 : 0)) {
+
+                if (token.type != TOKEN_DECIMAL) {
+                    throw syntaxError(selector, token.position, "numeric literal out of range");
+                }
+
+                // Decimal values too large for a long are treated as approximate values.
+                double value = std::strtod(token.text.c_str(), NULL);
+                return Pointer<Expression>(new ConstantExpression(SelectorValue::createDouble(negative ? -value : value)));
+            }
+
+            long long value = negative ? (long long) (0ULL - magnitude) : (long long) magnitude;
+            return Pointer<Expression>(new ConstantExpression(SelectorValue::createLong(value)));
+        }
+
+        Pointer<Expression> parsePrimary() {
+
+            const Token& token = next();
+
+            switch (token.type) {
+                case TOKEN_STRING:
+                    return Pointer<Expression>(new ConstantExpression(token.text));
+                case TOKEN_DECIMAL:
+                case TOKEN_OCTAL:
+                case TOKEN_HEX:
+                case TOKEN_FLOAT:
+                    return parseNumber(token, false);
+                case TOKEN_TRUE:
+                    return Pointer<Expression>(new ConstantExpression(SelectorValue::createBoolean(true)));
+                case TOKEN_FALSE:
+                    return Pointer<Expression>(new ConstantExpression(SelectorValue::createBoolean(false)));
+                case TOKEN_NULL:
+                    return Pointer<Expression>(new ConstantExpression(SelectorValue()));
+                case TOKEN_IDENTIFIER:
+                    return createVariable(token.text);
+                case TOKEN_LPAREN: {
+                    Pointer<Expression> result = parseOr();
+                    expect(TOKEN_RPAREN, "')'");
+                    return result;
+                }
+                default:
+                    break;
+            }
+
+            if (token.type == TOKEN_END) {
+                throw syntaxError(selector, token.position, "unexpected end of selector");
+            }
+
+            throw syntaxError(selector, token.position, std::string("unexpected '") + token.text + "'");
+        }
+
+        static Pointer<Expression> createVariable(const std::string& name) {
+
+            static const struct {
+                const char* name;
+                HeaderField field;
+            } HEADERS[] = {
+                { "JMSDeliveryMode", JMS_DELIVERY_MODE },
+                { "JMSPriority", JMS_PRIORITY },
+                { "JMSMessageID", JMS_MESSAGE_ID },
+                { "JMSTimestamp", JMS_TIMESTAMP },
+                { "JMSCorrelationID", JMS_CORRELATION_ID },
+                { "JMSType", JMS_TYPE },
+                { "JMSExpiration", JMS_EXPIRATION },
+                { "JMSRedelivered", JMS_REDELIVERED },
+                { "JMSXDeliveryCount", JMSX_DELIVERY_COUNT },
+                { "JMSXGroupID", JMSX_GROUP_ID },
+                { "JMSXGroupSeq", JMSX_GROUP_SEQ },
+                { "JMSXUserID", JMSX_USER_ID }
+            };
+
+            if (name.compare(0, 3, "JMS") == 0) {
+                for (std::size_t i = 0; i < sizeof(HEADERS) / sizeof(HEADERS[0]); ++i) {
+                    if (name == HEADERS[i].name) {
+                        return Pointer<Expression>(new HeaderExpression(name, HEADERS[i].field));
+                    }
+                }
+            }
+
+            return Pointer<Expression>(new PropertyExpression(name));
+        }
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SelectorParser::SelectorParser() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SelectorParser::~SelectorParser() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<Expression> SelectorParser::parse(const std::string& selector) {
+    Parser parser(selector);
+    return parser.parse();
+}
@@ -0,0 +1,69 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_FILTER_SELECTORPARSER_H_
+#define _ACTIVEMQ_FILTER_SELECTORPARSER_H_
+
+#include <activemq/util/Config.h>
+#include <activemq/filter/Expression.h>
+
+#include <cms/InvalidSelectorException.h>
+#include <decaf/lang/Pointer.h>
+
+#include <string>
+
+namespace activemq {
+namespace filter {
+
+    /**
+     * Compiles a JMS message selector string into an Expression tree.  The supported
+     * grammar is the SQL92 subset defined by the JMS specification: the logical
+     * operators AND, OR and NOT, comparison operators, arithmetic, BETWEEN, LIKE
+     * (with ESCAPE), IN and IS [NOT] NULL.  Identifiers beginning with JMS resolve to
+     * the Message header fields of the same name, all others are looked up in the
+     * Message properties.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API SelectorParser {
+    private:
+
+        SelectorParser();
+        SelectorParser(const SelectorParser&);
+        SelectorParser& operator=(const SelectorParser&);
+
+    public:
+
+        virtual ~SelectorParser();
+
+        /**
+         * Parses the given selector into an Expression tree.
+         *
+         * @param selector
+         *      The selector string to compile, must not be empty.
+         *
+         * @returns the root of the compiled expression tree.
+         *
+         * @throws InvalidSelectorException if the selector is not syntactically valid.
+         */
+        static decaf::lang::Pointer<Expression> parse(const std::string& selector);
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_FILTER_SELECTORPARSER_H_ */
@@ -0,0 +1,130 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SelectorValue.h"
+
+#include <decaf/lang/Long.h>
+#include <decaf/lang/Double.h>
+
+using namespace activemq;
+using namespace activemq::filter;
+using namespace decaf;
+using namespace decaf::lang;
+
+////////////////////////////////////////////////////////////////////////////////
+SelectorValue::SelectorValue() : type(NULL_VALUE),
+                                 boolValue(false),
+                                 longValue(0),
+                                 doubleValue(0.0),
+                                 stringValue(NULL),
+                                 ownedString() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SelectorValue::SelectorValue(const SelectorValue& source) : type(source.type),
+                                                            boolValue(source.boolValue),
+                                                            longValue(source.longValue),
+                                                            doubleValue(source.doubleValue),
+                                                            stringValue(source.stringValue),
+                                                            ownedString(source.ownedString) {
+
+    if (source.stringValue == &source.ownedString) {
+        this->stringValue = &this->ownedString;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SelectorValue& SelectorValue::operator=(const SelectorValue& source) {
+
+    if (this != &source) {
+        this->type = source.type;
+        this->boolValue = source.boolValue;
+        this->longValue = source.longValue;
+        this->doubleValue = source.doubleValue;
+        this->ownedString = source.ownedString;
+
+        if (source.stringValue == &source.ownedString) {
+            this->stringValue = &this->ownedString;
+        } else {
+            this->stringValue = source.stringValue;
+        }
+    }
+
+    return *this;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SelectorValue::~SelectorValue() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SelectorValue SelectorValue::createBoolean(bool value) {
+    SelectorValue result;
+    result.type = BOOLEAN_VALUE;
+    result.boolValue = value;
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SelectorValue SelectorValue::createLong(long long value) {
+    SelectorValue result;
+    result.type = LONG_VALUE;
+    result.longValue = value;
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SelectorValue SelectorValue::createDouble(double value) {
+    SelectorValue result;
+    result.type = DOUBLE_VALUE;
+    result.doubleValue = value;
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SelectorValue SelectorValue::createStringRef(const std::string& value) {
+    SelectorValue result;
+    result.type = STRING_VALUE;
+    result.stringValue = &value;
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SelectorValue SelectorValue::createString(const std::string& value) {
+    SelectorValue result;
+    result.type = STRING_VALUE;
+    result.ownedString = value;
+    result.stringValue = &result.ownedString;
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string SelectorValue::toString() const {
+
+    switch (this->type) {
+        case BOOLEAN_VALUE:
+            return this->boolValue ? "TRUE" : "FALSE";
+        case LONG_VALUE:
+            return Long::toString(this->longValue);
+        case DOUBLE_VALUE:
+            return Double::toString(this->doubleValue);
+        case STRING_VALUE:
+            return std::string("'") + *this->stringValue + "'";
+        default:
+            return "NULL";
+    }
+}
@@ -0,0 +1,152 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_FILTER_SELECTORVALUE_H_
+#define _ACTIVEMQ_FILTER_SELECTORVALUE_H_
+
+#include <activemq/util/Config.h>
+
+#include <string>
+
+namespace activemq {
+namespace filter {
+
+    /**
+     * The result of evaluating a node of a compiled message selector.  A value is
+     * either NULL (which doubles as SQL's UNKNOWN truth value), a boolean, an
+     * exact or approximate number, or a string.
+     *
+     * String values normally reference storage owned by the Message or the
+     * expression tree being evaluated so that no copy is made per message, the
+     * referenced storage must outlive the value.  Computed strings are held by
+     * the value itself.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API SelectorValue {
+    public:
+
+        enum ValueType {
+            NULL_VALUE = 0,
+            BOOLEAN_VALUE = 1,
+            LONG_VALUE = 2,
+            DOUBLE_VALUE = 3,
+            STRING_VALUE = 4
+        };
+
+    private:
+
+        ValueType type;
+        bool boolValue;
+        long long longValue;
+        double doubleValue;
+        const std::string* stringValue;
+        std::string ownedString;
+
+    public:
+
+        /**
+         * Creates a NULL value.
+         */
+        SelectorValue();
+
+        SelectorValue(const SelectorValue& source);
+
+        SelectorValue& operator=(const SelectorValue& source);
+
+        ~SelectorValue();
+
+        static SelectorValue createBoolean(bool value);
+
+        static SelectorValue createLong(long long value);
+
+        static SelectorValue createDouble(double value);
+
+        /**
+         * Creates a string value that references the given string, the caller must
+         * ensure the string remains valid for the lifetime of the returned value.
+         */
+        static SelectorValue createStringRef(const std::string& value);
+
+        /**
+         * Creates a string value that holds its own copy of the given string.
+         */
+        static SelectorValue createString(const std::string& value);
+
+        ValueType getType() const {
+            return this->type;
+        }
+
+        bool isNull() const {
+            return this->type == NULL_VALUE;
+        }
+
+        bool isBoolean() const {
+            return this->type == BOOLEAN_VALUE;
+        }
+
+        bool isNumber() const {
+            return this->type == LONG_VALUE || this->type == DOUBLE_VALUE;
+        }
+
+        bool isString() const {
+            return this->type == STRING_VALUE;
+        }
+
+        /**
+         * @returns true if this value is the boolean TRUE, NULL and FALSE both return false.
+         */
+        bool isTrue() const {
+            return this->type == BOOLEAN_VALUE && this->boolValue;
+        }
+
+        /**
+         * @returns true if this value is the boolean FALSE.
+         */
+        bool isFalse() const {
+            return this->type == BOOLEAN_VALUE && !this->boolValue;
+        }
+
+        bool getBoolean() const {
+            return this->boolValue;
+        }
+
+        long long getLong() const {
+            return this->longValue;
+        }
+
+        /**
+         * @returns the numeric value widened to a double, valid for both numeric types.
+         */
+        double getDouble() const {
+            return this->type == LONG_VALUE ? (double) this->longValue : this->doubleValue;
+        }
+
+        const std::string& getString() const {
+            return *this->stringValue;
+        }
+
+        /**
+         * @returns a string representation of this value, used for diagnostics.
+         */
+        std::string toString() const;
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_FILTER_SELECTORVALUE_H_ */
@@ -0,0 +1,372 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CaptureFile.h"
+
+#include <activemq/exceptions/ActiveMQException.h>
+#include <activemq/exceptions/ExceptionDefines.h>
+#include <decaf/io/IOException.h>
+#include <decaf/lang/System.h>
+#include <decaf/lang/exceptions/IllegalArgumentException.h>
+#include <decaf/internal/util/concurrent/Atomics.h>
+
+#if HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#if HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#if HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#if HAVE_SYS_MMAN_H && HAVE_FCNTL_H && HAVE_UNISTD_H && HAVE_SYS_STAT_H
+#define AMQ_CAPTURE_USE_MMAP
+#endif
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::io;
+using namespace decaf::io;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::internal::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace activemq {
+namespace io {
+
+    const char CAPTURE_MAGIC[8] = { 'A', 'M', 'Q', 'C', 'A', 'P', 'T', '1' };
+    const int CAPTURE_VERSION = 1;
+
+    /**
+     * The layout of the first HEADER_SIZE bytes of the file.
+     */
+    struct CaptureHeader {
+        char magic[8];
+        int version;
+        int capacity;
+        volatile int head;
+        volatile int wrapped;
+        volatile int streams;
+        volatile int dropped;
+        char reserved[32];
+    };
+
+    /**
+     * The layout of the first RECORD_HEADER_SIZE bytes of each record, a padding
+     * record may be as short as the sync word and length.
+     */
+    struct CaptureRecordHeader {
+        volatile int sync;
+        int length;
+        int streamId;
+        int flags;
+        long long timestamp;
+    };
+
+    class CaptureFileImpl {
+    private:
+
+        CaptureFileImpl(const CaptureFileImpl&);
+        CaptureFileImpl& operator=(const CaptureFileImpl&);
+
+    public:
+
+        std::string path;
+        int capacity;
+        unsigned char* mapping;
+        CaptureHeader* header;
+        unsigned char* ring;
+        long long epochNanos;
+        long long startNanos;
+        int fd;
+
+        CaptureFileImpl(const std::string& path, int capacity) :
+            path(path), capacity(capacity), mapping(NULL), header(NULL), ring(NULL),
+            epochNanos(System::currentTimeMillis() * 1000000LL), startNanos(System::nanoTime()), fd(-1) {
+        }
+
+        long long timestamp() const {
+            return this->epochNanos + (System::nanoTime() - this->startNanos);
+        }
+
+        bool isValid() const {
+            return memcmp(this->header->magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) == 0 &&
+                   this->header->version == CAPTURE_VERSION && this->header->capacity == this->capacity;
+        }
+
+        void initialize() {
+            memset(this->mapping, 0, CaptureFile::HEADER_SIZE + (size_t) this->capacity);
+            memcpy(this->header->magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+            this->header->version = CAPTURE_VERSION;
+            this->header->capacity = this->capacity;
+        }
+
+        void open();
+
+        void close();
+
+        void writePadding(unsigned int offset, unsigned int length) {
+            CaptureRecordHeader* padding = (CaptureRecordHeader*) (this->ring + offset);
+            Atomics::getAndSet(&padding->sync, 0);
+            padding->length = (int) length;
+            if (length >= (unsigned int) CaptureFile::RECORD_HEADER_SIZE) {
+                padding->streamId = 0;
+                padding->flags = CaptureFile::PADDING;
+                padding->timestamp = 0;
+            }
+            Atomics::getAndSet(&padding->sync, CaptureFile::SYNC);
+        }
+    };
+
+}}
+
+#ifdef AMQ_CAPTURE_USE_MMAP
+
+////////////////////////////////////////////////////////////////////////////////
+void CaptureFileImpl::open() {
+
+    size_t size = CaptureFile::HEADER_SIZE + (size_t) this->capacity;
+
+    this->fd = ::open(this->path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (this->fd < 0) {
+        throw IOException(__FILE__, __LINE__, "Cannot open capture file %s: %s", this->path.c_str(), strerror(errno));
+    }
+
+    struct stat status;
+    bool existing = fstat(this->fd, &status) == 0 && (size_t) status.st_size == size;
+
+    if (!existing && ftruncate(this->fd, (off_t) size) != 0) {
+        int error = errno;
+        ::close(this->fd);
+        this->fd = -1;
+        throw IOException(__FILE__, __LINE__, "Cannot size capture file %s: %s", this->path.c_str(), strerror(error));
+    }
+
+    void* address = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+    if (address == MAP_FAILED) {
+        int error = errno;
+        ::close(this->fd);
+        this->fd = -1;
+        throw IOException(__FILE__, __LINE__, "Cannot map capture file %s: %s", this->path.c_str(), strerror(error));
+    }
+
+    this->mapping = (unsigned char*) address;
+    this->header = (CaptureHeader*) this->mapping;
+    this->ring = this->mapping + CaptureFile::HEADER_SIZE;
+
+    if (!existing || !isValid()) {
+        initialize();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CaptureFileImpl::close() {
+
+    if (this->mapping != NULL) {
+        munmap(this->mapping, CaptureFile::HEADER_SIZE + (size_t) this->capacity);
+        this->mapping = NULL;
+        this->header = NULL;
+        this->ring = NULL;
+    }
+
+    if (this->fd >= 0) {
+        ::close(this->fd);
+        this->fd = -1;
+    }
+}
+
+#else
+
+////////////////////////////////////////////////////////////////////////////////
+void CaptureFileImpl::open() {
+
+    size_t size = CaptureFile::HEADER_SIZE + (size_t) this->capacity;
+
+    this->mapping = new unsigned char[size];
+    this->header = (CaptureHeader*) this->mapping;
+    this->ring = this->mapping + CaptureFile::HEADER_SIZE;
+
+    bool existing = false;
+    FILE* file = fopen(this->path.c_str(), "rb");
+    if (file != NULL) {
+        existing = fread(this->mapping, 1, size, file) == size;
+        fclose(file);
+    }
+
+    if (!existing || !isValid()) {
+        initialize();
+    }
+
+    file = fopen(this->path.c_str(), "ab");
+    if (file == NULL) {
+        delete [] this->mapping;
+        this->mapping = NULL;
+        throw IOException(__FILE__, __LINE__, "Cannot open capture file %s: %s", this->path.c_str(), strerror(errno));
+    }
+    fclose(file);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CaptureFileImpl::close() {
+
+    if (this->mapping == NULL) {
+        return;
+    }
+
+    FILE* file = fopen(this->path.c_str(), "wb");
+    if (file != NULL) {
+        fwrite(this->mapping, 1, CaptureFile::HEADER_SIZE + (size_t) this->capacity, file);
+        fclose(file);
+    }
+
+    delete [] this->mapping;
+    this->mapping = NULL;
+    this->header = NULL;
+    this->ring = NULL;
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+CaptureFile::CaptureFile(const std::string& path, int capacity) : impl(NULL) {
+
+    if (path.empty()) {
+        throw IllegalArgumentException(__FILE__, __LINE__, "Capture file path cannot be empty");
+    }
+
+    int size = MINIMUM_CAPACITY;
+    while (size < capacity && size < MAXIMUM_CAPACITY) {
+        size <<= 1;
+    }
+
+    this->impl = new CaptureFileImpl(path, size);
+
+    try {
+        this->impl->open();
+    } catch (...) {
+        delete this->impl;
+        throw;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CaptureFile::~CaptureFile() {
+    try {
+        close();
+    }
+    AMQ_CATCHALL_NOTHROW()
+
+    try {
+        delete this->impl;
+    }
+    AMQ_CATCHALL_NOTHROW()
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int CaptureFile::newStreamId() {
+
+    if (this->impl->header == NULL) {
+        throw IOException(__FILE__, __LINE__, "Capture file %s is closed", this->impl->path.c_str());
+    }
+
+    return Atomics::incrementAndGet(&this->impl->header->streams);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CaptureFile::append(int streamId, int flags, const unsigned char* data, int length) {
+
+    CaptureHeader* header = this->impl->header;
+    if (header == NULL || length < 0 || (data == NULL && length > 0)) {
+        return;
+    }
+
+    unsigned int capacity = (unsigned int) this->impl->capacity;
+    unsigned int size = ((unsigned int) (RECORD_HEADER_SIZE + length) + 7) & ~7U;
+
+    if (size > capacity) {
+        Atomics::getAndIncrement(&header->dropped);
+        return;
+    }
+
+    // Reserve the space, a record that does not fit before the end of the ring
+    // also takes the rest of the ring as padding and starts over at the front.
+    unsigned int offset = 0;
+    unsigned int space = 0;
+    while (true) {
+        unsigned int head = (unsigned int) header->head;
+        offset = head & (capacity - 1);
+        space = capacity - offset;
+        unsigned int advance = size <= space ? size : space + size;
+
+        if (Atomics::compareAndSet32(&header->head, (int) head, (int) (head + advance))) {
+            break;
+        }
+    }
+
+    if (size > space) {
+        this->impl->writePadding(offset, space);
+        offset = 0;
+    }
+
+    if (size >= space && header->wrapped == 0) {
+        Atomics::getAndSet(&header->wrapped, 1);
+    }
+
+    // Clear the sync word first so a record torn by a crash is never read back,
+    // setting it again publishes the completed record.
+    CaptureRecordHeader* record = (CaptureRecordHeader*) (this->impl->ring + offset);
+    Atomics::getAndSet(&record->sync, 0);
+    record->length = RECORD_HEADER_SIZE + length;
+    record->streamId = streamId;
+    record->flags = flags;
+    record->timestamp = this->impl->timestamp();
+
+    if (length > 0) {
+        memcpy(this->impl->ring + offset + RECORD_HEADER_SIZE, data, (size_t) length);
+    }
+
+    Atomics::getAndSet(&record->sync, SYNC);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CaptureFile::close() {
+    this->impl->close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string CaptureFile::getPath() const {
+    return this->impl->path;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int CaptureFile::getCapacity() const {
+    return this->impl->capacity;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int CaptureFile::getDroppedCount() const {
+    return this->impl->header == NULL ? 0 : this->impl->header->dropped;
+}
@@ -0,0 +1,138 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_IO_CAPTUREFILE_H_
+#define _ACTIVEMQ_IO_CAPTUREFILE_H_
+
+#include <activemq/util/Config.h>
+
+#include <string>
+
+namespace activemq {
+namespace io {
+
+    class CaptureFileImpl;
+
+    /**
+     * A ring buffer of timestamped byte records kept in a memory mapped file, used to
+     * capture the raw bytes a transport sends and receives at little cost.  Writers
+     * reserve space with a single atomic operation so any number of threads, and any
+     * number of transports sharing the file, can append without locking.  Once the
+     * ring is full the oldest records are overwritten.
+     *
+     * The file starts with a 64 byte header followed by the ring.  Each record is
+     * aligned to eight bytes and made up of a sync word, the record length, the id of
+     * the stream it belongs to, its flags and a timestamp in nanoseconds since the
+     * epoch, followed by the captured bytes.  The CaptureFileReader reads them back.
+     *
+     * Opening an existing capture file of the same capacity continues it, so the
+     * connections made after a reconnect or a restart are added to the same capture.
+     * On platforms without mmap the ring is held in memory and written out on close.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API CaptureFile {
+    public:
+
+        /** Flag of a record holding bytes read from the peer. */
+        static const int INBOUND = 1;
+
+        /** Flag of a record holding bytes written to the peer. */
+        static const int OUTBOUND = 2;
+
+        /** Flag of a record that only fills the end of the ring, it holds no data. */
+        static const int PADDING = 4;
+
+        static const int HEADER_SIZE = 64;
+        static const int RECORD_HEADER_SIZE = 24;
+        static const int SYNC = 0x41514350;
+        static const int DEFAULT_CAPACITY = 64 * 1024 * 1024;
+        static const int MINIMUM_CAPACITY = 64 * 1024;
+        static const int MAXIMUM_CAPACITY = 1024 * 1024 * 1024;
+
+    private:
+
+        CaptureFileImpl* impl;
+
+    private:
+
+        CaptureFile(const CaptureFile&);
+        CaptureFile& operator=(const CaptureFile&);
+
+    public:
+
+        /**
+         * Opens the capture file at the given path, creating it if needed.
+         *
+         * @param path
+         *      The file to capture to.
+         * @param capacity
+         *      The size of the ring in bytes, rounded up to a power of two between
+         *      MINIMUM_CAPACITY and MAXIMUM_CAPACITY.
+         *
+         * @throws IOException if the file cannot be created or mapped.
+         */
+        CaptureFile(const std::string& path, int capacity = DEFAULT_CAPACITY);
+
+        virtual ~CaptureFile();
+
+        /**
+         * @returns a new id for the records of one connection, unique within the file.
+         */
+        int newStreamId();
+
+        /**
+         * Appends a record to the ring.  Records larger than the ring are dropped and
+         * counted instead.
+         *
+         * @param streamId
+         *      The stream the bytes belong to.
+         * @param flags
+         *      INBOUND or OUTBOUND.
+         * @param data
+         *      The bytes to capture.
+         * @param length
+         *      The number of bytes to capture.
+         */
+        void append(int streamId, int flags, const unsigned char* data, int length);
+
+        /**
+         * Releases the mapping, or writes out the ring when it is held in memory.  The
+         * file is closed automatically when this object is destroyed.
+         */
+        void close();
+
+        /**
+         * @returns the path of the capture file.
+         */
+        std::string getPath() const;
+
+        /**
+         * @returns the size of the ring in bytes.
+         */
+        int getCapacity() const;
+
+        /**
+         * @returns the number of records that were too large to capture.
+         */
+        int getDroppedCount() const;
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_IO_CAPTUREFILE_H_ */
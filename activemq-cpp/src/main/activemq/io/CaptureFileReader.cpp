@@ -0,0 +1,188 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CaptureFileReader.h"
+
+#include <activemq/io/CaptureFile.h>
+#include <decaf/io/IOException.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::io;
+using namespace decaf::io;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const char CAPTURE_MAGIC[8] = { 'A', 'M', 'Q', 'C', 'A', 'P', 'T', '1' };
+
+    int readInt(const unsigned char* buffer) {
+        int value;
+        memcpy(&value, buffer, sizeof(value));
+        return value;
+    }
+
+    long long readLong(const unsigned char* buffer) {
+        long long value;
+        memcpy(&value, buffer, sizeof(value));
+        return value;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CaptureFileReader::CaptureFileReader(const std::string& path) :
+    path(path), ring(), offsets(), position(0), streams(0), dropped(0), wrapped(false) {
+
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == NULL) {
+        throw IOException(__FILE__, __LINE__, "Cannot open capture file %s: %s", path.c_str(), strerror(errno));
+    }
+
+    unsigned char header[CaptureFile::HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) || memcmp(header, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0) {
+        fclose(file);
+        throw IOException(__FILE__, __LINE__, "%s is not a capture file", path.c_str());
+    }
+
+    int capacity = readInt(header + 12);
+    unsigned int head = (unsigned int) readInt(header + 16);
+    this->wrapped = readInt(header + 20) != 0;
+    this->streams = readInt(header + 24);
+    this->dropped = readInt(header + 28);
+
+    if (capacity < CaptureFile::MINIMUM_CAPACITY || capacity > CaptureFile::MAXIMUM_CAPACITY || (capacity & (capacity - 1)) != 0) {
+        fclose(file);
+        throw IOException(__FILE__, __LINE__, "Capture file %s has an invalid capacity %d", path.c_str(), capacity);
+    }
+
+    this->ring.resize((size_t) capacity);
+    size_t count = fread(&this->ring[0], 1, this->ring.size(), file);
+    fclose(file);
+
+    if (count != this->ring.size()) {
+        throw IOException(__FILE__, __LINE__, "Capture file %s is truncated", path.c_str());
+    }
+
+    int end = (int) (head & (unsigned int) (capacity - 1));
+
+    if (!this->wrapped) {
+        walk(0, end, &this->offsets);
+        return;
+    }
+
+    // Find the oldest record boundary whose chain leads back to the write position,
+    // remembering the longest chain in case a torn record breaks all of them.
+    int best = -1;
+    int bestLength = 0;
+    for (int step = 0; step < capacity; step += 8) {
+        int start = (end + step) & (capacity - 1);
+        int length = walk(start, end, NULL);
+
+        if (length < 0) {
+            best = start;
+            break;
+        }
+
+        if (length > bestLength) {
+            best = start;
+            bestLength = length;
+        }
+    }
+
+    if (best >= 0) {
+        walk(best, end, &this->offsets);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CaptureFileReader::~CaptureFileReader() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int CaptureFileReader::walk(int start, int end, std::vector<int>* found) const {
+
+    int capacity = (int) this->ring.size();
+    int offset = start;
+    int walked = 0;
+
+    while (walked < capacity) {
+
+        if (walked > 0 && offset == end) {
+            return -1;
+        }
+
+        if (walked == 0 && offset == end && !this->wrapped) {
+            return -1;
+        }
+
+        int space = capacity - offset;
+        if (space < 8) {
+            break;
+        }
+
+        const unsigned char* record = &this->ring[(size_t) offset];
+        int length = readInt(record + 4);
+        int size = (length + 7) & ~7;
+
+        if (readInt(record) != CaptureFile::SYNC || length < 8 || size > space || walked + size > capacity) {
+            break;
+        }
+
+        if (found != NULL && length >= CaptureFile::RECORD_HEADER_SIZE &&
+            (readInt(record + 12) & CaptureFile::PADDING) == 0) {
+
+            found->push_back(offset);
+        }
+
+        walked += size;
+        offset = (offset + size) & (capacity - 1);
+    }
+
+    return walked;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CaptureFileReader::next(CaptureRecord& record) {
+
+    if (this->position >= this->offsets.size()) {
+        return false;
+    }
+
+    const unsigned char* buffer = &this->ring[(size_t) this->offsets[this->position++]];
+    int length = readInt(buffer + 4);
+
+    record.setStreamId(readInt(buffer + 8));
+    record.setFlags(readInt(buffer + 12));
+    record.setTimestamp(readLong(buffer + 16));
+    record.getData().assign(buffer + CaptureFile::RECORD_HEADER_SIZE, buffer + length);
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CaptureFileReader::reset() {
+    this->position = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int CaptureFileReader::getRecordCount() const {
+    return (int) this->offsets.size();
+}
@@ -0,0 +1,120 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_IO_CAPTUREFILEREADER_H_
+#define _ACTIVEMQ_IO_CAPTUREFILEREADER_H_
+
+#include <activemq/util/Config.h>
+#include <activemq/io/CaptureRecord.h>
+
+#include <string>
+#include <vector>
+
+namespace activemq {
+namespace io {
+
+    /**
+     * Reads back the records of a file written by a CaptureFile, oldest first.  The
+     * whole file is loaded when the reader is created so a capture that is still
+     * being written can be read without disturbing the writers.
+     *
+     * Once the ring has wrapped the oldest surviving record is found by looking for
+     * the first record boundary after the write position whose chain of records ends
+     * exactly at it, records torn by a crash end the chain early.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API CaptureFileReader {
+    private:
+
+        std::string path;
+        std::vector<unsigned char> ring;
+        std::vector<int> offsets;
+        std::size_t position;
+        int streams;
+        int dropped;
+        bool wrapped;
+
+    private:
+
+        CaptureFileReader(const CaptureFileReader&);
+        CaptureFileReader& operator=(const CaptureFileReader&);
+
+    public:
+
+        /**
+         * Loads the capture file at the given path.
+         *
+         * @param path
+         *      The capture file to read.
+         *
+         * @throws IOException if the file cannot be read or is not a capture file.
+         */
+        CaptureFileReader(const std::string& path);
+
+        virtual ~CaptureFileReader();
+
+        /**
+         * Reads the next record holding captured bytes.
+         *
+         * @param record
+         *      The record to fill in.
+         *
+         * @returns false once all records have been read.
+         */
+        bool next(CaptureRecord& record);
+
+        /**
+         * Starts reading from the oldest record again.
+         */
+        void reset();
+
+        /**
+         * @returns the number of records that can be read in total.
+         */
+        int getRecordCount() const;
+
+        /**
+         * @returns the number of stream ids handed out by the capture.
+         */
+        int getStreamCount() const {
+            return this->streams;
+        }
+
+        /**
+         * @returns the number of records the writers had to drop.
+         */
+        int getDroppedCount() const {
+            return this->dropped;
+        }
+
+        /**
+         * @returns true if the ring has wrapped and the oldest records were lost.
+         */
+        bool isWrapped() const {
+            return this->wrapped;
+        }
+
+    private:
+
+        int walk(int start, int end, std::vector<int>* found) const;
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_IO_CAPTUREFILEREADER_H_ */
@@ -0,0 +1,68 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CaptureInputStream.h"
+
+#include <activemq/exceptions/ExceptionDefines.h>
+
+using namespace activemq;
+using namespace activemq::io;
+using namespace decaf::io;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+
+////////////////////////////////////////////////////////////////////////////////
+CaptureInputStream::CaptureInputStream(InputStream* inputStream, const Pointer<CaptureFile> captureFile, int streamId, bool own) :
+    FilterInputStream(inputStream, own), captureFile(captureFile), streamId(streamId) {
+
+    if (captureFile == NULL) {
+        throw NullPointerException(__FILE__, __LINE__, "CaptureFile instance cannot be NULL");
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CaptureInputStream::~CaptureInputStream() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int CaptureInputStream::doReadByte() {
+    try {
+        int value = FilterInputStream::doReadByte();
+        if (value >= 0) {
+            unsigned char c = (unsigned char) value;
+            this->captureFile->append(this->streamId, CaptureFile::INBOUND, &c, 1);
+        }
+        return value;
+    }
+    AMQ_CATCH_RETHROW(IOException)
+    AMQ_CATCHALL_THROW(IOException)
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int CaptureInputStream::doReadArrayBounded(unsigned char* buffer, int size, int offset, int length) {
+    try {
+        int numRead = FilterInputStream::doReadArrayBounded(buffer, size, offset, length);
+        if (numRead > 0) {
+            this->captureFile->append(this->streamId, CaptureFile::INBOUND, buffer + offset, numRead);
+        }
+        return numRead;
+    }
+    AMQ_CATCH_RETHROW(IOException)
+    AMQ_CATCH_RETHROW(IndexOutOfBoundsException)
+    AMQ_CATCH_RETHROW(NullPointerException)
+    AMQ_CATCHALL_THROW(IOException)
+}
@@ -0,0 +1,80 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_IO_CAPTUREINPUTSTREAM_H_
+#define _ACTIVEMQ_IO_CAPTUREINPUTSTREAM_H_
+
+#include <activemq/util/Config.h>
+#include <activemq/io/CaptureFile.h>
+#include <decaf/io/FilterInputStream.h>
+#include <decaf/lang/Pointer.h>
+
+namespace activemq {
+namespace io {
+
+    /**
+     * Appends every chunk of bytes read from the wrapped stream to a CaptureFile as
+     * an inbound record of the given stream.  Placed directly above a socket stream
+     * it records the bytes as they arrived from the peer, in the chunks the reads
+     * returned them.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API CaptureInputStream : public decaf::io::FilterInputStream {
+    private:
+
+        decaf::lang::Pointer<CaptureFile> captureFile;
+        int streamId;
+
+    public:
+
+        /**
+         * Creates a CaptureInputStream that reads from the given stream.
+         *
+         * @param inputStream
+         *      the InputStream instance to wrap.
+         * @param captureFile
+         *      the file the bytes that are read are captured to.
+         * @param streamId
+         *      the stream id of the captured records.
+         * @param own
+         *      indicates if this class owns the wrapped stream, defaults to false.
+         */
+        CaptureInputStream(decaf::io::InputStream* inputStream,
+                           const decaf::lang::Pointer<CaptureFile> captureFile,
+                           int streamId, bool own = false);
+
+        virtual ~CaptureInputStream();
+
+        /**
+         * @returns the stream id of the captured records.
+         */
+        int getStreamId() const {
+            return this->streamId;
+        }
+
+    protected:
+
+        virtual int doReadByte();
+
+        virtual int doReadArrayBounded(unsigned char* buffer, int size, int offset, int length);
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_IO_CAPTUREINPUTSTREAM_H_ */
@@ -0,0 +1,81 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CaptureOutputStream.h"
+
+#include <activemq/exceptions/ExceptionDefines.h>
+
+using namespace activemq;
+using namespace activemq::io;
+using namespace decaf::io;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+
+////////////////////////////////////////////////////////////////////////////////
+CaptureOutputStream::CaptureOutputStream(OutputStream* outputStream, const Pointer<CaptureFile> captureFile, int streamId, bool own) :
+    FilterOutputStream(outputStream, own), captureFile(captureFile), streamId(streamId) {
+
+    if (captureFile == NULL) {
+        throw NullPointerException(__FILE__, __LINE__, "CaptureFile instance cannot be NULL");
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CaptureOutputStream::~CaptureOutputStream() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CaptureOutputStream::doWriteByte(unsigned char value) {
+    try {
+        this->captureFile->append(this->streamId, CaptureFile::OUTBOUND, &value, 1);
+        FilterOutputStream::doWriteByte(value);
+    }
+    AMQ_CATCH_RETHROW(IOException)
+    AMQ_CATCHALL_THROW(IOException)
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CaptureOutputStream::doWriteArrayBounded(const unsigned char* buffer, int size, int offset, int length) {
+
+    try {
+
+        if (isClosed()) {
+            throw IOException(__FILE__, __LINE__, "CaptureOutputStream::write - Stream is closed");
+        }
+
+        if (buffer == NULL) {
+            throw NullPointerException(__FILE__, __LINE__, "CaptureOutputStream::write - Buffer passed is Null.");
+        }
+
+        if (size < 0 || offset < 0 || offset > size || length < 0 || length > size - offset) {
+            throw IndexOutOfBoundsException(__FILE__, __LINE__,
+                "CaptureOutputStream::write - size{%d}, offset{%d} and length{%d} are out of bounds.", size, offset, length);
+        }
+
+        if (length == 0) {
+            return;
+        }
+
+        // Captured before the write so any reply the peer sends is recorded after it.
+        this->captureFile->append(this->streamId, CaptureFile::OUTBOUND, buffer + offset, length);
+        this->outputStream->write(buffer, size, offset, length);
+    }
+    AMQ_CATCH_RETHROW(IOException)
+    AMQ_CATCH_RETHROW(NullPointerException)
+    AMQ_CATCH_RETHROW(IndexOutOfBoundsException)
+    AMQ_CATCHALL_THROW(IOException)
+}
@@ -0,0 +1,82 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_IO_CAPTUREOUTPUTSTREAM_H_
+#define _ACTIVEMQ_IO_CAPTUREOUTPUTSTREAM_H_
+
+#include <activemq/util/Config.h>
+#include <activemq/io/CaptureFile.h>
+#include <decaf/io/FilterOutputStream.h>
+#include <decaf/lang/Pointer.h>
+
+namespace activemq {
+namespace io {
+
+    /**
+     * Appends every chunk of bytes written to the wrapped stream to a CaptureFile as
+     * an outbound record of the given stream.  Placed directly above a socket stream
+     * and below the buffering it records each write that goes out to the peer.  The
+     * bytes are captured just before they are written so a reply from the peer is
+     * always recorded after the request that caused it.  Arrays are passed on to the
+     * wrapped stream in one write rather than a byte at a time.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API CaptureOutputStream : public decaf::io::FilterOutputStream {
+    private:
+
+        decaf::lang::Pointer<CaptureFile> captureFile;
+        int streamId;
+
+    public:
+
+        /**
+         * Creates a CaptureOutputStream that writes to the given stream.
+         *
+         * @param outputStream
+         *      the OutputStream instance to wrap.
+         * @param captureFile
+         *      the file the bytes that are written are captured to.
+         * @param streamId
+         *      the stream id of the captured records.
+         * @param own
+         *      indicates if this class owns the wrapped stream, defaults to false.
+         */
+        CaptureOutputStream(decaf::io::OutputStream* outputStream,
+                            const decaf::lang::Pointer<CaptureFile> captureFile,
+                            int streamId, bool own = false);
+
+        virtual ~CaptureOutputStream();
+
+        /**
+         * @returns the stream id of the captured records.
+         */
+        int getStreamId() const {
+            return this->streamId;
+        }
+
+    protected:
+
+        virtual void doWriteByte(unsigned char value);
+
+        virtual void doWriteArrayBounded(const unsigned char* buffer, int size, int offset, int length);
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_IO_CAPTUREOUTPUTSTREAM_H_ */
@@ -0,0 +1,101 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_IO_CAPTURERECORD_H_
+#define _ACTIVEMQ_IO_CAPTURERECORD_H_
+
+#include <activemq/util/Config.h>
+
+#include <vector>
+
+namespace activemq {
+namespace io {
+
+    /**
+     * One record read back from a CaptureFile, the bytes a transport read from or
+     * wrote to its peer at one point in time.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API CaptureRecord {
+    private:
+
+        int streamId;
+        int flags;
+        long long timestamp;
+        std::vector<unsigned char> data;
+
+    public:
+
+        CaptureRecord() : streamId(0), flags(0), timestamp(0), data() {}
+
+        virtual ~CaptureRecord() {}
+
+        /**
+         * @returns the id of the connection the bytes belong to.
+         */
+        int getStreamId() const {
+            return this->streamId;
+        }
+
+        void setStreamId(int streamId) {
+            this->streamId = streamId;
+        }
+
+        /**
+         * @returns the record flags, CaptureFile::INBOUND or CaptureFile::OUTBOUND.
+         */
+        int getFlags() const {
+            return this->flags;
+        }
+
+        void setFlags(int flags) {
+            this->flags = flags;
+        }
+
+        /**
+         * @returns true if the bytes were read from the peer.
+         */
+        bool isInbound() const;
+
+        /**
+         * @returns the time the bytes were captured in nanoseconds since the epoch.
+         */
+        long long getTimestamp() const {
+            return this->timestamp;
+        }
+
+        void setTimestamp(long long timestamp) {
+            this->timestamp = timestamp;
+        }
+
+        /**
+         * @returns the captured bytes.
+         */
+        const std::vector<unsigned char>& getData() const {
+            return this->data;
+        }
+
+        std::vector<unsigned char>& getData() {
+            return this->data;
+        }
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_IO_CAPTURERECORD_H_ */
@@ -0,0 +1,146 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FileRegion.h"
+
+#include <decaf/io/IOException.h>
+#include <decaf/lang/Integer.h>
+#include <decaf/lang/Long.h>
+#include <decaf/lang/exceptions/IllegalArgumentException.h>
+
+#if HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#if HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#if HAVE_FCNTL_H && HAVE_UNISTD_H && HAVE_SYS_STAT_H
+#define AMQ_FILEREGION_USE_POSIX
+#endif
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::io;
+using namespace decaf::io;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+
+////////////////////////////////////////////////////////////////////////////////
+FileRegion::FileRegion(const std::string& path, long long position, int length) :
+    path(path), position(position), length(length) {
+
+    if (position < 0 || length < 0) {
+        throw IllegalArgumentException(__FILE__, __LINE__,
+            "FileRegion - Invalid region: position %lld, length %d", position, length);
+    }
+
+    long long fileSize = -1;
+
+#ifdef AMQ_FILEREGION_USE_POSIX
+    struct stat status;
+    if (::stat(path.c_str(), &status) == 0 && S_ISREG(status.st_mode)) {
+        fileSize = (long long) status.st_size;
+    }
+#else
+    FILE* file = ::fopen(path.c_str(), "rb");
+    if (file != NULL) {
+        if (::fseek(file, 0, SEEK_END) == 0) {
+            fileSize = (long long) ::ftell(file);
+        }
+        ::fclose(file);
+    }
+#endif
+
+    if (fileSize < 0) {
+        throw IOException(__FILE__, __LINE__,
+            "FileRegion - Cannot read file: %s", path.c_str());
+    }
+
+    if (position + length > fileSize) {
+        throw IOException(__FILE__, __LINE__,
+            "FileRegion - Region ends at %lld beyond the end of %s (%lld bytes)",
+            position + length, path.c_str(), fileSize);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+FileRegion::~FileRegion() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void FileRegion::read(unsigned char* buffer) const {
+
+    if (this->length == 0) {
+        return;
+    }
+
+    if (buffer == NULL) {
+        throw IOException(__FILE__, __LINE__, "FileRegion::read - Buffer passed is NULL");
+    }
+
+    int done = 0;
+
+#ifdef AMQ_FILEREGION_USE_POSIX
+    int fd = ::open(this->path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw IOException(__FILE__, __LINE__,
+            "FileRegion::read - Cannot open %s: %s", this->path.c_str(), ::strerror(errno));
+    }
+
+    while (done < this->length) {
+        ssize_t result = ::pread(fd, buffer + done, (size_t) (this->length - done), (off_t) (this->position + done));
+        if (result < 0 && errno == EINTR) {
+            continue;
+        } else if (result <= 0) {
+            break;
+        }
+        done += (int) result;
+    }
+
+    ::close(fd);
+#else
+    FILE* file = ::fopen(this->path.c_str(), "rb");
+    if (file == NULL) {
+        throw IOException(__FILE__, __LINE__,
+            "FileRegion::read - Cannot open %s", this->path.c_str());
+    }
+
+    if (::fseek(file, (long) this->position, SEEK_SET) == 0) {
+        done = (int) ::fread(buffer, 1, (size_t) this->length, file);
+    }
+
+    ::fclose(file);
+#endif
+
+    if (done != this->length) {
+        throw IOException(__FILE__, __LINE__,
+            "FileRegion::read - Read %d of %d bytes from %s", done, this->length, this->path.c_str());
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string FileRegion::toString() const {
+    return this->path + "[" + Long::toString(this->position) + ", " + Integer::toString(this->length) + "]";
+}
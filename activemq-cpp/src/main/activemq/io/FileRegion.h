@@ -0,0 +1,102 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_IO_FILEREGION_H_
+#define _ACTIVEMQ_IO_FILEREGION_H_
+
+#include <activemq/util/Config.h>
+
+#include <string>
+
+namespace activemq {
+namespace io {
+
+    /**
+     * Describes a range of bytes in a file that is used in place of an in memory
+     * buffer, for example as the body of a BytesMessage.  The region is checked
+     * against the size of the file when it is created, the bytes themselves are
+     * only read when they are needed.  A FileRegion is immutable once created.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API FileRegion {
+    private:
+
+        std::string path;
+        long long position;
+        int length;
+
+    public:
+
+        /**
+         * Creates a region of the named file.
+         *
+         * @param path
+         *      The path of the file.
+         * @param position
+         *      The offset into the file of the first byte of the region.
+         * @param length
+         *      The number of bytes in the region.
+         *
+         * @throw IllegalArgumentException if position or length is negative.
+         * @throw IOException if the file cannot be read or is shorter than the region.
+         */
+        FileRegion(const std::string& path, long long position, int length);
+
+        virtual ~FileRegion();
+
+        /**
+         * @returns the path of the file.
+         */
+        const std::string& getPath() const {
+            return this->path;
+        }
+
+        /**
+         * @returns the offset into the file of the first byte of the region.
+         */
+        long long getPosition() const {
+            return this->position;
+        }
+
+        /**
+         * @returns the number of bytes in the region.
+         */
+        int getLength() const {
+            return this->length;
+        }
+
+        /**
+         * Reads the whole region from the file into the given buffer.
+         *
+         * @param buffer
+         *      The buffer to read into, at least getLength() bytes in size.
+         *
+         * @throw IOException if the file cannot be read or no longer holds the region.
+         */
+        void read(unsigned char* buffer) const;
+
+        /**
+         * @returns a string describing this region.
+         */
+        std::string toString() const;
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_IO_FILEREGION_H_ */
@@ -0,0 +1,64 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FileRegionDataOutputStream.h"
+
+#include <activemq/exceptions/ExceptionDefines.h>
+#include <decaf/io/IOException.h>
+#include <decaf/lang/exceptions/NullPointerException.h>
+#include <decaf/internal/net/tcp/TcpSocketOutputStream.h>
+
+using namespace activemq;
+using namespace activemq::io;
+using namespace decaf::io;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::internal::net::tcp;
+
+////////////////////////////////////////////////////////////////////////////////
+FileRegionDataOutputStream::FileRegionDataOutputStream(OutputStream* outputStream,
+                                                       TcpSocketOutputStream* socketStream, bool own) :
+    DataOutputStream(outputStream, own), socketStream(socketStream) {
+
+    if (socketStream == NULL) {
+        throw NullPointerException(__FILE__, __LINE__, "Socket stream passed was NULL.");
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+FileRegionDataOutputStream::~FileRegionDataOutputStream() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void FileRegionDataOutputStream::writeFileRegion(const unsigned char* header, int headerLength,
+                                                 const FileRegion& region,
+                                                 const unsigned char* trailer, int trailerLength) {
+
+    try {
+
+        // Anything buffered above the socket has to go out ahead of the region.
+        this->flush();
+
+        this->socketStream->sendFile(region.getPath(), region.getPosition(), region.getLength(),
+                                     header, headerLength, trailer, trailerLength);
+
+        this->written += (long long) headerLength + region.getLength() + trailerLength;
+    }
+    AMQ_CATCH_RETHROW(IOException)
+    AMQ_CATCH_EXCEPTION_CONVERT(Exception, IOException)
+    AMQ_CATCHALL_THROW(IOException)
+}
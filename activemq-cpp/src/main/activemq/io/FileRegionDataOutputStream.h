@@ -0,0 +1,100 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_IO_FILEREGIONDATAOUTPUTSTREAM_H_
+#define _ACTIVEMQ_IO_FILEREGIONDATAOUTPUTSTREAM_H_
+
+#include <activemq/util/Config.h>
+#include <activemq/io/FileRegion.h>
+#include <decaf/io/DataOutputStream.h>
+
+namespace decaf {
+namespace internal {
+namespace net {
+namespace tcp {
+    class TcpSocketOutputStream;
+}}}}
+
+namespace activemq {
+namespace io {
+
+    /**
+     * A DataOutputStream for a plain TCP socket that can also write a region of a file
+     * to the socket without copying it through user space.  The wrapped stream chain
+     * is flushed and the file region, along with a header and trailer from memory, is
+     * handed to the socket's sendfile support.  Streams that see the written bytes,
+     * such as capture or logging streams, must not sit between the two since the file
+     * bytes never pass through them.
+     *
+     * Wire formats check for this type to decide whether a file backed message body
+     * can be sent as it is or must be read into memory first.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API FileRegionDataOutputStream : public decaf::io::DataOutputStream {
+    private:
+
+        decaf::internal::net::tcp::TcpSocketOutputStream* socketStream;
+
+    private:
+
+        FileRegionDataOutputStream(const FileRegionDataOutputStream&);
+        FileRegionDataOutputStream& operator=(const FileRegionDataOutputStream&);
+
+    public:
+
+        /**
+         * Creates a FileRegionDataOutputStream.
+         *
+         * @param outputStream
+         *      The stream chain that ordinary writes go to.
+         * @param socketStream
+         *      The socket stream at the bottom of that chain.
+         * @param own
+         *      Indicates if this class owns the wrapped stream, defaults to false.
+         */
+        FileRegionDataOutputStream(decaf::io::OutputStream* outputStream,
+                                   decaf::internal::net::tcp::TcpSocketOutputStream* socketStream,
+                                   bool own = false);
+
+        virtual ~FileRegionDataOutputStream();
+
+        /**
+         * Writes the header, the bytes of the file region and then the trailer, after
+         * flushing anything already written to this stream.
+         *
+         * @param header
+         *      Bytes written before the file region.
+         * @param headerLength
+         *      The number of header bytes.
+         * @param region
+         *      The region of the file to write.
+         * @param trailer
+         *      Bytes written after the file region.
+         * @param trailerLength
+         *      The number of trailer bytes.
+         *
+         * @throw IOException if an I/O error occurs.
+         */
+        void writeFileRegion(const unsigned char* header, int headerLength, const FileRegion& region,
+                             const unsigned char* trailer, int trailerLength);
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_IO_FILEREGIONDATAOUTPUTSTREAM_H_ */
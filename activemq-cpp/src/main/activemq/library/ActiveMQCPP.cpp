@@ -22,6 +22,7 @@
 #include <activemq/transport/TransportRegistry.h>
 
 #include <activemq/util/IdGenerator.h>
+#include <activemq/util/MessageArena.h>
 
 #include <activemq/wireformat/stomp/StompWireFormatFactory.h>
 #include <activemq/wireformat/openwire/OpenWireFormatFactory.h>
@@ -30,6 +31,7 @@
 #include <activemq/transport/tcp/TcpTransportFactory.h>
 #include <activemq/transport/tcp/SslTransportFactory.h>
 #include <activemq/transport/failover/FailoverTransportFactory.h>
+#include <activemq/transport/replay/ReplayTransportFactory.h>
 
 using namespace activemq;
 using namespace activemq::library;
@@ -38,6 +40,7 @@ using namespace activemq::transport;
 using namespace activemq::transport::tcp;
 using namespace activemq::transport::mock;
 using namespace activemq::transport::failover;
+using namespace activemq::transport::replay;
 using namespace activemq::wireformat;
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -64,6 +67,9 @@ void ActiveMQCPP::initializeLibrary(int argc, char** argv) {
 
     // Start the IdGenerator Kernel
     IdGenerator::initialize();
+
+    // Per thread arenas for transient marshaling memory.
+    MessageArena::initialize();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -74,6 +80,8 @@ void ActiveMQCPP::initializeLibrary() {
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQCPP::shutdownLibrary() {
 
+    MessageArena::shutdown();
+
     // Shutdown the IdGenerator Kernel
     IdGenerator::shutdown();
 
@@ -106,4 +114,5 @@ void ActiveMQCPP::registerTransports() {
     TransportRegistry::getInstance().registerFactory("ssl", new SslTransportFactory());
     TransportRegistry::getInstance().registerFactory("mock", new MockTransportFactory());
     TransportRegistry::getInstance().registerFactory("failover", new FailoverTransportFactory());
+    TransportRegistry::getInstance().registerFactory("replay", new ReplayTransportFactory());
 }
@@ -115,8 +115,16 @@ namespace state {
             return sessions.remove(id);
         }
 
-        const Pointer<SessionState> getSessionState(Pointer<SessionId> id) const {
-            return sessions.get(id);
+        /**
+         * @return the state of the given session, or NULL if it isn't being tracked.
+         */
+        const Pointer<SessionState> getSessionState(Pointer<SessionId> id) {
+            synchronized(&sessions) {
+                if (sessions.containsKey(id)) {
+                    return sessions.get(id);
+                }
+            }
+            return Pointer<SessionState>();
         }
 
         const LinkedList<Pointer<DestinationInfo> >& getTempDesinations() const {
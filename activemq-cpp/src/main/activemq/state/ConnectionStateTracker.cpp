@@ -129,6 +129,20 @@ namespace state {
             }
             AMQ_CATCHALL_NOTHROW()
         }
+
+        /**
+         * Looks up the state of a connection, returning NULL rather than throwing when
+         * it isn't tracked, commands for a connection that is already gone are routine
+         * while the transport is going down.
+         */
+        Pointer<ConnectionState> getConnectionState(const Pointer<ConnectionId>& id) {
+            synchronized(&connectionStates) {
+                if (connectionStates.containsKey(id)) {
+                    return connectionStates.get(id);
+                }
+            }
+            return Pointer<ConnectionState>();
+        }
     };
 
     class RemoveTransactionAction : public Runnable {
@@ -208,7 +222,9 @@ void ConnectionStateTracker::trackBack(Pointer<Command> command) {
             if (trackMessages && command->isMessage()) {
                 Pointer<Message> message = command.dynamicCast<Message>();
                 if (message->getTransactionId() == NULL) {
-                    this->impl->messageCache.currentCacheSize += message->getSize();
+                    synchronized(&this->impl->messageCache) {
+                        this->impl->messageCache.currentCacheSize += message->getSize();
+                    }
                 }
             }
         }
@@ -245,14 +261,22 @@ void ConnectionStateTracker::restore(Pointer<transport::Transport> transport) {
         }
 
         // Now we flush messages
-        Pointer<Iterator<Pointer<Command> > > messages(this->impl->messageCache.values().iterator());
-        while (messages->hasNext()) {
-            transport->oneway(messages->next());
+        std::vector<Pointer<Command> > messages;
+        synchronized(&this->impl->messageCache) {
+            messages = this->impl->messageCache.values().toArray();
+        }
+        std::vector<Pointer<Command> >::const_iterator message = messages.begin();
+        for (; message != messages.end(); ++message) {
+            transport->oneway(*message);
         }
 
-        Pointer<Iterator<Pointer<Command> > > messagePullIter(this->impl->messagePullCache.values().iterator());
-        while (messagePullIter->hasNext()) {
-            transport->oneway(messagePullIter->next());
+        std::vector<Pointer<Command> > pulls;
+        synchronized(&this->impl->messagePullCache) {
+            pulls = this->impl->messagePullCache.values().toArray();
+        }
+        std::vector<Pointer<Command> >::const_iterator pull = pulls.begin();
+        for (; pull != pulls.end(); ++pull) {
+            transport->oneway(*pull);
         }
     }
     AMQ_CATCH_RETHROW(IOException)
@@ -448,7 +472,7 @@ Pointer<Command> ConnectionStateTracker::processProducerInfo(ProducerInfo* info)
             if (sessionId != NULL) {
                 Pointer<ConnectionId> connectionId = sessionId->getParentId();
                 if (connectionId != NULL) {
-                    Pointer<ConnectionState> cs = this->impl->connectionStates.get(connectionId);
+                    Pointer<ConnectionState> cs = this->impl->getConnectionState(connectionId);
                     if (cs != NULL) {
                         Pointer<SessionState> ss = cs->getSessionState(sessionId);
                         if (ss != NULL) {
@@ -474,7 +498,7 @@ Pointer<Command> ConnectionStateTracker::processRemoveProducer(ProducerId* id) {
             if (sessionId != NULL) {
                 Pointer<ConnectionId> connectionId = sessionId->getParentId();
                 if (connectionId != NULL) {
-                    Pointer<ConnectionState> cs = this->impl->connectionStates.get(connectionId);
+                    Pointer<ConnectionState> cs = this->impl->getConnectionState(connectionId);
                     if (cs != NULL) {
                         Pointer<SessionState> ss = cs->getSessionState(sessionId);
                         if (ss != NULL) {
@@ -501,7 +525,7 @@ Pointer<Command> ConnectionStateTracker::processConsumerInfo(ConsumerInfo* info)
             if (sessionId != NULL) {
                 Pointer<ConnectionId> connectionId = sessionId->getParentId();
                 if (connectionId != NULL) {
-                    Pointer<ConnectionState> cs = this->impl->connectionStates.get(connectionId);
+                    Pointer<ConnectionState> cs = this->impl->getConnectionState(connectionId);
                     if (cs != NULL) {
                         Pointer<SessionState> ss = cs->getSessionState(sessionId);
                         if (ss != NULL) {
@@ -527,7 +551,7 @@ Pointer<Command> ConnectionStateTracker::processRemoveConsumer(ConsumerId* id) {
             if (sessionId != NULL) {
                 Pointer<ConnectionId> connectionId = sessionId->getParentId();
                 if (connectionId != NULL) {
-                    Pointer<ConnectionState> cs = this->impl->connectionStates.get(connectionId);
+                    Pointer<ConnectionState> cs = this->impl->getConnectionState(connectionId);
                     if (cs != NULL) {
                         Pointer<SessionState> ss = cs->getSessionState(sessionId);
                         if (ss != NULL) {
@@ -536,6 +560,18 @@ Pointer<Command> ConnectionStateTracker::processRemoveConsumer(ConsumerId* id) {
                     }
                 }
             }
+
+            // Pulls for a closed consumer must not be replayed.
+            synchronized(&this->impl->messagePullCache) {
+                std::vector<std::string> keys(this->impl->messagePullCache.keySet().toArray());
+                std::vector<std::string>::const_iterator key = keys.begin();
+                for (; key != keys.end(); ++key) {
+                    Pointer<MessagePull> pull = this->impl->messagePullCache.get(*key).dynamicCast<MessagePull>();
+                    if (pull->getConsumerId()->equals(*id)) {
+                        this->impl->messagePullCache.remove(*key);
+                    }
+                }
+            }
         }
         return this->impl->TRACKED_RESPONSE_MARKER;
     }
@@ -552,7 +588,7 @@ Pointer<Command> ConnectionStateTracker::processSessionInfo(SessionInfo* info) {
         if (info != NULL) {
             Pointer<ConnectionId> connectionId = info->getSessionId()->getParentId();
             if (connectionId != NULL) {
-                Pointer<ConnectionState> cs = this->impl->connectionStates.get(connectionId);
+                Pointer<ConnectionState> cs = this->impl->getConnectionState(connectionId);
                 if (cs != NULL) {
                     cs->addSession(Pointer<SessionInfo>(info->cloneDataStructure()));
                 }
@@ -573,7 +609,7 @@ Pointer<Command> ConnectionStateTracker::processRemoveSession(SessionId* id) {
         if (id != NULL) {
             Pointer<ConnectionId> connectionId = id->getParentId();
             if (connectionId != NULL) {
-                Pointer<ConnectionState> cs = this->impl->connectionStates.get(connectionId);
+                Pointer<ConnectionState> cs = this->impl->getConnectionState(connectionId);
                 if (cs != NULL) {
                     cs->removeSession(Pointer<SessionId>(id->cloneDataStructure()));
                 }
@@ -628,7 +664,7 @@ Pointer<Command> ConnectionStateTracker::processMessage(Message* message) {
                 Pointer<ConnectionId> connectionId = producerId->getParentId()->getParentId();
 
                 if (connectionId != NULL) {
-                    Pointer<ConnectionState> cs = this->impl->connectionStates.get(connectionId);
+                    Pointer<ConnectionState> cs = this->impl->getConnectionState(connectionId);
                     if (cs != NULL) {
                         Pointer<TransactionState> transactionState = cs->getTransactionState(message->getTransactionId());
                         if (transactionState != NULL) {
@@ -637,16 +673,20 @@ Pointer<Command> ConnectionStateTracker::processMessage(Message* message) {
                             if (trackTransactionProducers) {
                                 // Track the producer in case it is closed before a commit
                                 Pointer<SessionState> sessionState = cs->getSessionState(producerId->getParentId());
-                                Pointer<ProducerState> producerState = sessionState->getProducerState(producerId);
-                                producerState->setTransactionState(transactionState);
+                                if (sessionState != NULL) {
+                                    Pointer<ProducerState> producerState = sessionState->getProducerState(producerId);
+                                    producerState->setTransactionState(transactionState);
+                                }
                             }
                         }
                     }
                 }
                 return this->impl->TRACKED_RESPONSE_MARKER;
             } else if (trackMessages) {
-                this->impl->messageCache.put(
-                    message->getMessageId(), Pointer<Message>(message->cloneDataStructure()));
+                Pointer<Command> copy(message->cloneDataStructure());
+                synchronized(&this->impl->messageCache) {
+                    this->impl->messageCache.put(message->getMessageId(), copy);
+                }
             }
         }
 
@@ -665,7 +705,7 @@ Pointer<Command> ConnectionStateTracker::processBeginTransaction(TransactionInfo
         if (trackTransactions && info != NULL) {
             Pointer<ConnectionId> connectionId = info->getConnectionId();
             if (connectionId != NULL) {
-                Pointer<ConnectionState> cs = this->impl->connectionStates.get(connectionId);
+                Pointer<ConnectionState> cs = this->impl->getConnectionState(connectionId);
                 if (cs != NULL) {
                     cs->addTransactionState(info->getTransactionId());
                     Pointer<TransactionState> transactionState = cs->getTransactionState(info->getTransactionId());
@@ -691,7 +731,7 @@ Pointer<Command> ConnectionStateTracker::processPrepareTransaction(TransactionIn
         if (trackTransactions && info != NULL) {
             Pointer<ConnectionId> connectionId = info->getConnectionId();
             if (connectionId != NULL) {
-                Pointer<ConnectionState> cs = this->impl->connectionStates.get(connectionId);
+                Pointer<ConnectionState> cs = this->impl->getConnectionState(connectionId);
                 if (cs != NULL) {
                     Pointer<TransactionState> transactionState = cs->getTransactionState(info->getTransactionId());
                     if (transactionState != NULL) {
@@ -718,7 +758,7 @@ Pointer<Command> ConnectionStateTracker::processCommitTransactionOnePhase(Transa
         if (trackTransactions && info != NULL) {
             Pointer<ConnectionId> connectionId = info->getConnectionId();
             if (connectionId != NULL) {
-                Pointer<ConnectionState> cs = this->impl->connectionStates.get(connectionId);
+                Pointer<ConnectionState> cs = this->impl->getConnectionState(connectionId);
                 if (cs != NULL) {
                     Pointer<TransactionState> transactionState = cs->getTransactionState(info->getTransactionId());
                     if (transactionState != NULL) {
@@ -745,7 +785,7 @@ Pointer<Command> ConnectionStateTracker::processCommitTransactionTwoPhase(Transa
         if (trackTransactions && info != NULL) {
             Pointer<ConnectionId> connectionId = info->getConnectionId();
             if (connectionId != NULL) {
-                Pointer<ConnectionState> cs = this->impl->connectionStates.get(connectionId);
+                Pointer<ConnectionState> cs = this->impl->getConnectionState(connectionId);
                 if (cs != NULL) {
                     Pointer<TransactionState> transactionState = cs->getTransactionState(info->getTransactionId());
                     if (transactionState != NULL) {
@@ -772,7 +812,7 @@ Pointer<Command> ConnectionStateTracker::processRollbackTransaction(TransactionI
         if (trackTransactions && info != NULL) {
             Pointer<ConnectionId> connectionId = info->getConnectionId();
             if (connectionId != NULL) {
-                Pointer<ConnectionState> cs = this->impl->connectionStates.get(connectionId);
+                Pointer<ConnectionState> cs = this->impl->getConnectionState(connectionId);
                 if (cs != NULL) {
                     Pointer<TransactionState> transactionState = cs->getTransactionState(info->getTransactionId());
                     if (transactionState != NULL) {
@@ -799,7 +839,7 @@ Pointer<Command> ConnectionStateTracker::processEndTransaction(TransactionInfo*
         if (trackTransactions && info != NULL) {
             Pointer<ConnectionId> connectionId = info->getConnectionId();
             if (connectionId != NULL) {
-                Pointer<ConnectionState> cs = this->impl->connectionStates.get(connectionId);
+                Pointer<ConnectionState> cs = this->impl->getConnectionState(connectionId);
                 if (cs != NULL) {
                     Pointer<TransactionState> transactionState = cs->getTransactionState(info->getTransactionId());
                     if (transactionState != NULL) {
@@ -825,7 +865,15 @@ Pointer<Command> ConnectionStateTracker::processMessagePull(MessagePull* pull) {
 
         if (pull != NULL && pull->getDestination() != NULL && pull->getConsumerId() != NULL) {
             std::string id = pull->getDestination()->toString() + "::" + pull->getConsumerId()->toString();
-            this->impl->messagePullCache.put(id, Pointer<Command>(pull->cloneDataStructure()));
+
+            // Pipelined pulls carry the slot they occupy so each outstanding pull is replayed.
+            if (!pull->getCorrelationId().empty()) {
+                id += "::" + pull->getCorrelationId();
+            }
+
+            synchronized(&this->impl->messagePullCache) {
+                this->impl->messagePullCache.put(id, Pointer<Command>(pull->cloneDataStructure()));
+            }
         }
 
         return Pointer<Command>();
@@ -19,6 +19,8 @@
 
 #include <activemq/exceptions/ActiveMQException.h>
 
+#include <decaf/lang/System.h>
+
 using namespace activemq;
 using namespace activemq::threads;
 using namespace activemq::exceptions;
@@ -28,7 +30,7 @@ using namespace decaf::lang::exceptions;
 
 ////////////////////////////////////////////////////////////////////////////////
 DedicatedTaskRunner::DedicatedTaskRunner(Task* task) :
-    mutex(), thread(), threadTerminated(false), pending(false), shutDown(false), task(task) {
+    mutex(), thread(), threadTerminated(false), pending(false), shutDown(false), wakeupTime(0), task(task) {
 
     if (this->task == NULL) {
         throw NullPointerException(__FILE__, __LINE__, "Task passed was null");
@@ -124,6 +126,28 @@ void DedicatedTaskRunner::wakeup() {
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void DedicatedTaskRunner::wakeupAfter(long long delay) {
+
+    if (delay <= 0) {
+        this->wakeup();
+        return;
+    }
+
+    long long time = System::nanoTime() / 1000000 + delay;
+
+    synchronized(&mutex) {
+        if (shutDown) {
+            return;
+        }
+
+        if (wakeupTime == 0 || time < wakeupTime) {
+            wakeupTime = time;
+            mutex.notifyAll();
+        }
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void DedicatedTaskRunner::run() {
 
@@ -133,6 +157,7 @@ void DedicatedTaskRunner::run() {
 
             synchronized(&mutex) {
                 pending = false;
+                wakeupTime = 0;
                 if (shutDown) {
                     return;
                 }
@@ -146,7 +171,15 @@ void DedicatedTaskRunner::run() {
                         return;
                     }
                     while (!pending && !shutDown) {
-                        mutex.wait();
+                        if (wakeupTime == 0) {
+                            mutex.wait();
+                        } else {
+                            long long remaining = wakeupTime - System::nanoTime() / 1000000;
+                            if (remaining <= 0) {
+                                break;
+                            }
+                            mutex.wait(remaining);
+                        }
                     }
                 }
             }
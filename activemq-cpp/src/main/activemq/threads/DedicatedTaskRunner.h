@@ -40,6 +40,7 @@ namespace threads {
         bool threadTerminated;
         bool pending;
         bool shutDown;
+        long long wakeupTime;
         Task* task;
 
     private:
@@ -76,6 +77,19 @@ namespace threads {
          */
         virtual void wakeup();
 
+        /**
+         * Signal the TaskRunner to execute another iteration cycle on the task once the
+         * given delay has passed, unless it is woken before then.  When several delayed
+         * wakeups are requested the earliest one wins, the request is dropped once the
+         * task is next iterated so a task that still needs one asks again from iterate.
+         *
+         * @param delay
+         *      Time in milliseconds before the task is iterated.
+         *
+         * @since 3.8.0
+         */
+        void wakeupAfter(long long delay);
+
     protected:
 
         virtual void run();
@@ -23,6 +23,8 @@
 #include <activemq/wireformat/WireFormat.h>
 #include <activemq/exceptions/ActiveMQException.h>
 #include <activemq/util/Config.h>
+#include <activemq/util/LatencyStatistics.h>
+#include <decaf/lang/System.h>
 #include <typeinfo>
 
 using namespace activemq;
@@ -30,6 +32,7 @@ using namespace activemq::transport;
 using namespace activemq::exceptions;
 using namespace activemq::commands;
 using namespace activemq::wireformat;
+using namespace activemq::util;
 using namespace decaf;
 using namespace decaf::io;
 using namespace decaf::lang;
@@ -58,12 +61,13 @@ namespace transport {
         Pointer<decaf::lang::Thread> thread;
         AtomicBoolean closed;
         AtomicBoolean started;
+        Pointer<LatencyStatistics> statistics;
 
-        IOTransportImpl() : wireFormat(), listener(NULL), inputStream(NULL), outputStream(NULL), thread(), closed(false) {
+        IOTransportImpl() : wireFormat(), listener(NULL), inputStream(NULL), outputStream(NULL), thread(), closed(false), started(), statistics() {
         }
 
         IOTransportImpl(const Pointer<WireFormat> wireFormat) :
-            wireFormat(wireFormat), listener(NULL), inputStream(NULL), outputStream(NULL), thread(), closed(false) {
+            wireFormat(wireFormat), listener(NULL), inputStream(NULL), outputStream(NULL), thread(), closed(false), started(), statistics() {
         }
     };
 
@@ -142,9 +146,20 @@ void IOTransport::oneway(const Pointer<Command> command) {
         }
 
         synchronized(impl->outputStream) {
-            // Write the command to the output stream.
-            this->impl->wireFormat->marshal(command, this, this->impl->outputStream);
-            this->impl->outputStream->flush();
+
+            if (this->impl->statistics == NULL) {
+                // Write the command to the output stream.
+                this->impl->wireFormat->marshal(command, this, this->impl->outputStream);
+                this->impl->outputStream->flush();
+            } else {
+                long long started = System::nanoTime();
+                this->impl->wireFormat->marshal(command, this, this->impl->outputStream);
+                long long marshaled = System::nanoTime();
+                this->impl->outputStream->flush();
+
+                this->impl->statistics->record(LatencyStatistics::MARSHAL_TIME, marshaled - started);
+                this->impl->statistics->record(LatencyStatistics::SOCKET_WRITE_TIME, System::nanoTime() - marshaled);
+            }
         }
     }
     AMQ_CATCH_RETHROW(IOException)
@@ -316,6 +331,24 @@ void IOTransport::setOutputStream(decaf::io::DataOutputStream* os) {
     this->impl->outputStream = os;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void IOTransport::setStatistics(Pointer<LatencyStatistics> statistics) {
+
+    // Writers read the statistics under the output stream's lock.
+    if (this->impl->outputStream != NULL) {
+        synchronized(this->impl->outputStream) {
+            this->impl->statistics = statistics;
+        }
+    } else {
+        this->impl->statistics = statistics;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<LatencyStatistics> IOTransport::getStatistics() const {
+    return this->impl->statistics;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 Pointer<wireformat::WireFormat> IOTransport::getWireFormat() const {
     return this->impl->wireFormat;
@@ -24,6 +24,7 @@
 #include <activemq/commands/Command.h>
 #include <activemq/commands/Response.h>
 #include <activemq/wireformat/WireFormat.h>
+#include <activemq/util/LatencyStatistics.h>
 
 #include <decaf/lang/Runnable.h>
 #include <decaf/lang/Thread.h>
@@ -121,6 +122,21 @@ namespace transport {
          */
         virtual void setOutputStream(decaf::io::DataOutputStream* os);
 
+        /**
+         * Sets the statistics that the time spent marshaling each command and flushing
+         * it to the output stream is recorded in.  When NULL, the default, no timings
+         * are taken.
+         *
+         * @param statistics
+         *      The statistics to record write timings in, or NULL to stop recording.
+         */
+        void setStatistics(Pointer<activemq::util::LatencyStatistics> statistics);
+
+        /**
+         * @returns the statistics write timings are recorded in, or NULL if none are set.
+         */
+        Pointer<activemq::util::LatencyStatistics> getStatistics() const;
+
     public:  // Transport methods
 
         virtual void oneway(const Pointer<Command> command);
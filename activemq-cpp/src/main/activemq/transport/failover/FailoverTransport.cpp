@@ -18,6 +18,7 @@
 #include "FailoverTransport.h"
 
 #include <activemq/commands/ConnectionControl.h>
+#include <activemq/commands/Message.h>
 #include <activemq/commands/ShutdownInfo.h>
 #include <activemq/commands/RemoveInfo.h>
 #include <activemq/transport/TransportRegistry.h>
@@ -27,6 +28,7 @@
 #include <activemq/transport/failover/URIPool.h>
 #include <activemq/transport/failover/FailoverTransportListener.h>
 #include <activemq/transport/failover/CloseTransportsTask.h>
+#include <activemq/transport/failover/MessageSpool.h>
 #include <activemq/transport/failover/URIPool.h>
 #include <decaf/util/Random.h>
 #include <decaf/util/StringTokenizer.h>
@@ -34,8 +36,11 @@
 #include <decaf/util/StlMap.h>
 #include <decaf/util/concurrent/TimeUnit.h>
 #include <decaf/util/concurrent/Mutex.h>
+#include <decaf/util/concurrent/atomic/AtomicInteger.h>
+#include <decaf/util/concurrent/atomic/AtomicReference.h>
 #include <decaf/lang/System.h>
 #include <decaf/lang/Integer.h>
+#include <decaf/lang/ThreadLocal.h>
 
 using namespace std;
 using namespace activemq;
@@ -50,9 +55,13 @@ using namespace decaf::io;
 using namespace decaf::net;
 using namespace decaf::util;
 using namespace decaf::util::concurrent;
+using namespace decaf::util::concurrent::atomic;
 using namespace decaf::lang;
 using namespace decaf::lang::exceptions;
 
+////////////////////////////////////////////////////////////////////////////////
+LOGDECAF_INITIALIZE( logger, FailoverTransport, "activemq.transport.failover.FailoverTransport")
+
 ////////////////////////////////////////////////////////////////////////////////
 namespace activemq {
 namespace transport {
@@ -98,6 +107,10 @@ namespace failover {
         bool doRebalance;
         bool connectedToPrioirty;
 
+        std::string spoolDirectory;
+        long long spoolMaxSize;
+        int spoolSegmentSize;
+
         mutable Mutex reconnectMutex;
         mutable Mutex sleepMutex;
         mutable Mutex listenerMutex;
@@ -116,6 +129,29 @@ namespace failover {
         Pointer<TransportListener> disposedListener;
         Pointer<TransportListener> myTransportListener;
 
+        // Lock free view of the connected Transport used by oneway() once the
+        // connection state has been restored, the generation changes each time
+        // a Transport is published or retracted so a late failure on a retired
+        // Transport can't tear down its replacement.
+        AtomicReference<Transport> sendTransport;
+        AtomicInteger sendGeneration;
+        AtomicInteger activeSenders;
+
+        // A retract waits on sendersMutex for the active senders to finish, senders
+        // only signal it while someone is waiting so the send path stays lock free.
+        // Each thread's own sends are counted so a failure reported from inside a
+        // send doesn't wait on itself.
+        Mutex sendersMutex;
+        AtomicInteger sendersWaiters;
+        ThreadLocal<int> threadSenders;
+
+        // Persistent sends made while reconnecting are written here when a spool
+        // directory is configured, spooling is only true between a failure and the
+        // point where the spool has been drained onto the new Transport.
+        Pointer<MessageSpool> spool;
+        Mutex spoolMutex;
+        bool spooling;
+
         TransportListener* transportListener;
 
         FailoverTransportImpl(FailoverTransport* parent) :
@@ -145,6 +181,9 @@ namespace failover {
             backupsEnabled(false),
             doRebalance(false),
             connectedToPrioirty(false),
+            spoolDirectory(),
+            spoolMaxSize(MessageSpool::DEFAULT_MAX_SIZE),
+            spoolSegmentSize(MessageSpool::DEFAULT_SEGMENT_SIZE),
             reconnectMutex(),
             sleepMutex(),
             listenerMutex(),
@@ -160,6 +199,15 @@ namespace failover {
             taskRunner(new CompositeTaskRunner()),
             disposedListener(),
             myTransportListener(new FailoverTransportListener(parent)),
+            sendTransport(),
+            sendGeneration(),
+            activeSenders(),
+            sendersMutex(),
+            sendersWaiters(),
+            threadSenders(),
+            spool(),
+            spoolMutex(),
+            spooling(false),
             transportListener(NULL) {
 
             this->backups.reset(
@@ -252,7 +300,88 @@ namespace failover {
             return connectedTransport != NULL && !doRebalance && !this->backups->isPriorityBackupAvailable();
         }
 
+        /**
+         * Makes the connected Transport available to senders that don't hold the
+         * reconnect mutex.  This must be called with the reconnect mutex locked and
+         * only after the connection state has been restored on the Transport.
+         */
+        void publishTransport() {
+            sendGeneration.incrementAndGet();
+            sendTransport.set(connectedTransport.get());
+        }
+
+        /**
+         * Registers the calling thread as a sender, it must be matched by a call to
+         * endSend() once the sender is done with the published Transport.
+         */
+        void beginSend() {
+            activeSenders.incrementAndGet();
+            threadSenders.get()++;
+        }
+
+        void endSend() {
+            threadSenders.get()--;
+            activeSenders.decrementAndGet();
+
+            if (sendersWaiters.get() > 0) {
+                synchronized(&sendersMutex) {
+                    sendersMutex.notifyAll();
+                }
+            }
+        }
+
+        /**
+         * Withdraws the published Transport so no new sender can pick it up, senders
+         * that fail on it afterwards see the changed generation and leave the failover
+         * to whoever withdrew it.
+         *
+         * @return true if a Transport was published.
+         */
+        bool withdrawTransport() {
+            if (sendTransport.getAndSet(NULL) == NULL) {
+                return false;
+            }
+
+            sendGeneration.incrementAndGet();
+            return true;
+        }
+
+        /**
+         * Blocks until every sender other than the calling thread is done with the
+         * withdrawn Transport, after which it can be released.
+         */
+        void awaitSenders() {
+
+            int own = threadSenders.get();
+
+            synchronized(&sendersMutex) {
+                sendersWaiters.incrementAndGet();
+                try {
+                    while (activeSenders.get() > own) {
+                        sendersMutex.wait();
+                    }
+                } catch (...) {
+                    sendersWaiters.decrementAndGet();
+                    throw;
+                }
+                sendersWaiters.decrementAndGet();
+            }
+        }
+
+        /**
+         * Withdraws the published Transport and waits for any sender still using it
+         * to finish, this must be called with the reconnect mutex locked and before
+         * the connected Transport is released.
+         */
+        void retractTransport() {
+            if (withdrawTransport()) {
+                awaitSenders();
+            }
+        }
+
         void disconnect() {
+            retractTransport();
+
             Pointer<Transport> transport;
             transport.swap(this->connectedTransport);
 
@@ -392,6 +521,18 @@ void FailoverTransport::oneway(const Pointer<Command> command) {
 
     try {
 
+        // While connected the send doesn't need the reconnect mutex, we only fall
+        // through to the locked path when disconnected or reconnecting.
+        if (command != NULL && onewayConnected(command)) {
+            return;
+        }
+
+        // While reconnecting persistent sends can be accepted into the spool instead
+        // of blocking the caller until a new connection is made.
+        if (command != NULL && onewaySpooled(command)) {
+            return;
+        }
+
         synchronized(&this->impl->reconnectMutex) {
 
             if (command != NULL && this->impl->connectedTransport == NULL) {
@@ -447,9 +588,10 @@ void FailoverTransport::oneway(const Pointer<Command> command) {
                     }
 
                     if (transport == NULL) {
-                        // Previous loop may have exited due to us being disposed.
+                        // Previous loop may have exited due to us being disposed, a send
+                        // on a closed transport is dropped without raising an error.
                         if (this->impl->closed) {
-                            error.reset(new IOException(__FILE__, __LINE__, "Transport disposed."));
+                            return;
                         } else if (this->impl->connectionFailure != NULL) {
                             error = this->impl->connectionFailure;
                         } else if (timedout == true) {
@@ -496,7 +638,9 @@ void FailoverTransport::oneway(const Pointer<Command> command) {
                             // since we will retry in this method.. take it out of the
                             // request map so that it is not sent 2 times on recovery
                             if (command->isResponseRequired()) {
-                                this->impl->requestMap.remove(command->getCommandId());
+                                synchronized(&this->impl->requestMap) {
+                                    this->impl->requestMap.remove(command->getCommandId());
+                                }
                             }
 
                             // re-throw the exception so it will handled by the outer catch
@@ -528,6 +672,139 @@ void FailoverTransport::oneway(const Pointer<Command> command) {
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool FailoverTransport::onewayConnected(const Pointer<Command> command) {
+
+    // Registering as an active sender before reading the published Transport means
+    // a reconnect can't retire it until this send completes.
+    this->impl->beginSend();
+
+    Transport* transport = this->impl->sendTransport.get();
+    if (transport == NULL) {
+        this->impl->endSend();
+        return false;
+    }
+
+    int generation = this->impl->sendGeneration.get();
+    Pointer<Tracked> tracked;
+
+    try {
+        tracked = stateTracker.track(command);
+        synchronized(&this->impl->requestMap) {
+            if (tracked != NULL && tracked->isWaitingForResponse()) {
+                this->impl->requestMap.put(command->getCommandId(), tracked);
+            } else if (tracked == NULL && command->isResponseRequired()) {
+                this->impl->requestMap.put(command->getCommandId(), command);
+            }
+        }
+    } catch (...) {
+        this->impl->endSend();
+        throw;
+    }
+
+    try {
+        transport->oneway(command);
+    } catch (IOException& ex) {
+
+        this->impl->endSend();
+        ex.setMark(__FILE__, __LINE__);
+
+        // Untracked commands are retried by the locked path so they must not also
+        // be replayed from the request map on recovery.
+        if (tracked == NULL && command->isResponseRequired()) {
+            synchronized(&this->impl->requestMap) {
+                this->impl->requestMap.remove(command->getCommandId());
+            }
+        }
+
+        // Only fail over if no other sender or the listener has already done so.
+        synchronized(&this->impl->reconnectMutex) {
+            if (generation == this->impl->sendGeneration.get()) {
+                handleTransportFailure(ex);
+            }
+        }
+
+        return tracked != NULL;
+    } catch (...) {
+        this->impl->endSend();
+        throw;
+    }
+
+    this->impl->endSend();
+    stateTracker.trackBack(command);
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool FailoverTransport::onewaySpooled(const Pointer<Command> command) {
+
+    if (this->impl->spool == NULL || !command->isMessage()) {
+        return false;
+    }
+
+    Pointer<Message> message = command.dynamicCast<Message>();
+
+    // Transacted sends are replayed with their transaction, non persistent ones
+    // aren't worth writing to disk.
+    if (!message->isPersistent() || message->getTransactionId() != NULL) {
+        return false;
+    }
+
+    synchronized(&this->impl->spoolMutex) {
+
+        if (!this->impl->spooling || !this->impl->spool->offer(command)) {
+            return false;
+        }
+    }
+
+    if (command->isResponseRequired()) {
+        Pointer<Response> response(new Response());
+        response->setCorrelationId(command->getCommandId());
+        this->impl->myTransportListener->onCommand(response);
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void FailoverTransport::drainSpool(const Pointer<Transport> transport) {
+
+    if (this->impl->spool == NULL) {
+        return;
+    }
+
+    try {
+
+        while (true) {
+
+            Pointer<Command> command;
+
+            synchronized(&this->impl->spoolMutex) {
+                if (this->impl->spool->isEmpty()) {
+                    // No new sends can be spooled now, they wait in the locked send
+                    // path until the Transport is published.
+                    this->impl->spooling = false;
+                    return;
+                }
+
+                command = this->impl->spool->peek();
+            }
+
+            // The sender has already been answered on our behalf.
+            command->setResponseRequired(false);
+            transport->oneway(command);
+
+            synchronized(&this->impl->spoolMutex) {
+                this->impl->spool->remove();
+            }
+        }
+    }
+    AMQ_CATCH_RETHROW(IOException)
+    AMQ_CATCH_EXCEPTION_CONVERT(Exception, IOException)
+    AMQ_CATCHALL_THROW(IOException)
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 Pointer<FutureResponse> FailoverTransport::asyncRequest(const Pointer<Command> command AMQCPP_UNUSED,
                                                         const Pointer<ResponseCallback> responseCallback AMQCPP_UNUSED) {
@@ -567,6 +844,11 @@ void FailoverTransport::start() {
             stateTracker.setTrackMessages(this->isTrackMessages());
             stateTracker.setTrackTransactionProducers(this->isTrackTransactionProducers());
 
+            if (!this->impl->spoolDirectory.empty() && this->impl->spool == NULL) {
+                this->impl->spool.reset(new MessageSpool(
+                    this->impl->spoolDirectory, this->impl->spoolMaxSize, this->impl->spoolSegmentSize));
+            }
+
             if (this->impl->connectedTransport != NULL) {
                 stateTracker.restore(this->impl->connectedTransport);
             } else {
@@ -599,6 +881,7 @@ void FailoverTransport::close() {
     try {
 
         Pointer<Transport> transportToStop;
+        bool sendersPending = false;
 
         synchronized(&this->impl->reconnectMutex) {
 
@@ -613,6 +896,11 @@ void FailoverTransport::close() {
             this->impl->backups->setEnabled(false);
             this->impl->requestMap.clear();
 
+            // Senders still using the Transport are waited for once it has been
+            // closed below, a sender blocked in a write then fails out instead of
+            // holding up the close.
+            sendersPending = this->impl->withdrawTransport();
+
             if (this->impl->connectedTransport != NULL) {
                 transportToStop.swap(this->impl->connectedTransport);
             }
@@ -628,9 +916,37 @@ void FailoverTransport::close() {
 
         this->impl->taskRunner->shutdown(TimeUnit::MINUTES.toMillis(5));
 
+        // The spooled sends were already answered as complete, while there is still
+        // a connection they are sent on it before it goes.
+        if (transportToStop != NULL && this->impl->spool != NULL) {
+            try {
+                drainSpool(transportToStop);
+            } catch (IOException& ex) {
+                // Whatever could not be sent is discarded with the spool below.
+            }
+        }
+
         if (transportToStop != NULL) {
             transportToStop->close();
         }
+
+        if (sendersPending) {
+            this->impl->awaitSenders();
+        }
+
+        if (this->impl->spool != NULL) {
+            int abandoned = 0;
+            synchronized(&this->impl->spoolMutex) {
+                this->impl->spooling = false;
+                abandoned = this->impl->spool->size();
+                this->impl->spool->close();
+            }
+
+            if (abandoned > 0) {
+                LOGDECAF_WARN(logger, "Closed while disconnected, discarded " + Integer::toString(abandoned) +
+                              " spooled persistent sends that had already been reported as sent.");
+            }
+        }
     }
     AMQ_CATCH_RETHROW( IOException)
     AMQ_CATCH_EXCEPTION_CONVERT( Exception, IOException)
@@ -690,12 +1006,24 @@ void FailoverTransport::restoreTransport(const Pointer<Transport> transport) {
 ////////////////////////////////////////////////////////////////////////////////
 void FailoverTransport::handleTransportFailure(const decaf::lang::Exception& error) {
 
-    Pointer<Transport> transport;
+    // The whole hand off is done holding the reconnect mutex, a close() that finds
+    // the connected Transport already gone then waits for this to finish instead of
+    // letting the owner destroy us while the failing Transport's thread is still here.
     synchronized(&this->impl->reconnectMutex) {
+
+        Pointer<Transport> transport;
+        this->impl->retractTransport();
         this->impl->connectedTransport.swap(transport);
-    }
 
-    if (transport != NULL) {
+        if (transport == NULL) {
+            return;
+        }
+
+        if (this->impl->spool != NULL && !this->impl->closed) {
+            synchronized(&this->impl->spoolMutex) {
+                this->impl->spooling = true;
+            }
+        }
 
         if (this->impl->disposedListener != NULL) {
             transport->setTransportListener(this->impl->disposedListener.get());
@@ -704,35 +1032,30 @@ void FailoverTransport::handleTransportFailure(const decaf::lang::Exception& err
         // Hand off to the close task so it gets done in a different thread.
         this->impl->closeTask->add(transport);
 
-        bool reconnectOk = false;
-
-        synchronized(&this->impl->reconnectMutex) {
-
-            reconnectOk = this->impl->canReconnect();
-            URI failedUri = *this->impl->connectedTransportURI;
+        bool reconnectOk = this->impl->canReconnect();
+        URI failedUri = *this->impl->connectedTransportURI;
 
-            this->impl->initialized = false;
-            this->impl->uris->addURI(failedUri);
-            this->impl->connectedTransportURI.reset(NULL);
-            this->impl->connected = false;
-            this->impl->connectedToPrioirty = false;
+        this->impl->initialized = false;
+        this->impl->uris->addURI(failedUri);
+        this->impl->connectedTransportURI.reset(NULL);
+        this->impl->connected = false;
+        this->impl->connectedToPrioirty = false;
 
-            // Place the State Tracker into a reconnection state.
-            this->stateTracker.transportInterrupted();
+        // Place the State Tracker into a reconnection state.
+        this->stateTracker.transportInterrupted();
 
-            // Notify before we attempt to reconnect so that the consumers have a chance
-            // to cleanup their state.
-            if (this->impl->transportListener != NULL) {
-                this->impl->transportListener->transportInterrupted();
-            }
+        // Notify before we attempt to reconnect so that the consumers have a chance
+        // to cleanup their state.
+        if (this->impl->transportListener != NULL) {
+            this->impl->transportListener->transportInterrupted();
+        }
 
-            if (reconnectOk) {
-                this->impl->updated->removeURI(failedUri);
-                this->impl->taskRunner->wakeup();
-            } else if (!this->impl->closed) {
-                this->impl->connectionFailure.reset(error.clone());
-                this->impl->propagateFailureToExceptionListener();
-            }
+        if (reconnectOk) {
+            this->impl->updated->removeURI(failedUri);
+            this->impl->taskRunner->wakeup();
+        } else if (!this->impl->closed) {
+            this->impl->connectionFailure.reset(error.clone());
+            this->impl->propagateFailureToExceptionListener();
         }
     }
 }
@@ -933,11 +1256,13 @@ bool FailoverTransport::iterate() {
 
                         if (this->impl->started && !this->impl->firstConnection) {
                             restoreTransport(transport);
+                            drainSpool(transport);
                         }
 
                         this->impl->reconnectDelay = this->impl->initialReconnectDelay;
                         this->impl->connectedTransportURI.reset(new URI(uri));
                         this->impl->connectedTransport = transport;
+                        this->impl->publishTransport();
                         this->impl->reconnectMutex.notifyAll();
                         this->impl->connectFailures = 0;
 
@@ -1275,6 +1600,36 @@ void FailoverTransport::setMaxPullCacheSize(int value) {
     this->impl->maxPullCacheSize = value;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+std::string FailoverTransport::getSpoolDirectory() const {
+    return this->impl->spoolDirectory;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void FailoverTransport::setSpoolDirectory(const std::string& directory) {
+    this->impl->spoolDirectory = directory;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long FailoverTransport::getSpoolMaxSize() const {
+    return this->impl->spoolMaxSize;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void FailoverTransport::setSpoolMaxSize(long long value) {
+    this->impl->spoolMaxSize = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int FailoverTransport::getSpoolSegmentSize() const {
+    return this->impl->spoolSegmentSize;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void FailoverTransport::setSpoolSegmentSize(int value) {
+    this->impl->spoolSegmentSize = value;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 bool FailoverTransport::isReconnectSupported() const {
     return this->impl->reconnectSupported;
@@ -32,6 +32,7 @@
 #include <decaf/util/Properties.h>
 #include <decaf/net/URI.h>
 #include <decaf/io/IOException.h>
+#include <decaf/util/logging/LoggerDefines.h>
 
 namespace activemq {
 namespace transport {
@@ -47,6 +48,9 @@ namespace failover {
 
     class AMQCPP_API FailoverTransport : public CompositeTransport,
                                          public activemq::threads::CompositeTask {
+
+        LOGDECAF_DECLARE(logger)
+
     private:
 
         friend class FailoverTransportListener;
@@ -216,6 +220,37 @@ namespace failover {
 
         void setMaxPullCacheSize(int value);
 
+        /**
+         * @return the directory persistent sends are spooled to while disconnected, or
+         *         an empty string if spooling is disabled.
+         *
+         * @since 3.8.0
+         */
+        std::string getSpoolDirectory() const;
+
+        /**
+         * Sets the directory that persistent, non-transacted Messages are spooled to
+         * while the transport is reconnecting, the spooled Messages are sent ahead of
+         * any new sends once a connection is restored.  Spooling is disabled when the
+         * directory is empty, this must be set before the transport is started.
+         *
+         * A spooled send has already been reported to the producer as complete.  If the
+         * transport is closed while it has no connection the Messages still in the spool
+         * cannot be delivered, they are discarded and a warning with their count is
+         * logged.
+         *
+         * @since 3.8.0
+         */
+        void setSpoolDirectory(const std::string& directory);
+
+        long long getSpoolMaxSize() const;
+
+        void setSpoolMaxSize(long long value);
+
+        int getSpoolSegmentSize() const;
+
+        void setSpoolSegmentSize(int value);
+
         bool isReconnectSupported() const;
 
         void setReconnectSupported(bool value);
@@ -286,6 +321,44 @@ namespace failover {
 
         void processResponse(const Pointer<Response> response);
 
+        /**
+         * Sends the command on the currently published Transport without taking the
+         * reconnect mutex.
+         *
+         * @param command
+         *      The Command to send.
+         *
+         * @return true if the command was handled, false if the caller must use the
+         *         locked send path because no Transport is currently published.
+         */
+        bool onewayConnected(const Pointer<Command> command);
+
+        /**
+         * Accepts a persistent non-transacted Message into the disk spool while the
+         * transport is reconnecting and simulates the Broker's Response if one is
+         * required.
+         *
+         * @param command
+         *      The Command to send.
+         *
+         * @return true if the command was spooled, false if the caller must use the
+         *         locked send path.
+         */
+        bool onewaySpooled(const Pointer<Command> command);
+
+        /**
+         * Sends every spooled Message on the given Transport in the order it was
+         * spooled, this must be called with the reconnect mutex locked after the
+         * connection state has been restored and before the Transport is published.
+         *
+         * @param transport
+         *        The new Transport connected to the Broker.
+         *
+         * @throw IOException if a Message could not be sent, those not yet sent remain
+         *        in the spool.
+         */
+        void drainSpool(const Pointer<Transport> transport);
+
     };
 
 }}}
@@ -109,6 +109,11 @@ Pointer<Transport> FailoverTransportFactory::doCreateComposite(const decaf::net:
         transport->setPriorityBackup(
             Boolean::parseBoolean(topLvlProperties.getProperty("priorityBackup", "false")));
         transport->setPriorityURIs(topLvlProperties.getProperty("priorityURIs", ""));
+        transport->setSpoolDirectory(topLvlProperties.getProperty("spoolDirectory", ""));
+        transport->setSpoolMaxSize(
+            Long::parseLong(topLvlProperties.getProperty("spoolMaxSize", "67108864")));
+        transport->setSpoolSegmentSize(
+            Integer::parseInt(topLvlProperties.getProperty("spoolSegmentSize", "4194304")));
 
         transport->addURI(false, data.getComponents());
 
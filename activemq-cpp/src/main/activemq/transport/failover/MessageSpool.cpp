@@ -0,0 +1,463 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MessageSpool.h"
+
+#include <activemq/exceptions/ActiveMQException.h>
+#include <activemq/exceptions/ExceptionDefines.h>
+#include <activemq/commands/ActiveMQBytesMessage.h>
+#include <activemq/wireformat/openwire/OpenWireFormat.h>
+#include <decaf/io/ByteArrayInputStream.h>
+#include <decaf/io/ByteArrayOutputStream.h>
+#include <decaf/io/DataInputStream.h>
+#include <decaf/io/DataOutputStream.h>
+#include <decaf/io/IOException.h>
+#include <decaf/lang/ArrayPointer.h>
+#include <decaf/lang/Long.h>
+#include <decaf/lang/exceptions/IllegalArgumentException.h>
+#include <decaf/util/Properties.h>
+#include <decaf/util/UUID.h>
+#include <decaf/internal/util/concurrent/Atomics.h>
+
+#if HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#if HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#if HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+
+#if HAVE_SYS_MMAN_H && HAVE_FCNTL_H && HAVE_UNISTD_H && HAVE_SYS_STAT_H
+#define AMQ_SPOOL_USE_MMAP
+#endif
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::commands;
+using namespace activemq::transport;
+using namespace activemq::transport::failover;
+using namespace activemq::wireformat::openwire;
+using namespace decaf::io;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::util;
+using namespace decaf::internal::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+const int MessageSpool::DEFAULT_SEGMENT_SIZE = 4 * 1024 * 1024;
+const long long MessageSpool::DEFAULT_MAX_SIZE = 64LL * 1024 * 1024;
+const int MessageSpool::MINIMUM_SEGMENT_SIZE = 4096;
+const int MessageSpool::SEGMENT_HEADER_SIZE = 32;
+const int MessageSpool::RECORD_HEADER_SIZE = 8;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace activemq {
+namespace transport {
+namespace failover {
+
+    const char SPOOL_MAGIC[8] = { 'A', 'M', 'Q', 'S', 'P', 'O', 'O', 'L' };
+    const int SPOOL_VERSION = 1;
+
+    const int RECORD_WRITTEN = 1;
+    const int RECORD_REMOVED = 2;
+
+    /**
+     * The layout of the first SEGMENT_HEADER_SIZE bytes of each segment file.
+     */
+    struct SpoolSegmentHeader {
+        char magic[8];
+        int version;
+        int capacity;
+        long long sequence;
+        char reserved[8];
+    };
+
+    /**
+     * The layout of the RECORD_HEADER_SIZE bytes in front of each marshaled Command,
+     * the state is written last so a torn record is never seen as written.
+     */
+    struct SpoolRecordHeader {
+        int length;
+        volatile int state;
+    };
+
+    class SpoolSegment {
+    private:
+
+        SpoolSegment(const SpoolSegment&);
+        SpoolSegment& operator=(const SpoolSegment&);
+
+    public:
+
+        std::string path;
+        long long sequence;
+        int capacity;
+        unsigned char* mapping;
+        int fd;
+        int readOffset;
+        int writeOffset;
+        int live;
+
+        SpoolSegment(const std::string& path, long long sequence, int capacity) :
+            path(path), sequence(sequence), capacity(capacity), mapping(NULL), fd(-1),
+            readOffset(MessageSpool::SEGMENT_HEADER_SIZE), writeOffset(MessageSpool::SEGMENT_HEADER_SIZE), live(0) {
+        }
+
+        void open();
+
+        void close(bool discard);
+
+        void initialize() {
+            SpoolSegmentHeader* header = (SpoolSegmentHeader*) this->mapping;
+            memset(header, 0, sizeof(SpoolSegmentHeader));
+            memcpy(header->magic, SPOOL_MAGIC, sizeof(SPOOL_MAGIC));
+            header->version = SPOOL_VERSION;
+            header->capacity = this->capacity;
+            header->sequence = this->sequence;
+        }
+
+        SpoolRecordHeader* record(int offset) const {
+            return (SpoolRecordHeader*) (this->mapping + offset);
+        }
+
+        static int recordSize(int length) {
+            return (MessageSpool::RECORD_HEADER_SIZE + length + 7) & ~7;
+        }
+    };
+
+    class MessageSpoolImpl {
+    private:
+
+        MessageSpoolImpl(const MessageSpoolImpl&);
+        MessageSpoolImpl& operator=(const MessageSpoolImpl&);
+
+    public:
+
+        std::string directory;
+        std::string prefix;
+        long long maxSize;
+        int segmentSize;
+        long long nextSequence;
+        int count;
+        bool closed;
+        std::deque<SpoolSegment*> segments;
+        OpenWireFormat format;
+
+        MessageSpoolImpl(const std::string& directory, long long maxSize, int segmentSize) :
+            directory(directory), prefix(), maxSize(maxSize), segmentSize(segmentSize),
+            nextSequence(0), count(0), closed(false), segments(), format(Properties()) {
+
+            // The spool must read back exactly what it wrote no matter how many records
+            // are dropped in between, so no marshaling state may span records.
+            this->format.setCacheEnabled(false);
+
+            this->prefix = this->directory + "/spool-" + UUID::randomUUID().toString() + "-";
+        }
+
+        void createDirectory();
+
+        SpoolSegment* newSegment() {
+            long long sequence = this->nextSequence++;
+            std::auto_ptr<SpoolSegment> segment(new SpoolSegment(
+                this->prefix + Long::toString(sequence) + ".dat", sequence, this->segmentSize));
+            segment->open();
+            this->segments.push_back(segment.get());
+            return segment.release();
+        }
+    };
+
+}}}
+
+#ifdef AMQ_SPOOL_USE_MMAP
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSpoolImpl::createDirectory() {
+
+    if (mkdir(this->directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        throw IOException(__FILE__, __LINE__, "Cannot create spool directory %s: %s",
+                          this->directory.c_str(), strerror(errno));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SpoolSegment::open() {
+
+    this->fd = ::open(this->path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (this->fd < 0) {
+        throw IOException(__FILE__, __LINE__, "Cannot create spool segment %s: %s", this->path.c_str(), strerror(errno));
+    }
+
+    if (ftruncate(this->fd, (off_t) this->capacity) != 0) {
+        int error = errno;
+        ::close(this->fd);
+        ::unlink(this->path.c_str());
+        this->fd = -1;
+        throw IOException(__FILE__, __LINE__, "Cannot size spool segment %s: %s", this->path.c_str(), strerror(error));
+    }
+
+    void* address = mmap(NULL, (size_t) this->capacity, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+    if (address == MAP_FAILED) {
+        int error = errno;
+        ::close(this->fd);
+        ::unlink(this->path.c_str());
+        this->fd = -1;
+        throw IOException(__FILE__, __LINE__, "Cannot map spool segment %s: %s", this->path.c_str(), strerror(error));
+    }
+
+    this->mapping = (unsigned char*) address;
+    initialize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SpoolSegment::close(bool discard) {
+
+    if (this->mapping != NULL) {
+        munmap(this->mapping, (size_t) this->capacity);
+        this->mapping = NULL;
+    }
+
+    if (this->fd >= 0) {
+        ::close(this->fd);
+        this->fd = -1;
+    }
+
+    if (discard) {
+        ::unlink(this->path.c_str());
+    }
+}
+
+#else
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSpoolImpl::createDirectory() {
+    // Without memory mapped files the segments are only kept in memory.
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SpoolSegment::open() {
+    this->mapping = new unsigned char[this->capacity];
+    memset(this->mapping, 0, (size_t) this->capacity);
+    initialize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SpoolSegment::close(bool discard AMQCPP_UNUSED) {
+    delete [] this->mapping;
+    this->mapping = NULL;
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+MessageSpool::MessageSpool(const std::string& directory, long long maxSize, int segmentSize) : impl(NULL) {
+
+    if (directory.empty()) {
+        throw IllegalArgumentException(__FILE__, __LINE__, "Spool directory cannot be empty");
+    }
+
+    if (segmentSize < MINIMUM_SEGMENT_SIZE) {
+        throw IllegalArgumentException(__FILE__, __LINE__,
+            "Spool segment size must be at least %d bytes", MINIMUM_SEGMENT_SIZE);
+    }
+
+    if (maxSize < segmentSize) {
+        throw IllegalArgumentException(__FILE__, __LINE__,
+            "Spool max size must be at least one segment of %d bytes", segmentSize);
+    }
+
+    this->impl = new MessageSpoolImpl(directory, maxSize, (segmentSize + 7) & ~7);
+
+    try {
+        this->impl->createDirectory();
+    } catch (...) {
+        delete this->impl;
+        throw;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MessageSpool::~MessageSpool() {
+    try {
+        close();
+    }
+    AMQ_CATCHALL_NOTHROW()
+
+    try {
+        delete this->impl;
+    }
+    AMQ_CATCHALL_NOTHROW()
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool MessageSpool::offer(const Pointer<Command> command) {
+
+    if (this->impl->closed || command == NULL) {
+        return false;
+    }
+
+    try {
+
+        // The spooled record has to hold the whole message, a body that is still in
+        // its file is read in first.
+        ActiveMQBytesMessage* bytesMessage = dynamic_cast<ActiveMQBytesMessage*>(command.get());
+        if (bytesMessage != NULL) {
+            bytesMessage->loadBodyFile();
+        }
+
+        ByteArrayOutputStream bytes;
+        DataOutputStream dataOut(&bytes);
+        this->impl->format.looseMarshalNestedObject(command.get(), &dataOut);
+        dataOut.flush();
+
+        std::pair<unsigned char*, int> data = bytes.toByteArray();
+        ArrayPointer<unsigned char> buffer(data.first, data.second);
+
+        int size = SpoolSegment::recordSize(data.second);
+        if (size > this->impl->segmentSize - SEGMENT_HEADER_SIZE) {
+            return false;
+        }
+
+        SpoolSegment* tail = this->impl->segments.empty() ? NULL : this->impl->segments.back();
+        if (tail == NULL || tail->writeOffset + size > tail->capacity) {
+
+            long long used = (long long) this->impl->segments.size() * this->impl->segmentSize;
+            if (used + this->impl->segmentSize > this->impl->maxSize) {
+                return false;
+            }
+
+            tail = this->impl->newSegment();
+        }
+
+        SpoolRecordHeader* header = tail->record(tail->writeOffset);
+        memcpy(tail->mapping + tail->writeOffset + RECORD_HEADER_SIZE, data.first, (size_t) data.second);
+        header->length = data.second;
+        Atomics::getAndSet(&header->state, RECORD_WRITTEN);
+
+        tail->writeOffset += size;
+        tail->live++;
+        this->impl->count++;
+
+        return true;
+    }
+    AMQ_CATCH_RETHROW(IOException)
+    AMQ_CATCH_EXCEPTION_CONVERT(Exception, IOException)
+    AMQ_CATCHALL_THROW(IOException)
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<Command> MessageSpool::peek() {
+
+    if (this->impl->count == 0) {
+        return Pointer<Command>();
+    }
+
+    try {
+
+        SpoolSegment* head = this->impl->segments.front();
+        SpoolRecordHeader* header = head->record(head->readOffset);
+
+        ByteArrayInputStream bytes(head->mapping + head->readOffset + RECORD_HEADER_SIZE,
+                                   header->length, 0, header->length);
+        DataInputStream dataIn(&bytes);
+
+        return Pointer<Command>(dynamic_cast<Command*>(this->impl->format.looseUnmarshalNestedObject(&dataIn)));
+    }
+    AMQ_CATCH_RETHROW(IOException)
+    AMQ_CATCH_EXCEPTION_CONVERT(Exception, IOException)
+    AMQ_CATCHALL_THROW(IOException)
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSpool::remove() {
+
+    if (this->impl->count == 0) {
+        return;
+    }
+
+    SpoolSegment* head = this->impl->segments.front();
+    SpoolRecordHeader* header = head->record(head->readOffset);
+
+    Atomics::getAndSet(&header->state, RECORD_REMOVED);
+    head->readOffset += SpoolSegment::recordSize(header->length);
+    head->live--;
+    this->impl->count--;
+
+    if (head->live == 0) {
+        this->impl->segments.pop_front();
+        head->close(true);
+        delete head;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool MessageSpool::isEmpty() const {
+    return this->impl->count == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int MessageSpool::size() const {
+    return this->impl->count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int MessageSpool::getSegmentCount() const {
+    return (int) this->impl->segments.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string MessageSpool::getDirectory() const {
+    return this->impl->directory;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long MessageSpool::getMaxSize() const {
+    return this->impl->maxSize;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int MessageSpool::getSegmentSize() const {
+    return this->impl->segmentSize;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSpool::close() {
+
+    if (this->impl->closed) {
+        return;
+    }
+
+    this->impl->closed = true;
+    this->impl->count = 0;
+
+    while (!this->impl->segments.empty()) {
+        SpoolSegment* segment = this->impl->segments.front();
+        this->impl->segments.pop_front();
+        segment->close(true);
+        delete segment;
+    }
+}
@@ -0,0 +1,161 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_TRANSPORT_FAILOVER_MESSAGESPOOL_H_
+#define _ACTIVEMQ_TRANSPORT_FAILOVER_MESSAGESPOOL_H_
+
+#include <activemq/util/Config.h>
+#include <activemq/commands/Command.h>
+
+#include <decaf/lang/Pointer.h>
+
+#include <string>
+
+namespace activemq {
+namespace transport {
+namespace failover {
+
+    using decaf::lang::Pointer;
+
+    class MessageSpoolImpl;
+
+    /**
+     * An append only FIFO of Commands kept on disk, used by the FailoverTransport to
+     * accept persistent sends while it has no connection to a Broker.  Commands are
+     * marshaled with OpenWire into fixed size segment files which are memory mapped on
+     * platforms that support it, a segment file is deleted once every Command in it
+     * has been removed.  The combined size of the live segments is bounded by a quota,
+     * once the quota is reached offer fails and the caller must fall back to waiting.
+     *
+     * Each spool instance writes its own uniquely named segments into the directory so
+     * several connections can share one spool directory.
+     *
+     * This class is not thread safe, callers must serialize access to it.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API MessageSpool {
+    private:
+
+        MessageSpoolImpl* impl;
+
+    private:
+
+        MessageSpool(const MessageSpool&);
+        MessageSpool& operator=(const MessageSpool&);
+
+    public:
+
+        static const int DEFAULT_SEGMENT_SIZE;
+        static const long long DEFAULT_MAX_SIZE;
+
+        static const int MINIMUM_SEGMENT_SIZE;
+        static const int SEGMENT_HEADER_SIZE;
+        static const int RECORD_HEADER_SIZE;
+
+    public:
+
+        /**
+         * Creates a new empty spool that writes its segments into the given directory,
+         * the directory is created if it does not already exist.
+         *
+         * @param directory
+         *      The directory the segment files are written to.
+         * @param maxSize
+         *      The quota for the combined size of all the segment files.
+         * @param segmentSize
+         *      The size of each segment file, a Command larger than a segment is never spooled.
+         *
+         * @throws IllegalArgumentException if the directory is empty or the sizes are invalid.
+         * @throws IOException if the directory cannot be created.
+         */
+        MessageSpool(const std::string& directory,
+                     long long maxSize = DEFAULT_MAX_SIZE,
+                     int segmentSize = DEFAULT_SEGMENT_SIZE);
+
+        virtual ~MessageSpool();
+
+        /**
+         * Appends the Command to the tail of the spool.
+         *
+         * @param command
+         *      The Command to store.
+         *
+         * @return true if the Command was stored, false if it does not fit in a segment,
+         *         the quota has been reached or the spool is closed.
+         *
+         * @throws IOException if a new segment file cannot be created.
+         */
+        bool offer(const Pointer<commands::Command> command);
+
+        /**
+         * Reads the Command at the head of the spool without removing it.
+         *
+         * @return the oldest Command in the spool or NULL if the spool is empty.
+         *
+         * @throws IOException if the stored Command cannot be unmarshaled.
+         */
+        Pointer<commands::Command> peek();
+
+        /**
+         * Removes the Command at the head of the spool, deleting its segment file if it
+         * was the last Command stored there.  Does nothing if the spool is empty.
+         */
+        void remove();
+
+        /**
+         * @return true if there are no Commands in the spool.
+         */
+        bool isEmpty() const;
+
+        /**
+         * @return the number of Commands in the spool.
+         */
+        int size() const;
+
+        /**
+         * @return the number of segment files currently in use.
+         */
+        int getSegmentCount() const;
+
+        /**
+         * @return the directory the segment files are written to.
+         */
+        std::string getDirectory() const;
+
+        /**
+         * @return the quota for the combined size of the segment files.
+         */
+        long long getMaxSize() const;
+
+        /**
+         * @return the size of each segment file.
+         */
+        int getSegmentSize() const;
+
+        /**
+         * Closes the spool and deletes all of its segment files.  Any Commands still
+         * stored are discarded, a spool's uniquely named segments are never reopened so
+         * leaving them on disk would only leak them.  Once closed offer always fails.
+         */
+        void close();
+
+    };
+
+}}}
+
+#endif /* _ACTIVEMQ_TRANSPORT_FAILOVER_MESSAGESPOOL_H_ */
@@ -0,0 +1,1403 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MockBroker.h"
+
+#include <activemq/core/ActiveMQConstants.h>
+#include <activemq/commands/ActiveMQBytesMessage.h>
+#include <activemq/commands/ActiveMQDestination.h>
+#include <activemq/commands/ActiveMQTextMessage.h>
+#include <activemq/commands/BrokerId.h>
+#include <activemq/commands/BrokerInfo.h>
+#include <activemq/commands/ConsumerId.h>
+#include <activemq/commands/ConsumerInfo.h>
+#include <activemq/commands/KeepAliveInfo.h>
+#include <activemq/commands/Message.h>
+#include <activemq/commands/MessageAck.h>
+#include <activemq/commands/MessageDispatch.h>
+#include <activemq/commands/MessageId.h>
+#include <activemq/commands/MessagePull.h>
+#include <activemq/commands/ProducerAck.h>
+#include <activemq/commands/ProducerId.h>
+#include <activemq/commands/ProducerInfo.h>
+#include <activemq/commands/RemoveInfo.h>
+#include <activemq/commands/Response.h>
+#include <activemq/commands/TransactionInfo.h>
+#include <activemq/commands/WireFormatInfo.h>
+#include <activemq/exceptions/ActiveMQException.h>
+#include <activemq/transport/IOTransport.h>
+#include <activemq/util/LongSequenceGenerator.h>
+#include <activemq/wireformat/openwire/OpenWireFormat.h>
+#include <activemq/wireformat/openwire/OpenWireFormatFactory.h>
+#include <activemq/wireformat/openwire/OpenWireResponseBuilder.h>
+#include <activemq/wireformat/stomp/StompCommandConstants.h>
+#include <activemq/wireformat/stomp/StompFrame.h>
+#include <activemq/wireformat/stomp/StompHelper.h>
+#include <activemq/wireformat/stomp/StompWireFormat.h>
+
+#include <decaf/io/BufferedInputStream.h>
+#include <decaf/io/BufferedOutputStream.h>
+#include <decaf/io/DataInputStream.h>
+#include <decaf/io/DataOutputStream.h>
+#include <decaf/io/IOException.h>
+#include <decaf/lang/Integer.h>
+#include <decaf/lang/Long.h>
+#include <decaf/lang/Math.h>
+#include <decaf/lang/Pointer.h>
+#include <decaf/lang/Runnable.h>
+#include <decaf/lang/System.h>
+#include <decaf/lang/Thread.h>
+#include <decaf/net/ServerSocket.h>
+#include <decaf/net/Socket.h>
+#include <decaf/util/Properties.h>
+#include <decaf/util/Timer.h>
+#include <decaf/util/TimerTask.h>
+#include <decaf/util/concurrent/Mutex.h>
+
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::core;
+using namespace activemq::commands;
+using namespace activemq::exceptions;
+using namespace activemq::transport;
+using namespace activemq::transport::mock;
+using namespace activemq::wireformat;
+using namespace activemq::wireformat::openwire;
+using namespace activemq::wireformat::stomp;
+using namespace decaf;
+using namespace decaf::io;
+using namespace decaf::lang;
+using namespace decaf::net;
+using namespace decaf::util;
+using namespace decaf::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace activemq {
+namespace transport {
+namespace mock {
+
+    class BrokerConnection;
+    class BrokerDestination;
+
+    /**
+     * A message handed to a subscription that has not been consumed yet.
+     */
+    class Delivery {
+    public:
+
+        Pointer<Message> message;
+        std::string messageId;
+        bool delivered;
+
+    public:
+
+        Delivery(const Pointer<Message>& message) :
+            message(message), messageId(message->getMessageId()->toString()), delivered(false) {
+        }
+    };
+
+    class Subscription {
+    private:
+
+        Subscription(const Subscription&);
+        Subscription& operator=(const Subscription&);
+
+    public:
+
+        BrokerConnection* connection;
+        BrokerDestination* destination;
+        std::string key;
+        Pointer<ConsumerId> consumerId;
+        int prefetch;
+        int pullCredit;
+        bool autoAck;
+        std::deque<Delivery> inFlight;
+        int delivered;
+
+        // Topic messages waiting for prefetch room, queues keep theirs on the destination.
+        std::deque< Pointer<Message> > pending;
+
+    public:
+
+        Subscription(BrokerConnection* connection, BrokerDestination* destination, const std::string& key,
+                     const Pointer<ConsumerId>& consumerId, int prefetch, bool autoAck) :
+            connection(connection), destination(destination), key(key), consumerId(consumerId),
+            prefetch(prefetch), pullCredit(0), autoAck(autoAck), inFlight(), delivered(0), pending() {
+        }
+
+        /**
+         * Delivered acks open the prefetch window without consuming, a zero
+         * prefetch consumer only gets what it has pulled.
+         */
+        int getCredit() const {
+            if (prefetch > 0) {
+                return prefetch - ((int) inFlight.size() - delivered);
+            }
+
+            return pullCredit;
+        }
+
+        int indexOf(const std::string& messageId) const {
+            for (std::size_t i = 0; i < inFlight.size(); ++i) {
+                if (inFlight[i].messageId == messageId) {
+                    return (int) i;
+                }
+            }
+
+            return -1;
+        }
+
+        void markDelivered(int first, int last) {
+            for (int i = first; i <= last; ++i) {
+                if (!inFlight[i].delivered) {
+                    inFlight[i].delivered = true;
+                    delivered++;
+                }
+            }
+        }
+    };
+
+    class BrokerDestination {
+    private:
+
+        BrokerDestination(const BrokerDestination&);
+        BrokerDestination& operator=(const BrokerDestination&);
+
+    public:
+
+        bool topic;
+        std::deque< Pointer<Message> > pending;
+        std::vector<Subscription*> subscriptions;
+        std::size_t next;
+
+    public:
+
+        BrokerDestination(bool topic) : topic(topic), pending(), subscriptions(), next(0) {
+        }
+    };
+
+    /**
+     * Sends and acks held back until their transaction commits.
+     */
+    class BrokerTransaction {
+    public:
+
+        class PendingAck {
+        public:
+
+            std::string subscription;
+            std::string messageId;
+            bool individual;
+
+            PendingAck(const std::string& subscription, const std::string& messageId, bool individual) :
+                subscription(subscription), messageId(messageId), individual(individual) {
+            }
+        };
+
+        std::vector< Pointer<Message> > sends;
+        std::vector<PendingAck> acks;
+
+    public:
+
+        BrokerTransaction() : sends(), acks() {
+        }
+    };
+
+    /**
+     * One accepted client socket, the reader thread owns the protocol state and
+     * all writes happen with the broker lock held.
+     */
+    class BrokerConnection : public Runnable {
+    private:
+
+        BrokerConnection(const BrokerConnection&);
+        BrokerConnection& operator=(const BrokerConnection&);
+
+    protected:
+
+        MockBrokerImpl* broker;
+        std::auto_ptr<Socket> socket;
+        std::auto_ptr<DataInputStream> input;
+        std::auto_ptr<DataOutputStream> output;
+        long long lastWrite;
+
+    public:
+
+        std::auto_ptr<Thread> thread;
+        std::map<std::string, Pointer<Subscription> > subscriptions;
+        std::map<std::string, BrokerTransaction> transactions;
+        bool closed;
+
+    public:
+
+        BrokerConnection(MockBrokerImpl* broker, Socket* socket) :
+            Runnable(), broker(broker), socket(socket), input(), output(), lastWrite(System::currentTimeMillis()),
+            thread(), subscriptions(), transactions(), closed(false) {
+
+            this->socket->setTcpNoDelay(true);
+            this->input.reset(new DataInputStream(new BufferedInputStream(this->socket->getInputStream()), true));
+            this->output.reset(new DataOutputStream(new BufferedOutputStream(this->socket->getOutputStream()), true));
+        }
+
+        virtual ~BrokerConnection() {}
+
+        /**
+         * Writes the message to the client, called with the broker lock held.
+         */
+        virtual void dispatch(Subscription* subscription, const Delivery& delivery) = 0;
+
+        /**
+         * Tells a zero prefetch consumer that its pull found nothing.
+         */
+        virtual void dispatchNothing(Subscription* subscription AMQCPP_UNUSED) {}
+
+        /**
+         * Keeps an idle client's inactivity monitor satisfied.
+         */
+        virtual void keepAlive(long long now AMQCPP_UNUSED) {}
+
+        void close() {
+            try {
+                this->socket->close();
+            } catch (...) {
+            }
+        }
+
+        virtual void run();
+
+    protected:
+
+        virtual void readLoop() = 0;
+
+    };
+
+    class MockBrokerImpl {
+    private:
+
+        MockBrokerImpl(const MockBrokerImpl&);
+        MockBrokerImpl& operator=(const MockBrokerImpl&);
+
+    public:
+
+        Mutex mutex;
+
+        int port;
+        int stompPort;
+        bool stompEnabled;
+        bool keepAliveEnabled;
+        bool started;
+
+        Pointer<ServerSocket> server;
+        Pointer<ServerSocket> stompServer;
+        std::vector< Pointer<Thread> > acceptors;
+        std::vector< Pointer<Runnable> > acceptorTasks;
+        Pointer<Timer> timer;
+
+        std::list< Pointer<BrokerConnection> > connections;
+        std::map<std::string, Pointer<BrokerDestination> > destinations;
+
+        OpenWireResponseBuilder responseBuilder;
+        StompWireFormat stompWireFormat;
+        StompHelper stompHelper;
+        activemq::util::LongSequenceGenerator sequence;
+
+        long long enqueueCount;
+        long long dequeueCount;
+
+    public:
+
+        MockBrokerImpl() : mutex(), port(0), stompPort(0), stompEnabled(false), keepAliveEnabled(true),
+                           started(false), server(), stompServer(), acceptors(), acceptorTasks(), timer(),
+                           connections(), destinations(), responseBuilder(), stompWireFormat(),
+                           stompHelper(&stompWireFormat), sequence(), enqueueCount(0), dequeueCount(0) {
+        }
+
+        void accepted(Socket* socket, bool stomp);
+
+        void removeConnections(std::list< Pointer<BrokerConnection> >& removed, bool all);
+
+        void connectionClosed(BrokerConnection* connection);
+
+        void keepAlive();
+
+        BrokerDestination* getDestination(const Pointer<ActiveMQDestination>& destination, bool create);
+
+        void send(BrokerConnection* connection, const Pointer<Message>& message, const std::string& transaction);
+
+        void route(const Pointer<Message>& message);
+
+        void subscribe(BrokerConnection* connection, const std::string& key, const Pointer<ConsumerId>& consumerId,
+                       const Pointer<ActiveMQDestination>& destination, int prefetch, bool autoAck);
+
+        void unsubscribe(BrokerConnection* connection, const std::string& key);
+
+        void acknowledge(BrokerConnection* connection, const std::string& key, int ackType,
+                         const std::string& messageId, const std::string& transaction);
+
+        void pull(BrokerConnection* connection, const std::string& key, long long timeout);
+
+        void commit(BrokerConnection* connection, const std::string& transaction);
+
+        void rollback(BrokerConnection* connection, const std::string& transaction);
+
+        void pump(BrokerDestination* destination);
+
+    private:
+
+        void consume(Subscription* subscription, int index, bool individual);
+
+        void deliver(Subscription* subscription, const Pointer<Message>& message);
+
+    };
+
+    class Acceptor : public Runnable {
+    private:
+
+        Acceptor(const Acceptor&);
+        Acceptor& operator=(const Acceptor&);
+
+    private:
+
+        MockBrokerImpl* broker;
+        Pointer<ServerSocket> server;
+        bool stomp;
+
+    public:
+
+        Acceptor(MockBrokerImpl* broker, const Pointer<ServerSocket>& server, bool stomp) :
+            Runnable(), broker(broker), server(server), stomp(stomp) {
+        }
+
+        virtual ~Acceptor() {}
+
+        virtual void run() {
+            try {
+                while (!server->isClosed()) {
+                    broker->accepted(server->accept(), stomp);
+                }
+            } catch (...) {
+            }
+        }
+    };
+
+    class KeepAliveTask : public TimerTask {
+    private:
+
+        KeepAliveTask(const KeepAliveTask&);
+        KeepAliveTask& operator=(const KeepAliveTask&);
+
+    private:
+
+        MockBrokerImpl* broker;
+
+    public:
+
+        KeepAliveTask(MockBrokerImpl* broker) : TimerTask(), broker(broker) {}
+
+        virtual ~KeepAliveTask() {}
+
+        virtual void run() {
+            broker->keepAlive();
+        }
+    };
+
+    class OpenWireConnection : public BrokerConnection {
+    private:
+
+        Pointer<OpenWireFormat> wireFormat;
+        IOTransport transport;
+        std::map<std::string, int> producerWindows;
+        long long maxInactivityDuration;
+
+    public:
+
+        OpenWireConnection(MockBrokerImpl* broker, Socket* socket) :
+            BrokerConnection(broker, socket), wireFormat(), transport(), producerWindows(), maxInactivityDuration(0) {
+
+            Properties properties;
+            this->wireFormat = OpenWireFormatFactory().createWireFormat(properties).dynamicCast<OpenWireFormat>();
+        }
+
+        virtual ~OpenWireConnection() {}
+
+        virtual void dispatch(Subscription* subscription, const Delivery& delivery) {
+            Pointer<MessageDispatch> dispatch(new MessageDispatch());
+            dispatch->setConsumerId(subscription->consumerId);
+            dispatch->setDestination(delivery.message->getDestination());
+            dispatch->setMessage(delivery.message);
+            dispatch->setRedeliveryCounter(delivery.message->getRedeliveryCounter());
+            write(dispatch);
+        }
+
+        virtual void dispatchNothing(Subscription* subscription) {
+            Pointer<MessageDispatch> dispatch(new MessageDispatch());
+            dispatch->setConsumerId(subscription->consumerId);
+            write(dispatch);
+        }
+
+        virtual void keepAlive(long long now) {
+            if (maxInactivityDuration > 0 && now - lastWrite >= maxInactivityDuration / 3) {
+                write(Pointer<Command>(new KeepAliveInfo()));
+            }
+        }
+
+    protected:
+
+        virtual void readLoop();
+
+    private:
+
+        void write(const Pointer<Command>& command);
+
+        bool process(const Pointer<Command>& command);
+
+    };
+
+    class StompConnection : public BrokerConnection {
+    private:
+
+        std::string producerKey;
+
+    public:
+
+        StompConnection(MockBrokerImpl* broker, Socket* socket) :
+            BrokerConnection(broker, socket), producerKey() {
+
+            this->producerKey = std::string("ID:MockBroker-stomp-") + Long::toString(broker->sequence.getNextSequenceId());
+        }
+
+        virtual ~StompConnection() {}
+
+        virtual void dispatch(Subscription* subscription, const Delivery& delivery);
+
+    protected:
+
+        virtual void readLoop();
+
+    private:
+
+        void write(const Pointer<StompFrame>& frame);
+
+        bool process(const Pointer<StompFrame>& frame);
+
+        Pointer<Message> createMessage(const Pointer<StompFrame>& frame);
+
+    };
+
+}}}
+
+////////////////////////////////////////////////////////////////////////////////
+void BrokerConnection::run() {
+
+    try {
+        this->readLoop();
+    } catch (...) {
+    }
+
+    this->close();
+    this->broker->connectionClosed(this);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireConnection::write(const Pointer<Command>& command) {
+
+    if (this->closed) {
+        return;
+    }
+
+    try {
+        this->wireFormat->marshal(command, &this->transport, this->output.get());
+        this->output->flush();
+        this->lastWrite = System::currentTimeMillis();
+    } catch (Exception& ex) {
+        // The reader notices the dead socket and cleans up after us.
+        this->close();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireConnection::readLoop() {
+
+    synchronized(&broker->mutex) {
+        write(this->wireFormat->getPreferedWireFormatInfo());
+    }
+
+    while (true) {
+        Pointer<Command> command = this->wireFormat->unmarshal(&this->transport, this->input.get());
+
+        bool done = false;
+        synchronized(&broker->mutex) {
+            done = process(command);
+        }
+
+        if (done) {
+            return;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool OpenWireConnection::process(const Pointer<Command>& command) {
+
+    bool done = false;
+
+    if (command->isWireFormatInfo()) {
+        Pointer<WireFormatInfo> info = command.dynamicCast<WireFormatInfo>();
+        this->wireFormat->renegotiateWireFormat(*info);
+        this->maxInactivityDuration = Math::min(info->getMaxInactivityDuration(),
+            this->wireFormat->getPreferedWireFormatInfo()->getMaxInactivityDuration());
+    } else if (command->isConnectionInfo()) {
+        write(broker->responseBuilder.buildResponse(command));
+
+        Pointer<BrokerInfo> info(new BrokerInfo());
+        Pointer<BrokerId> brokerId(new BrokerId());
+        brokerId->setValue("ID:MockBroker");
+        info->setBrokerId(brokerId);
+        info->setBrokerName("MockBroker");
+        write(info);
+        return false;
+    } else if (command->isProducerInfo()) {
+        Pointer<ProducerInfo> info = command.dynamicCast<ProducerInfo>();
+        if (info->getWindowSize() > 0) {
+            this->producerWindows[info->getProducerId()->toString()] = info->getWindowSize();
+        }
+    } else if (command->isConsumerInfo()) {
+        Pointer<ConsumerInfo> info = command.dynamicCast<ConsumerInfo>();
+
+        // Answer first so the client has the consumer registered before it gets messages.
+        write(broker->responseBuilder.buildResponse(command));
+        broker->subscribe(this, info->getConsumerId()->toString(), info->getConsumerId(),
+                          info->getDestination(), info->getPrefetchSize(), false);
+        return false;
+    } else if (command->isRemoveInfo()) {
+        Pointer<RemoveInfo> info = command.dynamicCast<RemoveInfo>();
+        unsigned char type = info->getObjectId()->getDataStructureType();
+
+        if (type == ConsumerId::ID_CONSUMERID) {
+            broker->unsubscribe(this, info->getObjectId().dynamicCast<ConsumerId>()->toString());
+        } else if (type == ProducerId::ID_PRODUCERID) {
+            this->producerWindows.erase(info->getObjectId().dynamicCast<ProducerId>()->toString());
+        }
+    } else if (command->isMessage()) {
+        Pointer<Message> message = command.dynamicCast<Message>();
+        std::string transaction;
+        if (message->getTransactionId() != NULL) {
+            transaction = message->getTransactionId()->toString();
+        }
+
+        broker->send(this, message, transaction);
+
+        std::map<std::string, int>::const_iterator window =
+            this->producerWindows.find(message->getProducerId()->toString());
+        if (!message->isResponseRequired() && window != this->producerWindows.end()) {
+            Pointer<ProducerAck> ack(new ProducerAck());
+            ack->setProducerId(message->getProducerId());
+            ack->setSize(message->getSize());
+            write(ack);
+        }
+    } else if (command->isMessageAck()) {
+        Pointer<MessageAck> ack = command.dynamicCast<MessageAck>();
+        std::string transaction;
+        if (ack->getTransactionId() != NULL) {
+            transaction = ack->getTransactionId()->toString();
+        }
+
+        broker->acknowledge(this, ack->getConsumerId()->toString(), ack->getAckType(),
+                            ack->getLastMessageId()->toString(), transaction);
+    } else if (command->isMessagePull()) {
+        Pointer<MessagePull> pull = command.dynamicCast<MessagePull>();
+        broker->pull(this, pull->getConsumerId()->toString(), pull->getTimeout());
+    } else if (command->isTransactionInfo()) {
+        Pointer<TransactionInfo> info = command.dynamicCast<TransactionInfo>();
+        std::string transaction = info->getTransactionId()->toString();
+
+        switch (info->getType()) {
+            case ActiveMQConstants::TRANSACTION_STATE_BEGIN:
+                this->transactions[transaction];
+                break;
+            case ActiveMQConstants::TRANSACTION_STATE_COMMITONEPHASE:
+            case ActiveMQConstants::TRANSACTION_STATE_COMMITTWOPHASE:
+                broker->commit(this, transaction);
+                break;
+            case ActiveMQConstants::TRANSACTION_STATE_ROLLBACK:
+                broker->rollback(this, transaction);
+                break;
+            default:
+                break;
+        }
+    } else if (command->isShutdownInfo()) {
+        done = true;
+    }
+
+    Pointer<Response> response = broker->responseBuilder.buildResponse(command);
+    if (response != NULL) {
+        write(response);
+    }
+
+    return done;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StompConnection::write(const Pointer<StompFrame>& frame) {
+
+    if (this->closed) {
+        return;
+    }
+
+    try {
+        frame->toStream(this->output.get());
+        this->lastWrite = System::currentTimeMillis();
+    } catch (Exception& ex) {
+        this->close();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StompConnection::dispatch(Subscription* subscription, const Delivery& delivery) {
+
+    Pointer<StompFrame> frame(new StompFrame());
+    frame->setCommand(StompCommandConstants::MESSAGE);
+
+    broker->stompHelper.convertProperties(delivery.message, frame);
+    frame->removeProperty(StompCommandConstants::HEADER_TRANSACTIONID);
+    frame->setProperty(StompCommandConstants::HEADER_MESSAGEID, delivery.messageId);
+    frame->setProperty(StompCommandConstants::HEADER_SUBSCRIPTION, subscription->key);
+
+    ActiveMQTextMessage* text = dynamic_cast<ActiveMQTextMessage*>(delivery.message.get());
+    if (text != NULL) {
+        // Text bodies carry their terminating null, the client reads up to it.
+        std::string body = text->getText();
+        frame->setBody((const unsigned char*) body.c_str(), body.length() + 1);
+    } else {
+        const std::vector<unsigned char>& content = delivery.message->getContent();
+        if (!content.empty()) {
+            frame->setBody(&content[0], content.size());
+        }
+        frame->setProperty(StompCommandConstants::HEADER_CONTENTLENGTH, Long::toString((long long) content.size()));
+    }
+
+    write(frame);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StompConnection::readLoop() {
+
+    while (true) {
+        Pointer<StompFrame> frame(new StompFrame());
+        frame->fromStream(this->input.get());
+
+        bool done = false;
+        synchronized(&broker->mutex) {
+            done = process(frame);
+        }
+
+        if (done) {
+            return;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<Message> StompConnection::createMessage(const Pointer<StompFrame>& frame) {
+
+    Pointer<Message> message;
+
+    if (frame->hasProperty(StompCommandConstants::HEADER_CONTENTLENGTH)) {
+        Pointer<ActiveMQBytesMessage> bytes(new ActiveMQBytesMessage());
+        if (Integer::parseInt(frame->removeProperty(StompCommandConstants::HEADER_CONTENTLENGTH)) > 0) {
+            bytes->setContent(frame->getBody());
+        }
+        message = bytes;
+    } else {
+        Pointer<ActiveMQTextMessage> text(new ActiveMQTextMessage());
+        if (frame->getBodyLength() > 0) {
+            text->setText((const char*) &(frame->getBody()[0]));
+        }
+        message = text;
+    }
+
+    broker->stompHelper.convertProperties(frame, message);
+
+    Pointer<ProducerId> producerId(new ProducerId());
+    producerId->setConnectionId(this->producerKey);
+    Pointer<MessageId> messageId(new MessageId());
+    messageId->setProducerId(producerId);
+    messageId->setProducerSequenceId(broker->sequence.getNextSequenceId());
+    message->setProducerId(producerId);
+    message->setMessageId(messageId);
+    message->setTransactionId(Pointer<TransactionId>());
+
+    return message;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool StompConnection::process(const Pointer<StompFrame>& frame) {
+
+    const std::string& command = frame->getCommand();
+    std::string receipt = frame->removeProperty(StompCommandConstants::HEADER_RECEIPT_REQUIRED);
+    std::string transaction = frame->getProperty(StompCommandConstants::HEADER_TRANSACTIONID);
+    bool done = false;
+
+    if (command == StompCommandConstants::CONNECT) {
+        Pointer<StompFrame> connected(new StompFrame());
+        connected->setCommand(StompCommandConstants::CONNECTED);
+        connected->setProperty(StompCommandConstants::HEADER_SESSIONID, this->producerKey);
+        write(connected);
+    } else if (command == StompCommandConstants::SEND) {
+        broker->send(this, createMessage(frame), transaction);
+    } else if (command == StompCommandConstants::SUBSCRIBE) {
+        std::string destination = frame->getProperty(StompCommandConstants::HEADER_DESTINATION);
+        std::string id = frame->getProperty(StompCommandConstants::HEADER_ID, destination);
+
+        // STOMP has no pull, so a zero prefetch degrades to one message at a time.
+        int prefetch = Integer::parseInt(frame->getProperty(StompCommandConstants::HEADER_PREFETCHSIZE, "1000"));
+        bool autoAck = frame->getProperty(StompCommandConstants::HEADER_ACK, StompCommandConstants::ACK_AUTO) == StompCommandConstants::ACK_AUTO;
+
+        broker->subscribe(this, id, Pointer<ConsumerId>(), broker->stompHelper.convertDestination(destination),
+                          Math::max(prefetch, 1), autoAck);
+    } else if (command == StompCommandConstants::UNSUBSCRIBE) {
+        broker->unsubscribe(this, frame->getProperty(StompCommandConstants::HEADER_ID));
+    } else if (command == StompCommandConstants::ACK) {
+        std::string messageId = frame->getProperty(StompCommandConstants::HEADER_MESSAGEID);
+
+        std::map<std::string, Pointer<Subscription> >::const_iterator iter = this->subscriptions.begin();
+        for (; iter != this->subscriptions.end(); ++iter) {
+            if (iter->second->indexOf(messageId) >= 0) {
+                broker->acknowledge(this, iter->first, ActiveMQConstants::ACK_TYPE_CONSUMED, messageId, transaction);
+                break;
+            }
+        }
+    } else if (command == StompCommandConstants::BEGIN) {
+        this->transactions[transaction];
+    } else if (command == StompCommandConstants::COMMIT) {
+        broker->commit(this, transaction);
+    } else if (command == StompCommandConstants::ABORT) {
+        broker->rollback(this, transaction);
+    } else if (command == StompCommandConstants::DISCONNECT) {
+        done = true;
+    } else {
+        Pointer<StompFrame> error(new StompFrame());
+        error->setCommand(StompCommandConstants::ERROR_CMD);
+        error->setProperty(StompCommandConstants::HEADER_MESSAGE, std::string("Unknown STOMP action: ") + command);
+        write(error);
+    }
+
+    if (!receipt.empty()) {
+        Pointer<StompFrame> response(new StompFrame());
+        response->setCommand(StompCommandConstants::RECEIPT);
+        response->setProperty(StompCommandConstants::HEADER_RECEIPTID, receipt);
+        write(response);
+    }
+
+    return done;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerImpl::accepted(Socket* socket, bool stomp) {
+
+    std::auto_ptr<Socket> guard(socket);
+    std::list< Pointer<BrokerConnection> > removed;
+
+    synchronized(&mutex) {
+
+        if (!this->started) {
+            guard->close();
+            return;
+        }
+
+        Pointer<BrokerConnection> connection;
+        if (stomp) {
+            connection.reset(new StompConnection(this, guard.release()));
+        } else {
+            connection.reset(new OpenWireConnection(this, guard.release()));
+        }
+
+        connection->thread.reset(new Thread(connection.get(), "MockBroker Connection"));
+        this->connections.push_back(connection);
+        connection->thread->start();
+
+        // Reap connections that have gone away so churn does not pile them up.
+        removeConnections(removed, false);
+    }
+
+    std::list< Pointer<BrokerConnection> >::iterator iter = removed.begin();
+    for (; iter != removed.end(); ++iter) {
+        (*iter)->thread->join();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerImpl::removeConnections(std::list< Pointer<BrokerConnection> >& removed, bool all) {
+
+    std::list< Pointer<BrokerConnection> >::iterator iter = this->connections.begin();
+    while (iter != this->connections.end()) {
+        if (all || (*iter)->closed) {
+            (*iter)->close();
+            removed.push_back(*iter);
+            iter = this->connections.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerImpl::connectionClosed(BrokerConnection* connection) {
+
+    synchronized(&mutex) {
+
+        while (!connection->subscriptions.empty()) {
+            unsubscribe(connection, connection->subscriptions.begin()->first);
+        }
+
+        connection->transactions.clear();
+        connection->closed = true;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerImpl::keepAlive() {
+
+    synchronized(&mutex) {
+
+        if (!this->keepAliveEnabled) {
+            return;
+        }
+
+        long long now = System::currentTimeMillis();
+
+        std::list< Pointer<BrokerConnection> >::iterator iter = this->connections.begin();
+        for (; iter != this->connections.end(); ++iter) {
+            (*iter)->keepAlive(now);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+BrokerDestination* MockBrokerImpl::getDestination(const Pointer<ActiveMQDestination>& destination, bool create) {
+
+    std::string name = destination->toString();
+
+    std::map<std::string, Pointer<BrokerDestination> >::iterator iter = this->destinations.find(name);
+    if (iter != this->destinations.end()) {
+        return iter->second.get();
+    }
+
+    if (!create) {
+        return NULL;
+    }
+
+    Pointer<BrokerDestination> result(new BrokerDestination(destination->isTopic()));
+    this->destinations[name] = result;
+    return result.get();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerImpl::send(BrokerConnection* connection, const Pointer<Message>& message, const std::string& transaction) {
+
+    if (!transaction.empty()) {
+        connection->transactions[transaction].sends.push_back(message);
+    } else {
+        route(message);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerImpl::route(const Pointer<Message>& message) {
+
+    this->enqueueCount++;
+
+    BrokerDestination* destination = getDestination(message->getDestination(), true);
+
+    if (destination->topic) {
+        std::vector<Subscription*>::const_iterator iter = destination->subscriptions.begin();
+        for (; iter != destination->subscriptions.end(); ++iter) {
+            (*iter)->pending.push_back(message);
+        }
+    } else {
+        destination->pending.push_back(message);
+    }
+
+    pump(destination);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerImpl::subscribe(BrokerConnection* connection, const std::string& key, const Pointer<ConsumerId>& consumerId,
+                               const Pointer<ActiveMQDestination>& destination, int prefetch, bool autoAck) {
+
+    if (destination == NULL || connection->subscriptions.find(key) != connection->subscriptions.end()) {
+        return;
+    }
+
+    BrokerDestination* target = getDestination(destination, true);
+
+    Pointer<Subscription> subscription(new Subscription(connection, target, key, consumerId, prefetch, autoAck));
+    connection->subscriptions[key] = subscription;
+    target->subscriptions.push_back(subscription.get());
+
+    pump(target);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerImpl::unsubscribe(BrokerConnection* connection, const std::string& key) {
+
+    std::map<std::string, Pointer<Subscription> >::iterator iter = connection->subscriptions.find(key);
+    if (iter == connection->subscriptions.end()) {
+        return;
+    }
+
+    Pointer<Subscription> subscription = iter->second;
+    connection->subscriptions.erase(iter);
+
+    BrokerDestination* destination = subscription->destination;
+
+    std::vector<Subscription*>::iterator position = destination->subscriptions.begin();
+    for (; position != destination->subscriptions.end(); ++position) {
+        if (*position == subscription.get()) {
+            destination->subscriptions.erase(position);
+            break;
+        }
+    }
+
+    if (!destination->topic) {
+
+        // Unconsumed messages go back to the head of the queue in their original order.
+        std::deque<Delivery>::reverse_iterator delivery = subscription->inFlight.rbegin();
+        for (; delivery != subscription->inFlight.rend(); ++delivery) {
+            if (delivery->delivered) {
+                delivery->message->setRedeliveryCounter(delivery->message->getRedeliveryCounter() + 1);
+            }
+            destination->pending.push_front(delivery->message);
+        }
+
+        pump(destination);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerImpl::acknowledge(BrokerConnection* connection, const std::string& key, int ackType,
+                                 const std::string& messageId, const std::string& transaction) {
+
+    std::map<std::string, Pointer<Subscription> >::iterator iter = connection->subscriptions.find(key);
+    if (iter == connection->subscriptions.end()) {
+        return;
+    }
+
+    Subscription* subscription = iter->second.get();
+
+    int index = subscription->indexOf(messageId);
+    if (index < 0) {
+        return;
+    }
+
+    switch (ackType) {
+        case ActiveMQConstants::ACK_TYPE_REDELIVERED:
+            return;
+        case ActiveMQConstants::ACK_TYPE_DELIVERED:
+            subscription->markDelivered(0, index);
+            break;
+        default:
+            bool individual = ackType == ActiveMQConstants::ACK_TYPE_INDIVIDUAL;
+
+            if (!transaction.empty()) {
+                // Held until commit, meanwhile the acked messages stop counting against prefetch.
+                subscription->markDelivered(individual ? index : 0, index);
+                connection->transactions[transaction].acks.push_back(
+                    BrokerTransaction::PendingAck(key, messageId, individual));
+            } else {
+                consume(subscription, index, individual);
+            }
+            break;
+    }
+
+    pump(subscription->destination);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerImpl::consume(Subscription* subscription, int index, bool individual) {
+
+    int first = individual ? index : 0;
+
+    for (int i = first; i <= index; ++i) {
+        if (subscription->inFlight[i].delivered) {
+            subscription->delivered--;
+        }
+    }
+
+    subscription->inFlight.erase(subscription->inFlight.begin() + first, subscription->inFlight.begin() + index + 1);
+    this->dequeueCount += index - first + 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerImpl::pull(BrokerConnection* connection, const std::string& key, long long timeout) {
+
+    std::map<std::string, Pointer<Subscription> >::iterator iter = connection->subscriptions.find(key);
+    if (iter == connection->subscriptions.end()) {
+        return;
+    }
+
+    Subscription* subscription = iter->second.get();
+    if (subscription->prefetch > 0) {
+        return;
+    }
+
+    subscription->pullCredit = 1;
+    pump(subscription->destination);
+
+    // A receiveNoWait pull is answered at once, timed pulls wait for the next message.
+    if (subscription->pullCredit > 0 && timeout < 0) {
+        subscription->pullCredit = 0;
+        connection->dispatchNothing(subscription);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerImpl::commit(BrokerConnection* connection, const std::string& transaction) {
+
+    std::map<std::string, BrokerTransaction>::iterator iter = connection->transactions.find(transaction);
+    if (iter == connection->transactions.end()) {
+        return;
+    }
+
+    BrokerTransaction committed = iter->second;
+    connection->transactions.erase(iter);
+
+    std::vector<BrokerTransaction::PendingAck>::const_iterator ack = committed.acks.begin();
+    for (; ack != committed.acks.end(); ++ack) {
+
+        std::map<std::string, Pointer<Subscription> >::iterator subscription = connection->subscriptions.find(ack->subscription);
+        if (subscription == connection->subscriptions.end()) {
+            continue;
+        }
+
+        int index = subscription->second->indexOf(ack->messageId);
+        if (index >= 0) {
+            consume(subscription->second.get(), index, ack->individual);
+            pump(subscription->second->destination);
+        }
+    }
+
+    std::vector< Pointer<Message> >::const_iterator message = committed.sends.begin();
+    for (; message != committed.sends.end(); ++message) {
+        route(*message);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerImpl::rollback(BrokerConnection* connection, const std::string& transaction) {
+
+    // Rolled back messages stay in flight, the client redelivers them itself.
+    connection->transactions.erase(transaction);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerImpl::deliver(Subscription* subscription, const Pointer<Message>& message) {
+
+    Delivery delivery(message);
+
+    if (subscription->prefetch == 0) {
+        subscription->pullCredit--;
+    }
+
+    if (subscription->autoAck) {
+        this->dequeueCount++;
+    } else {
+        subscription->inFlight.push_back(delivery);
+    }
+
+    subscription->connection->dispatch(subscription, delivery);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerImpl::pump(BrokerDestination* destination) {
+
+    if (destination->topic) {
+
+        std::vector<Subscription*>::const_iterator iter = destination->subscriptions.begin();
+        for (; iter != destination->subscriptions.end(); ++iter) {
+            Subscription* subscription = *iter;
+            while (!subscription->pending.empty() && subscription->getCredit() > 0) {
+                Pointer<Message> message = subscription->pending.front();
+                subscription->pending.pop_front();
+                deliver(subscription, message);
+            }
+        }
+
+        return;
+    }
+
+    // Queues hand messages out round robin to whichever consumers have room.
+    bool progress = true;
+    while (!destination->pending.empty() && progress) {
+        progress = false;
+
+        std::size_t count = destination->subscriptions.size();
+        for (std::size_t i = 0; i < count && !destination->pending.empty(); ++i) {
+            Subscription* subscription = destination->subscriptions[(destination->next + i) % count];
+            if (subscription->connection->closed || subscription->getCredit() <= 0) {
+                continue;
+            }
+
+            Pointer<Message> message = destination->pending.front();
+            destination->pending.pop_front();
+            deliver(subscription, message);
+            destination->next = (destination->next + i + 1) % count;
+            progress = true;
+            break;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MockBroker::MockBroker() : impl(new MockBrokerImpl()) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MockBroker::~MockBroker() {
+    try {
+        stop();
+    }
+    AMQ_CATCHALL_NOTHROW()
+
+    try {
+        delete impl;
+    }
+    AMQ_CATCHALL_NOTHROW()
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBroker::setPort(int port) {
+    this->impl->port = port;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int MockBroker::getPort() const {
+    return this->impl->port;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBroker::setStompPort(int port) {
+    this->impl->stompPort = port;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int MockBroker::getStompPort() const {
+    return this->impl->stompPort;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBroker::setStompEnabled(bool value) {
+    this->impl->stompEnabled = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool MockBroker::isStompEnabled() const {
+    return this->impl->stompEnabled;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBroker::setKeepAliveEnabled(bool value) {
+    synchronized(&this->impl->mutex) {
+        this->impl->keepAliveEnabled = value;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool MockBroker::isKeepAliveEnabled() const {
+    return this->impl->keepAliveEnabled;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBroker::start() {
+
+    try {
+
+        synchronized(&this->impl->mutex) {
+
+            if (this->impl->started) {
+                return;
+            }
+
+            this->impl->server.reset(new ServerSocket());
+            this->impl->server->setReuseAddress(true);
+            this->impl->server->bind("127.0.0.1", this->impl->port);
+            this->impl->port = this->impl->server->getLocalPort();
+            this->impl->acceptorTasks.push_back(Pointer<Runnable>(new Acceptor(this->impl, this->impl->server, false)));
+
+            if (this->impl->stompEnabled) {
+                this->impl->stompServer.reset(new ServerSocket());
+                this->impl->stompServer->setReuseAddress(true);
+                this->impl->stompServer->bind("127.0.0.1", this->impl->stompPort);
+                this->impl->stompPort = this->impl->stompServer->getLocalPort();
+                this->impl->acceptorTasks.push_back(Pointer<Runnable>(new Acceptor(this->impl, this->impl->stompServer, true)));
+            }
+
+            this->impl->started = true;
+
+            std::vector< Pointer<Runnable> >::const_iterator task = this->impl->acceptorTasks.begin();
+            for (; task != this->impl->acceptorTasks.end(); ++task) {
+                Pointer<Thread> acceptor(new Thread(task->get(), "MockBroker Acceptor"));
+                this->impl->acceptors.push_back(acceptor);
+                acceptor->start();
+            }
+
+            // Fine grained enough for the short inactivity durations tests like to use.
+            this->impl->timer.reset(new Timer("MockBroker KeepAlive Timer"));
+            this->impl->timer->scheduleAtFixedRate(Pointer<TimerTask>(new KeepAliveTask(this->impl)), 100, 100);
+        }
+    }
+    AMQ_CATCH_RETHROW(IOException)
+    AMQ_CATCH_EXCEPTION_CONVERT(Exception, IOException)
+    AMQ_CATCHALL_THROW(IOException)
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBroker::stop() {
+
+    synchronized(&this->impl->mutex) {
+
+        if (!this->impl->started) {
+            return;
+        }
+
+        this->impl->started = false;
+    }
+
+    // The keep alive task takes the broker lock, so the timer is torn down outside of it.
+    this->impl->timer->cancel();
+    this->impl->timer.reset(NULL);
+
+    try {
+        this->impl->server->close();
+        if (this->impl->stompServer != NULL) {
+            this->impl->stompServer->close();
+        }
+    } catch (...) {
+    }
+
+    std::vector< Pointer<Thread> >::const_iterator acceptor = this->impl->acceptors.begin();
+    for (; acceptor != this->impl->acceptors.end(); ++acceptor) {
+        (*acceptor)->join();
+    }
+
+    this->dropConnections();
+
+    synchronized(&this->impl->mutex) {
+        this->impl->acceptors.clear();
+        this->impl->acceptorTasks.clear();
+        this->impl->server.reset(NULL);
+        this->impl->stompServer.reset(NULL);
+        this->impl->destinations.clear();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool MockBroker::isStarted() const {
+    return this->impl->started;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string MockBroker::getConnectString() const {
+    return std::string("tcp://127.0.0.1:") + Integer::toString(this->impl->port);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string MockBroker::getStompConnectString() const {
+    return std::string("tcp://127.0.0.1:") + Integer::toString(this->impl->stompPort) + "?wireFormat=stomp";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBroker::dropConnections() {
+
+    std::list< Pointer<BrokerConnection> > removed;
+
+    synchronized(&this->impl->mutex) {
+        this->impl->removeConnections(removed, true);
+    }
+
+    // The readers need the broker lock to clean up so they are joined outside of it.
+    std::list< Pointer<BrokerConnection> >::iterator iter = removed.begin();
+    for (; iter != removed.end(); ++iter) {
+        (*iter)->thread->join();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int MockBroker::getConnectionCount() const {
+
+    int count = 0;
+
+    synchronized(&this->impl->mutex) {
+        std::list< Pointer<BrokerConnection> >::const_iterator iter = this->impl->connections.begin();
+        for (; iter != this->impl->connections.end(); ++iter) {
+            if (!(*iter)->closed) {
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long MockBroker::getQueueSize(const std::string& queueName) const {
+
+    long long size = 0;
+
+    synchronized(&this->impl->mutex) {
+
+        std::map<std::string, Pointer<BrokerDestination> >::const_iterator iter =
+            this->impl->destinations.find(std::string("queue://") + queueName);
+
+        if (iter != this->impl->destinations.end()) {
+            size = (long long) iter->second->pending.size();
+
+            std::vector<Subscription*>::const_iterator subscription = iter->second->subscriptions.begin();
+            for (; subscription != iter->second->subscriptions.end(); ++subscription) {
+                size += (long long) (*subscription)->inFlight.size();
+            }
+        }
+    }
+
+    return size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long MockBroker::getEnqueueCount() const {
+
+    long long count = 0;
+    synchronized(&this->impl->mutex) {
+        count = this->impl->enqueueCount;
+    }
+    return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long MockBroker::getDequeueCount() const {
+
+    long long count = 0;
+    synchronized(&this->impl->mutex) {
+        count = this->impl->dequeueCount;
+    }
+    return count;
+}
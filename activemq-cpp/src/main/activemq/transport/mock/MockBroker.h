@@ -0,0 +1,181 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_TRANSPORT_MOCK_MOCKBROKER_H_
+#define _ACTIVEMQ_TRANSPORT_MOCK_MOCKBROKER_H_
+
+#include <activemq/util/Config.h>
+
+#include <string>
+
+namespace activemq {
+namespace transport {
+namespace mock {
+
+    class MockBrokerImpl;
+
+    /**
+     * A small in-process broker that serves real sockets so that the full client
+     * stack (TCP, wire format negotiation, inactivity monitoring and failover) can
+     * be exercised and load tested without an external ActiveMQ broker.
+     *
+     * The broker speaks OpenWire and, optionally, STOMP on a second port.  It keeps
+     * queues and topics in memory, honors consumer prefetch and message pulls,
+     * tracks acknowledgements so that unacknowledged queue messages are redelivered
+     * when a consumer or connection goes away, and supports local transactions.
+     * There is no persistence, no selectors and no durable subscriptions.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API MockBroker {
+    private:
+
+        MockBrokerImpl* impl;
+
+    private:
+
+        MockBroker(const MockBroker&);
+        MockBroker& operator=(const MockBroker&);
+
+    public:
+
+        MockBroker();
+
+        virtual ~MockBroker();
+
+        /**
+         * Sets the port the OpenWire listener binds to, zero selects an ephemeral
+         * port.  Once started the broker remembers the port it bound so that a
+         * restart comes back on the same address, which is what failover clients
+         * expect.
+         *
+         * @param port
+         *      The port to listen on.
+         */
+        void setPort(int port);
+
+        /**
+         * @returns the OpenWire port, the bound port once the broker has been started.
+         */
+        int getPort() const;
+
+        /**
+         * Sets the port the STOMP listener binds to, zero selects an ephemeral port.
+         *
+         * @param port
+         *      The port to listen on.
+         */
+        void setStompPort(int port);
+
+        /**
+         * @returns the STOMP port, the bound port once the broker has been started.
+         */
+        int getStompPort() const;
+
+        /**
+         * @param value
+         *      Whether the broker also accepts STOMP connections, false by default.
+         */
+        void setStompEnabled(bool value);
+
+        /**
+         * @returns true if the broker accepts STOMP connections.
+         */
+        bool isStompEnabled() const;
+
+        /**
+         * Controls whether the broker writes KeepAliveInfo commands to idle OpenWire
+         * connections.  Turning this off makes the broker go silent so the client's
+         * inactivity monitor fires, true by default.
+         *
+         * @param value
+         *      Whether keep alives are sent.
+         */
+        void setKeepAliveEnabled(bool value);
+
+        /**
+         * @returns true if the broker keeps idle OpenWire connections alive.
+         */
+        bool isKeepAliveEnabled() const;
+
+        /**
+         * Binds the listeners and starts accepting connections, does nothing if
+         * the broker is already started.
+         *
+         * @throws IOException if a listener cannot be bound.
+         */
+        void start();
+
+        /**
+         * Closes the listeners and every open connection and discards all queued
+         * messages.  Does nothing if the broker is not started.
+         */
+        void stop();
+
+        /**
+         * @returns true if the broker is started.
+         */
+        bool isStarted() const;
+
+        /**
+         * @returns a URI that an OpenWire client can use to connect to this broker.
+         */
+        std::string getConnectString() const;
+
+        /**
+         * @returns a URI that a STOMP client can use to connect to this broker.
+         */
+        std::string getStompConnectString() const;
+
+        /**
+         * Closes every open client connection while leaving the listeners up, the
+         * way a broker side network failure looks to the clients.  Messages that
+         * were in flight to those connections are returned to their queues.
+         */
+        void dropConnections();
+
+        /**
+         * @returns the number of currently open client connections.
+         */
+        int getConnectionCount() const;
+
+        /**
+         * Returns the number of messages on the named queue that have not been
+         * acknowledged yet, whether or not they have been dispatched.
+         *
+         * @param queueName
+         *      The physical name of the queue.
+         *
+         * @returns the queue depth, zero for an unknown queue.
+         */
+        long long getQueueSize(const std::string& queueName) const;
+
+        /**
+         * @returns the number of messages the broker has accepted.
+         */
+        long long getEnqueueCount() const;
+
+        /**
+         * @returns the number of messages consumers have acknowledged as consumed.
+         */
+        long long getDequeueCount() const;
+
+    };
+
+}}}
+
+#endif /* _ACTIVEMQ_TRANSPORT_MOCK_MOCKBROKER_H_ */
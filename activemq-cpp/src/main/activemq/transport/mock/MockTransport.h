@@ -132,6 +132,7 @@ namespace mock{
          */
         void setResponseBuilder(const Pointer<ResponseBuilder> responseBuilder) {
             this->responseBuilder = responseBuilder;
+            this->internalListener.setResponseBuilder(responseBuilder);
         }
 
         /**
@@ -0,0 +1,733 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ReplayTransport.h"
+
+#include <activemq/commands/ConnectionError.h>
+#include <activemq/commands/ConnectionId.h>
+#include <activemq/commands/ConnectionInfo.h>
+#include <activemq/commands/ConsumerControl.h>
+#include <activemq/commands/ConsumerId.h>
+#include <activemq/commands/MessageDispatch.h>
+#include <activemq/commands/ProducerAck.h>
+#include <activemq/commands/ProducerId.h>
+#include <activemq/commands/RemoveInfo.h>
+#include <activemq/commands/SessionId.h>
+#include <activemq/commands/WireFormatInfo.h>
+#include <activemq/exceptions/ActiveMQException.h>
+#include <activemq/io/CaptureFileReader.h>
+#include <activemq/io/CaptureInputStream.h>
+#include <activemq/io/CaptureOutputStream.h>
+#include <activemq/io/CaptureRecord.h>
+#include <activemq/transport/IOTransport.h>
+#include <activemq/wireformat/openwire/OpenWireCaptureDecoder.h>
+#include <activemq/wireformat/openwire/OpenWireFormat.h>
+#include <decaf/io/DataInputStream.h>
+#include <decaf/io/DataOutputStream.h>
+#include <decaf/io/IOException.h>
+#include <decaf/lang/Math.h>
+#include <decaf/lang/Runnable.h>
+#include <decaf/lang/System.h>
+#include <decaf/lang/Thread.h>
+#include <decaf/util/LinkedList.h>
+#include <decaf/util/Properties.h>
+#include <decaf/util/concurrent/Mutex.h>
+#include <decaf/util/concurrent/atomic/AtomicInteger.h>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::io;
+using namespace activemq::commands;
+using namespace activemq::exceptions;
+using namespace activemq::transport;
+using namespace activemq::transport::replay;
+using namespace activemq::wireformat::openwire;
+using namespace decaf;
+using namespace decaf::io;
+using namespace decaf::lang;
+using namespace decaf::util;
+using namespace decaf::util::concurrent;
+using namespace decaf::util::concurrent::atomic;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace activemq {
+namespace transport {
+namespace replay {
+
+    /**
+     * A recorded inbound command, released once the client has sent gate commands.
+     */
+    struct ReplayCommand {
+        Pointer<Command> command;
+        int gate;
+        long long timestamp;
+
+        ReplayCommand(const Pointer<Command>& command, int gate, long long timestamp) :
+            command(command), gate(gate), timestamp(timestamp) {
+        }
+    };
+
+    class ReplayTransportImpl;
+
+    /**
+     * The stream the IOTransport reads, it hands out the blocks the feeder marshaled.
+     */
+    class ReplayInputStream : public InputStream {
+    private:
+
+        ReplayTransportImpl* impl;
+
+    private:
+
+        ReplayInputStream(const ReplayInputStream&);
+        ReplayInputStream& operator=(const ReplayInputStream&);
+
+    public:
+
+        ReplayInputStream(ReplayTransportImpl* impl) : InputStream(), impl(impl) {}
+
+        virtual ~ReplayInputStream() {}
+
+        virtual int available() const;
+
+        virtual void close();
+
+    protected:
+
+        virtual int doReadByte() {
+            unsigned char value = 0;
+            return doReadArrayBounded(&value, 1, 0, 1) == 1 ? (int) value : -1;
+        }
+
+        virtual int doReadArrayBounded(unsigned char* buffer, int size, int offset, int length);
+
+    };
+
+    /**
+     * The stream the IOTransport writes, the bytes are counted and dropped.
+     */
+    class ReplayOutputStream : public OutputStream {
+    private:
+
+        ReplayTransportImpl* impl;
+
+    private:
+
+        ReplayOutputStream(const ReplayOutputStream&);
+        ReplayOutputStream& operator=(const ReplayOutputStream&);
+
+    public:
+
+        ReplayOutputStream(ReplayTransportImpl* impl) : OutputStream(), impl(impl) {}
+
+        virtual ~ReplayOutputStream() {}
+
+    protected:
+
+        virtual void doWriteByte(unsigned char value AMQCPP_UNUSED);
+
+        virtual void doWriteArrayBounded(const unsigned char* buffer, int size, int offset, int length);
+
+    };
+
+    /**
+     * Collects what the replay format marshals into a block for the input stream.
+     */
+    class BlockOutputStream : public OutputStream {
+    private:
+
+        std::vector<unsigned char>& block;
+
+    private:
+
+        BlockOutputStream(const BlockOutputStream&);
+        BlockOutputStream& operator=(const BlockOutputStream&);
+
+    public:
+
+        BlockOutputStream(std::vector<unsigned char>& block) : OutputStream(), block(block) {}
+
+        virtual ~BlockOutputStream() {}
+
+    protected:
+
+        virtual void doWriteByte(unsigned char value) {
+            this->block.push_back(value);
+        }
+
+        virtual void doWriteArrayBounded(const unsigned char* buffer, int size AMQCPP_UNUSED, int offset, int length) {
+            this->block.insert(this->block.end(), buffer + offset, buffer + offset + length);
+        }
+    };
+
+    class ReplayTransportImpl : public Runnable {
+    private:
+
+        ReplayTransportImpl(const ReplayTransportImpl&);
+        ReplayTransportImpl& operator=(const ReplayTransportImpl&);
+
+    public:
+
+        const Transport* owner;
+        std::string path;
+        int streamId;
+        bool originalSpeed;
+        Pointer<CaptureFile> outputCaptureFile;
+
+        std::vector<ReplayCommand> schedule;
+        std::string recordedConnectionId;
+        std::string connectionId;
+        Pointer<WireFormatInfo> localInfo;
+
+        Mutex mutex;
+        std::deque< std::vector<unsigned char> > blocks;
+        std::size_t blockPosition;
+        bool fed;
+        bool drained;
+        bool closed;
+
+        AtomicInteger replayed;
+        AtomicInteger sent;
+        volatile long long bytesSent;
+        long long startTime;
+        long long endTime;
+
+        std::auto_ptr<DataInputStream> dataInputStream;
+        std::auto_ptr<DataOutputStream> dataOutputStream;
+        Pointer<Thread> feeder;
+
+        ReplayTransportImpl(const Transport* owner, const std::string& path, int streamId) :
+            owner(owner), path(path), streamId(streamId), originalSpeed(false), outputCaptureFile(),
+            schedule(), recordedConnectionId(), connectionId(), localInfo(), mutex(), blocks(),
+            blockPosition(0), fed(false), drained(false), closed(false), replayed(), sent(),
+            bytesSent(0), startTime(0), endTime(0), dataInputStream(), dataOutputStream(), feeder() {
+        }
+
+        virtual ~ReplayTransportImpl() {}
+
+        void load();
+
+        virtual void run();
+
+        bool awaitGate(const ReplayCommand& next);
+
+        void awaitDue(long long start, long long recordedStart, long long timestamp);
+
+        void rewrite(const Pointer<Command>& command) const;
+
+        void rewrite(ConsumerId* id) const {
+            if (id != NULL && id->getConnectionId() == this->recordedConnectionId) {
+                id->setConnectionId(this->connectionId);
+            }
+        }
+
+        void rewrite(ProducerId* id) const {
+            if (id != NULL && id->getConnectionId() == this->recordedConnectionId) {
+                id->setConnectionId(this->connectionId);
+            }
+        }
+
+        void close() {
+            synchronized(&this->mutex) {
+                this->closed = true;
+                this->mutex.notifyAll();
+            }
+        }
+    };
+
+}}}
+
+////////////////////////////////////////////////////////////////////////////////
+int ReplayInputStream::available() const {
+
+    int available = 0;
+
+    synchronized(&impl->mutex) {
+        if (!impl->blocks.empty()) {
+            available = (int) (impl->blocks.front().size() - impl->blockPosition);
+        }
+    }
+
+    return available;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ReplayInputStream::close() {
+    impl->close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ReplayInputStream::doReadArrayBounded(unsigned char* buffer, int size, int offset, int length) {
+
+    if (buffer == NULL) {
+        throw decaf::lang::exceptions::NullPointerException(__FILE__, __LINE__, "Buffer passed is Null");
+    }
+
+    if (offset < 0 || length < 0 || offset > size - length) {
+        throw decaf::lang::exceptions::IndexOutOfBoundsException(__FILE__, __LINE__,
+            "size{%d}, offset{%d} and length{%d} are out of bounds.", size, offset, length);
+    }
+
+    if (length == 0) {
+        return 0;
+    }
+
+    int count = 0;
+
+    synchronized(&impl->mutex) {
+
+        // Once the recording is used up the client waits here as it would for a
+        // quiet broker, until the transport is closed.
+        while (impl->blocks.empty() && !impl->closed) {
+            impl->mutex.wait();
+        }
+
+        if (impl->closed) {
+            return -1;
+        }
+
+        while (count < length && !impl->blocks.empty()) {
+
+            std::vector<unsigned char>& block = impl->blocks.front();
+            int chunk = Math::min(length - count, (int) (block.size() - impl->blockPosition));
+
+            memcpy(buffer + offset + count, &block[impl->blockPosition], (size_t) chunk);
+            count += chunk;
+            impl->blockPosition += (size_t) chunk;
+
+            if (impl->blockPosition == block.size()) {
+                impl->blocks.pop_front();
+                impl->blockPosition = 0;
+            }
+        }
+
+        if (impl->blocks.empty() && impl->fed && !impl->drained) {
+            impl->drained = true;
+            impl->endTime = System::nanoTime();
+            impl->mutex.notifyAll();
+        }
+    }
+
+    return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ReplayOutputStream::doWriteByte(unsigned char value AMQCPP_UNUSED) {
+    impl->bytesSent++;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ReplayOutputStream::doWriteArrayBounded(const unsigned char* buffer, int size, int offset, int length) {
+
+    if (buffer == NULL) {
+        throw decaf::lang::exceptions::NullPointerException(__FILE__, __LINE__, "Buffer passed is Null");
+    }
+
+    if (offset < 0 || length < 0 || offset > size - length) {
+        throw decaf::lang::exceptions::IndexOutOfBoundsException(__FILE__, __LINE__,
+            "size{%d}, offset{%d} and length{%d} are out of bounds.", size, offset, length);
+    }
+
+    impl->bytesSent += length;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ReplayTransportImpl::load() {
+
+    CaptureFileReader reader(this->path);
+    OpenWireCaptureDecoder decoder;
+    CaptureRecord record;
+    LinkedList< Pointer<Command> > commands;
+    int outbound = 0;
+
+    while (reader.next(record)) {
+
+        if (this->streamId == 0) {
+            this->streamId = record.getStreamId();
+        } else if (record.getStreamId() != this->streamId) {
+            continue;
+        }
+
+        decoder.decode(record, commands);
+
+        while (!commands.isEmpty()) {
+            Pointer<Command> command = commands.removeFirst();
+
+            if (record.isInbound()) {
+                this->schedule.push_back(ReplayCommand(command, outbound, record.getTimestamp()));
+            } else if (!command->isKeepAliveInfo()) {
+                // Keep alives depend on the timing of the recorded connection, they are
+                // not counted so the replay does not wait for the client to repeat them.
+                outbound++;
+
+                if (command->isConnectionInfo() && this->recordedConnectionId.empty()) {
+                    this->recordedConnectionId =
+                        command.dynamicCast<ConnectionInfo>()->getConnectionId()->getValue();
+                }
+            }
+        }
+    }
+
+    if (this->schedule.empty() || !this->schedule.front().command->isWireFormatInfo()) {
+        throw IOException(__FILE__, __LINE__,
+            "Stream %d of capture %s does not hold the start of an OpenWire connection",
+            this->streamId, this->path.c_str());
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ReplayTransportImpl::awaitGate(const ReplayCommand& next) {
+
+    synchronized(&this->mutex) {
+
+        // The broker's WireFormatInfo can only be answered with the same format once
+        // the client's own info has been seen.
+        while (!this->closed && (this->sent.get() < next.gate ||
+               (next.command->isWireFormatInfo() && this->localInfo == NULL))) {
+
+            this->mutex.wait();
+        }
+
+        return !this->closed;
+    }
+
+    return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ReplayTransportImpl::awaitDue(long long start, long long recordedStart, long long timestamp) {
+
+    long long due = start + (timestamp - recordedStart);
+
+    synchronized(&this->mutex) {
+        long long remaining = due - System::nanoTime();
+        while (!this->closed && remaining > 1000000) {
+            this->mutex.wait(remaining / 1000000);
+            remaining = due - System::nanoTime();
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ReplayTransportImpl::rewrite(const Pointer<Command>& command) const {
+
+    if (this->recordedConnectionId.empty() || this->connectionId.empty() ||
+        this->recordedConnectionId == this->connectionId) {
+
+        return;
+    }
+
+    if (command->isMessageDispatch()) {
+        rewrite(dynamic_cast<MessageDispatch*>(command.get())->getConsumerId().get());
+    } else if (command->isProducerAck()) {
+        rewrite(dynamic_cast<ProducerAck*>(command.get())->getProducerId().get());
+    } else if (command->isConsumerControl()) {
+        rewrite(dynamic_cast<ConsumerControl*>(command.get())->getConsumerId().get());
+    } else if (command->isConnectionError()) {
+        Pointer<ConnectionId>& id = dynamic_cast<ConnectionError*>(command.get())->getConnectionId();
+        if (id != NULL && id->getValue() == this->recordedConnectionId) {
+            id->setValue(this->connectionId);
+        }
+    } else if (command->isRemoveInfo()) {
+        DataStructure* id = dynamic_cast<RemoveInfo*>(command.get())->getObjectId().get();
+        rewrite(dynamic_cast<ConsumerId*>(id));
+        rewrite(dynamic_cast<ProducerId*>(id));
+
+        SessionId* sessionId = dynamic_cast<SessionId*>(id);
+        if (sessionId != NULL && sessionId->getConnectionId() == this->recordedConnectionId) {
+            sessionId->setConnectionId(this->connectionId);
+        }
+
+        ConnectionId* connectionId = dynamic_cast<ConnectionId*>(id);
+        if (connectionId != NULL && connectionId->getValue() == this->recordedConnectionId) {
+            connectionId->setValue(this->connectionId);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ReplayTransportImpl::run() {
+
+    try {
+
+        // The recorded commands are marshaled again with the format the client
+        // negotiates, its own WireFormatInfo and the broker's recorded one.
+        OpenWireFormat format((Properties()));
+        std::vector<ReplayCommand>::const_iterator iter = this->schedule.begin();
+        long long start = 0;
+
+        for (; iter != this->schedule.end(); ++iter) {
+
+            if (!awaitGate(*iter)) {
+                return;
+            }
+
+            if (start == 0) {
+                start = System::nanoTime();
+            } else if (this->originalSpeed) {
+                awaitDue(start, this->schedule.front().timestamp, iter->timestamp);
+            }
+
+            std::vector<unsigned char> block;
+            BlockOutputStream blockStream(block);
+            DataOutputStream dataOut(&blockStream);
+
+            synchronized(&this->mutex) {
+                rewrite(iter->command);
+            }
+
+            format.marshal(iter->command, this->owner, &dataOut);
+
+            if (iter->command->isWireFormatInfo()) {
+                Pointer<WireFormatInfo> localInfo;
+                synchronized(&this->mutex) {
+                    localInfo = this->localInfo;
+                }
+
+                format.setPreferedWireFormatInfo(localInfo);
+                format.renegotiateWireFormat(*iter->command.dynamicCast<WireFormatInfo>());
+            }
+
+            synchronized(&this->mutex) {
+                if (this->startTime == 0) {
+                    this->startTime = System::nanoTime();
+                }
+
+                this->blocks.push_back(std::vector<unsigned char>());
+                this->blocks.back().swap(block);
+                this->replayed.incrementAndGet();
+                this->mutex.notifyAll();
+            }
+        }
+
+        synchronized(&this->mutex) {
+            this->fed = true;
+            if (this->blocks.empty() && !this->drained) {
+                this->drained = true;
+                this->endTime = System::nanoTime();
+            }
+            this->mutex.notifyAll();
+        }
+    }
+    AMQ_CATCHALL_NOTHROW()
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ReplayTransport::ReplayTransport(const Pointer<Transport> next, const std::string& path, int streamId) :
+    TransportFilter(next), impl(new ReplayTransportImpl(this, path, streamId)) {
+
+    try {
+        this->impl->load();
+    } catch (...) {
+        delete this->impl;
+        throw;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ReplayTransport::~ReplayTransport() {
+    try {
+        close();
+    }
+    AMQ_CATCHALL_NOTHROW()
+
+    try {
+        delete this->impl;
+    }
+    AMQ_CATCHALL_NOTHROW()
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ReplayTransport::setOriginalSpeed(bool originalSpeed) {
+    this->impl->originalSpeed = originalSpeed;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ReplayTransport::isOriginalSpeed() const {
+    return this->impl->originalSpeed;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ReplayTransport::setOutputCaptureFile(const Pointer<CaptureFile> captureFile) {
+    this->impl->outputCaptureFile = captureFile;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<CaptureFile> ReplayTransport::getOutputCaptureFile() const {
+    return this->impl->outputCaptureFile;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ReplayTransport::getStreamId() const {
+    return this->impl->streamId;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ReplayTransport::getCommandCount() const {
+    return (int) this->impl->schedule.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ReplayTransport::getCommandsReplayed() const {
+    return this->impl->replayed.get();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ReplayTransport::getCommandsSent() const {
+    return this->impl->sent.get();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long ReplayTransport::getBytesSent() const {
+    return this->impl->bytesSent;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long ReplayTransport::getReplayTime() const {
+
+    long long replayTime = 0;
+
+    synchronized(&this->impl->mutex) {
+        if (this->impl->startTime != 0) {
+            long long end = this->impl->drained ? this->impl->endTime : System::nanoTime();
+            replayTime = end - this->impl->startTime;
+        }
+    }
+
+    return replayTime;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ReplayTransport::awaitCompletion(long long timeout) {
+
+    long long deadline = System::currentTimeMillis() + timeout;
+
+    synchronized(&this->impl->mutex) {
+        while (!this->impl->drained && !this->impl->closed) {
+            long long remaining = deadline - System::currentTimeMillis();
+            if (remaining <= 0) {
+                break;
+            }
+            this->impl->mutex.wait(remaining);
+        }
+
+        return this->impl->drained;
+    }
+
+    return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ReplayTransport::oneway(const Pointer<Command> command) {
+
+    try {
+
+        checkClosed();
+
+        if (command->isWireFormatInfo() || command->isConnectionInfo()) {
+            synchronized(&this->impl->mutex) {
+                if (command->isWireFormatInfo()) {
+                    this->impl->localInfo = command.dynamicCast<WireFormatInfo>();
+                } else if (this->impl->connectionId.empty()) {
+                    this->impl->connectionId = command.dynamicCast<ConnectionInfo>()->getConnectionId()->getValue();
+                }
+            }
+        }
+
+        next->oneway(command);
+
+        if (!command->isKeepAliveInfo()) {
+            this->impl->sent.incrementAndGet();
+            synchronized(&this->impl->mutex) {
+                this->impl->mutex.notifyAll();
+            }
+        }
+    }
+    AMQ_CATCH_RETHROW(IOException)
+    AMQ_CATCH_EXCEPTION_CONVERT(Exception, IOException)
+    AMQ_CATCHALL_THROW(IOException)
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ReplayTransport::isConnected() const {
+    return !isClosed();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string ReplayTransport::getRemoteAddress() const {
+    return "replay:" + this->impl->path;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ReplayTransport::beforeNextIsStarted() {
+
+    try {
+
+        IOTransport* ioTransport = dynamic_cast<IOTransport*>(next.get());
+        if (ioTransport == NULL) {
+            throw ActiveMQException(__FILE__, __LINE__, "ReplayTransport::beforeNextIsStarted - "
+                "transport must be of type IOTransport");
+        }
+
+        Pointer<InputStream> inputStream(new ReplayInputStream(this->impl));
+        Pointer<OutputStream> outputStream(new ReplayOutputStream(this->impl));
+
+        Pointer<CaptureFile> captureFile = this->impl->outputCaptureFile;
+        if (captureFile != NULL) {
+            int streamId = captureFile->newStreamId();
+            inputStream.reset(new CaptureInputStream(inputStream.release(), captureFile, streamId, true));
+            outputStream.reset(new CaptureOutputStream(outputStream.release(), captureFile, streamId, true));
+        }
+
+        this->impl->dataInputStream.reset(new DataInputStream(inputStream.release(), true));
+        this->impl->dataOutputStream.reset(new DataOutputStream(outputStream.release(), true));
+
+        ioTransport->setInputStream(this->impl->dataInputStream.get());
+        ioTransport->setOutputStream(this->impl->dataOutputStream.get());
+
+        this->impl->feeder.reset(new Thread(this->impl, "ActiveMQ Replay Feeder"));
+        this->impl->feeder->start();
+    }
+    AMQ_CATCH_RETHROW(IOException)
+    AMQ_CATCH_EXCEPTION_CONVERT(Exception, IOException)
+    AMQ_CATCHALL_THROW(IOException)
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ReplayTransport::afterNextIsStopped() {
+    this->impl->close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ReplayTransport::doClose() {
+
+    try {
+        this->impl->close();
+
+        if (this->impl->feeder != NULL) {
+            this->impl->feeder->join();
+            this->impl->feeder.reset(NULL);
+        }
+    }
+    AMQ_CATCH_RETHROW(IOException)
+    AMQ_CATCH_EXCEPTION_CONVERT(Exception, IOException)
+    AMQ_CATCHALL_THROW(IOException)
+}
@@ -0,0 +1,165 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_TRANSPORT_REPLAY_REPLAYTRANSPORT_H_
+#define _ACTIVEMQ_TRANSPORT_REPLAY_REPLAYTRANSPORT_H_
+
+#include <activemq/util/Config.h>
+#include <activemq/io/CaptureFile.h>
+#include <activemq/transport/TransportFilter.h>
+#include <decaf/lang/Pointer.h>
+
+#include <string>
+
+namespace activemq {
+namespace transport {
+namespace replay {
+
+    using decaf::lang::Pointer;
+
+    class ReplayTransportImpl;
+
+    /**
+     * Plays the inbound side of a connection recorded in a CaptureFile back into the
+     * client, in place of a broker.  The transport feeds the IOTransport below it with
+     * the recorded commands as OpenWire bytes, so they are unmarshaled and dispatched
+     * exactly as on a live connection, while everything the client sends is
+     * marshaled and then discarded.
+     *
+     * The replay follows the client: each recorded command is released only once the
+     * client has sent as many commands as the recorded client had when it arrived, so
+     * responses find the request they answer.  By default commands are released as
+     * fast as the client takes them, they can also be spaced as they were recorded.
+     * The connection id of the recorded connection is swapped for the one the client
+     * uses so the dispatches reach its consumers.
+     *
+     * The client has to perform the same steps as the recorded one for the replay to
+     * line up, typically it is the same application or benchmark.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API ReplayTransport : public TransportFilter {
+    private:
+
+        ReplayTransportImpl* impl;
+
+    private:
+
+        ReplayTransport(const ReplayTransport&);
+        ReplayTransport& operator=(const ReplayTransport&);
+
+    public:
+
+        /**
+         * Loads the recording of one stream of a capture file.
+         *
+         * @param next
+         *      The IOTransport the recorded bytes are fed to.
+         * @param path
+         *      The capture file to replay.
+         * @param streamId
+         *      The stream to replay, zero replays the first stream in the capture.
+         *
+         * @throws IOException if the capture cannot be read or the stream does not
+         *         hold the start of an OpenWire connection.
+         */
+        ReplayTransport(const Pointer<Transport> next, const std::string& path, int streamId = 0);
+
+        virtual ~ReplayTransport();
+
+        /**
+         * Sets whether the recorded commands are spaced by their recorded times,
+         * otherwise they are released as soon as the client is ready for them.
+         */
+        void setOriginalSpeed(bool originalSpeed);
+        bool isOriginalSpeed() const;
+
+        /**
+         * Sets a capture file the replayed connection is recorded to, both the bytes
+         * fed to the client and the bytes it sent.  Must be set before the transport is
+         * started.
+         */
+        void setOutputCaptureFile(const Pointer<activemq::io::CaptureFile> captureFile);
+        Pointer<activemq::io::CaptureFile> getOutputCaptureFile() const;
+
+        /**
+         * @returns the id of the stream being replayed.
+         */
+        int getStreamId() const;
+
+        /**
+         * @returns the number of recorded commands the replay will feed to the client.
+         */
+        int getCommandCount() const;
+
+        /**
+         * @returns the number of recorded commands fed to the client so far.
+         */
+        int getCommandsReplayed() const;
+
+        /**
+         * @returns the number of commands the client has sent so far.
+         */
+        int getCommandsSent() const;
+
+        /**
+         * @returns the number of bytes the client has written so far.
+         */
+        long long getBytesSent() const;
+
+        /**
+         * @returns the time in nanoseconds from the first recorded byte being fed to
+         *          the client until the last one was read, or so far if the replay has
+         *          not completed.
+         */
+        long long getReplayTime() const;
+
+        /**
+         * Waits for the client to read the last recorded command.
+         *
+         * @param timeout
+         *      The time to wait in milliseconds.
+         *
+         * @returns true if the replay completed.
+         */
+        bool awaitCompletion(long long timeout);
+
+    public: // Transport Methods
+
+        virtual void oneway(const Pointer<Command> command);
+
+        virtual bool isFaultTolerant() const {
+            return false;
+        }
+
+        virtual bool isConnected() const;
+
+        virtual std::string getRemoteAddress() const;
+
+    protected:
+
+        virtual void beforeNextIsStarted();
+
+        virtual void afterNextIsStopped();
+
+        virtual void doClose();
+
+    };
+
+}}}
+
+#endif /* _ACTIVEMQ_TRANSPORT_REPLAY_REPLAYTRANSPORT_H_ */
@@ -0,0 +1,131 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ReplayTransportFactory.h"
+
+#include <activemq/io/CaptureFile.h>
+#include <activemq/transport/IOTransport.h>
+#include <activemq/transport/correlator/ResponseCorrelator.h>
+#include <activemq/transport/replay/ReplayTransport.h>
+#include <activemq/util/URISupport.h>
+#include <activemq/wireformat/WireFormat.h>
+#include <decaf/lang/Integer.h>
+#include <decaf/lang/exceptions/IllegalArgumentException.h>
+#include <decaf/util/Properties.h>
+
+using namespace activemq;
+using namespace activemq::util;
+using namespace activemq::wireformat;
+using namespace activemq::transport;
+using namespace activemq::transport::replay;
+using namespace activemq::transport::correlator;
+using namespace activemq::exceptions;
+using namespace decaf;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::util;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    Properties parseOptions(const decaf::net::URI& location) {
+        if (location.isOpaque()) {
+            return activemq::util::URISupport::parseQuery(location.getSchemeSpecificPart());
+        }
+
+        return activemq::util::URISupport::parseQuery(location.getQuery());
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<Transport> ReplayTransportFactory::create(const decaf::net::URI& location) {
+
+    try {
+
+        Properties properties = parseOptions(location);
+
+        Pointer<WireFormat> wireFormat = this->createWireFormat(properties);
+
+        // Create the initial Composite Transport, then wrap it in the normal Filters
+        // for a non-composite Transport which right now is just a ResponseCorrelator
+        Pointer<Transport> transport(doCreateComposite(location, wireFormat, properties));
+
+        transport.reset(new ResponseCorrelator(transport));
+
+        return transport;
+    }
+    AMQ_CATCH_RETHROW(ActiveMQException)
+    AMQ_CATCH_EXCEPTION_CONVERT(Exception, ActiveMQException)
+    AMQ_CATCHALL_THROW(ActiveMQException)
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<Transport> ReplayTransportFactory::createComposite(const decaf::net::URI& location) {
+
+    try {
+
+        Properties properties = parseOptions(location);
+
+        Pointer<WireFormat> wireFormat = this->createWireFormat(properties);
+
+        // Create the initial Transport, then wrap it in the normal Filters
+        return doCreateComposite(location, wireFormat, properties);
+    }
+    AMQ_CATCH_RETHROW(ActiveMQException)
+    AMQ_CATCH_EXCEPTION_CONVERT(Exception, ActiveMQException)
+    AMQ_CATCHALL_THROW(ActiveMQException)
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<Transport> ReplayTransportFactory::doCreateComposite(const decaf::net::URI& location AMQCPP_UNUSED,
+                                                             const Pointer<wireformat::WireFormat> wireFormat,
+                                                             const decaf::util::Properties& properties) {
+
+    try {
+
+        std::string file = properties.getProperty("file", "");
+        if (file.empty()) {
+            throw IllegalArgumentException(__FILE__, __LINE__, "The replay transport needs a capture file to replay");
+        }
+
+        if (!wireFormat->hasNegotiator()) {
+            throw IllegalArgumentException(__FILE__, __LINE__, "The replay transport only replays OpenWire captures");
+        }
+
+        Pointer<Transport> transport(new IOTransport(wireFormat));
+
+        Pointer<ReplayTransport> replay(new ReplayTransport(
+            transport, file, Integer::parseInt(properties.getProperty("stream", "0"))));
+
+        replay->setOriginalSpeed(properties.getProperty("speed", "max") == "original");
+
+        std::string outputFile = properties.getProperty("outputFile", "");
+        if (!outputFile.empty()) {
+            int outputFileSize = Integer::parseInt(properties.getProperty(
+                "outputFileSize", Integer::toString(activemq::io::CaptureFile::DEFAULT_CAPACITY)));
+            replay->setOutputCaptureFile(Pointer<activemq::io::CaptureFile>(
+                new activemq::io::CaptureFile(outputFile, outputFileSize)));
+        }
+
+        transport = replay;
+
+        return wireFormat->createNegotiator(transport);
+    }
+    AMQ_CATCH_RETHROW(ActiveMQException)
+    AMQ_CATCH_EXCEPTION_CONVERT(Exception, ActiveMQException)
+    AMQ_CATCHALL_THROW(ActiveMQException)
+}
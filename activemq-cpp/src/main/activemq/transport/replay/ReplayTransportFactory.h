@@ -0,0 +1,63 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_TRANSPORT_REPLAY_REPLAYTRANSPORTFACTORY_H_
+#define _ACTIVEMQ_TRANSPORT_REPLAY_REPLAYTRANSPORTFACTORY_H_
+
+#include <activemq/util/Config.h>
+#include <activemq/transport/AbstractTransportFactory.h>
+#include <activemq/exceptions/ActiveMQException.h>
+
+namespace activemq {
+namespace transport {
+namespace replay {
+
+    using decaf::lang::Pointer;
+
+    /**
+     * Creates ReplayTransports for URIs of the form
+     * <code>replay:file=/path/to/capture&speed=original</code>, or with the options
+     * in the query of <code>replay://localhost?file=...</code>.  The options are:
+     *
+     *  - file : the capture file to replay, required.
+     *  - stream : the stream of the capture to replay, the first one by default.
+     *  - speed : <code>max</code> (the default) or <code>original</code>.
+     *  - outputFile : a capture file the replayed connection is recorded to.
+     *  - outputFileSize : the size of that capture file.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API ReplayTransportFactory : public AbstractTransportFactory {
+    public:
+
+        virtual ~ReplayTransportFactory() {}
+
+        virtual Pointer<Transport> create(const decaf::net::URI& location);
+
+        virtual Pointer<Transport> createComposite(const decaf::net::URI& location);
+
+    protected:
+
+        virtual Pointer<Transport> doCreateComposite(const decaf::net::URI& location,
+                                                     const Pointer<wireformat::WireFormat> wireFormat,
+                                                     const decaf::util::Properties& properties);
+
+    };
+
+}}}
+
+#endif /* _ACTIVEMQ_TRANSPORT_REPLAY_REPLAYTRANSPORTFACTORY_H_ */
@@ -19,10 +19,12 @@
 
 #include <activemq/transport/IOTransport.h>
 #include <activemq/transport/TransportFactory.h>
+#include <activemq/io/FileRegionDataOutputStream.h>
 
 #include <decaf/lang/exceptions/NullPointerException.h>
 #include <decaf/lang/exceptions/IllegalArgumentException.h>
 #include <decaf/net/SocketFactory.h>
+#include <decaf/internal/net/tcp/TcpSocketOutputStream.h>
 #include <decaf/util/concurrent/atomic/AtomicBoolean.h>
 
 #include <memory>
@@ -35,6 +37,7 @@ using namespace activemq::transport::tcp;
 using namespace activemq::exceptions;
 using namespace decaf;
 using namespace decaf::net;
+using namespace decaf::internal::net::tcp;
 using namespace decaf::util;
 using namespace decaf::util::concurrent;
 using namespace decaf::util::concurrent::atomic;
@@ -67,6 +70,8 @@ namespace tcp {
 
         bool trace;
 
+        Pointer<CaptureFile> captureFile;
+
         int soLinger;
         bool soKeepAlive;
         int soReceiveBufferSize;
@@ -82,6 +87,7 @@ namespace tcp {
             outputBufferSize(8192),
             inputBufferSize(8192),
             trace(false),
+            captureFile(),
             soLinger(-1),
             soKeepAlive(false),
             soReceiveBufferSize(-1),
@@ -190,12 +196,33 @@ void TcpTransport::connect() {
         Pointer<InputStream> inputStream;
         Pointer<OutputStream> outputStream;
 
+        // File backed message bodies can be sent straight from the file when nothing
+        // but buffering sits above a plain socket, SSL sockets use other stream types.
+        TcpSocketOutputStream* sendFileStream = dynamic_cast<TcpSocketOutputStream*>(sokcetOStream);
+
         // If tcp tracing was enabled, wrap the input / output streams with logging streams
         if (this->impl->trace) {
             // Wrap with logging stream, we don't own the wrapped streams
             inputStream.reset(new LoggingInputStream(socketIStream));
             outputStream.reset(new LoggingOutputStream(sokcetOStream));
+        }
 
+        // If capture was enabled, record the raw bytes of this connection under its own
+        // stream id, below the buffering so each socket read and write is one record.
+        Pointer<CaptureFile> captureFile = this->impl->captureFile;
+        if (captureFile != NULL) {
+            int streamId = captureFile->newStreamId();
+
+            if (inputStream != NULL) {
+                inputStream.reset(new CaptureInputStream(inputStream.release(), captureFile, streamId, true));
+                outputStream.reset(new CaptureOutputStream(outputStream.release(), captureFile, streamId, true));
+            } else {
+                inputStream.reset(new CaptureInputStream(socketIStream, captureFile, streamId));
+                outputStream.reset(new CaptureOutputStream(sokcetOStream, captureFile, streamId));
+            }
+        }
+
+        if (inputStream != NULL) {
             // Now wrap with the Buffered streams, we own the source streams
             inputStream.reset(new BufferedInputStream(inputStream.release(), inputBufferSize, true));
             outputStream.reset(new BufferedOutputStream(outputStream.release(), outputBufferSize, true));
@@ -209,7 +236,12 @@ void TcpTransport::connect() {
         // the Source streams, all the streams in the chain that we own are
         // destroyed when these are.
         this->impl->dataInputStream.reset(new DataInputStream(inputStream.release(), true));
-        this->impl->dataOutputStream.reset(new DataOutputStream(outputStream.release(), true));
+        if (sendFileStream != NULL && !this->impl->trace && captureFile == NULL) {
+            this->impl->dataOutputStream.reset(
+                new FileRegionDataOutputStream(outputStream.release(), sendFileStream, true));
+        } else {
+            this->impl->dataOutputStream.reset(new DataOutputStream(outputStream.release(), true));
+        }
 
         // Give the IOTransport the streams.
         ioTransport->setInputStream(impl->dataInputStream.get());
@@ -313,6 +345,16 @@ bool TcpTransport::isTrace() const {
     return this->impl->trace;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void TcpTransport::setCaptureFile(const Pointer<CaptureFile> captureFile) {
+    this->impl->captureFile = captureFile;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<CaptureFile> TcpTransport::getCaptureFile() const {
+    return this->impl->captureFile;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void TcpTransport::setLinger(int soLinger) {
     this->impl->soLinger = soLinger;
@@ -18,6 +18,9 @@
 #ifndef _ACTIVEMQ_TRANSPORT_TCP_TCPTRANSPORT_H_
 #define _ACTIVEMQ_TRANSPORT_TCP_TCPTRANSPORT_H_
 
+#include <activemq/io/CaptureFile.h>
+#include <activemq/io/CaptureInputStream.h>
+#include <activemq/io/CaptureOutputStream.h>
 #include <activemq/io/LoggingInputStream.h>
 #include <activemq/io/LoggingOutputStream.h>
 #include <activemq/util/Config.h>
@@ -82,6 +85,17 @@ namespace tcp {
         void setTrace(bool trace);
         bool isTrace() const;
 
+        /**
+         * Sets the file the raw bytes of each connection this transport makes are
+         * captured to, or NULL to stop capturing on the next connect.  The file can be
+         * shared by any number of transports, each connection gets its own stream id.
+         *
+         * @param captureFile
+         *      The CaptureFile to append to.
+         */
+        void setCaptureFile(const Pointer<activemq::io::CaptureFile> captureFile);
+        Pointer<activemq::io::CaptureFile> getCaptureFile() const;
+
         void setLinger(int soLinger);
         int getLinger() const;
 
@@ -17,6 +17,7 @@
 
 #include "TcpTransportFactory.h"
 
+#include <activemq/io/CaptureFile.h>
 #include <activemq/transport/IOTransport.h>
 #include <activemq/transport/tcp/TcpTransport.h>
 #include <activemq/transport/correlator/ResponseCorrelator.h>
@@ -137,6 +138,15 @@ void TcpTransportFactory::doConfigureTransport(Pointer<Transport> transport,
         tcp->setSendBufferSize(Integer::parseInt(properties.getProperty("soSendBufferSize", "-1")));
         tcp->setTcpNoDelay(Boolean::parseBoolean(properties.getProperty("tcpNoDelay", "true")));
         tcp->setConnectTimeout(Integer::parseInt(properties.getProperty("soConnectTimeout", "0")));
+
+        // Each connection reopens the shared capture file, appending to what the
+        // connections before it captured.
+        std::string captureFile = properties.getProperty("transport.captureFile", "");
+        if (!captureFile.empty()) {
+            int captureFileSize = Integer::parseInt(properties.getProperty(
+                "transport.captureFileSize", Integer::toString(activemq::io::CaptureFile::DEFAULT_CAPACITY)));
+            tcp->setCaptureFile(Pointer<activemq::io::CaptureFile>(new activemq::io::CaptureFile(captureFile, captureFileSize)));
+        }
     }
     AMQ_CATCH_RETHROW(ActiveMQException)
     AMQ_CATCH_EXCEPTION_CONVERT(Exception, ActiveMQException)
@@ -0,0 +1,187 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LatencyHistogram.h"
+
+#include <decaf/internal/util/concurrent/Atomics.h>
+
+using namespace activemq;
+using namespace activemq::util;
+using namespace decaf::internal::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    // Values below LINEAR_LIMIT get a bucket each, above it every power of two
+    // is split into SUB_BUCKETS linear steps.
+    const int SUB_BUCKET_BITS = 5;
+    const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    const int LINEAR_BITS = SUB_BUCKET_BITS + 1;
+    const long long LINEAR_LIMIT = 1LL << LINEAR_BITS;
+
+    int magnitudeOf(unsigned long long value) {
+#if defined(__GNUC__)
+        return 63 - __builtin_clzll(value);
+#else
+        int magnitude = 0;
+        while (value >>= 1) {
+            magnitude++;
+        }
+        return magnitude;
+#endif
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+LatencyHistogram::~LatencyHistogram() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int LatencyHistogram::bucketOf(long long nanos) {
+
+    if (nanos < LINEAR_LIMIT) {
+        return nanos < 0 ? 0 : (int) nanos;
+    }
+
+    int magnitude = magnitudeOf((unsigned long long) nanos);
+    int shift = magnitude - SUB_BUCKET_BITS;
+    int bucket = (int) LINEAR_LIMIT + (magnitude - LINEAR_BITS) * SUB_BUCKETS +
+                 (int) (nanos >> shift) - SUB_BUCKETS;
+
+    return bucket < BUCKET_COUNT ? bucket : BUCKET_COUNT - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long LatencyHistogram::lowestValueIn(int bucket) {
+
+    if (bucket < LINEAR_LIMIT) {
+        return bucket;
+    }
+
+    int offset = bucket - (int) LINEAR_LIMIT;
+    int shift = offset / SUB_BUCKETS + LINEAR_BITS - SUB_BUCKET_BITS;
+    return (long long) (SUB_BUCKETS + offset % SUB_BUCKETS) << shift;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long LatencyHistogram::highestValueIn(int bucket) {
+
+    if (bucket < LINEAR_LIMIT) {
+        return bucket;
+    }
+
+    int offset = bucket - (int) LINEAR_LIMIT;
+    int shift = offset / SUB_BUCKETS + LINEAR_BITS - SUB_BUCKET_BITS;
+    return ((long long) (SUB_BUCKETS + offset % SUB_BUCKETS + 1) << shift) - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void LatencyHistogram::record(long long nanos) {
+    Atomics::getAndAdd64(&this->counts[bucketOf(nanos)], 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long LatencyHistogram::getCount() const {
+
+    long long count = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        count += Atomics::get64(&this->counts[i]);
+    }
+
+    return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long LatencyHistogram::getMinValue() const {
+
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        if (Atomics::get64(&this->counts[i]) != 0) {
+            return lowestValueIn(i);
+        }
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long LatencyHistogram::getMaxValue() const {
+
+    for (int i = BUCKET_COUNT - 1; i >= 0; --i) {
+        if (Atomics::get64(&this->counts[i]) != 0) {
+            return highestValueIn(i);
+        }
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+double LatencyHistogram::getMean() const {
+
+    long long count = 0;
+    double total = 0.0;
+
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        long long bucketCount = Atomics::get64(&this->counts[i]);
+        if (bucketCount != 0) {
+            count += bucketCount;
+            total += (double) bucketCount * ((double) lowestValueIn(i) + (double) highestValueIn(i)) / 2.0;
+        }
+    }
+
+    return count == 0 ? 0.0 : total / (double) count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long LatencyHistogram::getValueAtPercentile(double percentile) const {
+
+    long long count = getCount();
+    if (count == 0) {
+        return 0;
+    }
+
+    if (percentile > 100.0) {
+        percentile = 100.0;
+    }
+
+    long long rank = (long long) (percentile / 100.0 * (double) count + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+
+    long long seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += Atomics::get64(&this->counts[i]);
+        if (seen >= rank) {
+            return highestValueIn(i);
+        }
+    }
+
+    return getMaxValue();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void LatencyHistogram::reset() {
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        this->counts[i] = 0;
+    }
+}
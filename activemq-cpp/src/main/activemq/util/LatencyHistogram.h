@@ -0,0 +1,125 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_UTIL_LATENCYHISTOGRAM_H_
+#define _ACTIVEMQ_UTIL_LATENCYHISTOGRAM_H_
+
+#include <activemq/util/Config.h>
+
+namespace activemq {
+namespace util {
+
+    /**
+     * A fixed size histogram of latencies in nanoseconds in the style of an HDR
+     * histogram.  Values below 64 are counted exactly, larger values fall into
+     * buckets of 32 linear steps per power of two so every value is kept to within
+     * about three percent.  Values of 2^36 nanoseconds (about 68 seconds) and more
+     * are counted in the last bucket.
+     *
+     * Recording is a single atomic increment and never allocates, so it can be
+     * called from any number of threads on the hot path.  Reads are not atomic
+     * with respect to concurrent recording, they see a close but possibly not
+     * exact picture while values are still being added.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API LatencyHistogram {
+    public:
+
+        static const int BUCKET_COUNT = 1024;
+
+    private:
+
+        volatile long long counts[BUCKET_COUNT];
+
+    private:
+
+        LatencyHistogram(const LatencyHistogram&);
+        LatencyHistogram& operator=(const LatencyHistogram&);
+
+    public:
+
+        LatencyHistogram();
+
+        virtual ~LatencyHistogram();
+
+        /**
+         * Counts one value, negative values are counted as zero.
+         *
+         * @param nanos
+         *      The latency to record in nanoseconds.
+         */
+        void record(long long nanos);
+
+        /**
+         * @returns the number of values recorded.
+         */
+        long long getCount() const;
+
+        /**
+         * @returns the smallest value recorded to within the histogram's precision,
+         *          or zero if nothing has been recorded.
+         */
+        long long getMinValue() const;
+
+        /**
+         * @returns the largest value recorded to within the histogram's precision,
+         *          or zero if nothing has been recorded.
+         */
+        long long getMaxValue() const;
+
+        /**
+         * @returns the mean of the recorded values, each taken at the middle of its bucket.
+         */
+        double getMean() const;
+
+        /**
+         * Returns the value that the given percentage of the recorded values are at
+         * or below, reported as the upper end of the bucket it falls in.
+         *
+         * @param percentile
+         *      The percentile to compute, from 0.0 to 100.0.
+         *
+         * @returns the value at that percentile or zero if nothing has been recorded.
+         */
+        long long getValueAtPercentile(double percentile) const;
+
+        /**
+         * Discards all recorded values.
+         */
+        void reset();
+
+        /**
+         * @returns the index of the bucket a value is counted in.
+         */
+        static int bucketOf(long long nanos);
+
+        /**
+         * @returns the smallest value counted in the given bucket.
+         */
+        static long long lowestValueIn(int bucket);
+
+        /**
+         * @returns the largest value counted in the given bucket.
+         */
+        static long long highestValueIn(int bucket);
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_UTIL_LATENCYHISTOGRAM_H_ */
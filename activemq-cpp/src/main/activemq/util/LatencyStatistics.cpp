@@ -0,0 +1,109 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LatencyStatistics.h"
+
+#include <decaf/lang/exceptions/IndexOutOfBoundsException.h>
+
+#include <sstream>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::util;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+
+////////////////////////////////////////////////////////////////////////////////
+LatencyStatistics::LatencyStatistics(Pointer<LatencyStatistics> parent) : histograms(), parent(parent) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+LatencyStatistics::~LatencyStatistics() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void LatencyStatistics::record(Metric metric, long long nanos) {
+
+    LatencyStatistics* current = this;
+    while (current != NULL) {
+        current->histograms[metric].record(nanos);
+        current = current->parent.get();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const LatencyHistogram& LatencyStatistics::getHistogram(Metric metric) const {
+
+    if (metric < 0 || metric >= METRIC_COUNT) {
+        throw IndexOutOfBoundsException(__FILE__, __LINE__, "Invalid metric: %d", (int) metric);
+    }
+
+    return this->histograms[metric];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void LatencyStatistics::reset() {
+    for (int i = 0; i < METRIC_COUNT; ++i) {
+        this->histograms[i].reset();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string LatencyStatistics::toString() const {
+
+    std::ostringstream stream;
+
+    for (int i = 0; i < METRIC_COUNT; ++i) {
+        const LatencyHistogram& histogram = this->histograms[i];
+
+        if (i != 0) {
+            stream << ", ";
+        }
+
+        stream << getMetricName((Metric) i) << "={count=" << histogram.getCount();
+        if (histogram.getCount() != 0) {
+            stream << ", mean=" << histogram.getMean() / 1000.0
+                   << "us, p50=" << (double) histogram.getValueAtPercentile(50.0) / 1000.0
+                   << "us, p99=" << (double) histogram.getValueAtPercentile(99.0) / 1000.0
+                   << "us, max=" << (double) histogram.getMaxValue() / 1000.0 << "us";
+        }
+        stream << "}";
+    }
+
+    return stream.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string LatencyStatistics::getMetricName(Metric metric) {
+
+    switch (metric) {
+        case SEND_LATENCY:
+            return "sendLatency";
+        case MARSHAL_TIME:
+            return "marshalTime";
+        case SOCKET_WRITE_TIME:
+            return "socketWriteTime";
+        case DISPATCH_RESIDENCE_TIME:
+            return "dispatchResidenceTime";
+        case LISTENER_TIME:
+            return "listenerTime";
+        case ACK_ROUND_TRIP:
+            return "ackRoundTrip";
+        default:
+            return "unknown";
+    }
+}
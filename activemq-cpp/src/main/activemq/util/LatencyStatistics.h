@@ -0,0 +1,120 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_UTIL_LATENCYSTATISTICS_H_
+#define _ACTIVEMQ_UTIL_LATENCYSTATISTICS_H_
+
+#include <activemq/util/Config.h>
+#include <activemq/util/LatencyHistogram.h>
+#include <decaf/lang/Pointer.h>
+
+#include <string>
+
+namespace activemq {
+namespace util {
+
+    /**
+     * The set of latency histograms kept for one Connection, Session or Consumer
+     * when statistics are enabled on the Connection.  Every value recorded here is
+     * also recorded in the parent statistics, so a Connection's statistics hold the
+     * totals of all its Sessions and a Session's the totals of all its Consumers.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API LatencyStatistics {
+    public:
+
+        enum Metric {
+            /** Time spent in a producer send, up to the broker's response when synchronous. */
+            SEND_LATENCY,
+            /** Time spent marshaling a command into the transport's output stream. */
+            MARSHAL_TIME,
+            /** Time spent flushing a marshaled command to the socket. */
+            SOCKET_WRITE_TIME,
+            /** Time from a dispatch arriving from the transport to it being handed to the application. */
+            DISPATCH_RESIDENCE_TIME,
+            /** Time spent in a MessageListener's onMessage call. */
+            LISTENER_TIME,
+            /** Time taken to send a MessageAck, up to the broker's response when synchronous. */
+            ACK_ROUND_TRIP,
+            METRIC_COUNT
+        };
+
+    private:
+
+        LatencyHistogram histograms[METRIC_COUNT];
+        decaf::lang::Pointer<LatencyStatistics> parent;
+
+    private:
+
+        LatencyStatistics(const LatencyStatistics&);
+        LatencyStatistics& operator=(const LatencyStatistics&);
+
+    public:
+
+        /**
+         * Creates a new set of statistics.
+         *
+         * @param parent
+         *      Statistics that everything recorded here is also recorded in, can be NULL.
+         */
+        LatencyStatistics(decaf::lang::Pointer<LatencyStatistics> parent = decaf::lang::Pointer<LatencyStatistics>());
+
+        virtual ~LatencyStatistics();
+
+        /**
+         * Records one value for the given metric here and in the parent statistics.
+         *
+         * @param metric
+         *      The metric the value was measured for.
+         * @param nanos
+         *      The measured time in nanoseconds.
+         */
+        void record(Metric metric, long long nanos);
+
+        /**
+         * @returns the histogram holding the values recorded for the given metric.
+         */
+        const LatencyHistogram& getHistogram(Metric metric) const;
+
+        /**
+         * @returns the parent statistics, or NULL if there are none.
+         */
+        decaf::lang::Pointer<LatencyStatistics> getParent() const {
+            return this->parent;
+        }
+
+        /**
+         * Discards the values recorded here, the parent statistics are left untouched.
+         */
+        void reset();
+
+        /**
+         * @returns a one line summary of count, mean and percentiles per metric in microseconds.
+         */
+        std::string toString() const;
+
+        /**
+         * @returns the display name of the given metric.
+         */
+        static std::string getMetricName(Metric metric);
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_UTIL_LATENCYSTATISTICS_H_ */
@@ -26,7 +26,7 @@ namespace activemq {
 namespace util {
 
     class AMQCPP_API MemoryUsage : public Usage {
-    private:
+    protected:
 
         // The physical limit of memory usage this object allows.
         unsigned long long limit;
@@ -0,0 +1,224 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MessageArena.h"
+
+#include <decaf/internal/util/concurrent/ThreadLocalImpl.h>
+#include <decaf/lang/exceptions/IllegalStateException.h>
+
+#include <new>
+
+using namespace activemq;
+using namespace activemq::util;
+using namespace decaf;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::internal::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+const std::size_t MessageArena::BLOCK_SIZE = 64 * 1024;
+const std::size_t MessageArena::ALIGNMENT = 16;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    // Standard sized blocks kept by an idle arena, enough for a few frames of a
+    // typical size without the thread holding on to a burst of large messages.
+    const std::size_t RETAINED_BLOCKS = 4;
+
+    class ArenaThreadLocal : public ThreadLocalImpl {
+    private:
+
+        ArenaThreadLocal(const ArenaThreadLocal&);
+        ArenaThreadLocal& operator=(const ArenaThreadLocal&);
+
+    public:
+
+        ArenaThreadLocal() : ThreadLocalImpl() {}
+
+        virtual ~ArenaThreadLocal() {
+            try {
+                removeAll();
+            } catch (...) {
+            }
+        }
+
+        MessageArena* get() {
+            MessageArena* arena = static_cast<MessageArena*>(getRawValue());
+            if (arena == NULL) {
+                arena = new MessageArena();
+                setRawValue(arena);
+            }
+            return arena;
+        }
+
+        MessageArena* peek() const {
+            return static_cast<MessageArena*>(getRawValue());
+        }
+
+        virtual void doDelete(void* value) {
+            delete static_cast<MessageArena*>(value);
+        }
+    };
+
+    ArenaThreadLocal* arenas = NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MessageArena::Scope::Scope(bool enabled) : arena(NULL), block(0), offset(0) {
+
+    if (!enabled || arenas == NULL) {
+        return;
+    }
+
+    this->arena = arenas->get();
+    this->block = this->arena->block;
+    this->offset = this->arena->offset;
+    this->arena->depth++;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MessageArena::Scope::~Scope() {
+
+    if (this->arena != NULL) {
+        this->arena->rewind(this->block, this->offset);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MessageArena::MessageArena() : blocks(), block(0), offset(0), depth(0), allocations(0) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MessageArena::~MessageArena() {
+
+    std::vector<Block>::iterator iter = this->blocks.begin();
+    for (; iter != this->blocks.end(); ++iter) {
+        delete [] iter->memory;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MessageArena* MessageArena::current() {
+
+    if (arenas == NULL) {
+        return NULL;
+    }
+
+    MessageArena* arena = arenas->peek();
+    if (arena == NULL || arena->depth == 0) {
+        return NULL;
+    }
+
+    return arena;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void* MessageArena::allocate(std::size_t size) {
+
+    if (this->depth == 0) {
+        throw IllegalStateException(
+            __FILE__, __LINE__, "MessageArena::allocate - No scope is open on this arena.");
+    }
+
+    size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    if (size == 0) {
+        size = ALIGNMENT;
+    }
+
+    this->allocations++;
+
+    if (this->block < this->blocks.size() && this->blocks[this->block].size - this->offset >= size) {
+        void* result = this->blocks[this->block].memory + this->offset;
+        this->offset += size;
+        return result;
+    }
+
+    return allocateFromNextBlock(size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void* MessageArena::allocateFromNextBlock(std::size_t size) {
+
+    std::size_t next = this->blocks.empty() ? 0 : this->block + 1;
+
+    // Blocks past the current one are free, reuse the next one when it is big
+    // enough, otherwise slot a new one in ahead of it.
+    if (next >= this->blocks.size() || this->blocks[next].size < size) {
+        Block fresh;
+        fresh.size = size > BLOCK_SIZE ? size : BLOCK_SIZE;
+        fresh.memory = new unsigned char[fresh.size];
+        this->blocks.insert(this->blocks.begin() + next, fresh);
+    }
+
+    this->block = next;
+    this->offset = size;
+
+    return this->blocks[next].memory;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageArena::rewind(std::size_t block, std::size_t offset) {
+
+    this->block = block;
+    this->offset = offset;
+
+    if (--this->depth > 0) {
+        return;
+    }
+
+    // Nothing is in use once the outermost scope closes, so let go of oversized
+    // blocks and any extra standard ones that a burst of traffic left behind.
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < this->blocks.size(); ++i) {
+        if (this->blocks[i].size == BLOCK_SIZE && kept < RETAINED_BLOCKS) {
+            this->blocks[kept++] = this->blocks[i];
+        } else {
+            delete [] this->blocks[i].memory;
+        }
+    }
+
+    this->blocks.resize(kept);
+    this->block = 0;
+    this->offset = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::size_t MessageArena::getBytesInUse() const {
+
+    if (this->depth == 0 || this->blocks.empty()) {
+        return 0;
+    }
+
+    std::size_t result = this->offset;
+    for (std::size_t i = 0; i < this->block; ++i) {
+        result += this->blocks[i].size;
+    }
+
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageArena::initialize() {
+    arenas = new ArenaThreadLocal();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageArena::shutdown() {
+    delete arenas;
+    arenas = NULL;
+}
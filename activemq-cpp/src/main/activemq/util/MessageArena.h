@@ -0,0 +1,177 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_UTIL_MESSAGEARENA_H_
+#define _ACTIVEMQ_UTIL_MESSAGEARENA_H_
+
+#include <activemq/util/Config.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace activemq {
+namespace library {
+    class ActiveMQCPP;
+}
+namespace util {
+
+    /**
+     * A per-thread bump allocator for memory that only lives for one marshal or
+     * unmarshal of a command, such as frame buffers and encoding scratch space.
+     *
+     * Memory is handed out from large blocks by moving an offset and is never freed
+     * on its own.  A Scope records the offset when it is opened and moves it back when
+     * it is closed, so everything taken inside the scope is released at once and the
+     * blocks are reused by the next cycle.  Scopes nest, an inner scope only releases
+     * what was taken since it was opened.
+     *
+     * Use is opt-in: code that can take its scratch memory from the arena asks for
+     * current(), which is NULL unless the calling thread has a scope open, and falls
+     * back to the heap otherwise.  Memory taken from the arena must not be referenced
+     * once the scope it was taken in has closed, and objects with destructors must not
+     * be placed in it.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API MessageArena {
+    public:
+
+        /**
+         * Size of the blocks the arena carves allocations from.
+         */
+        static const std::size_t BLOCK_SIZE;
+
+        /**
+         * Alignment of every address returned from allocate.
+         */
+        static const std::size_t ALIGNMENT;
+
+        /**
+         * Opens a scope on the calling thread's arena for as long as it exists.  A scope
+         * that is created disabled, or while the library is not initialized, does nothing
+         * so callers can make the choice at runtime without branching.
+         */
+        class AMQCPP_API Scope {
+        private:
+
+            MessageArena* arena;
+            std::size_t block;
+            std::size_t offset;
+
+        private:
+
+            Scope(const Scope&);
+            Scope& operator=(const Scope&);
+
+        public:
+
+            Scope(bool enabled = true);
+
+            ~Scope();
+
+            /**
+             * @returns the arena this scope was opened on, or NULL if it is disabled.
+             */
+            MessageArena* getArena() const {
+                return this->arena;
+            }
+        };
+
+    private:
+
+        struct Block {
+            unsigned char* memory;
+            std::size_t size;
+        };
+
+        std::vector<Block> blocks;
+        std::size_t block;
+        std::size_t offset;
+        int depth;
+        long long allocations;
+
+    private:
+
+        MessageArena(const MessageArena&);
+        MessageArena& operator=(const MessageArena&);
+
+    public:
+
+        MessageArena();
+
+        virtual ~MessageArena();
+
+        /**
+         * @returns the calling thread's arena if a scope is open on it, otherwise NULL.
+         */
+        static MessageArena* current();
+
+        /**
+         * Takes size bytes from the arena, the memory is not initialized.
+         *
+         * @param size
+         *      The number of bytes needed.
+         *
+         * @returns a pointer aligned to ALIGNMENT that stays valid until the enclosing
+         *          scope is closed.
+         *
+         * @throw IllegalStateException if no scope is open on this arena.
+         */
+        void* allocate(std::size_t size);
+
+        /**
+         * @returns the number of allocations served since the arena was created.
+         */
+        long long getAllocationCount() const {
+            return this->allocations;
+        }
+
+        /**
+         * @returns the number of blocks currently held by the arena.
+         */
+        std::size_t getBlockCount() const {
+            return this->blocks.size();
+        }
+
+        /**
+         * @returns the number of bytes currently taken from the arena, including padding.
+         */
+        std::size_t getBytesInUse() const;
+
+        /**
+         * @returns true if a scope is open on this arena.
+         */
+        bool isActive() const {
+            return this->depth > 0;
+        }
+
+    private:
+
+        void rewind(std::size_t block, std::size_t offset);
+
+        void* allocateFromNextBlock(std::size_t size);
+
+        static void initialize();
+        static void shutdown();
+
+        friend class activemq::library::ActiveMQCPP;
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_UTIL_MESSAGEARENA_H_ */
@@ -0,0 +1,298 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ProducerWindow.h"
+
+#include <decaf/lang/System.h>
+
+using namespace activemq;
+using namespace activemq::util;
+using namespace decaf::lang;
+using namespace decaf::util;
+using namespace decaf::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+const long long ProducerWindow::MAXIMUM_PACING_DELAY = 100;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    // Acks seen over less than this many nanoseconds are folded into the next sample,
+    // a burst of acks released together says nothing about the drain rate.
+    const long long MINIMUM_SAMPLE_TIME = 10 * 1000000LL;
+
+    // Weight given to the newest sample in the drain rate estimate.
+    const double SAMPLE_WEIGHT = 0.25;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ProducerWindow::ProducerWindow(unsigned long long limit, bool adaptivePacing) :
+    MemoryUsage(limit), adaptivePacing(adaptivePacing), closed(false), drainRate(0), sampleStart(0), sampleBytes(0), nextSendTime(0),
+    peakUsage(0), ackCount(0), ackedBytes(0), blockedCount(0), blockedTime(0), pacedCount(0), pacedTime(0) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ProducerWindow::~ProducerWindow() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ProducerWindow::waitForSpace() {
+
+    synchronized(&mutex) {
+
+        long long start = System::nanoTime();
+        bool blocked = false;
+        bool paced = false;
+
+        while (!this->closed) {
+            if (this->usage >= this->limit) {
+                blocked = true;
+                mutex.wait();
+                continue;
+            }
+
+            long long remaining = this->nextSendTime - System::nanoTime();
+            if (this->nextSendTime != 0 && remaining > 0) {
+                paced = true;
+                mutex.wait(remaining / 1000000, (int) (remaining % 1000000));
+                continue;
+            }
+
+            break;
+        }
+
+        if (blocked) {
+            this->blockedCount++;
+            this->blockedTime += (System::nanoTime() - start) / 1000;
+        } else if (paced) {
+            this->pacedCount++;
+            this->pacedTime += (System::nanoTime() - start) / 1000;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ProducerWindow::waitForSpace(unsigned int timeout) {
+
+    synchronized(&mutex) {
+        if (!this->closed && this->usage >= this->limit) {
+            long long start = System::nanoTime();
+            mutex.wait(timeout);
+            this->blockedCount++;
+            this->blockedTime += (System::nanoTime() - start) / 1000;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ProducerWindow::increaseUsage(unsigned long long value) {
+
+    if (value == 0) {
+        return;
+    }
+
+    synchronized(&mutex) {
+        this->usage += value;
+
+        if (this->usage > this->peakUsage) {
+            this->peakUsage = this->usage;
+        }
+
+        long long now = System::nanoTime();
+
+        if (this->sampleStart == 0) {
+            this->sampleStart = now;
+        }
+
+        // Past half the window the sends are spaced at the rate the broker has been
+        // draining it, the lower half absorbs bursts without any delay.
+        if (this->adaptivePacing && this->drainRate > 0 && this->usage > this->limit / 2) {
+            long long base = this->nextSendTime > now ? this->nextSendTime : now;
+            long long next = base + (long long) ((double) value * 1e9 / this->drainRate);
+            long long latest = now + MAXIMUM_PACING_DELAY * 1000000;
+            this->nextSendTime = next < latest ? next : latest;
+        } else {
+            this->nextSendTime = 0;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ProducerWindow::decreaseUsage(unsigned long long value) {
+
+    if (value == 0) {
+        return;
+    }
+
+    synchronized(&mutex) {
+        value > this->usage ? this->usage = 0 : this->usage -= value;
+
+        this->ackCount++;
+        this->ackedBytes += value;
+
+        long long now = System::nanoTime();
+
+        if (this->sampleStart != 0) {
+            this->sampleBytes += value;
+
+            long long elapsed = now - this->sampleStart;
+            if (elapsed >= MINIMUM_SAMPLE_TIME) {
+                double rate = (double) this->sampleBytes * 1e9 / (double) elapsed;
+                this->drainRate = this->drainRate == 0 ? rate :
+                    this->drainRate * (1.0 - SAMPLE_WEIGHT) + rate * SAMPLE_WEIGHT;
+                this->sampleStart = now;
+                this->sampleBytes = 0;
+            }
+        }
+
+        // An empty window has nothing draining, the next sample starts with the next send
+        // so that idle time does not count against the rate.
+        if (this->usage == 0) {
+            this->sampleStart = 0;
+            this->sampleBytes = 0;
+        }
+
+        if (this->usage <= this->limit / 2) {
+            this->nextSendTime = 0;
+        }
+
+        mutex.notifyAll();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ProducerWindow::close() {
+
+    synchronized(&mutex) {
+        this->closed = true;
+        mutex.notifyAll();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ProducerWindow::isClosed() const {
+
+    bool result = false;
+    synchronized(&mutex) {
+        result = this->closed;
+    }
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ProducerWindow::reset() {
+
+    synchronized(&mutex) {
+        this->usage = 0;
+        this->nextSendTime = 0;
+        this->sampleStart = 0;
+        this->sampleBytes = 0;
+        mutex.notifyAll();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+double ProducerWindow::getDrainRate() const {
+
+    double result = 0;
+    synchronized(&mutex) {
+        result = this->drainRate;
+    }
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+double ProducerWindow::getUtilization() const {
+
+    double result = 0;
+    synchronized(&mutex) {
+        if (this->limit > 0) {
+            result = this->usage >= this->limit ? 1.0 : (double) this->usage / (double) this->limit;
+        }
+    }
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned long long ProducerWindow::getPeakUsage() const {
+
+    unsigned long long result = 0;
+    synchronized(&mutex) {
+        result = this->peakUsage;
+    }
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long ProducerWindow::getAckCount() const {
+
+    long long result = 0;
+    synchronized(&mutex) {
+        result = this->ackCount;
+    }
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned long long ProducerWindow::getAckedBytes() const {
+
+    unsigned long long result = 0;
+    synchronized(&mutex) {
+        result = this->ackedBytes;
+    }
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long ProducerWindow::getBlockedCount() const {
+
+    long long result = 0;
+    synchronized(&mutex) {
+        result = this->blockedCount;
+    }
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long ProducerWindow::getBlockedTime() const {
+
+    long long result = 0;
+    synchronized(&mutex) {
+        result = this->blockedTime;
+    }
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long ProducerWindow::getPacedCount() const {
+
+    long long result = 0;
+    synchronized(&mutex) {
+        result = this->pacedCount;
+    }
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long ProducerWindow::getPacedTime() const {
+
+    long long result = 0;
+    synchronized(&mutex) {
+        result = this->pacedTime;
+    }
+    return result;
+}
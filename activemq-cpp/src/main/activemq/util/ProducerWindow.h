@@ -0,0 +1,186 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_UTIL_PRODUCERWINDOW_H_
+#define _ACTIVEMQ_UTIL_PRODUCERWINDOW_H_
+
+#include <activemq/util/Config.h>
+#include <activemq/util/MemoryUsage.h>
+
+namespace activemq {
+namespace util {
+
+    /**
+     * The send window of a single producer, the bytes it has sent that the broker has not
+     * yet acknowledged with a ProducerAck.
+     *
+     * As a plain MemoryUsage the window lets the producer send until it is full and then
+     * blocks it until acks free space, so a throttling broker sees bursts followed by
+     * full stalls.  With adaptive pacing enabled the window estimates the rate at which
+     * the broker drains it from the ProducerAcks it receives.  Once more than half the
+     * window is in use each send is spaced out so that the producer sends at the drain
+     * rate, and the window only blocks outright if it fills regardless.
+     *
+     * A window that is closed releases any sender waiting on it and never blocks again,
+     * the owner is expected to check isClosed() once a wait returns.
+     *
+     * The window also records how full it runs and how long the producer spent waiting
+     * on it, whether pacing is enabled or not.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API ProducerWindow : public MemoryUsage {
+    public:
+
+        /**
+         * The longest time in milliseconds a single send is held back by pacing.
+         */
+        static const long long MAXIMUM_PACING_DELAY;
+
+    private:
+
+        bool adaptivePacing;
+        bool closed;
+
+        // Estimated drain rate in bytes per second, zero until the first sample.
+        double drainRate;
+        long long sampleStart;
+        unsigned long long sampleBytes;
+
+        // Time in nanoseconds before which the next send is held, zero when not pacing.
+        long long nextSendTime;
+
+        unsigned long long peakUsage;
+        long long ackCount;
+        unsigned long long ackedBytes;
+        long long blockedCount;
+        long long blockedTime;
+        long long pacedCount;
+        long long pacedTime;
+
+    private:
+
+        ProducerWindow(const ProducerWindow&);
+        ProducerWindow& operator=(const ProducerWindow&);
+
+    public:
+
+        /**
+         * Creates a window of the given size.
+         *
+         * @param limit
+         *      The size of the window in bytes.
+         * @param adaptivePacing
+         *      True if sends are paced to the broker's drain rate.
+         */
+        ProducerWindow(unsigned long long limit, bool adaptivePacing);
+
+        virtual ~ProducerWindow();
+
+        /**
+         * Waits until the window has space and, when pacing, until the time the next
+         * send is due.
+         */
+        virtual void waitForSpace();
+
+        virtual void waitForSpace(unsigned int timeout);
+
+        /**
+         * Records a send of value bytes.
+         */
+        virtual void increaseUsage(unsigned long long value);
+
+        /**
+         * Records a ProducerAck for value bytes, updating the drain rate estimate.
+         */
+        virtual void decreaseUsage(unsigned long long value);
+
+        /**
+         * Closes the window, waking any sender blocked on it.
+         */
+        void close();
+
+        /**
+         * @returns true if the window has been closed.
+         */
+        bool isClosed() const;
+
+        /**
+         * Empties the window and drops any pacing delay, waking blocked senders.  Used
+         * when the bytes outstanding will never be acknowledged, for example after the
+         * connection they were sent on has failed over.
+         */
+        void reset();
+
+        /**
+         * @returns true if sends are paced to the broker's drain rate.
+         */
+        bool isAdaptivePacing() const {
+            return this->adaptivePacing;
+        }
+
+        /**
+         * @returns the estimated rate in bytes per second at which the broker acknowledges
+         *          sends, zero until enough acks have been seen.
+         */
+        double getDrainRate() const;
+
+        /**
+         * @returns the fraction of the window currently in use, from 0.0 to 1.0.
+         */
+        double getUtilization() const;
+
+        /**
+         * @returns the most bytes that have been outstanding at once.
+         */
+        unsigned long long getPeakUsage() const;
+
+        /**
+         * @returns the number of ProducerAcks received.
+         */
+        long long getAckCount() const;
+
+        /**
+         * @returns the total bytes freed by ProducerAcks.
+         */
+        unsigned long long getAckedBytes() const;
+
+        /**
+         * @returns the number of sends that waited because the window was full.
+         */
+        long long getBlockedCount() const;
+
+        /**
+         * @returns the time in microseconds sends have spent waiting on a full window.
+         */
+        long long getBlockedTime() const;
+
+        /**
+         * @returns the number of sends that were held back to pace the producer.
+         */
+        long long getPacedCount() const;
+
+        /**
+         * @returns the time in microseconds sends have been held back by pacing.
+         */
+        long long getPacedTime() const;
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_UTIL_PRODUCERWINDOW_H_ */
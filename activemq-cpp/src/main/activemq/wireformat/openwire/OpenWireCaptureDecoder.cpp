@@ -0,0 +1,232 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "OpenWireCaptureDecoder.h"
+
+#include <activemq/commands/WireFormatInfo.h>
+#include <activemq/exceptions/ExceptionDefines.h>
+#include <activemq/wireformat/openwire/OpenWireFormat.h>
+#include <decaf/io/ByteArrayInputStream.h>
+#include <decaf/io/DataInputStream.h>
+#include <decaf/io/EOFException.h>
+#include <decaf/util/Properties.h>
+
+#include <map>
+#include <vector>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::io;
+using namespace activemq::commands;
+using namespace activemq::wireformat;
+using namespace activemq::wireformat::openwire;
+using namespace decaf::io;
+using namespace decaf::lang;
+using namespace decaf::util;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace activemq {
+namespace wireformat {
+namespace openwire {
+
+    class CaptureStream {
+    private:
+
+        CaptureStream(const CaptureStream&);
+        CaptureStream& operator=(const CaptureStream&);
+
+    public:
+
+        OpenWireFormat format;
+        Pointer<WireFormatInfo> inboundInfo;
+        std::vector<unsigned char> pending[2];
+        bool failed[2];
+
+        CaptureStream() : format(Properties()), inboundInfo() {
+            failed[0] = false;
+            failed[1] = false;
+        }
+    };
+
+    class OpenWireCaptureDecoderImpl {
+    private:
+
+        OpenWireCaptureDecoderImpl(const OpenWireCaptureDecoderImpl&);
+        OpenWireCaptureDecoderImpl& operator=(const OpenWireCaptureDecoderImpl&);
+
+    public:
+
+        std::map<int, CaptureStream*> streams;
+        int errors;
+
+        OpenWireCaptureDecoderImpl() : streams(), errors(0) {}
+
+        ~OpenWireCaptureDecoderImpl() {
+            clear();
+        }
+
+        void clear() {
+            std::map<int, CaptureStream*>::iterator iter = streams.begin();
+            for (; iter != streams.end(); ++iter) {
+                delete iter->second;
+            }
+            streams.clear();
+        }
+
+        CaptureStream* getStream(int streamId) {
+            std::map<int, CaptureStream*>::iterator iter = streams.find(streamId);
+            if (iter != streams.end()) {
+                return iter->second;
+            }
+
+            CaptureStream* stream = new CaptureStream();
+            streams[streamId] = stream;
+            return stream;
+        }
+
+        /**
+         * Decodes the next frame at the front of the pending bytes, returning NULL if
+         * the frame is not complete yet.
+         */
+        Pointer<Command> decodeFrame(CaptureStream* stream, std::vector<unsigned char>& pending, std::size_t& position) {
+
+            int available = (int) (pending.size() - position);
+            int length = available;
+
+            if (!stream->format.isSizePrefixDisabled()) {
+                if (available < 4) {
+                    return Pointer<Command>();
+                }
+
+                const unsigned char* prefix = &pending[position];
+                int size = (int) ((prefix[0] << 24) | (prefix[1] << 16) | (prefix[2] << 8) | prefix[3]);
+                if (size < 1) {
+                    throw IOException(__FILE__, __LINE__, "Invalid frame size: %d", size);
+                }
+
+                if (size > available - 4) {
+                    return Pointer<Command>();
+                }
+
+                length = size + 4;
+            }
+
+            ByteArrayInputStream bytes(&pending[position], available, 0, length);
+            DataInputStream dataIn(&bytes);
+
+            try {
+                Pointer<Command> command = stream->format.unmarshal(NULL, &dataIn);
+                position += (std::size_t) (length - bytes.available());
+                return command;
+            } catch (EOFException& ex) {
+                if (!stream->format.isSizePrefixDisabled()) {
+                    throw;
+                }
+            }
+
+            return Pointer<Command>();
+        }
+
+        /**
+         * Mirrors the negotiation of the live connection, the outbound info is the one
+         * this side preferred and the inbound one is what the peer asked for.
+         */
+        void negotiate(CaptureStream* stream, bool inbound, const Pointer<Command>& command) {
+
+            Pointer<WireFormatInfo> info = command.dynamicCast<WireFormatInfo>();
+
+            if (inbound) {
+                stream->inboundInfo = info;
+            } else {
+                stream->format.setPreferedWireFormatInfo(info);
+            }
+
+            if (stream->inboundInfo != NULL && stream->format.getPreferedWireFormatInfo() != NULL) {
+                stream->format.renegotiateWireFormat(*stream->inboundInfo);
+            }
+        }
+    };
+
+}}}
+
+////////////////////////////////////////////////////////////////////////////////
+OpenWireCaptureDecoder::OpenWireCaptureDecoder() : impl(new OpenWireCaptureDecoderImpl()) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+OpenWireCaptureDecoder::~OpenWireCaptureDecoder() {
+    try {
+        delete this->impl;
+    }
+    AMQ_CATCHALL_NOTHROW()
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int OpenWireCaptureDecoder::decode(const CaptureRecord& record, LinkedList< Pointer<Command> >& commands) {
+
+    CaptureStream* stream = this->impl->getStream(record.getStreamId());
+    bool inbound = record.isInbound();
+    int direction = inbound ? 0 : 1;
+
+    if (stream->failed[direction]) {
+        return 0;
+    }
+
+    std::vector<unsigned char>& pending = stream->pending[direction];
+    pending.insert(pending.end(), record.getData().begin(), record.getData().end());
+
+    int count = 0;
+    std::size_t position = 0;
+
+    try {
+
+        while (position < pending.size()) {
+
+            Pointer<Command> command = this->impl->decodeFrame(stream, pending, position);
+            if (command == NULL) {
+                break;
+            }
+
+            if (command->isWireFormatInfo()) {
+                this->impl->negotiate(stream, inbound, command);
+            }
+
+            commands.add(command);
+            count++;
+        }
+
+        pending.erase(pending.begin(), pending.begin() + (std::ptrdiff_t) position);
+
+    } catch (decaf::lang::Exception& ex) {
+        stream->failed[direction] = true;
+        pending.clear();
+        this->impl->errors++;
+    }
+
+    return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int OpenWireCaptureDecoder::getErrorCount() const {
+    return this->impl->errors;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireCaptureDecoder::reset() {
+    this->impl->clear();
+    this->impl->errors = 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_WIREFORMAT_OPENWIRE_OPENWIRECAPTUREDECODER_H_
+#define _ACTIVEMQ_WIREFORMAT_OPENWIRE_OPENWIRECAPTUREDECODER_H_
+
+#include <activemq/util/Config.h>
+#include <activemq/commands/Command.h>
+#include <activemq/io/CaptureRecord.h>
+#include <decaf/lang/Pointer.h>
+#include <decaf/util/LinkedList.h>
+
+namespace activemq {
+namespace wireformat {
+namespace openwire {
+
+    using decaf::lang::Pointer;
+
+    class OpenWireCaptureDecoderImpl;
+
+    /**
+     * Turns the records of a CaptureFile back into OpenWire commands.  Each captured
+     * stream gets its own OpenWireFormat, the bytes of each direction are gathered
+     * until a whole frame is present and the wire format is renegotiated once the
+     * WireFormatInfo of both sides has been seen, just as the live connection did.
+     *
+     * A stream whose first bytes were lost when the capture wrapped cannot be framed,
+     * the direction that fails to decode is counted as an error and skipped from then
+     * on.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API OpenWireCaptureDecoder {
+    private:
+
+        OpenWireCaptureDecoderImpl* impl;
+
+    private:
+
+        OpenWireCaptureDecoder(const OpenWireCaptureDecoder&);
+        OpenWireCaptureDecoder& operator=(const OpenWireCaptureDecoder&);
+
+    public:
+
+        OpenWireCaptureDecoder();
+
+        virtual ~OpenWireCaptureDecoder();
+
+        /**
+         * Adds the bytes of a record to its stream and decodes the commands they
+         * complete.
+         *
+         * @param record
+         *      The next record read from the capture.
+         * @param commands
+         *      The list the decoded commands are appended to, in the order they were
+         *      sent or received.
+         *
+         * @returns the number of commands that were decoded.
+         */
+        int decode(const activemq::io::CaptureRecord& record,
+                   decaf::util::LinkedList< Pointer<commands::Command> >& commands);
+
+        /**
+         * @returns the number of stream directions that failed to decode.
+         */
+        int getErrorCount() const;
+
+        /**
+         * Forgets all streams seen so far.
+         */
+        void reset();
+
+    };
+
+}}}
+
+#endif /* _ACTIVEMQ_WIREFORMAT_OPENWIRE_OPENWIRECAPTUREDECODER_H_ */
@@ -23,11 +23,18 @@
 #include <decaf/util/UUID.h>
 #include <decaf/lang/Math.h>
 #include <decaf/io/ByteArrayOutputStream.h>
+#include <decaf/lang/ArrayPointer.h>
+#include <decaf/internal/nio/DirectMemoryPool.h>
 #include <activemq/wireformat/openwire/OpenWireFormatNegotiator.h>
 #include <activemq/wireformat/openwire/utils/BooleanStream.h>
+#include <activemq/wireformat/openwire/utils/DirectDataInputStream.h>
+#include <activemq/wireformat/openwire/utils/DirectDataOutputStream.h>
 #include <activemq/wireformat/MarshalAware.h>
 #include <activemq/commands/WireFormatInfo.h>
 #include <activemq/commands/DataStructure.h>
+#include <activemq/commands/ActiveMQBytesMessage.h>
+#include <activemq/io/FileRegionDataOutputStream.h>
+#include <activemq/util/MessageArena.h>
 #include <activemq/wireformat/openwire/marshal/DataStreamMarshaller.h>
 #include <activemq/wireformat/openwire/marshal/generated/MarshallerFactory.h>
 #include <activemq/exceptions/ActiveMQException.h>
@@ -36,6 +43,7 @@ using namespace std;
 using namespace activemq;
 using namespace activemq::util;
 using namespace activemq::commands;
+using namespace activemq::io;
 using namespace activemq::transport;
 using namespace activemq::exceptions;
 using namespace activemq::wireformat;
@@ -46,18 +54,162 @@ using namespace decaf::io;
 using namespace decaf::util;
 using namespace decaf::lang;
 using namespace decaf::lang::exceptions;
+using namespace decaf::internal::nio;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    /**
+     * Holds the memory for one frame, taken from the direct memory pool so that the
+     * blocks of similarly sized frames are reused instead of allocated for each one.
+     */
+    class PooledFrame {
+    private:
+
+        unsigned char* block;
+        int size;
+
+    private:
+
+        PooledFrame(const PooledFrame&);
+        PooledFrame& operator=(const PooledFrame&);
+
+    public:
+
+        PooledFrame(int size) : block(DirectMemoryPool::allocate(size)), size(size) {
+        }
+
+        ~PooledFrame() {
+            DirectMemoryPool::release(this->block, this->size);
+        }
+
+        unsigned char* get() const {
+            return this->block;
+        }
+    };
+
+    /**
+     * Buffers a frame and notes the offset at which a given array is written into it.
+     */
+    class ContentLocatingOutputStream : public DataOutputStream {
+    private:
+
+        ByteArrayOutputStream* buffer;
+        const unsigned char* content;
+        int contentOffset;
+
+    private:
+
+        ContentLocatingOutputStream(const ContentLocatingOutputStream&);
+        ContentLocatingOutputStream& operator=(const ContentLocatingOutputStream&);
+
+    public:
+
+        ContentLocatingOutputStream(ByteArrayOutputStream* buffer, const unsigned char* content) :
+            DataOutputStream(buffer, true), buffer(buffer), content(content), contentOffset(-1) {
+        }
+
+        virtual ~ContentLocatingOutputStream() {}
+
+        int getContentOffset() const {
+            return this->contentOffset;
+        }
+
+    protected:
+
+        virtual void doWriteArrayBounded(const unsigned char* array, int size, int offset, int length) {
+            if (array == this->content && this->contentOffset < 0) {
+                this->contentOffset = (int) this->buffer->size();
+            }
+            DataOutputStream::doWriteArrayBounded(array, size, offset, length);
+        }
+    };
+
+    void appendInt(std::vector<unsigned char>& bytes, int value) {
+        bytes.push_back((unsigned char) ((unsigned int) value >> 24));
+        bytes.push_back((unsigned char) ((unsigned int) value >> 16));
+        bytes.push_back((unsigned char) ((unsigned int) value >> 8));
+        bytes.push_back((unsigned char) value);
+    }
+
+    /**
+     * Writes a BytesMessage whose body is a file region with the body going from the
+     * file to the socket.  The message is marshaled with a single stand-in byte as its
+     * content, the generated marshaller writes the content length and that byte where
+     * the file data belongs and the frame is split around it into a header and trailer.
+     */
+    void marshalFileBody(OpenWireFormat* format, DataStreamMarshaller* dsm, ActiveMQBytesMessage* message,
+                         FileRegionDataOutputStream* dataOut) {
+
+        Pointer<FileRegion> region = message->getBodyFile();
+
+        ByteArrayOutputStream* buffer = new ByteArrayOutputStream();
+        message->getContent().assign(1, 0);
+        ContentLocatingOutputStream frameOut(buffer, &message->getContent()[0]);
+
+        try {
+            frameOut.writeByte(message->getDataStructureType());
+
+            if (format->isTightEncodingEnabled()) {
+                BooleanStream bs;
+                dsm->tightMarshal1(format, message, &bs);
+                bs.marshal(&frameOut);
+                dsm->tightMarshal2(format, message, &frameOut, &bs);
+            } else {
+                dsm->looseMarshal(format, message, &frameOut);
+            }
+        } catch (...) {
+            message->getContent().clear();
+            throw;
+        }
+
+        message->getContent().clear();
+
+        int contentOffset = frameOut.getContentOffset();
+        if (contentOffset < 4) {
+            throw IOException(__FILE__, __LINE__,
+                "OpenWireFormat::marshal - Message content was not written to the frame");
+        }
+
+        std::pair<unsigned char*, int> frame = buffer->toByteArray();
+        ArrayPointer<unsigned char> bytes(frame.first, frame.second);
+
+        if (region->getLength() > Integer::MAX_VALUE - frame.second) {
+            throw IOException(__FILE__, __LINE__,
+                "OpenWireFormat::marshal - Message body of %d bytes is too large for a frame", region->getLength());
+        }
+
+        // The header ends with the real content length in place of the stand-in's.
+        std::vector<unsigned char> header;
+        header.reserve(contentOffset + 4);
+
+        if (!format->isSizePrefixDisabled()) {
+            appendInt(header, frame.second - 1 + region->getLength());
+        }
+
+        header.insert(header.end(), bytes.get(), bytes.get() + contentOffset - 4);
+        appendInt(header, region->getLength());
+
+        dataOut->writeFileRegion(&header[0], (int) header.size(), *region,
+                                 bytes.get() + contentOffset + 1, frame.second - contentOffset - 1);
+    }
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 const unsigned char OpenWireFormat::NULL_TYPE = 0;
 const int OpenWireFormat::DEFAULT_VERSION = 1;
 const int OpenWireFormat::MAX_SUPPORTED_VERSION = 9;
+const long long OpenWireFormat::DEFAULT_MAX_FRAME_SIZE = 100 * 1024 * 1024;
+const int OpenWireFormat::MAX_BUFFERED_FRAME_SIZE = 8192;
+const int OpenWireFormat::ARENA_LOOSE_FRAME_SIZE = 32 * 1024;
 
 ////////////////////////////////////////////////////////////////////////////////
 OpenWireFormat::OpenWireFormat(const decaf::util::Properties& properties) :
     properties(properties), preferedWireFormatInfo(), dataMarshallers(256),
     id(UUID::randomUUID().toString()), receiving(), version(0), stackTraceEnabled(true),
     tcpNoDelayEnabled(true), cacheEnabled(true), cacheSize(1024), tightEncodingEnabled(false),
-    sizePrefixDisabled(false), maxInactivityDuration(30000), maxInactivityDurationInitialDelay(10000) {
+    sizePrefixDisabled(false), maxInactivityDuration(30000), maxInactivityDurationInitialDelay(10000),
+    maxFrameSize(DEFAULT_MAX_FRAME_SIZE), messageArenaEnabled(false) {
 
     // initialize the universal marshalers, don't need to reset them again
     // after this so its safe to do this here.
@@ -146,6 +298,8 @@ void OpenWireFormat::marshal(const Pointer<commands::Command> command, const act
 
         int size = 1;
 
+        MessageArena::Scope scope(this->messageArenaEnabled);
+
         if (command != NULL) {
 
             DataStructure* dataStructure = dynamic_cast<DataStructure*>(command.get());
@@ -158,18 +312,73 @@ void OpenWireFormat::marshal(const Pointer<commands::Command> command, const act
                 throw IOException(__FILE__, __LINE__, (string("OpenWireFormat::marshal - Unknown data type: ") + Integer::toString(type)).c_str());
             }
 
+            // A BytesMessage body held in a file is sent from the file when the stream
+            // writes to a plain socket, any other stream gets it read into the message.
+            if (type == ActiveMQBytesMessage::ID_ACTIVEMQBYTESMESSAGE) {
+                ActiveMQBytesMessage* bytesMessage = dynamic_cast<ActiveMQBytesMessage*>(dataStructure);
+
+                if (bytesMessage != NULL && bytesMessage->getBodyFile() != NULL) {
+                    FileRegionDataOutputStream* regionOut = dynamic_cast<FileRegionDataOutputStream*>(dataOut);
+
+                    if (regionOut != NULL) {
+                        marshalFileBody(this, dsm, bytesMessage, regionOut);
+                        return;
+                    }
+
+                    bytesMessage->loadBodyFile();
+                }
+            }
+
             if (tightEncodingEnabled) {
                 BooleanStream bs;
                 size += dsm->tightMarshal1(this, dataStructure, &bs);
                 size += bs.marshalledSize();
 
+                int frameSize = sizePrefixDisabled ? size : size + 4;
+
+                // A large frame is already bigger than the transport's output buffer,
+                // building it in memory would only add an allocation and a copy.
+                if (frameSize > MAX_BUFFERED_FRAME_SIZE) {
+
+                    if (!sizePrefixDisabled) {
+                        dataOut->writeInt(size);
+                    }
+
+                    dataOut->writeByte(type);
+                    bs.marshal(dataOut);
+                    dsm->tightMarshal2(this, dataStructure, dataOut, &bs);
+                    return;
+                }
+
+                // The size is exact so the frame is encoded into memory and handed
+                // to the transport in a single write.
+                std::auto_ptr<PooledFrame> pooledFrame;
+                unsigned char* frame = NULL;
+
+                if (scope.getArena() != NULL) {
+                    frame = static_cast<unsigned char*>(scope.getArena()->allocate(frameSize));
+                } else {
+                    pooledFrame.reset(new PooledFrame(frameSize));
+                    frame = pooledFrame->get();
+                }
+
+                DirectDataOutputStream frameOut(frame, frameSize);
+
                 if (!sizePrefixDisabled) {
-                    dataOut->writeInt(size);
+                    frameOut.writeInt(size);
+                }
+
+                frameOut.writeByte(type);
+                bs.marshal(&frameOut);
+                dsm->tightMarshal2(this, dataStructure, &frameOut, &bs);
+
+                if (frameOut.getPosition() != frameSize) {
+                    throw IOException(__FILE__, __LINE__,
+                        "OpenWireFormat::marshal - Marshalled %d bytes for a frame of %d bytes",
+                        frameOut.getPosition(), frameSize);
                 }
 
-                dataOut->writeByte(type);
-                bs.marshal(dataOut);
-                dsm->tightMarshal2(this, dataStructure, dataOut, &bs);
+                dataOut->write(frame, frameSize);
 
             } else {
 
@@ -178,6 +387,35 @@ void OpenWireFormat::marshal(const Pointer<commands::Command> command, const act
                     dsm->looseMarshal(this, dataStructure, dataOut);
                 } else {
 
+                    // Within an arena scope the frame is encoded into arena memory after
+                    // room for its size, a frame that doesn't fit is encoded again on the
+                    // heap.  Loose marshaling keeps no state so the retry is safe.
+                    if (scope.getArena() != NULL) {
+                        unsigned char* frame = static_cast<unsigned char*>(
+                            scope.getArena()->allocate(ARENA_LOOSE_FRAME_SIZE));
+
+                        int length = -1;
+
+                        try {
+                            DirectDataOutputStream frameOut(frame + 4, ARENA_LOOSE_FRAME_SIZE - 4);
+                            frameOut.writeByte(type);
+                            dsm->looseMarshal(this, dataStructure, &frameOut);
+                            length = frameOut.getPosition();
+                        } catch (IOException& ex) {
+                            // Too large for the arena frame, fall through to the heap.
+                        }
+
+                        if (length >= 0) {
+                            frame[0] = (unsigned char) ((unsigned int) length >> 24);
+                            frame[1] = (unsigned char) ((unsigned int) length >> 16);
+                            frame[2] = (unsigned char) ((unsigned int) length >> 8);
+                            frame[3] = (unsigned char) length;
+
+                            dataOut->write(frame, length + 4);
+                            return;
+                        }
+                    }
+
                     ByteArrayOutputStream* baos = new ByteArrayOutputStream();
                     std::auto_ptr<DataOutputStream> looseOut(new DataOutputStream(baos, true));
 
@@ -222,12 +460,47 @@ Pointer<commands::Command> OpenWireFormat::unmarshal(const activemq::transport::
             throw decaf::io::IOException(__FILE__, __LINE__, "DataInputStream passed is NULL");
         }
 
+        Pointer<DataStructure> data;
+
         if (!sizePrefixDisabled) {
-            dis->readInt();
-        }
+            int size = dis->readInt();
+            if (size < 1) {
+                throw IOException(__FILE__, __LINE__,
+                    "OpenWireFormat::unmarshal - Invalid frame size: %d", size);
+            }
+
+            // The size comes off the wire, check it before allocating the frame.
+            if (size > this->maxFrameSize) {
+                throw IOException(__FILE__, __LINE__,
+                    "OpenWireFormat::unmarshal - Frame size of %d bytes is larger than the max allowed %lld bytes",
+                    size, this->maxFrameSize);
+            }
+
+            // Read the rest of the frame in one call and decode it from memory.
+            MessageArena::Scope scope(this->messageArenaEnabled);
+            std::auto_ptr<PooledFrame> pooledFrame;
+            unsigned char* frame = NULL;
+
+            if (scope.getArena() != NULL) {
+                frame = static_cast<unsigned char*>(scope.getArena()->allocate(size));
+            } else {
+                pooledFrame.reset(new PooledFrame(size));
+                frame = pooledFrame->get();
+            }
+
+            this->receiving.set(true);
+            try {
+                dis->readFully(frame, size);
+            } catch (...) {
+                this->receiving.set(false);
+                throw;
+            }
 
-        // Get the unmarshalled DataStructure
-        Pointer<DataStructure> data(doUnmarshal(dis));
+            DirectDataInputStream frameIn(frame, size);
+            data.reset(doUnmarshal(&frameIn));
+        } else {
+            data.reset(doUnmarshal(dis));
+        }
 
         if (data == NULL) {
             throw IOException(__FILE__, __LINE__, "OpenWireFormat::doUnmarshal - "
@@ -52,6 +52,19 @@ namespace marshal {
         // Defines the maximum supported openwire version
         static const int MAX_SUPPORTED_VERSION;
 
+        // Largest tight encoded frame built in memory before the write, larger ones
+        // are streamed so their body isn't copied an extra time.
+        static const int MAX_BUFFERED_FRAME_SIZE;
+
+        // Arena memory a loose encoded frame is built in, larger frames use the heap.
+        // Half an arena block so the frame shares a block with the other scratch space.
+        static const int ARENA_LOOSE_FRAME_SIZE;
+
+    public:
+
+        // Largest frame accepted from the broker unless configured otherwise.
+        static const long long DEFAULT_MAX_FRAME_SIZE;
+
     private:
 
         // Configuration parameters
@@ -80,6 +93,12 @@ namespace marshal {
         long long maxInactivityDuration;
         long long maxInactivityDurationInitialDelay;
 
+        // Largest size prefixed frame accepted from the broker
+        long long maxFrameSize;
+
+        // Take transient marshaling memory from the thread's MessageArena
+        bool messageArenaEnabled;
+
     public:
 
         /**
@@ -357,6 +376,44 @@ namespace marshal {
             this->maxInactivityDurationInitialDelay = value;
         }
 
+        /**
+         * Gets the largest frame, in bytes, that unmarshal will accept from the broker.
+         * @return the maximum frame size in bytes.
+         */
+        long long getMaxFrameSize() const {
+            return this->maxFrameSize;
+        }
+
+        /**
+         * Sets the largest frame, in bytes, that unmarshal will accept from the broker.  A
+         * frame whose size prefix is larger is rejected with an IOException before any
+         * memory is allocated for it.  This is a local setting and is not negotiated with
+         * the broker.
+         * @param value - the maximum frame size in bytes.
+         */
+        void setMaxFrameSize(long long value) {
+            this->maxFrameSize = value;
+        }
+
+        /**
+         * Checks if frames and other memory that only lives for one marshal or unmarshal
+         * are taken from the calling thread's MessageArena instead of the heap.
+         * @return true if the message arena is used.
+         */
+        bool isMessageArenaEnabled() const {
+            return this->messageArenaEnabled;
+        }
+
+        /**
+         * Sets if frames and other memory that only lives for one marshal or unmarshal
+         * are taken from the calling thread's MessageArena instead of the heap.  This
+         * is a local setting and is not negotiated with the broker.
+         * @param value - true to use the message arena.
+         */
+        void setMessageArenaEnabled(bool value) {
+            this->messageArenaEnabled = value;
+        }
+
     protected:
 
         /**
@@ -65,6 +65,12 @@ Pointer<WireFormat> OpenWireFormatFactory::createWireFormat(const decaf::util::P
         // Create the Openwire Format Object
         Pointer<OpenWireFormat> wireFormat(new OpenWireFormat(properties));
 
+        wireFormat->setMessageArenaEnabled(
+            Boolean::parseBoolean(properties.getProperty("wireFormat.messageArenaEnabled", "false")));
+        wireFormat->setMaxFrameSize(
+            Long::parseLong(properties.getProperty("wireFormat.maxFrameSize",
+                Long::toString(OpenWireFormat::DEFAULT_MAX_FRAME_SIZE))));
+
         // give the format object the ownership
         wireFormat->setPreferedWireFormatInfo(info);
 
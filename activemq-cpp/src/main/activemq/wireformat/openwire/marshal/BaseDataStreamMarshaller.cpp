@@ -27,6 +27,7 @@
 #include <decaf/lang/Long.h>
 #include <decaf/lang/Integer.h>
 #include <decaf/lang/Pointer.h>
+#include <decaf/internal/util/ModifiedUTF8.h>
 #include <activemq/util/Config.h>
 
 using namespace std;
@@ -41,6 +42,7 @@ using namespace activemq::wireformat::openwire::utils;
 using namespace decaf::io;
 using namespace decaf::util;
 using namespace decaf::lang;
+using decaf::internal::util::ModifiedUTF8;
 
 ////////////////////////////////////////////////////////////////////////////////
 utils::HexTable BaseDataStreamMarshaller::hexTable;
@@ -174,24 +176,8 @@ int BaseDataStreamMarshaller::tightMarshalString1(const std::string& value, util
         bs->writeBoolean(value != "");
         if (value != "") {
             size_t strlen = value.length();
-
-            int utflen = 0;
-            int c = 0;
-            bool isOnlyAscii = true;
-
-            for (size_t i = 0; i < strlen; ++i) {
-
-                c = value[i];
-                if ((c >= 0x0001) && (c <= 0x007F)) { // ASCII char
-                    utflen++;
-                } else if (c > 0x07FF) {
-                    utflen += 3;
-                    isOnlyAscii = false;
-                } else {
-                    isOnlyAscii = false;
-                    utflen += 2;
-                }
-            }
+            size_t utflen = ModifiedUTF8::encodedLength(value.c_str(), strlen);
+            bool isOnlyAscii = utflen == strlen;
 
             if (utflen >= 0x10000) {
                 throw IOException(__FILE__, __LINE__, "BaseDataStreamMarshaller::tightMarshalString1 - "
@@ -200,7 +186,7 @@ int BaseDataStreamMarshaller::tightMarshalString1(const std::string& value, util
 
             bs->writeBoolean(isOnlyAscii);
 
-            return utflen + 2;
+            return (int) utflen + 2;
         } else {
             return 0;
         }
@@ -696,12 +682,8 @@ std::string BaseDataStreamMarshaller::readAsciiString(decaf::io::DataInputStream
         int size = dataIn->readShort();
 
         if (size > 0) {
-
-            std::vector<char> data(size);
-            dataIn->readFully((unsigned char*) &data[0], size);
-
-            // Now build a string and copy data into it.
-            text.insert(text.begin(), data.begin(), data.end());
+            text.resize(size);
+            dataIn->readFully((unsigned char*) &text[0], size);
         }
 
         return text;
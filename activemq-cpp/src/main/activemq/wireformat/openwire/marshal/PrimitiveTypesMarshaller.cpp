@@ -22,6 +22,8 @@
 #include <decaf/io/DataInputStream.h>
 #include <decaf/io/DataOutputStream.h>
 #include <activemq/exceptions/ActiveMQException.h>
+#include <activemq/util/MessageArena.h>
+#include <activemq/wireformat/openwire/utils/DirectDataOutputStream.h>
 #include <decaf/lang/Short.h>
 
 #include <memory>
@@ -33,16 +35,41 @@ using namespace activemq::exceptions;
 using namespace activemq::wireformat;
 using namespace activemq::wireformat::openwire;
 using namespace activemq::wireformat::openwire::marshal;
+using namespace activemq::wireformat::openwire::utils;
 using namespace decaf;
 using namespace decaf::io;
 using namespace decaf::lang;
 using namespace decaf::util;
 
+///////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    // Scratch space taken from the MessageArena for encoding a map or list, those
+    // that don't fit are encoded on the heap instead.
+    const int ARENA_SCRATCH_SIZE = 16 * 1024;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void PrimitiveTypesMarshaller::marshal( const PrimitiveMap* map, std::vector<unsigned char>& buffer ) {
 
     try {
 
+        // Within a marshal cycle that uses the arena the map is encoded into scratch
+        // memory that is released with the cycle, and only the result is copied out.
+        MessageArena* arena = MessageArena::current();
+        if( arena != NULL && map != NULL ) {
+            unsigned char* scratch = static_cast<unsigned char*>( arena->allocate( ARENA_SCRATCH_SIZE ) );
+
+            try {
+                DirectDataOutputStream dataOut( scratch, ARENA_SCRATCH_SIZE );
+                PrimitiveTypesMarshaller::marshalPrimitiveMap( dataOut, *map );
+                buffer.insert( buffer.begin(), scratch, scratch + dataOut.getPosition() );
+                return;
+            } catch( IOException& ) {
+                // Too large for the scratch space, fall through to the heap encoding.
+            }
+        }
+
         ByteArrayOutputStream bytesOut;
         DataOutputStream dataOut( &bytesOut );
 
@@ -87,6 +114,21 @@ void PrimitiveTypesMarshaller::marshal( const PrimitiveList* list, std::vector<u
 
     try {
 
+        // Encoded into arena scratch memory the same way as a map.
+        MessageArena* arena = MessageArena::current();
+        if( arena != NULL && list != NULL ) {
+            unsigned char* scratch = static_cast<unsigned char*>( arena->allocate( ARENA_SCRATCH_SIZE ) );
+
+            try {
+                DirectDataOutputStream dataOut( scratch, ARENA_SCRATCH_SIZE );
+                PrimitiveTypesMarshaller::marshalPrimitiveList( dataOut, *list );
+                buffer.insert( buffer.begin(), scratch, scratch + dataOut.getPosition() );
+                return;
+            } catch( IOException& ) {
+                // Too large for the scratch space, fall through to the heap encoding.
+            }
+        }
+
         ByteArrayOutputStream bytesOut;
         DataOutputStream dataOut( &bytesOut );
 
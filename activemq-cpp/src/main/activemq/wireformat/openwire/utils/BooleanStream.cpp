@@ -18,10 +18,14 @@
 #include <activemq/wireformat/openwire/utils/BooleanStream.h>
 
 #include <activemq/exceptions/ActiveMQException.h>
+#include <activemq/util/MessageArena.h>
+
+#include <algorithm>
 
 using namespace std;
 using namespace activemq;
 using namespace activemq::exceptions;
+using namespace activemq::util;
 using namespace activemq::wireformat;
 using namespace activemq::wireformat::openwire;
 using namespace activemq::wireformat::openwire::utils;
@@ -30,10 +34,16 @@ using namespace decaf::lang;
 using namespace decaf::lang::exceptions;
 
 ///////////////////////////////////////////////////////////////////////////////
-BooleanStream::BooleanStream() : data(), arrayLimit(0), arrayPos(0), bytePos(0) {
+namespace {
 
-    // Reserve 1K
-    this->data.resize( 1000, 0 );
+    // The largest size the three byte size field can carry.
+    const int MAX_ARRAY_LIMIT = 32767;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+BooleanStream::BooleanStream() : overflow(), data( inlineData + MAX_HEADER_SIZE ), capacity( INLINE_SIZE ),
+                                 arrayLimit( 0 ), writeWord( 0 ), writePos( 0 ),
+                                 readWord( 0 ), readPos( 0 ), readLimit( 0 ) {
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -41,18 +51,13 @@ BooleanStream::~BooleanStream() {
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-bool BooleanStream::readBoolean() {
+void BooleanStream::marshal( DataOutputStream* dataOut ) {
 
     try {
 
-        unsigned char b = data[arrayPos];
-        bool rc = ( ( b >> bytePos ) & 0x01 ) != 0;
-        bytePos++;
-        if( bytePos >= 8 ) {
-            bytePos = 0;
-            arrayPos++;
-        }
-        return rc;
+        clear();
+        unsigned char* header = encodeHeader();
+        dataOut->write( header, marshalledSize() );
     }
     AMQ_CATCH_RETHROW( IOException )
     AMQ_CATCH_EXCEPTION_CONVERT( Exception, IOException )
@@ -60,30 +65,13 @@ bool BooleanStream::readBoolean() {
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-void BooleanStream::writeBoolean( bool value ) {
+void BooleanStream::marshal( std::vector< unsigned char >& dataOut ) {
 
     try{
 
-        if( bytePos == 0 ) {
-            arrayLimit++;
-
-            if( (size_t)arrayLimit >= data.size() ) {
-                // re-grow the array if necessary
-                data.resize( data.size() * 2 );
-            }
-        }
-
-        if( value ) {
-            data[arrayPos] |= (unsigned char)( 0x01 << bytePos );
-        }
-
-        bytePos++;
-
-        // Wrap around when we hit the next byte
-        if( bytePos >= 8 ) {
-            bytePos=0;
-            arrayPos++;
-        }
+        finishWriting();
+        unsigned char* header = encodeHeader();
+        dataOut.insert( dataOut.end(), header, header + marshalledSize() );
     }
     AMQ_CATCH_RETHROW( IOException )
     AMQ_CATCH_EXCEPTION_CONVERT( Exception, IOException )
@@ -91,22 +79,34 @@ void BooleanStream::writeBoolean( bool value ) {
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-void BooleanStream::marshal( DataOutputStream* dataOut ) {
+void BooleanStream::unmarshal( DataInputStream* dataIn ) {
 
-    try {
+    try{
+
+        int limit = dataIn->readByte() & 0xFF;
 
-        if( arrayLimit < 64 ) {
-            dataOut->writeByte( (unsigned char)arrayLimit );
-        } else if( arrayLimit < 256 ) { // max value of unsigned char
-            dataOut->writeByte( 0xC0 );
-            dataOut->writeByte( (unsigned char)arrayLimit );
-        } else {
-            dataOut->writeByte( 0x80 );
-            dataOut->writeShort( arrayLimit );
+        if( limit == 0xC0 ) {
+            limit = dataIn->readByte() & 0xFF;
+        } else if( limit == 0x80 ) {
+            limit = dataIn->readShort();
+        }
+
+        if( limit < 0 ) {
+            throw IOException(
+                __FILE__, __LINE__, "BooleanStream::unmarshal - Invalid size: %d", limit );
+        }
+
+        ensureCapacity( limit );
+        this->arrayLimit = limit;
+        this->readLimit = limit * 8;
+        this->writeWord = 0;
+        this->writePos = 0;
+
+        // Make sure we get all the data we are expecting
+        if( limit > 0 ) {
+            dataIn->readFully( this->data, limit );
         }
 
-        // Dump the payload
-        dataOut->write( &data[0], (int)data.size(), 0, arrayLimit );
         clear();
     }
     AMQ_CATCH_RETHROW( IOException )
@@ -115,70 +115,133 @@ void BooleanStream::marshal( DataOutputStream* dataOut ) {
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-void BooleanStream::marshal( std::vector< unsigned char >& dataOut ) {
+void BooleanStream::clear() {
+    finishWriting();
+    this->readPos = 0;
+}
 
-    try{
+///////////////////////////////////////////////////////////////////////////////
+unsigned char* BooleanStream::encodeHeader() {
+
+    // Only called after finishWriting so arrayLimit covers every boolean.
+    if( this->arrayLimit < 64 ) {
+        this->data[-1] = (unsigned char) this->arrayLimit;
+        return this->data - 1;
+    } else if( this->arrayLimit < 256 ) { // max value of unsigned char
+        this->data[-2] = 0xC0;
+        this->data[-1] = (unsigned char) this->arrayLimit;
+        return this->data - 2;
+    }
+
+    this->data[-3] = 0x80;
+    this->data[-2] = (unsigned char)( this->arrayLimit >> 8 );
+    this->data[-1] = (unsigned char)( this->arrayLimit & 0xFF );
+    return this->data - 3;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void BooleanStream::finishWriting() {
 
-        if( arrayLimit < 64 ) {
-            dataOut.push_back( ( unsigned char ) arrayLimit );
-        } else if( arrayLimit < 256 ) { // max value of unsigned byte
-            dataOut.push_back( ( unsigned char ) 0xC0 );
-            dataOut.push_back( ( unsigned char ) arrayLimit );
-        } else {
-            dataOut.push_back( ( unsigned char ) 0x80 );
-            dataOut.push_back( ( unsigned char )( arrayLimit >> 8 ) );   // High Byte
-            dataOut.push_back( ( unsigned char )( arrayLimit & 0xFF ) ); // Low Byte
+    int bits = this->writePos & 31;
+    if( bits != 0 ) {
+        int offset = ( this->writePos >> 3 ) & ~3;
+        int length = ( bits + 7 ) >> 3;
+
+        ensureCapacity( offset + length );
+        for( int i = 0; i < length; ++i ) {
+            this->data[offset + i] = (unsigned char)( this->writeWord >> ( i * 8 ) );
         }
+    }
 
-        // Insert all data from data into the passed buffer
-        dataOut.insert( dataOut.end(), &data[0], &data[arrayLimit-1] );
+    if( this->writePos > 0 ) {
+        this->arrayLimit = ( this->writePos + 7 ) >> 3;
+        this->readLimit = this->arrayLimit * 8;
     }
-    AMQ_CATCH_RETHROW( IOException )
-    AMQ_CATCH_EXCEPTION_CONVERT( Exception, IOException )
-    AMQ_CATCHALL_THROW( IOException )
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-void BooleanStream::unmarshal( DataInputStream* dataIn ) {
+void BooleanStream::storeWord() {
 
-    try{
+    // Called once writePos reaches a multiple of 32, the word fills the four
+    // bytes before it in the order the encoding numbers the bits.
+    int offset = ( this->writePos >> 3 ) - 4;
 
-        arrayLimit = (short)( dataIn->readByte() & 0xFF );
+    if( offset + 4 > this->capacity ) {
+        grow();
+    }
 
-        if ( arrayLimit == 0xC0 ) {
-            arrayLimit = (short)( dataIn->readByte() & 0xFF );
-        } else if( arrayLimit == 0x80 ) {
-            arrayLimit = dataIn->readShort();
-        }
+    unsigned int value = this->writeWord;
+    unsigned char* bytes = this->data + offset;
+    bytes[0] = (unsigned char) value;
+    bytes[1] = (unsigned char)( value >> 8 );
+    bytes[2] = (unsigned char)( value >> 16 );
+    bytes[3] = (unsigned char)( value >> 24 );
+    this->writeWord = 0;
+}
 
-        // Make sure we can accomodate all the data.
-        data.resize( arrayLimit );
+///////////////////////////////////////////////////////////////////////////////
+void BooleanStream::loadWord() {
 
-        // Make sure we get all the data we are expecting
-        dataIn->readFully( &data[0], (int)data.size(), 0, arrayLimit );
+    int offset = this->readPos >> 3;
+    int length = std::min( 4, this->arrayLimit - offset );
+    const unsigned char* bytes = this->data + offset;
 
-        clear();
+    unsigned int value = 0;
+    for( int i = 0; i < length; ++i ) {
+        value |= (unsigned int) bytes[i] << ( i * 8 );
     }
-    AMQ_CATCH_RETHROW( IOException )
-    AMQ_CATCH_EXCEPTION_CONVERT( Exception, IOException )
-    AMQ_CATCHALL_THROW( IOException )
+
+    this->readWord = value;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-void BooleanStream::clear() {
-    // Reset the positions
-    arrayPos = 0;
-    bytePos = 0;
+void BooleanStream::ensureCapacity( int size ) {
+
+    if( size <= this->capacity ) {
+        return;
+    }
+
+    if( size > MAX_ARRAY_LIMIT ) {
+        throw IOException(
+            __FILE__, __LINE__, "BooleanStream - Size of %d bytes is larger than the encoding allows", size );
+    }
+
+    // A stream lives no longer than the marshal or unmarshal that created it, so
+    // within a scope the larger buffer can come from the arena.
+    MessageArena* arena = MessageArena::current();
+    std::vector<unsigned char> heap;
+    unsigned char* buffer = NULL;
+
+    if( arena != NULL ) {
+        buffer = static_cast<unsigned char*>( arena->allocate( MAX_HEADER_SIZE + size ) );
+    } else {
+        heap.resize( MAX_HEADER_SIZE + size );
+        buffer = &heap[0];
+    }
+
+    std::copy( this->data, this->data + this->capacity, buffer + MAX_HEADER_SIZE );
+
+    if( arena == NULL ) {
+        this->overflow.swap( heap );
+    }
+
+    this->data = buffer + MAX_HEADER_SIZE;
+    this->capacity = size;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-int BooleanStream::marshalledSize() {
+void BooleanStream::grow() {
 
-    if( arrayLimit < 64 ) {
-        return 1 + arrayLimit;
-    } else if( arrayLimit < 256 ) {
-        return 2 + arrayLimit;
-    } else {
-        return 3 + arrayLimit;
+    int size = this->capacity * 2;
+    if( size > MAX_ARRAY_LIMIT ) {
+        size = std::max( MAX_ARRAY_LIMIT, this->capacity + 1 );
     }
+
+    ensureCapacity( size );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void BooleanStream::throwUnderflow() const {
+    throw IOException(
+        __FILE__, __LINE__, "BooleanStream - Read past the %d bytes of booleans in the stream", this->arrayLimit );
 }
@@ -22,6 +22,8 @@
 #include <decaf/io/DataOutputStream.h>
 #include <activemq/util/Config.h>
 
+#include <vector>
+
 namespace activemq{
 namespace wireformat{
 namespace openwire{
@@ -45,21 +47,62 @@ namespace utils{
      * the size field.  If the first byte < 64, the value of the byte is simply the size
      * value.  If the first byte = 0xC0, the following unsigned byte is the size field.
      * If the first byte = 0x80, the following short (two bytes) are the size field.
+     *
+     * A stream is created for every tightly encoded command so it keeps its booleans
+     * in a small buffer inside the object and only moves to the heap when a stream
+     * outgrows it, or to the thread's MessageArena when the marshal or unmarshal it
+     * belongs to has a scope open.  Booleans are collected in a word and moved to and from the buffer
+     * 32 at a time, and the size field is placed directly in front of them so that
+     * marshaling is a single write to the output stream.
      */
     class AMQCPP_API BooleanStream {
+    public:
+
+        /**
+         * Number of bytes of booleans held inside the object itself, enough for the
+         * bits of every command the generated marshallers write.  Larger streams
+         * move to the heap.
+         */
+        static const int INLINE_SIZE = 64;
+
+        /**
+         * The largest number of bytes the size field can take.
+         */
+        static const int MAX_HEADER_SIZE = 3;
+
     private:
 
-        // Internal Buffer of data
-        std::vector<unsigned char> data;
+        // Inline buffer, the size field is written into the space in front of
+        // the booleans so both go out in a single write.
+        unsigned char inlineData[MAX_HEADER_SIZE + INLINE_SIZE];
+
+        // Heap buffer for streams larger than the inline one, same layout.  Unused
+        // when the larger buffer is taken from the MessageArena.
+        std::vector<unsigned char> overflow;
+
+        // Start of the booleans in whichever buffer is in use.
+        unsigned char* data;
 
-        // Limit on buffer size
-        short arrayLimit;
+        // Number of bytes available at data.
+        int capacity;
 
-        // Byte we are on from the buffer
-        short arrayPos;
+        // Number of bytes of booleans in the buffer, set by unmarshal or once the
+        // written booleans are stored for marshaling.
+        int arrayLimit;
+
+        // Booleans are written into a word and stored in the buffer 32 at a time.
+        unsigned int writeWord;
+        int writePos;
+
+        // Booleans are read from a word loaded from the buffer 32 at a time.
+        unsigned int readWord;
+        int readPos;
+        int readLimit;
+
+    private:
 
-        // Bit we are on in the byte we are on from the buffer
-        unsigned char bytePos;
+        BooleanStream( const BooleanStream& );
+        BooleanStream& operator= ( const BooleanStream& );
 
     public:
 
@@ -72,20 +115,39 @@ namespace utils{
          *
          * @returns boolean from the stream
          *
-         * @throws IOException if an I/O error occurs during this operation.
+         * @throws IOException if the stream holds no more booleans.
          */
-        bool readBoolean();
+        bool readBoolean() {
+            if( this->readPos >= this->readLimit ) {
+                throwUnderflow();
+            }
+
+            if( ( this->readPos & 31 ) == 0 ) {
+                loadWord();
+            }
+
+            return ( ( this->readWord >> ( this->readPos++ & 31 ) ) & 0x01 ) != 0;
+        }
 
         /**
          * Writes a Boolean value to the internal data buffer
          * @param value - boolean data to write.
          *
-         * @throws IOException if an I/O error occurs during this operation.
+         * @throws IOException if the stream would grow past the size field's limit.
          */
-        void writeBoolean( bool value );
+        void writeBoolean( bool value ) {
+            if( value ) {
+                this->writeWord |= 1u << ( this->writePos & 31 );
+            }
+
+            if( ( ++this->writePos & 31 ) == 0 ) {
+                storeWord();
+            }
+        }
 
         /**
-         * Marshal the data to a DataOutputStream
+         * Marshal the data to a DataOutputStream, the size field and the booleans
+         * are handed to the stream in one write.
          * @param dataOut - Stream to write the data to.
          *
          * @throws IOException if an I/O error occurs during this operation.
@@ -117,7 +179,34 @@ namespace utils{
          * Calc the size that data is marshalled to
          * @returns int size of marshalled data.
          */
-        int marshalledSize();
+        int marshalledSize() const {
+            int size = byteCount();
+            return ( size < 64 ? 1 : ( size < 256 ? 2 : 3 ) ) + size;
+        }
+
+    private:
+
+        int byteCount() const {
+            return this->writePos > 0 ? ( this->writePos + 7 ) >> 3 : this->arrayLimit;
+        }
+
+        // Stores the booleans written since the last full word, making them
+        // part of the buffer that is marshaled and read back.
+        void finishWriting();
+
+        void storeWord();
+
+        void loadWord();
+
+        // Writes the size field into the bytes in front of the booleans and
+        // returns where it starts.
+        unsigned char* encodeHeader();
+
+        void ensureCapacity( int size );
+
+        void grow();
+
+        void throwUnderflow() const;
 
     };
 
@@ -0,0 +1,181 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DirectDataInputStream.h"
+
+#include <decaf/lang/exceptions/NullPointerException.h>
+#include <decaf/lang/exceptions/IndexOutOfBoundsException.h>
+#include <decaf/internal/util/ModifiedUTF8.h>
+
+#include <string.h>
+
+using namespace activemq;
+using namespace activemq::wireformat;
+using namespace activemq::wireformat::openwire;
+using namespace activemq::wireformat::openwire::utils;
+using namespace decaf;
+using namespace decaf::io;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using decaf::internal::util::ModifiedUTF8;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace activemq {
+namespace wireformat {
+namespace openwire {
+namespace utils {
+
+    /**
+     * Source of the base class filter chain, anything read through the generic
+     * DataInputStream methods such as readLine comes from the same array.
+     */
+    class DirectDataInputStream::Source : public decaf::io::InputStream {
+    private:
+
+        DirectDataInputStream* parent;
+
+    private:
+
+        Source(const Source&);
+        Source& operator=(const Source&);
+
+    public:
+
+        Source() : InputStream(), parent(NULL) {}
+
+        virtual ~Source() {}
+
+        void setParent(DirectDataInputStream* parent) {
+            this->parent = parent;
+        }
+
+        virtual int available() const {
+            return this->parent->available();
+        }
+
+        virtual long long skip(long long num) {
+            return this->parent->skipBytes(num);
+        }
+
+    protected:
+
+        virtual int doReadByte() {
+            return this->parent->doReadByte();
+        }
+
+        virtual int doReadArrayBounded(unsigned char* buffer, int size, int offset, int length) {
+            return this->parent->doReadArrayBounded(buffer, size, offset, length);
+        }
+    };
+
+}}}}
+
+////////////////////////////////////////////////////////////////////////////////
+DirectDataInputStream::DirectDataInputStream(const unsigned char* frame, int length) :
+    DataInputStream(new Source(), true), frame(frame), length(length), position(0) {
+
+    if (frame == NULL && length > 0) {
+        throw NullPointerException(__FILE__, __LINE__, "Frame buffer cannot be NULL");
+    }
+
+    static_cast<Source*>(this->inputStream)->setParent(this);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+DirectDataInputStream::~DirectDataInputStream() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string DirectDataInputStream::readUTF() {
+
+    int utfLength = readUnsignedShort();
+    if (utfLength == 0) {
+        return "";
+    }
+
+    ensureAvailable(utfLength);
+
+    std::string result(utfLength, '\0');
+    result.resize(ModifiedUTF8::decode(this->frame + this->position, utfLength, &result[0]));
+    this->position += utfLength;
+
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DirectDataInputStream::readFully(unsigned char* buffer, int size, int offset, int length) {
+
+    if (length == 0) {
+        return;
+    }
+
+    if (buffer == NULL) {
+        throw NullPointerException(__FILE__, __LINE__, "Buffer passed cannot be NULL");
+    }
+
+    if (size < 0 || offset < 0 || length < 0 || offset > size - length) {
+        throw IndexOutOfBoundsException(__FILE__, __LINE__, "Invalid offset or length for the given buffer");
+    }
+
+    ensureAvailable(length);
+    ::memcpy(buffer + offset, this->frame + this->position, length);
+    this->position += length;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long DirectDataInputStream::skipBytes(long long num) {
+
+    if (num <= 0) {
+        return 0;
+    }
+
+    long long skipped = num < available() ? num : available();
+    this->position += (int) skipped;
+    return skipped;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int DirectDataInputStream::doReadArrayBounded(unsigned char* buffer, int size, int offset, int length) {
+
+    if (length == 0) {
+        return 0;
+    }
+
+    if (buffer == NULL) {
+        throw NullPointerException(__FILE__, __LINE__, "Buffer passed cannot be NULL");
+    }
+
+    if (size < 0 || offset < 0 || length < 0 || offset > size - length) {
+        throw IndexOutOfBoundsException(__FILE__, __LINE__, "Invalid offset or length for the given buffer");
+    }
+
+    if (this->position >= this->length) {
+        return -1;
+    }
+
+    int count = length < available() ? length : available();
+    ::memcpy(buffer + offset, this->frame + this->position, count);
+    this->position += count;
+    return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DirectDataInputStream::throwUnderflow(int count) const {
+    throw EOFException(__FILE__, __LINE__,
+        "Read of %d bytes passes the end of a frame of %d bytes at position %d",
+        count, this->length, this->position);
+}
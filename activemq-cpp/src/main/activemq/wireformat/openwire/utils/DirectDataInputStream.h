@@ -0,0 +1,174 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_WIREFORMAT_OPENWIRE_UTILS_DIRECTDATAINPUTSTREAM_H_
+#define _ACTIVEMQ_WIREFORMAT_OPENWIRE_UTILS_DIRECTDATAINPUTSTREAM_H_
+
+#include <activemq/util/Config.h>
+#include <decaf/io/DataInputStream.h>
+#include <decaf/io/EOFException.h>
+
+namespace activemq {
+namespace wireformat {
+namespace openwire {
+namespace utils {
+
+    /**
+     * A DataInputStream that decodes directly from a byte array holding a complete frame.
+     *
+     * Once the size prefix of a frame has been read the rest of it is read from the
+     * transport in one call and the marshallers decode it from memory with plain loads
+     * at a cursor.  Reading past the end of the frame throws an EOFException.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API DirectDataInputStream : public decaf::io::DataInputStream {
+    private:
+
+        class Source;
+
+        const unsigned char* frame;
+        int length;
+        int position;
+
+    private:
+
+        DirectDataInputStream(const DirectDataInputStream&);
+        DirectDataInputStream& operator=(const DirectDataInputStream&);
+
+    public:
+
+        /**
+         * Creates a stream that reads from the given array, the array must outlive the stream.
+         *
+         * @param frame
+         *      The array to decode from.
+         * @param length
+         *      The number of valid bytes in the array.
+         */
+        DirectDataInputStream(const unsigned char* frame, int length);
+
+        virtual ~DirectDataInputStream();
+
+        /**
+         * @returns the number of bytes read so far.
+         */
+        int getPosition() const {
+            return this->position;
+        }
+
+        /**
+         * @returns the number of bytes in the frame.
+         */
+        int getLength() const {
+            return this->length;
+        }
+
+        virtual int available() const {
+            return this->length - this->position;
+        }
+
+        virtual bool readBoolean() {
+            ensureAvailable(1);
+            return this->frame[this->position++] != 0;
+        }
+
+        virtual char readByte() {
+            ensureAvailable(1);
+            return (char) this->frame[this->position++];
+        }
+
+        virtual unsigned char readUnsignedByte() {
+            ensureAvailable(1);
+            return this->frame[this->position++];
+        }
+
+        virtual char readChar() {
+            return readByte();
+        }
+
+        virtual short readShort() {
+            return (short) readUnsignedShort();
+        }
+
+        virtual unsigned short readUnsignedShort() {
+            ensureAvailable(2);
+            const unsigned char* cursor = this->frame + this->position;
+            this->position += 2;
+            return (unsigned short) ((cursor[0] << 8) | cursor[1]);
+        }
+
+        virtual int readInt() {
+            ensureAvailable(4);
+            const unsigned char* cursor = this->frame + this->position;
+            this->position += 4;
+            return (int) (((unsigned int) cursor[0] << 24) | ((unsigned int) cursor[1] << 16) |
+                          ((unsigned int) cursor[2] << 8) | (unsigned int) cursor[3]);
+        }
+
+        virtual long long readLong() {
+            ensureAvailable(8);
+            const unsigned char* cursor = this->frame + this->position;
+            this->position += 8;
+            unsigned long long high = ((unsigned long long) cursor[0] << 24) | ((unsigned long long) cursor[1] << 16) |
+                                      ((unsigned long long) cursor[2] << 8) | (unsigned long long) cursor[3];
+            unsigned long long low = ((unsigned long long) cursor[4] << 24) | ((unsigned long long) cursor[5] << 16) |
+                                     ((unsigned long long) cursor[6] << 8) | (unsigned long long) cursor[7];
+            return (long long) ((high << 32) | low);
+        }
+
+        virtual std::string readUTF();
+
+        virtual void readFully(unsigned char* buffer, int size) {
+            readFully(buffer, size, 0, size);
+        }
+
+        virtual void readFully(unsigned char* buffer, int size, int offset, int length);
+
+        virtual long long skipBytes(long long num);
+
+        virtual void close() {}
+
+    protected:
+
+        virtual int doReadByte() {
+            return this->position < this->length ? this->frame[this->position++] : -1;
+        }
+
+        virtual int doReadArray(unsigned char* buffer, int size) {
+            return doReadArrayBounded(buffer, size, 0, size);
+        }
+
+        virtual int doReadArrayBounded(unsigned char* buffer, int size, int offset, int length);
+
+    private:
+
+        void ensureAvailable(int count) const {
+            if (this->length - this->position < count) {
+                throwUnderflow(count);
+            }
+        }
+
+        void throwUnderflow(int count) const;
+
+        friend class Source;
+
+    };
+
+}}}}
+
+#endif /* _ACTIVEMQ_WIREFORMAT_OPENWIRE_UTILS_DIRECTDATAINPUTSTREAM_H_ */
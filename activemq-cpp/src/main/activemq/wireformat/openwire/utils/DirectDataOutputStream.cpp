@@ -0,0 +1,136 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DirectDataOutputStream.h"
+
+#include <decaf/lang/exceptions/NullPointerException.h>
+#include <decaf/lang/exceptions/IndexOutOfBoundsException.h>
+#include <decaf/io/UTFDataFormatException.h>
+#include <decaf/internal/util/ModifiedUTF8.h>
+
+#include <string.h>
+
+using namespace activemq;
+using namespace activemq::wireformat;
+using namespace activemq::wireformat::openwire;
+using namespace activemq::wireformat::openwire::utils;
+using namespace decaf;
+using namespace decaf::io;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using decaf::internal::util::ModifiedUTF8;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace activemq {
+namespace wireformat {
+namespace openwire {
+namespace utils {
+
+    /**
+     * Target of the base class filter chain, anything written through the generic
+     * DataOutputStream methods such as writeChars lands in the same array.
+     */
+    class DirectDataOutputStream::Sink : public decaf::io::OutputStream {
+    private:
+
+        DirectDataOutputStream* parent;
+
+    private:
+
+        Sink(const Sink&);
+        Sink& operator=(const Sink&);
+
+    public:
+
+        Sink() : OutputStream(), parent(NULL) {}
+
+        virtual ~Sink() {}
+
+        void setParent(DirectDataOutputStream* parent) {
+            this->parent = parent;
+        }
+
+    protected:
+
+        virtual void doWriteByte(unsigned char value) {
+            this->parent->writeByte(value);
+        }
+
+        virtual void doWriteArrayBounded(const unsigned char* buffer, int size, int offset, int length) {
+            this->parent->doWriteArrayBounded(buffer, size, offset, length);
+        }
+    };
+
+}}}}
+
+////////////////////////////////////////////////////////////////////////////////
+DirectDataOutputStream::DirectDataOutputStream(unsigned char* frame, int capacity) :
+    DataOutputStream(new Sink(), true), frame(frame), capacity(capacity), position(0) {
+
+    if (frame == NULL && capacity > 0) {
+        throw NullPointerException(__FILE__, __LINE__, "Frame buffer cannot be NULL");
+    }
+
+    static_cast<Sink*>(this->outputStream)->setParent(this);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+DirectDataOutputStream::~DirectDataOutputStream() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DirectDataOutputStream::doWriteArrayBounded(const unsigned char* buffer, int size, int offset, int length) {
+
+    if (length == 0) {
+        return;
+    }
+
+    if (buffer == NULL) {
+        throw NullPointerException(__FILE__, __LINE__, "Buffer passed cannot be NULL");
+    }
+
+    if (size < 0 || offset < 0 || length < 0 || offset > size - length) {
+        throw IndexOutOfBoundsException(__FILE__, __LINE__, "Invalid offset or length for the given buffer");
+    }
+
+    ensureCapacity(length);
+    ::memcpy(this->frame + this->position, buffer + offset, length);
+    this->position += length;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DirectDataOutputStream::writeUTF(const std::string& value) {
+
+    std::size_t length = value.length();
+    std::size_t utfLength = ModifiedUTF8::encodedLength(value.c_str(), length);
+
+    if (utfLength > 65535) {
+        throw UTFDataFormatException(__FILE__, __LINE__, "Attempted to write a string as UTF-8 whose length is longer "
+                "than the supported 65535 bytes");
+    }
+
+    ensureCapacity((int) utfLength + 2);
+    writeUnsignedShort((unsigned short) utfLength);
+    this->position += (int) ModifiedUTF8::encode(value.c_str(), length, this->frame + this->position);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DirectDataOutputStream::throwOverflow(int length) const {
+    throw IOException(__FILE__, __LINE__,
+        "Write of %d bytes overflows a frame of %d bytes at position %d",
+        length, this->capacity, this->position);
+}
@@ -0,0 +1,174 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_WIREFORMAT_OPENWIRE_UTILS_DIRECTDATAOUTPUTSTREAM_H_
+#define _ACTIVEMQ_WIREFORMAT_OPENWIRE_UTILS_DIRECTDATAOUTPUTSTREAM_H_
+
+#include <activemq/util/Config.h>
+#include <decaf/io/DataOutputStream.h>
+#include <decaf/io/IOException.h>
+
+namespace activemq {
+namespace wireformat {
+namespace openwire {
+namespace utils {
+
+    /**
+     * A DataOutputStream that encodes directly into a caller supplied byte array.
+     *
+     * OpenWireFormat computes the exact size of a frame before writing it, so the whole
+     * frame can be encoded into one array sized for it and then handed to the transport
+     * in a single write.  The primitive writes are plain big-endian stores at a cursor,
+     * they don't pass through a chain of filter streams or the exception translation that
+     * each layer of that chain adds.  Writing past the end of the array throws an
+     * IOException, which for a frame sized by tightMarshal1 indicates a marshaller bug.
+     *
+     * @since 3.8.0
+     */
+    class AMQCPP_API DirectDataOutputStream : public decaf::io::DataOutputStream {
+    private:
+
+        class Sink;
+
+        unsigned char* frame;
+        int capacity;
+        int position;
+
+    private:
+
+        DirectDataOutputStream(const DirectDataOutputStream&);
+        DirectDataOutputStream& operator=(const DirectDataOutputStream&);
+
+    public:
+
+        /**
+         * Creates a stream that writes into the given array, the array must outlive the stream.
+         *
+         * @param frame
+         *      The array to encode into.
+         * @param capacity
+         *      The number of bytes available in the array.
+         */
+        DirectDataOutputStream(unsigned char* frame, int capacity);
+
+        virtual ~DirectDataOutputStream();
+
+        /**
+         * @returns the number of bytes written so far.
+         */
+        int getPosition() const {
+            return this->position;
+        }
+
+        /**
+         * @returns the number of bytes the array can hold.
+         */
+        int getCapacity() const {
+            return this->capacity;
+        }
+
+        virtual long long size() const {
+            return this->position;
+        }
+
+        virtual void writeBoolean(bool value) {
+            ensureCapacity(1);
+            this->frame[this->position++] = value ? 1 : 0;
+        }
+
+        virtual void writeByte(unsigned char value) {
+            ensureCapacity(1);
+            this->frame[this->position++] = value;
+        }
+
+        virtual void writeShort(short value) {
+            writeUnsignedShort((unsigned short) value);
+        }
+
+        virtual void writeUnsignedShort(unsigned short value) {
+            ensureCapacity(2);
+            unsigned char* cursor = this->frame + this->position;
+            cursor[0] = (unsigned char) (value >> 8);
+            cursor[1] = (unsigned char) value;
+            this->position += 2;
+        }
+
+        virtual void writeChar(char value) {
+            writeByte((unsigned char) value);
+        }
+
+        virtual void writeInt(int value) {
+            ensureCapacity(4);
+            unsigned int bits = (unsigned int) value;
+            unsigned char* cursor = this->frame + this->position;
+            cursor[0] = (unsigned char) (bits >> 24);
+            cursor[1] = (unsigned char) (bits >> 16);
+            cursor[2] = (unsigned char) (bits >> 8);
+            cursor[3] = (unsigned char) bits;
+            this->position += 4;
+        }
+
+        virtual void writeLong(long long value) {
+            ensureCapacity(8);
+            unsigned long long bits = (unsigned long long) value;
+            unsigned char* cursor = this->frame + this->position;
+            cursor[0] = (unsigned char) (bits >> 56);
+            cursor[1] = (unsigned char) (bits >> 48);
+            cursor[2] = (unsigned char) (bits >> 40);
+            cursor[3] = (unsigned char) (bits >> 32);
+            cursor[4] = (unsigned char) (bits >> 24);
+            cursor[5] = (unsigned char) (bits >> 16);
+            cursor[6] = (unsigned char) (bits >> 8);
+            cursor[7] = (unsigned char) bits;
+            this->position += 8;
+        }
+
+        virtual void writeUTF(const std::string& value);
+
+        virtual void flush() {}
+
+        virtual void close() {}
+
+    protected:
+
+        virtual void doWriteByte(unsigned char value) {
+            writeByte(value);
+        }
+
+        virtual void doWriteArray(const unsigned char* buffer, int size) {
+            doWriteArrayBounded(buffer, size, 0, size);
+        }
+
+        virtual void doWriteArrayBounded(const unsigned char* buffer, int size, int offset, int length);
+
+    private:
+
+        void ensureCapacity(int length) const {
+            if (this->capacity - this->position < length) {
+                throwOverflow(length);
+            }
+        }
+
+        void throwOverflow(int length) const;
+
+        friend class Sink;
+
+    };
+
+}}}}
+
+#endif /* _ACTIVEMQ_WIREFORMAT_OPENWIRE_UTILS_DIRECTDATAOUTPUTSTREAM_H_ */
@@ -24,6 +24,7 @@
 #include <decaf/lang/System.h>
 #include <decaf/lang/Thread.h>
 #include <decaf/internal/net/Network.h>
+#include <decaf/internal/nio/DirectMemoryPool.h>
 #include <decaf/internal/security/SecurityRuntime.h>
 #include <decaf/internal/util/concurrent/Threading.h>
 
@@ -98,6 +99,9 @@ void Runtime::shutdownRuntime() {
 
     System::shutdownSystem();
 
+    // Give back the memory cached for direct buffers.
+    decaf::internal::nio::DirectMemoryPool::purge();
+
     // This must go away before Threading is shutdown.
     delete globalLock;
 
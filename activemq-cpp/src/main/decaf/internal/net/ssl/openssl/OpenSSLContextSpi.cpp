@@ -30,6 +30,8 @@
 #include <decaf/internal/net/ssl/openssl/OpenSSLSocketFactory.h>
 #include <decaf/internal/net/ssl/openssl/OpenSSLServerSocketFactory.h>
 
+#include <map>
+
 #ifdef HAVE_STRINGS_H
 #include <strings.h>
 #endif
@@ -77,13 +79,20 @@ namespace openssl {
         Pointer<SecureRandom> random;
         std::string password;
 
+        // Client side TLS sessions keyed by the peer they were negotiated with.
+        mutable Mutex sessionLock;
+        long long sessionHits;
+        long long sessionMisses;
+
         static Mutex* locks;
         static std::string defaultCipherList;
 
 #ifdef HAVE_OPENSSL
         SSL_CTX* openSSLContext;
+        std::map<std::string, SSL_SESSION*> sessions;
 #else
         void* openSSLContext;
+        std::map<std::string, void*> sessions;
 #endif
 
     private:
@@ -98,7 +107,11 @@ namespace openssl {
                                   serverSocketFactory(),
                                   random(),
                                   password(),
-                                  openSSLContext(NULL) {
+                                  sessionLock(),
+                                  sessionHits(0),
+                                  sessionMisses(0),
+                                  openSSLContext(NULL),
+                                  sessions() {
 
             ContextData::locks = new Mutex[size];
         }
@@ -107,6 +120,7 @@ namespace openssl {
 
 #ifdef HAVE_OPENSSL
             try{
+                clearSessions();
                 SSL_CTX_free( this->openSSLContext );
             } catch(...) {}
 #endif
@@ -142,6 +156,49 @@ namespace openssl {
             return (unsigned long)Thread::currentThread()->getId();
         }
 
+#ifdef HAVE_OPENSSL
+
+        void clearSessions() {
+            synchronized( &sessionLock ) {
+                std::map<std::string, SSL_SESSION*>::iterator iter = sessions.begin();
+                for( ; iter != sessions.end(); ++iter ) {
+                    SSL_SESSION_free( iter->second );
+                }
+                sessions.clear();
+            }
+        }
+
+        // Called by OpenSSL each time a client connection is handed a new session, with
+        // TLS 1.3 this happens when the server's ticket is read after the handshake.  We
+        // only cache for sockets that registered the peer they connected to.
+        static int newSessionCallback( SSL* ssl, SSL_SESSION* session ) {
+
+            OpenSSLContextSpi* context =
+                static_cast<OpenSSLContextSpi*>( SSL_CTX_get_app_data( SSL_get_SSL_CTX( ssl ) ) );
+            const std::string* peer = static_cast<const std::string*>( SSL_get_app_data( ssl ) );
+
+            if( context == NULL || peer == NULL || peer->empty() ) {
+                return 0;
+            }
+
+            ContextData* ctxData = context->data;
+
+            synchronized( &ctxData->sessionLock ) {
+                std::map<std::string, SSL_SESSION*>::iterator iter = ctxData->sessions.find( *peer );
+                if( iter != ctxData->sessions.end() ) {
+                    SSL_SESSION_free( iter->second );
+                    iter->second = session;
+                } else {
+                    ctxData->sessions.insert( std::make_pair( *peer, session ) );
+                }
+            }
+
+            // We keep the reference OpenSSL handed us.
+            return 1;
+        }
+
+#endif
+
     };
 
     Mutex* ContextData::locks = NULL;
@@ -203,6 +260,15 @@ void OpenSSLContextSpi::providerInit( SecureRandom* random ) {
         SSL_CTX_set_options( this->data->openSSLContext, SSL_OP_ALL | SSL_OP_NO_SSLv2 );
         SSL_CTX_set_mode( this->data->openSSLContext, SSL_MODE_AUTO_RETRY );
 
+        // Client sessions are kept in our own per peer cache so that reconnects can resume
+        // them, the server side keeps using the OpenSSL internal cache.  The session id
+        // context is required for a server to resume sessions when verifying clients.
+        SSL_CTX_set_app_data( this->data->openSSLContext, (void*)this );
+        SSL_CTX_set_session_cache_mode( this->data->openSSLContext, SSL_SESS_CACHE_BOTH );
+        SSL_CTX_sess_set_new_cb( this->data->openSSLContext, &ContextData::newSessionCallback );
+        SSL_CTX_set_session_id_context( this->data->openSSLContext,
+                                        (const unsigned char*)"decaf", 5 );
+
         // The Password Callback for cases where we need to open a Cert.
         SSL_CTX_set_default_passwd_cb( this->data->openSSLContext, &ContextData::passwordCallback );
         SSL_CTX_set_default_passwd_cb_userdata( this->data->openSSLContext, (void*)this->data );
@@ -313,3 +379,98 @@ void* OpenSSLContextSpi::getOpenSSLCtx() {
 
     return (void*)this->data->openSSLContext;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+long long OpenSSLContextSpi::getSessionCacheHits() const {
+
+    if( this->data == NULL ) {
+        return 0;
+    }
+
+    synchronized( &( this->data->sessionLock ) ) {
+        return this->data->sessionHits;
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long OpenSSLContextSpi::getSessionCacheMisses() const {
+
+    if( this->data == NULL ) {
+        return 0;
+    }
+
+    synchronized( &( this->data->sessionLock ) ) {
+        return this->data->sessionMisses;
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int OpenSSLContextSpi::getSessionCacheSize() const {
+
+    if( this->data == NULL ) {
+        return 0;
+    }
+
+    synchronized( &( this->data->sessionLock ) ) {
+        return (int)this->data->sessions.size();
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenSSLContextSpi::clearSessionCache() {
+
+#ifdef HAVE_OPENSSL
+    if( this->data != NULL ) {
+        this->data->clearSessions();
+    }
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool OpenSSLContextSpi::resumeSession( void* ssl DECAF_UNUSED, const std::string& peer DECAF_UNUSED ) {
+
+#ifdef HAVE_OPENSSL
+    synchronized( &( this->data->sessionLock ) ) {
+        std::map<std::string, SSL_SESSION*>::const_iterator iter = this->data->sessions.find( peer );
+        if( iter != this->data->sessions.end() ) {
+            // The SSL object takes its own reference to the session.
+            return SSL_set_session( static_cast<SSL*>( ssl ), iter->second ) == 1;
+        }
+    }
+#endif
+
+    return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenSSLContextSpi::handshakeCompleted( void* ssl DECAF_UNUSED,
+                                            const std::string& peer DECAF_UNUSED,
+                                            bool success DECAF_UNUSED ) {
+
+#ifdef HAVE_OPENSSL
+    synchronized( &( this->data->sessionLock ) ) {
+
+        if( !success ) {
+            std::map<std::string, SSL_SESSION*>::iterator iter = this->data->sessions.find( peer );
+            if( iter != this->data->sessions.end() ) {
+                SSL_SESSION_free( iter->second );
+                this->data->sessions.erase( iter );
+            }
+
+            return;
+        }
+
+        if( SSL_session_reused( static_cast<SSL*>( ssl ) ) ) {
+            this->data->sessionHits++;
+        } else {
+            this->data->sessionMisses++;
+        }
+    }
+#endif
+}
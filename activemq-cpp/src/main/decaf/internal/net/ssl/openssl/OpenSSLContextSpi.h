@@ -66,8 +66,44 @@ namespace openssl {
          */
         virtual decaf::net::ServerSocketFactory* providerGetServerSocketFactory();
 
+    public:  // TLS Session cache
+
+        /**
+         * Client sockets created from this context cache the TLS session negotiated with
+         * each peer, keyed by the "host:port" they connected to, and offer it on the next
+         * connect to that peer so that a reconnect can skip the full handshake.
+         *
+         * @return the number of client handshakes that resumed a cached session.
+         *
+         * @since 3.8.0
+         */
+        long long getSessionCacheHits() const;
+
+        /**
+         * @return the number of client handshakes that required a full handshake.
+         *
+         * @since 3.8.0
+         */
+        long long getSessionCacheMisses() const;
+
+        /**
+         * @return the number of peers that currently have a cached TLS session.
+         *
+         * @since 3.8.0
+         */
+        int getSessionCacheSize() const;
+
+        /**
+         * Discards all cached TLS sessions, the next connect to any peer will perform
+         * a full handshake.  The hit and miss counters are not reset.
+         *
+         * @since 3.8.0
+         */
+        void clearSessionCache();
+
     private:
 
+        friend class ContextData;
         friend class OpenSSLSocket;
         friend class OpenSSLSocketFactory;
 
@@ -75,6 +111,14 @@ namespace openssl {
         std::vector<std::string> getSupportedCipherSuites();
         void* getOpenSSLCtx();
 
+        // Offers the session cached for the given peer to the SSL object prior to the
+        // handshake, returns true if there was one to offer.
+        bool resumeSession( void* ssl, const std::string& peer );
+
+        // Records the outcome of a client handshake, a failed handshake discards any
+        // session that was cached for the peer.
+        void handshakeCompleted( void* ssl, const std::string& peer, bool success );
+
     };
 
 }}}}}
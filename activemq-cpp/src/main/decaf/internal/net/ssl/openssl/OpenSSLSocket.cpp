@@ -28,10 +28,12 @@
 #include <decaf/io/IOException.h>
 #include <decaf/net/SocketException.h>
 #include <decaf/lang/Boolean.h>
+#include <decaf/lang/Integer.h>
 #include <decaf/lang/exceptions/NullPointerException.h>
 #include <decaf/lang/exceptions/IndexOutOfBoundsException.h>
 #include <decaf/internal/util/StringUtils.h>
 #include <decaf/internal/net/SocketFileDescriptor.h>
+#include <decaf/internal/net/ssl/openssl/OpenSSLContextSpi.h>
 #include <decaf/internal/net/ssl/openssl/OpenSSLParameters.h>
 #include <decaf/internal/net/ssl/openssl/OpenSSLSocketException.h>
 #include <decaf/internal/net/ssl/openssl/OpenSSLSocketInputStream.h>
@@ -64,6 +66,7 @@ namespace openssl {
         bool handshakeStarted;
         bool handshakeCompleted;
         std::string commonName;
+        std::string peer;
 
         Mutex handshakeLock;
 
@@ -72,6 +75,7 @@ namespace openssl {
         SocketData() : handshakeStarted( false ),
                        handshakeCompleted( false ),
                        commonName(),
+                       peer(),
                        handshakeLock() {
         }
 
@@ -205,6 +209,9 @@ void OpenSSLSocket::connect( const std::string& host, int port, int timeout ) {
             // Later when startHandshake is called we will check for this common name
             // in the provided certificate
             this->data->commonName = host;
+
+            // Key used to resume a previously negotiated session with this peer.
+            this->data->peer = host + ":" + Integer::toString( port );
         }
 #else
         throw SocketException( __FILE__, __LINE__, "Not Supported" );
@@ -366,6 +373,17 @@ void OpenSSLSocket::startHandshake() {
                     SSL_set_verify( this->parameters->getSSL(), SSL_VERIFY_NONE, NULL );
                 }
 
+                // Offer the session cached for this peer so that a reconnect can skip the
+                // full handshake, registering the peer also lets the context cache the
+                // session the server hands us this time around.
+                OpenSSLContextSpi* context = static_cast<OpenSSLContextSpi*>(
+                    SSL_CTX_get_app_data( SSL_get_SSL_CTX( this->parameters->getSSL() ) ) );
+
+                if( context != NULL && !this->data->peer.empty() ) {
+                    SSL_set_app_data( this->parameters->getSSL(), (void*)&( this->data->peer ) );
+                    context->resumeSession( this->parameters->getSSL(), this->data->peer );
+                }
+
                 int result = SSL_connect( this->parameters->getSSL() );
 
                 // Checks the error status, when things go right we still perform a deeper
@@ -374,13 +392,27 @@ void OpenSSLSocket::startHandshake() {
                 // signed by a signing authority that we trust.
                 switch( SSL_get_error( this->parameters->getSSL(), result ) ) {
                     case SSL_ERROR_NONE:
-                        if(!peerVerifyDisabled) {
-                            verifyServerCert( this->data->commonName );
+                        try {
+                            if(!peerVerifyDisabled) {
+                                verifyServerCert( this->data->commonName );
+                            }
+                        } catch( IOException& ex ) {
+                            if( context != NULL ) {
+                                context->handshakeCompleted( this->parameters->getSSL(), this->data->peer, false );
+                            }
+                            throw;
+                        }
+
+                        if( context != NULL ) {
+                            context->handshakeCompleted( this->parameters->getSSL(), this->data->peer, true );
                         }
                         break;
                     case SSL_ERROR_SSL:
                     case SSL_ERROR_ZERO_RETURN:
                     case SSL_ERROR_SYSCALL:
+                        if( context != NULL ) {
+                            context->handshakeCompleted( this->parameters->getSSL(), this->data->peer, false );
+                        }
                         SSLSocket::close();
                         throw OpenSSLSocketException( __FILE__, __LINE__ );
                 }
@@ -406,7 +438,7 @@ void OpenSSLSocket::startHandshake() {
 
                 int result = SSL_accept( this->parameters->getSSL() );
 
-                if( result != SSL_ERROR_NONE ) {
+                if( result != 1 ) {
                     SSLSocket::close();
                     throw OpenSSLSocketException( __FILE__, __LINE__ );
                 }
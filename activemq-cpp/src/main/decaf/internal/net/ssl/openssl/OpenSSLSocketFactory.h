@@ -94,6 +94,16 @@ namespace openssl {
         virtual decaf::net::Socket* createSocket( decaf::net::Socket* socket, std::string host,
                                                   int port, bool autoClose );
 
+        /**
+         * @return the OpenSSLContextSpi that created this factory, it holds the TLS
+         *         session cache shared by all the sockets this factory creates.
+         *
+         * @since 3.8.0
+         */
+        OpenSSLContextSpi* getContext() const {
+            return this->parent;
+        }
+
     };
 
 }}}}}
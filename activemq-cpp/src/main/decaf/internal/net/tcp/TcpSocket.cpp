@@ -30,9 +30,12 @@
 #include <string>
 #include <stdio.h>
 #include <iostream>
+#include <vector>
+#include <algorithm>
 
 #include <apr_portable.h>
 #include <apr_network_io.h>
+#include <apr_file_io.h>
 
 #if !defined(HAVE_WINSOCK2_H)
     #include <sys/select.h>
@@ -760,6 +763,140 @@ void TcpSocket::write(const unsigned char* buffer, int size, int offset, int len
     DECAF_CATCHALL_THROW(IOException)
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void TcpSocket::sendFile(const std::string& path, long long position, long long length,
+                         const unsigned char* header, int headerLength,
+                         const unsigned char* trailer, int trailerLength) {
+
+    try {
+
+        if (position < 0 || length < 0) {
+            throw IndexOutOfBoundsException(__FILE__, __LINE__,
+                "TcpSocket::sendFile - Invalid file region: position %lld, length %lld.", position, length);
+        }
+
+        if (headerLength < 0 || trailerLength < 0 ||
+            (header == NULL && headerLength > 0) || (trailer == NULL && trailerLength > 0)) {
+            throw IndexOutOfBoundsException(__FILE__, __LINE__,
+                "TcpSocket::sendFile - Invalid header or trailer.");
+        }
+
+        if (isClosed()) {
+            throw IOException(__FILE__, __LINE__,
+                "TcpSocket::sendFile - This Stream has been closed.");
+        }
+
+        AprPool pool;
+        apr_file_t* file = NULL;
+
+        if (apr_file_open(&file, path.c_str(), APR_READ | APR_BINARY | APR_SENDFILE_ENABLED,
+                          APR_OS_DEFAULT, pool.getAprPool()) != APR_SUCCESS) {
+            throw IOException(__FILE__, __LINE__,
+                "TcpSocket::sendFile - Could not open file: %s", path.c_str());
+        }
+
+        try {
+
+            long long fileSent = 0;
+            long long trailerSent = 0;
+
+#if APR_HAS_SENDFILE
+
+            struct iovec headers[1];
+            struct iovec trailers[1];
+            headers[0].iov_base = (char*) header;
+            headers[0].iov_len = (apr_size_t) headerLength;
+            trailers[0].iov_base = (char*) trailer;
+            trailers[0].iov_len = (apr_size_t) trailerLength;
+
+            apr_hdtr_t hdtr;
+            hdtr.headers = headers;
+            hdtr.numheaders = headerLength > 0 ? 1 : 0;
+            hdtr.trailers = trailers;
+            hdtr.numtrailers = trailerLength > 0 ? 1 : 0;
+
+            // The first call normally moves the whole frame, on return sent holds the
+            // count of header, file and trailer bytes that actually went out.
+            apr_off_t offset = (apr_off_t) position;
+            apr_size_t sent = (apr_size_t) length;
+
+            apr_status_t result = apr_socket_sendfile(
+                this->impl->socketHandle, file, &hdtr, &offset, &sent, 0);
+
+            if (result != APR_SUCCESS || isClosed()) {
+                throw IOException(__FILE__, __LINE__,
+                    "TcpSocket::sendFile - %s", SocketError::getErrorString().c_str());
+            }
+
+            long long done = (long long) sent;
+
+            if (done < headerLength) {
+                this->write(header, headerLength, (int) done, headerLength - (int) done);
+                done = headerLength;
+            }
+
+            fileSent = std::min(done - headerLength, length);
+            trailerSent = std::max(done - headerLength - length, (long long) 0);
+
+            while (fileSent < length && !isClosed()) {
+
+                offset = (apr_off_t) (position + fileSent);
+                sent = (apr_size_t) (length - fileSent);
+
+                result = apr_socket_sendfile(this->impl->socketHandle, file, NULL, &offset, &sent, 0);
+
+                if (result != APR_SUCCESS || sent == 0 || isClosed()) {
+                    throw IOException(__FILE__, __LINE__,
+                        "TcpSocket::sendFile - %s", SocketError::getErrorString().c_str());
+                }
+
+                fileSent += (long long) sent;
+            }
+
+#else
+
+            this->write(header, headerLength, 0, headerLength);
+
+            apr_off_t offset = (apr_off_t) position;
+            if (apr_file_seek(file, APR_SET, &offset) != APR_SUCCESS) {
+                throw IOException(__FILE__, __LINE__,
+                    "TcpSocket::sendFile - Could not seek to %lld in file: %s", position, path.c_str());
+            }
+
+            std::vector<unsigned char> chunk((std::size_t) std::min(length, (long long) 65536));
+
+            while (fileSent < length) {
+
+                apr_size_t count = (apr_size_t) std::min(length - fileSent, (long long) chunk.size());
+                apr_size_t read = 0;
+
+                if (apr_file_read_full(file, &chunk[0], count, &read) != APR_SUCCESS) {
+                    throw IOException(__FILE__, __LINE__,
+                        "TcpSocket::sendFile - File is shorter than the region being sent: %s", path.c_str());
+                }
+
+                this->write(&chunk[0], (int) read, 0, (int) read);
+                fileSent += (long long) read;
+            }
+
+#endif
+
+            if (trailerSent < trailerLength) {
+                this->write(trailer, trailerLength, (int) trailerSent, trailerLength - (int) trailerSent);
+            }
+
+        } catch (...) {
+            apr_file_close(file);
+            throw;
+        }
+
+        apr_file_close(file);
+    }
+    DECAF_CATCH_RETHROW(IOException)
+    DECAF_CATCH_RETHROW(IndexOutOfBoundsException)
+    DECAF_CATCHALL_THROW(IOException)
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 bool TcpSocket::isConnected() const {
     return this->impl->connected;
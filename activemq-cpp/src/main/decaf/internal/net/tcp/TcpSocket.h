@@ -27,6 +27,7 @@
 #include <decaf/net/SocketTimeoutException.h>
 #include <decaf/lang/exceptions/NullPointerException.h>
 #include <decaf/lang/exceptions/IndexOutOfBoundsException.h>
+#include <string>
 
 namespace decaf {
 namespace internal {
@@ -184,6 +185,37 @@ namespace tcp {
          */
         void write(const unsigned char* buffer, int size, int offset, int length);
 
+        /**
+         * Writes a region of a file to the Socket, optionally surrounded by a header and
+         * a trailer taken from memory.  Where the platform supports it the file bytes are
+         * handed to the kernel with sendfile and never pass through user space, otherwise
+         * they are read in chunks and written with write().
+         *
+         * @param path
+         *      The file whose contents are to be sent.
+         * @param position
+         *      The offset into the file of the first byte to send.
+         * @param length
+         *      The number of bytes of the file to send.
+         * @param header
+         *      Bytes written before the file region, may be NULL if headerLength is zero.
+         * @param headerLength
+         *      The number of header bytes.
+         * @param trailer
+         *      Bytes written after the file region, may be NULL if trailerLength is zero.
+         * @param trailerLength
+         *      The number of trailer bytes.
+         *
+         * @throw IOException if the file cannot be read or an I/O error occurs during the write.
+         * @throw IndexOutOfBoundsException if position, length or the header and trailer
+         *        lengths are negative.
+         *
+         * @since 3.8.0
+         */
+        void sendFile(const std::string& path, long long position, long long length,
+                      const unsigned char* header, int headerLength,
+                      const unsigned char* trailer, int trailerLength);
+
     protected:
 
         void checkResult(apr_status_t value) const;
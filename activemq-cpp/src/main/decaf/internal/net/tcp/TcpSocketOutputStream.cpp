@@ -62,6 +62,25 @@ void TcpSocketOutputStream::close() {
     DECAF_CATCHALL_THROW(IOException)
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void TcpSocketOutputStream::sendFile(const std::string& path, long long position, long long length,
+                                     const unsigned char* header, int headerLength,
+                                     const unsigned char* trailer, int trailerLength) {
+
+    try {
+
+        if (closed) {
+            throw IOException(__FILE__, __LINE__,
+                "TcpSocketOutputStream::sendFile - This Stream has been closed.");
+        }
+
+        this->socket->sendFile(path, position, length, header, headerLength, trailer, trailerLength);
+    }
+    DECAF_CATCH_RETHROW(IOException)
+    DECAF_CATCH_RETHROW(IndexOutOfBoundsException)
+    DECAF_CATCHALL_THROW(IOException)
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void TcpSocketOutputStream::doWriteByte(unsigned char c) {
 
@@ -22,6 +22,8 @@
 
 #include <decaf/io/OutputStream.h>
 
+#include <string>
+
 namespace decaf {
 namespace internal {
 namespace net {
@@ -59,6 +61,35 @@ namespace tcp {
 
         virtual void close();
 
+        /**
+         * Writes a header, a region of a file and a trailer to the socket.  The file bytes
+         * are sent by the kernel where the platform supports sendfile, any data buffered
+         * by streams layered over this one must be flushed first.
+         *
+         * @param path
+         *      The file whose contents are to be sent.
+         * @param position
+         *      The offset into the file of the first byte to send.
+         * @param length
+         *      The number of bytes of the file to send.
+         * @param header
+         *      Bytes written before the file region.
+         * @param headerLength
+         *      The number of header bytes.
+         * @param trailer
+         *      Bytes written after the file region.
+         * @param trailerLength
+         *      The number of trailer bytes.
+         *
+         * @throw IOException if the stream is closed or an I/O error occurs.
+         * @throw IndexOutOfBoundsException if any of the lengths are invalid.
+         *
+         * @since 3.8.0
+         */
+        void sendFile(const std::string& path, long long position, long long length,
+                      const unsigned char* header, int headerLength,
+                      const unsigned char* trailer, int trailerLength);
+
     protected:
 
         virtual void doWriteByte(unsigned char c);
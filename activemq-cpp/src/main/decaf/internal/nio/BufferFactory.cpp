@@ -18,6 +18,8 @@
 #include "BufferFactory.h"
 
 #include <decaf/internal/nio/ByteArrayBuffer.h>
+#include <decaf/internal/nio/DirectByteArrayAdapter.h>
+#include <decaf/lang/exceptions/UnsupportedOperationException.h>
 #include <decaf/internal/nio/CharArrayBuffer.h>
 #include <decaf/internal/nio/DoubleArrayBuffer.h>
 #include <decaf/internal/nio/FloatArrayBuffer.h>
@@ -64,6 +66,33 @@ ByteBuffer* BufferFactory::createByteBuffer( std::vector<unsigned char>& buffer
     DECAF_CATCHALL_THROW( Exception )
 }
 
+////////////////////////////////////////////////////////////////////////////////
+ByteBuffer* BufferFactory::createDirectByteBuffer( int capacity ) {
+
+    try{
+        Pointer<ByteArrayAdapter> memory( new DirectByteArrayAdapter( capacity ) );
+        return new ByteArrayBuffer( memory, 0, capacity );
+    }
+    DECAF_CATCH_RETHROW( IllegalArgumentException )
+    DECAF_CATCH_EXCEPTION_CONVERT( Exception, IllegalArgumentException )
+    DECAF_CATCHALL_THROW( IllegalArgumentException )
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MappedByteBuffer* BufferFactory::createMappedByteBuffer( const std::string& path,
+                                                         MappedByteBuffer::MapMode mode,
+                                                         long long position, int size ) {
+
+    try{
+        return MappedByteBuffer::map( path, mode, position, size );
+    }
+    DECAF_CATCH_RETHROW( IllegalArgumentException )
+    DECAF_CATCH_RETHROW( decaf::io::IOException )
+    DECAF_CATCH_RETHROW( UnsupportedOperationException )
+    DECAF_CATCH_EXCEPTION_CONVERT( Exception, decaf::io::IOException )
+    DECAF_CATCHALL_THROW( decaf::io::IOException )
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 CharBuffer* BufferFactory::createCharBuffer( int capacity ) {
 
@@ -25,6 +25,7 @@
 #include <decaf/nio/LongBuffer.h>
 #include <decaf/nio/IntBuffer.h>
 #include <decaf/nio/ShortBuffer.h>
+#include <decaf/internal/nio/MappedByteBuffer.h>
 
 #include <decaf/lang/exceptions/IndexOutOfBoundsException.h>
 
@@ -99,6 +100,46 @@ namespace nio{
          */
         static decaf::nio::ByteBuffer* createByteBuffer( std::vector<unsigned char>& buffer );
 
+        /**
+         * Allocates a new direct byte buffer backed by memory from the DirectMemoryPool
+         * whose position will be zero its limit will be its capacity and its mark is
+         * not set.
+         *
+         * @param capacity
+         *      The internal buffer's capacity.
+         *
+         * @returns a newly allocated direct ByteBuffer which the caller owns.
+         *
+         * @throws IllegalArgumentException if the capacity specified is negative.
+         *
+         * @since 3.8.0
+         */
+        static decaf::nio::ByteBuffer* createDirectByteBuffer( int capacity );
+
+        /**
+         * Maps a region of a file into a new direct byte buffer whose position will be
+         * zero its limit will be its capacity and its mark is not set.
+         *
+         * @param path
+         *      The file to map.
+         * @param mode
+         *      How the mapping may be accessed.
+         * @param position
+         *      The offset in the file where the region starts.
+         * @param size
+         *      The size of the region, this becomes the buffer's capacity.
+         *
+         * @returns a new MappedByteBuffer which the caller owns.
+         *
+         * @throws IllegalArgumentException if position or size is negative.
+         * @throws IOException if the file cannot be mapped.
+         *
+         * @since 3.8.0
+         */
+        static MappedByteBuffer* createMappedByteBuffer( const std::string& path,
+                                                         MappedByteBuffer::MapMode mode,
+                                                         long long position, int size );
+
         /**
          * Allocates a new char buffer whose position will be zero its limit will
          * be its capacity and its mark is not set.
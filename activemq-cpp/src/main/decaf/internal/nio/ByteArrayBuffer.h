@@ -209,6 +209,13 @@ namespace nio{
          */
         virtual bool hasArray() const { return true; }
 
+        /**
+         * {@inheritDoc}
+         */
+        virtual bool isDirect() const {
+            return this->_array->isDirect();
+        }
+
     public:   // Abstract Methods
 
         /**
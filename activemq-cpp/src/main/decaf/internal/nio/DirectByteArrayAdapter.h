@@ -0,0 +1,63 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _DECAF_INTERNAL_NIO_DIRECTBYTEARRAYADAPTER_H_
+#define _DECAF_INTERNAL_NIO_DIRECTBYTEARRAYADAPTER_H_
+
+#include <decaf/util/Config.h>
+#include <decaf/internal/util/ByteArrayAdapter.h>
+
+namespace decaf {
+namespace internal {
+namespace nio {
+
+    /**
+     * A ByteArrayAdapter whose memory comes from the DirectMemoryPool, the memory
+     * is returned to the pool when the last buffer that shares this adapter is
+     * destroyed.
+     *
+     * @since 3.8.0
+     */
+    class DECAF_API DirectByteArrayAdapter : public decaf::internal::util::ByteArrayAdapter {
+    private:
+
+        DirectByteArrayAdapter(const DirectByteArrayAdapter&);
+        DirectByteArrayAdapter& operator=(const DirectByteArrayAdapter&);
+
+    public:
+
+        /**
+         * Creates a zero filled adapter of the given capacity.
+         *
+         * @param capacity
+         *      The size of the memory block in bytes.
+         *
+         * @throws IllegalArgumentException if capacity is negative.
+         */
+        DirectByteArrayAdapter(int capacity);
+
+        virtual ~DirectByteArrayAdapter();
+
+        virtual bool isDirect() const {
+            return true;
+        }
+
+    };
+
+}}}
+
+#endif /* _DECAF_INTERNAL_NIO_DIRECTBYTEARRAYADAPTER_H_ */
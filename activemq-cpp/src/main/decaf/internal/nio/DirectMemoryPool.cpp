@@ -0,0 +1,195 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DirectMemoryPool.h"
+
+#include <decaf/lang/Thread.h>
+#include <decaf/lang/exceptions/IllegalArgumentException.h>
+#include <decaf/lang/exceptions/OutOfMemoryError.h>
+#include <decaf/internal/util/concurrent/Atomics.h>
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace decaf;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::internal;
+using namespace decaf::internal::nio;
+using namespace decaf::internal::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+const int DirectMemoryPool::ALIGNMENT = 64;
+const int DirectMemoryPool::MIN_POOLED_SIZE = 4096;
+const int DirectMemoryPool::MAX_POOLED_SIZE = 1024 * 1024;
+const int DirectMemoryPool::MAX_CACHED_BLOCKS = 16;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    // One size class per power of two from MIN_POOLED_SIZE to MAX_POOLED_SIZE.
+    const int SIZE_CLASSES = 9;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    // Plain zero initialized statics so the pool is usable before and after the
+    // decaf Runtime is initialized, a spin lock guards them since the critical
+    // sections are only a few instructions long.
+    volatile int poolLock;
+    FreeBlock* freeLists[SIZE_CLASSES];
+    int freeCounts[SIZE_CLASSES];
+
+    void lock() {
+        while (!Atomics::compareAndSet32(&poolLock, 0, 1)) {
+            Thread::yield();
+        }
+    }
+
+    void unlock() {
+        Atomics::getAndSet(&poolLock, 0);
+    }
+
+    int sizeClass(int size) {
+        if (size > DirectMemoryPool::MAX_POOLED_SIZE) {
+            return -1;
+        }
+
+        int index = 0;
+        for (int classSize = DirectMemoryPool::MIN_POOLED_SIZE; classSize < size; classSize <<= 1) {
+            index++;
+        }
+
+        return index;
+    }
+
+    // The pointer returned by malloc is stored just in front of the aligned block.
+    unsigned char* systemAllocate(int size) {
+        void* raw = ::malloc((size_t) size + DirectMemoryPool::ALIGNMENT + sizeof(void*));
+        if (raw == NULL) {
+            return NULL;
+        }
+
+        size_t address = (size_t) raw + sizeof(void*);
+        address = (address + DirectMemoryPool::ALIGNMENT - 1) & ~((size_t) DirectMemoryPool::ALIGNMENT - 1);
+
+        ((void**) address)[-1] = raw;
+        return (unsigned char*) address;
+    }
+
+    void systemFree(unsigned char* block) {
+        ::free(((void**) block)[-1]);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned char* DirectMemoryPool::allocate(int size) {
+
+    if (size < 0) {
+        throw IllegalArgumentException(__FILE__, __LINE__, "Direct buffer size cannot be negative: %d", size);
+    }
+
+    int index = sizeClass(size);
+    unsigned char* block = NULL;
+
+    if (index >= 0) {
+        lock();
+        FreeBlock* head = freeLists[index];
+        if (head != NULL) {
+            freeLists[index] = head->next;
+            freeCounts[index]--;
+        }
+        unlock();
+
+        block = (unsigned char*) head;
+        if (block == NULL) {
+            block = systemAllocate(MIN_POOLED_SIZE << index);
+        }
+    } else {
+        block = systemAllocate(size);
+    }
+
+    if (block == NULL) {
+        throw OutOfMemoryError(__FILE__, __LINE__, "Cannot allocate a direct buffer of %d bytes", size);
+    }
+
+    ::memset(block, 0, (size_t) size);
+    return block;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DirectMemoryPool::release(unsigned char* block, int size) {
+
+    if (block == NULL) {
+        return;
+    }
+
+    int index = sizeClass(size);
+
+    if (index >= 0) {
+        lock();
+        if (freeCounts[index] < MAX_CACHED_BLOCKS) {
+            FreeBlock* entry = (FreeBlock*) block;
+            entry->next = freeLists[index];
+            freeLists[index] = entry;
+            freeCounts[index]++;
+            block = NULL;
+        }
+        unlock();
+    }
+
+    if (block != NULL) {
+        systemFree(block);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int DirectMemoryPool::getCachedBlockCount() {
+
+    int count = 0;
+
+    lock();
+    for (int i = 0; i < SIZE_CLASSES; ++i) {
+        count += freeCounts[i];
+    }
+    unlock();
+
+    return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DirectMemoryPool::purge() {
+
+    FreeBlock* blocks[SIZE_CLASSES];
+
+    lock();
+    for (int i = 0; i < SIZE_CLASSES; ++i) {
+        blocks[i] = freeLists[i];
+        freeLists[i] = NULL;
+        freeCounts[i] = 0;
+    }
+    unlock();
+
+    for (int i = 0; i < SIZE_CLASSES; ++i) {
+        while (blocks[i] != NULL) {
+            FreeBlock* next = blocks[i]->next;
+            systemFree((unsigned char*) blocks[i]);
+            blocks[i] = next;
+        }
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _DECAF_INTERNAL_NIO_DIRECTMEMORYPOOL_H_
+#define _DECAF_INTERNAL_NIO_DIRECTMEMORYPOOL_H_
+
+#include <decaf/util/Config.h>
+
+namespace decaf {
+namespace internal {
+namespace nio {
+
+    /**
+     * Process wide allocator for the memory that backs direct ByteBuffers.  Every block
+     * is aligned to ALIGNMENT bytes.  Blocks between MIN_POOLED_SIZE and MAX_POOLED_SIZE
+     * are rounded up to a power of two and kept on a free list when released so that
+     * buffers that are created and destroyed for each message reuse the same memory,
+     * larger blocks always go back to the system.
+     *
+     * @since 3.8.0
+     */
+    class DECAF_API DirectMemoryPool {
+    private:
+
+        DirectMemoryPool();
+        DirectMemoryPool(const DirectMemoryPool&);
+        DirectMemoryPool& operator=(const DirectMemoryPool&);
+
+    public:
+
+        static const int ALIGNMENT;
+        static const int MIN_POOLED_SIZE;
+        static const int MAX_POOLED_SIZE;
+        static const int MAX_CACHED_BLOCKS;
+
+    public:
+
+        /**
+         * Allocates a zero filled block that is at least size bytes long.
+         *
+         * @param size
+         *      The number of bytes needed.
+         *
+         * @return the aligned block, which must be given back with release.
+         *
+         * @throws IllegalArgumentException if size is negative.
+         * @throws OutOfMemoryError if the memory cannot be allocated.
+         */
+        static unsigned char* allocate(int size);
+
+        /**
+         * Returns a block to the pool.
+         *
+         * @param block
+         *      The block returned from allocate, NULL is ignored.
+         * @param size
+         *      The size that was passed to allocate.
+         */
+        static void release(unsigned char* block, int size);
+
+        /**
+         * @return the number of released blocks currently held for reuse.
+         */
+        static int getCachedBlockCount();
+
+        /**
+         * Frees every block held for reuse.
+         */
+        static void purge();
+
+    };
+
+}}}
+
+#endif /* _DECAF_INTERNAL_NIO_DIRECTMEMORYPOOL_H_ */
@@ -0,0 +1,232 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MappedByteBuffer.h"
+
+#include <decaf/lang/Integer.h>
+#include <decaf/lang/exceptions/IllegalArgumentException.h>
+#include <decaf/lang/exceptions/UnsupportedOperationException.h>
+
+#if HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#if HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#if HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+
+#if HAVE_SYS_MMAN_H && HAVE_FCNTL_H && HAVE_UNISTD_H && HAVE_SYS_STAT_H
+#define DECAF_NIO_USE_MMAP
+#endif
+
+using namespace decaf;
+using namespace decaf::io;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::internal;
+using namespace decaf::internal::nio;
+using namespace decaf::internal::util;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    /**
+     * Owns a mapping, it is unmapped once the last buffer sharing it is destroyed.
+     */
+    class MappedRegion : public ByteArrayAdapter {
+    private:
+
+        void* address;
+        long long length;
+
+    private:
+
+        MappedRegion(const MappedRegion&);
+        MappedRegion& operator=(const MappedRegion&);
+
+    public:
+
+        MappedRegion(void* address, long long length) :
+            ByteArrayAdapter((unsigned char*) address, (int) length, false), address(address), length(length) {
+        }
+
+        virtual ~MappedRegion() {
+#ifdef DECAF_NIO_USE_MMAP
+            munmap(this->address, (size_t) this->length);
+#endif
+        }
+
+        virtual bool isDirect() const {
+            return true;
+        }
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MappedByteBuffer::MappedByteBuffer(const Pointer<ByteArrayAdapter>& region, int offset, int size,
+                                   void* address, long long length, MapMode mode) :
+    ByteArrayBuffer(region, offset, size, mode == READ_ONLY),
+    address(address), length(length), mode(mode), loaded(false) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MappedByteBuffer::~MappedByteBuffer() {
+}
+
+#ifdef DECAF_NIO_USE_MMAP
+
+////////////////////////////////////////////////////////////////////////////////
+MappedByteBuffer* MappedByteBuffer::map(const std::string& path, MapMode mode, long long position, int size) {
+
+    if (position < 0) {
+        throw IllegalArgumentException(__FILE__, __LINE__, "Map position cannot be negative: %lld", position);
+    }
+
+    if (size < 0) {
+        throw IllegalArgumentException(__FILE__, __LINE__, "Map size cannot be negative: %d", size);
+    }
+
+    // The mapping has to start on a page boundary, the buffer starts part way in.
+    long long pageSize = (long long) sysconf(_SC_PAGESIZE);
+    long long base = position - (position % pageSize);
+    int offset = (int) (position - base);
+    long long length = (long long) offset + size;
+
+    // The whole mapping is held in a single array.
+    if (length > Integer::MAX_VALUE) {
+        throw IllegalArgumentException(__FILE__, __LINE__,
+            "Map size %d at position %lld is too large to map", size, position);
+    }
+
+    int fd = ::open(path.c_str(), mode == READ_WRITE ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    if (fd < 0) {
+        throw IOException(__FILE__, __LINE__, "Cannot open %s: %s", path.c_str(), strerror(errno));
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw IOException(__FILE__, __LINE__, "Cannot stat %s: %s", path.c_str(), strerror(error));
+    }
+
+    long long end = position + size;
+    if ((long long) status.st_size < end) {
+        if (mode != READ_WRITE) {
+            ::close(fd);
+            throw IOException(__FILE__, __LINE__, "Region %lld-%lld lies beyond the end of %s",
+                              position, end, path.c_str());
+        }
+
+        if (ftruncate(fd, (off_t) end) != 0) {
+            int error = errno;
+            ::close(fd);
+            throw IOException(__FILE__, __LINE__, "Cannot extend %s: %s", path.c_str(), strerror(error));
+        }
+    }
+
+    void* address = NULL;
+    if (length > 0) {
+        int protection = mode == READ_ONLY ? PROT_READ : PROT_READ | PROT_WRITE;
+        int flags = mode == PRIVATE ? MAP_PRIVATE : MAP_SHARED;
+
+        address = mmap(NULL, (size_t) length, protection, flags, fd, (off_t) base);
+    }
+
+    int error = errno;
+    ::close(fd);
+
+    if (address == MAP_FAILED) {
+        throw IOException(__FILE__, __LINE__, "Cannot map %s: %s", path.c_str(), strerror(error));
+    }
+
+    Pointer<ByteArrayAdapter> region;
+    if (address == NULL) {
+        region.reset(new ByteArrayAdapter(0));
+    } else {
+        try {
+            region.reset(new MappedRegion(address, length));
+        } catch (...) {
+            munmap(address, (size_t) length);
+            throw;
+        }
+    }
+
+    return new MappedByteBuffer(region, offset, size, address, length, mode);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MappedByteBuffer& MappedByteBuffer::force() {
+
+    if (this->mode == READ_WRITE && this->address != NULL) {
+        if (msync(this->address, (size_t) this->length, MS_SYNC) != 0) {
+            throw IOException(__FILE__, __LINE__, "Cannot synchronize mapped region: %s", strerror(errno));
+        }
+    }
+
+    return *this;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MappedByteBuffer& MappedByteBuffer::load() {
+
+    if (this->address != NULL) {
+
+        madvise(this->address, (size_t) this->length, MADV_WILLNEED);
+
+        // Reading one byte from each page faults it in.
+        long long pageSize = (long long) sysconf(_SC_PAGESIZE);
+        volatile unsigned char* bytes = (volatile unsigned char*) this->address;
+        unsigned char sum = 0;
+        for (long long i = 0; i < this->length; i += pageSize) {
+            sum = (unsigned char) (sum + bytes[i]);
+        }
+        (void) sum;
+    }
+
+    this->loaded = true;
+    return *this;
+}
+
+#else
+
+////////////////////////////////////////////////////////////////////////////////
+MappedByteBuffer* MappedByteBuffer::map(const std::string& path DECAF_UNUSED, MapMode mode DECAF_UNUSED,
+                                        long long position DECAF_UNUSED, int size DECAF_UNUSED) {
+    throw UnsupportedOperationException(__FILE__, __LINE__, "Memory mapped files are not supported on this platform");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MappedByteBuffer& MappedByteBuffer::force() {
+    return *this;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MappedByteBuffer& MappedByteBuffer::load() {
+    this->loaded = true;
+    return *this;
+}
+
+#endif
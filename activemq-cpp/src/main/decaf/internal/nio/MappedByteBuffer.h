@@ -0,0 +1,132 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _DECAF_INTERNAL_NIO_MAPPEDBYTEBUFFER_H_
+#define _DECAF_INTERNAL_NIO_MAPPEDBYTEBUFFER_H_
+
+#include <decaf/util/Config.h>
+#include <decaf/internal/nio/ByteArrayBuffer.h>
+#include <decaf/io/IOException.h>
+
+#include <string>
+
+namespace decaf {
+namespace internal {
+namespace nio {
+
+    /**
+     * A direct ByteBuffer whose content is a memory mapped region of a file.  The
+     * mapping stays valid until this buffer and every buffer created from it by
+     * duplicate, slice or asReadOnlyBuffer have been destroyed.
+     *
+     * In READ_WRITE mode changes are written through to the file, in PRIVATE mode
+     * they are only visible to this process and in READ_ONLY mode the buffer can't
+     * be written to.  A PRIVATE mapping gives writable access to the file's bytes
+     * through array() without copying them, for example to hand a file to a socket
+     * stream as one contiguous block.
+     *
+     * @since 3.8.0
+     */
+    class DECAF_API MappedByteBuffer : public ByteArrayBuffer {
+    public:
+
+        enum MapMode {
+            READ_ONLY,
+            READ_WRITE,
+            PRIVATE
+        };
+
+    private:
+
+        // Page aligned start and length of the whole mapping, the buffer's content
+        // may begin part way into the first page.
+        void* address;
+        long long length;
+        MapMode mode;
+        bool loaded;
+
+    private:
+
+        MappedByteBuffer(const decaf::lang::Pointer<decaf::internal::util::ByteArrayAdapter>& region,
+                         int offset, int size, void* address, long long length, MapMode mode);
+
+        MappedByteBuffer(const MappedByteBuffer&);
+        MappedByteBuffer& operator=(const MappedByteBuffer&);
+
+    public:
+
+        virtual ~MappedByteBuffer();
+
+        /**
+         * Maps a region of a file into memory.  In READ_WRITE mode the file is created
+         * and extended as needed, in the other modes the region must lie within the
+         * file.
+         *
+         * @param path
+         *      The file to map.
+         * @param mode
+         *      How the mapping may be accessed.
+         * @param position
+         *      The offset in the file where the region starts.
+         * @param size
+         *      The size of the region.
+         *
+         * @return a new buffer over the region, the caller owns it.
+         *
+         * @throws IllegalArgumentException if position or size is negative, or the region
+         *         together with its offset into the first page exceeds Integer::MAX_VALUE.
+         * @throws IOException if the file cannot be opened, sized or mapped.
+         * @throws UnsupportedOperationException if the platform can't map files.
+         */
+        static MappedByteBuffer* map(const std::string& path, MapMode mode, long long position, int size);
+
+        /**
+         * @return the mode the region was mapped with.
+         */
+        MapMode getMapMode() const {
+            return this->mode;
+        }
+
+        /**
+         * Touches every page of the region so that later reads don't fault.
+         *
+         * @return a reference to this buffer.
+         */
+        MappedByteBuffer& load();
+
+        /**
+         * @return true if load has been called, a hint that the content is resident.
+         */
+        bool isLoaded() const {
+            return this->loaded;
+        }
+
+        /**
+         * Writes any changes made to a READ_WRITE buffer through to the file, for the
+         * other modes this does nothing.
+         *
+         * @return a reference to this buffer.
+         *
+         * @throws IOException if the region could not be synchronized.
+         */
+        MappedByteBuffer& force();
+
+    };
+
+}}}
+
+#endif /* _DECAF_INTERNAL_NIO_MAPPEDBYTEBUFFER_H_ */
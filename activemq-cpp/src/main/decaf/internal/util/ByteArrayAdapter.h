@@ -192,6 +192,16 @@ namespace util {
 
         virtual ~ByteArrayAdapter();
 
+        /**
+         * @return true if the wrapped memory lives outside the normal heap, such as
+         *         memory from the direct buffer pool or a mapped file.
+         *
+         * @since 3.8.0
+         */
+        virtual bool isDirect() const {
+            return false;
+        }
+
         /**
          * Gets the size of the underlying array.
          * @return the size the array.
@@ -0,0 +1,292 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ModifiedUTF8.h"
+
+#include <decaf/io/UTFDataFormatException.h>
+
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DECAF_MODIFIEDUTF8_SSE2
+#endif
+
+using namespace decaf;
+using namespace decaf::io;
+using namespace decaf::internal;
+using namespace decaf::internal::util;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    // Bytes 0x01 to 0x7F encode as themselves, everything else takes two bytes.
+    inline bool isSingleByte(unsigned char value) {
+        return (unsigned char) (value - 1) < 0x7F;
+    }
+
+#if defined(__AVX2__)
+
+    const std::size_t BLOCK_SIZE = 32;
+
+    inline __m256i singleByteMask(const unsigned char* bytes) {
+        __m256i block = _mm256_loadu_si256((const __m256i*) bytes);
+        return _mm256_cmpgt_epi8(block, _mm256_setzero_si256());
+    }
+
+    inline bool isSingleByteBlock(const unsigned char* bytes) {
+        return _mm256_movemask_epi8(singleByteMask(bytes)) == -1;
+    }
+
+    inline bool isAsciiBlock(const unsigned char* bytes) {
+        return _mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*) bytes)) == 0;
+    }
+
+    std::size_t countMultiByteBlocks(const unsigned char* bytes, std::size_t blocks) {
+
+        const __m256i zero = _mm256_setzero_si256();
+        std::size_t count = 0;
+
+        while (blocks > 0) {
+
+            // Byte lanes count up to 255 before they have to be folded into the total.
+            std::size_t chunk = blocks < 255 ? blocks : 255;
+            __m256i lanes = zero;
+
+            for (std::size_t i = 0; i < chunk; ++i, bytes += BLOCK_SIZE) {
+                lanes = _mm256_sub_epi8(lanes, _mm256_cmpeq_epi8(singleByteMask(bytes), zero));
+            }
+
+            __m256i sums = _mm256_sad_epu8(lanes, zero);
+            __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+            count += (std::size_t) _mm_cvtsi128_si32(half) + (std::size_t) _mm_cvtsi128_si32(_mm_srli_si128(half, 8));
+            blocks -= chunk;
+        }
+
+        return count;
+    }
+
+#elif defined(DECAF_MODIFIEDUTF8_SSE2)
+
+    const std::size_t BLOCK_SIZE = 16;
+
+    inline __m128i singleByteMask(const unsigned char* bytes) {
+        __m128i block = _mm_loadu_si128((const __m128i*) bytes);
+        return _mm_cmpgt_epi8(block, _mm_setzero_si128());
+    }
+
+    inline bool isSingleByteBlock(const unsigned char* bytes) {
+        return _mm_movemask_epi8(singleByteMask(bytes)) == 0xFFFF;
+    }
+
+    inline bool isAsciiBlock(const unsigned char* bytes) {
+        return _mm_movemask_epi8(_mm_loadu_si128((const __m128i*) bytes)) == 0;
+    }
+
+    std::size_t countMultiByteBlocks(const unsigned char* bytes, std::size_t blocks) {
+
+        const __m128i zero = _mm_setzero_si128();
+        std::size_t count = 0;
+
+        while (blocks > 0) {
+
+            // Byte lanes count up to 255 before they have to be folded into the total.
+            std::size_t chunk = blocks < 255 ? blocks : 255;
+            __m128i lanes = zero;
+
+            for (std::size_t i = 0; i < chunk; ++i, bytes += BLOCK_SIZE) {
+                lanes = _mm_sub_epi8(lanes, _mm_cmpeq_epi8(singleByteMask(bytes), zero));
+            }
+
+            __m128i sums = _mm_sad_epu8(lanes, zero);
+            count += (std::size_t) _mm_cvtsi128_si32(sums) + (std::size_t) _mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+            blocks -= chunk;
+        }
+
+        return count;
+    }
+
+#else
+
+    const std::size_t BLOCK_SIZE = 8;
+
+    const unsigned long long LOW_BITS = 0x0101010101010101ULL;
+    const unsigned long long HIGH_BITS = 0x8080808080808080ULL;
+
+    inline unsigned long long loadWord(const unsigned char* bytes) {
+        unsigned long long word;
+        ::memcpy(&word, bytes, sizeof(word));
+        return word;
+    }
+
+    inline bool isSingleByteBlock(const unsigned char* bytes) {
+        unsigned long long word = loadWord(bytes);
+        // Non zero when any byte has its high bit set or is zero.
+        return ((word | ((word - LOW_BITS) & ~word)) & HIGH_BITS) == 0;
+    }
+
+    inline bool isAsciiBlock(const unsigned char* bytes) {
+        return (loadWord(bytes) & HIGH_BITS) == 0;
+    }
+
+    std::size_t countMultiByteBlocks(const unsigned char* bytes, std::size_t blocks) {
+
+        std::size_t count = 0;
+
+        for (std::size_t i = 0; i < blocks; ++i, bytes += BLOCK_SIZE) {
+            if (!isSingleByteBlock(bytes)) {
+                for (std::size_t j = 0; j < BLOCK_SIZE; ++j) {
+                    count += isSingleByte(bytes[j]) ? 0 : 1;
+                }
+            }
+        }
+
+        return count;
+    }
+
+#endif
+
+    std::size_t singleByteRun(const unsigned char* bytes, std::size_t length) {
+
+        std::size_t index = 0;
+
+        while (length - index >= BLOCK_SIZE && isSingleByteBlock(bytes + index)) {
+            index += BLOCK_SIZE;
+        }
+        while (index < length && isSingleByte(bytes[index])) {
+            index++;
+        }
+
+        return index;
+    }
+
+    std::size_t asciiRun(const unsigned char* bytes, std::size_t length) {
+
+        std::size_t index = 0;
+
+        while (length - index >= BLOCK_SIZE && isAsciiBlock(bytes + index)) {
+            index += BLOCK_SIZE;
+        }
+        while (index < length && bytes[index] < 0x80) {
+            index++;
+        }
+
+        return index;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::size_t ModifiedUTF8::encodedLength(const char* value, std::size_t length) {
+
+    const unsigned char* bytes = (const unsigned char*) value;
+    std::size_t blocks = length / BLOCK_SIZE;
+    std::size_t count = length + countMultiByteBlocks(bytes, blocks);
+
+    for (std::size_t i = blocks * BLOCK_SIZE; i < length; ++i) {
+        count += isSingleByte(bytes[i]) ? 0 : 1;
+    }
+
+    return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::size_t ModifiedUTF8::encode(const char* value, std::size_t length, unsigned char* dest) {
+
+    const unsigned char* bytes = (const unsigned char*) value;
+    std::size_t index = 0;
+    std::size_t count = 0;
+
+    while (index < length) {
+
+        std::size_t run = singleByteRun(bytes + index, length - index);
+        if (run > 0) {
+            ::memcpy(dest + count, bytes + index, run);
+            index += run;
+            count += run;
+        }
+
+        while (index < length && !isSingleByte(bytes[index])) {
+            unsigned char charValue = bytes[index++];
+            dest[count++] = (unsigned char) (0xc0 | (0x1f & (charValue >> 6)));
+            dest[count++] = (unsigned char) (0x80 | (0x3f & charValue));
+        }
+    }
+
+    return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::size_t ModifiedUTF8::decode(const unsigned char* bytes, std::size_t length, char* dest) {
+
+    std::size_t count = 0;
+    std::size_t index = 0;
+
+    while (count < length) {
+
+        std::size_t run = asciiRun(bytes + count, length - count);
+        if (run > 0) {
+            if ((const unsigned char*) dest + index != bytes + count) {
+                ::memmove(dest + index, bytes + count, run);
+            }
+            index += run;
+            count += run;
+
+            if (count == length) {
+                break;
+            }
+        }
+
+        unsigned char a = bytes[count++];
+
+        if ((a & 0xE0) == 0xC0) {
+            if (count >= length) {
+                throw UTFDataFormatException(__FILE__, __LINE__, "Invalid UTF-8 encoding found, start of two byte char found at end.");
+            }
+
+            unsigned char b = bytes[count++];
+            if ((b & 0xC0) != 0x80) {
+                throw UTFDataFormatException(__FILE__, __LINE__, "Invalid UTF-8 encoding found, byte two does not start with 0x80.");
+            }
+
+            // 2-byte UTF8 encoding: 110X XXxx 10xx xxxx
+            // Bits set at 'X' means we have encountered a UTF8 encoded value
+            // greater than 255, which is not supported.
+            if (a & 0x1C) {
+                throw UTFDataFormatException(__FILE__, __LINE__, "Invalid 2 byte UTF-8 encoding found, "
+                        "This method only supports encoded ASCII values of (0-255).");
+            }
+
+            dest[index++] = (char) (((a & 0x1F) << 6) | (b & 0x3F));
+
+        } else if ((a & 0xF0) == 0xE0) {
+
+            if (count + 1 >= length) {
+                throw UTFDataFormatException(__FILE__, __LINE__, "Invalid UTF-8 encoding found, start of three byte char found at end.");
+            } else {
+                throw UTFDataFormatException(__FILE__, __LINE__, "Invalid 3 byte UTF-8 encoding found, "
+                        "This method only supports encoded ASCII values of (0-255).");
+            }
+
+        } else {
+            throw UTFDataFormatException(__FILE__, __LINE__, "Invalid UTF-8 encoding found, aborting.");
+        }
+    }
+
+    return index;
+}
@@ -0,0 +1,105 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _DECAF_INTERNAL_UTIL_MODIFIEDUTF8_H_
+#define _DECAF_INTERNAL_UTIL_MODIFIEDUTF8_H_
+
+#include <decaf/util/Config.h>
+
+#include <cstddef>
+
+namespace decaf {
+namespace internal {
+namespace util {
+
+    /**
+     * Encoding and decoding of the modified UTF-8 format used by DataInput and DataOutput
+     * for single byte strings.
+     *
+     * Every byte in the range 0x01 to 0x7F is stored as is, every other byte value is stored
+     * as a two byte sequence.  Strings on the wire are almost always plain ASCII so the scans
+     * for runs of single byte values are vectorized, with SSE2 or AVX2 when the compiler
+     * targets them and eight bytes at a time otherwise, and runs are copied as a block.
+     *
+     * @since 3.8.0
+     */
+    class DECAF_API ModifiedUTF8 {
+    private:
+
+        ModifiedUTF8(const ModifiedUTF8&);
+        ModifiedUTF8& operator= (const ModifiedUTF8&);
+
+    private:
+
+        ModifiedUTF8() {}
+
+    public:
+
+        virtual ~ModifiedUTF8() {}
+
+        /**
+         * Computes the number of bytes needed to encode the given characters.
+         *
+         * @param value
+         *      The characters to measure.
+         * @param length
+         *      The number of characters in value.
+         *
+         * @returns the encoded length, which equals length only when every character is
+         *          stored as a single byte.
+         */
+        static std::size_t encodedLength(const char* value, std::size_t length);
+
+        /**
+         * Encodes the given characters into the destination array, which must have room
+         * for encodedLength(value, length) bytes.  Twice the input length is always enough.
+         *
+         * @param value
+         *      The characters to encode.
+         * @param length
+         *      The number of characters in value.
+         * @param dest
+         *      The array that receives the encoded bytes.
+         *
+         * @returns the number of bytes written to dest.
+         */
+        static std::size_t encode(const char* value, std::size_t length, unsigned char* dest);
+
+        /**
+         * Decodes the given bytes into the destination array, which must have room for
+         * length characters.  The destination may be the same array as the source, the
+         * decoded form is never longer than the encoded one.
+         *
+         * @param bytes
+         *      The encoded bytes.
+         * @param length
+         *      The number of encoded bytes.
+         * @param dest
+         *      The array that receives the decoded characters.
+         *
+         * @returns the number of characters written to dest.
+         *
+         * @throws UTFDataFormatException if the bytes are not a valid encoding or hold
+         *         characters that do not fit in a single byte.
+         */
+        static std::size_t decode(const unsigned char* bytes, std::size_t length, char* dest);
+
+    };
+
+}}}
+
+#endif /* _DECAF_INTERNAL_UTIL_MODIFIEDUTF8_H_ */
@@ -59,6 +59,9 @@ namespace concurrent {
         static int incrementAndGet(volatile int* target);
         static int decrementAndGet(volatile int* target);
 
+        static long long getAndAdd64(volatile long long* target, long long delta);
+        static long long get64(const volatile long long* target);
+
     private:
 
         static void initialize();
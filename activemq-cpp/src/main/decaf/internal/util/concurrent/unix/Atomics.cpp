@@ -251,3 +251,40 @@ int Atomics::decrementAndGet(volatile int* target) {
 #endif
 }
 
+////////////////////////////////////////////////////////////////////////////////
+long long Atomics::getAndAdd64(volatile long long* target, long long delta) {
+#ifdef HAVE_ATOMIC_BUILTINS
+    return __sync_fetch_and_add(target, delta);
+#elif defined(SOLARIS2) && SOLARIS2 >= 10
+    return (long long) atomic_add_64_nv((volatile uint64_t*)target, delta) - delta;
+#else
+    long long oldValue;
+    PlatformThread::lockMutex(atomicMutex);
+
+    oldValue = *target;
+    *target += delta;
+
+    PlatformThread::unlockMutex(atomicMutex);
+
+    return oldValue;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long Atomics::get64(const volatile long long* target) {
+#ifdef HAVE_ATOMIC_BUILTINS
+    return __sync_fetch_and_add(const_cast<volatile long long*>(target), 0);
+#elif defined(SOLARIS2) && SOLARIS2 >= 10
+    return (long long) atomic_add_64_nv((volatile uint64_t*)target, 0);
+#else
+    long long value;
+    PlatformThread::lockMutex(atomicMutex);
+
+    value = *target;
+
+    PlatformThread::unlockMutex(atomicMutex);
+
+    return value;
+#endif
+}
+
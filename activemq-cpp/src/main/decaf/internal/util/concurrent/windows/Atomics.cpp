@@ -79,3 +79,17 @@ int Atomics::decrementAndGet(volatile int* target) {
     return ::InterlockedExchangeAdd((volatile LONG*)target, 0xFFFFFFFF) - 1;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+long long Atomics::getAndAdd64(volatile long long* target, long long delta) {
+    LONGLONG oldValue;
+    do {
+        oldValue = *target;
+    } while (::InterlockedCompareExchange64((volatile LONGLONG*)target, oldValue + delta, oldValue) != oldValue);
+
+    return oldValue;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long Atomics::get64(const volatile long long* target) {
+    return ::InterlockedCompareExchange64((volatile LONGLONG*)target, 0, 0);
+}
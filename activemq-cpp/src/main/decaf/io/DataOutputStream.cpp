@@ -17,6 +17,7 @@
 
 #include <decaf/io/DataOutputStream.h>
 #include <decaf/io/UTFDataFormatException.h>
+#include <decaf/internal/util/ModifiedUTF8.h>
 #include <decaf/util/Config.h>
 #include <string.h>
 #include <stdio.h>
@@ -24,6 +25,7 @@
 using namespace decaf;
 using namespace decaf::io;
 using namespace decaf::util;
+using namespace decaf::internal::util;
 using namespace decaf::lang::exceptions;
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -273,6 +275,7 @@ void DataOutputStream::writeUTF(const std::string& value) {
 
     try {
 
+        std::size_t length = value.length();
         unsigned int utfLength = this->countUTFLength(value);
 
         if (utfLength > 65535) {
@@ -280,32 +283,24 @@ void DataOutputStream::writeUTF(const std::string& value) {
                     "than the supported 65535 bytes");
         }
 
-        std::size_t length = value.length();
-        std::vector<unsigned char> utfBytes((std::size_t) utfLength);
-        unsigned int utfIndex = 0;
-
-        for (std::size_t i = 0; i < length; i++) {
-
-            unsigned int charValue = (unsigned char) value.at(i);
-
-            // Written to allow for expansion to wide character strings at some
-            // point, as it stands now the value can never be > 255 since the
-            // string class returns a single byte char.
-            if (charValue > 0 && charValue <= 127) {
-                utfBytes[utfIndex++] = (unsigned char) charValue;
-            } else if (charValue <= 2047) {
-                utfBytes[utfIndex++] = (unsigned char) (0xc0 | (0x1f & (charValue >> 6)));
-                utfBytes[utfIndex++] = (unsigned char) (0x80 | (0x3f & charValue));
-            } else {
-                utfBytes[utfIndex++] = (unsigned char) (0xe0 | (0x0f & (charValue >> 12)));
-                utfBytes[utfIndex++] = (unsigned char) (0x80 | (0x3f & (charValue >> 6)));
-                utfBytes[utfIndex++] = (unsigned char) (0x80 | (0x3f & charValue));
+        this->writeUnsignedShort((unsigned short) utfLength);
+
+        if (utfLength == length) {
+            // Nothing to encode, the common case of a plain ASCII string.
+            if (length > 0) {
+                this->write((const unsigned char*) value.c_str(), (int) length, 0, (int) length);
             }
+            return;
         }
 
-        this->writeUnsignedShort((unsigned short) utfLength);
-        if (utfLength > 0) {
-            this->write(&utfBytes[0], utfIndex, 0, utfIndex);
+        // Encode in slices small enough for a stack buffer, each char needs at most two bytes.
+        unsigned char utfBytes[512];
+        const std::size_t sliceLength = sizeof(utfBytes) / 2;
+
+        for (std::size_t i = 0; i < length; i += sliceLength) {
+            std::size_t slice = length - i < sliceLength ? length - i : sliceLength;
+            int encoded = (int) ModifiedUTF8::encode(value.c_str() + i, slice, utfBytes);
+            this->write(utfBytes, encoded, 0, encoded);
         }
     }
     DECAF_CATCH_RETHROW(UTFDataFormatException)
@@ -315,25 +310,5 @@ void DataOutputStream::writeUTF(const std::string& value) {
 
 ////////////////////////////////////////////////////////////////////////////////
 unsigned int DataOutputStream::countUTFLength(const std::string& value) {
-
-    unsigned int utfCount = 0;
-    std::size_t length = value.length();
-
-    for (std::size_t i = 0; i < length; ++i) {
-
-        unsigned int charValue = (unsigned char) value.at(i);
-
-        // Written to allow for expansion to wide character strings at some
-        // point, as it stands now the value can never be > 255 since the
-        // string class returns a single byte char.
-        if (charValue > 0 && charValue <= 127) {
-            utfCount++;
-        } else if (charValue <= 2047) {
-            utfCount += 2;
-        } else {
-            utfCount += 3;
-        }
-    }
-
-    return utfCount;
+    return (unsigned int) ModifiedUTF8::encodedLength(value.c_str(), value.length());
 }
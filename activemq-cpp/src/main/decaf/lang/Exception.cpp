@@ -23,16 +23,53 @@
 #include <sstream>
 #include <apr_strings.h>
 
+#ifndef va_copy
+#ifdef __va_copy
+#define va_copy(dest, src) __va_copy(dest, src)
+#else
+#define va_copy(dest, src) ((dest) = (src))
+#endif
+#endif
+
+// For supporting older versions of msvc (<=2003)
+#if defined(_MSC_VER) && (_MSC_VER < 1400)
+#define vsnprintf _vsnprintf
+#endif
+
 using namespace std;
 using namespace decaf;
 using namespace decaf::internal;
 using namespace decaf::lang;
 using namespace decaf::util::logging;
 
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    // Formatted messages that fit are built on the stack rather than in an APR pool.
+    const int MESSAGE_BUFFER_SIZE = 256;
+}
+
 namespace decaf {
 namespace lang {
 
     class ExceptionData {
+    public:
+
+        /**
+         * A point in the code where the exception was created or marked, the file is
+         * a string of static lifetime such as __FILE__ so only the pointer is kept.
+         */
+        struct Mark {
+            const char* file;
+            int line;
+        };
+
+        /**
+         * Number of marks held without allocating, enough for the layers most
+         * exceptions pass through before they are handled.
+         */
+        static const int INLINE_MARKS = 8;
+
     public:
 
         /**
@@ -46,14 +83,48 @@ namespace lang {
         decaf::lang::Pointer<const std::exception> cause;
 
         /**
-         * The stack trace.
+         * A stack trace assigned with setStackTrace, reported ahead of the marks.
          */
         std::vector< std::pair< std::string, int> > stackTrace;
 
-    public:
+        /**
+         * The marks set on this exception, the first INLINE_MARKS are held inline
+         * and any beyond that in overflow.
+         */
+        Mark marks[INLINE_MARKS];
+        int markCount;
+        std::vector<Mark> overflow;
 
-        ExceptionData() : message(), cause(NULL), stackTrace() {}
+    public:
 
+        ExceptionData() : message(), cause(NULL), stackTrace(), marks(), markCount(0), overflow() {}
+
+        void addMark(const char* file, int line) {
+            Mark mark = { file, line };
+            if (markCount < INLINE_MARKS) {
+                marks[markCount] = mark;
+            } else {
+                overflow.push_back(mark);
+            }
+            markCount++;
+        }
+
+        const Mark& getMark(int index) const {
+            return index < INLINE_MARKS ? marks[index] : overflow[index - INLINE_MARKS];
+        }
+
+        void copyMarks(const ExceptionData& source) {
+            markCount = source.markCount;
+            for (int i = 0; i < markCount && i < INLINE_MARKS; ++i) {
+                marks[i] = source.marks[i];
+            }
+            overflow = source.overflow;
+        }
+
+        void clearMarks() {
+            markCount = 0;
+            overflow.clear();
+        }
     };
 
 }}
@@ -117,20 +188,30 @@ void Exception::setMessage(const char* msg, ...) {
 ////////////////////////////////////////////////////////////////////////////////
 void Exception::buildMessage(const char* format, va_list& vargs) {
 
-    // Allocate buffer with a guess of it's size
-    AprPool pool;
+    // Most messages are short, format those on the stack and only fall back to a
+    // pool for the ones that don't fit.
+    char buffer[MESSAGE_BUFFER_SIZE];
 
-    // Allocate a buffer of the specified size.
-    char* buffer = apr_pvsprintf(pool.getAprPool(), format, vargs);
+    va_list copy;
+    va_copy(copy, vargs);
+    int length = vsnprintf(buffer, sizeof(buffer), format, copy);
+    va_end(copy);
+
+    // A message that filled the buffer may have been cut short.
+    if (length >= 0 && length < MESSAGE_BUFFER_SIZE - 1) {
+        this->data->message.assign(buffer, length);
+        return;
+    }
 
-    // Guessed size was enough. Assign the string.
-    this->data->message.assign(buffer, strlen(buffer));
+    AprPool pool;
+    char* result = apr_pvsprintf(pool.getAprPool(), format, vargs);
+    this->data->message.assign(result, strlen(result));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 void Exception::setMark(const char* file, const int lineNumber) {
     // Add this mark to the end of the stack trace.
-    this->data->stackTrace.push_back(std::make_pair(std::string(file), (int) lineNumber));
+    this->data->addMark(file, (int) lineNumber);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -140,12 +221,22 @@ Exception* Exception::clone() const {
 
 ////////////////////////////////////////////////////////////////////////////////
 std::vector<std::pair<std::string, int> > Exception::getStackTrace() const {
-    return this->data->stackTrace;
+
+    std::vector<std::pair<std::string, int> > trace(this->data->stackTrace);
+    trace.reserve(trace.size() + this->data->markCount);
+
+    for (int ix = 0; ix < this->data->markCount; ++ix) {
+        const ExceptionData::Mark& mark = this->data->getMark(ix);
+        trace.push_back(std::make_pair(std::string(mark.file), mark.line));
+    }
+
+    return trace;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 void Exception::setStackTrace(const std::vector<std::pair<std::string, int> >& trace) {
     this->data->stackTrace = trace;
+    this->data->clearMarks();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -171,6 +262,12 @@ std::string Exception::getStackTraceString() const {
         stream << ", LINE: " << this->data->stackTrace[ix].second;
         stream << std::endl;
     }
+    for (int ix = 0; ix < this->data->markCount; ++ix) {
+        const ExceptionData::Mark& mark = this->data->getMark(ix);
+        stream << "\tFILE: " << mark.file;
+        stream << ", LINE: " << mark.line;
+        stream << std::endl;
+    }
 
     // Return the string from the output stream.
     return stream.str();
@@ -180,6 +277,7 @@ std::string Exception::getStackTraceString() const {
 Exception& Exception::operator =(const Exception& ex) {
     this->data->message = ex.data->message;
     this->data->stackTrace = ex.data->stackTrace;
+    this->data->copyMarks(*ex.data);
     this->data->cause = ex.data->cause;
     return *this;
 }
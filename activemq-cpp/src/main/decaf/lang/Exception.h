@@ -149,7 +149,9 @@ namespace lang {
         virtual void setMessage(const char* msg, ...);
 
         /**
-         * Adds a file/line number to the stack trace.
+         * Adds a file/line number to the stack trace.  Only the file pointer is kept, so
+         * the name must remain valid for the life of the exception, as __FILE__ does.
+         * Marking does not allocate for the first several marks.
          *
          * @param file
          *      The name of the file calling this method (use __FILE__).
@@ -44,6 +44,16 @@ ByteBuffer* ByteBuffer::allocate( int capacity ) {
     DECAF_CATCHALL_THROW( IllegalArgumentException )
 }
 
+////////////////////////////////////////////////////////////////////////////////
+ByteBuffer* ByteBuffer::allocateDirect( int capacity ) {
+
+    try{
+        return BufferFactory::createDirectByteBuffer( capacity );
+    }
+    DECAF_CATCH_RETHROW( IllegalArgumentException )
+    DECAF_CATCHALL_THROW( IllegalArgumentException )
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ByteBuffer* ByteBuffer::wrap( unsigned char* buffer, int size, int offset, int length ) {
 
@@ -289,6 +289,19 @@ namespace nio{
          */
         virtual bool hasArray() const = 0;
 
+        /**
+         * Tells whether or not this buffer is direct.  A direct buffer's memory comes
+         * from an aligned pool or a mapped file rather than the general heap, buffers
+         * created from it by duplicate, slice or asReadOnlyBuffer are direct as well.
+         *
+         * @returns true if, and only if, this buffer is direct.
+         *
+         * @since 3.8.0
+         */
+        virtual bool isDirect() const {
+            return false;
+        }
+
         /**
          * Creates a view of this byte buffer as a char buffer.
          *
@@ -878,6 +891,23 @@ namespace nio{
          */
         static ByteBuffer* allocate( int capacity );
 
+        /**
+         * Allocates a new direct byte buffer whose position will be zero its limit will
+         * be its capacity and its mark is not set.  The memory is aligned and comes from
+         * a pool that reuses the memory of destroyed direct buffers, which makes direct
+         * buffers the better choice for buffers that are created and destroyed often.
+         *
+         * @param capacity
+         *      The internal buffer's capacity.
+         *
+         * @returns a newly allocated direct ByteBuffer which the caller owns.
+         *
+         * @throws IllegalArgumentException if capacity is negative.
+         *
+         * @since 3.8.0
+         */
+        static ByteBuffer* allocateDirect( int capacity );
+
         /**
          * Wraps the passed buffer with a new ByteBuffer.
          *
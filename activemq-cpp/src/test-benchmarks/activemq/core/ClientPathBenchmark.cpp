@@ -0,0 +1,404 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ClientPathBenchmark.h"
+
+#include <benchmark/AllocationCounter.h>
+#include <benchmark/LatencyRecorder.h>
+
+#include <activemq/core/ActiveMQConnection.h>
+#include <activemq/core/ActiveMQConnectionFactory.h>
+#include <activemq/commands/ConsumerInfo.h>
+#include <activemq/commands/Message.h>
+#include <activemq/commands/MessageDispatch.h>
+#include <activemq/commands/RemoveInfo.h>
+#include <activemq/commands/WireFormatInfo.h>
+#include <activemq/transport/IOTransport.h>
+#include <activemq/transport/mock/MockBroker.h>
+#include <activemq/transport/mock/MockTransport.h>
+#include <activemq/transport/mock/ResponseBuilder.h>
+#include <activemq/wireformat/openwire/OpenWireFormat.h>
+#include <activemq/wireformat/openwire/OpenWireFormatFactory.h>
+#include <activemq/wireformat/openwire/OpenWireResponseBuilder.h>
+
+#include <cms/BytesMessage.h>
+#include <cms/MapMessage.h>
+#include <cms/MessageConsumer.h>
+#include <cms/MessageListener.h>
+#include <cms/MessageProducer.h>
+#include <cms/Queue.h>
+#include <cms/Session.h>
+#include <cms/TextMessage.h>
+
+#include <decaf/io/ByteArrayInputStream.h>
+#include <decaf/io/ByteArrayOutputStream.h>
+#include <decaf/io/DataInputStream.h>
+#include <decaf/io/DataOutputStream.h>
+#include <decaf/lang/Integer.h>
+#include <decaf/lang/Pointer.h>
+#include <decaf/lang/System.h>
+#include <decaf/util/LinkedList.h>
+#include <decaf/util/Properties.h>
+#include <decaf/util/StlMap.h>
+#include <decaf/util/concurrent/CountDownLatch.h>
+#include <decaf/util/concurrent/Semaphore.h>
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::core;
+using namespace activemq::commands;
+using namespace activemq::transport;
+using namespace activemq::transport::mock;
+using namespace activemq::wireformat;
+using namespace activemq::wireformat::openwire;
+using namespace decaf;
+using namespace decaf::io;
+using namespace decaf::lang;
+using namespace decaf::util;
+using namespace decaf::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const int WARMUP_MESSAGES = 200;
+    const int MEASURED_MESSAGES = 2000;
+    const int SEND_WINDOW = 64;
+    const int TRANSACTION_SIZE = 100;
+    const long long AWAIT_TIMEOUT = 60000;
+
+    enum MessageKind {
+        TEXT_MESSAGE,
+        BYTES_MESSAGE,
+        MAP_MESSAGE
+    };
+
+    const char* messageKindName( int kind ) {
+        switch( kind ) {
+            case TEXT_MESSAGE: return "TextMessage";
+            case BYTES_MESSAGE: return "BytesMessage";
+            default: return "MapMessage";
+        }
+    }
+
+    const char* ackModeName( int mode ) {
+        switch( mode ) {
+            case cms::Session::AUTO_ACKNOWLEDGE: return "AUTO_ACKNOWLEDGE";
+            case cms::Session::DUPS_OK_ACKNOWLEDGE: return "DUPS_OK_ACKNOWLEDGE";
+            case cms::Session::CLIENT_ACKNOWLEDGE: return "CLIENT_ACKNOWLEDGE";
+            default: return "SESSION_TRANSACTED";
+        }
+    }
+
+    cms::Message* createMessage( cms::Session* session, int kind ) {
+
+        switch( kind ) {
+            case TEXT_MESSAGE:
+                return session->createTextMessage( std::string( 1024, 'x' ) );
+            case BYTES_MESSAGE: {
+                std::vector<unsigned char> payload( 1024, 0x5A );
+                return session->createBytesMessage( &payload[0], (int) payload.size() );
+            }
+            default: {
+                cms::MapMessage* message = session->createMapMessage();
+                for( int i = 0; i < 10; ++i ) {
+                    message->setString( "key" + Integer::toString( i ), std::string( 64, 'v' ) );
+                }
+                return message;
+            }
+        }
+    }
+
+    Pointer<OpenWireFormat> createWireFormat() {
+        Properties properties;
+        Pointer<OpenWireFormat> format =
+            OpenWireFormatFactory().createWireFormat( properties ).dynamicCast<OpenWireFormat>();
+        return format;
+    }
+
+    /**
+     * The broker side of the loopback, answers commands that need a response and
+     * turns every message sent into a dispatch for the consumer on its destination.
+     */
+    class LoopbackRouter {
+    private:
+
+        OpenWireResponseBuilder responses;
+        StlMap< std::string, Pointer<ConsumerId> > consumers;
+
+    public:
+
+        LoopbackRouter() : responses(), consumers() {}
+
+        void route( const Pointer<Command> command, LinkedList< Pointer<Command> >& replies ) {
+
+            Pointer<Response> response = responses.buildResponse( command );
+            if( response != NULL ) {
+                replies.add( response );
+            }
+
+            if( command->isConsumerInfo() ) {
+                Pointer<ConsumerInfo> info = command.dynamicCast<ConsumerInfo>();
+                consumers.put( info->getDestination()->toString(), info->getConsumerId() );
+            } else if( command->isMessage() ) {
+                Pointer<Message> message = command.dynamicCast<Message>();
+                std::string destination = message->getDestination()->toString();
+
+                if( consumers.containsKey( destination ) ) {
+                    Pointer<MessageDispatch> dispatch( new MessageDispatch() );
+                    dispatch->setConsumerId( consumers.get( destination ) );
+                    dispatch->setDestination( message->getDestination() );
+                    dispatch->setMessage( message );
+                    dispatch->setRedeliveryCounter( 0 );
+                    replies.add( dispatch );
+                }
+            }
+        }
+    };
+
+    /**
+     * Loops commands sent through a MockTransport back to the client.  Every command
+     * is marshaled and unmarshaled on the way out and again on the way back in, which
+     * is the work IOTransport does on a real connection.
+     */
+    class LoopbackResponseBuilder : public ResponseBuilder {
+    private:
+
+        LoopbackRouter router;
+        Pointer<OpenWireFormat> outbound;
+        Pointer<OpenWireFormat> inbound;
+        IOTransport transport;
+
+    private:
+
+        LoopbackResponseBuilder( const LoopbackResponseBuilder& );
+        LoopbackResponseBuilder& operator= ( const LoopbackResponseBuilder& );
+
+    public:
+
+        LoopbackResponseBuilder() : ResponseBuilder(), router(), outbound( createWireFormat() ),
+                                    inbound( createWireFormat() ), transport() {
+
+            outbound->renegotiateWireFormat( *outbound->getPreferedWireFormatInfo() );
+            inbound->renegotiateWireFormat( *inbound->getPreferedWireFormatInfo() );
+        }
+
+        virtual ~LoopbackResponseBuilder() {}
+
+        virtual Pointer<Response> buildResponse( const Pointer<Command> command ) {
+            LinkedList< Pointer<Command> > replies;
+            router.route( command, replies );
+            return replies.isEmpty() ? Pointer<Response>() : replies.getFirst().dynamicCast<Response>();
+        }
+
+        virtual void buildIncomingCommands( const Pointer<Command> command, LinkedList< Pointer<Command> >& queue ) {
+
+            if( command->isWireFormatInfo() ) {
+                queue.push( Pointer<Command>( dynamic_cast<WireFormatInfo*>( command->cloneDataStructure() ) ) );
+                return;
+            }
+
+            LinkedList< Pointer<Command> > replies;
+            router.route( roundTrip( *outbound, command ), replies );
+
+            Pointer< Iterator< Pointer<Command> > > iter( replies.iterator() );
+            while( iter->hasNext() ) {
+                queue.push( roundTrip( *inbound, iter->next() ) );
+            }
+        }
+
+    private:
+
+        Pointer<Command> roundTrip( OpenWireFormat& format, const Pointer<Command> command ) {
+
+            ByteArrayOutputStream bytesOut;
+            DataOutputStream dataOut( &bytesOut );
+            format.marshal( command, &transport, &dataOut );
+
+            std::pair<unsigned char*, int> frame = bytesOut.toByteArray();
+            ByteArrayInputStream bytesIn( frame.first, frame.second, true );
+            DataInputStream dataIn( &bytesIn );
+            return format.unmarshal( &transport, &dataIn );
+        }
+    };
+
+    /**
+     * Records the latency of each message and applies the session's ack mode.
+     */
+    class LatencyListener : public cms::MessageListener {
+    private:
+
+        cms::Session* session;
+        int ackMode;
+        benchmark::LatencyRecorder& recorder;
+        Semaphore& window;
+        int received;
+        int uncommitted;
+
+    public:
+
+        CountDownLatch warmedUp;
+        CountDownLatch finished;
+
+    private:
+
+        LatencyListener( const LatencyListener& );
+        LatencyListener& operator= ( const LatencyListener& );
+
+    public:
+
+        LatencyListener( cms::Session* session, int ackMode, benchmark::LatencyRecorder& recorder, Semaphore& window ) :
+            cms::MessageListener(), session( session ), ackMode( ackMode ), recorder( recorder ), window( window ),
+            received( 0 ), uncommitted( 0 ), warmedUp( WARMUP_MESSAGES ), finished( WARMUP_MESSAGES + MEASURED_MESSAGES ) {
+        }
+
+        virtual ~LatencyListener() {}
+
+        virtual void onMessage( const cms::Message* message ) {
+
+            recorder.record( System::nanoTime() - message->getLongProperty( "sendTime" ) );
+
+            if( ackMode == cms::Session::CLIENT_ACKNOWLEDGE ) {
+                message->acknowledge();
+            } else if( ackMode == cms::Session::SESSION_TRANSACTED && ++uncommitted == TRANSACTION_SIZE ) {
+                session->commit();
+                uncommitted = 0;
+            }
+
+            if( ++received <= WARMUP_MESSAGES ) {
+                warmedUp.countDown();
+            }
+            finished.countDown();
+            window.release();
+        }
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ClientPathBenchmark::testMockTransport() {
+    runScenarios( false );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ClientPathBenchmark::testLoopbackSocket() {
+    runScenarios( true );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ClientPathBenchmark::runScenarios( bool loopbackSocket ) {
+
+    const int ackModes[] = { cms::Session::AUTO_ACKNOWLEDGE, cms::Session::DUPS_OK_ACKNOWLEDGE,
+                             cms::Session::CLIENT_ACKNOWLEDGE, cms::Session::SESSION_TRANSACTED };
+
+    std::cout << std::endl;
+    for( int kind = TEXT_MESSAGE; kind <= MAP_MESSAGE; ++kind ) {
+        for( std::size_t mode = 0; mode < sizeof( ackModes ) / sizeof( int ); ++mode ) {
+            runScenario( loopbackSocket, kind, ackModes[mode] );
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ClientPathBenchmark::runScenario( bool loopbackSocket, int messageKind, int ackMode ) {
+
+    MockBroker broker;
+    std::string uri = "mock://127.0.0.1:12345?wireFormat=openwire";
+
+    if( loopbackSocket ) {
+        broker.start();
+        uri = broker.getConnectString() + "?transport.useInactivityMonitor=false";
+    }
+
+    ActiveMQConnectionFactory factory( uri );
+    std::auto_ptr<ActiveMQConnection> connection(
+        dynamic_cast<ActiveMQConnection*>( factory.createConnection() ) );
+
+    if( !loopbackSocket ) {
+        MockTransport* mock = dynamic_cast<MockTransport*>(
+            connection->getTransport().narrow( typeid( MockTransport ) ) );
+        CPPUNIT_ASSERT( mock != NULL );
+        mock->setResponseBuilder( Pointer<ResponseBuilder>( new LoopbackResponseBuilder() ) );
+    }
+
+    connection->start();
+
+    std::auto_ptr<cms::Session> producerSession( connection->createSession( cms::Session::AUTO_ACKNOWLEDGE ) );
+    std::auto_ptr<cms::Session> consumerSession( connection->createSession( (cms::Session::AcknowledgeMode) ackMode ) );
+    std::auto_ptr<cms::Queue> queue( producerSession->createQueue( "BENCHMARK.CLIENTPATH" ) );
+
+    benchmark::LatencyRecorder recorder( WARMUP_MESSAGES + MEASURED_MESSAGES );
+    Semaphore window( SEND_WINDOW );
+    LatencyListener listener( consumerSession.get(), ackMode, recorder, window );
+
+    std::auto_ptr<cms::MessageConsumer> consumer( consumerSession->createConsumer( queue.get() ) );
+    consumer->setMessageListener( &listener );
+
+    std::auto_ptr<cms::MessageProducer> producer( producerSession->createProducer( queue.get() ) );
+    producer->setDeliveryMode( cms::DeliveryMode::NON_PERSISTENT );
+
+    std::auto_ptr<cms::Message> message( createMessage( producerSession.get(), messageKind ) );
+
+    for( int i = 0; i < WARMUP_MESSAGES; ++i ) {
+        window.acquire();
+        message->setLongProperty( "sendTime", System::nanoTime() );
+        producer->send( message.get() );
+    }
+
+    CPPUNIT_ASSERT( listener.warmedUp.await( AWAIT_TIMEOUT ) );
+
+    // Nothing is in flight once the warm up messages have all arrived.
+    recorder.reset();
+    long long allocations = benchmark::AllocationCounter::getAllocations();
+    long long startTime = System::nanoTime();
+
+    for( int i = 0; i < MEASURED_MESSAGES; ++i ) {
+        window.acquire();
+        message->setLongProperty( "sendTime", System::nanoTime() );
+        producer->send( message.get() );
+    }
+
+    CPPUNIT_ASSERT( listener.finished.await( AWAIT_TIMEOUT ) );
+
+    long long elapsed = System::nanoTime() - startTime;
+    allocations = benchmark::AllocationCounter::getAllocations() - allocations;
+
+    std::cout << "ClientPath " << std::left
+              << std::setw( 5 ) << ( loopbackSocket ? "tcp" : "mock" )
+              << std::setw( 13 ) << messageKindName( messageKind )
+              << std::setw( 20 ) << ackModeName( ackMode ) << std::right
+              << " msgs/sec=" << std::setw( 7 ) << (long long) ( MEASURED_MESSAGES * 1e9 / (double) elapsed )
+              << " p50=" << std::setw( 6 ) << recorder.getPercentile( 50.0 ) / 1000 << "us"
+              << " p99=" << std::setw( 6 ) << recorder.getPercentile( 99.0 ) / 1000 << "us"
+              << " p999=" << std::setw( 6 ) << recorder.getPercentile( 99.9 ) / 1000 << "us";
+
+    if( benchmark::AllocationCounter::isSupported() ) {
+        std::cout << " allocs/msg=" << std::fixed << std::setprecision( 1 )
+                  << (double) allocations / MEASURED_MESSAGES;
+    }
+    std::cout << std::endl;
+
+    if( ackMode == cms::Session::SESSION_TRANSACTED ) {
+        consumerSession->commit();
+    }
+
+    consumer->setMessageListener( NULL );
+    connection->close();
+}
@@ -0,0 +1,66 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_CORE_CLIENTPATHBENCHMARK_H_
+#define _ACTIVEMQ_CORE_CLIENTPATHBENCHMARK_H_
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace activemq{
+namespace core{
+
+    /**
+     * Measures the whole client path for one message: the producer send, marshaling,
+     * the transport, unmarshaling, the connection's dispatch and the consumer's
+     * listener.  Each message type is run under each acknowledgement mode.  Every run
+     * prints its throughput, its p50, p99 and p99.9 send to onMessage latency, and the
+     * number of allocations per message.
+     *
+     * Two transports are measured:
+     *  - mock: a MockTransport that marshals every command sent and unmarshals it again,
+     *    standing in for the socket, and loops each message back as a dispatch.
+     *  - tcp: a real TcpTransport connected over the loopback interface to an
+     *    in-process MockBroker.  The broker's own allocations are included in its
+     *    allocation counts.
+     */
+    class ClientPathBenchmark : public CppUnit::TestFixture {
+
+        CPPUNIT_TEST_SUITE( ClientPathBenchmark );
+        CPPUNIT_TEST( testMockTransport );
+        CPPUNIT_TEST( testLoopbackSocket );
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+
+        ClientPathBenchmark() {}
+        virtual ~ClientPathBenchmark() {}
+
+        void testMockTransport();
+        void testLoopbackSocket();
+
+    private:
+
+        void runScenarios( bool loopbackSocket );
+
+        void runScenario( bool loopbackSocket, int messageKind, int ackMode );
+
+    };
+
+}}
+
+#endif /*_ACTIVEMQ_CORE_CLIENTPATHBENCHMARK_H_*/
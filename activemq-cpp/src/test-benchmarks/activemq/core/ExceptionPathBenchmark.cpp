@@ -0,0 +1,278 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ExceptionPathBenchmark.h"
+
+#include <benchmark/AllocationCounter.h>
+
+#include <activemq/core/ActiveMQConnection.h>
+#include <activemq/core/ActiveMQConnectionFactory.h>
+#include <activemq/commands/ConsumerId.h>
+#include <activemq/commands/MessageAck.h>
+#include <activemq/commands/RemoveInfo.h>
+#include <activemq/exceptions/ActiveMQException.h>
+#include <activemq/exceptions/ExceptionDefines.h>
+#include <activemq/transport/DefaultTransportListener.h>
+#include <activemq/transport/failover/FailoverTransport.h>
+#include <activemq/transport/failover/FailoverTransportFactory.h>
+#include <activemq/transport/mock/MockTransport.h>
+
+#include <cms/MessageConsumer.h>
+#include <cms/MessageProducer.h>
+#include <cms/Queue.h>
+#include <cms/Session.h>
+
+#include <decaf/io/IOException.h>
+#include <decaf/lang/Pointer.h>
+#include <decaf/lang/System.h>
+#include <decaf/lang/Thread.h>
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <typeinfo>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::core;
+using namespace activemq::commands;
+using namespace activemq::exceptions;
+using namespace activemq::transport;
+using namespace activemq::transport::failover;
+using namespace activemq::transport::mock;
+using namespace decaf;
+using namespace decaf::io;
+using namespace decaf::lang;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const int THROWS = 20000;
+    const int CONNECTIONS = 100;
+    const int SENDS = 50000;
+    const int RUNS = 3;
+
+    void report( const char* name, long long elapsed, long long allocated, int count ) {
+
+        std::cout << std::setw( 28 ) << name
+                  << " ns/op=" << std::setw( 8 ) << elapsed / count;
+
+        if( benchmark::AllocationCounter::isSupported() ) {
+            std::cout << " allocs/op=" << std::fixed << std::setprecision( 1 )
+                      << (double) allocated / count;
+        }
+        std::cout << std::endl;
+    }
+
+    // The layers a failed send passes through on its way to the caller, the
+    // transport raising an IOException and each layer above it marking or
+    // converting it.
+    void transportWrite() {
+        throw IOException( __FILE__, __LINE__, "Transport is closed." );
+    }
+
+    void transportFilter() {
+        try {
+            transportWrite();
+        }
+        AMQ_CATCH_RETHROW( IOException )
+    }
+
+    void responseCorrelator() {
+        try {
+            transportFilter();
+        }
+        AMQ_CATCH_RETHROW( IOException )
+    }
+
+    void connectionOneway() {
+        try {
+            responseCorrelator();
+        }
+        AMQ_CATCH_EXCEPTION_CONVERT( IOException, ActiveMQException )
+    }
+
+    void sessionSend() {
+        try {
+            connectionOneway();
+        }
+        AMQ_CATCH_RETHROW( ActiveMQException )
+    }
+
+    /**
+     * Opens a connection on the mock transport with a session, consumer and producer,
+     * optionally fails its transport and then returns the time and allocations taken
+     * to close it.
+     */
+    void closeConnection( bool failTransport, long long& elapsed, long long& allocated, int& errors ) {
+
+        ActiveMQConnectionFactory factory( "mock://localhost:61616?wireFormat=openwire" );
+        std::auto_ptr<ActiveMQConnection> connection(
+            dynamic_cast<ActiveMQConnection*>( factory.createConnection() ) );
+
+        connection->start();
+
+        std::auto_ptr<cms::Session> session( connection->createSession( cms::Session::AUTO_ACKNOWLEDGE ) );
+        std::auto_ptr<cms::Queue> queue( session->createQueue( "ExceptionPathBenchmark" ) );
+        std::auto_ptr<cms::MessageConsumer> consumer( session->createConsumer( queue.get() ) );
+        std::auto_ptr<cms::MessageProducer> producer( session->createProducer( queue.get() ) );
+
+        if( failTransport ) {
+            MockTransport* transport = dynamic_cast<MockTransport*>(
+                connection->getTransport().narrow( typeid( MockTransport ) ) );
+            CPPUNIT_ASSERT( transport != NULL );
+
+            transport->fireException( ActiveMQException( __FILE__, __LINE__, "Transport failed." ) );
+
+            // The connection records the failure on its executor.
+            while( !connection->isTransportFailed() ) {
+                Thread::sleep( 1 );
+            }
+        }
+
+        long long before = benchmark::AllocationCounter::getAllocations();
+        long long start = System::nanoTime();
+
+        try {
+            connection->close();
+        } catch( cms::CMSException& ) {
+            ++errors;
+        }
+
+        elapsed += System::nanoTime() - start;
+        allocated += benchmark::AllocationCounter::getAllocations() - before;
+    }
+
+    void measureClose( const char* name, bool failTransport ) {
+
+        for( int run = 0; run < RUNS; ++run ) {
+
+            long long elapsed = 0;
+            long long allocated = 0;
+            int errors = 0;
+
+            for( int i = 0; i < CONNECTIONS; ++i ) {
+                closeConnection( failTransport, elapsed, allocated, errors );
+            }
+
+            report( name, elapsed, allocated, CONNECTIONS );
+            if( errors > 0 ) {
+                std::cout << std::setw( 28 ) << "" << " close threw " << errors << " times" << std::endl;
+            }
+        }
+    }
+
+    void measureSends( const char* name, Transport& transport, const Pointer<Command>& command ) {
+
+        for( int run = 0; run < RUNS; ++run ) {
+
+            long long allocated = benchmark::AllocationCounter::getAllocations();
+            long long start = System::nanoTime();
+
+            for( int i = 0; i < SENDS; ++i ) {
+                transport.oneway( command );
+            }
+
+            long long elapsed = System::nanoTime() - start;
+            allocated = benchmark::AllocationCounter::getAllocations() - allocated;
+
+            report( name, elapsed, allocated, SENDS );
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ExceptionPathBenchmark::testConvertChain() {
+
+    std::cout << std::endl;
+
+    for( int run = 0; run < RUNS; ++run ) {
+
+        int caught = 0;
+        long long allocated = benchmark::AllocationCounter::getAllocations();
+        long long start = System::nanoTime();
+
+        for( int i = 0; i < THROWS; ++i ) {
+            try {
+                sessionSend();
+            } catch( ActiveMQException& ) {
+                ++caught;
+            }
+        }
+
+        long long elapsed = System::nanoTime() - start;
+        allocated = benchmark::AllocationCounter::getAllocations() - allocated;
+
+        CPPUNIT_ASSERT_EQUAL( THROWS, caught );
+        report( "convert (4 layers)", elapsed, allocated, THROWS );
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ExceptionPathBenchmark::testFailedConnectionClose() {
+
+    std::cout << std::endl;
+
+    measureClose( "close (healthy)", false );
+    measureClose( "close (transport failed)", true );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ExceptionPathBenchmark::testFailoverDisconnectedSends() {
+
+    std::cout << std::endl;
+
+    // The only broker can never be reached so the transport stays disconnected,
+    // the long reconnect delay keeps the reconnect task out of the measurement.
+    std::string uri = "failover://(mock://localhost:61616?failOnCreate=true)?"
+                      "useExponentialBackOff=false&initialReconnectDelay=60000";
+
+    DefaultTransportListener listener;
+    FailoverTransportFactory factory;
+
+    Pointer<Transport> transport( factory.create( uri ) );
+    transport->setTransportListener( &listener );
+    transport->start();
+
+    FailoverTransport* failover = dynamic_cast<FailoverTransport*>(
+        transport->narrow( typeid( FailoverTransport ) ) );
+    CPPUNIT_ASSERT( failover != NULL );
+
+    Pointer<ConsumerId> consumerId( new ConsumerId() );
+    consumerId->setConnectionId( "ExceptionPathBenchmark" );
+    consumerId->setSessionId( 1 );
+    consumerId->setValue( 1 );
+
+    Pointer<RemoveInfo> remove( new RemoveInfo() );
+    remove->setObjectId( consumerId );
+    remove->setCommandId( 1 );
+    remove->setResponseRequired( true );
+
+    Pointer<MessageAck> ack( new MessageAck() );
+    ack->setConsumerId( consumerId );
+    ack->setMessageCount( 1 );
+
+    measureSends( "failover RemoveInfo (sim)", *transport, remove );
+    measureSends( "failover MessageAck (sim)", *transport, ack );
+
+    transport->close();
+
+    // The filters above the failover transport refuse sends once closed, the failover
+    // transport itself drops them so a send racing a close doesn't raise an error.
+    measureSends( "failover RemoveInfo (closed)", *failover, remove );
+    measureSends( "failover MessageAck (closed)", *failover, ack );
+}
@@ -0,0 +1,59 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_CORE_EXCEPTIONPATHBENCHMARK_H_
+#define _ACTIVEMQ_CORE_EXCEPTIONPATHBENCHMARK_H_
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace activemq{
+namespace core{
+
+    /**
+     * Measures the paths the client takes when things go wrong, printing the time
+     * and the number of allocations for each operation:
+     *  - convert: an IOException thrown from a transport and marked, rethrown and
+     *    converted through the layers above it the way a failed send travels.
+     *  - close: closing a connection, with a session, consumer and producer open,
+     *    whose transport has already failed, against closing a healthy one.
+     *  - failover: sends on a FailoverTransport that cannot connect, which answer
+     *    RemoveInfo and MessageAck with simulated responses, and sends on one that
+     *    has been closed.
+     */
+    class ExceptionPathBenchmark : public CppUnit::TestFixture {
+
+        CPPUNIT_TEST_SUITE( ExceptionPathBenchmark );
+        CPPUNIT_TEST( testConvertChain );
+        CPPUNIT_TEST( testFailedConnectionClose );
+        CPPUNIT_TEST( testFailoverDisconnectedSends );
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+
+        ExceptionPathBenchmark() {}
+        virtual ~ExceptionPathBenchmark() {}
+
+        void testConvertChain();
+        void testFailedConnectionClose();
+        void testFailoverDisconnectedSends();
+
+    };
+
+}}
+
+#endif /*_ACTIVEMQ_CORE_EXCEPTIONPATHBENCHMARK_H_*/
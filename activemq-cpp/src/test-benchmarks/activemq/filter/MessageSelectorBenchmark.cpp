@@ -0,0 +1,64 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MessageSelectorBenchmark.h"
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::filter;
+using namespace decaf::lang;
+
+////////////////////////////////////////////////////////////////////////////////
+MessageSelectorBenchmark::MessageSelectorBenchmark() : message(), selectors() {}
+
+////////////////////////////////////////////////////////////////////////////////
+MessageSelectorBenchmark::~MessageSelectorBenchmark() {}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSelectorBenchmark::setUp(){
+
+    message.getMessageProperties().setString( "color", "red" );
+    message.getMessageProperties().setString( "region", "emea-west-2" );
+    message.getMessageProperties().setInt( "quantity", 250 );
+    message.getMessageProperties().setDouble( "price", 17.25 );
+    message.getMessageProperties().setBool( "urgent", false );
+    message.setPriority( 7 );
+    message.setType( "order" );
+
+    selectors.push_back( Pointer<MessageSelector>( new MessageSelector(
+        "color = 'red'" ) ) );
+    selectors.push_back( Pointer<MessageSelector>( new MessageSelector(
+        "JMSPriority > 4 AND JMSType = 'order'" ) ) );
+    selectors.push_back( Pointer<MessageSelector>( new MessageSelector(
+        "quantity * price BETWEEN 1000 AND 5000 AND NOT urgent" ) ) );
+    selectors.push_back( Pointer<MessageSelector>( new MessageSelector(
+        "region LIKE 'emea-%' AND color IN ('red', 'green', 'blue')" ) ) );
+    selectors.push_back( Pointer<MessageSelector>( new MessageSelector(
+        "missing IS NULL OR missing = 'x'" ) ) );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSelectorBenchmark::run() {
+
+    int numRuns = 1000;
+
+    for( int i = 0; i < numRuns; ++i ){
+        for( std::size_t j = 0; j < selectors.size(); ++j ) {
+            CPPUNIT_ASSERT( selectors[j]->matches( &message ) );
+        }
+    }
+}
@@ -0,0 +1,53 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_FILTER_MESSAGESELECTORBENCHMARK_H_
+#define _ACTIVEMQ_FILTER_MESSAGESELECTORBENCHMARK_H_
+
+#include <benchmark/BenchmarkBase.h>
+
+#include <activemq/filter/MessageSelector.h>
+#include <activemq/commands/Message.h>
+#include <decaf/lang/Pointer.h>
+
+#include <vector>
+
+namespace activemq{
+namespace filter{
+
+    class MessageSelectorBenchmark :
+        public benchmark::BenchmarkBase<
+            activemq::filter::MessageSelectorBenchmark, MessageSelector >
+    {
+    private:
+
+        commands::Message message;
+        std::vector< decaf::lang::Pointer<MessageSelector> > selectors;
+
+    public:
+
+        MessageSelectorBenchmark();
+        virtual ~MessageSelectorBenchmark();
+
+        void setUp();
+        void run();
+
+    };
+
+}}
+
+#endif /*_ACTIVEMQ_FILTER_MESSAGESELECTORBENCHMARK_H_*/
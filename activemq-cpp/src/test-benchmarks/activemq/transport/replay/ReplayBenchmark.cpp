@@ -0,0 +1,135 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ReplayBenchmark.h"
+
+#include <benchmark/AllocationCounter.h>
+
+#include <activemq/core/ActiveMQConnection.h>
+#include <activemq/core/ActiveMQConnectionFactory.h>
+#include <activemq/transport/mock/MockBroker.h>
+#include <activemq/transport/replay/ReplayTransport.h>
+
+#include <cms/Connection.h>
+#include <cms/MessageConsumer.h>
+#include <cms/MessageProducer.h>
+#include <cms/Queue.h>
+#include <cms/Session.h>
+#include <cms/TextMessage.h>
+
+#include <decaf/lang/System.h>
+
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::core;
+using namespace activemq::transport;
+using namespace activemq::transport::mock;
+using namespace activemq::transport::replay;
+using namespace decaf::lang;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const char* CAPTURE_PATH = "ReplayBenchmark.capture";
+    const int MESSAGES = 2000;
+    const int RUNS = 5;
+
+    /**
+     * The client steps that are recorded and then replayed, returns the time taken
+     * by the message exchange in nanoseconds.
+     */
+    long long exchange( const std::string& uri, long long* allocations, ReplayTransport** replay ) {
+
+        ActiveMQConnectionFactory factory( uri );
+        std::auto_ptr<cms::Connection> connection( factory.createConnection() );
+        connection->start();
+
+        std::auto_ptr<cms::Session> session( connection->createSession( cms::Session::AUTO_ACKNOWLEDGE ) );
+        std::auto_ptr<cms::Queue> queue( session->createQueue( "ReplayBenchmark.Queue" ) );
+        std::auto_ptr<cms::MessageProducer> producer( session->createProducer( queue.get() ) );
+        std::auto_ptr<cms::MessageConsumer> consumer( session->createConsumer( queue.get() ) );
+        std::auto_ptr<cms::TextMessage> message( session->createTextMessage( std::string( 1024, 'x' ) ) );
+
+        long long allocated = benchmark::AllocationCounter::getAllocations();
+        long long start = System::nanoTime();
+
+        for( int i = 0; i < MESSAGES; ++i ) {
+            producer->send( message.get() );
+            std::auto_ptr<cms::Message> received( consumer->receive( 10000 ) );
+            CPPUNIT_ASSERT( received.get() != NULL );
+        }
+
+        long long elapsed = System::nanoTime() - start;
+        *allocations = benchmark::AllocationCounter::getAllocations() - allocated;
+
+        if( replay != NULL ) {
+            ActiveMQConnection* amqConnection = dynamic_cast<ActiveMQConnection*>( connection.get() );
+            *replay = dynamic_cast<ReplayTransport*>(
+                amqConnection->getTransport().narrow( typeid( ReplayTransport ) ) );
+            CPPUNIT_ASSERT( *replay != NULL );
+            std::cout << "Replay commands=" << ( *replay )->getCommandsReplayed()
+                      << "/" << ( *replay )->getCommandCount();
+        }
+
+        connection->close();
+
+        return elapsed;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ReplayBenchmark::tearDown() {
+    ::remove( CAPTURE_PATH );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ReplayBenchmark::testReplay() {
+
+    ::remove( CAPTURE_PATH );
+
+    long long allocations = 0;
+
+    {
+        MockBroker broker;
+        broker.start();
+        exchange( broker.getConnectString() + "?transport.useInactivityMonitor=false"
+                  "&connection.useAsyncSend=true&transport.captureFile=" + CAPTURE_PATH,
+                  &allocations, NULL );
+        broker.stop();
+    }
+
+    std::cout << std::endl;
+    for( int run = 0; run < RUNS; ++run ) {
+
+        ReplayTransport* replay = NULL;
+        long long elapsed = exchange( std::string( "replay://localhost?file=" ) + CAPTURE_PATH +
+                                      "&connection.useAsyncSend=true", &allocations, &replay );
+
+        std::cout << " msgs/sec=" << std::setw( 7 ) << (long long) ( MESSAGES * 1e9 / (double) elapsed );
+
+        if( benchmark::AllocationCounter::isSupported() ) {
+            std::cout << " allocs/msg=" << std::fixed << std::setprecision( 1 )
+                      << (double) allocations / MESSAGES;
+        }
+        std::cout << std::endl;
+    }
+}
@@ -0,0 +1,54 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_TRANSPORT_REPLAY_REPLAYBENCHMARK_H_
+#define _ACTIVEMQ_TRANSPORT_REPLAY_REPLAYBENCHMARK_H_
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace activemq{
+namespace transport{
+namespace replay{
+
+    /**
+     * Records a producer and consumer exchanging messages with an in-process
+     * MockBroker over tcp, then replays the capture into the same client steps over
+     * the replay transport.  Without a broker or socket in the way each run measures
+     * the client's own unmarshal and dispatch path on exactly the same input, and
+     * prints its throughput and the number of allocations per message.
+     */
+    class ReplayBenchmark : public CppUnit::TestFixture {
+
+        CPPUNIT_TEST_SUITE( ReplayBenchmark );
+        CPPUNIT_TEST( testReplay );
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+
+        ReplayBenchmark() {}
+        virtual ~ReplayBenchmark() {}
+
+        virtual void tearDown();
+
+        void testReplay();
+
+    };
+
+}}}
+
+#endif /*_ACTIVEMQ_TRANSPORT_REPLAY_REPLAYBENCHMARK_H_*/
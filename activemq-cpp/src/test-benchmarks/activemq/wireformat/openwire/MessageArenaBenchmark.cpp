@@ -0,0 +1,126 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MessageArenaBenchmark.h"
+#include "OpenWireMarshalBenchmark.h"
+
+#include <benchmark/AllocationCounter.h>
+
+#include <activemq/commands/ActiveMQTextMessage.h>
+#include <activemq/commands/MessageDispatch.h>
+#include <activemq/transport/IOTransport.h>
+#include <activemq/wireformat/openwire/OpenWireFormat.h>
+
+#include <decaf/io/ByteArrayInputStream.h>
+#include <decaf/io/ByteArrayOutputStream.h>
+#include <decaf/io/DataInputStream.h>
+#include <decaf/io/DataOutputStream.h>
+#include <decaf/lang/Pointer.h>
+#include <decaf/lang/System.h>
+#include <decaf/util/Properties.h>
+
+#include <iomanip>
+#include <iostream>
+#include <typeinfo>
+#include <vector>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::commands;
+using namespace activemq::transport;
+using namespace activemq::wireformat;
+using namespace activemq::wireformat::openwire;
+using namespace decaf::io;
+using namespace decaf::lang;
+using namespace decaf::util;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const int MESSAGES = 20000;
+    const int RUNS = 3;
+
+    /**
+     * Runs MESSAGES marshal and unmarshal cycles of the command and prints the
+     * nanoseconds and allocations per cycle.
+     */
+    void measure( const char* name, const Pointer<Command>& command, bool arenaEnabled ) {
+
+        OpenWireFormat format( (Properties()) );
+        format.setVersion( 9 );
+        format.setTightEncodingEnabled( true );
+        format.setMessageArenaEnabled( arenaEnabled );
+
+        IOTransport transport;
+
+        ByteArrayOutputStream bytesOut;
+        DataOutputStream dataOut( &bytesOut );
+        format.marshal( command, &transport, &dataOut );
+
+        std::pair<unsigned char*, int> sample = bytesOut.toByteArray();
+        std::vector<unsigned char> frame( sample.first, sample.first + sample.second );
+        delete [] sample.first;
+
+        ByteArrayInputStream bytesIn;
+        DataInputStream dataIn( &bytesIn );
+
+        for( int run = 0; run < RUNS; ++run ) {
+
+            long long allocated = benchmark::AllocationCounter::getAllocations();
+            long long start = System::nanoTime();
+
+            for( int i = 0; i < MESSAGES; ++i ) {
+                bytesOut.reset();
+                format.marshal( command, &transport, &dataOut );
+
+                bytesIn.setByteArray( &frame[0], (int) frame.size() );
+                Pointer<Command> result = format.unmarshal( &transport, &dataIn );
+                CPPUNIT_ASSERT( result != NULL );
+            }
+
+            long long elapsed = System::nanoTime() - start;
+            allocated = benchmark::AllocationCounter::getAllocations() - allocated;
+
+            std::cout << std::setw( 16 ) << name
+                      << " arena=" << ( arenaEnabled ? "on " : "off" )
+                      << " ns/msg=" << std::setw( 6 ) << elapsed / MESSAGES;
+
+            if( benchmark::AllocationCounter::isSupported() ) {
+                std::cout << " allocs/msg=" << std::fixed << std::setprecision( 1 )
+                          << (double) allocated / MESSAGES;
+            }
+            std::cout << std::endl;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageArenaBenchmark::testAllocations() {
+
+    Pointer<ActiveMQTextMessage> message( new ActiveMQTextMessage() );
+    OpenWireMarshalBenchmarkSupport::populate( *message );
+
+    Pointer<MessageDispatch> dispatch( new MessageDispatch() );
+    OpenWireMarshalBenchmarkSupport::populate( *dispatch );
+
+    std::cout << std::endl;
+
+    measure( "TextMessage", message, false );
+    measure( "TextMessage", message, true );
+    measure( "MessageDispatch", dispatch, false );
+    measure( "MessageDispatch", dispatch, true );
+}
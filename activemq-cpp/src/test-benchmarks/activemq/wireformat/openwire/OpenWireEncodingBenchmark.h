@@ -0,0 +1,50 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_WIREFORMAT_OPENWIRE_OPENWIREENCODINGBENCHMARK_H_
+#define _ACTIVEMQ_WIREFORMAT_OPENWIRE_OPENWIREENCODINGBENCHMARK_H_
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace activemq{
+namespace wireformat{
+namespace openwire{
+
+    /**
+     * Marshals and unmarshals a text message, a message dispatch and a message ack
+     * with loose and then with tight encoding, and prints the time and the number of
+     * allocations per command for each encoding.
+     */
+    class OpenWireEncodingBenchmark : public CppUnit::TestFixture {
+
+        CPPUNIT_TEST_SUITE( OpenWireEncodingBenchmark );
+        CPPUNIT_TEST( testEncodings );
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+
+        OpenWireEncodingBenchmark() {}
+        virtual ~OpenWireEncodingBenchmark() {}
+
+        void testEncodings();
+
+    };
+
+}}}
+
+#endif /*_ACTIVEMQ_WIREFORMAT_OPENWIRE_OPENWIREENCODINGBENCHMARK_H_*/
@@ -0,0 +1,115 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "OpenWireMarshalBenchmark.h"
+
+#include <activemq/commands/ActiveMQQueue.h>
+#include <activemq/commands/ActiveMQTopic.h>
+#include <activemq/commands/ConsumerId.h>
+#include <activemq/commands/MessageId.h>
+#include <activemq/commands/ProducerId.h>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::commands;
+using namespace activemq::wireformat;
+using namespace activemq::wireformat::openwire;
+using namespace decaf::lang;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    Pointer<ProducerId> createProducerId() {
+        Pointer<ProducerId> id( new ProducerId() );
+        id->setConnectionId( "ID:benchmark-host-51234-1300000000000-0:1" );
+        id->setSessionId( 1 );
+        id->setValue( 1 );
+        return id;
+    }
+
+    Pointer<ConsumerId> createConsumerId() {
+        Pointer<ConsumerId> id( new ConsumerId() );
+        id->setConnectionId( "ID:benchmark-host-51234-1300000000000-0:1" );
+        id->setSessionId( 1 );
+        id->setValue( 2 );
+        return id;
+    }
+
+    Pointer<MessageId> createMessageId() {
+        Pointer<MessageId> id( new MessageId() );
+        id->setProducerId( createProducerId() );
+        id->setProducerSequenceId( 42 );
+        return id;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireMarshalBenchmarkSupport::populate( ActiveMQTextMessage& command ) {
+
+    command.setMessageId( createMessageId() );
+    command.setProducerId( createProducerId() );
+    command.setDestination( Pointer<ActiveMQDestination>( new ActiveMQQueue( "BENCHMARK.QUEUE" ) ) );
+    command.setPersistent( true );
+    command.setPriority( 4 );
+    command.setTimestamp( 1300000000000LL );
+    command.setCorrelationId( "correlation-1" );
+    command.setType( "order" );
+    command.setIntProperty( "quantity", 250 );
+    command.setStringProperty( "region", "emea-west-2" );
+    command.setText( std::string( 1024, 'x' ) );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireMarshalBenchmarkSupport::populate( MessageDispatch& command ) {
+
+    Pointer<ActiveMQTextMessage> message( new ActiveMQTextMessage() );
+    populate( *message );
+
+    command.setConsumerId( createConsumerId() );
+    command.setDestination( message->getDestination() );
+    command.setMessage( message );
+    command.setRedeliveryCounter( 0 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireMarshalBenchmarkSupport::populate( MessageAck& command ) {
+
+    command.setAckType( 2 );
+    command.setConsumerId( createConsumerId() );
+    command.setDestination( Pointer<ActiveMQDestination>( new ActiveMQQueue( "BENCHMARK.QUEUE" ) ) );
+    command.setFirstMessageId( createMessageId() );
+    command.setLastMessageId( createMessageId() );
+    command.setMessageCount( 10 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireMarshalBenchmarkSupport::populate( ProducerAck& command ) {
+
+    command.setProducerId( createProducerId() );
+    command.setSize( 2048 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireMarshalBenchmarkSupport::populate( ConsumerInfo& command ) {
+
+    command.setConsumerId( createConsumerId() );
+    command.setDestination( Pointer<ActiveMQDestination>( new ActiveMQTopic( "BENCHMARK.TOPIC" ) ) );
+    command.setPrefetchSize( 1000 );
+    command.setSelector( "color = 'red'" );
+    command.setDispatchAsync( true );
+    command.setPriority( 0 );
+}
@@ -0,0 +1,108 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_WIREFORMAT_OPENWIRE_OPENWIREMARSHALBENCHMARK_H_
+#define _ACTIVEMQ_WIREFORMAT_OPENWIRE_OPENWIREMARSHALBENCHMARK_H_
+
+#include <benchmark/BenchmarkBase.h>
+
+#include <activemq/wireformat/openwire/OpenWireFormat.h>
+#include <activemq/transport/IOTransport.h>
+#include <activemq/commands/ActiveMQTextMessage.h>
+#include <activemq/commands/ConsumerInfo.h>
+#include <activemq/commands/MessageAck.h>
+#include <activemq/commands/MessageDispatch.h>
+#include <activemq/commands/ProducerAck.h>
+#include <decaf/io/ByteArrayInputStream.h>
+#include <decaf/io/ByteArrayOutputStream.h>
+#include <decaf/io/DataInputStream.h>
+#include <decaf/io/DataOutputStream.h>
+#include <decaf/lang/Pointer.h>
+#include <decaf/util/Properties.h>
+
+namespace activemq{
+namespace wireformat{
+namespace openwire{
+
+    /**
+     * Fills in a command of each benchmarked type with representative content.
+     */
+    class OpenWireMarshalBenchmarkSupport {
+    public:
+
+        static void populate(commands::ActiveMQTextMessage& command);
+        static void populate(commands::MessageDispatch& command);
+        static void populate(commands::MessageAck& command);
+        static void populate(commands::ProducerAck& command);
+        static void populate(commands::ConsumerInfo& command);
+
+    };
+
+    /**
+     * Marshals and then unmarshals one command type through a tight encoding
+     * OpenWireFormat, the same path a command takes through the transport.
+     */
+    template< typename COMMAND >
+    class OpenWireMarshalBenchmark :
+        public benchmark::BenchmarkBase<
+            activemq::wireformat::openwire::OpenWireMarshalBenchmark<COMMAND>, COMMAND >
+    {
+    private:
+
+        OpenWireFormat format;
+        transport::IOTransport transport;
+        decaf::lang::Pointer<commands::Command> command;
+
+    public:
+
+        OpenWireMarshalBenchmark() : format(decaf::util::Properties()), transport(), command() {}
+        virtual ~OpenWireMarshalBenchmark() {}
+
+        void setUp() {
+            format.setVersion( 9 );
+            format.setTightEncodingEnabled( true );
+
+            decaf::lang::Pointer<COMMAND> sample( new COMMAND() );
+            OpenWireMarshalBenchmarkSupport::populate( *sample );
+            command = sample;
+        }
+
+        void run() {
+
+            int numRuns = 1000;
+
+            decaf::io::ByteArrayOutputStream bytesOut;
+            decaf::io::DataOutputStream dataOut( &bytesOut );
+
+            for( int i = 0; i < numRuns; ++i ) {
+                bytesOut.reset();
+                format.marshal( command, &transport, &dataOut );
+
+                std::pair<unsigned char*, int> frame = bytesOut.toByteArray();
+                decaf::io::ByteArrayInputStream bytesIn( frame.first, frame.second, true );
+                decaf::io::DataInputStream dataIn( &bytesIn );
+                decaf::lang::Pointer<commands::Command> result = format.unmarshal( &transport, &dataIn );
+
+                CPPUNIT_ASSERT( result->getDataStructureType() == command->getDataStructureType() );
+            }
+        }
+
+    };
+
+}}}
+
+#endif /*_ACTIVEMQ_WIREFORMAT_OPENWIRE_OPENWIREMARSHALBENCHMARK_H_*/
@@ -0,0 +1,85 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+using namespace benchmark;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    volatile long long allocations = 0;
+
+    inline void countAllocation() {
+#if defined(__GNUC__)
+        __sync_fetch_and_add( &allocations, 1 );
+#endif
+    }
+
+    inline void* allocate( std::size_t size ) {
+
+        countAllocation();
+
+        void* memory = std::malloc( size == 0 ? 1 : size );
+        if( memory == NULL ) {
+            throw std::bad_alloc();
+        }
+
+        return memory;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void* operator new( std::size_t size ) throw( std::bad_alloc ) {
+    return allocate( size );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void* operator new[]( std::size_t size ) throw( std::bad_alloc ) {
+    return allocate( size );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void operator delete( void* memory ) throw() {
+    std::free( memory );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void operator delete[]( void* memory ) throw() {
+    std::free( memory );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool AllocationCounter::isSupported() {
+#if defined(__GNUC__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long AllocationCounter::getAllocations() {
+#if defined(__GNUC__)
+    return __sync_fetch_and_add( &allocations, 0 );
+#else
+    return allocations;
+#endif
+}
@@ -0,0 +1,54 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LatencyRecorder.h"
+
+#include <algorithm>
+
+using namespace std;
+using namespace benchmark;
+
+////////////////////////////////////////////////////////////////////////////////
+LatencyRecorder::LatencyRecorder( std::size_t capacity ) : samples() {
+    samples.reserve( capacity );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+LatencyRecorder::~LatencyRecorder(){
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void LatencyRecorder::reset(){
+    samples.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long LatencyRecorder::getPercentile( double percentile ){
+
+    if( samples.empty() ) {
+        return 0;
+    }
+
+    std::sort( samples.begin(), samples.end() );
+
+    std::size_t rank = (std::size_t)( percentile / 100.0 * (double) samples.size() );
+    if( rank >= samples.size() ) {
+        rank = samples.size() - 1;
+    }
+
+    return samples[rank];
+}
@@ -0,0 +1,83 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _BENCHMARK_LATENCYRECORDER_H_
+#define _BENCHMARK_LATENCYRECORDER_H_
+
+#include <activemq/util/Config.h>
+#include <vector>
+
+namespace benchmark{
+
+    /**
+     * Collects one latency sample per operation and reports percentiles over them.
+     * Storage for the expected number of samples is reserved up front so recording
+     * does not allocate while a benchmark is being measured.  Not thread safe, only
+     * one thread may record at a time.
+     */
+    class LatencyRecorder {
+    private:
+
+        std::vector<long long> samples;
+
+    public:
+
+        /**
+         * @param capacity
+         *      The number of samples to reserve space for.
+         */
+        LatencyRecorder( std::size_t capacity );
+        virtual ~LatencyRecorder();
+
+        /**
+         * Records the latency of one operation.
+         *
+         * @param nanos
+         *      The latency in nanoseconds.
+         */
+        void record( long long nanos ) {
+            samples.push_back( nanos );
+        }
+
+        /**
+         * Throws away all recorded samples.
+         */
+        void reset();
+
+        /**
+         * @returns the number of samples recorded since the last reset.
+         */
+        std::size_t getCount() const {
+            return samples.size();
+        }
+
+        /**
+         * Gets the value below which the given percentage of the samples fall, the
+         * samples are sorted by this call.
+         *
+         * @param percentile
+         *      The percentile to compute, between 0 and 100.
+         *
+         * @returns the latency in nanoseconds, or zero if nothing was recorded.
+         */
+        long long getPercentile( double percentile );
+
+    };
+
+}
+
+#endif /*_BENCHMARK_LATENCYRECORDER_H_*/
@@ -16,6 +16,8 @@
  */
 
 #include "DataInputStreamBenchmark.h"
+#include <decaf/io/ByteArrayOutputStream.h>
+#include <decaf/io/DataOutputStream.h>
 
 using namespace std;
 using namespace decaf;
@@ -25,7 +27,7 @@ using namespace decaf::io;
 const int DataInputStreamBenchmark::bufferSize = 200000;
 
 ////////////////////////////////////////////////////////////////////////////////
-DataInputStreamBenchmark::DataInputStreamBenchmark() : buffer(), bis() {
+DataInputStreamBenchmark::DataInputStreamBenchmark() : buffer(), bis(), utfBuffer(), utfIn() {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -39,6 +41,28 @@ void DataInputStreamBenchmark::setUp(){
     }
     buffer[bufferSize-1] = 0;
     bis.setByteArray( buffer, bufferSize );
+
+    // One long ASCII string, one long string with two byte characters and then the
+    // short strings that most frames are made of.
+    std::string asciiString( 8096, 'a' );
+    std::string latinString( asciiString );
+    for( size_t i = 0; i < latinString.length(); i += 16 ) {
+        latinString[i] = (char) 0xE9;
+    }
+
+    ByteArrayOutputStream bos;
+    DataOutputStream dos( &bos );
+    dos.writeUTF( asciiString );
+    dos.writeUTF( latinString );
+    for( int i = 0; i < 1000; ++i ) {
+        dos.writeUTF( "queue://TEST.QUEUE.ORDERS.INBOUND" );
+    }
+
+    std::pair<unsigned char*, int> bytes = bos.toByteArray();
+    utfBuffer.assign( bytes.first, bytes.first + bytes.second );
+    delete [] bytes.first;
+
+    utfIn.setByteArray( &utfBuffer[0], (int) utfBuffer.size() );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -112,4 +136,15 @@ void DataInputStreamBenchmark::run(){
         stringResult = dis.readString();
         bis.reset();
     }
+
+    DataInputStream utfDis( &utfIn );
+
+    for( int i = 0; i < 100; ++i ) {
+        stringResult = utfDis.readUTF();
+        stringResult = utfDis.readUTF();
+        for( int j = 0; j < 1000; ++j ) {
+            stringResult = utfDis.readUTF();
+        }
+        utfIn.reset();
+    }
 }
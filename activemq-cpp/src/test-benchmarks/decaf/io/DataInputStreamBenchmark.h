@@ -21,6 +21,7 @@
 #include <benchmark/BenchmarkBase.h>
 #include <decaf/io/DataInputStream.h>
 #include <decaf/io/ByteArrayInputStream.h>
+#include <vector>
 
 namespace decaf{
 namespace io{
@@ -33,6 +34,8 @@ namespace io{
 
         unsigned char* buffer;
         ByteArrayInputStream bis;
+        std::vector<unsigned char> utfBuffer;
+        ByteArrayInputStream utfIn;
         static const int bufferSize;
 
     private:
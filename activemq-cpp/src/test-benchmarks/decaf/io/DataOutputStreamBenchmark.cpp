@@ -23,7 +23,7 @@ using namespace decaf;
 using namespace decaf::io;
 
 ////////////////////////////////////////////////////////////////////////////////
-DataOutputStreamBenchmark::DataOutputStreamBenchmark() : testString() {
+DataOutputStreamBenchmark::DataOutputStreamBenchmark() : testString(), latinString(), shortString() {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -32,6 +32,15 @@ void DataOutputStreamBenchmark::setUp(){
     for( size_t i = 0; i < 8096; ++i ) {
         testString += 'a';
     }
+
+    // Mostly ASCII with the occasional character that needs two bytes.
+    latinString = testString;
+    for( size_t i = 0; i < latinString.length(); i += 16 ) {
+        latinString[i] = (char) 0xE9;
+    }
+
+    // Roughly the size of the destination names and ids that make up most frames.
+    shortString = "queue://TEST.QUEUE.ORDERS.INBOUND";
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -78,6 +87,13 @@ void DataOutputStreamBenchmark::run(){
         dos.writeUTF( testString );
         bos.reset();
     }
+    for( int iy = 0; iy < numRuns; ++iy ){
+        dos.writeUTF( latinString );
+        bos.reset();
+    }
+    for( int iy = 0; iy < numRuns * 40; ++iy ){
+        dos.writeUTF( shortString );
+    }
 
     bos.reset();
 }
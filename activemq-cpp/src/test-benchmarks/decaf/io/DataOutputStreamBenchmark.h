@@ -31,6 +31,8 @@ namespace io{
     private:
 
         std::string testString;
+        std::string latinString;
+        std::string shortString;
 
     public:
 
@@ -18,6 +18,28 @@
 #include <activemq/util/PrimitiveMapBenchmark.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::util::PrimitiveMapBenchmark );
 
+#include <activemq/core/ClientPathBenchmark.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::ClientPathBenchmark );
+#include <activemq/core/ExceptionPathBenchmark.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::ExceptionPathBenchmark );
+
+#include <activemq/filter/MessageSelectorBenchmark.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::filter::MessageSelectorBenchmark );
+
+#include <activemq/transport/replay/ReplayBenchmark.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::transport::replay::ReplayBenchmark );
+
+#include <activemq/wireformat/openwire/MessageArenaBenchmark.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::openwire::MessageArenaBenchmark );
+#include <activemq/wireformat/openwire/OpenWireEncodingBenchmark.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::openwire::OpenWireEncodingBenchmark );
+#include <activemq/wireformat/openwire/OpenWireMarshalBenchmark.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::openwire::OpenWireMarshalBenchmark<activemq::commands::ActiveMQTextMessage> );
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::openwire::OpenWireMarshalBenchmark<activemq::commands::MessageDispatch> );
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::openwire::OpenWireMarshalBenchmark<activemq::commands::MessageAck> );
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::openwire::OpenWireMarshalBenchmark<activemq::commands::ProducerAck> );
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::openwire::OpenWireMarshalBenchmark<activemq::commands::ConsumerInfo> );
+
 #include <decaf/lang/BooleanBenchmark.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( decaf::lang::BooleanBenchmark );
 #include <decaf/lang/ThreadBenchmark.h>
@@ -21,6 +21,10 @@
 #include <decaf/lang/Exception.h>
 #include <activemq/commands/ActiveMQBytesMessage.h>
 
+#include <cstdio>
+#include <memory>
+#include <vector>
+
 using namespace std;
 using namespace cms;
 using namespace activemq;
@@ -29,6 +33,21 @@ using namespace activemq::commands;
 using namespace decaf;
 using namespace decaf::lang;
 
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const char* BODY_FILE = "ActiveMQBytesMessageTest.dat";
+
+    void writeBodyFile( int size ) {
+        FILE* file = ::fopen( BODY_FILE, "wb" );
+        CPPUNIT_ASSERT( file != NULL );
+        for( int i = 0; i < size; ++i ) {
+            ::fputc( i % 251, file );
+        }
+        ::fclose( file );
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQBytesMessageTest::testGetBodyLength() {
     ActiveMQBytesMessage msg;
@@ -459,3 +478,76 @@ void ActiveMQBytesMessageTest::testWriteOnlyBody() {
     } catch( MessageNotReadableException& e ) {
     }
 }
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQBytesMessageTest::testBodyFile() {
+
+    writeBodyFile( 1000 );
+
+    ActiveMQBytesMessage message;
+    message.writeInt( 42 );
+    message.setBodyFile( BODY_FILE, 100, 500 );
+
+    CPPUNIT_ASSERT( message.getBodyFile() != NULL );
+    CPPUNIT_ASSERT_EQUAL( 100LL, message.getBodyFile()->getPosition() );
+    CPPUNIT_ASSERT( message.getContent().empty() );
+
+    // Copies share the region without reading it.
+    std::auto_ptr<ActiveMQBytesMessage> copy( message.cloneDataStructure() );
+    CPPUNIT_ASSERT( copy->getBodyFile() == message.getBodyFile() );
+
+    message.reset();
+    CPPUNIT_ASSERT_EQUAL( 500, message.getBodyLength() );
+    CPPUNIT_ASSERT( message.getBodyFile() != NULL );
+
+    std::vector<unsigned char> body( 500 );
+    CPPUNIT_ASSERT_EQUAL( 500, message.readBytes( &body[0], 500 ) );
+    CPPUNIT_ASSERT( message.getBodyFile() == NULL );
+    for( int i = 0; i < 500; ++i ) {
+        CPPUNIT_ASSERT_EQUAL( (unsigned char)( ( 100 + i ) % 251 ), body[i] );
+    }
+
+    copy->loadBodyFile();
+    CPPUNIT_ASSERT( copy->getBodyFile() == NULL );
+    CPPUNIT_ASSERT( copy->getContent() == body );
+
+    message.clearBody();
+    message.setBodyFile( BODY_FILE, 0, 1000 );
+    message.clearBody();
+    CPPUNIT_ASSERT( message.getBodyFile() == NULL );
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw a CMSException for a region past the end of the file",
+        message.setBodyFile( BODY_FILE, 900, 200 ), CMSException );
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw a CMSException for a missing file",
+        message.setBodyFile( "ActiveMQBytesMessageTest.missing", 0, 1 ), CMSException );
+
+    message.reset();
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw a MessageNotWriteableException",
+        message.setBodyFile( BODY_FILE, 0, 10 ), MessageNotWriteableException );
+
+    ::remove( BODY_FILE );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQBytesMessageTest::testBodyFileAppend() {
+
+    writeBodyFile( 16 );
+
+    ActiveMQBytesMessage message;
+    message.setBodyFile( BODY_FILE, 8, 8 );
+    message.writeByte( 255 );
+    CPPUNIT_ASSERT( message.getBodyFile() == NULL );
+
+    message.reset();
+    CPPUNIT_ASSERT_EQUAL( 9, message.getBodyLength() );
+    for( int i = 0; i < 8; ++i ) {
+        CPPUNIT_ASSERT_EQUAL( (unsigned char)( 8 + i ), message.readByte() );
+    }
+    CPPUNIT_ASSERT_EQUAL( (unsigned char)255, message.readByte() );
+
+    ::remove( BODY_FILE );
+}
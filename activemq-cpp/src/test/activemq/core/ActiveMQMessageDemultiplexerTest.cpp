@@ -0,0 +1,406 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ActiveMQMessageDemultiplexerTest.h"
+
+#include <activemq/core/ActiveMQConnectionFactory.h>
+#include <activemq/core/ActiveMQMessageDemultiplexer.h>
+#include <activemq/commands/ActiveMQTextMessage.h>
+#include <activemq/commands/ActiveMQTopic.h>
+#include <activemq/commands/ConsumerInfo.h>
+#include <activemq/commands/MessageDispatch.h>
+#include <activemq/transport/DefaultTransportListener.h>
+
+#include <cms/IllegalStateException.h>
+#include <cms/InvalidSelectorException.h>
+
+#include <decaf/lang/Integer.h>
+#include <decaf/lang/Pointer.h>
+#include <decaf/lang/Thread.h>
+#include <decaf/util/concurrent/CountDownLatch.h>
+#include <decaf/util/concurrent/Mutex.h>
+
+#include <vector>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::core;
+using namespace activemq::commands;
+using namespace activemq::transport;
+using namespace decaf;
+using namespace decaf::lang;
+using namespace decaf::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    class ConsumerInfoCapture : public DefaultTransportListener {
+    public:
+
+        Mutex mutex;
+        std::vector< Pointer<ConsumerInfo> > consumers;
+
+        ConsumerInfoCapture() : mutex(), consumers() {}
+        virtual ~ConsumerInfoCapture() {}
+
+        virtual void onCommand(const Pointer<Command> command) {
+            if (command->isConsumerInfo()) {
+                synchronized(&mutex) {
+                    consumers.push_back(command.dynamicCast<ConsumerInfo>());
+                }
+            }
+        }
+    };
+
+    class RecordingListener : public cms::MessageListener {
+    public:
+
+        Mutex mutex;
+        std::vector<std::string> received;
+
+        RecordingListener() : mutex(), received() {}
+        virtual ~RecordingListener() {}
+
+        virtual void onMessage(const cms::Message* message) {
+            synchronized(&mutex) {
+                const cms::TextMessage* text = dynamic_cast<const cms::TextMessage*>(message);
+                received.push_back(text->getText());
+                mutex.notifyAll();
+            }
+        }
+
+        int size() {
+            synchronized(&mutex) {
+                return (int) received.size();
+            }
+            return 0;
+        }
+
+        std::string get(int index) {
+            synchronized(&mutex) {
+                return received.at(index);
+            }
+            return "";
+        }
+    };
+
+    // Removes itself on the first message it receives.
+    class OneShotListener : public RecordingListener {
+    public:
+
+        ActiveMQMessageDemultiplexer* demux;
+
+        OneShotListener() : RecordingListener(), demux(NULL) {}
+        virtual ~OneShotListener() {}
+
+        virtual void onMessage(const cms::Message* message) {
+            RecordingListener::onMessage(message);
+            demux->removeListener(this);
+        }
+    };
+
+    // Counts down once for each message, used to know when routing has completed.
+    class LatchListener : public cms::MessageListener {
+    public:
+
+        CountDownLatch* latch;
+
+        LatchListener(CountDownLatch* latch) : latch(latch) {}
+        virtual ~LatchListener() {}
+
+        virtual void onMessage(const cms::Message* message AMQCPP_UNUSED) {
+            latch->countDown();
+        }
+    };
+
+    Pointer<MessageDispatch> createDispatch(const std::string& text, const std::string& topic,
+                                            const std::string& color, int sequence,
+                                            const Pointer<ConsumerId>& consumerId) {
+
+        Pointer<ActiveMQTextMessage> msg(new ActiveMQTextMessage());
+
+        Pointer<ProducerId> producerId(new ProducerId());
+        producerId->setConnectionId(consumerId->getConnectionId());
+        producerId->setSessionId(consumerId->getSessionId());
+        producerId->setValue(1);
+
+        Pointer<MessageId> messageId(new MessageId());
+        messageId->setProducerId(producerId);
+        messageId->setProducerSequenceId(sequence);
+
+        ActiveMQTopic destination(topic);
+
+        msg->setText(text);
+        msg->setCMSDestination(&destination);
+        msg->setMessageId(messageId);
+        if (!color.empty()) {
+            msg->setStringProperty("color", color);
+        }
+
+        Pointer<MessageDispatch> dispatch(new MessageDispatch());
+        dispatch->setMessage(msg);
+        dispatch->setDestination(msg->getDestination());
+        dispatch->setConsumerId(consumerId);
+
+        return dispatch;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ActiveMQMessageDemultiplexerTest::ActiveMQMessageDemultiplexerTest() : connection(), transport(NULL) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ActiveMQMessageDemultiplexerTest::~ActiveMQMessageDemultiplexerTest() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQMessageDemultiplexerTest::setUp() {
+
+    ActiveMQConnectionFactory factory("mock://127.0.0.1:12345?wireFormat=openwire");
+
+    connection.reset(dynamic_cast<ActiveMQConnection*>(factory.createConnection()));
+
+    transport = dynamic_cast<transport::mock::MockTransport*>(
+        connection->getTransport().narrow(typeid(transport::mock::MockTransport)));
+    CPPUNIT_ASSERT(transport != NULL);
+
+    connection->start();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQMessageDemultiplexerTest::tearDown() {
+    transport = NULL;
+    connection.reset(NULL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQMessageDemultiplexerTest::testSingleSubscription() {
+
+    ConsumerInfoCapture capture;
+    transport->setOutgoingListener(&capture);
+
+    ActiveMQTopic wildcard("PRICES.>");
+    ActiveMQMessageDemultiplexer demux(connection.get(), &wildcard);
+
+    std::vector<RecordingListener*> listeners;
+    for (int i = 0; i < 100; ++i) {
+        ActiveMQTopic topic(std::string("PRICES.") + decaf::lang::Integer::toString(i));
+        listeners.push_back(new RecordingListener());
+        demux.addListener(&topic, listeners.back());
+    }
+
+    CPPUNIT_ASSERT_EQUAL(100, demux.getRouteCount());
+    CPPUNIT_ASSERT_EQUAL(1, (int) capture.consumers.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("PRICES.>"),
+                         capture.consumers[0]->getDestination()->getPhysicalName());
+
+    demux.close();
+    transport->setOutgoingListener(NULL);
+
+    for (std::size_t i = 0; i < listeners.size(); ++i) {
+        delete listeners[i];
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQMessageDemultiplexerTest::testRouteByDestination() {
+
+    ConsumerInfoCapture capture;
+    transport->setOutgoingListener(&capture);
+
+    ActiveMQTopic wildcard("PRICES.>");
+    ActiveMQTopic topicA("PRICES.A");
+    ActiveMQTopic topicB("PRICES.B");
+
+    RecordingListener listenerA;
+    RecordingListener listenerB;
+    RecordingListener unmatched;
+    CountDownLatch done(4);
+    LatchListener latch(&done);
+
+    ActiveMQMessageDemultiplexer demux(connection.get(), &wildcard);
+    demux.addListener(&topicA, &listenerA);
+    demux.addListener(&topicB, &listenerB);
+    demux.addListener("", &latch);
+    demux.setDefaultListener(&unmatched);
+
+    Pointer<ConsumerId> id = capture.consumers.at(0)->getConsumerId();
+    transport->setOutgoingListener(NULL);
+
+    transport->fireCommand(createDispatch("a1", "PRICES.A", "", 1, id));
+    transport->fireCommand(createDispatch("b1", "PRICES.B", "", 2, id));
+    transport->fireCommand(createDispatch("a2", "PRICES.A", "", 3, id));
+    transport->fireCommand(createDispatch("c1", "PRICES.C", "", 4, id));
+
+    CPPUNIT_ASSERT(done.await(2000));
+
+    CPPUNIT_ASSERT_EQUAL(2, listenerA.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("a1"), listenerA.get(0));
+    CPPUNIT_ASSERT_EQUAL(std::string("a2"), listenerA.get(1));
+    CPPUNIT_ASSERT_EQUAL(1, listenerB.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("b1"), listenerB.get(0));
+
+    // The catch all route matched PRICES.C so the default listener is not used.
+    CPPUNIT_ASSERT_EQUAL(0, unmatched.size());
+    CPPUNIT_ASSERT_EQUAL(4LL, demux.getRoutedCount());
+
+    demux.removeListener(&latch);
+    transport->fireCommand(createDispatch("c2", "PRICES.C", "", 5, id));
+    transport->fireCommand(createDispatch("b2", "PRICES.B", "", 6, id));
+
+    for (int i = 0; i < 100 && listenerB.size() < 2; ++i) {
+        Thread::sleep(20);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(1, unmatched.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("c2"), unmatched.get(0));
+    CPPUNIT_ASSERT_EQUAL(1LL, demux.getUnroutedCount());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQMessageDemultiplexerTest::testRouteBySelector() {
+
+    ConsumerInfoCapture capture;
+    transport->setOutgoingListener(&capture);
+
+    ActiveMQTopic wildcard("PRICES.>");
+    RecordingListener red;
+    RecordingListener blue;
+    CountDownLatch done(3);
+    LatchListener latch(&done);
+
+    ActiveMQMessageDemultiplexer demux(connection.get(), &wildcard);
+    demux.addListener("color = 'red'", &red);
+    demux.addListener("color IN ('blue', 'navy')", &blue);
+    demux.addListener("", &latch);
+
+    Pointer<ConsumerId> id = capture.consumers.at(0)->getConsumerId();
+    transport->setOutgoingListener(NULL);
+
+    transport->fireCommand(createDispatch("1", "PRICES.A", "red", 1, id));
+    transport->fireCommand(createDispatch("2", "PRICES.B", "navy", 2, id));
+    transport->fireCommand(createDispatch("3", "PRICES.C", "green", 3, id));
+
+    CPPUNIT_ASSERT(done.await(2000));
+
+    CPPUNIT_ASSERT_EQUAL(1, red.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("1"), red.get(0));
+    CPPUNIT_ASSERT_EQUAL(1, blue.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("2"), blue.get(0));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQMessageDemultiplexerTest::testRouteByDestinationAndSelector() {
+
+    ConsumerInfoCapture capture;
+    transport->setOutgoingListener(&capture);
+
+    ActiveMQTopic wildcard("PRICES.>");
+    ActiveMQTopic topicA("PRICES.A");
+    RecordingListener redA;
+    CountDownLatch done(3);
+    LatchListener latch(&done);
+
+    ActiveMQMessageDemultiplexer demux(connection.get(), &wildcard);
+    demux.addListener(&topicA, "color = 'red'", &redA);
+    demux.addListener("", &latch);
+
+    Pointer<ConsumerId> id = capture.consumers.at(0)->getConsumerId();
+    transport->setOutgoingListener(NULL);
+
+    transport->fireCommand(createDispatch("1", "PRICES.A", "blue", 1, id));
+    transport->fireCommand(createDispatch("2", "PRICES.B", "red", 2, id));
+    transport->fireCommand(createDispatch("3", "PRICES.A", "red", 3, id));
+
+    CPPUNIT_ASSERT(done.await(2000));
+
+    CPPUNIT_ASSERT_EQUAL(1, redA.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("3"), redA.get(0));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQMessageDemultiplexerTest::testRemoveListener() {
+
+    ConsumerInfoCapture capture;
+    transport->setOutgoingListener(&capture);
+
+    ActiveMQTopic wildcard("PRICES.>");
+    ActiveMQTopic topicA("PRICES.A");
+    OneShotListener oneShot;
+    CountDownLatch done(2);
+    LatchListener latch(&done);
+
+    ActiveMQMessageDemultiplexer demux(connection.get(), &wildcard);
+    oneShot.demux = &demux;
+    demux.addListener(&topicA, &oneShot);
+    demux.addListener("", &latch);
+    CPPUNIT_ASSERT_EQUAL(2, demux.getRouteCount());
+
+    Pointer<ConsumerId> id = capture.consumers.at(0)->getConsumerId();
+    transport->setOutgoingListener(NULL);
+
+    transport->fireCommand(createDispatch("1", "PRICES.A", "", 1, id));
+    transport->fireCommand(createDispatch("2", "PRICES.A", "", 2, id));
+
+    CPPUNIT_ASSERT(done.await(2000));
+
+    CPPUNIT_ASSERT_EQUAL(1, oneShot.size());
+    CPPUNIT_ASSERT_EQUAL(1, demux.getRouteCount());
+    CPPUNIT_ASSERT(!demux.removeListener(&oneShot));
+    CPPUNIT_ASSERT(demux.removeListener(&latch));
+    CPPUNIT_ASSERT_EQUAL(0, demux.getRouteCount());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQMessageDemultiplexerTest::testInvalidSelector() {
+
+    ActiveMQTopic wildcard("PRICES.>");
+    RecordingListener listener;
+
+    ActiveMQMessageDemultiplexer demux(connection.get(), &wildcard);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an InvalidSelectorException",
+        demux.addListener("color = ", &listener),
+        cms::InvalidSelectorException);
+
+    CPPUNIT_ASSERT_EQUAL(0, demux.getRouteCount());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQMessageDemultiplexerTest::testClose() {
+
+    ActiveMQTopic wildcard("PRICES.>");
+    ActiveMQTopic topicA("PRICES.A");
+    RecordingListener listener;
+
+    ActiveMQMessageDemultiplexer demux(connection.get(), &wildcard);
+    demux.addListener(&topicA, &listener);
+
+    demux.close();
+    CPPUNIT_ASSERT(demux.isClosed());
+    CPPUNIT_ASSERT_EQUAL(0, demux.getRouteCount());
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IllegalStateException",
+        demux.addListener(&topicA, &listener),
+        cms::IllegalStateException);
+
+    // Closing again is a no-op.
+    demux.close();
+}
@@ -0,0 +1,74 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_CORE_ACTIVEMQMESSAGEDEMULTIPLEXERTEST_H_
+#define _ACTIVEMQ_CORE_ACTIVEMQMESSAGEDEMULTIPLEXERTEST_H_
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <activemq/core/ActiveMQConnection.h>
+#include <activemq/transport/mock/MockTransport.h>
+
+#include <memory>
+
+namespace activemq {
+namespace core {
+
+    class ActiveMQMessageDemultiplexerTest : public CppUnit::TestFixture {
+
+        CPPUNIT_TEST_SUITE( ActiveMQMessageDemultiplexerTest );
+        CPPUNIT_TEST( testSingleSubscription );
+        CPPUNIT_TEST( testRouteByDestination );
+        CPPUNIT_TEST( testRouteBySelector );
+        CPPUNIT_TEST( testRouteByDestinationAndSelector );
+        CPPUNIT_TEST( testRemoveListener );
+        CPPUNIT_TEST( testInvalidSelector );
+        CPPUNIT_TEST( testClose );
+        CPPUNIT_TEST_SUITE_END();
+
+    private:
+
+        std::auto_ptr<ActiveMQConnection> connection;
+        transport::mock::MockTransport* transport;
+
+    private:
+
+        ActiveMQMessageDemultiplexerTest(const ActiveMQMessageDemultiplexerTest&);
+        ActiveMQMessageDemultiplexerTest& operator= (const ActiveMQMessageDemultiplexerTest&);
+
+    public:
+
+        ActiveMQMessageDemultiplexerTest();
+        virtual ~ActiveMQMessageDemultiplexerTest();
+
+        virtual void setUp();
+        virtual void tearDown();
+
+        void testSingleSubscription();
+        void testRouteByDestination();
+        void testRouteBySelector();
+        void testRouteByDestinationAndSelector();
+        void testRemoveListener();
+        void testInvalidSelector();
+        void testClose();
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_CORE_ACTIVEMQMESSAGEDEMULTIPLEXERTEST_H_ */
@@ -18,16 +18,30 @@
 #include "ActiveMQSessionTest.h"
 
 #include <cms/ExceptionListener.h>
+#include <cms/InvalidSelectorException.h>
 #include <activemq/transport/mock/MockTransportFactory.h>
 #include <activemq/transport/TransportRegistry.h>
 #include <activemq/commands/ActiveMQTextMessage.h>
+#include <activemq/commands/ConsumerControl.h>
 #include <activemq/commands/ConsumerId.h>
 #include <activemq/commands/MessageDispatch.h>
+#include <activemq/commands/MessagePull.h>
+#include <activemq/commands/ProducerAck.h>
 #include <activemq/core/ActiveMQConnectionFactory.h>
 #include <activemq/core/ActiveMQSession.h>
 #include <activemq/core/ActiveMQConsumer.h>
 #include <activemq/core/ActiveMQProducer.h>
+#include <activemq/core/AdaptivePrefetchController.h>
+#include <activemq/core/PrefetchPolicy.h>
+#include <activemq/transport/DefaultTransportListener.h>
+#include <activemq/util/MemoryUsage.h>
+#include <activemq/util/LatencyStatistics.h>
+#include <decaf/io/IOException.h>
 #include <decaf/util/Properties.h>
+#include <decaf/util/concurrent/CountDownLatch.h>
+#include <decaf/util/concurrent/atomic/AtomicBoolean.h>
+#include <decaf/util/concurrent/atomic/AtomicInteger.h>
+#include <decaf/lang/Integer.h>
 #include <decaf/lang/System.h>
 #include <decaf/lang/Pointer.h>
 #include <decaf/lang/Thread.h>
@@ -434,6 +448,97 @@ void ActiveMQSessionTest::testTransactionRollbackOneConsumer() {
     session->commit();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testTransactionRollbackWithRedeliveryDelay() {
+
+    MyCMSMessageListener msgListener;
+
+    connection->getRedeliveryPolicy()->setInitialRedeliveryDelay(300);
+
+    std::auto_ptr<cms::Session> session(
+        connection->createSession(cms::Session::SESSION_TRANSACTED));
+    std::auto_ptr<cms::Topic> topic(session->createTopic("TestTopic1"));
+    std::auto_ptr<ActiveMQConsumer> consumer(
+        dynamic_cast<ActiveMQConsumer*>(session->createConsumer(topic.get())));
+
+    consumer->setMessageListener(&msgListener);
+
+    const unsigned int msgCount = 10;
+
+    for (unsigned int i = 0; i < msgCount; ++i) {
+        injectTextMessage("Redelivered", *topic, *(consumer->getConsumerId()));
+    }
+
+    msgListener.asyncWaitForMessages(msgCount);
+    CPPUNIT_ASSERT_EQUAL((size_t) msgCount, msgListener.messages.size());
+    msgListener.clear();
+
+    long long start = System::currentTimeMillis();
+    session->rollback();
+
+    // The consumer is held stopped until the session restarts it.
+    Thread::sleep(100);
+    synchronized(&msgListener.mutex) {
+        CPPUNIT_ASSERT_EQUAL((size_t) 0, msgListener.messages.size());
+    }
+
+    msgListener.asyncWaitForMessages(msgCount);
+    CPPUNIT_ASSERT_EQUAL((size_t) msgCount, msgListener.messages.size());
+    CPPUNIT_ASSERT(System::currentTimeMillis() - start >= 250);
+
+    session->commit();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testNonBlockingRedelivery() {
+
+    MyCMSMessageListener msgListener;
+
+    connection->setNonBlockingRedelivery(true);
+    connection->getRedeliveryPolicy()->setInitialRedeliveryDelay(300);
+
+    std::auto_ptr<cms::Session> session(
+        connection->createSession(cms::Session::SESSION_TRANSACTED));
+    std::auto_ptr<cms::Topic> topic(session->createTopic("TestTopic1"));
+    std::auto_ptr<ActiveMQConsumer> consumer(
+        dynamic_cast<ActiveMQConsumer*>(session->createConsumer(topic.get())));
+
+    consumer->setMessageListener(&msgListener);
+
+    const unsigned int msgCount = 10;
+
+    for (unsigned int i = 0; i < msgCount; ++i) {
+        injectTextMessage(Integer::toString(i), *topic, *(consumer->getConsumerId()));
+    }
+
+    msgListener.asyncWaitForMessages(msgCount);
+    CPPUNIT_ASSERT_EQUAL((size_t) msgCount, msgListener.messages.size());
+    msgListener.clear();
+
+    long long start = System::currentTimeMillis();
+    session->rollback();
+
+    // Messages arriving while the rolled back ones wait are delivered right away.
+    injectTextMessage(Integer::toString(msgCount), *topic, *(consumer->getConsumerId()));
+    msgListener.asyncWaitForMessages(1);
+    synchronized(&msgListener.mutex) {
+        CPPUNIT_ASSERT_EQUAL((size_t) 1, msgListener.messages.size());
+    }
+
+    msgListener.asyncWaitForMessages(msgCount + 1);
+    CPPUNIT_ASSERT_EQUAL((size_t) msgCount + 1, msgListener.messages.size());
+    CPPUNIT_ASSERT(System::currentTimeMillis() - start >= 250);
+
+    // The rolled back messages come back in the order they were first delivered.
+    for (unsigned int i = 0; i < msgCount; ++i) {
+        cms::TextMessage* message = dynamic_cast<cms::TextMessage*>(msgListener.messages[i + 1].get());
+        CPPUNIT_ASSERT(message != NULL);
+        CPPUNIT_ASSERT_EQUAL(Integer::toString(i), message->getText());
+    }
+
+    session->commit();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQSessionTest::testTransactionRollbackTwoConsumer() {
 
@@ -658,6 +763,700 @@ void ActiveMQSessionTest::testTransactionCommitAfterConsumerClosed() {
     msgListener1.clear();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    Pointer<MessageDispatch> createColoredDispatch(const std::string& color, int sequence,
+                                                   const cms::Destination& destination,
+                                                   const commands::ConsumerId& id) {
+
+        Pointer<ActiveMQTextMessage> msg(new ActiveMQTextMessage());
+
+        Pointer<ProducerId> producerId(new ProducerId());
+        producerId->setConnectionId(id.getConnectionId());
+        producerId->setSessionId(id.getSessionId());
+        producerId->setValue(1);
+
+        Pointer<MessageId> messageId(new MessageId());
+        messageId->setProducerId(producerId);
+        messageId->setProducerSequenceId(sequence);
+
+        msg->setText(color);
+        msg->setCMSDestination(&destination);
+        msg->setMessageId(messageId);
+        msg->setStringProperty("color", color);
+
+        Pointer<MessageDispatch> dispatch(new MessageDispatch());
+        dispatch->setMessage(msg);
+        dispatch->setConsumerId(Pointer<ConsumerId>(id.cloneDataStructure()));
+
+        return dispatch;
+    }
+
+    class ConsumerControlCapture : public activemq::transport::DefaultTransportListener {
+    public:
+
+        decaf::util::concurrent::Mutex mutex;
+        std::vector< Pointer<ConsumerControl> > controls;
+
+        ConsumerControlCapture() : mutex(), controls() {}
+        virtual ~ConsumerControlCapture() {}
+
+        virtual void onCommand(const Pointer<Command> command) {
+            if (command->isConsumerControl()) {
+                synchronized(&mutex) {
+                    controls.push_back(command.dynamicCast<ConsumerControl>());
+                }
+            }
+        }
+
+        int waitForControls(int count) {
+            for (int i = 0; i < 200; ++i) {
+                synchronized(&mutex) {
+                    if ((int) controls.size() >= count) {
+                        return (int) controls.size();
+                    }
+                }
+                Thread::sleep(10);
+            }
+            synchronized(&mutex) {
+                return (int) controls.size();
+            }
+            return 0;
+        }
+    };
+
+    class FailingControlCapture : public ConsumerControlCapture {
+    public:
+
+        decaf::util::concurrent::atomic::AtomicInteger failures;
+
+        FailingControlCapture(int failures) : ConsumerControlCapture(), failures(failures) {}
+        virtual ~FailingControlCapture() {}
+
+        virtual void onCommand(const Pointer<Command> command) {
+            if (command->isConsumerControl() && failures.decrementAndGet() >= 0) {
+                throw decaf::io::IOException(__FILE__, __LINE__, "Failed to send ConsumerControl");
+            }
+            ConsumerControlCapture::onCommand(command);
+        }
+    };
+
+    class MessagePullCapture : public activemq::transport::DefaultTransportListener {
+    public:
+
+        decaf::util::concurrent::Mutex mutex;
+        std::vector< Pointer<MessagePull> > pulls;
+
+        MessagePullCapture() : mutex(), pulls() {}
+        virtual ~MessagePullCapture() {}
+
+        virtual void onCommand(const Pointer<Command> command) {
+            if (command->isMessagePull()) {
+                synchronized(&mutex) {
+                    pulls.push_back(command.dynamicCast<MessagePull>());
+                }
+            }
+        }
+
+        int size() {
+            synchronized(&mutex) {
+                return (int) pulls.size();
+            }
+            return 0;
+        }
+    };
+
+    class BlockingAsyncCallback : public cms::AsyncCallback {
+    public:
+
+        decaf::util::concurrent::CountDownLatch release;
+        decaf::util::concurrent::CountDownLatch completed;
+        decaf::util::concurrent::atomic::AtomicInteger successes;
+        std::string threadName;
+
+        BlockingAsyncCallback(int expected) :
+            release(1), completed(expected), successes(), threadName() {}
+        virtual ~BlockingAsyncCallback() {}
+
+        virtual void onSuccess() {
+            threadName = Thread::currentThread()->getName();
+            release.await();
+            successes.incrementAndGet();
+            completed.countDown();
+        }
+
+        virtual void onException(const cms::CMSException& ex) {
+            completed.countDown();
+        }
+    };
+
+    class AsyncSendTask : public Runnable {
+    public:
+
+        cms::MessageProducer* producer;
+        cms::Message* message;
+        cms::AsyncCallback* callback;
+        decaf::util::concurrent::atomic::AtomicBoolean done;
+
+        AsyncSendTask(cms::MessageProducer* producer, cms::Message* message, cms::AsyncCallback* callback) :
+            producer(producer), message(message), callback(callback), done(false) {}
+        virtual ~AsyncSendTask() {}
+
+        virtual void run() {
+            try {
+                producer->send(message, callback);
+            } catch(...) {}
+            done.set(true);
+        }
+
+    private:
+
+        AsyncSendTask(const AsyncSendTask&);
+        AsyncSendTask& operator= (const AsyncSendTask&);
+    };
+
+    class BlockedSendTask : public Runnable {
+    public:
+
+        cms::MessageProducer* producer;
+        cms::Message* message;
+        decaf::util::concurrent::atomic::AtomicBoolean failed;
+        decaf::util::concurrent::atomic::AtomicBoolean done;
+
+        BlockedSendTask(cms::MessageProducer* producer, cms::Message* message) :
+            producer(producer), message(message), failed(false), done(false) {}
+        virtual ~BlockedSendTask() {}
+
+        virtual void run() {
+            try {
+                producer->send(message);
+            } catch(cms::CMSException& ex) {
+                failed.set(true);
+            }
+            done.set(true);
+        }
+
+    private:
+
+        BlockedSendTask(const BlockedSendTask&);
+        BlockedSendTask& operator= (const BlockedSendTask&);
+    };
+
+    class DelayingMessageListener : public cms::MessageListener {
+    public:
+
+        int delay;
+        decaf::util::concurrent::CountDownLatch done;
+
+        DelayingMessageListener(int delay, int count) : delay(delay), done(count) {}
+        virtual ~DelayingMessageListener() {}
+
+        virtual void onMessage(const cms::Message* message AMQCPP_UNUSED) {
+            if (delay > 0) {
+                Thread::sleep(delay);
+            }
+            done.countDown();
+        }
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testLocalSelectorFiltering() {
+
+    MyCMSMessageListener msgListener;
+
+    CPPUNIT_ASSERT( connection.get() != NULL );
+    connection->setLocalSelectorFiltering(true);
+
+    // Synchronous receive is not allowed on a session with a listener so use two.
+    std::auto_ptr<cms::Session> session( connection->createSession() );
+    std::auto_ptr<cms::Session> listenerSession( connection->createSession() );
+    std::auto_ptr<cms::Topic> topic1( session->createTopic( "TestTopic1" ) );
+    std::auto_ptr<cms::Topic> topic2( session->createTopic( "TestTopic2" ) );
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an InvalidSelectorException",
+        session->createConsumer( topic1.get(), "color = " ),
+        cms::InvalidSelectorException );
+
+    std::auto_ptr<ActiveMQConsumer> consumer1(
+        dynamic_cast<ActiveMQConsumer*>( session->createConsumer( topic1.get(), "color = 'red'" ) ) );
+    std::auto_ptr<ActiveMQConsumer> consumer2(
+        dynamic_cast<ActiveMQConsumer*>( listenerSession->createConsumer( topic2.get(), "color IN ('red', 'green')" ) ) );
+
+    consumer2->setMessageListener( &msgListener );
+
+    // Synchronous consumer only ever sees the matching message.
+    dTransport->fireCommand( createColoredDispatch( "blue", 1, *topic1, *( consumer1->getConsumerId() ) ) );
+    dTransport->fireCommand( createColoredDispatch( "red", 2, *topic1, *( consumer1->getConsumerId() ) ) );
+
+    std::auto_ptr<cms::Message> received( consumer1->receive( 2000 ) );
+    CPPUNIT_ASSERT( received.get() != NULL );
+    CPPUNIT_ASSERT_EQUAL( std::string( "red" ), received->getStringProperty( "color" ) );
+    received.reset( consumer1->receiveNoWait() );
+    CPPUNIT_ASSERT( received.get() == NULL );
+
+    // Asynchronous listener is not handed the non-matching message.
+    dTransport->fireCommand( createColoredDispatch( "blue", 3, *topic2, *( consumer2->getConsumerId() ) ) );
+    dTransport->fireCommand( createColoredDispatch( "green", 4, *topic2, *( consumer2->getConsumerId() ) ) );
+
+    msgListener.asyncWaitForMessages( 1 );
+    Thread::sleep( 50 );
+
+    CPPUNIT_ASSERT_EQUAL( 1, (int) msgListener.messages.size() );
+    CPPUNIT_ASSERT_EQUAL( std::string( "green" ), msgListener.messages[0]->getStringProperty( "color" ) );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testAdaptivePrefetch() {
+
+    CPPUNIT_ASSERT( connection.get() != NULL );
+    connection->setAdaptivePrefetch( true );
+
+    std::auto_ptr<cms::Session> session( connection->createSession() );
+    std::auto_ptr<cms::Topic> topic1( session->createTopic( "TestTopic1" ) );
+    std::auto_ptr<ActiveMQConsumer> consumer(
+        dynamic_cast<ActiveMQConsumer*>( session->createConsumer( topic1.get() ) ) );
+
+    const AdaptivePrefetchController* controller = consumer->getAdaptivePrefetchController();
+    CPPUNIT_ASSERT( controller != NULL );
+
+    ConsumerControlCapture capture;
+    dTransport->setOutgoingListener( &capture );
+
+    // A listener taking 5ms a message can only get through about 200 a second.
+    const int count = AdaptivePrefetchController::DEFAULT_SAMPLE_SIZE;
+    DelayingMessageListener listener( 5, count );
+    consumer->setMessageListener( &listener );
+
+    for( int i = 0; i < count; ++i ) {
+        dTransport->fireCommand( createColoredDispatch( "red", i + 1, *topic1, *( consumer->getConsumerId() ) ) );
+    }
+
+    CPPUNIT_ASSERT( listener.done.await( 5000 ) );
+    CPPUNIT_ASSERT( capture.waitForControls( 1 ) >= 1 );
+    dTransport->setOutgoingListener( NULL );
+
+    Pointer<ConsumerControl> control = capture.controls.back();
+    CPPUNIT_ASSERT( control->getConsumerId()->equals( consumer->getConsumerId().get() ) );
+    CPPUNIT_ASSERT( control->getPrefetch() > 0 );
+    CPPUNIT_ASSERT( control->getPrefetch() <= 200 );
+    CPPUNIT_ASSERT_EQUAL( control->getPrefetch(), controller->getWindow() );
+    CPPUNIT_ASSERT_EQUAL( control->getPrefetch(), consumer->getConsumerInfo()->getPrefetchSize() );
+    CPPUNIT_ASSERT( connection->getReservedPrefetchMemory() > 0 );
+
+    consumer->close();
+    CPPUNIT_ASSERT_EQUAL( 0LL, connection->getReservedPrefetchMemory() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testAdaptivePrefetchMemoryLimit() {
+
+    CPPUNIT_ASSERT( connection.get() != NULL );
+    connection->setAdaptivePrefetch( true );
+    connection->setAdaptivePrefetchMemoryLimit( 64 * 1024 );
+
+    std::auto_ptr<cms::Session> session( connection->createSession() );
+    std::auto_ptr<cms::Topic> topic1( session->createTopic( "TestTopic1" ) );
+    std::auto_ptr<ActiveMQConsumer> consumer(
+        dynamic_cast<ActiveMQConsumer*>( session->createConsumer( topic1.get() ) ) );
+
+    ConsumerControlCapture capture;
+    dTransport->setOutgoingListener( &capture );
+
+    // A listener that does no work would be given the maximum window if not for the limit.
+    const int count = AdaptivePrefetchController::DEFAULT_SAMPLE_SIZE;
+    DelayingMessageListener listener( 0, count );
+    consumer->setMessageListener( &listener );
+
+    for( int i = 0; i < count; ++i ) {
+        dTransport->fireCommand( createColoredDispatch( "red", i + 1, *topic1, *( consumer->getConsumerId() ) ) );
+    }
+
+    CPPUNIT_ASSERT( listener.done.await( 5000 ) );
+    CPPUNIT_ASSERT( capture.waitForControls( 1 ) >= 1 );
+    dTransport->setOutgoingListener( NULL );
+
+    const AdaptivePrefetchController* controller = consumer->getAdaptivePrefetchController();
+    long long messageSize = controller->getAverageMessageSize();
+    CPPUNIT_ASSERT( messageSize > 0 );
+
+    int window = capture.controls.back()->getPrefetch();
+    CPPUNIT_ASSERT( window >= 1 );
+    CPPUNIT_ASSERT( (long long) window <= ( 64 * 1024 ) / messageSize );
+    CPPUNIT_ASSERT( connection->getReservedPrefetchMemory() <= 64 * 1024 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testInboundMemoryLimit() {
+
+    CPPUNIT_ASSERT( connection.get() != NULL );
+
+    std::auto_ptr<cms::Session> session( connection->createSession() );
+    std::auto_ptr<cms::Topic> topic1( session->createTopic( "TestTopic1" ) );
+    std::auto_ptr<ActiveMQConsumer> consumer(
+        dynamic_cast<ActiveMQConsumer*>( session->createConsumer( topic1.get() ) ) );
+
+    ConsumerControlCapture capture;
+    dTransport->setOutgoingListener( &capture );
+
+    Pointer<activemq::util::MemoryUsage> usage = connection->getInboundMemoryUsage();
+    CPPUNIT_ASSERT( usage != NULL );
+    CPPUNIT_ASSERT_EQUAL( 0ULL, usage->getUsage() );
+
+    // Measure what one buffered message costs and allow four of them.
+    dTransport->fireCommand( createColoredDispatch( "red", 1, *topic1, *( consumer->getConsumerId() ) ) );
+    for( int i = 0; i < 200 && usage->getUsage() == 0; ++i ) {
+        Thread::sleep( 10 );
+    }
+    unsigned long long messageSize = usage->getUsage();
+    CPPUNIT_ASSERT( messageSize > 0 );
+
+    connection->setInboundMemoryLimit( (long long) ( 4 * messageSize ) );
+    CPPUNIT_ASSERT( !connection->isInboundMemoryThrottled() );
+
+    for( int i = 1; i < 4; ++i ) {
+        dTransport->fireCommand( createColoredDispatch( "red", i + 1, *topic1, *( consumer->getConsumerId() ) ) );
+    }
+
+    CPPUNIT_ASSERT_EQUAL( 1, capture.waitForControls( 1 ) );
+    CPPUNIT_ASSERT( connection->isInboundMemoryThrottled() );
+    CPPUNIT_ASSERT_EQUAL( 0, capture.controls.back()->getPrefetch() );
+    CPPUNIT_ASSERT( capture.controls.back()->getConsumerId()->equals( *( consumer->getConsumerId() ) ) );
+    CPPUNIT_ASSERT_EQUAL( 4 * messageSize, usage->getUsage() );
+
+    // Draining to half of the limit restores the consumer's prefetch.
+    for( int i = 0; i < 2; ++i ) {
+        std::auto_ptr<cms::Message> message( consumer->receive( 2000 ) );
+        CPPUNIT_ASSERT( message.get() != NULL );
+    }
+
+    CPPUNIT_ASSERT_EQUAL( 2, capture.waitForControls( 2 ) );
+    CPPUNIT_ASSERT( !connection->isInboundMemoryThrottled() );
+    CPPUNIT_ASSERT( capture.controls.back()->getPrefetch() > 0 );
+    CPPUNIT_ASSERT_EQUAL( 2 * messageSize, usage->getUsage() );
+
+    // Closing the consumer returns whatever it still held.
+    consumer->close();
+    CPPUNIT_ASSERT_EQUAL( 0ULL, usage->getUsage() );
+    dTransport->setOutgoingListener( NULL );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testInboundMemoryThrottleFailure() {
+
+    CPPUNIT_ASSERT( connection.get() != NULL );
+
+    // The first ConsumerControl sent fails, the other session must still be updated.
+    FailingControlCapture capture( 1 );
+
+    std::auto_ptr<cms::Session> session1( connection->createSession() );
+    std::auto_ptr<cms::Session> session2( connection->createSession() );
+    std::auto_ptr<cms::Topic> topic1( session1->createTopic( "TestTopic1" ) );
+    std::auto_ptr<cms::Topic> topic2( session2->createTopic( "TestTopic2" ) );
+    std::auto_ptr<ActiveMQConsumer> consumer1(
+        dynamic_cast<ActiveMQConsumer*>( session1->createConsumer( topic1.get() ) ) );
+    std::auto_ptr<ActiveMQConsumer> consumer2(
+        dynamic_cast<ActiveMQConsumer*>( session2->createConsumer( topic2.get() ) ) );
+
+    dTransport->setOutgoingListener( &capture );
+
+    Pointer<activemq::util::MemoryUsage> usage = connection->getInboundMemoryUsage();
+    dTransport->fireCommand( createColoredDispatch( "red", 1, *topic1, *( consumer1->getConsumerId() ) ) );
+    for( int i = 0; i < 200 && usage->getUsage() == 0; ++i ) {
+        Thread::sleep( 10 );
+    }
+    unsigned long long messageSize = usage->getUsage();
+    CPPUNIT_ASSERT( messageSize > 0 );
+
+    connection->setInboundMemoryLimit( (long long) ( 2 * messageSize ) );
+    dTransport->fireCommand( createColoredDispatch( "red", 2, *topic1, *( consumer1->getConsumerId() ) ) );
+
+    CPPUNIT_ASSERT( capture.waitForControls( 1 ) >= 1 );
+    CPPUNIT_ASSERT( connection->isInboundMemoryThrottled() );
+    for( int i = 0; i < 200 && !exListener.caughtOne; ++i ) {
+        Thread::sleep( 10 );
+    }
+    CPPUNIT_ASSERT( exListener.caughtOne );
+
+    // The next inbound message retries both sessions, unless an earlier check already did.
+    dTransport->fireCommand( createColoredDispatch( "red", 1, *topic2, *( consumer2->getConsumerId() ) ) );
+
+    CPPUNIT_ASSERT_EQUAL( 3, capture.waitForControls( 3 ) );
+    synchronized( &capture.mutex ) {
+        for( std::size_t i = 0; i < capture.controls.size(); ++i ) {
+            CPPUNIT_ASSERT_EQUAL( 0, capture.controls[i]->getPrefetch() );
+        }
+    }
+
+    dTransport->setOutgoingListener( NULL );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testPipelinedPull() {
+
+    CPPUNIT_ASSERT( connection.get() != NULL );
+    connection->setPullPipelineDepth( 3 );
+    connection->getPrefetchPolicy()->setTopicPrefetch( 0 );
+
+    std::auto_ptr<cms::Session> session( connection->createSession() );
+    std::auto_ptr<cms::Topic> topic1( session->createTopic( "TestTopic1" ) );
+    std::auto_ptr<ActiveMQConsumer> consumer(
+        dynamic_cast<ActiveMQConsumer*>( session->createConsumer( topic1.get() ) ) );
+
+    MessagePullCapture capture;
+    dTransport->setOutgoingListener( &capture );
+
+    // The first receive fills the pipeline with pulls that wait on the broker indefinitely.
+    std::auto_ptr<cms::Message> message( consumer->receiveNoWait() );
+    CPPUNIT_ASSERT( message.get() == NULL );
+    CPPUNIT_ASSERT_EQUAL( 3, capture.size() );
+    CPPUNIT_ASSERT_EQUAL( 3, consumer->getOutstandingPullCount() );
+    for( int i = 0; i < 3; ++i ) {
+        CPPUNIT_ASSERT_EQUAL( 0LL, capture.pulls[i]->getTimeout() );
+        CPPUNIT_ASSERT_EQUAL( Integer::toString( i ), capture.pulls[i]->getCorrelationId() );
+    }
+
+    dTransport->fireCommand( createColoredDispatch( "red", 1, *topic1, *( consumer->getConsumerId() ) ) );
+    dTransport->fireCommand( createColoredDispatch( "red", 2, *topic1, *( consumer->getConsumerId() ) ) );
+    for( int i = 0; i < 200 && consumer->getOutstandingPullCount() != 1; ++i ) {
+        Thread::sleep( 10 );
+    }
+    CPPUNIT_ASSERT_EQUAL( 1, consumer->getOutstandingPullCount() );
+
+    // Messages waiting locally count against the depth so nothing more is requested yet.
+    message.reset( consumer->receive( 2000 ) );
+    CPPUNIT_ASSERT( message.get() != NULL );
+    CPPUNIT_ASSERT_EQUAL( 3, capture.size() );
+
+    // With one message buffered and one pull outstanding the pipeline is topped up by one.
+    message.reset( consumer->receive( 2000 ) );
+    CPPUNIT_ASSERT( message.get() != NULL );
+    CPPUNIT_ASSERT_EQUAL( 4, capture.size() );
+    CPPUNIT_ASSERT_EQUAL( std::string( "0" ), capture.pulls[3]->getCorrelationId() );
+    CPPUNIT_ASSERT_EQUAL( 2, consumer->getOutstandingPullCount() );
+
+    dTransport->setOutgoingListener( NULL );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testPipelinedSend() {
+
+    CPPUNIT_ASSERT( connection.get() != NULL );
+    connection->setSendPipelineDepth( 4 );
+
+    std::auto_ptr<cms::Session> session( connection->createSession() );
+    std::auto_ptr<cms::Queue> queue( session->createQueue( "TestQueue" ) );
+    std::auto_ptr<ActiveMQProducer> producer(
+        dynamic_cast<ActiveMQProducer*>( session->createProducer( queue.get() ) ) );
+    producer->setDeliveryMode( cms::DeliveryMode::PERSISTENT );
+
+    std::auto_ptr<cms::TextMessage> message( session->createTextMessage( "pipelined" ) );
+    for( int i = 0; i < 10; ++i ) {
+        producer->send( message.get() );
+    }
+
+    CPPUNIT_ASSERT_NO_THROW( producer->flush() );
+    CPPUNIT_ASSERT_EQUAL( 0, producer->getPendingSendCount() );
+
+    // A send that cannot be written fails at once and gives back its slot.
+    dTransport->setFailOnSendMessage( true );
+    dTransport->setNumSentMessageBeforeFail( 0 );
+    CPPUNIT_ASSERT_THROW( producer->send( message.get() ), cms::CMSException );
+    CPPUNIT_ASSERT_EQUAL( 0, producer->getPendingSendCount() );
+
+    dTransport->setFailOnSendMessage( false );
+    CPPUNIT_ASSERT_NO_THROW( producer->send( message.get() ) );
+    CPPUNIT_ASSERT_NO_THROW( producer->close() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testProducerWindow() {
+
+    CPPUNIT_ASSERT( connection.get() != NULL );
+
+    std::auto_ptr<cms::Session> session( connection->createSession() );
+    std::auto_ptr<cms::Queue> queue( session->createQueue( "TestQueue" ) );
+
+    // No window is tracked unless a window size is configured.
+    std::auto_ptr<ActiveMQProducer> unbounded(
+        dynamic_cast<ActiveMQProducer*>( session->createProducer( queue.get() ) ) );
+    CPPUNIT_ASSERT( unbounded->getProducerWindow() == NULL );
+
+    connection->setProducerWindowSize( 1024 * 1024 );
+    connection->setAdaptiveSendPacing( true );
+
+    std::auto_ptr<ActiveMQProducer> producer(
+        dynamic_cast<ActiveMQProducer*>( session->createProducer( queue.get() ) ) );
+    producer->setDeliveryMode( cms::DeliveryMode::NON_PERSISTENT );
+
+    const util::ProducerWindow* window = producer->getProducerWindow();
+    CPPUNIT_ASSERT( window != NULL );
+    CPPUNIT_ASSERT( window->isAdaptivePacing() );
+    CPPUNIT_ASSERT_EQUAL( 1024ULL * 1024ULL, window->getLimit() );
+
+    std::auto_ptr<cms::TextMessage> message( session->createTextMessage( "windowed" ) );
+    for( int i = 0; i < 5; ++i ) {
+        producer->send( message.get() );
+    }
+
+    unsigned long long outstanding = window->getUsage();
+    CPPUNIT_ASSERT( outstanding > 0 );
+    CPPUNIT_ASSERT_EQUAL( outstanding, window->getPeakUsage() );
+
+    Pointer<ProducerAck> ack( new ProducerAck() );
+    ack->setProducerId( producer->getProducerId() );
+    ack->setSize( (int) outstanding );
+    dTransport->fireCommand( ack );
+
+    for( int i = 0; i < 100 && window->getAckCount() == 0; ++i ) {
+        Thread::sleep( 10 );
+    }
+
+    CPPUNIT_ASSERT_EQUAL( 1LL, window->getAckCount() );
+    CPPUNIT_ASSERT_EQUAL( 0ULL, window->getUsage() );
+    CPPUNIT_ASSERT_EQUAL( 0LL, window->getBlockedCount() );
+
+    // A window of one byte is full after a single send.
+    connection->setAdaptiveSendPacing( false );
+    connection->setProducerWindowSize( 1 );
+
+    std::auto_ptr<ActiveMQProducer> blocked(
+        dynamic_cast<ActiveMQProducer*>( session->createProducer( queue.get() ) ) );
+    blocked->setDeliveryMode( cms::DeliveryMode::NON_PERSISTENT );
+
+    const util::ProducerWindow* smallWindow = blocked->getProducerWindow();
+    blocked->send( message.get() );
+    CPPUNIT_ASSERT( smallWindow->isFull() );
+
+    // Sends made before a failover are never acked, the resumed transport empties the window.
+    connection->transportResumed();
+    CPPUNIT_ASSERT_EQUAL( 0ULL, smallWindow->getUsage() );
+
+    blocked->send( message.get() );
+    CPPUNIT_ASSERT( smallWindow->isFull() );
+
+    // A send blocked on the full window is released when its producer is closed.
+    BlockedSendTask task( blocked.get(), message.get() );
+    Thread thread( &task );
+    thread.start();
+
+    Thread::sleep( 100 );
+    CPPUNIT_ASSERT( !task.done.get() );
+
+    blocked->close();
+    thread.join( 5000 );
+
+    CPPUNIT_ASSERT( task.done.get() );
+    CPPUNIT_ASSERT( task.failed.get() );
+    CPPUNIT_ASSERT_EQUAL( 1LL, smallWindow->getBlockedCount() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testCompletionExecutor() {
+
+    CPPUNIT_ASSERT( connection.get() != NULL );
+    connection->setCompletionExecutorThreads( 1 );
+    connection->setCompletionQueueSize( 1 );
+
+    std::auto_ptr<cms::Session> session( connection->createSession() );
+    std::auto_ptr<cms::Queue> queue( session->createQueue( "TestQueue" ) );
+    std::auto_ptr<cms::MessageProducer> producer( session->createProducer( queue.get() ) );
+    std::auto_ptr<cms::TextMessage> message( session->createTextMessage( "callback" ) );
+
+    BlockingAsyncCallback callback( 3 );
+
+    // The callbacks are stalled, the thread delivering responses must not be.
+    AsyncSendTask task( producer.get(), message.get(), &callback );
+    Thread sender( &task );
+    sender.start();
+    sender.join( 5000 );
+
+    bool sent = task.done.get();
+    producer->send( message.get(), &callback );
+    Thread::sleep( 100 );
+    int early = callback.successes.get();
+
+    // The third answer waits for room in the completion queue and is delivered later.
+    AsyncSendTask last( producer.get(), message.get(), &callback );
+    Thread lastSender( &last );
+    lastSender.start();
+
+    callback.release.countDown();
+    lastSender.join( 5000 );
+
+    CPPUNIT_ASSERT( sent );
+    CPPUNIT_ASSERT_EQUAL( 0, early );
+    CPPUNIT_ASSERT( last.done.get() );
+    CPPUNIT_ASSERT( callback.completed.await( 5000 ) );
+    CPPUNIT_ASSERT_EQUAL( 3, callback.successes.get() );
+    CPPUNIT_ASSERT( callback.threadName.find( "ActiveMQ Connection Completions" ) == 0 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testLatencyStatistics() {
+
+    MyCMSMessageListener msgListener;
+
+    CPPUNIT_ASSERT( connection.get() != NULL );
+    CPPUNIT_ASSERT( connection->getStatistics() == NULL );
+    connection->setStatisticsEnabled( true );
+
+    std::auto_ptr<ActiveMQSession> session(
+        dynamic_cast<ActiveMQSession*>( connection->createSession() ) );
+    std::auto_ptr<ActiveMQSession> syncSession(
+        dynamic_cast<ActiveMQSession*>( connection->createSession() ) );
+    std::auto_ptr<cms::Topic> topic1( session->createTopic( "TestTopic1" ) );
+    std::auto_ptr<cms::Topic> topic2( session->createTopic( "TestTopic2" ) );
+
+    std::auto_ptr<ActiveMQConsumer> listening(
+        dynamic_cast<ActiveMQConsumer*>( session->createConsumer( topic1.get() ) ) );
+    std::auto_ptr<ActiveMQConsumer> receiving(
+        dynamic_cast<ActiveMQConsumer*>( syncSession->createConsumer( topic2.get() ) ) );
+    std::auto_ptr<cms::MessageProducer> producer( syncSession->createProducer( topic1.get() ) );
+
+    listening->setMessageListener( &msgListener );
+
+    injectTextMessage( "listened", *topic1, *( listening->getConsumerId() ) );
+    msgListener.asyncWaitForMessages( 1 );
+    CPPUNIT_ASSERT_EQUAL( 1, (int) msgListener.messages.size() );
+
+    injectTextMessage( "received", *topic2, *( receiving->getConsumerId() ) );
+    std::auto_ptr<cms::Message> received( receiving->receive( 2000 ) );
+    CPPUNIT_ASSERT( received.get() != NULL );
+
+    std::auto_ptr<cms::TextMessage> message( syncSession->createTextMessage( "sent" ) );
+    producer->send( message.get() );
+
+    Pointer<util::LatencyStatistics> listenerStats = listening->getStatistics();
+    Pointer<util::LatencyStatistics> receiverStats = receiving->getStatistics();
+    Pointer<util::LatencyStatistics> sessionStats = session->getStatistics();
+    Pointer<util::LatencyStatistics> syncSessionStats = syncSession->getStatistics();
+    Pointer<util::LatencyStatistics> connectionStats = connection->getStatistics();
+
+    CPPUNIT_ASSERT( listenerStats != NULL && receiverStats != NULL );
+    CPPUNIT_ASSERT( sessionStats != NULL && syncSessionStats != NULL && connectionStats != NULL );
+
+    CPPUNIT_ASSERT_EQUAL( 1LL, listenerStats->getHistogram( util::LatencyStatistics::LISTENER_TIME ).getCount() );
+    CPPUNIT_ASSERT_EQUAL( 1LL, listenerStats->getHistogram( util::LatencyStatistics::DISPATCH_RESIDENCE_TIME ).getCount() );
+    CPPUNIT_ASSERT_EQUAL( 0LL, receiverStats->getHistogram( util::LatencyStatistics::LISTENER_TIME ).getCount() );
+    CPPUNIT_ASSERT_EQUAL( 1LL, receiverStats->getHistogram( util::LatencyStatistics::DISPATCH_RESIDENCE_TIME ).getCount() );
+
+    CPPUNIT_ASSERT_EQUAL( 1LL, sessionStats->getHistogram( util::LatencyStatistics::DISPATCH_RESIDENCE_TIME ).getCount() );
+    CPPUNIT_ASSERT_EQUAL( 1LL, syncSessionStats->getHistogram( util::LatencyStatistics::DISPATCH_RESIDENCE_TIME ).getCount() );
+    CPPUNIT_ASSERT_EQUAL( 1LL, syncSessionStats->getHistogram( util::LatencyStatistics::SEND_LATENCY ).getCount() );
+    CPPUNIT_ASSERT_EQUAL( 2LL, connectionStats->getHistogram( util::LatencyStatistics::DISPATCH_RESIDENCE_TIME ).getCount() );
+    CPPUNIT_ASSERT_EQUAL( 1LL, connectionStats->getHistogram( util::LatencyStatistics::SEND_LATENCY ).getCount() );
+    CPPUNIT_ASSERT( connectionStats->getHistogram( util::LatencyStatistics::ACK_ROUND_TRIP ).getCount() > 0 );
+
+    // The mock transport does not write to a socket.
+    CPPUNIT_ASSERT_EQUAL( 0LL, connectionStats->getHistogram( util::LatencyStatistics::SOCKET_WRITE_TIME ).getCount() );
+
+    connection->setStatisticsEnabled( false );
+    CPPUNIT_ASSERT( connection->getStatistics() == NULL );
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQSessionTest::setUp() {
 
@@ -47,8 +47,20 @@ namespace core{
         CPPUNIT_TEST( testTransactionRollbackOneConsumer );
         CPPUNIT_TEST( testTransactionRollbackTwoConsumer );
         CPPUNIT_TEST( testTransactionCloseWithoutCommit );
+        CPPUNIT_TEST( testTransactionRollbackWithRedeliveryDelay );
+        CPPUNIT_TEST( testNonBlockingRedelivery );
         CPPUNIT_TEST( testExpiration );
         CPPUNIT_TEST( testCreateManyConsumersAndSetListeners );
+        CPPUNIT_TEST( testLocalSelectorFiltering );
+        CPPUNIT_TEST( testAdaptivePrefetch );
+        CPPUNIT_TEST( testAdaptivePrefetchMemoryLimit );
+        CPPUNIT_TEST( testInboundMemoryLimit );
+        CPPUNIT_TEST( testInboundMemoryThrottleFailure );
+        CPPUNIT_TEST( testPipelinedPull );
+        CPPUNIT_TEST( testPipelinedSend );
+        CPPUNIT_TEST( testProducerWindow );
+        CPPUNIT_TEST( testCompletionExecutor );
+        CPPUNIT_TEST( testLatencyStatistics );
         CPPUNIT_TEST_SUITE_END();
 
     private:
@@ -96,11 +108,23 @@ namespace core{
         void testAutoAcking();
         void testClientAck();
         void testCreateManyConsumersAndSetListeners();
+        void testLocalSelectorFiltering();
+        void testAdaptivePrefetch();
+        void testAdaptivePrefetchMemoryLimit();
+        void testInboundMemoryLimit();
+        void testInboundMemoryThrottleFailure();
+        void testPipelinedPull();
+        void testPipelinedSend();
+        void testProducerWindow();
+        void testCompletionExecutor();
+        void testLatencyStatistics();
         void testTransactionCommitOneConsumer();
         void testTransactionCommitTwoConsumer();
         void testTransactionRollbackOneConsumer();
         void testTransactionRollbackTwoConsumer();
         void testTransactionCloseWithoutCommit();
+        void testTransactionRollbackWithRedeliveryDelay();
+        void testNonBlockingRedelivery();
         void testTransactionCommitAfterConsumerClosed();
         void testExpiration();
 
@@ -0,0 +1,175 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AdaptivePrefetchControllerTest.h"
+
+#include <activemq/core/AdaptivePrefetchController.h>
+
+#include <decaf/lang/exceptions/IllegalArgumentException.h>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::core;
+using namespace decaf;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+
+////////////////////////////////////////////////////////////////////////////////
+AdaptivePrefetchControllerTest::AdaptivePrefetchControllerTest() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+AdaptivePrefetchControllerTest::~AdaptivePrefetchControllerTest() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void AdaptivePrefetchControllerTest::testConstructor() {
+
+    AdaptivePrefetchController controller(1000, 0, 5000, 0);
+
+    CPPUNIT_ASSERT_EQUAL(1000, controller.getWindow());
+    CPPUNIT_ASSERT_EQUAL(1, controller.getMinimumWindow());
+    CPPUNIT_ASSERT_EQUAL(5000, controller.getMaximumWindow());
+    CPPUNIT_ASSERT_EQUAL(AdaptivePrefetchController::DEFAULT_TARGET_DRAIN_TIME, controller.getTargetDrainTime());
+    CPPUNIT_ASSERT_EQUAL(0LL, controller.getAdjustmentCount());
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IllegalArgumentException",
+        AdaptivePrefetchController(10, 100, 50, 0),
+        IllegalArgumentException);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IllegalArgumentException",
+        controller.setTargetDrainTime(0),
+        IllegalArgumentException);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void AdaptivePrefetchControllerTest::testSampleComplete() {
+
+    AdaptivePrefetchController controller(1000, 1, 5000, 0);
+
+    // Nothing consumed, never complete.
+    CPPUNIT_ASSERT(!controller.isSampleComplete(0));
+    CPPUNIT_ASSERT(!controller.isSampleComplete(1000000));
+
+    for (int i = 0; i < AdaptivePrefetchController::DEFAULT_SAMPLE_SIZE - 1; ++i) {
+        controller.messageConsumed(10, 100);
+    }
+    CPPUNIT_ASSERT(!controller.isSampleComplete(10));
+
+    // A partial sample completes once the sample period has passed.
+    CPPUNIT_ASSERT(controller.isSampleComplete(AdaptivePrefetchController::DEFAULT_SAMPLE_PERIOD));
+
+    controller.messageConsumed(10, 100);
+    CPPUNIT_ASSERT(controller.isSampleComplete(10));
+
+    controller.evaluate(10);
+    CPPUNIT_ASSERT(!controller.isSampleComplete(10));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void AdaptivePrefetchControllerTest::testFastConsumerGrows() {
+
+    AdaptivePrefetchController controller(100, 1, 5000, 0);
+
+    // 50 microseconds a message, 20000 a second, more than the maximum.
+    for (int i = 0; i < AdaptivePrefetchController::DEFAULT_SAMPLE_SIZE; ++i) {
+        controller.messageConsumed(50, 1024);
+    }
+
+    int window = controller.evaluate(100);
+    CPPUNIT_ASSERT_EQUAL(5000, window);
+
+    // Proposals are not applied until the consumer accepts them.
+    CPPUNIT_ASSERT_EQUAL(100, controller.getWindow());
+    controller.setWindow(window);
+    CPPUNIT_ASSERT_EQUAL(5000, controller.getWindow());
+    CPPUNIT_ASSERT_EQUAL(1LL, controller.getAdjustmentCount());
+
+    // A consumer that does no measurable work also gets the maximum.
+    AdaptivePrefetchController idle(100, 1, 5000, 0);
+    idle.messageConsumed(0, 1024);
+    CPPUNIT_ASSERT_EQUAL(5000, idle.evaluate(AdaptivePrefetchController::DEFAULT_SAMPLE_PERIOD));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void AdaptivePrefetchControllerTest::testSlowConsumerShrinks() {
+
+    AdaptivePrefetchController controller(1000, 1, 5000, 0);
+
+    // 20 milliseconds a message, 50 can be processed in the drain time.
+    for (int i = 0; i < AdaptivePrefetchController::DEFAULT_SAMPLE_SIZE; ++i) {
+        controller.messageConsumed(20000, 1024);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(50, controller.evaluate(640));
+
+    // Halving the drain time halves the window.
+    controller.setTargetDrainTime(500);
+    for (int i = 0; i < AdaptivePrefetchController::DEFAULT_SAMPLE_SIZE; ++i) {
+        controller.messageConsumed(20000, 1024);
+    }
+    controller.setWindow(50);
+    CPPUNIT_ASSERT_EQUAL(25, controller.evaluate(1280));
+
+    // Never below the minimum.
+    AdaptivePrefetchController verySlow(1000, 5, 5000, 0);
+    verySlow.messageConsumed(10000000, 1024);
+    CPPUNIT_ASSERT_EQUAL(5, verySlow.evaluate(AdaptivePrefetchController::DEFAULT_SAMPLE_PERIOD * 10));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void AdaptivePrefetchControllerTest::testSmallChangesIgnored() {
+
+    AdaptivePrefetchController controller(100, 1, 5000, 0);
+
+    // 9 milliseconds a message proposes 111, within a quarter of 100.
+    for (int i = 0; i < AdaptivePrefetchController::DEFAULT_SAMPLE_SIZE; ++i) {
+        controller.messageConsumed(9000, 1024);
+    }
+    CPPUNIT_ASSERT_EQUAL(100, controller.evaluate(300));
+
+    // A window outside the bounds is always corrected.
+    AdaptivePrefetchController outOfBounds(6000, 1, 5000, 0);
+    for (int i = 0; i < AdaptivePrefetchController::DEFAULT_SAMPLE_SIZE; ++i) {
+        outOfBounds.messageConsumed(210, 1024);
+    }
+    CPPUNIT_ASSERT_EQUAL(4761, outOfBounds.evaluate(10));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void AdaptivePrefetchControllerTest::testStatistics() {
+
+    AdaptivePrefetchController controller(100, 1, 5000, 0);
+
+    for (int i = 0; i < AdaptivePrefetchController::DEFAULT_SAMPLE_SIZE; ++i) {
+        controller.messageConsumed(1000, 2048);
+    }
+    controller.evaluate(64);
+
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(500.0, controller.getConsumptionRate(), 0.001);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1000.0, controller.getAverageProcessingTime(), 0.001);
+    CPPUNIT_ASSERT_EQUAL(2048LL, controller.getAverageMessageSize());
+
+    // The message size is smoothed over samples.
+    for (int i = 0; i < AdaptivePrefetchController::DEFAULT_SAMPLE_SIZE; ++i) {
+        controller.messageConsumed(1000, 1024);
+    }
+    controller.evaluate(128);
+    CPPUNIT_ASSERT_EQUAL(1920LL, controller.getAverageMessageSize());
+}
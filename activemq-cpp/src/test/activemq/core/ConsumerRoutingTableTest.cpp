@@ -0,0 +1,278 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ConsumerRoutingTableTest.h"
+
+#include <activemq/core/ConsumerRoutingTable.h>
+#include <activemq/commands/ConsumerId.h>
+
+#include <decaf/lang/Thread.h>
+#include <decaf/lang/Runnable.h>
+#include <decaf/util/concurrent/CountDownLatch.h>
+#include <decaf/util/concurrent/atomic/AtomicBoolean.h>
+
+#include <vector>
+
+using namespace activemq;
+using namespace activemq::core;
+using namespace activemq::commands;
+using namespace decaf;
+using namespace decaf::lang;
+using namespace decaf::util::concurrent;
+using namespace decaf::util::concurrent::atomic;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    ConsumerId createId(long long sessionId, long long value) {
+        ConsumerId id;
+        id.setConnectionId("ID:test-connection");
+        id.setSessionId(sessionId);
+        id.setValue(value);
+        return id;
+    }
+
+    class HoldingReader : public Runnable {
+    private:
+
+        HoldingReader(const HoldingReader&);
+        HoldingReader& operator= (const HoldingReader&);
+
+    public:
+
+        ConsumerRoutingTable<int>& table;
+        CountDownLatch entered;
+        CountDownLatch release;
+        AtomicBoolean done;
+        int found;
+
+        HoldingReader(ConsumerRoutingTable<int>& table) :
+            table(table), entered(1), release(1), done(false), found(0) {}
+
+        virtual ~HoldingReader() {}
+
+        virtual void run() {
+            ConsumerRoutingTable<int>::ReadGuard guard(table);
+            found = guard.get(createId(1, 1));
+            entered.countDown();
+            release.await();
+            done.set(true);
+        }
+    };
+
+    class Remover : public Runnable {
+    private:
+
+        Remover(const Remover&);
+        Remover& operator= (const Remover&);
+
+    public:
+
+        ConsumerRoutingTable<int>& table;
+        HoldingReader& reader;
+        AtomicBoolean readerDoneAtReturn;
+
+        Remover(ConsumerRoutingTable<int>& table, HoldingReader& reader) :
+            table(table), reader(reader), readerDoneAtReturn(false) {}
+
+        virtual ~Remover() {}
+
+        virtual void run() {
+            table.remove(createId(1, 1));
+            readerDoneAtReturn.set(reader.done.get());
+        }
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ConsumerRoutingTableTest::ConsumerRoutingTableTest() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ConsumerRoutingTableTest::~ConsumerRoutingTableTest() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConsumerRoutingTableTest::testPutGetRemove() {
+
+    ConsumerRoutingTable<int> table;
+
+    CPPUNIT_ASSERT_EQUAL(0, table.size());
+    CPPUNIT_ASSERT_EQUAL(0, table.get(createId(1, 1)));
+
+    table.put(createId(1, 1), 11);
+    table.put(createId(1, 2), 12);
+    table.put(createId(2, 1), 21);
+
+    CPPUNIT_ASSERT_EQUAL(3, table.size());
+    CPPUNIT_ASSERT_EQUAL(11, table.get(createId(1, 1)));
+    CPPUNIT_ASSERT_EQUAL(12, table.get(createId(1, 2)));
+    CPPUNIT_ASSERT_EQUAL(21, table.get(createId(2, 1)));
+    CPPUNIT_ASSERT_EQUAL(0, table.get(createId(2, 2)));
+
+    table.put(createId(1, 1), 111);
+    CPPUNIT_ASSERT_EQUAL(3, table.size());
+    CPPUNIT_ASSERT_EQUAL(111, table.get(createId(1, 1)));
+
+    CPPUNIT_ASSERT(table.remove(createId(1, 2)));
+    CPPUNIT_ASSERT(!table.remove(createId(1, 2)));
+    CPPUNIT_ASSERT_EQUAL(2, table.size());
+    CPPUNIT_ASSERT_EQUAL(0, table.get(createId(1, 2)));
+    CPPUNIT_ASSERT_EQUAL(21, table.get(createId(2, 1)));
+    CPPUNIT_ASSERT_EQUAL(2, (int) table.values().size());
+
+    table.clear();
+    CPPUNIT_ASSERT_EQUAL(0, table.size());
+    CPPUNIT_ASSERT_EQUAL(0, table.get(createId(1, 1)));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConsumerRoutingTableTest::testGrowAndShrink() {
+
+    ConsumerRoutingTable<int> table;
+
+    for (int session = 1; session <= 10; ++session) {
+        for (int consumer = 1; consumer <= 50; ++consumer) {
+            table.put(createId(session, consumer), session * 1000 + consumer);
+        }
+    }
+
+    CPPUNIT_ASSERT_EQUAL(500, table.size());
+
+    for (int session = 1; session <= 10; ++session) {
+        for (int consumer = 1; consumer <= 50; ++consumer) {
+            CPPUNIT_ASSERT_EQUAL(session * 1000 + consumer, table.get(createId(session, consumer)));
+        }
+    }
+
+    for (int session = 1; session <= 10; ++session) {
+        for (int consumer = 1; consumer <= 50; consumer += 2) {
+            CPPUNIT_ASSERT(table.remove(createId(session, consumer)));
+        }
+    }
+
+    CPPUNIT_ASSERT_EQUAL(250, table.size());
+
+    for (int session = 1; session <= 10; ++session) {
+        for (int consumer = 1; consumer <= 50; ++consumer) {
+            int expected = consumer % 2 == 0 ? session * 1000 + consumer : 0;
+            CPPUNIT_ASSERT_EQUAL(expected, table.get(createId(session, consumer)));
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConsumerRoutingTableTest::testRemoveWaitsForReaders() {
+
+    ConsumerRoutingTable<int> table;
+    table.put(createId(1, 1), 11);
+
+    HoldingReader reader(table);
+    Thread readerThread(&reader);
+    readerThread.start();
+
+    CPPUNIT_ASSERT(reader.entered.await(10000));
+    CPPUNIT_ASSERT_EQUAL(11, reader.found);
+
+    Remover remover(table, reader);
+    Thread removerThread(&remover);
+    removerThread.start();
+
+    // New readers are not blocked by the pending remove.
+    Thread::sleep(100);
+    CPPUNIT_ASSERT(removerThread.isAlive());
+    CPPUNIT_ASSERT_EQUAL(0, table.get(createId(1, 1)));
+
+    reader.release.countDown();
+    removerThread.join(10000);
+    readerThread.join(10000);
+
+    CPPUNIT_ASSERT(!removerThread.isAlive());
+    CPPUNIT_ASSERT(remover.readerDoneAtReturn.get());
+    CPPUNIT_ASSERT_EQUAL(0, table.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConsumerRoutingTableTest::testRemoveFromReadingThread() {
+
+    ConsumerRoutingTable<int> table;
+    table.put(createId(1, 1), 11);
+
+    {
+        ConsumerRoutingTable<int>::ReadGuard guard(table);
+        CPPUNIT_ASSERT_EQUAL(11, guard.get(createId(1, 1)));
+
+        // A listener may close its own consumer while it is being dispatched to.
+        CPPUNIT_ASSERT(table.remove(createId(1, 1)));
+        table.put(createId(1, 2), 12);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(0, table.get(createId(1, 1)));
+    CPPUNIT_ASSERT_EQUAL(12, table.get(createId(1, 2)));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConsumerRoutingTableTest::testPutDoesNotWaitForReaders() {
+
+    ConsumerRoutingTable<int> table;
+    table.put(createId(1, 1), 11);
+
+    HoldingReader reader(table);
+    Thread readerThread(&reader);
+    readerThread.start();
+
+    CPPUNIT_ASSERT(reader.entered.await(10000));
+
+    // Adding a consumer while a dispatch is in progress must not wait for it.
+    table.put(createId(1, 2), 12);
+    CPPUNIT_ASSERT(!reader.done.get());
+    CPPUNIT_ASSERT_EQUAL(12, table.get(createId(1, 2)));
+    CPPUNIT_ASSERT_EQUAL(11, table.get(createId(1, 1)));
+
+    reader.release.countDown();
+    readerThread.join(10000);
+    CPPUNIT_ASSERT(!readerThread.isAlive());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConsumerRoutingTableTest::testManyGuardsOnOneThread() {
+
+    ConsumerRoutingTable<int> table;
+    table.put(createId(1, 1), 11);
+    table.put(createId(1, 2), 12);
+
+    // More guards than the table has reader slots, the extra ones must still be
+    // counted as held by this thread or the remove below would wait on itself.
+    std::vector<ConsumerRoutingTable<int>::ReadGuard*> guards;
+    for (int i = 0; i < 40; ++i) {
+        guards.push_back(new ConsumerRoutingTable<int>::ReadGuard(table));
+    }
+
+    CPPUNIT_ASSERT(table.remove(createId(1, 1)));
+    CPPUNIT_ASSERT_EQUAL(0, table.get(createId(1, 1)));
+
+    // Guards taken before the remove still see the table they started with.
+    CPPUNIT_ASSERT_EQUAL(11, guards.back()->get(createId(1, 1)));
+    CPPUNIT_ASSERT_EQUAL(12, guards.front()->get(createId(1, 2)));
+
+    for (std::size_t i = 0; i < guards.size(); ++i) {
+        delete guards[i];
+    }
+
+    CPPUNIT_ASSERT_EQUAL(1, table.size());
+    CPPUNIT_ASSERT_EQUAL(12, table.get(createId(1, 2)));
+}
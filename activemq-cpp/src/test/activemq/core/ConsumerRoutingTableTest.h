@@ -0,0 +1,54 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_CORE_CONSUMERROUTINGTABLETEST_H_
+#define _ACTIVEMQ_CORE_CONSUMERROUTINGTABLETEST_H_
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace activemq {
+namespace core {
+
+    class ConsumerRoutingTableTest : public CppUnit::TestFixture {
+
+        CPPUNIT_TEST_SUITE( ConsumerRoutingTableTest );
+        CPPUNIT_TEST( testPutGetRemove );
+        CPPUNIT_TEST( testGrowAndShrink );
+        CPPUNIT_TEST( testRemoveWaitsForReaders );
+        CPPUNIT_TEST( testRemoveFromReadingThread );
+        CPPUNIT_TEST( testPutDoesNotWaitForReaders );
+        CPPUNIT_TEST( testManyGuardsOnOneThread );
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+
+        ConsumerRoutingTableTest();
+        virtual ~ConsumerRoutingTableTest();
+
+        void testPutGetRemove();
+        void testGrowAndShrink();
+        void testRemoveWaitsForReaders();
+        void testRemoveFromReadingThread();
+        void testPutDoesNotWaitForReaders();
+        void testManyGuardsOnOneThread();
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_CORE_CONSUMERROUTINGTABLETEST_H_ */
@@ -18,13 +18,16 @@
 #include "FifoMessageDispatchChannelTest.h"
 
 #include <activemq/core/FifoMessageDispatchChannel.h>
+#include <activemq/commands/Message.h>
 #include <activemq/commands/MessageDispatch.h>
+#include <activemq/util/MemoryUsage.h>
 #include <decaf/lang/Pointer.h>
 #include <decaf/lang/System.h>
 
 using namespace activemq;
 using namespace activemq::core;
 using namespace activemq::commands;
+using namespace activemq::util;
 using namespace decaf;
 using namespace decaf::lang;
 
@@ -230,3 +233,67 @@ void FifoMessageDispatchChannelTest::testRemoveAll() {
     CPPUNIT_ASSERT( channel.size() == 0 );
     CPPUNIT_ASSERT( channel.isEmpty() == true );
 }
+
+////////////////////////////////////////////////////////////////////////////////
+void FifoMessageDispatchChannelTest::testMemoryUsage() {
+
+    Pointer<MemoryUsage> usage( new MemoryUsage( 1024 * 1024 ) );
+    FifoMessageDispatchChannel channel;
+
+    Pointer<Message> message1( new Message() );
+    Pointer<Message> message2( new Message() );
+    message2->setContent( std::vector<unsigned char>( 512, 'a' ) );
+    Pointer<MessageDispatch> dispatch1( new MessageDispatch() );
+    Pointer<MessageDispatch> dispatch2( new MessageDispatch() );
+    Pointer<MessageDispatch> dispatch3( new MessageDispatch() );
+    dispatch1->setMessage( message1 );
+    dispatch2->setMessage( message2 );
+
+    unsigned long long size1 = message1->getSize();
+    unsigned long long size2 = message2->getSize();
+
+    // Messages already held are charged when the usage is assigned.
+    channel.enqueue( dispatch1 );
+    channel.setMemoryUsage( usage );
+    CPPUNIT_ASSERT( channel.getMemoryUsage() == usage );
+    CPPUNIT_ASSERT_EQUAL( size1, usage->getUsage() );
+
+    // A dispatch without a Message costs nothing.
+    channel.enqueue( dispatch2 );
+    channel.enqueue( dispatch3 );
+    CPPUNIT_ASSERT_EQUAL( size1 + size2, usage->getUsage() );
+
+    channel.start();
+    CPPUNIT_ASSERT( channel.dequeueNoWait() == dispatch1 );
+    CPPUNIT_ASSERT_EQUAL( size2, usage->getUsage() );
+    CPPUNIT_ASSERT( channel.dequeue( 0 ) == dispatch2 );
+    CPPUNIT_ASSERT( channel.dequeue( 0 ) == dispatch3 );
+    CPPUNIT_ASSERT_EQUAL( 0ULL, usage->getUsage() );
+
+    channel.enqueue( dispatch1 );
+    channel.enqueueFirst( dispatch2 );
+    CPPUNIT_ASSERT_EQUAL( size1 + size2, usage->getUsage() );
+    CPPUNIT_ASSERT( channel.removeAll().size() == 2 );
+    CPPUNIT_ASSERT_EQUAL( 0ULL, usage->getUsage() );
+
+    channel.enqueue( dispatch1 );
+    channel.enqueue( dispatch2 );
+    channel.clear();
+    CPPUNIT_ASSERT( channel.isEmpty() == true );
+    CPPUNIT_ASSERT_EQUAL( 0ULL, usage->getUsage() );
+
+    channel.enqueue( dispatch2 );
+    channel.setMemoryUsage( Pointer<MemoryUsage>() );
+    CPPUNIT_ASSERT_EQUAL( 0ULL, usage->getUsage() );
+    channel.clear();
+
+    // Messages still held when the Channel is destroyed are returned.
+    {
+        FifoMessageDispatchChannel other;
+        other.setMemoryUsage( usage );
+        other.enqueue( dispatch1 );
+        other.enqueue( dispatch2 );
+        CPPUNIT_ASSERT_EQUAL( size1 + size2, usage->getUsage() );
+    }
+    CPPUNIT_ASSERT_EQUAL( 0ULL, usage->getUsage() );
+}
@@ -0,0 +1,264 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PipelinedSendWindowTest.h"
+
+#include <activemq/core/PipelinedSendWindow.h>
+
+#include <cms/ResourceAllocationException.h>
+
+#include <decaf/lang/Thread.h>
+#include <decaf/lang/Runnable.h>
+#include <decaf/lang/exceptions/IllegalArgumentException.h>
+#include <decaf/util/concurrent/atomic/AtomicBoolean.h>
+
+using namespace activemq;
+using namespace activemq::core;
+using namespace decaf;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::util::concurrent::atomic;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    class AcquireTask : public Runnable {
+    private:
+
+        AcquireTask(const AcquireTask&);
+        AcquireTask& operator= (const AcquireTask&);
+
+    public:
+
+        PipelinedSendWindow& window;
+        AtomicBoolean done;
+        AtomicBoolean failed;
+
+        AcquireTask(PipelinedSendWindow& window) : window(window), done(false), failed(false) {}
+
+        virtual ~AcquireTask() {}
+
+        virtual void run() {
+            try {
+                window.acquire();
+            } catch (cms::CMSException& ex) {
+                failed.set(true);
+            }
+            done.set(true);
+        }
+    };
+
+    class FlushTask : public Runnable {
+    private:
+
+        FlushTask(const FlushTask&);
+        FlushTask& operator= (const FlushTask&);
+
+    public:
+
+        PipelinedSendWindow& window;
+        AtomicBoolean done;
+        AtomicBoolean failed;
+
+        FlushTask(PipelinedSendWindow& window) : window(window), done(false), failed(false) {}
+
+        virtual ~FlushTask() {}
+
+        virtual void run() {
+            try {
+                window.flush();
+            } catch (cms::CMSException& ex) {
+                failed.set(true);
+            }
+            done.set(true);
+        }
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+PipelinedSendWindowTest::PipelinedSendWindowTest() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+PipelinedSendWindowTest::~PipelinedSendWindowTest() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PipelinedSendWindowTest::testConstructor() {
+
+    PipelinedSendWindow window(4);
+
+    CPPUNIT_ASSERT_EQUAL(4, window.getCapacity());
+    CPPUNIT_ASSERT_EQUAL(0, window.getInFlightCount());
+    CPPUNIT_ASSERT_EQUAL(0LL, window.getCompletedCount());
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IllegalArgumentException",
+        PipelinedSendWindow(0),
+        IllegalArgumentException);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PipelinedSendWindowTest::testAcquireBlocksWhenFull() {
+
+    PipelinedSendWindow window(2);
+
+    window.acquire();
+    window.acquire();
+    CPPUNIT_ASSERT_EQUAL(2, window.getInFlightCount());
+
+    AcquireTask task(window);
+    Thread thread(&task);
+    thread.start();
+
+    Thread::sleep(100);
+    CPPUNIT_ASSERT(!task.done.get());
+
+    window.onSuccess();
+    thread.join(5000);
+
+    CPPUNIT_ASSERT(task.done.get());
+    CPPUNIT_ASSERT_EQUAL(2, window.getInFlightCount());
+    CPPUNIT_ASSERT_EQUAL(1LL, window.getCompletedCount());
+
+    window.release();
+    CPPUNIT_ASSERT_EQUAL(1, window.getInFlightCount());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PipelinedSendWindowTest::testErrorReportedOnce() {
+
+    PipelinedSendWindow window(4);
+
+    window.acquire();
+    window.acquire();
+    window.onException(cms::CMSException("first"));
+    window.onException(cms::CMSException("second"));
+    CPPUNIT_ASSERT_EQUAL(0, window.getInFlightCount());
+
+    try {
+        window.acquire();
+        CPPUNIT_FAIL("Should have reported the failed send");
+    } catch (cms::CMSException& ex) {
+        CPPUNIT_ASSERT_EQUAL(std::string("first"), ex.getMessage());
+    }
+
+    CPPUNIT_ASSERT_EQUAL(0, window.getInFlightCount());
+    CPPUNIT_ASSERT_NO_THROW(window.checkForError());
+    CPPUNIT_ASSERT_NO_THROW(window.acquire());
+    CPPUNIT_ASSERT_EQUAL(1, window.getInFlightCount());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PipelinedSendWindowTest::testFlush() {
+
+    PipelinedSendWindow window(4);
+    CPPUNIT_ASSERT_NO_THROW(window.flush());
+
+    window.acquire();
+    window.acquire();
+
+    FlushTask task(window);
+    Thread thread(&task);
+    thread.start();
+
+    window.onSuccess();
+    Thread::sleep(100);
+    CPPUNIT_ASSERT(!task.done.get());
+
+    window.onException(cms::CMSException("failed"));
+    thread.join(5000);
+
+    CPPUNIT_ASSERT(task.done.get());
+    CPPUNIT_ASSERT(task.failed.get());
+    CPPUNIT_ASSERT_EQUAL(0, window.getInFlightCount());
+    CPPUNIT_ASSERT_NO_THROW(window.flush());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PipelinedSendWindowTest::testErrorKeepsItsType() {
+
+    PipelinedSendWindow window(4);
+
+    window.acquire();
+    window.onException(cms::ResourceAllocationException("no space"));
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw the type the broker reported",
+        window.checkForError(),
+        cms::ResourceAllocationException);
+
+    window.acquire();
+    window.onException(cms::ResourceAllocationException("no space"));
+
+    try {
+        window.flush();
+        CPPUNIT_FAIL("Should have reported the failed send");
+    } catch (cms::ResourceAllocationException& ex) {
+        CPPUNIT_ASSERT_EQUAL(std::string("no space"), ex.getMessage());
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PipelinedSendWindowTest::testAwaitCompletionTimesOut() {
+
+    PipelinedSendWindow window(4);
+    CPPUNIT_ASSERT(window.awaitCompletion(100));
+
+    window.acquire();
+    CPPUNIT_ASSERT(!window.awaitCompletion(100));
+    CPPUNIT_ASSERT_EQUAL(1, window.getInFlightCount());
+
+    window.onSuccess();
+    CPPUNIT_ASSERT(window.awaitCompletion(100));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PipelinedSendWindowTest::testFail() {
+
+    PipelinedSendWindow window(2);
+
+    window.acquire();
+    window.acquire();
+
+    AcquireTask task(window);
+    Thread thread(&task);
+    thread.start();
+
+    Thread::sleep(100);
+    CPPUNIT_ASSERT(!task.done.get());
+
+    window.fail(cms::CMSException("transport failed"));
+    thread.join(5000);
+
+    // The blocked send reports the failure instead of taking a slot.
+    CPPUNIT_ASSERT(task.done.get());
+    CPPUNIT_ASSERT(task.failed.get());
+    CPPUNIT_ASSERT_EQUAL(0, window.getInFlightCount());
+    CPPUNIT_ASSERT(window.awaitCompletion(100));
+
+    // Responses for the abandoned sends change nothing.
+    window.acquire();
+    window.onException(cms::CMSException("late"));
+    window.onSuccess();
+    CPPUNIT_ASSERT_EQUAL(1, window.getInFlightCount());
+    CPPUNIT_ASSERT_EQUAL(0LL, window.getCompletedCount());
+
+    window.onSuccess();
+    CPPUNIT_ASSERT_EQUAL(0, window.getInFlightCount());
+    CPPUNIT_ASSERT_NO_THROW(window.flush());
+}
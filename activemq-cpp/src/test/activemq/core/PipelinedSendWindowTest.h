@@ -0,0 +1,56 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_CORE_PIPELINEDSENDWINDOWTEST_H_
+#define _ACTIVEMQ_CORE_PIPELINEDSENDWINDOWTEST_H_
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace activemq {
+namespace core {
+
+    class PipelinedSendWindowTest : public CppUnit::TestFixture {
+
+        CPPUNIT_TEST_SUITE( PipelinedSendWindowTest );
+        CPPUNIT_TEST( testConstructor );
+        CPPUNIT_TEST( testAcquireBlocksWhenFull );
+        CPPUNIT_TEST( testErrorReportedOnce );
+        CPPUNIT_TEST( testFlush );
+        CPPUNIT_TEST( testErrorKeepsItsType );
+        CPPUNIT_TEST( testAwaitCompletionTimesOut );
+        CPPUNIT_TEST( testFail );
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+
+        PipelinedSendWindowTest();
+        virtual ~PipelinedSendWindowTest();
+
+        void testConstructor();
+        void testAcquireBlocksWhenFull();
+        void testErrorReportedOnce();
+        void testFlush();
+        void testErrorKeepsItsType();
+        void testAwaitCompletionTimesOut();
+        void testFail();
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_CORE_PIPELINEDSENDWINDOWTEST_H_ */
@@ -0,0 +1,291 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MessageSelectorTest.h"
+
+#include <activemq/filter/MessageSelector.h>
+#include <activemq/commands/MessageId.h>
+#include <activemq/commands/ProducerId.h>
+#include <cms/InvalidSelectorException.h>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::filter;
+using namespace activemq::commands;
+using namespace decaf;
+using namespace decaf::lang;
+
+////////////////////////////////////////////////////////////////////////////////
+MessageSelectorTest::MessageSelectorTest() : message() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MessageSelectorTest::~MessageSelectorTest() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSelectorTest::setUp() {
+
+    message.getMessageProperties().clear();
+    message.getMessageProperties().setString("color", "red");
+    message.getMessageProperties().setString("name", "Hello World");
+    message.getMessageProperties().setInt("count", 42);
+    message.getMessageProperties().setLong("big", 10000000000LL);
+    message.getMessageProperties().setDouble("price", 9.5);
+    message.getMessageProperties().setBool("flag", true);
+    message.getMessageProperties().setShort("small", 7);
+
+    message.setPriority(4);
+    message.setPersistent(true);
+    message.setType("order");
+    message.setCorrelationId("");
+    message.setTimestamp(1000);
+    message.setRedeliveryCounter(0);
+    message.setGroupID("group-1");
+    message.setGroupSequence(3);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool MessageSelectorTest::matches(const std::string& selector) {
+    MessageSelector compiled(selector);
+    return compiled.matches(&message);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSelectorTest::testEmptySelector() {
+
+    MessageSelector empty("");
+    CPPUNIT_ASSERT(empty.isEmpty());
+    CPPUNIT_ASSERT(empty.matches(&message));
+    CPPUNIT_ASSERT(!empty.matches(NULL));
+
+    MessageSelector blank("   ");
+    CPPUNIT_ASSERT(blank.isEmpty());
+    CPPUNIT_ASSERT(blank.matches(&message));
+
+    MessageSelector selector("color = 'red'");
+    CPPUNIT_ASSERT(!selector.isEmpty());
+    CPPUNIT_ASSERT_EQUAL(std::string("color = 'red'"), selector.getSelector());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSelectorTest::testComparisons() {
+
+    CPPUNIT_ASSERT(matches("color = 'red'"));
+    CPPUNIT_ASSERT(!matches("color = 'blue'"));
+    CPPUNIT_ASSERT(matches("color <> 'blue'"));
+    CPPUNIT_ASSERT(matches("count = 42"));
+    CPPUNIT_ASSERT(matches("count > 41"));
+    CPPUNIT_ASSERT(matches("count >= 42"));
+    CPPUNIT_ASSERT(!matches("count < 42"));
+    CPPUNIT_ASSERT(matches("count <= 42"));
+    CPPUNIT_ASSERT(matches("count = 42.0"));
+    CPPUNIT_ASSERT(matches("big > 9999999999"));
+    CPPUNIT_ASSERT(matches("price > 9"));
+    CPPUNIT_ASSERT(matches("price < 9.75"));
+    CPPUNIT_ASSERT(matches("small = 7"));
+    CPPUNIT_ASSERT(matches("flag = TRUE"));
+    CPPUNIT_ASSERT(!matches("flag = false"));
+    CPPUNIT_ASSERT(matches("flag"));
+
+    // Mismatched types are never equal.
+    CPPUNIT_ASSERT(!matches("color = 1"));
+    CPPUNIT_ASSERT(matches("color <> 1"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSelectorTest::testLogicalOperators() {
+
+    CPPUNIT_ASSERT(matches("color = 'red' AND count = 42"));
+    CPPUNIT_ASSERT(!matches("color = 'red' AND count = 41"));
+    CPPUNIT_ASSERT(matches("color = 'blue' OR count = 42"));
+    CPPUNIT_ASSERT(!matches("color = 'blue' OR count = 41"));
+    CPPUNIT_ASSERT(matches("NOT color = 'blue'"));
+    CPPUNIT_ASSERT(matches("color = 'blue' OR color = 'green' OR (count > 40 and price < 10)"));
+    CPPUNIT_ASSERT(!matches("not (color = 'red')"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSelectorTest::testNullHandling() {
+
+    CPPUNIT_ASSERT(matches("missing IS NULL"));
+    CPPUNIT_ASSERT(!matches("missing IS NOT NULL"));
+    CPPUNIT_ASSERT(matches("color IS NOT NULL"));
+
+    // Comparisons against a missing property are UNKNOWN and so never select.
+    CPPUNIT_ASSERT(!matches("missing = 'x'"));
+    CPPUNIT_ASSERT(!matches("missing <> 'x'"));
+    CPPUNIT_ASSERT(!matches("NOT missing = 'x'"));
+    CPPUNIT_ASSERT(!matches("missing > 1"));
+
+    // UNKNOWN AND FALSE is FALSE, UNKNOWN OR TRUE is TRUE.
+    CPPUNIT_ASSERT(matches("NOT (missing = 1 AND count = 0)"));
+    CPPUNIT_ASSERT(matches("missing = 1 OR count = 42"));
+    CPPUNIT_ASSERT(!matches("missing = 1 OR count = 0"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSelectorTest::testArithmetic() {
+
+    CPPUNIT_ASSERT(matches("count + 8 = 50"));
+    CPPUNIT_ASSERT(matches("count - 2 = 40"));
+    CPPUNIT_ASSERT(matches("count * 2 = 84"));
+    CPPUNIT_ASSERT(matches("count / 5 = 8"));
+    CPPUNIT_ASSERT(matches("count % 5 = 2"));
+    CPPUNIT_ASSERT(matches("count / 5.0 = 8.4"));
+    CPPUNIT_ASSERT(matches("-count = -42"));
+    CPPUNIT_ASSERT(matches("2 + 3 * 4 = 14"));
+    CPPUNIT_ASSERT(matches("(2 + 3) * 4 = 20"));
+    CPPUNIT_ASSERT(matches("price * 2 = 19"));
+    CPPUNIT_ASSERT(!matches("count / 0 = 0"));
+    CPPUNIT_ASSERT(!matches("missing + 1 = 1"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSelectorTest::testBetween() {
+
+    CPPUNIT_ASSERT(matches("count BETWEEN 40 AND 50"));
+    CPPUNIT_ASSERT(matches("count BETWEEN 42 AND 42"));
+    CPPUNIT_ASSERT(!matches("count BETWEEN 43 AND 50"));
+    CPPUNIT_ASSERT(matches("count NOT BETWEEN 43 AND 50"));
+    CPPUNIT_ASSERT(!matches("count NOT BETWEEN 40 AND 50"));
+    CPPUNIT_ASSERT(matches("price BETWEEN 9 AND 10 AND color = 'red'"));
+    CPPUNIT_ASSERT(!matches("missing BETWEEN 1 AND 2"));
+    CPPUNIT_ASSERT(!matches("missing NOT BETWEEN 1 AND 2"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSelectorTest::testLike() {
+
+    CPPUNIT_ASSERT(matches("name LIKE 'Hello%'"));
+    CPPUNIT_ASSERT(matches("name LIKE '%World'"));
+    CPPUNIT_ASSERT(matches("name LIKE '%o W%'"));
+    CPPUNIT_ASSERT(matches("name LIKE 'H_llo World'"));
+    CPPUNIT_ASSERT(matches("name LIKE '%'"));
+    CPPUNIT_ASSERT(matches("name LIKE 'Hello World'"));
+    CPPUNIT_ASSERT(!matches("name LIKE 'Hello'"));
+    CPPUNIT_ASSERT(!matches("name LIKE '_Hello%'"));
+    CPPUNIT_ASSERT(matches("name NOT LIKE 'Goodbye%'"));
+    CPPUNIT_ASSERT(matches("color LIKE '%%d'"));
+    CPPUNIT_ASSERT(!matches("missing LIKE '%'"));
+
+    message.getMessageProperties().setString("code", "100%_done");
+    CPPUNIT_ASSERT(matches("code LIKE '100\\%\\_done' ESCAPE '\\'"));
+    CPPUNIT_ASSERT(matches("code LIKE '100!%%' ESCAPE '!'"));
+    CPPUNIT_ASSERT(!matches("code LIKE '100!_%' ESCAPE '!'"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSelectorTest::testIn() {
+
+    CPPUNIT_ASSERT(matches("color IN ('red', 'green', 'blue')"));
+    CPPUNIT_ASSERT(!matches("color IN ('green', 'blue')"));
+    CPPUNIT_ASSERT(matches("color NOT IN ('green', 'blue')"));
+    CPPUNIT_ASSERT(matches("color in ('red')"));
+    CPPUNIT_ASSERT(!matches("missing IN ('red')"));
+    CPPUNIT_ASSERT(!matches("missing NOT IN ('red')"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSelectorTest::testHeaderFields() {
+
+    CPPUNIT_ASSERT(matches("JMSPriority = 4"));
+    CPPUNIT_ASSERT(matches("JMSPriority > 3 AND JMSPriority < 5"));
+    CPPUNIT_ASSERT(matches("JMSDeliveryMode = 'PERSISTENT'"));
+    CPPUNIT_ASSERT(matches("JMSType = 'order'"));
+    CPPUNIT_ASSERT(matches("JMSCorrelationID IS NULL"));
+    CPPUNIT_ASSERT(matches("JMSTimestamp = 1000"));
+    CPPUNIT_ASSERT(matches("JMSRedelivered = FALSE"));
+    CPPUNIT_ASSERT(matches("JMSXDeliveryCount = 1"));
+    CPPUNIT_ASSERT(matches("JMSXGroupID = 'group-1' AND JMSXGroupSeq = 3"));
+    CPPUNIT_ASSERT(matches("JMSMessageID IS NULL"));
+
+    message.setPersistent(false);
+    message.setRedeliveryCounter(2);
+    message.setCorrelationId("abc");
+    CPPUNIT_ASSERT(matches("JMSDeliveryMode = 'NON_PERSISTENT'"));
+    CPPUNIT_ASSERT(matches("JMSRedelivered AND JMSXDeliveryCount = 3"));
+    CPPUNIT_ASSERT(matches("JMSCorrelationID = 'abc'"));
+
+    Pointer<ProducerId> producerId(new ProducerId());
+    producerId->setConnectionId("ID:host-1234-1");
+    producerId->setSessionId(1);
+    producerId->setValue(2);
+    Pointer<MessageId> messageId(new MessageId());
+    messageId->setProducerId(producerId);
+    messageId->setProducerSequenceId(3);
+    message.setMessageId(messageId);
+    CPPUNIT_ASSERT(matches("JMSMessageID = 'ID:host-1234-1:1:2:3'"));
+
+    // Unknown JMS prefixed names are treated as ordinary properties.
+    message.getMessageProperties().setString("JMSCustom", "x");
+    CPPUNIT_ASSERT(matches("JMSCustom = 'x'"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSelectorTest::testLiterals() {
+
+    CPPUNIT_ASSERT(matches("count = 0x2A"));
+    CPPUNIT_ASSERT(matches("count = 052"));
+    CPPUNIT_ASSERT(matches("count = 42L"));
+    CPPUNIT_ASSERT(matches("price = 95e-1"));
+    CPPUNIT_ASSERT(matches("price = .95E1"));
+    CPPUNIT_ASSERT(matches("-9223372036854775808 < 0"));
+    CPPUNIT_ASSERT(matches("9223372036854775808 > 0"));
+
+    message.getMessageProperties().setString("quote", "it's");
+    CPPUNIT_ASSERT(matches("quote = 'it''s'"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSelectorTest::testInvalidSelectors() {
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an InvalidSelectorException",
+        MessageSelector("color = "),
+        cms::InvalidSelectorException);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an InvalidSelectorException",
+        MessageSelector("color = 'red"),
+        cms::InvalidSelectorException);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an InvalidSelectorException",
+        MessageSelector("(color = 'red'"),
+        cms::InvalidSelectorException);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an InvalidSelectorException",
+        MessageSelector("color IN (1, 2)"),
+        cms::InvalidSelectorException);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an InvalidSelectorException",
+        MessageSelector("name LIKE 'a%' ESCAPE 'ab'"),
+        cms::InvalidSelectorException);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an InvalidSelectorException",
+        MessageSelector("count = 12abc"),
+        cms::InvalidSelectorException);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an InvalidSelectorException",
+        MessageSelector("color = 'red' #"),
+        cms::InvalidSelectorException);
+}
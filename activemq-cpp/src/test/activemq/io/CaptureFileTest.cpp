@@ -0,0 +1,282 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CaptureFileTest.h"
+
+#include <activemq/io/CaptureFile.h>
+#include <activemq/io/CaptureFileReader.h>
+#include <activemq/io/CaptureRecord.h>
+#include <decaf/lang/Thread.h>
+#include <decaf/lang/Runnable.h>
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::io;
+using namespace decaf::lang;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const char* CAPTURE_PATH = "CaptureFileTest.capture";
+
+    void appendInt(CaptureFile& file, int streamId, int flags, int value, int length) {
+        std::vector<unsigned char> data(length, (unsigned char) 0xAB);
+        memcpy(&data[0], &value, sizeof(value));
+        file.append(streamId, flags, &data[0], length);
+    }
+
+    int readInt(const CaptureRecord& record) {
+        int value;
+        memcpy(&value, &record.getData()[0], sizeof(value));
+        return value;
+    }
+
+    class Appender : public Runnable {
+    private:
+
+        CaptureFile* file;
+        int streamId;
+        int count;
+
+    private:
+
+        Appender(const Appender&);
+        Appender& operator=(const Appender&);
+
+    public:
+
+        Appender(CaptureFile* file, int count) : file(file), streamId(file->newStreamId()), count(count) {}
+
+        virtual ~Appender() {}
+
+        int getStreamId() const {
+            return this->streamId;
+        }
+
+        virtual void run() {
+            for (int i = 0; i < count; ++i) {
+                appendInt(*file, streamId, CaptureFile::OUTBOUND, i, 4 + (i % 29));
+            }
+        }
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CaptureFileTest::tearDown() {
+    ::remove(CAPTURE_PATH);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CaptureFileTest::testAppendAndRead() {
+
+    ::remove(CAPTURE_PATH);
+
+    {
+        CaptureFile file(CAPTURE_PATH, 1000);
+        CPPUNIT_ASSERT_EQUAL((int) CaptureFile::MINIMUM_CAPACITY, file.getCapacity());
+
+        int first = file.newStreamId();
+        int second = file.newStreamId();
+        CPPUNIT_ASSERT(first != second);
+
+        const unsigned char hello[] = { 'h', 'e', 'l', 'l', 'o' };
+        file.append(first, CaptureFile::OUTBOUND, hello, 5);
+        file.append(second, CaptureFile::INBOUND, hello, 3);
+        file.append(first, CaptureFile::INBOUND, NULL, 0);
+    }
+
+    CaptureFileReader reader(CAPTURE_PATH);
+    CPPUNIT_ASSERT(!reader.isWrapped());
+    CPPUNIT_ASSERT_EQUAL(2, reader.getStreamCount());
+    CPPUNIT_ASSERT_EQUAL(3, reader.getRecordCount());
+
+    CaptureRecord record;
+    CPPUNIT_ASSERT(reader.next(record));
+    CPPUNIT_ASSERT_EQUAL(1, record.getStreamId());
+    CPPUNIT_ASSERT(!record.isInbound());
+    CPPUNIT_ASSERT_EQUAL(std::string("hello"), std::string(record.getData().begin(), record.getData().end()));
+    long long timestamp = record.getTimestamp();
+    CPPUNIT_ASSERT(timestamp > 0);
+
+    CPPUNIT_ASSERT(reader.next(record));
+    CPPUNIT_ASSERT_EQUAL(2, record.getStreamId());
+    CPPUNIT_ASSERT(record.isInbound());
+    CPPUNIT_ASSERT_EQUAL(std::string("hel"), std::string(record.getData().begin(), record.getData().end()));
+    CPPUNIT_ASSERT(record.getTimestamp() >= timestamp);
+
+    CPPUNIT_ASSERT(reader.next(record));
+    CPPUNIT_ASSERT(record.getData().empty());
+    CPPUNIT_ASSERT(!reader.next(record));
+
+    reader.reset();
+    CPPUNIT_ASSERT(reader.next(record));
+    CPPUNIT_ASSERT_EQUAL(1, record.getStreamId());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CaptureFileTest::testWrap() {
+
+    ::remove(CAPTURE_PATH);
+
+    {
+        CaptureFile file(CAPTURE_PATH, CaptureFile::MINIMUM_CAPACITY);
+        int streamId = file.newStreamId();
+
+        // Odd sizes so the records never line up with the end of the ring.
+        for (int i = 0; i < 1000; ++i) {
+            appendInt(file, streamId, CaptureFile::OUTBOUND, i, 100 + (i % 7) * 13);
+        }
+    }
+
+    CaptureFileReader reader(CAPTURE_PATH);
+    CPPUNIT_ASSERT(reader.isWrapped());
+    CPPUNIT_ASSERT(reader.getRecordCount() > 100);
+    CPPUNIT_ASSERT(reader.getRecordCount() < 1000);
+
+    CaptureRecord record;
+    CPPUNIT_ASSERT(reader.next(record));
+    int expected = readInt(record);
+    CPPUNIT_ASSERT_EQUAL(1000 - reader.getRecordCount(), expected);
+
+    while (reader.next(record)) {
+        CPPUNIT_ASSERT_EQUAL(++expected, readInt(record));
+        CPPUNIT_ASSERT_EQUAL(100 + (expected % 7) * 13, (int) record.getData().size());
+    }
+
+    CPPUNIT_ASSERT_EQUAL(999, expected);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CaptureFileTest::testReopen() {
+
+    ::remove(CAPTURE_PATH);
+
+    {
+        CaptureFile file(CAPTURE_PATH, CaptureFile::MINIMUM_CAPACITY);
+        int streamId = file.newStreamId();
+        for (int i = 0; i < 3; ++i) {
+            appendInt(file, streamId, CaptureFile::INBOUND, i, 8);
+        }
+    }
+
+    {
+        CaptureFile file(CAPTURE_PATH, CaptureFile::MINIMUM_CAPACITY);
+        CPPUNIT_ASSERT_EQUAL(2, file.newStreamId());
+        appendInt(file, 2, CaptureFile::INBOUND, 3, 8);
+    }
+
+    {
+        CaptureFileReader reader(CAPTURE_PATH);
+        CPPUNIT_ASSERT_EQUAL(4, reader.getRecordCount());
+        CPPUNIT_ASSERT_EQUAL(2, reader.getStreamCount());
+
+        CaptureRecord record;
+        for (int i = 0; i < 4; ++i) {
+            CPPUNIT_ASSERT(reader.next(record));
+            CPPUNIT_ASSERT_EQUAL(i, readInt(record));
+        }
+    }
+
+    // A different capacity starts the capture over.
+    {
+        CaptureFile file(CAPTURE_PATH, CaptureFile::MINIMUM_CAPACITY * 2);
+        CPPUNIT_ASSERT_EQUAL(1, file.newStreamId());
+    }
+
+    CaptureFileReader reader(CAPTURE_PATH);
+    CPPUNIT_ASSERT_EQUAL(0, reader.getRecordCount());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CaptureFileTest::testDroppedRecord() {
+
+    ::remove(CAPTURE_PATH);
+
+    {
+        CaptureFile file(CAPTURE_PATH, CaptureFile::MINIMUM_CAPACITY);
+        int streamId = file.newStreamId();
+
+        appendInt(file, streamId, CaptureFile::OUTBOUND, 1, 16);
+        appendInt(file, streamId, CaptureFile::OUTBOUND, 2, CaptureFile::MINIMUM_CAPACITY);
+        appendInt(file, streamId, CaptureFile::OUTBOUND, 3, 16);
+
+        CPPUNIT_ASSERT_EQUAL(1, file.getDroppedCount());
+    }
+
+    CaptureFileReader reader(CAPTURE_PATH);
+    CPPUNIT_ASSERT_EQUAL(1, reader.getDroppedCount());
+    CPPUNIT_ASSERT_EQUAL(2, reader.getRecordCount());
+
+    CaptureRecord record;
+    CPPUNIT_ASSERT(reader.next(record));
+    CPPUNIT_ASSERT_EQUAL(1, readInt(record));
+    CPPUNIT_ASSERT(reader.next(record));
+    CPPUNIT_ASSERT_EQUAL(3, readInt(record));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CaptureFileTest::testConcurrentAppend() {
+
+    ::remove(CAPTURE_PATH);
+
+    const int THREADS = 4;
+    const int COUNT = 2000;
+
+    {
+        CaptureFile file(CAPTURE_PATH, 1024 * 1024);
+
+        std::vector<Appender*> appenders;
+        std::vector<Thread*> threads;
+        for (int i = 0; i < THREADS; ++i) {
+            appenders.push_back(new Appender(&file, COUNT));
+            threads.push_back(new Thread(appenders.back()));
+        }
+
+        for (int i = 0; i < THREADS; ++i) {
+            threads[i]->start();
+        }
+
+        for (int i = 0; i < THREADS; ++i) {
+            threads[i]->join();
+            delete threads[i];
+            delete appenders[i];
+        }
+    }
+
+    CaptureFileReader reader(CAPTURE_PATH);
+    CPPUNIT_ASSERT(!reader.isWrapped());
+    CPPUNIT_ASSERT_EQUAL(THREADS * COUNT, reader.getRecordCount());
+
+    // Each thread's records come back complete and in the order it wrote them.
+    std::vector<int> next(THREADS + 1, 0);
+    CaptureRecord record;
+    while (reader.next(record)) {
+        int streamId = record.getStreamId();
+        CPPUNIT_ASSERT(streamId >= 1 && streamId <= THREADS);
+        CPPUNIT_ASSERT_EQUAL(next[streamId], readInt(record));
+        CPPUNIT_ASSERT_EQUAL(4 + (next[streamId] % 29), (int) record.getData().size());
+        next[streamId]++;
+    }
+
+    for (int i = 1; i <= THREADS; ++i) {
+        CPPUNIT_ASSERT_EQUAL(COUNT, next[i]);
+    }
+}
@@ -266,3 +266,42 @@ void ConnectionStateTrackerTest::testMessagePullCache() {
 
     CPPUNIT_ASSERT_EQUAL_MESSAGE("Should only be three message pulls", 10, transport->messagePulls.size());
 }
+
+////////////////////////////////////////////////////////////////////////////////
+void ConnectionStateTrackerTest::testPipelinedMessagePullCache() {
+
+    ConnectionStateTracker tracker;
+    tracker.setTrackMessages(true);
+
+    ConnectionData conn = createConnectionState(tracker);
+
+    Pointer<ConsumerId> otherId(conn.consumer->getConsumerId()->cloneDataStructure());
+    otherId->setValue(otherId->getValue() + 1);
+
+    Pointer<ActiveMQDestination> destination(new ActiveMQTopic("TEST"));
+
+    // Each slot is reused once its pull has been answered, only the last pull per slot is kept.
+    for (int i = 0; i < 8; ++i) {
+        Pointer<commands::MessagePull> pull(new commands::MessagePull());
+        pull->setConsumerId(conn.consumer->getConsumerId());
+        pull->setDestination(destination);
+        pull->setCorrelationId(Integer::toString(i % 4));
+        tracker.processMessagePull(pull.get());
+    }
+
+    Pointer<commands::MessagePull> other(new commands::MessagePull());
+    other->setConsumerId(otherId);
+    other->setDestination(destination);
+    tracker.processMessagePull(other.get());
+
+    Pointer<TrackingTransport> transport(new TrackingTransport);
+    tracker.restore(transport);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Should replay every outstanding pull", 5, transport->messagePulls.size());
+
+    tracker.processRemoveConsumer(conn.consumer->getConsumerId().get());
+
+    transport.reset(new TrackingTransport);
+    tracker.restore(transport);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Should not replay pulls of a removed consumer", 1, transport->messagePulls.size());
+    CPPUNIT_ASSERT(transport->messagePulls.getFirst().dynamicCast<MessagePull>()->getConsumerId()->equals(*otherId));
+}
@@ -22,6 +22,7 @@
 #include <activemq/threads/Task.h>
 #include <activemq/threads/DedicatedTaskRunner.h>
 
+#include <decaf/lang/System.h>
 #include <decaf/lang/Thread.h>
 #include <decaf/lang/exceptions/NullPointerException.h>
 
@@ -104,3 +105,39 @@ void DedicatedTaskRunnerTest::testSimple() {
     Thread::sleep( 250 );
     CPPUNIT_ASSERT( infiniteTask.getCount() == count );
 }
+
+////////////////////////////////////////////////////////////////////////////////
+void DedicatedTaskRunnerTest::testWakeupAfter() {
+
+    SimpleCountingTask task;
+    DedicatedTaskRunner runner(&task);
+    runner.start();
+
+    runner.wakeup();
+    Thread::sleep(100);
+    unsigned int count = task.getCount();
+    CPPUNIT_ASSERT(count >= 1);
+
+    long long start = System::currentTimeMillis();
+    runner.wakeupAfter(2000);
+    runner.wakeupAfter(300);
+    Thread::sleep(100);
+    CPPUNIT_ASSERT_EQUAL(count, task.getCount());
+
+    // The earlier of the two deadlines wins.
+    while (task.getCount() == count && System::currentTimeMillis() - start < 1500) {
+        Thread::sleep(10);
+    }
+    CPPUNIT_ASSERT_EQUAL(count + 1, task.getCount());
+    CPPUNIT_ASSERT(System::currentTimeMillis() - start >= 250);
+
+    // A deadline is only honored for the next idle period.
+    Thread::sleep(2500);
+    CPPUNIT_ASSERT_EQUAL(count + 1, task.getCount());
+
+    runner.wakeupAfter(0);
+    Thread::sleep(100);
+    CPPUNIT_ASSERT_EQUAL(count + 2, task.getCount());
+
+    runner.shutdown();
+}
@@ -28,6 +28,7 @@ namespace threads {
 
         CPPUNIT_TEST_SUITE( DedicatedTaskRunnerTest );
         CPPUNIT_TEST( testSimple );
+        CPPUNIT_TEST( testWakeupAfter );
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -36,6 +37,7 @@ namespace threads {
         virtual ~DedicatedTaskRunnerTest() {}
 
         void testSimple();
+        void testWakeupAfter();
 
     };
 
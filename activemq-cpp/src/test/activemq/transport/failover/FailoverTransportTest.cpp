@@ -27,6 +27,7 @@
 #include <decaf/lang/Pointer.h>
 #include <decaf/lang/Thread.h>
 #include <decaf/util/UUID.h>
+#include <decaf/util/concurrent/atomic/AtomicInteger.h>
 
 using namespace activemq;
 using namespace activemq::mock;
@@ -38,6 +39,7 @@ using namespace activemq::exceptions;
 using namespace decaf::io;
 using namespace decaf::lang;
 using namespace decaf::util;
+using namespace decaf::util::concurrent::atomic;
 
 ////////////////////////////////////////////////////////////////////////////////
 FailoverTransportTest::FailoverTransportTest() {
@@ -710,3 +712,94 @@ void FailoverTransportTest::testConnectedToMockBroker() {
     broker1.stop();
     broker1.waitUntilStopped();
 }
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    class OnewaySender : public Runnable {
+    private:
+
+        Transport* transport;
+        int numMessages;
+        AtomicInteger* errors;
+
+    private:
+
+        OnewaySender( const OnewaySender& );
+        OnewaySender& operator= ( const OnewaySender& );
+
+    public:
+
+        OnewaySender( Transport* transport, int numMessages, AtomicInteger* errors ) :
+            transport( transport ), numMessages( numMessages ), errors( errors ) {}
+
+        virtual ~OnewaySender() {}
+
+        virtual void run() {
+            Pointer<ActiveMQMessage> message( new ActiveMQMessage() );
+            for( int i = 0; i < numMessages; ++i ) {
+                try {
+                    transport->oneway( message );
+                } catch( Exception& ex ) {
+                    errors->incrementAndGet();
+                }
+            }
+        }
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void FailoverTransportTest::testConcurrentSendsAcrossFailure() {
+
+    std::string uri =
+        "failover://(mock://localhost:61616?failOnSendMessage=true&numSentMessageBeforeFail=100,"
+                    "mock://localhost:61618?name=Backup)?randomize=false";
+
+    const int numThreads = 4;
+    const int numMessages = 250;
+
+    DefaultTransportListener listener;
+    FailoverTransportFactory factory;
+
+    Pointer<Transport> transport( factory.create( uri ) );
+    CPPUNIT_ASSERT( transport != NULL );
+    transport->setTransportListener( &listener );
+
+    FailoverTransport* failover = dynamic_cast<FailoverTransport*>(
+        transport->narrow( typeid( FailoverTransport ) ) );
+
+    CPPUNIT_ASSERT( failover != NULL );
+
+    transport->start();
+
+    int count = 0;
+    while( !failover->isConnected() && count++ < 20 ) {
+        Thread::sleep( 100 );
+    }
+    CPPUNIT_ASSERT( failover->isConnected() == true );
+
+    AtomicInteger errors;
+    std::vector< Pointer<OnewaySender> > senders;
+    std::vector< Pointer<Thread> > threads;
+
+    for( int i = 0; i < numThreads; ++i ) {
+        senders.push_back( Pointer<OnewaySender>(
+            new OnewaySender( transport.get(), numMessages, &errors ) ) );
+        threads.push_back( Pointer<Thread>( new Thread( senders.back().get() ) ) );
+        threads.back()->start();
+    }
+
+    for( int i = 0; i < numThreads; ++i ) {
+        threads[i]->join();
+    }
+
+    // Every send either went out on the first broker or was retried on the backup.
+    CPPUNIT_ASSERT_EQUAL( 0, errors.get() );
+    CPPUNIT_ASSERT( failover->isConnected() == true );
+
+    MockTransport* mock = dynamic_cast<MockTransport*>( transport->narrow( typeid( MockTransport ) ) );
+    CPPUNIT_ASSERT( mock != NULL );
+    CPPUNIT_ASSERT_EQUAL( std::string( "Backup" ), mock->getName() );
+
+    transport->close();
+}
@@ -54,6 +54,7 @@ namespace failover {
         CPPUNIT_TEST( testPriorityBackupConfig );
         CPPUNIT_TEST( testUriOptionsApplied );
         CPPUNIT_TEST( testConnectedToMockBroker );
+        CPPUNIT_TEST( testConcurrentSendsAcrossFailure );
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -75,6 +76,7 @@ namespace failover {
         void testPriorityBackupConfig();
         void testUriOptionsApplied();
         void testConnectedToMockBroker();
+        void testConcurrentSendsAcrossFailure();
 
     private:
 
@@ -0,0 +1,209 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MessageSpoolTest.h"
+
+#include <activemq/transport/failover/MessageSpool.h>
+#include <activemq/commands/ActiveMQTextMessage.h>
+#include <activemq/commands/MessageId.h>
+#include <activemq/commands/ProducerId.h>
+#include <decaf/lang/Integer.h>
+#include <decaf/lang/exceptions/IllegalArgumentException.h>
+
+#include <cstdio>
+#include <string>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::commands;
+using namespace activemq::transport;
+using namespace activemq::transport::failover;
+using namespace decaf::lang;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const char* SPOOL_DIRECTORY = "MessageSpoolTest.spool";
+
+    Pointer<ActiveMQTextMessage> createMessage(int sequence, const std::string& text) {
+        Pointer<ProducerId> producerId(new ProducerId());
+        producerId->setConnectionId("ID:MessageSpoolTest:1");
+        producerId->setSessionId(1);
+        producerId->setValue(1);
+
+        Pointer<MessageId> messageId(new MessageId());
+        messageId->setProducerId(producerId);
+        messageId->setProducerSequenceId(sequence);
+
+        Pointer<ActiveMQTextMessage> message(new ActiveMQTextMessage());
+        message->setCommandId(sequence);
+        message->setMessageId(messageId);
+        message->setPersistent(true);
+        message->setText(text);
+        return message;
+    }
+
+    void assertMessage(int sequence, const std::string& text, const Pointer<Command>& command) {
+        CPPUNIT_ASSERT(command != NULL);
+        Pointer<ActiveMQTextMessage> message = command.dynamicCast<ActiveMQTextMessage>();
+        CPPUNIT_ASSERT_EQUAL((long long) sequence, message->getMessageId()->getProducerSequenceId());
+        CPPUNIT_ASSERT_EQUAL(sequence, message->getCommandId());
+        CPPUNIT_ASSERT_EQUAL(text, message->getText());
+        CPPUNIT_ASSERT(message->isPersistent());
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSpoolTest::tearDown() {
+    ::remove(SPOOL_DIRECTORY);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSpoolTest::testOfferAndRemove() {
+
+    MessageSpool spool(SPOOL_DIRECTORY);
+
+    CPPUNIT_ASSERT(spool.isEmpty());
+    CPPUNIT_ASSERT(spool.peek() == NULL);
+    CPPUNIT_ASSERT_EQUAL(0, spool.getSegmentCount());
+
+    for (int i = 1; i <= 10; ++i) {
+        CPPUNIT_ASSERT(spool.offer(createMessage(i, "message " + Integer::toString(i))));
+    }
+
+    CPPUNIT_ASSERT_EQUAL(10, spool.size());
+    CPPUNIT_ASSERT_EQUAL(1, spool.getSegmentCount());
+
+    // Peek doesn't consume the head.
+    assertMessage(1, "message 1", spool.peek());
+    assertMessage(1, "message 1", spool.peek());
+
+    for (int i = 1; i <= 10; ++i) {
+        assertMessage(i, "message " + Integer::toString(i), spool.peek());
+        spool.remove();
+    }
+
+    CPPUNIT_ASSERT(spool.isEmpty());
+    CPPUNIT_ASSERT_EQUAL(0, spool.getSegmentCount());
+
+    // Removing from an empty spool does nothing.
+    spool.remove();
+    CPPUNIT_ASSERT(spool.isEmpty());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSpoolTest::testSegmentRollover() {
+
+    MessageSpool spool(SPOOL_DIRECTORY, 1024 * 1024, MessageSpool::MINIMUM_SEGMENT_SIZE);
+    const std::string text(500, 'x');
+
+    int count = 0;
+    while (spool.getSegmentCount() < 4) {
+        CPPUNIT_ASSERT(spool.offer(createMessage(++count, text)));
+    }
+
+    CPPUNIT_ASSERT_EQUAL(count, spool.size());
+
+    // Segments are released as they are emptied, interleaved offers keep the order.
+    int next = 1;
+    while (spool.getSegmentCount() > 2) {
+        assertMessage(next++, text, spool.peek());
+        spool.remove();
+    }
+
+    CPPUNIT_ASSERT(spool.offer(createMessage(++count, text)));
+
+    while (!spool.isEmpty()) {
+        assertMessage(next++, text, spool.peek());
+        spool.remove();
+    }
+
+    CPPUNIT_ASSERT_EQUAL(count + 1, next);
+    CPPUNIT_ASSERT_EQUAL(0, spool.getSegmentCount());
+
+    // Every segment file has been deleted so the directory can be removed.
+    CPPUNIT_ASSERT_EQUAL(0, ::remove(SPOOL_DIRECTORY));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSpoolTest::testQuota() {
+
+    MessageSpool spool(SPOOL_DIRECTORY, MessageSpool::MINIMUM_SEGMENT_SIZE * 2, MessageSpool::MINIMUM_SEGMENT_SIZE);
+    const std::string text(500, 'x');
+
+    int count = 0;
+    while (spool.offer(createMessage(count + 1, text))) {
+        count++;
+    }
+
+    CPPUNIT_ASSERT(count > 0);
+    CPPUNIT_ASSERT_EQUAL(count, spool.size());
+    CPPUNIT_ASSERT_EQUAL(2, spool.getSegmentCount());
+
+    // Draining the first segment frees room for another.
+    int next = 1;
+    while (spool.getSegmentCount() == 2) {
+        assertMessage(next++, text, spool.peek());
+        spool.remove();
+    }
+
+    CPPUNIT_ASSERT(spool.offer(createMessage(++count, text)));
+
+    while (!spool.isEmpty()) {
+        spool.remove();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSpoolTest::testOversizedCommand() {
+
+    MessageSpool spool(SPOOL_DIRECTORY, 1024 * 1024, MessageSpool::MINIMUM_SEGMENT_SIZE);
+
+    CPPUNIT_ASSERT(!spool.offer(createMessage(1, std::string(MessageSpool::MINIMUM_SEGMENT_SIZE, 'x'))));
+    CPPUNIT_ASSERT(spool.isEmpty());
+    CPPUNIT_ASSERT_EQUAL(0, spool.getSegmentCount());
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IllegalArgumentException",
+        MessageSpool(SPOOL_DIRECTORY, 1024 * 1024, MessageSpool::MINIMUM_SEGMENT_SIZE - 1),
+        decaf::lang::exceptions::IllegalArgumentException);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IllegalArgumentException",
+        MessageSpool(""),
+        decaf::lang::exceptions::IllegalArgumentException);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageSpoolTest::testClose() {
+
+    MessageSpool spool(SPOOL_DIRECTORY);
+
+    CPPUNIT_ASSERT(spool.offer(createMessage(1, "message")));
+    spool.remove();
+    CPPUNIT_ASSERT(spool.offer(createMessage(2, "message")));
+    CPPUNIT_ASSERT_EQUAL(1, spool.getSegmentCount());
+
+    // Commands still stored are discarded along with their segments, nothing would
+    // ever reopen them.
+    spool.close();
+    CPPUNIT_ASSERT(!spool.offer(createMessage(3, "message")));
+    CPPUNIT_ASSERT(spool.isEmpty());
+    CPPUNIT_ASSERT_EQUAL(0, spool.getSegmentCount());
+
+    CPPUNIT_ASSERT_EQUAL(0, ::remove(SPOOL_DIRECTORY));
+}
@@ -0,0 +1,604 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MockBrokerTest.h"
+
+#include <activemq/transport/mock/MockBroker.h>
+#include <activemq/core/ActiveMQConnection.h>
+#include <activemq/core/ActiveMQConnectionFactory.h>
+#include <activemq/commands/ActiveMQBytesMessage.h>
+#include <activemq/commands/ActiveMQTextMessage.h>
+#include <activemq/commands/MessageDispatch.h>
+#include <activemq/io/CaptureFileReader.h>
+#include <activemq/wireformat/openwire/OpenWireCaptureDecoder.h>
+#include <activemq/transport/DefaultTransportListener.h>
+#include <activemq/util/LatencyStatistics.h>
+
+#include <cms/BytesMessage.h>
+#include <cms/Connection.h>
+#include <cms/DeliveryMode.h>
+#include <cms/ExceptionListener.h>
+#include <cms/MessageConsumer.h>
+#include <cms/MessageProducer.h>
+#include <cms/Queue.h>
+#include <cms/Session.h>
+#include <cms/TextMessage.h>
+#include <cms/Topic.h>
+
+#include <decaf/lang/Integer.h>
+#include <decaf/lang/System.h>
+#include <decaf/lang/Thread.h>
+#include <decaf/util/concurrent/CountDownLatch.h>
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::core;
+using namespace activemq::commands;
+using namespace activemq::io;
+using namespace activemq::transport;
+using namespace activemq::transport::mock;
+using namespace activemq::util;
+using namespace activemq::wireformat::openwire;
+using namespace decaf::lang;
+using namespace decaf::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    class FailureListener : public cms::ExceptionListener {
+    public:
+
+        CountDownLatch failed;
+
+        FailureListener() : failed(1) {}
+
+        virtual ~FailureListener() {}
+
+        virtual void onException(const cms::CMSException& ex AMQCPP_UNUSED) {
+            failed.countDown();
+        }
+    };
+
+    class InterruptionListener : public DefaultTransportListener {
+    public:
+
+        CountDownLatch interrupted;
+
+        InterruptionListener() : interrupted(1) {}
+
+        virtual ~InterruptionListener() {}
+
+        virtual void transportInterrupted() {
+            interrupted.countDown();
+        }
+    };
+
+    cms::Connection* connect(const std::string& uri) {
+        ActiveMQConnectionFactory factory(uri);
+        std::auto_ptr<cms::Connection> connection(factory.createConnection());
+        connection->start();
+        return connection.release();
+    }
+
+    std::string receiveText(cms::MessageConsumer* consumer, int timeout) {
+        std::auto_ptr<cms::Message> message(consumer->receive(timeout));
+        CPPUNIT_ASSERT_MESSAGE("Should have received a message", message.get() != NULL);
+        cms::TextMessage* text = dynamic_cast<cms::TextMessage*>(message.get());
+        CPPUNIT_ASSERT(text != NULL);
+        return text->getText();
+    }
+
+    void waitForQueueSize(const MockBroker& broker, const std::string& queue, long long size) {
+        for (int i = 0; i < 100 && broker.getQueueSize(queue) != size; ++i) {
+            Thread::sleep(20);
+        }
+        CPPUNIT_ASSERT_EQUAL(size, broker.getQueueSize(queue));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerTest::testQueueSendReceive() {
+
+    MockBroker broker;
+    broker.start();
+
+    std::auto_ptr<cms::Connection> connection(connect(broker.getConnectString()));
+    std::auto_ptr<cms::Session> session(connection->createSession(cms::Session::AUTO_ACKNOWLEDGE));
+    std::auto_ptr<cms::Queue> queue(session->createQueue("MockBrokerTest.Queue"));
+    std::auto_ptr<cms::MessageProducer> producer(session->createProducer(queue.get()));
+    std::auto_ptr<cms::MessageConsumer> consumer(session->createConsumer(queue.get()));
+
+    CPPUNIT_ASSERT_EQUAL(1, broker.getConnectionCount());
+
+    for (int i = 0; i < 10; ++i) {
+        std::auto_ptr<cms::TextMessage> message(session->createTextMessage(Integer::toString(i)));
+        producer->send(message.get());
+    }
+
+    for (int i = 0; i < 10; ++i) {
+        CPPUNIT_ASSERT_EQUAL(Integer::toString(i), receiveText(consumer.get(), 2000));
+    }
+
+    waitForQueueSize(broker, "MockBrokerTest.Queue", 0);
+    CPPUNIT_ASSERT_EQUAL(10LL, broker.getEnqueueCount());
+    CPPUNIT_ASSERT_EQUAL(10LL, broker.getDequeueCount());
+
+    connection->close();
+    broker.stop();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerTest::testTopicFanOut() {
+
+    MockBroker broker;
+    broker.start();
+
+    std::auto_ptr<cms::Connection> connection(connect(broker.getConnectString()));
+    std::auto_ptr<cms::Session> session(connection->createSession(cms::Session::AUTO_ACKNOWLEDGE));
+    std::auto_ptr<cms::Topic> topic(session->createTopic("MockBrokerTest.Topic"));
+    std::auto_ptr<cms::MessageConsumer> consumer1(session->createConsumer(topic.get()));
+    std::auto_ptr<cms::MessageConsumer> consumer2(session->createConsumer(topic.get()));
+    std::auto_ptr<cms::MessageProducer> producer(session->createProducer(topic.get()));
+
+    std::auto_ptr<cms::TextMessage> message(session->createTextMessage("fan-out"));
+    producer->send(message.get());
+
+    CPPUNIT_ASSERT_EQUAL(std::string("fan-out"), receiveText(consumer1.get(), 2000));
+    CPPUNIT_ASSERT_EQUAL(std::string("fan-out"), receiveText(consumer2.get(), 2000));
+
+    connection->close();
+    broker.stop();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerTest::testClientAckRedelivery() {
+
+    MockBroker broker;
+    broker.start();
+
+    std::auto_ptr<cms::Connection> connection(connect(broker.getConnectString()));
+    std::auto_ptr<cms::Session> session(connection->createSession(cms::Session::CLIENT_ACKNOWLEDGE));
+    std::auto_ptr<cms::Queue> queue(session->createQueue("MockBrokerTest.ClientAck"));
+    std::auto_ptr<cms::MessageProducer> producer(session->createProducer(queue.get()));
+
+    std::auto_ptr<cms::TextMessage> message(session->createTextMessage("redeliver"));
+    producer->send(message.get());
+
+    {
+        std::auto_ptr<cms::MessageConsumer> consumer(session->createConsumer(queue.get()));
+        CPPUNIT_ASSERT_EQUAL(std::string("redeliver"), receiveText(consumer.get(), 2000));
+        consumer->close();
+    }
+
+    // Closing the consumer without acking puts the message back on the queue.
+    waitForQueueSize(broker, "MockBrokerTest.ClientAck", 1);
+
+    std::auto_ptr<cms::MessageConsumer> consumer(session->createConsumer(queue.get()));
+    std::auto_ptr<cms::Message> received(consumer->receive(2000));
+    CPPUNIT_ASSERT(received.get() != NULL);
+    received->acknowledge();
+
+    waitForQueueSize(broker, "MockBrokerTest.ClientAck", 0);
+
+    connection->close();
+    broker.stop();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerTest::testTransactedSend() {
+
+    MockBroker broker;
+    broker.start();
+
+    std::auto_ptr<cms::Connection> connection(connect(broker.getConnectString()));
+    std::auto_ptr<cms::Session> session(connection->createSession(cms::Session::SESSION_TRANSACTED));
+    std::auto_ptr<cms::Session> receiver(connection->createSession(cms::Session::AUTO_ACKNOWLEDGE));
+    std::auto_ptr<cms::Queue> queue(session->createQueue("MockBrokerTest.Transacted"));
+    std::auto_ptr<cms::MessageProducer> producer(session->createProducer(queue.get()));
+    std::auto_ptr<cms::MessageConsumer> consumer(receiver->createConsumer(queue.get()));
+
+    std::auto_ptr<cms::TextMessage> rolledBack(session->createTextMessage("rolled back"));
+    producer->send(rolledBack.get());
+    session->rollback();
+
+    std::auto_ptr<cms::TextMessage> committed(session->createTextMessage("committed"));
+    producer->send(committed.get());
+
+    std::auto_ptr<cms::Message> early(consumer->receive(200));
+    CPPUNIT_ASSERT_MESSAGE("Nothing should arrive before the commit", early.get() == NULL);
+
+    session->commit();
+
+    CPPUNIT_ASSERT_EQUAL(std::string("committed"), receiveText(consumer.get(), 2000));
+    CPPUNIT_ASSERT_EQUAL(1LL, broker.getEnqueueCount());
+
+    connection->close();
+    broker.stop();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerTest::testZeroPrefetchPull() {
+
+    MockBroker broker;
+    broker.start();
+
+    std::auto_ptr<cms::Connection> connection(
+        connect(broker.getConnectString() + "?cms.prefetchPolicy.queuePrefetch=0"));
+    std::auto_ptr<cms::Session> session(connection->createSession(cms::Session::AUTO_ACKNOWLEDGE));
+    std::auto_ptr<cms::Queue> queue(session->createQueue("MockBrokerTest.Pull"));
+    std::auto_ptr<cms::MessageProducer> producer(session->createProducer(queue.get()));
+    std::auto_ptr<cms::MessageConsumer> consumer(session->createConsumer(queue.get()));
+
+    for (int i = 0; i < 2; ++i) {
+        std::auto_ptr<cms::TextMessage> message(session->createTextMessage(Integer::toString(i)));
+        producer->send(message.get());
+    }
+
+    // Nothing is pushed to a zero prefetch consumer until it asks.
+    waitForQueueSize(broker, "MockBrokerTest.Pull", 2);
+
+    CPPUNIT_ASSERT_EQUAL(std::string("0"), receiveText(consumer.get(), 2000));
+    CPPUNIT_ASSERT_EQUAL(std::string("1"), receiveText(consumer.get(), 2000));
+
+    connection->close();
+    broker.stop();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerTest::testStompSendReceive() {
+
+    MockBroker broker;
+    broker.setStompEnabled(true);
+    broker.start();
+
+    std::auto_ptr<cms::Connection> stomp(connect(broker.getStompConnectString()));
+    std::auto_ptr<cms::Connection> openwire(connect(broker.getConnectString()));
+
+    std::auto_ptr<cms::Session> stompSession(stomp->createSession(cms::Session::CLIENT_ACKNOWLEDGE));
+    std::auto_ptr<cms::Session> openwireSession(openwire->createSession(cms::Session::AUTO_ACKNOWLEDGE));
+    std::auto_ptr<cms::Queue> queue(stompSession->createQueue("MockBrokerTest.Stomp"));
+
+    std::auto_ptr<cms::MessageConsumer> consumer(stompSession->createConsumer(queue.get()));
+    std::auto_ptr<cms::MessageProducer> stompProducer(stompSession->createProducer(queue.get()));
+    std::auto_ptr<cms::MessageProducer> openwireProducer(openwireSession->createProducer(queue.get()));
+
+    std::auto_ptr<cms::TextMessage> fromStomp(stompSession->createTextMessage("from stomp"));
+    stompProducer->send(fromStomp.get());
+    std::auto_ptr<cms::TextMessage> fromOpenWire(openwireSession->createTextMessage("from openwire"));
+    openwireProducer->send(fromOpenWire.get());
+
+    CPPUNIT_ASSERT_EQUAL(std::string("from stomp"), receiveText(consumer.get(), 2000));
+
+    std::auto_ptr<cms::Message> last(consumer->receive(2000));
+    CPPUNIT_ASSERT(last.get() != NULL);
+    CPPUNIT_ASSERT_EQUAL(std::string("from openwire"), dynamic_cast<cms::TextMessage*>(last.get())->getText());
+    last->acknowledge();
+
+    waitForQueueSize(broker, "MockBrokerTest.Stomp", 0);
+
+    stomp->close();
+    openwire->close();
+    broker.stop();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerTest::testFailoverReconnect() {
+
+    MockBroker broker;
+    broker.start();
+
+    std::auto_ptr<cms::Connection> connection(
+        connect(std::string("failover:(") + broker.getConnectString() + ")?initialReconnectDelay=10"));
+    std::auto_ptr<cms::Session> session(connection->createSession(cms::Session::AUTO_ACKNOWLEDGE));
+    std::auto_ptr<cms::Queue> queue(session->createQueue("MockBrokerTest.Failover"));
+    std::auto_ptr<cms::MessageProducer> producer(session->createProducer(queue.get()));
+    std::auto_ptr<cms::MessageConsumer> consumer(session->createConsumer(queue.get()));
+
+    std::auto_ptr<cms::TextMessage> before(session->createTextMessage("before"));
+    producer->send(before.get());
+    CPPUNIT_ASSERT_EQUAL(std::string("before"), receiveText(consumer.get(), 2000));
+    waitForQueueSize(broker, "MockBrokerTest.Failover", 0);
+
+    broker.dropConnections();
+
+    // The consumer is restored on the new connection and sees messages sent after the drop.
+    std::auto_ptr<cms::TextMessage> after(session->createTextMessage("after"));
+    producer->send(after.get());
+    CPPUNIT_ASSERT_EQUAL(std::string("after"), receiveText(consumer.get(), 5000));
+    CPPUNIT_ASSERT_EQUAL(1, broker.getConnectionCount());
+
+    connection->close();
+    broker.stop();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerTest::testInactivityFailure() {
+
+    MockBroker broker;
+    broker.setKeepAliveEnabled(false);
+    broker.start();
+
+    FailureListener listener;
+
+    std::auto_ptr<cms::Connection> connection(
+        connect(broker.getConnectString() + "?wireFormat.MaxInactivityDuration=300"
+                                            "&wireFormat.MaxInactivityDurationInitalDelay=100"));
+    connection->setExceptionListener(&listener);
+
+    CPPUNIT_ASSERT_MESSAGE("A silent broker should trip the inactivity monitor",
+                           listener.failed.await(5000));
+
+    connection.reset(NULL);
+    broker.stop();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerTest::testLatencyStatistics() {
+
+    MockBroker broker;
+    broker.start();
+
+    std::auto_ptr<cms::Connection> connection(
+        connect(std::string("failover:(") + broker.getConnectString() + ")?initialReconnectDelay=10"
+                                                                        "&connection.statisticsEnabled=true"));
+    std::auto_ptr<cms::Session> session(connection->createSession(cms::Session::AUTO_ACKNOWLEDGE));
+    std::auto_ptr<cms::Queue> queue(session->createQueue("MockBrokerTest.Statistics"));
+    std::auto_ptr<cms::MessageProducer> producer(session->createProducer(queue.get()));
+    std::auto_ptr<cms::MessageConsumer> consumer(session->createConsumer(queue.get()));
+
+    Pointer<LatencyStatistics> statistics = dynamic_cast<ActiveMQConnection*>(connection.get())->getStatistics();
+    CPPUNIT_ASSERT(statistics != NULL);
+
+    std::auto_ptr<cms::TextMessage> before(session->createTextMessage("before"));
+    producer->send(before.get());
+    CPPUNIT_ASSERT_EQUAL(std::string("before"), receiveText(consumer.get(), 2000));
+    waitForQueueSize(broker, "MockBrokerTest.Statistics", 0);
+
+    CPPUNIT_ASSERT_EQUAL(1LL, statistics->getHistogram(LatencyStatistics::SEND_LATENCY).getCount());
+    CPPUNIT_ASSERT_EQUAL(1LL, statistics->getHistogram(LatencyStatistics::DISPATCH_RESIDENCE_TIME).getCount());
+    CPPUNIT_ASSERT(statistics->getHistogram(LatencyStatistics::MARSHAL_TIME).getCount() > 0);
+    CPPUNIT_ASSERT(statistics->getHistogram(LatencyStatistics::SOCKET_WRITE_TIME).getCount() > 0);
+
+    broker.dropConnections();
+
+    // The transport created on reconnect times its writes as well.
+    std::auto_ptr<cms::TextMessage> after(session->createTextMessage("after"));
+    producer->send(after.get());
+    long long written = statistics->getHistogram(LatencyStatistics::SOCKET_WRITE_TIME).getCount();
+    CPPUNIT_ASSERT_EQUAL(std::string("after"), receiveText(consumer.get(), 5000));
+    producer->send(after.get());
+
+    CPPUNIT_ASSERT(statistics->getHistogram(LatencyStatistics::SOCKET_WRITE_TIME).getCount() > written);
+    CPPUNIT_ASSERT_EQUAL(3LL, statistics->getHistogram(LatencyStatistics::SEND_LATENCY).getCount());
+
+    connection->close();
+    broker.stop();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerTest::testCaptureFile() {
+
+    const std::string path = "MockBrokerTest.capture";
+    ::remove(path.c_str());
+
+    MockBroker broker;
+    broker.start();
+
+    std::auto_ptr<cms::Connection> connection(
+        connect(broker.getConnectString() + "?transport.captureFile=" + path + "&transport.captureFileSize=1048576"));
+    std::auto_ptr<cms::Session> session(connection->createSession(cms::Session::AUTO_ACKNOWLEDGE));
+    std::auto_ptr<cms::Queue> queue(session->createQueue("MockBrokerTest.Capture"));
+    std::auto_ptr<cms::MessageProducer> producer(session->createProducer(queue.get()));
+    std::auto_ptr<cms::MessageConsumer> consumer(session->createConsumer(queue.get()));
+
+    std::auto_ptr<cms::TextMessage> message(session->createTextMessage("captured"));
+    producer->send(message.get());
+    CPPUNIT_ASSERT_EQUAL(std::string("captured"), receiveText(consumer.get(), 2000));
+
+    connection->close();
+    broker.stop();
+
+    CaptureFileReader reader(path);
+    CPPUNIT_ASSERT_EQUAL(1, reader.getStreamCount());
+    CPPUNIT_ASSERT(reader.getRecordCount() > 0);
+
+    OpenWireCaptureDecoder decoder;
+    CaptureRecord record;
+    int wireFormatInfos = 0;
+    int sent = 0;
+    int dispatched = 0;
+
+    while (reader.next(record)) {
+
+        decaf::util::LinkedList< Pointer<Command> > commands;
+        decoder.decode(record, commands);
+
+        while (!commands.isEmpty()) {
+            Pointer<Command> command = commands.removeFirst();
+
+            if (command->isWireFormatInfo()) {
+                wireFormatInfos++;
+            } else if (command->isMessage() && !record.isInbound()) {
+                CPPUNIT_ASSERT_EQUAL(std::string("captured"), command.dynamicCast<ActiveMQTextMessage>()->getText());
+                sent++;
+            } else if (command->isMessageDispatch() && record.isInbound()) {
+                Pointer<MessageDispatch> dispatch = command.dynamicCast<MessageDispatch>();
+                CPPUNIT_ASSERT_EQUAL(std::string("captured"), dispatch->getMessage().dynamicCast<ActiveMQTextMessage>()->getText());
+                dispatched++;
+            }
+        }
+    }
+
+    CPPUNIT_ASSERT_EQUAL(0, decoder.getErrorCount());
+    CPPUNIT_ASSERT_EQUAL(2, wireFormatInfos);
+    CPPUNIT_ASSERT_EQUAL(1, sent);
+    CPPUNIT_ASSERT_EQUAL(1, dispatched);
+
+    ::remove(path.c_str());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerTest::testFailoverSpool() {
+
+    const std::string directory = "MockBrokerTest.spool";
+    const int count = 20;
+
+    MockBroker broker;
+    broker.start();
+
+    InterruptionListener listener;
+
+    std::auto_ptr<cms::Connection> connection(
+        connect(std::string("failover:(") + broker.getConnectString() + ")?initialReconnectDelay=10"
+                "&useExponentialBackOff=false&spoolDirectory=" + directory + "&spoolSegmentSize=4096"));
+    dynamic_cast<ActiveMQConnection*>(connection.get())->addTransportListener(&listener);
+
+    std::auto_ptr<cms::Session> session(connection->createSession(cms::Session::AUTO_ACKNOWLEDGE));
+    std::auto_ptr<cms::Queue> queue(session->createQueue("MockBrokerTest.Spool"));
+    std::auto_ptr<cms::MessageProducer> producer(session->createProducer(queue.get()));
+    producer->setDeliveryMode(cms::DeliveryMode::PERSISTENT);
+
+    broker.stop();
+    CPPUNIT_ASSERT(listener.interrupted.await(5000));
+
+    // With the broker down the persistent sends are answered from the spool.
+    std::vector<std::string> messageIds;
+    long long start = System::currentTimeMillis();
+    for (int i = 0; i < count; ++i) {
+        std::auto_ptr<cms::TextMessage> message(session->createTextMessage(Integer::toString(i)));
+        producer->send(message.get());
+        messageIds.push_back(message->getCMSMessageID());
+    }
+    CPPUNIT_ASSERT(System::currentTimeMillis() - start < 2000);
+    CPPUNIT_ASSERT_EQUAL(0LL, broker.getEnqueueCount());
+
+    broker.start();
+
+    std::auto_ptr<cms::MessageConsumer> consumer(session->createConsumer(queue.get()));
+    for (int i = 0; i < count; ++i) {
+        std::auto_ptr<cms::Message> message(consumer->receive(5000));
+        CPPUNIT_ASSERT_MESSAGE("Should have received a spooled message", message.get() != NULL);
+        CPPUNIT_ASSERT_EQUAL(Integer::toString(i), dynamic_cast<cms::TextMessage*>(message.get())->getText());
+        CPPUNIT_ASSERT_EQUAL(messageIds[i], message->getCMSMessageID());
+    }
+
+    connection->close();
+    broker.stop();
+
+    CPPUNIT_ASSERT_EQUAL(0, ::remove(directory.c_str()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerTest::testFailoverSpoolClosed() {
+
+    const std::string directory = "MockBrokerTest.spoolClosed";
+
+    MockBroker broker;
+    broker.start();
+
+    InterruptionListener listener;
+
+    std::auto_ptr<cms::Connection> connection(
+        connect(std::string("failover:(") + broker.getConnectString() + ")?initialReconnectDelay=10"
+                "&useExponentialBackOff=false&spoolDirectory=" + directory + "&spoolSegmentSize=4096"));
+    dynamic_cast<ActiveMQConnection*>(connection.get())->addTransportListener(&listener);
+
+    std::auto_ptr<cms::Session> session(connection->createSession(cms::Session::AUTO_ACKNOWLEDGE));
+    std::auto_ptr<cms::Queue> queue(session->createQueue("MockBrokerTest.SpoolClosed"));
+    std::auto_ptr<cms::MessageProducer> producer(session->createProducer(queue.get()));
+    producer->setDeliveryMode(cms::DeliveryMode::PERSISTENT);
+
+    broker.stop();
+    CPPUNIT_ASSERT(listener.interrupted.await(5000));
+
+    for (int i = 0; i < 5; ++i) {
+        std::auto_ptr<cms::TextMessage> message(session->createTextMessage(Integer::toString(i)));
+        producer->send(message.get());
+    }
+
+    // Closing without a connection discards the spooled sends and their segments.
+    connection->close();
+
+    CPPUNIT_ASSERT_EQUAL(0LL, broker.getEnqueueCount());
+    CPPUNIT_ASSERT_EQUAL(0, ::remove(directory.c_str()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MockBrokerTest::testFileBody() {
+
+    const std::string path = "MockBrokerTest.body";
+    const int size = 256 * 1024;
+
+    FILE* file = ::fopen(path.c_str(), "wb");
+    CPPUNIT_ASSERT(file != NULL);
+    for (int i = 0; i < size; ++i) {
+        ::fputc((i * 7) % 256, file);
+    }
+    ::fclose(file);
+
+    MockBroker broker;
+    broker.start();
+
+    // Tight and loose encoding split the frame at different points, with compression
+    // the body is read in and deflated instead.
+    const char* options[] = { "", "?wireFormat.tightEncodingEnabled=false", "?connection.useCompression=true" };
+
+    for (int run = 0; run < 3; ++run) {
+
+        std::auto_ptr<cms::Connection> connection(connect(broker.getConnectString() + options[run]));
+        std::auto_ptr<cms::Session> session(connection->createSession(cms::Session::AUTO_ACKNOWLEDGE));
+        std::auto_ptr<cms::Queue> queue(session->createQueue("MockBrokerTest.FileBody"));
+        std::auto_ptr<cms::MessageProducer> producer(session->createProducer(queue.get()));
+        std::auto_ptr<cms::MessageConsumer> consumer(session->createConsumer(queue.get()));
+
+        std::auto_ptr<cms::BytesMessage> message(session->createBytesMessage());
+        dynamic_cast<ActiveMQBytesMessage*>(message.get())->setBodyFile(path, 1000, size - 2000);
+        message->setStringProperty("trailer", "kept");
+        producer->send(message.get());
+
+        // The next frame only decodes if the file body frame had the right lengths.
+        std::auto_ptr<cms::TextMessage> next(session->createTextMessage("next"));
+        producer->send(next.get());
+
+        std::auto_ptr<cms::Message> received(consumer->receive(5000));
+        CPPUNIT_ASSERT_MESSAGE("Should have received the file body", received.get() != NULL);
+        cms::BytesMessage* bytes = dynamic_cast<cms::BytesMessage*>(received.get());
+        CPPUNIT_ASSERT(bytes != NULL);
+        CPPUNIT_ASSERT_EQUAL(std::string("kept"), bytes->getStringProperty("trailer"));
+        CPPUNIT_ASSERT_EQUAL(size - 2000, bytes->getBodyLength());
+
+        std::vector<unsigned char> body(size - 2000);
+        bytes->readBytes(&body[0], (int) body.size());
+        for (int i = 0; i < (int) body.size(); ++i) {
+            if (body[i] != (unsigned char) (((1000 + i) * 7) % 256)) {
+                CPPUNIT_FAIL("File body was corrupted at byte " + Integer::toString(i));
+            }
+        }
+
+        CPPUNIT_ASSERT_EQUAL(std::string("next"), receiveText(consumer.get(), 2000));
+
+        connection->close();
+    }
+
+    broker.stop();
+
+    ::remove(path.c_str());
+}
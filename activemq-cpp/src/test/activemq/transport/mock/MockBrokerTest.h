@@ -0,0 +1,69 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_TRANSPORT_MOCK_MOCKBROKERTEST_H_
+#define _ACTIVEMQ_TRANSPORT_MOCK_MOCKBROKERTEST_H_
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace activemq {
+namespace transport {
+namespace mock {
+
+    class MockBrokerTest : public CppUnit::TestFixture {
+
+        CPPUNIT_TEST_SUITE( MockBrokerTest );
+        CPPUNIT_TEST( testQueueSendReceive );
+        CPPUNIT_TEST( testTopicFanOut );
+        CPPUNIT_TEST( testClientAckRedelivery );
+        CPPUNIT_TEST( testTransactedSend );
+        CPPUNIT_TEST( testZeroPrefetchPull );
+        CPPUNIT_TEST( testStompSendReceive );
+        CPPUNIT_TEST( testFailoverReconnect );
+        CPPUNIT_TEST( testInactivityFailure );
+        CPPUNIT_TEST( testLatencyStatistics );
+        CPPUNIT_TEST( testCaptureFile );
+        CPPUNIT_TEST( testFailoverSpool );
+        CPPUNIT_TEST( testFailoverSpoolClosed );
+        CPPUNIT_TEST( testFileBody );
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+
+        MockBrokerTest() {}
+        virtual ~MockBrokerTest() {}
+
+        void testQueueSendReceive();
+        void testTopicFanOut();
+        void testClientAckRedelivery();
+        void testTransactedSend();
+        void testZeroPrefetchPull();
+        void testStompSendReceive();
+        void testFailoverReconnect();
+        void testInactivityFailure();
+        void testLatencyStatistics();
+        void testCaptureFile();
+        void testFailoverSpool();
+        void testFailoverSpoolClosed();
+        void testFileBody();
+
+    };
+
+}}}
+
+#endif /* _ACTIVEMQ_TRANSPORT_MOCK_MOCKBROKERTEST_H_ */
@@ -0,0 +1,186 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ReplayTransportTest.h"
+
+#include <activemq/commands/Command.h>
+#include <activemq/core/ActiveMQConnection.h>
+#include <activemq/core/ActiveMQConnectionFactory.h>
+#include <activemq/io/CaptureFileReader.h>
+#include <activemq/io/CaptureRecord.h>
+#include <activemq/transport/TransportRegistry.h>
+#include <activemq/transport/mock/MockBroker.h>
+#include <activemq/transport/replay/ReplayTransport.h>
+#include <activemq/wireformat/openwire/OpenWireCaptureDecoder.h>
+
+#include <cms/Connection.h>
+#include <cms/MessageConsumer.h>
+#include <cms/MessageProducer.h>
+#include <cms/Queue.h>
+#include <cms/Session.h>
+#include <cms/TextMessage.h>
+
+#include <decaf/lang/Integer.h>
+#include <decaf/net/URI.h>
+#include <decaf/util/LinkedList.h>
+
+#include <cstdio>
+#include <memory>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::commands;
+using namespace activemq::core;
+using namespace activemq::io;
+using namespace activemq::transport;
+using namespace activemq::transport::mock;
+using namespace activemq::transport::replay;
+using namespace activemq::wireformat::openwire;
+using namespace decaf::lang;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const char* RECORDED_PATH = "ReplayTransportTest.capture";
+    const char* REPLAYED_PATH = "ReplayTransportTest.output.capture";
+    const int MESSAGE_COUNT = 10;
+
+    /**
+     * The steps both the recorded and the replaying client perform.
+     */
+    void run(const std::string& uri) {
+
+        ActiveMQConnectionFactory factory(uri);
+        std::auto_ptr<cms::Connection> connection(factory.createConnection());
+        connection->start();
+
+        std::auto_ptr<cms::Session> session(connection->createSession(cms::Session::AUTO_ACKNOWLEDGE));
+        std::auto_ptr<cms::Queue> queue(session->createQueue("ReplayTransportTest.Queue"));
+        std::auto_ptr<cms::MessageProducer> producer(session->createProducer(queue.get()));
+        std::auto_ptr<cms::MessageConsumer> consumer(session->createConsumer(queue.get()));
+
+        for (int i = 0; i < MESSAGE_COUNT; ++i) {
+            std::auto_ptr<cms::TextMessage> message(session->createTextMessage(Integer::toString(i)));
+            producer->send(message.get());
+        }
+
+        for (int i = 0; i < MESSAGE_COUNT; ++i) {
+            std::auto_ptr<cms::Message> message(consumer->receive(5000));
+            CPPUNIT_ASSERT_MESSAGE("Should have received a message", message.get() != NULL);
+            cms::TextMessage* text = dynamic_cast<cms::TextMessage*>(message.get());
+            CPPUNIT_ASSERT(text != NULL);
+            CPPUNIT_ASSERT_EQUAL(Integer::toString(i), text->getText());
+        }
+
+        ActiveMQConnection* amqConnection = dynamic_cast<ActiveMQConnection*>(connection.get());
+        ReplayTransport* replay = dynamic_cast<ReplayTransport*>(
+            amqConnection->getTransport().narrow(typeid(ReplayTransport)));
+
+        if (replay != NULL) {
+            CPPUNIT_ASSERT(replay->getCommandsReplayed() > MESSAGE_COUNT);
+            CPPUNIT_ASSERT(replay->getCommandsSent() > MESSAGE_COUNT);
+            CPPUNIT_ASSERT(replay->getBytesSent() > 0);
+        }
+
+        connection->close();
+
+        if (replay != NULL) {
+            CPPUNIT_ASSERT_EQUAL(replay->getCommandCount(), replay->getCommandsReplayed());
+        }
+    }
+
+    void record() {
+        MockBroker broker;
+        broker.start();
+        run(broker.getConnectString() + "?transport.captureFile=" + RECORDED_PATH + "&transport.captureFileSize=1048576");
+        broker.stop();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ReplayTransportTest::setUp() {
+    ::remove(RECORDED_PATH);
+    ::remove(REPLAYED_PATH);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ReplayTransportTest::tearDown() {
+    ::remove(RECORDED_PATH);
+    ::remove(REPLAYED_PATH);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ReplayTransportTest::testReplay() {
+
+    record();
+
+    // No broker is running, everything the client receives comes from the capture.
+    run(std::string("replay:file=") + RECORDED_PATH);
+    run(std::string("replay://localhost?file=") + RECORDED_PATH + "&speed=original");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ReplayTransportTest::testReplayOutputCapture() {
+
+    record();
+
+    run(std::string("replay:file=") + RECORDED_PATH + "&outputFile=" + REPLAYED_PATH + "&outputFileSize=1048576");
+
+    // The replayed connection decodes to the same conversation.
+    int messages[2] = { 0, 0 };
+
+    const char* paths[2] = { RECORDED_PATH, REPLAYED_PATH };
+    for (int i = 0; i < 2; ++i) {
+
+        CaptureFileReader reader(paths[i]);
+        OpenWireCaptureDecoder decoder;
+        CaptureRecord record;
+        decaf::util::LinkedList< Pointer<Command> > commands;
+
+        while (reader.next(record)) {
+            decoder.decode(record, commands);
+            while (!commands.isEmpty()) {
+                Pointer<Command> command = commands.removeFirst();
+                if (command->isMessage() || command->isMessageDispatch()) {
+                    messages[i]++;
+                }
+            }
+        }
+
+        CPPUNIT_ASSERT_EQUAL(0, decoder.getErrorCount());
+    }
+
+    CPPUNIT_ASSERT_EQUAL(2 * MESSAGE_COUNT, messages[0]);
+    CPPUNIT_ASSERT_EQUAL(messages[0], messages[1]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ReplayTransportTest::testMissingCapture() {
+
+    TransportFactory* factory = TransportRegistry::getInstance().findFactory("replay");
+    CPPUNIT_ASSERT(factory != NULL);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw when the capture file does not exist",
+        factory->create(decaf::net::URI(std::string("replay:file=") + RECORDED_PATH)),
+        decaf::lang::Exception);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw when no capture file is given",
+        factory->create(decaf::net::URI("replay://localhost")),
+        decaf::lang::Exception);
+}
@@ -0,0 +1,132 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LatencyHistogramTest.h"
+
+#include <activemq/util/LatencyHistogram.h>
+#include <activemq/util/LatencyStatistics.h>
+
+using namespace activemq;
+using namespace activemq::util;
+using namespace decaf::lang;
+
+////////////////////////////////////////////////////////////////////////////////
+void LatencyHistogramTest::testEmpty() {
+
+    LatencyHistogram histogram;
+
+    CPPUNIT_ASSERT_EQUAL( 0LL, histogram.getCount() );
+    CPPUNIT_ASSERT_EQUAL( 0LL, histogram.getMinValue() );
+    CPPUNIT_ASSERT_EQUAL( 0LL, histogram.getMaxValue() );
+    CPPUNIT_ASSERT_EQUAL( 0LL, histogram.getValueAtPercentile( 99.0 ) );
+    CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.0, histogram.getMean(), 0.0 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void LatencyHistogramTest::testBuckets() {
+
+    // Small values are exact.
+    for( long long value = 0; value < 64; ++value ) {
+        int bucket = LatencyHistogram::bucketOf( value );
+        CPPUNIT_ASSERT_EQUAL( value, LatencyHistogram::lowestValueIn( bucket ) );
+        CPPUNIT_ASSERT_EQUAL( value, LatencyHistogram::highestValueIn( bucket ) );
+    }
+
+    CPPUNIT_ASSERT_EQUAL( 0, LatencyHistogram::bucketOf( -5 ) );
+
+    // Buckets are contiguous and every value falls within the bounds of its bucket.
+    for( int bucket = 1; bucket < LatencyHistogram::BUCKET_COUNT; ++bucket ) {
+        CPPUNIT_ASSERT_EQUAL( LatencyHistogram::highestValueIn( bucket - 1 ) + 1,
+                              LatencyHistogram::lowestValueIn( bucket ) );
+        CPPUNIT_ASSERT_EQUAL( bucket, LatencyHistogram::bucketOf( LatencyHistogram::lowestValueIn( bucket ) ) );
+        CPPUNIT_ASSERT_EQUAL( bucket, LatencyHistogram::bucketOf( LatencyHistogram::highestValueIn( bucket ) ) );
+    }
+
+    // A bucket never spans more than about three percent of its values.
+    long long values[] = { 100LL, 1000LL, 12345LL, 999999LL, 50000000LL, 30000000000LL };
+    for( int i = 0; i < 6; ++i ) {
+        int bucket = LatencyHistogram::bucketOf( values[i] );
+        long long width = LatencyHistogram::highestValueIn( bucket ) - LatencyHistogram::lowestValueIn( bucket ) + 1;
+        CPPUNIT_ASSERT( width * 32 <= LatencyHistogram::lowestValueIn( bucket ) + 1 );
+    }
+
+    // Very large values are counted in the last bucket.
+    CPPUNIT_ASSERT_EQUAL( LatencyHistogram::BUCKET_COUNT - 1, LatencyHistogram::bucketOf( 1LL << 40 ) );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void LatencyHistogramTest::testPercentiles() {
+
+    LatencyHistogram histogram;
+
+    for( long long value = 1; value <= 1000; ++value ) {
+        histogram.record( value * 1000 );
+    }
+
+    CPPUNIT_ASSERT_EQUAL( 1000LL, histogram.getCount() );
+    CPPUNIT_ASSERT( histogram.getMinValue() <= 1000 && histogram.getMinValue() >= 970 );
+    CPPUNIT_ASSERT( histogram.getMaxValue() >= 1000000 && histogram.getMaxValue() <= 1030000 );
+    CPPUNIT_ASSERT_DOUBLES_EQUAL( 500500.0, histogram.getMean(), 500500.0 * 0.03 );
+
+    long long median = histogram.getValueAtPercentile( 50.0 );
+    CPPUNIT_ASSERT( median >= 500000 && median <= 500000 * 1.03 );
+
+    long long p99 = histogram.getValueAtPercentile( 99.0 );
+    CPPUNIT_ASSERT( p99 >= 990000 && p99 <= 990000 * 1.03 );
+
+    CPPUNIT_ASSERT_EQUAL( histogram.getMaxValue(), histogram.getValueAtPercentile( 100.0 ) );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void LatencyHistogramTest::testReset() {
+
+    LatencyHistogram histogram;
+
+    histogram.record( 10 );
+    histogram.record( 20000 );
+    CPPUNIT_ASSERT_EQUAL( 2LL, histogram.getCount() );
+
+    histogram.reset();
+    CPPUNIT_ASSERT_EQUAL( 0LL, histogram.getCount() );
+    CPPUNIT_ASSERT_EQUAL( 0LL, histogram.getMaxValue() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void LatencyHistogramTest::testStatisticsParent() {
+
+    Pointer<LatencyStatistics> connection( new LatencyStatistics() );
+    Pointer<LatencyStatistics> session( new LatencyStatistics( connection ) );
+    LatencyStatistics consumer( session );
+
+    consumer.record( LatencyStatistics::LISTENER_TIME, 5000 );
+    session->record( LatencyStatistics::ACK_ROUND_TRIP, 7000 );
+
+    CPPUNIT_ASSERT_EQUAL( 1LL, consumer.getHistogram( LatencyStatistics::LISTENER_TIME ).getCount() );
+    CPPUNIT_ASSERT_EQUAL( 0LL, consumer.getHistogram( LatencyStatistics::ACK_ROUND_TRIP ).getCount() );
+    CPPUNIT_ASSERT_EQUAL( 1LL, session->getHistogram( LatencyStatistics::LISTENER_TIME ).getCount() );
+    CPPUNIT_ASSERT_EQUAL( 1LL, session->getHistogram( LatencyStatistics::ACK_ROUND_TRIP ).getCount() );
+    CPPUNIT_ASSERT_EQUAL( 1LL, connection->getHistogram( LatencyStatistics::LISTENER_TIME ).getCount() );
+    CPPUNIT_ASSERT_EQUAL( 1LL, connection->getHistogram( LatencyStatistics::ACK_ROUND_TRIP ).getCount() );
+
+    session->reset();
+    CPPUNIT_ASSERT_EQUAL( 0LL, session->getHistogram( LatencyStatistics::LISTENER_TIME ).getCount() );
+    CPPUNIT_ASSERT_EQUAL( 1LL, connection->getHistogram( LatencyStatistics::LISTENER_TIME ).getCount() );
+
+    CPPUNIT_ASSERT( connection->toString().find( "listenerTime={count=1" ) != std::string::npos );
+    CPPUNIT_ASSERT_EQUAL( std::string( "dispatchResidenceTime" ),
+                          LatencyStatistics::getMetricName( LatencyStatistics::DISPATCH_RESIDENCE_TIME ) );
+}
@@ -0,0 +1,187 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MessageArenaTest.h"
+
+#include <activemq/util/MessageArena.h>
+
+#include <decaf/lang/Thread.h>
+#include <decaf/lang/exceptions/IllegalStateException.h>
+
+#include <cstring>
+
+using namespace activemq;
+using namespace activemq::util;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    class ArenaThread : public Thread {
+    public:
+
+        MessageArena* outside;
+        MessageArena* inside;
+
+    public:
+
+        ArenaThread() : Thread(), outside(NULL), inside(NULL) {}
+        virtual ~ArenaThread() {}
+
+        virtual void run() {
+            outside = MessageArena::current();
+            MessageArena::Scope scope;
+            inside = MessageArena::current();
+            inside->allocate( 100 );
+        }
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageArenaTest::testNoScope() {
+
+    CPPUNIT_ASSERT( MessageArena::current() == NULL );
+
+    MessageArena arena;
+    CPPUNIT_ASSERT( !arena.isActive() );
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IllegalStateException",
+        arena.allocate( 10 ),
+        IllegalStateException );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageArenaTest::testDisabledScope() {
+
+    MessageArena::Scope scope( false );
+    CPPUNIT_ASSERT( scope.getArena() == NULL );
+    CPPUNIT_ASSERT( MessageArena::current() == NULL );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageArenaTest::testAllocate() {
+
+    MessageArena::Scope scope;
+    MessageArena* arena = scope.getArena();
+
+    CPPUNIT_ASSERT( arena != NULL );
+    CPPUNIT_ASSERT( arena == MessageArena::current() );
+    CPPUNIT_ASSERT( arena->isActive() );
+
+    unsigned char* first = static_cast<unsigned char*>( arena->allocate( 10 ) );
+    unsigned char* second = static_cast<unsigned char*>( arena->allocate( 100 ) );
+    unsigned char* third = static_cast<unsigned char*>( arena->allocate( 0 ) );
+
+    CPPUNIT_ASSERT_EQUAL( (std::size_t) 0, (std::size_t) first % MessageArena::ALIGNMENT );
+    CPPUNIT_ASSERT( second == first + MessageArena::ALIGNMENT );
+    CPPUNIT_ASSERT( third == second + 112 );
+    CPPUNIT_ASSERT_EQUAL( (std::size_t) 144, arena->getBytesInUse() );
+
+    std::memset( first, 0xAA, 10 );
+    std::memset( second, 0xBB, 100 );
+    CPPUNIT_ASSERT_EQUAL( (unsigned char) 0xAA, first[9] );
+    CPPUNIT_ASSERT_EQUAL( (unsigned char) 0xBB, second[0] );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageArenaTest::testReuseAfterScope() {
+
+    void* first = NULL;
+    long long allocations = 0;
+    MessageArena* arena = NULL;
+
+    {
+        MessageArena::Scope scope;
+        arena = scope.getArena();
+        allocations = arena->getAllocationCount();
+        first = arena->allocate( 1000 );
+    }
+
+    CPPUNIT_ASSERT( MessageArena::current() == NULL );
+    CPPUNIT_ASSERT( !arena->isActive() );
+    CPPUNIT_ASSERT_EQUAL( (std::size_t) 1, arena->getBlockCount() );
+
+    {
+        MessageArena::Scope scope;
+        CPPUNIT_ASSERT( arena == scope.getArena() );
+        CPPUNIT_ASSERT( first == arena->allocate( 1000 ) );
+        CPPUNIT_ASSERT_EQUAL( allocations + 2, arena->getAllocationCount() );
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageArenaTest::testNestedScopes() {
+
+    MessageArena::Scope outer;
+    MessageArena* arena = outer.getArena();
+
+    arena->allocate( 64 );
+    void* inner = NULL;
+
+    {
+        MessageArena::Scope scope;
+        CPPUNIT_ASSERT( arena == scope.getArena() );
+        inner = arena->allocate( 256 );
+        CPPUNIT_ASSERT_EQUAL( (std::size_t) 320, arena->getBytesInUse() );
+    }
+
+    // The inner scope only gave back its own memory.
+    CPPUNIT_ASSERT( arena->isActive() );
+    CPPUNIT_ASSERT_EQUAL( (std::size_t) 64, arena->getBytesInUse() );
+    CPPUNIT_ASSERT( inner == arena->allocate( 16 ) );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageArenaTest::testLargeAllocation() {
+
+    MessageArena* arena = NULL;
+
+    {
+        MessageArena::Scope scope;
+        arena = scope.getArena();
+
+        arena->allocate( 100 );
+        unsigned char* large = static_cast<unsigned char*>( arena->allocate( MessageArena::BLOCK_SIZE * 2 ) );
+        std::memset( large, 0, MessageArena::BLOCK_SIZE * 2 );
+
+        // Following allocations carry on past the oversized block.
+        for( int i = 0; i < 5; ++i ) {
+            arena->allocate( MessageArena::BLOCK_SIZE / 2 );
+        }
+
+        CPPUNIT_ASSERT( arena->getBlockCount() > 4 );
+    }
+
+    // The oversized block and the extra standard blocks are released.
+    CPPUNIT_ASSERT( arena->getBlockCount() <= 4 );
+    CPPUNIT_ASSERT_EQUAL( (std::size_t) 0, arena->getBytesInUse() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageArenaTest::testArenaPerThread() {
+
+    MessageArena::Scope scope;
+
+    ArenaThread thread;
+    thread.start();
+    thread.join();
+
+    CPPUNIT_ASSERT( thread.outside == NULL );
+    CPPUNIT_ASSERT( thread.inside != NULL );
+    CPPUNIT_ASSERT( thread.inside != scope.getArena() );
+}
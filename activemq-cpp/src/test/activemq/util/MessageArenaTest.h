@@ -0,0 +1,56 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_UTIL_MESSAGEARENATEST_H_
+#define _ACTIVEMQ_UTIL_MESSAGEARENATEST_H_
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace activemq {
+namespace util {
+
+    class MessageArenaTest : public CppUnit::TestFixture {
+
+        CPPUNIT_TEST_SUITE( MessageArenaTest );
+        CPPUNIT_TEST( testNoScope );
+        CPPUNIT_TEST( testDisabledScope );
+        CPPUNIT_TEST( testAllocate );
+        CPPUNIT_TEST( testReuseAfterScope );
+        CPPUNIT_TEST( testNestedScopes );
+        CPPUNIT_TEST( testLargeAllocation );
+        CPPUNIT_TEST( testArenaPerThread );
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+
+        MessageArenaTest() {}
+        virtual ~MessageArenaTest() {}
+
+        void testNoScope();
+        void testDisabledScope();
+        void testAllocate();
+        void testReuseAfterScope();
+        void testNestedScopes();
+        void testLargeAllocation();
+        void testArenaPerThread();
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_UTIL_MESSAGEARENATEST_H_ */
@@ -0,0 +1,246 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ProducerWindowTest.h"
+
+#include <activemq/util/ProducerWindow.h>
+
+#include <decaf/lang/Runnable.h>
+#include <decaf/lang/System.h>
+#include <decaf/lang/Thread.h>
+
+using namespace activemq;
+using namespace activemq::util;
+using namespace decaf::lang;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    class AckRunner : public decaf::lang::Runnable {
+    private:
+
+        AckRunner(const AckRunner&);
+        AckRunner& operator= (const AckRunner&);
+
+    private:
+
+        ProducerWindow* window;
+        unsigned long long size;
+
+    public:
+
+        AckRunner(ProducerWindow* window, unsigned long long size) : window(window), size(size) {}
+
+        virtual void run() {
+            Thread::sleep(50);
+            this->window->decreaseUsage(this->size);
+        }
+    };
+
+    class CloseRunner : public decaf::lang::Runnable {
+    private:
+
+        CloseRunner(const CloseRunner&);
+        CloseRunner& operator= (const CloseRunner&);
+
+    private:
+
+        ProducerWindow* window;
+        bool reset;
+
+    public:
+
+        CloseRunner(ProducerWindow* window, bool reset) : window(window), reset(reset) {}
+
+        virtual void run() {
+            Thread::sleep(50);
+            if (this->reset) {
+                this->window->reset();
+            } else {
+                this->window->close();
+            }
+        }
+    };
+
+    // Sends and acks enough to give the window a drain rate of at most 50000 bytes
+    // per second, leaving it exactly half full.
+    void primeDrainRate(ProducerWindow& window) {
+        window.increaseUsage(6000);
+        Thread::sleep(20);
+        window.decreaseUsage(1000);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ProducerWindowTest::testUtilization() {
+
+    ProducerWindow window(1000, false);
+
+    CPPUNIT_ASSERT(!window.isAdaptivePacing());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, window.getUtilization(), 0.001);
+
+    window.increaseUsage(600);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.6, window.getUtilization(), 0.001);
+    window.increaseUsage(300);
+    window.decreaseUsage(700);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.2, window.getUtilization(), 0.001);
+
+    CPPUNIT_ASSERT_EQUAL(900ULL, window.getPeakUsage());
+    CPPUNIT_ASSERT_EQUAL(1LL, window.getAckCount());
+    CPPUNIT_ASSERT_EQUAL(700ULL, window.getAckedBytes());
+
+    // An ack larger than the usage empties the window.
+    window.decreaseUsage(5000);
+    CPPUNIT_ASSERT_EQUAL(0ULL, window.getUsage());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ProducerWindowTest::testBlockedTime() {
+
+    ProducerWindow window(1000, false);
+
+    window.increaseUsage(500);
+    window.waitForSpace();
+    CPPUNIT_ASSERT_EQUAL(0LL, window.getBlockedCount());
+
+    window.increaseUsage(500);
+    CPPUNIT_ASSERT(window.isFull());
+
+    AckRunner runner(&window, 500);
+    Thread thread(&runner);
+    thread.start();
+
+    window.waitForSpace();
+    thread.join();
+
+    CPPUNIT_ASSERT(!window.isFull());
+    CPPUNIT_ASSERT_EQUAL(1LL, window.getBlockedCount());
+    CPPUNIT_ASSERT(window.getBlockedTime() >= 40000);
+    CPPUNIT_ASSERT_EQUAL(0LL, window.getPacedCount());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ProducerWindowTest::testDrainRate() {
+
+    ProducerWindow window(10000, false);
+
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, window.getDrainRate(), 0.001);
+
+    // Acks arriving closer together than a sample are folded into the next one.
+    window.increaseUsage(4000);
+    window.decreaseUsage(1000);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, window.getDrainRate(), 0.001);
+
+    Thread::sleep(20);
+    window.decreaseUsage(1000);
+
+    double rate = window.getDrainRate();
+    CPPUNIT_ASSERT(rate > 0);
+    CPPUNIT_ASSERT(rate <= 100000);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ProducerWindowTest::testPacing() {
+
+    {
+        ProducerWindow window(10000, true);
+        primeDrainRate(window);
+        CPPUNIT_ASSERT(window.getDrainRate() > 0);
+
+        // Below half the window sends are not held back.
+        window.waitForSpace();
+        CPPUNIT_ASSERT_EQUAL(0LL, window.getPacedCount());
+
+        // Past half, 1000 bytes at no more than 50000 bytes per second is 20ms.
+        long long start = System::currentTimeMillis();
+        window.increaseUsage(1000);
+        window.waitForSpace();
+        long long elapsed = System::currentTimeMillis() - start;
+
+        CPPUNIT_ASSERT_EQUAL(1LL, window.getPacedCount());
+        CPPUNIT_ASSERT(window.getPacedTime() >= 15000);
+        CPPUNIT_ASSERT(elapsed >= 15);
+        CPPUNIT_ASSERT(elapsed < ProducerWindow::MAXIMUM_PACING_DELAY + 500);
+        CPPUNIT_ASSERT_EQUAL(0LL, window.getBlockedCount());
+    }
+    {
+        ProducerWindow window(10000, false);
+        primeDrainRate(window);
+
+        window.increaseUsage(1000);
+        window.waitForSpace();
+        CPPUNIT_ASSERT_EQUAL(0LL, window.getPacedCount());
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ProducerWindowTest::testPacingReleased() {
+
+    ProducerWindow window(10000, true);
+    primeDrainRate(window);
+
+    window.increaseUsage(4000);
+
+    // Draining back below half the window lifts the pacing at once.
+    window.decreaseUsage(6000);
+
+    long long start = System::currentTimeMillis();
+    window.waitForSpace();
+    CPPUNIT_ASSERT(System::currentTimeMillis() - start < 15);
+    CPPUNIT_ASSERT_EQUAL(0LL, window.getPacedCount());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ProducerWindowTest::testClose() {
+
+    ProducerWindow window(1000, false);
+    window.increaseUsage(1000);
+    CPPUNIT_ASSERT(!window.isClosed());
+
+    // A sender blocked on a window that will never be acked is released by a close.
+    CloseRunner runner(&window, false);
+    Thread thread(&runner);
+    thread.start();
+
+    window.waitForSpace();
+    thread.join();
+
+    CPPUNIT_ASSERT(window.isClosed());
+    CPPUNIT_ASSERT(window.isFull());
+
+    // Once closed the window never blocks.
+    window.waitForSpace();
+    window.waitForSpace(5000);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ProducerWindowTest::testReset() {
+
+    ProducerWindow window(1000, false);
+    window.increaseUsage(1000);
+
+    CloseRunner runner(&window, true);
+    Thread thread(&runner);
+    thread.start();
+
+    window.waitForSpace();
+    thread.join();
+
+    CPPUNIT_ASSERT(!window.isClosed());
+    CPPUNIT_ASSERT_EQUAL(0ULL, window.getUsage());
+    CPPUNIT_ASSERT_EQUAL(1LL, window.getBlockedCount());
+}
@@ -0,0 +1,56 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_UTIL_PRODUCERWINDOWTEST_H_
+#define _ACTIVEMQ_UTIL_PRODUCERWINDOWTEST_H_
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace activemq {
+namespace util {
+
+    class ProducerWindowTest : public CppUnit::TestFixture {
+
+        CPPUNIT_TEST_SUITE( ProducerWindowTest );
+        CPPUNIT_TEST( testUtilization );
+        CPPUNIT_TEST( testBlockedTime );
+        CPPUNIT_TEST( testDrainRate );
+        CPPUNIT_TEST( testPacing );
+        CPPUNIT_TEST( testPacingReleased );
+        CPPUNIT_TEST( testClose );
+        CPPUNIT_TEST( testReset );
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+
+        ProducerWindowTest() {}
+        virtual ~ProducerWindowTest() {}
+
+        void testUtilization();
+        void testBlockedTime();
+        void testDrainRate();
+        void testPacing();
+        void testPacingReleased();
+        void testClose();
+        void testReset();
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_UTIL_PRODUCERWINDOWTEST_H_ */
@@ -19,10 +19,21 @@
 
 #include <decaf/util/Properties.h>
 #include <activemq/wireformat/openwire/OpenWireFormat.h>
+#include <activemq/wireformat/openwire/OpenWireFormatFactory.h>
+#include <activemq/wireformat/openwire/OpenWireResponseBuilder.h>
+#include <activemq/commands/ActiveMQTextMessage.h>
+#include <activemq/transport/mock/MockTransport.h>
+#include <decaf/io/ByteArrayInputStream.h>
+#include <decaf/io/ByteArrayOutputStream.h>
+#include <decaf/io/DataInputStream.h>
+#include <decaf/io/DataOutputStream.h>
+#include <decaf/io/IOException.h>
 
 using namespace std;
 using namespace activemq;
 using namespace activemq::util;
+using namespace activemq::commands;
+using namespace activemq::transport::mock;
 using namespace decaf::io;
 using namespace decaf::lang;
 using namespace decaf::util;
@@ -36,3 +47,105 @@ void OpenWireFormatTest::test()
     Properties properties;
     //OpenWireFormat myWireFormat( properties );
 }
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireFormatTest::testMaxFrameSize() {
+
+    Properties properties;
+    properties.setProperty("wireFormat.maxFrameSize", "1024");
+
+    Pointer<WireFormat> wireFormat = OpenWireFormatFactory().createWireFormat(properties);
+    OpenWireFormat* openWire = dynamic_cast<OpenWireFormat*>(wireFormat.get());
+    CPPUNIT_ASSERT(openWire != NULL);
+    CPPUNIT_ASSERT_EQUAL(1024LL, openWire->getMaxFrameSize());
+
+    // Only the size prefix is sent, the frame is refused before its body is read.
+    ByteArrayOutputStream bytesOut;
+    DataOutputStream dataOut(&bytesOut);
+    dataOut.writeInt(0x7FFFFFFF);
+
+    std::pair<unsigned char*, int> frame = bytesOut.toByteArray();
+    ByteArrayInputStream bytesIn(frame.first, frame.second, true);
+    DataInputStream dataIn(&bytesIn);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IOException for a frame over the max size",
+        openWire->unmarshal(NULL, &dataIn),
+        IOException);
+
+    CPPUNIT_ASSERT_EQUAL(OpenWireFormat::DEFAULT_MAX_FRAME_SIZE,
+                         OpenWireFormat(Properties()).getMaxFrameSize());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireFormatTest::testTightFrameRoundTrip() {
+
+    Properties properties;
+    properties.setProperty("wireFormat.tightEncodingEnabled", "true");
+
+    Pointer<WireFormat> wireFormat = OpenWireFormatFactory().createWireFormat(properties);
+    MockTransport transport(wireFormat, Pointer<OpenWireResponseBuilder>(new OpenWireResponseBuilder()));
+
+    // A frame small enough to be built in memory and one large enough to be streamed.
+    const int sizes[] = { 16, 256 * 1024 };
+
+    for (int i = 0; i < 2; ++i) {
+
+        Pointer<ActiveMQTextMessage> message(new ActiveMQTextMessage());
+        message->setText(std::string(sizes[i], 'a' + i));
+
+        ByteArrayOutputStream bytesOut;
+        DataOutputStream dataOut(&bytesOut);
+        wireFormat->marshal(message, &transport, &dataOut);
+        dataOut.flush();
+
+        std::pair<unsigned char*, int> frame = bytesOut.toByteArray();
+        ByteArrayInputStream bytesIn(frame.first, frame.second, true);
+        DataInputStream dataIn(&bytesIn);
+
+        Pointer<ActiveMQTextMessage> received =
+            wireFormat->unmarshal(&transport, &dataIn).dynamicCast<ActiveMQTextMessage>();
+
+        CPPUNIT_ASSERT(received != NULL);
+        CPPUNIT_ASSERT_EQUAL(message->getText(), received->getText());
+        CPPUNIT_ASSERT_EQUAL(0, (int) bytesIn.available());
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireFormatTest::testLooseFrameInArena() {
+
+    Properties properties;
+    properties.setProperty("wireFormat.tightEncodingEnabled", "false");
+    properties.setProperty("wireFormat.messageArenaEnabled", "true");
+
+    Pointer<WireFormat> wireFormat = OpenWireFormatFactory().createWireFormat(properties);
+    MockTransport transport(wireFormat, Pointer<OpenWireResponseBuilder>(new OpenWireResponseBuilder()));
+
+    // A frame that fits the arena's frame buffer and one that falls back to the heap.
+    const int sizes[] = { 16, 256 * 1024 };
+
+    for (int i = 0; i < 2; ++i) {
+
+        Pointer<ActiveMQTextMessage> message(new ActiveMQTextMessage());
+        message->setText(std::string(sizes[i], 'a' + i));
+        message->setIntProperty("index", i);
+
+        ByteArrayOutputStream bytesOut;
+        DataOutputStream dataOut(&bytesOut);
+        wireFormat->marshal(message, &transport, &dataOut);
+        dataOut.flush();
+
+        std::pair<unsigned char*, int> frame = bytesOut.toByteArray();
+        ByteArrayInputStream bytesIn(frame.first, frame.second, true);
+        DataInputStream dataIn(&bytesIn);
+
+        Pointer<ActiveMQTextMessage> received =
+            wireFormat->unmarshal(&transport, &dataIn).dynamicCast<ActiveMQTextMessage>();
+
+        CPPUNIT_ASSERT(received != NULL);
+        CPPUNIT_ASSERT_EQUAL(message->getText(), received->getText());
+        CPPUNIT_ASSERT_EQUAL(i, received->getIntProperty("index"));
+        CPPUNIT_ASSERT_EQUAL(0, (int) bytesIn.available());
+    }
+}
@@ -29,6 +29,9 @@ namespace openwire {
 
         CPPUNIT_TEST_SUITE( OpenWireFormatTest );
         CPPUNIT_TEST( test );
+        CPPUNIT_TEST( testMaxFrameSize );
+        CPPUNIT_TEST( testTightFrameRoundTrip );
+        CPPUNIT_TEST( testLooseFrameInArena );
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -37,6 +40,9 @@ namespace openwire {
         virtual ~OpenWireFormatTest() {}
 
         virtual void test();
+        virtual void testMaxFrameSize();
+        virtual void testTightFrameRoundTrip();
+        virtual void testLooseFrameInArena();
 
     };
 
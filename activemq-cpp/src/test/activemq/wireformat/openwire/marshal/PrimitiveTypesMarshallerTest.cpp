@@ -19,6 +19,7 @@
 
 #include <activemq/util/PrimitiveMap.h>
 #include <activemq/util/PrimitiveList.h>
+#include <activemq/util/MessageArena.h>
 #include <activemq/wireformat/openwire/marshal/PrimitiveTypesMarshaller.h>
 
 using namespace std;
@@ -158,3 +159,43 @@ void PrimitiveTypesMarshallerTest::testMaps() {
     CPPUNIT_ASSERT( newMap.get() != NULL );
     CPPUNIT_ASSERT( newMap->size() == 3 );
 }
+
+////////////////////////////////////////////////////////////////////////////////
+void PrimitiveTypesMarshallerTest::testMapInMessageArena() {
+
+    PrimitiveMap myMap;
+    myMap.setString( "stringKey", "The test string" );
+    myMap.setInt( "intKey", 655369 );
+    myMap.setByteArray( "bytesKey", std::vector<unsigned char>( 100, 42 ) );
+
+    std::vector<unsigned char> expected;
+    PrimitiveTypesMarshaller::marshal( &myMap, expected );
+
+    std::vector<unsigned char> marshaled;
+    {
+        MessageArena::Scope scope;
+        long long allocations = scope.getArena()->getAllocationCount();
+        PrimitiveTypesMarshaller::marshal( &myMap, marshaled );
+        CPPUNIT_ASSERT( scope.getArena()->getAllocationCount() > allocations );
+    }
+
+    CPPUNIT_ASSERT( marshaled == expected );
+
+    // A map larger than the arena scratch space is encoded on the heap.
+    myMap.setByteArray( "largeKey", std::vector<unsigned char>( 64 * 1024, 7 ) );
+    expected.clear();
+    PrimitiveTypesMarshaller::marshal( &myMap, expected );
+
+    {
+        MessageArena::Scope scope;
+        marshaled.clear();
+        PrimitiveTypesMarshaller::marshal( &myMap, marshaled );
+    }
+
+    CPPUNIT_ASSERT( marshaled == expected );
+
+    this->unmarshaledMap = new PrimitiveMap();
+    PrimitiveTypesMarshaller::unmarshal( this->unmarshaledMap, marshaled );
+    CPPUNIT_ASSERT_EQUAL( 655369, this->unmarshaledMap->getInt( "intKey" ) );
+    CPPUNIT_ASSERT_EQUAL( (std::size_t) 64 * 1024, this->unmarshaledMap->getByteArray( "largeKey" ).size() );
+}
@@ -33,6 +33,7 @@ namespace marshal{
         CPPUNIT_TEST( test );
         CPPUNIT_TEST( testLists );
         CPPUNIT_TEST( testMaps );
+        CPPUNIT_TEST( testMapInMessageArena );
         CPPUNIT_TEST_SUITE_END();
 
     private:
@@ -61,6 +62,7 @@ namespace marshal{
         void test();
         void testLists();
         void testMaps();
+        void testMapInMessageArena();
 
     };
 
@@ -18,10 +18,14 @@
 #include "BooleanStreamTest.h"
 
 #include <activemq/wireformat/openwire/utils/BooleanStream.h>
+#include <activemq/util/MessageArena.h>
 #include <decaf/io/ByteArrayOutputStream.h>
 #include <decaf/io/ByteArrayInputStream.h>
 #include <decaf/io/DataOutputStream.h>
 #include <decaf/io/DataInputStream.h>
+#include <decaf/io/IOException.h>
+
+#include <vector>
 
 using namespace decaf;
 using namespace decaf::io;
@@ -99,3 +103,99 @@ void BooleanStreamTest::test2(){
 
     delete [] array.first;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+void BooleanStreamTest::testSizeBoundaries() {
+
+    // Byte counts either side of the size field changes and of the inline buffer.
+    const int sizes[] = { 0, 1, 63, 64, BooleanStream::INLINE_SIZE + 1, 255, 256, 1000 };
+
+    for( std::size_t i = 0; i < sizeof( sizes ) / sizeof( int ); ++i ) {
+
+        int bits = sizes[i] * 8;
+        int headerSize = sizes[i] < 64 ? 1 : ( sizes[i] < 256 ? 2 : 3 );
+
+        BooleanStream b1Stream;
+        for( int bit = 0; bit < bits; ++bit ) {
+            b1Stream.writeBoolean( bit % 3 == 0 );
+        }
+
+        CPPUNIT_ASSERT_EQUAL( headerSize + sizes[i], b1Stream.marshalledSize() );
+
+        std::vector<unsigned char> buffer;
+        b1Stream.marshal( buffer );
+        CPPUNIT_ASSERT_EQUAL( (std::size_t) b1Stream.marshalledSize(), buffer.size() );
+
+        io::ByteArrayOutputStream baoStream;
+        io::DataOutputStream daoStream( &baoStream );
+        b1Stream.marshal( &daoStream );
+        CPPUNIT_ASSERT_EQUAL( (long long) buffer.size(), baoStream.size() );
+
+        // Bits can be read back once the stream has been marshaled.
+        for( int bit = 0; bit < bits; ++bit ) {
+            CPPUNIT_ASSERT( b1Stream.readBoolean() == ( bit % 3 == 0 ) );
+        }
+
+        BooleanStream b2Stream;
+        decaf::io::ByteArrayInputStream baiStream( buffer );
+        io::DataInputStream daiStream( &baiStream );
+        b2Stream.unmarshal( &daiStream );
+
+        CPPUNIT_ASSERT_EQUAL( 0, baiStream.available() );
+        CPPUNIT_ASSERT_EQUAL( b1Stream.marshalledSize(), b2Stream.marshalledSize() );
+        for( int bit = 0; bit < bits; ++bit ) {
+            CPPUNIT_ASSERT( b2Stream.readBoolean() == ( bit % 3 == 0 ) );
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void BooleanStreamTest::testReadPastEnd() {
+
+    BooleanStream b1Stream;
+    b1Stream.writeBoolean( true );
+    b1Stream.clear();
+
+    // The rest of the byte holding the last boolean reads as false.
+    CPPUNIT_ASSERT( b1Stream.readBoolean() );
+    for( int i = 1; i < 8; ++i ) {
+        CPPUNIT_ASSERT( !b1Stream.readBoolean() );
+    }
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IOException",
+        b1Stream.readBoolean(),
+        decaf::io::IOException );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void BooleanStreamTest::testArenaBuffer() {
+
+    activemq::util::MessageArena::Scope scope;
+    CPPUNIT_ASSERT( scope.getArena() != NULL );
+
+    long long allocations = scope.getArena()->getAllocationCount();
+
+    // Enough booleans to outgrow the inline buffer more than once.
+    const int bits = BooleanStream::INLINE_SIZE * 8 * 5;
+
+    BooleanStream b1Stream;
+    for( int bit = 0; bit < bits; ++bit ) {
+        b1Stream.writeBoolean( bit % 5 == 0 );
+    }
+
+    CPPUNIT_ASSERT( scope.getArena()->getAllocationCount() > allocations );
+
+    std::vector<unsigned char> buffer;
+    b1Stream.marshal( buffer );
+
+    BooleanStream b2Stream;
+    decaf::io::ByteArrayInputStream baiStream( buffer );
+    io::DataInputStream daiStream( &baiStream );
+    b2Stream.unmarshal( &daiStream );
+
+    CPPUNIT_ASSERT_EQUAL( 0, baiStream.available() );
+    for( int bit = 0; bit < bits; ++bit ) {
+        CPPUNIT_ASSERT( b2Stream.readBoolean() == ( bit % 5 == 0 ) );
+    }
+}
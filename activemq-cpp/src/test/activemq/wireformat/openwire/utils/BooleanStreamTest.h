@@ -31,6 +31,9 @@ namespace utils{
         CPPUNIT_TEST_SUITE( BooleanStreamTest );
         CPPUNIT_TEST( test );
         CPPUNIT_TEST( test2 );
+        CPPUNIT_TEST( testSizeBoundaries );
+        CPPUNIT_TEST( testReadPastEnd );
+        CPPUNIT_TEST( testArenaBuffer );
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -40,6 +43,9 @@ namespace utils{
 
         void test();
         void test2();
+        void testSizeBoundaries();
+        void testReadPastEnd();
+        void testArenaBuffer();
     };
 
 }}}}
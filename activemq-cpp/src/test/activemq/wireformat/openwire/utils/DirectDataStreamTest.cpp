@@ -0,0 +1,142 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DirectDataStreamTest.h"
+
+#include <activemq/wireformat/openwire/utils/DirectDataInputStream.h>
+#include <activemq/wireformat/openwire/utils/DirectDataOutputStream.h>
+
+#include <decaf/io/ByteArrayOutputStream.h>
+#include <decaf/io/DataOutputStream.h>
+#include <decaf/io/EOFException.h>
+#include <decaf/io/IOException.h>
+
+#include <vector>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::wireformat;
+using namespace activemq::wireformat::openwire;
+using namespace activemq::wireformat::openwire::utils;
+using namespace decaf::io;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    void writeSample(DataOutputStream& out) {
+        out.writeBoolean(true);
+        out.writeByte(0xFE);
+        out.writeShort(-2);
+        out.writeUnsignedShort(0xBEEF);
+        out.writeInt(0x80000001);
+        out.writeLong(0x0123456789ABCDEFLL);
+        out.writeLong(-1LL);
+        out.writeDouble(3.25);
+        out.writeFloat(-0.5f);
+        out.writeUTF("direct");
+        out.write((const unsigned char*) "xyz", 3, 1, 2);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DirectDataStreamTest::testMatchesDataOutputStream() {
+
+    ByteArrayOutputStream bytes;
+    DataOutputStream reference(&bytes);
+    writeSample(reference);
+    std::pair<unsigned char*, int> expected = bytes.toByteArray();
+
+    std::vector<unsigned char> frame(expected.second);
+    DirectDataOutputStream direct(&frame[0], (int) frame.size());
+    writeSample(direct);
+
+    CPPUNIT_ASSERT_EQUAL(expected.second, direct.getPosition());
+    CPPUNIT_ASSERT_EQUAL((long long) expected.second, direct.size());
+    for (int i = 0; i < expected.second; ++i) {
+        CPPUNIT_ASSERT_EQUAL((int) expected.first[i], (int) frame[i]);
+    }
+
+    delete [] expected.first;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DirectDataStreamTest::testRoundTrip() {
+
+    std::vector<unsigned char> frame(64);
+    DirectDataOutputStream out(&frame[0], (int) frame.size());
+    writeSample(out);
+    int length = out.getPosition();
+
+    DirectDataInputStream in(&frame[0], length);
+    CPPUNIT_ASSERT_EQUAL(length, in.available());
+    CPPUNIT_ASSERT(in.readBoolean());
+    CPPUNIT_ASSERT_EQUAL(0xFE, (int) in.readUnsignedByte());
+    CPPUNIT_ASSERT_EQUAL((short) -2, in.readShort());
+    CPPUNIT_ASSERT_EQUAL((unsigned short) 0xBEEF, in.readUnsignedShort());
+    CPPUNIT_ASSERT_EQUAL((int) 0x80000001, in.readInt());
+    CPPUNIT_ASSERT_EQUAL(0x0123456789ABCDEFLL, in.readLong());
+    CPPUNIT_ASSERT_EQUAL(-1LL, in.readLong());
+    CPPUNIT_ASSERT_EQUAL(3.25, in.readDouble());
+    CPPUNIT_ASSERT_EQUAL(-0.5f, in.readFloat());
+    CPPUNIT_ASSERT_EQUAL(std::string("direct"), in.readUTF());
+
+    unsigned char tail[2];
+    in.readFully(tail, 2);
+    CPPUNIT_ASSERT_EQUAL((int) 'y', (int) tail[0]);
+    CPPUNIT_ASSERT_EQUAL((int) 'z', (int) tail[1]);
+    CPPUNIT_ASSERT_EQUAL(0, in.available());
+    CPPUNIT_ASSERT_EQUAL(-1, in.read());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DirectDataStreamTest::testOverflow() {
+
+    unsigned char frame[6];
+    DirectDataOutputStream out(frame, 6);
+    out.writeInt(1);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IOException",
+        out.writeInt(2),
+        IOException);
+
+    CPPUNIT_ASSERT_EQUAL(4, out.getPosition());
+    out.writeShort(3);
+    CPPUNIT_ASSERT_EQUAL(6, out.getPosition());
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IOException",
+        out.write((const unsigned char*) "a", 1),
+        IOException);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DirectDataStreamTest::testUnderflow() {
+
+    unsigned char frame[] = { 0, 0, 0, 5, 1, 2 };
+    DirectDataInputStream in(frame, 6);
+    CPPUNIT_ASSERT_EQUAL(5, in.readInt());
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an EOFException",
+        in.readInt(),
+        EOFException);
+
+    CPPUNIT_ASSERT_EQUAL(2, in.available());
+    CPPUNIT_ASSERT_EQUAL(1LL, in.skipBytes(1));
+    CPPUNIT_ASSERT_EQUAL(2, (int) in.readByte());
+}
@@ -0,0 +1,58 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _DECAF_INTERNAL_NET_SSL_OPENSSL_OPENSSLCONTEXTSPITEST_H_
+#define _DECAF_INTERNAL_NET_SSL_OPENSSL_OPENSSLCONTEXTSPITEST_H_
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+
+namespace decaf {
+namespace internal {
+namespace net {
+namespace ssl {
+namespace openssl {
+
+    class OpenSSLContextSpiTest : public CppUnit::TestFixture {
+
+        CPPUNIT_TEST_SUITE( OpenSSLContextSpiTest );
+        CPPUNIT_TEST( testSessionResumption );
+        CPPUNIT_TEST( testClearSessionCache );
+        CPPUNIT_TEST_SUITE_END();
+
+    private:
+
+        std::string peerVerification;
+
+    public:
+
+        OpenSSLContextSpiTest();
+        virtual ~OpenSSLContextSpiTest();
+
+        virtual void setUp();
+        virtual void tearDown();
+
+        void testSessionResumption();
+        void testClearSessionCache();
+
+    };
+
+}}}}}
+
+#endif /* _DECAF_INTERNAL_NET_SSL_OPENSSL_OPENSSLCONTEXTSPITEST_H_ */
@@ -24,6 +24,9 @@
 #include <decaf/nio/LongBuffer.h>
 #include <decaf/nio/IntBuffer.h>
 #include <decaf/nio/ShortBuffer.h>
+#include <decaf/internal/nio/DirectMemoryPool.h>
+
+#include <memory>
 
 using namespace decaf;
 using namespace decaf::internal;
@@ -70,3 +73,44 @@ void BufferFactoryTest::testCreateByteBuffer3() {
 
     delete buffer;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+void BufferFactoryTest::testCreateDirectByteBuffer() {
+
+    std::auto_ptr<ByteBuffer> buffer( BufferFactory::createDirectByteBuffer( 500 ) );
+    CPPUNIT_ASSERT( buffer.get() != NULL );
+    CPPUNIT_ASSERT( buffer->isDirect() == true );
+    CPPUNIT_ASSERT( buffer->hasArray() == true );
+    CPPUNIT_ASSERT( buffer->capacity() == 500 );
+    CPPUNIT_ASSERT( buffer->isReadOnly() == false );
+    CPPUNIT_ASSERT( ( (size_t) buffer->array() % DirectMemoryPool::ALIGNMENT ) == 0 );
+
+    for( int i = 0; i < 500; ++i ) {
+        CPPUNIT_ASSERT( buffer->get( i ) == 0 );
+    }
+
+    buffer->putInt( 42 );
+    buffer->position( 100 );
+
+    // Views share the same direct memory.
+    std::auto_ptr<ByteBuffer> duplicate( buffer->duplicate() );
+    std::auto_ptr<ByteBuffer> slice( buffer->slice() );
+    std::auto_ptr<ByteBuffer> readOnly( buffer->asReadOnlyBuffer() );
+    CPPUNIT_ASSERT( duplicate->isDirect() == true );
+    CPPUNIT_ASSERT( slice->isDirect() == true );
+    CPPUNIT_ASSERT( readOnly->isDirect() == true );
+    CPPUNIT_ASSERT( duplicate->getInt( 0 ) == 42 );
+    CPPUNIT_ASSERT( slice->capacity() == 400 );
+
+    slice->put( 0, 7 );
+    buffer.reset( NULL );
+    CPPUNIT_ASSERT( duplicate->get( 100 ) == 7 );
+
+    std::auto_ptr<ByteBuffer> heap( BufferFactory::createByteBuffer( 500 ) );
+    CPPUNIT_ASSERT( heap->isDirect() == false );
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IllegalArgumentException",
+        BufferFactory::createDirectByteBuffer( -1 ),
+        decaf::lang::exceptions::IllegalArgumentException );
+}
@@ -33,6 +33,7 @@ namespace nio{
         CPPUNIT_TEST( testCreateByteBuffer1 );
         CPPUNIT_TEST( testCreateByteBuffer2 );
         CPPUNIT_TEST( testCreateByteBuffer3 );
+        CPPUNIT_TEST( testCreateDirectByteBuffer );
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -43,6 +44,7 @@ namespace nio{
         void testCreateByteBuffer1();
         void testCreateByteBuffer2();
         void testCreateByteBuffer3();
+        void testCreateDirectByteBuffer();
 
     };
 
@@ -0,0 +1,120 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DirectMemoryPoolTest.h"
+
+#include <decaf/internal/nio/DirectMemoryPool.h>
+#include <decaf/lang/exceptions/IllegalArgumentException.h>
+
+using namespace decaf;
+using namespace decaf::internal;
+using namespace decaf::internal::nio;
+
+////////////////////////////////////////////////////////////////////////////////
+void DirectMemoryPoolTest::testAlignment() {
+
+    int sizes[] = { 0, 1, 63, 4096, 5000, 1024 * 1024, 2 * 1024 * 1024 + 3 };
+
+    for( int i = 0; i < (int)( sizeof( sizes ) / sizeof( int ) ); ++i ) {
+        unsigned char* block = DirectMemoryPool::allocate( sizes[i] );
+        CPPUNIT_ASSERT( block != NULL );
+        CPPUNIT_ASSERT( ( (size_t) block % DirectMemoryPool::ALIGNMENT ) == 0 );
+
+        for( int j = 0; j < sizes[i]; ++j ) {
+            CPPUNIT_ASSERT( block[j] == 0 );
+        }
+
+        DirectMemoryPool::release( block, sizes[i] );
+    }
+
+    DirectMemoryPool::purge();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DirectMemoryPoolTest::testReuse() {
+
+    DirectMemoryPool::purge();
+
+    unsigned char* block = DirectMemoryPool::allocate( 3000 );
+    block[0] = 1;
+    block[2999] = 2;
+    DirectMemoryPool::release( block, 3000 );
+    CPPUNIT_ASSERT_EQUAL( 1, DirectMemoryPool::getCachedBlockCount() );
+
+    // Any size in the same class gets the cached block back, cleared.
+    unsigned char* again = DirectMemoryPool::allocate( 4000 );
+    CPPUNIT_ASSERT( again == block );
+    CPPUNIT_ASSERT( again[0] == 0 );
+    CPPUNIT_ASSERT( again[2999] == 0 );
+    CPPUNIT_ASSERT_EQUAL( 0, DirectMemoryPool::getCachedBlockCount() );
+
+    // A different size class doesn't.
+    DirectMemoryPool::release( again, 4000 );
+    unsigned char* larger = DirectMemoryPool::allocate( 5000 );
+    CPPUNIT_ASSERT( larger != again );
+    CPPUNIT_ASSERT_EQUAL( 1, DirectMemoryPool::getCachedBlockCount() );
+
+    DirectMemoryPool::release( larger, 5000 );
+    CPPUNIT_ASSERT_EQUAL( 2, DirectMemoryPool::getCachedBlockCount() );
+
+    // Only a bounded number of blocks is kept per class.
+    unsigned char* blocks[32];
+    for( int i = 0; i < 32; ++i ) {
+        blocks[i] = DirectMemoryPool::allocate( 100 );
+    }
+    for( int i = 0; i < 32; ++i ) {
+        DirectMemoryPool::release( blocks[i], 100 );
+    }
+    CPPUNIT_ASSERT_EQUAL( DirectMemoryPool::MAX_CACHED_BLOCKS + 1, DirectMemoryPool::getCachedBlockCount() );
+
+    DirectMemoryPool::purge();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DirectMemoryPoolTest::testLargeBlocksNotCached() {
+
+    DirectMemoryPool::purge();
+
+    int size = DirectMemoryPool::MAX_POOLED_SIZE + 1;
+    unsigned char* block = DirectMemoryPool::allocate( size );
+    block[size - 1] = 1;
+    DirectMemoryPool::release( block, size );
+
+    CPPUNIT_ASSERT_EQUAL( 0, DirectMemoryPool::getCachedBlockCount() );
+
+    // Releasing NULL is ignored.
+    DirectMemoryPool::release( NULL, 100 );
+    CPPUNIT_ASSERT_EQUAL( 0, DirectMemoryPool::getCachedBlockCount() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DirectMemoryPoolTest::testPurge() {
+
+    DirectMemoryPool::purge();
+
+    DirectMemoryPool::release( DirectMemoryPool::allocate( 100 ), 100 );
+    DirectMemoryPool::release( DirectMemoryPool::allocate( 100000 ), 100000 );
+    CPPUNIT_ASSERT_EQUAL( 2, DirectMemoryPool::getCachedBlockCount() );
+
+    DirectMemoryPool::purge();
+    CPPUNIT_ASSERT_EQUAL( 0, DirectMemoryPool::getCachedBlockCount() );
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IllegalArgumentException",
+        DirectMemoryPool::allocate( -1 ),
+        decaf::lang::exceptions::IllegalArgumentException );
+}
@@ -0,0 +1,234 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MappedByteBufferTest.h"
+
+#include <decaf/internal/nio/BufferFactory.h>
+#include <decaf/internal/nio/MappedByteBuffer.h>
+#include <decaf/nio/ReadOnlyBufferException.h>
+#include <decaf/io/IOException.h>
+#include <decaf/lang/Integer.h>
+#include <decaf/lang/exceptions/IllegalArgumentException.h>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace decaf;
+using namespace decaf::internal;
+using namespace decaf::internal::nio;
+using namespace decaf::nio;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const char* MAP_PATH = "MappedByteBufferTest.dat";
+
+    void writeFile(const std::string& content) {
+        FILE* file = ::fopen(MAP_PATH, "wb");
+        CPPUNIT_ASSERT(file != NULL);
+        CPPUNIT_ASSERT_EQUAL(content.size(), ::fwrite(content.data(), 1, content.size(), file));
+        ::fclose(file);
+    }
+
+    std::string readFile() {
+        std::string content;
+        FILE* file = ::fopen(MAP_PATH, "rb");
+        CPPUNIT_ASSERT(file != NULL);
+        char chunk[4096];
+        size_t count = 0;
+        while ((count = ::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            content.append(chunk, count);
+        }
+        ::fclose(file);
+        return content;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MappedByteBufferTest::tearDown() {
+    ::remove(MAP_PATH);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MappedByteBufferTest::testReadWrite() {
+
+    ::remove(MAP_PATH);
+
+    // The file is created and extended to cover the region.
+    std::auto_ptr<MappedByteBuffer> buffer(
+        BufferFactory::createMappedByteBuffer(MAP_PATH, MappedByteBuffer::READ_WRITE, 0, 10000));
+
+    CPPUNIT_ASSERT(buffer->isDirect());
+    CPPUNIT_ASSERT(!buffer->isReadOnly());
+    CPPUNIT_ASSERT_EQUAL(10000, buffer->capacity());
+    CPPUNIT_ASSERT_EQUAL(MappedByteBuffer::READ_WRITE, buffer->getMapMode());
+
+    buffer->put(0, 'a');
+    buffer->putInt(5000, 0x01020304);
+    buffer->put(9999, 'z');
+    buffer->force();
+
+    std::string content = readFile();
+    CPPUNIT_ASSERT_EQUAL((size_t) 10000, content.size());
+    CPPUNIT_ASSERT_EQUAL('a', content[0]);
+    CPPUNIT_ASSERT_EQUAL('z', content[9999]);
+
+    CPPUNIT_ASSERT(!buffer->isLoaded());
+    buffer->load();
+    CPPUNIT_ASSERT(buffer->isLoaded());
+
+    buffer.reset(NULL);
+
+    // Mapping the file again sees the earlier writes.
+    buffer.reset(BufferFactory::createMappedByteBuffer(MAP_PATH, MappedByteBuffer::READ_ONLY, 0, 10000));
+    CPPUNIT_ASSERT_EQUAL(0x01020304, buffer->getInt(5000));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MappedByteBufferTest::testReadOnly() {
+
+    writeFile("Hello World");
+
+    std::auto_ptr<MappedByteBuffer> buffer(
+        BufferFactory::createMappedByteBuffer(MAP_PATH, MappedByteBuffer::READ_ONLY, 0, 11));
+
+    CPPUNIT_ASSERT(buffer->isReadOnly());
+    CPPUNIT_ASSERT_EQUAL((unsigned char) 'H', buffer->get(0));
+    CPPUNIT_ASSERT_EQUAL((unsigned char) 'd', buffer->get(10));
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw a ReadOnlyBufferException",
+        buffer->put(0, 'h'),
+        ReadOnlyBufferException);
+
+    // Forcing a read only mapping does nothing.
+    buffer->force();
+    CPPUNIT_ASSERT_EQUAL(std::string("Hello World"), readFile());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MappedByteBufferTest::testPrivate() {
+
+    writeFile("Hello World");
+
+    std::auto_ptr<MappedByteBuffer> buffer(
+        BufferFactory::createMappedByteBuffer(MAP_PATH, MappedByteBuffer::PRIVATE, 0, 11));
+
+    CPPUNIT_ASSERT(!buffer->isReadOnly());
+    CPPUNIT_ASSERT(buffer->hasArray());
+
+    // Changes stay in this process.
+    buffer->array()[buffer->arrayOffset()] = 'J';
+    CPPUNIT_ASSERT_EQUAL((unsigned char) 'J', buffer->get(0));
+    buffer->force();
+
+    CPPUNIT_ASSERT_EQUAL(std::string("Hello World"), readFile());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MappedByteBufferTest::testUnalignedPosition() {
+
+    std::string content;
+    for (int i = 0; i < 20000; ++i) {
+        content.push_back((char) ('a' + (i % 26)));
+    }
+    writeFile(content);
+
+    std::auto_ptr<MappedByteBuffer> buffer(
+        BufferFactory::createMappedByteBuffer(MAP_PATH, MappedByteBuffer::READ_ONLY, 12345, 100));
+
+    CPPUNIT_ASSERT_EQUAL(100, buffer->capacity());
+    CPPUNIT_ASSERT_EQUAL(0, buffer->position());
+    CPPUNIT_ASSERT_EQUAL(100, buffer->limit());
+
+    std::vector<unsigned char> bytes(100);
+    buffer->ByteBuffer::get(&bytes[0], 100, 0, 100);
+    for (int i = 0; i < 100; ++i) {
+        CPPUNIT_ASSERT_EQUAL((unsigned char) content[12345 + i], bytes[i]);
+    }
+
+    // An empty region is allowed.
+    buffer.reset(BufferFactory::createMappedByteBuffer(MAP_PATH, MappedByteBuffer::READ_ONLY, 100, 0));
+    CPPUNIT_ASSERT_EQUAL(0, buffer->capacity());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MappedByteBufferTest::testRegionBeyondEnd() {
+
+    writeFile("short");
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IOException",
+        BufferFactory::createMappedByteBuffer(MAP_PATH, MappedByteBuffer::READ_ONLY, 0, 100),
+        decaf::io::IOException);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IOException",
+        BufferFactory::createMappedByteBuffer("MappedByteBufferTest.missing", MappedByteBuffer::READ_ONLY, 0, 1),
+        decaf::io::IOException);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IllegalArgumentException",
+        BufferFactory::createMappedByteBuffer(MAP_PATH, MappedByteBuffer::READ_ONLY, -1, 1),
+        decaf::lang::exceptions::IllegalArgumentException);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MappedByteBufferTest::testRegionTooLarge() {
+
+    writeFile("0123456789");
+
+    // Starting past a page boundary the mapping would be larger than the size,
+    // the region is refused before the file is extended.
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IllegalArgumentException",
+        BufferFactory::createMappedByteBuffer(
+            MAP_PATH, MappedByteBuffer::READ_WRITE, 1, decaf::lang::Integer::MAX_VALUE),
+        decaf::lang::exceptions::IllegalArgumentException);
+
+    std::auto_ptr<MappedByteBuffer> buffer(
+        BufferFactory::createMappedByteBuffer(MAP_PATH, MappedByteBuffer::READ_ONLY, 0, 10));
+    CPPUNIT_ASSERT_EQUAL(10, buffer->capacity());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MappedByteBufferTest::testViewsOutliveBuffer() {
+
+    writeFile("0123456789");
+
+    std::auto_ptr<MappedByteBuffer> buffer(
+        BufferFactory::createMappedByteBuffer(MAP_PATH, MappedByteBuffer::READ_WRITE, 0, 10));
+
+    buffer->position(5);
+    std::auto_ptr<ByteBuffer> slice(buffer->slice());
+    std::auto_ptr<ByteBuffer> duplicate(buffer->duplicate());
+
+    // The mapping stays in place while any view of it is alive.
+    buffer.reset(NULL);
+
+    CPPUNIT_ASSERT(slice->isDirect());
+    CPPUNIT_ASSERT_EQUAL((unsigned char) '5', slice->get(0));
+    slice->put(0, 'X');
+    CPPUNIT_ASSERT_EQUAL((unsigned char) 'X', duplicate->get(5));
+
+    slice.reset(NULL);
+    duplicate.reset(NULL);
+
+    CPPUNIT_ASSERT_EQUAL(std::string("01234X6789"), readFile());
+}
@@ -0,0 +1,171 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ModifiedUTF8Test.h"
+
+#include <decaf/internal/util/ModifiedUTF8.h>
+#include <decaf/io/UTFDataFormatException.h>
+
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace decaf;
+using namespace decaf::io;
+using namespace decaf::internal;
+using namespace decaf::internal::util;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    // Reference encoding, one char at a time.
+    std::vector<unsigned char> referenceEncode(const std::string& value) {
+
+        std::vector<unsigned char> result;
+
+        for (std::size_t i = 0; i < value.length(); ++i) {
+            unsigned int charValue = (unsigned char) value[i];
+            if (charValue > 0 && charValue <= 127) {
+                result.push_back((unsigned char) charValue);
+            } else {
+                result.push_back((unsigned char) (0xc0 | (0x1f & (charValue >> 6))));
+                result.push_back((unsigned char) (0x80 | (0x3f & charValue)));
+            }
+        }
+
+        return result;
+    }
+
+    // Strings of every length up to a few vector blocks, with the multi byte chars
+    // placed at the start, the end and on either side of each block boundary.
+    std::vector<std::string> createSamples() {
+
+        std::vector<std::string> samples;
+
+        for (std::size_t length = 0; length < 100; ++length) {
+            std::string ascii(length, 'x');
+            samples.push_back(ascii);
+
+            for (std::size_t pos = 0; pos < length; ++pos) {
+                std::string latin(ascii);
+                latin[pos] = (char) (pos % 2 == 0 ? 0xE9 : 0x00);
+                samples.push_back(latin);
+            }
+        }
+
+        std::string all;
+        for (int i = 0; i < 256; ++i) {
+            all += (char) i;
+        }
+        samples.push_back(all);
+
+        return samples;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ModifiedUTF8Test::testEncodedLength() {
+
+    CPPUNIT_ASSERT_EQUAL((std::size_t) 0, ModifiedUTF8::encodedLength("", 0));
+    CPPUNIT_ASSERT_EQUAL((std::size_t) 5, ModifiedUTF8::encodedLength("hello", 5));
+    CPPUNIT_ASSERT_EQUAL((std::size_t) 2, ModifiedUTF8::encodedLength("\0", 1));
+    CPPUNIT_ASSERT_EQUAL((std::size_t) 6, ModifiedUTF8::encodedLength("caf\xE9!", 5));
+
+    std::vector<std::string> samples = createSamples();
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        CPPUNIT_ASSERT_EQUAL(referenceEncode(samples[i]).size(),
+                             ModifiedUTF8::encodedLength(samples[i].c_str(), samples[i].length()));
+    }
+
+    // Long enough that the vector lane counters have to be folded more than once.
+    std::string large(70000, 'a');
+    for (std::size_t i = 0; i < large.length(); i += 3) {
+        large[i] = (char) 0xFF;
+    }
+    CPPUNIT_ASSERT_EQUAL(referenceEncode(large).size(), ModifiedUTF8::encodedLength(large.c_str(), large.length()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ModifiedUTF8Test::testEncodeDecode() {
+
+    std::vector<std::string> samples = createSamples();
+
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+
+        const std::string& sample = samples[i];
+        std::vector<unsigned char> expected = referenceEncode(sample);
+        std::vector<unsigned char> encoded(sample.length() * 2 + 1);
+
+        std::size_t length = ModifiedUTF8::encode(sample.c_str(), sample.length(), &encoded[0]);
+        CPPUNIT_ASSERT_EQUAL(expected.size(), length);
+        CPPUNIT_ASSERT(std::equal(expected.begin(), expected.end(), encoded.begin()));
+
+        std::vector<char> decoded(length + 1);
+        std::size_t count = ModifiedUTF8::decode(&encoded[0], length, &decoded[0]);
+        CPPUNIT_ASSERT_EQUAL(sample, std::string(&decoded[0], count));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ModifiedUTF8Test::testDecodeInPlace() {
+
+    std::string sample(200, 'z');
+    for (std::size_t i = 0; i < sample.length(); i += 7) {
+        sample[i] = (char) 0xC4;
+    }
+
+    std::vector<unsigned char> encoded = referenceEncode(sample);
+    std::size_t count = ModifiedUTF8::decode(&encoded[0], encoded.size(), (char*) &encoded[0]);
+
+    CPPUNIT_ASSERT_EQUAL(sample, std::string((char*) &encoded[0], count));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ModifiedUTF8Test::testDecodeInvalid() {
+
+    char dest[64];
+
+    const unsigned char truncated[] = { 'a', 'b', 0xC3 };
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw for a two byte char at the end",
+        ModifiedUTF8::decode(truncated, sizeof(truncated), dest),
+        UTFDataFormatException);
+
+    const unsigned char badContinuation[] = { 0xC3, 0x29 };
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw for a second byte not starting with 0x80",
+        ModifiedUTF8::decode(badContinuation, sizeof(badContinuation), dest),
+        UTFDataFormatException);
+
+    const unsigned char tooWide[] = { 0xC4, 0x80 };
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw for a char that does not fit in a byte",
+        ModifiedUTF8::decode(tooWide, sizeof(tooWide), dest),
+        UTFDataFormatException);
+
+    const unsigned char threeByte[] = { 0xE2, 0x82, 0xAC };
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw for a three byte char",
+        ModifiedUTF8::decode(threeByte, sizeof(threeByte), dest),
+        UTFDataFormatException);
+
+    const unsigned char badLead[] = { 'a', 0x80 };
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw for a stray continuation byte",
+        ModifiedUTF8::decode(badLead, sizeof(badLead), dest),
+        UTFDataFormatException);
+}
@@ -128,3 +128,52 @@ void ExceptionTest::testMessage3(){
     CPPUNIT_ASSERT( strcmp( ex.getMessage().c_str(),
                     "This is a test 1 100 1000" ) == 0 );
 }
+
+////////////////////////////////////////////////////////////////////////////////
+void ExceptionTest::testLongMessage() {
+
+    std::string text( 1000, 'x' );
+    Exception ex( __FILE__, __LINE__, "%s %d", text.c_str(), 42 );
+    CPPUNIT_ASSERT_EQUAL( text + " 42", ex.getMessage() );
+
+    // Right at the size of the internal buffer.
+    std::string edge( 255, 'y' );
+    ex.setMessage( "%s", edge.c_str() );
+    CPPUNIT_ASSERT_EQUAL( edge, ex.getMessage() );
+    ex.setMessage( "%s", edge.substr( 1 ).c_str() );
+    CPPUNIT_ASSERT_EQUAL( edge.substr( 1 ), ex.getMessage() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ExceptionTest::testStackTrace() {
+
+    Exception ex( "first.cpp", 1, "marked" );
+
+    // More marks than are kept inline.
+    for( int i = 2; i <= 20; ++i ) {
+        ex.setMark( "next.cpp", i );
+    }
+
+    std::vector< std::pair< std::string, int> > trace = ex.getStackTrace();
+    CPPUNIT_ASSERT_EQUAL( (size_t) 20, trace.size() );
+    CPPUNIT_ASSERT_EQUAL( std::string( "first.cpp" ), trace[0].first );
+    for( int i = 1; i < 20; ++i ) {
+        CPPUNIT_ASSERT_EQUAL( std::string( "next.cpp" ), trace[i].first );
+        CPPUNIT_ASSERT_EQUAL( i + 1, trace[i].second );
+    }
+
+    Exception copy( ex );
+    CPPUNIT_ASSERT( copy.getStackTrace() == trace );
+    CPPUNIT_ASSERT_EQUAL( ex.getStackTraceString(), copy.getStackTraceString() );
+
+    Exception* cloned = ex.clone();
+    CPPUNIT_ASSERT( cloned->getStackTrace() == trace );
+    delete cloned;
+
+    Exception assigned;
+    assigned.setMark( "other.cpp", 7 );
+    assigned = ex;
+    CPPUNIT_ASSERT( assigned.getStackTrace() == trace );
+
+    CPPUNIT_ASSERT( ex.getStackTraceString().find( "FILE: next.cpp, LINE: 20" ) != std::string::npos );
+}
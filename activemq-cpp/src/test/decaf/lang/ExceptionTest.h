@@ -36,6 +36,8 @@ namespace lang{
         CPPUNIT_TEST( testInitCause );
         CPPUNIT_TEST( testCtors );
         CPPUNIT_TEST( testAssign );
+        CPPUNIT_TEST( testLongMessage );
+        CPPUNIT_TEST( testStackTrace );
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -51,6 +53,8 @@ namespace lang{
         void testInitCause();
         void testMessage0();
         void testMessage3();
+        void testLongMessage();
+        void testStackTrace();
 
     };
 
@@ -52,6 +52,8 @@ CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::openwire::marshal::Primit
 
 #include <activemq/wireformat/openwire/utils/BooleanStreamTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::openwire::utils::BooleanStreamTest );
+#include <activemq/wireformat/openwire/utils/DirectDataStreamTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::openwire::utils::DirectDataStreamTest );
 #include <activemq/wireformat/openwire/utils/HexTableTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::openwire::utils::HexTableTest );
 #include <activemq/wireformat/openwire/utils/MessagePropertyInterceptorTest.h>
@@ -90,8 +92,16 @@ CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::FifoMessageDispatchChannelTest
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::SimplePriorityMessageDispatchChannelTest );
 #include <activemq/core/ActiveMQMessageAuditTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::ActiveMQMessageAuditTest );
+#include <activemq/core/ActiveMQMessageDemultiplexerTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::ActiveMQMessageDemultiplexerTest );
+#include <activemq/core/AdaptivePrefetchControllerTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::AdaptivePrefetchControllerTest );
 #include <activemq/core/ConnectionAuditTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::ConnectionAuditTest );
+#include <activemq/core/ConsumerRoutingTableTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::ConsumerRoutingTableTest );
+#include <activemq/core/PipelinedSendWindowTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::PipelinedSendWindowTest );
 
 #include <activemq/state/ConnectionStateTrackerTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::state::ConnectionStateTrackerTest );
@@ -108,6 +118,11 @@ CPPUNIT_TEST_SUITE_REGISTRATION( activemq::state::TransactionStateTest );
 
 #include <activemq/transport/failover/FailoverTransportTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::transport::failover::FailoverTransportTest );
+#include <activemq/transport/failover/MessageSpoolTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::transport::failover::MessageSpoolTest );
+
+#include <activemq/transport/replay/ReplayTransportTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::transport::replay::ReplayTransportTest );
 
 #include <activemq/transport/tcp/TcpTransportTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::transport::tcp::TcpTransportTest );
@@ -115,6 +130,8 @@ CPPUNIT_TEST_SUITE_REGISTRATION( activemq::transport::tcp::TcpTransportTest );
 #include <activemq/transport/correlator/ResponseCorrelatorTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::transport::correlator::ResponseCorrelatorTest );
 
+#include <activemq/transport/mock/MockBrokerTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::transport::mock::MockBrokerTest );
 #include <activemq/transport/mock/MockTransportFactoryTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::transport::mock::MockTransportFactoryTest );
 
@@ -129,14 +146,24 @@ CPPUNIT_TEST_SUITE_REGISTRATION( activemq::transport::IOTransportTest );
 #include <activemq/exceptions/ActiveMQExceptionTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::exceptions::ActiveMQExceptionTest );
 
+#include <activemq/filter/MessageSelectorTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::filter::MessageSelectorTest );
+
+#include <activemq/io/CaptureFileTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::io::CaptureFileTest );
+
 #include <activemq/util/AdvisorySupportTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::util::AdvisorySupportTest );
 #include <activemq/util/ActiveMQMessageTransformationTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::util::ActiveMQMessageTransformationTest );
 #include <activemq/util/IdGeneratorTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::util::IdGeneratorTest );
+#include <activemq/util/LatencyHistogramTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::util::LatencyHistogramTest );
 #include <activemq/util/LongSequenceGeneratorTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::util::LongSequenceGeneratorTest );
+#include <activemq/util/MessageArenaTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::util::MessageArenaTest );
 #include <activemq/util/PrimitiveValueNodeTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::util::PrimitiveValueNodeTest );
 #include <activemq/util/PrimitiveListTest.h>
@@ -149,6 +176,8 @@ CPPUNIT_TEST_SUITE_REGISTRATION( activemq::util::PrimitiveValueConverterTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::util::URISupportTest );
 #include <activemq/util/MemoryUsageTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::util::MemoryUsageTest );
+#include <activemq/util/ProducerWindowTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::util::ProducerWindowTest );
 #include <activemq/util/MarshallingSupportTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::util::MarshallingSupportTest );
 
@@ -164,11 +193,15 @@ CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::WireFormatRegistryTest );
 
 #include <decaf/internal/util/ByteArrayAdapterTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( decaf::internal::util::ByteArrayAdapterTest );
+#include <decaf/internal/util/ModifiedUTF8Test.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( decaf::internal::util::ModifiedUTF8Test );
 #include <decaf/internal/util/TimerTaskHeapTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( decaf::internal::util::TimerTaskHeapTest );
 
 #include <decaf/internal/net/ssl/DefaultSSLSocketFactoryTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( decaf::internal::net::ssl::DefaultSSLSocketFactoryTest );
+#include <decaf/internal/net/ssl/openssl/OpenSSLContextSpiTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( decaf::internal::net::ssl::openssl::OpenSSLContextSpiTest );
 
 #include <decaf/internal/nio/ByteArrayBufferTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( decaf::internal::nio::ByteArrayBufferTest );
@@ -186,6 +219,10 @@ CPPUNIT_TEST_SUITE_REGISTRATION( decaf::internal::nio::LongArrayBufferTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( decaf::internal::nio::IntArrayBufferTest );
 #include <decaf/internal/nio/ShortArrayBufferTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( decaf::internal::nio::ShortArrayBufferTest );
+#include <decaf/internal/nio/DirectMemoryPoolTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( decaf::internal::nio::DirectMemoryPoolTest );
+#include <decaf/internal/nio/MappedByteBufferTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( decaf::internal::nio::MappedByteBufferTest );
 
 #include <decaf/internal/net/URIEncoderDecoderTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( decaf::internal::net::URIEncoderDecoderTest );